@@ -3,23 +3,71 @@
 
 #include "iniparser.h"
 
+/**
+ * @def MAX_CONFIG_VALUE
+ * @brief Constant declaring the maximum length of a string value kept in the configuration snapshot
+*/
+#define MAX_CONFIG_VALUE 256
+
+/**
+ * @author agent
+ * @struct AK_config_snapshot
+ * @brief Typed copy of config.ini, filled once by AK_inflate_config and read by the configuration macros
+ *        with plain field loads. Values are only re-read when AK_reload_config is called.
+ */
+typedef struct {
+    /// database file name (general:db_file)
+    char db_file[MAX_CONFIG_VALUE];
+    /// blobs folder (general:blobs_folder)
+    char blobs_path[MAX_CONFIG_VALUE];
+    /// archive log folder (redolog:archivelog_folder)
+    char archivelog_path[MAX_CONFIG_VALUE];
+    /// buffer pool replacement policy (memory:cache_policy)
+    char cache_policy[MAX_CONFIG_VALUE];
+    /// size of the database file in MB (general:db_file_size)
+    int db_file_size;
+    /// maximum number of threads (general:number_of_threads)
+    int number_of_threads;
+    /// maximum number of blocks in a segment (segments:max_num_of_blocks)
+    int max_num_of_blocks;
+    /// maximum free space in a block (blocks:max_AK_free_space_size)
+    int max_free_space_size;
+    /// maximum size of the last tuple in a dictionary (dictionary:max_last_tuple_dict_size_to_use)
+    int max_last_tuple_dict_size_to_use;
+    /// initial extent size in blocks (extents:initial_extent_size)
+    int initial_extent_size;
+    /// extent growth factors (extents:extent_growth_*)
+    double extent_growth_table;
+    double extent_growth_index;
+    double extent_growth_transaction;
+    double extent_growth_temp;
+    /// number of buffer pool frames (memory:cache_size)
+    int cache_size;
+    /// number of references remembered by LRU-K (memory:lru_k)
+    int lru_k;
+} AK_config_snapshot;
+
+extern AK_config_snapshot AK_config_values;
+
+int AK_reload_config();
+
 /**
  * @def AK_BLOBS_PATH
  * @brief Constant declaring the path of blobs folder (note: if changed keep in mind for make clean in makefile).
    Path declared in config.ini has to be absolute (tied up with installation package), but for debugging purpose we are going to keep it relative.
 */
-#define AK_BLOBS_PATH (iniparser_getstring(AK_config, "general:blobs_folder", "./blobs"))
+#define AK_BLOBS_PATH (AK_config_values.blobs_path)
 
 /**
  * @def DB_NAME
  * @brief Constant declaring the name of the database file
 */
-#define DB_FILE (iniparser_getstring(AK_config,"general:db_file","kalashnikov.db"))
+#define DB_FILE (AK_config_values.db_file)
 /**
  * @def MAX_NUM_OF_BLOCKS
  * @brief Constant declaring the maximum number of blocks in a segment
 */
-#define MAX_NUM_OF_BLOCKS (iniparser_getint(AK_config,"segments:max_num_of_blocks",200))
+#define MAX_NUM_OF_BLOCKS (AK_config_values.max_num_of_blocks)
 /**
   * @def MAX_EXTENTS_IN_SEGMENT
   * @brief Constant declaring the maximum number of extents in segment
@@ -29,52 +77,52 @@
   * @def MAX_FREE_SPACE_SIZE
   * @brief Constant declaring the maximum free space in block
 */
-#define MAX_FREE_SPACE_SIZE (iniparser_getint(AK_config,"blocks:max_AK_free_space_size",4000))
+#define MAX_FREE_SPACE_SIZE (AK_config_values.max_free_space_size)
 /**
   * @def MAX_LAST_TUPLE_DICT_SIZE_TO_USE
   * @brief Constant declaring the maximum size od last tuple in a dictionary
 */
-#define MAX_LAST_TUPLE_DICT_SIZE_TO_USE (iniparser_getint(AK_config,"dictionary:max_last_tuple_dict_size_to_use",470))
+#define MAX_LAST_TUPLE_DICT_SIZE_TO_USE (AK_config_values.max_last_tuple_dict_size_to_use)
 /**
   * @def DB_FILE_SIZE
   * @brief Constant declaring size of DB file in MB
  */
-#define DB_FILE_SIZE (iniparser_getint(AK_config,"general:db_file_size",40))
+#define DB_FILE_SIZE (AK_config_values.db_file_size)
 /**
   * @def MAX_DB_FILE_BLOCKS
   * @brief Constant declaring total blocks in DB file (for the given DB_FILE size)
  */
-#define DB_FILE_BLOCKS_NUM (1024 * 1024 * DB_FILE_SIZE / sizeof(AK_block))
+#define DB_FILE_BLOCKS_NUM (1024 * 1024 * DB_FILE_SIZE / AK_PAGE_SIZE)
 /**
   * @def INITIAL_EXTENT_SIZE
   * @brief Constant declaring initial extent size in blocks
  */
-#define INITIAL_EXTENT_SIZE (iniparser_getint(AK_config,"extents:initial_extent_size",15))
+#define INITIAL_EXTENT_SIZE (AK_config_values.initial_extent_size)
 /**
   * @def EXTENT_GROWTH_TABLE
   * @brief Constant declaring extent growth factor for tables
  */
-#define EXTENT_GROWTH_TABLE (iniparser_getdouble(AK_config,"extents:extent_growth_table",0.5))
+#define EXTENT_GROWTH_TABLE (AK_config_values.extent_growth_table)
 /**
   * @def EXTENT_GROWTH_INDEX
   * @brief Constant declaring extent growth factor for indices
  */
-#define EXTENT_GROWTH_INDEX (iniparser_getdouble(AK_config,"extents:extent_growth_index",0.2))
+#define EXTENT_GROWTH_INDEX (AK_config_values.extent_growth_index)
 /**
   * @def EXTENT_GROWTH_TRANSACTION
   * @brief Constant declaring extent growth factor for transaction segments
  */
-#define EXTENT_GROWTH_TRANSACTION (iniparser_getdouble(AK_config,"extents:extent_growth_transaction",0.2))
+#define EXTENT_GROWTH_TRANSACTION (AK_config_values.extent_growth_transaction)
 /**
   * @def EXTENT_GROWTH_TEMP
   * @brief Constant declaring extent growth factor for temporary segments
  */
-#define EXTENT_GROWTH_TEMP (iniparser_getdouble(AK_config,"extents:extent_growth_temp",0.5))
+#define EXTENT_GROWTH_TEMP (AK_config_values.extent_growth_temp)
 /**
  * @def ARCHIVELOG_PATH
  * @brief Constant declaring the path of archivelog folder
 */
-#define ARCHIVELOG_PATH (iniparser_getstring(AK_config, "redolog:archivelog_folder", "./archivelog"))
+#define ARCHIVELOG_PATH (AK_config_values.archivelog_path)
 /**
  * @def MAX_REDO_LOG_MEMORY
  * @brief The maximum size of REDO log memory
@@ -91,7 +139,22 @@
  * @def NUMBER_OF_THREADS
  * @brief Constant declaring maximum number of threads that an application can acquire
 */
-#define NUMBER_OF_THREADS (iniparser_getint(AK_config,"general:number_of_threads",42))
+#define NUMBER_OF_THREADS (AK_config_values.number_of_threads)
+/**
+  * @def CACHE_SIZE
+  * @brief Constant declaring the number of frames (blocks) in the buffer pool
+*/
+#define CACHE_SIZE (AK_config_values.cache_size)
+/**
+  * @def CACHE_POLICY
+  * @brief Constant declaring the page replacement policy of the buffer pool ("clock" or "lru-k")
+*/
+#define CACHE_POLICY (AK_config_values.cache_policy)
+/**
+  * @def CACHE_LRU_K
+  * @brief Constant declaring the number of references remembered by the LRU-K policy
+*/
+#define CACHE_LRU_K (AK_config_values.lru_k)
 /**
   * @def MAX_EXTENTS
   * @brief Constant declaring maximum number of extents for a given segment
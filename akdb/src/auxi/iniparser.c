@@ -9,6 +9,8 @@
 /*---------------------------- Includes ------------------------------------*/
 #include <ctype.h>
 #include "iniparser.h"
+#include "configuration.h"
+#include "constants.h"
 
 /*---------------------------- Defines -------------------------------------*/
 #define ASCIILINESZ         (1024)
@@ -852,13 +854,174 @@ char * AK_config_get(dictionary * d, char * key, char * def)
 //char * DB_FILE;
 
 
+/**
+ * @def AK_CONFIG_DEFAULTS
+ * @brief Initializer holding the values used when config.ini is missing or a value in it is invalid
+ */
+#define AK_CONFIG_DEFAULTS {"kalashnikov.db", "./blobs", "./archivelog", "clock", 40, 42, 200, 4000, 470, 15, 0.5, 0.2, 0.2, 0.5, MAX_CACHE_MEMORY, 2}
+
+/// configuration values in effect, readable before AK_inflate_config is called
+AK_config_snapshot AK_config_values = AK_CONFIG_DEFAULTS;
+
+/**
+ * @author agent
+ * @brief Function that copies a string value of the configuration into the snapshot. A missing key keeps the
+ *        default, an empty or too long value is rejected.
+ * @param d dictionary holding config.ini
+ * @param key section:key of the value
+ * @param dest field of the snapshot, holding the default
+ * @return 1 if the value was rejected, 0 otherwise
+ */
+static int AK_config_string(dictionary *d, const char *key, char *dest)
+{
+    char *value;
+    int rejected = 0;
+    AK_PRO;
+    value = iniparser_getstring(d, key, NULL);
+    if (value != NULL)
+    {
+        if (value[0] == '\0' || strlen(value) >= MAX_CONFIG_VALUE)
+        {
+            printf("AK_inflate_config: WARNING. Invalid value of %s, using %s\n", key, dest);
+            rejected = 1;
+        }
+        else
+            strcpy(dest, value);
+    }
+    AK_EPI;
+    return rejected;
+}
+
+/**
+ * @author agent
+ * @brief Function that copies an integer value of the configuration into the snapshot. Values below min are
+ *        rejected.
+ * @param d dictionary holding config.ini
+ * @param key section:key of the value
+ * @param dest field of the snapshot, holding the default
+ * @param min smallest accepted value
+ * @return 1 if the value was rejected, 0 otherwise
+ */
+static int AK_config_int(dictionary *d, const char *key, int *dest, int min)
+{
+    int value;
+    int rejected = 0;
+    AK_PRO;
+    value = iniparser_getint(d, key, *dest);
+    if (value < min)
+    {
+        printf("AK_inflate_config: WARNING. Invalid value of %s (%d), using %d\n", key, value, *dest);
+        rejected = 1;
+    }
+    else
+        *dest = value;
+    AK_EPI;
+    return rejected;
+}
+
+/**
+ * @author agent
+ * @brief Function that copies an extent growth factor of the configuration into the snapshot. Factors that
+ *        are not positive are rejected.
+ * @param d dictionary holding config.ini
+ * @param key section:key of the value
+ * @param dest field of the snapshot, holding the default
+ * @return 1 if the value was rejected, 0 otherwise
+ */
+static int AK_config_double(dictionary *d, const char *key, double *dest)
+{
+    double value;
+    int rejected = 0;
+    AK_PRO;
+    value = iniparser_getdouble(d, key, *dest);
+    if (!(value > 0))
+    {
+        printf("AK_inflate_config: WARNING. Invalid value of %s (%f), using %f\n", key, value, *dest);
+        rejected = 1;
+    }
+    else
+        *dest = value;
+    AK_EPI;
+    return rejected;
+}
+
+/**
+ * @author agent
+ * @brief Function that builds a validated configuration snapshot from a dictionary. Every value that is
+ *        missing or invalid is taken from AK_CONFIG_DEFAULTS.
+ * @param d dictionary holding config.ini (may be NULL)
+ * @param snapshot snapshot to fill
+ * @return number of rejected values
+ */
+static int AK_config_fill(dictionary *d, AK_config_snapshot *snapshot)
+{
+    AK_config_snapshot defaults = AK_CONFIG_DEFAULTS;
+    int rejected = 0;
+    AK_PRO;
+    *snapshot = defaults;
+    rejected += AK_config_string(d, "general:db_file", snapshot->db_file);
+    rejected += AK_config_string(d, "general:blobs_folder", snapshot->blobs_path);
+    rejected += AK_config_string(d, "redolog:archivelog_folder", snapshot->archivelog_path);
+    rejected += AK_config_string(d, "memory:cache_policy", snapshot->cache_policy);
+    rejected += AK_config_int(d, "general:db_file_size", &snapshot->db_file_size, 1);
+    rejected += AK_config_int(d, "general:number_of_threads", &snapshot->number_of_threads, 1);
+    rejected += AK_config_int(d, "segments:max_num_of_blocks", &snapshot->max_num_of_blocks, 1);
+    rejected += AK_config_int(d, "blocks:max_AK_free_space_size", &snapshot->max_free_space_size, 1);
+    rejected += AK_config_int(d, "dictionary:max_last_tuple_dict_size_to_use", &snapshot->max_last_tuple_dict_size_to_use, 1);
+    rejected += AK_config_int(d, "extents:initial_extent_size", &snapshot->initial_extent_size, 1);
+    rejected += AK_config_double(d, "extents:extent_growth_table", &snapshot->extent_growth_table);
+    rejected += AK_config_double(d, "extents:extent_growth_index", &snapshot->extent_growth_index);
+    rejected += AK_config_double(d, "extents:extent_growth_transaction", &snapshot->extent_growth_transaction);
+    rejected += AK_config_double(d, "extents:extent_growth_temp", &snapshot->extent_growth_temp);
+    rejected += AK_config_int(d, "memory:cache_size", &snapshot->cache_size, 1);
+    rejected += AK_config_int(d, "memory:lru_k", &snapshot->lru_k, 1);
+    AK_EPI;
+    return rejected;
+}
+
+/**
+ * @author agent (configuration snapshot)
+ * @brief Function that loads config.ini and fills AK_config_values, the snapshot read by the configuration
+ *        macros. It is called once at startup.
+ */
 void AK_inflate_config()
 {
+  AK_config_snapshot snapshot;
   AK_PRO;
   AK_config = iniparser_load("config.ini");
+  AK_config_fill(AK_config, &snapshot);
+  AK_config_values = snapshot;
   AK_EPI;
-  //DB_FILE = AK_config_get(AK_config,"general:db_file", NULL);
-  //printf("DB_FILE: %s \n",DB_FILE);
+}
+
+/**
+ * @author agent
+ * @brief Function that reloads config.ini and replaces the configuration snapshot. The database file name
+ *        and size are taken over as well, so the caller has to reinitialize the disk manager if they
+ *        changed. It should not be called while other threads are using the configuration.
+ * @return EXIT_SUCCESS if the configuration was reloaded, EXIT_WARNING if some values were replaced by
+ *         defaults, EXIT_ERROR if config.ini could not be read (the current snapshot is kept)
+ */
+int AK_reload_config()
+{
+  dictionary *d;
+  AK_config_snapshot snapshot;
+  int rejected;
+  AK_PRO;
+  d = iniparser_load("config.ini");
+  if (d == NULL)
+  {
+    printf("AK_reload_config: ERROR. Cannot load config.ini\n");
+    AK_EPI;
+    return EXIT_ERROR;
+  }
+  rejected = AK_config_fill(d, &snapshot);
+  AK_config_values = snapshot;
+  if (AK_config != NULL)
+    iniparser_AK_freedict(AK_config);
+  AK_config = d;
+  AK_EPI;
+  return rejected ? EXIT_WARNING : EXIT_SUCCESS;
 }
 
 
@@ -1121,6 +1284,53 @@ TestResult AK_iniparser_test(){
         printf("Failed\n\n");
     }
 
+    // test the configuration snapshot
+    printf("\nTesting if the configuration snapshot matches config.ini\n");
+
+    if(strcmp(DB_FILE, iniparser_getstring(AK_config, "general:db_file", "kalashnikov.db")) == 0
+        && MAX_NUM_OF_BLOCKS == iniparser_getint(AK_config, "segments:max_num_of_blocks", 200)
+        && EXTENT_GROWTH_INDEX == iniparser_getdouble(AK_config, "extents:extent_growth_index", 0.2)){
+        succesfulTests++;
+        printf("Success\n\n");
+    }
+    else{
+        failedTests++;
+        printf("Failed\n\n");
+    }
+
+    printf("\nTesting if invalid configuration values are replaced by defaults\n");
+
+    AK_config_snapshot snapshot;
+    iniparser_set(dict_to_test, "segments:max_num_of_blocks", "-5");
+    iniparser_set(dict_to_test, "extents:extent_growth_table", "0");
+    iniparser_set(dict_to_test, "memory:lru_k", "3");
+    int rejected = AK_config_fill(dict_to_test, &snapshot);
+
+    if(rejected == 2 && snapshot.max_num_of_blocks == 200 && snapshot.extent_growth_table == 0.5
+        && snapshot.lru_k == 3 && strcmp(snapshot.db_file, "kalashnikov.db") == 0){
+        succesfulTests++;
+        printf("Success\n\n");
+    }
+    else{
+        failedTests++;
+        printf("Failed\n\n");
+    }
+
+    printf("\nTesting if the configuration can be reloaded\n");
+
+    char db_file[MAX_CONFIG_VALUE];
+    strcpy(db_file, DB_FILE);
+    int cache_size = CACHE_SIZE;
+
+    if(AK_reload_config() == EXIT_SUCCESS && strcmp(db_file, DB_FILE) == 0 && cache_size == CACHE_SIZE){
+        succesfulTests++;
+        printf("Success\n\n");
+    }
+    else{
+        failedTests++;
+        printf("Failed\n\n");
+    }
+
     //cleaning dictionary
     iniparser_AK_freedict(dict_to_test);
 	AK_EPI;
@@ -1044,6 +1044,153 @@ size_t AK_fread(void *buf, size_t size, size_t count, FILE *fp) {
     return ret;
 }
 
+/**
+* @def AK_ARENA_HEADER
+* @brief Size of the chunk header rounded up to AK_ARENA_ALIGN
+*/
+#define AK_ARENA_HEADER ((sizeof(AK_arena_chunk) + AK_ARENA_ALIGN - 1) & ~((size_t)AK_ARENA_ALIGN - 1))
+
+/**
+* @author agent
+* @param size bytes the chunk has to hold
+* @brief Allocates an empty arena chunk [private function]
+* @return chunk or NULL
+*/
+static AK_arena_chunk* AK_arena_new_chunk(size_t size){
+    AK_arena_chunk *chunk = (AK_arena_chunk*) AK_malloc(AK_ARENA_HEADER + size);
+    if (chunk == NULL){
+        return NULL;
+    }
+    chunk->next = NULL;
+    chunk->size = size;
+    chunk->used = 0;
+    return chunk;
+}
+
+/**
+* @author agent
+* @param chunk_size size of one chunk in bytes, 0 for AK_ARENA_CHUNK_SIZE
+* @brief Creates an empty arena [public function]
+* @return arena or NULL
+*/
+AK_arena* AK_arena_create(size_t chunk_size){
+    AK_arena *arena = (AK_arena*) AK_malloc(sizeof(AK_arena));
+    if (arena == NULL){
+        return NULL;
+    }
+    arena->chunk_size = chunk_size > 0 ? chunk_size : AK_ARENA_CHUNK_SIZE;
+    arena->first = arena->current = AK_arena_new_chunk(arena->chunk_size);
+    if (arena->first == NULL){
+        AK_free(arena);
+        return NULL;
+    }
+    arena->used = 0;
+    arena->peak = 0;
+    arena->reserved = arena->chunk_size;
+    return arena;
+}
+
+/**
+* @author agent
+* @param arena arena
+* @param size of memory to allocate in bytes
+* @brief Allocates memory from an arena, aligned to AK_ARENA_ALIGN. The chunks left from before a reset are
+* reused in order, a request larger than a chunk gets a chunk of its own [public function]
+* @return allocated memory or NULL
+*/
+void* AK_arena_alloc(AK_arena* arena, size_t size){
+    AK_arena_chunk *chunk, *fresh;
+    void *memory;
+
+    if (arena == NULL){
+        return NULL;
+    }
+    size = (size + AK_ARENA_ALIGN - 1) & ~((size_t)AK_ARENA_ALIGN - 1);
+    chunk = arena->current;
+    while (chunk->used + size > chunk->size){
+        if (chunk->next != NULL && size <= chunk->next->size){
+            chunk = chunk->next;
+            chunk->used = 0;
+            continue;
+        }
+        fresh = AK_arena_new_chunk(size > arena->chunk_size ? size : arena->chunk_size);
+        if (fresh == NULL){
+            return NULL;
+        }
+        fresh->next = chunk->next;
+        chunk->next = fresh;
+        arena->reserved += fresh->size;
+        chunk = fresh;
+    }
+    arena->current = chunk;
+    memory = (char*) chunk + AK_ARENA_HEADER + chunk->used;
+    chunk->used += size;
+    arena->used += size;
+    if (arena->used > arena->peak){
+        arena->peak = arena->used;
+    }
+    return memory;
+}
+
+/**
+* @author agent
+* @param arena arena
+* @param num number of elements
+* @param size of element in bytes
+* @brief Allocates zeroed memory from an arena [public function]
+* @return allocated memory or NULL
+*/
+void* AK_arena_calloc(AK_arena* arena, size_t num, size_t size){
+    void *memory = AK_arena_alloc(arena, num * size);
+    if (memory != NULL){
+        memset(memory, 0, num * size);
+    }
+    return memory;
+}
+
+/**
+* @author agent
+* @param arena arena
+* @brief Releases all allocations of an arena at once, the chunks are kept for reuse [public function]
+* @return void
+*/
+void AK_arena_reset(AK_arena* arena){
+    if (arena == NULL){
+        return;
+    }
+    arena->current = arena->first;
+    arena->first->used = 0;
+    arena->used = 0;
+}
+
+/**
+* @author agent
+* @param arena arena
+* @brief Frees an arena with all of its chunks [public function]
+* @return void
+*/
+void AK_arena_destroy(AK_arena* arena){
+    AK_arena_chunk *chunk, *next;
+    if (arena == NULL){
+        return;
+    }
+    for (chunk = arena->first; chunk != NULL; chunk = next){
+        next = chunk->next;
+        AK_free(chunk);
+    }
+    AK_free(arena);
+}
+
+/**
+* @author agent
+* @param arena arena
+* @brief Returns the peak usage of an arena [public function]
+* @return largest number of bytes handed out between two resets
+*/
+size_t AK_arena_peak(AK_arena* arena){
+    return arena == NULL ? 0 : arena->peak;
+}
+
 #if 0
 /* Dummy versions of wrapper functions */
 void* AK_calloc(size_t num, size_t size) { return calloc(num, size); }
@@ -1120,6 +1267,35 @@ void AK_mempro_test()
         failed_test++;
     }
 
+    printf("\nArena test\nAllocate from an arena, reset it and allocate again\n");
+    AK_arena *arena = AK_arena_create(256);
+    char *a_1 = AK_arena_alloc(arena, 10);
+    char *a_2 = AK_arena_calloc(arena, 3, 10);
+    char *a_big = AK_arena_alloc(arena, 1000);
+    if(arena != NULL && a_1 != NULL && a_2 != NULL && a_big != NULL
+        && ((uintptr_t) a_2 % AK_ARENA_ALIGN) == 0 && a_2 >= a_1 + 10 && a_2[29] == 0
+        && AK_arena_peak(arena) >= 10 + 30 + 1000) {
+        memset(a_big, 'x', 1000);
+        strcpy(a_1, "arena");
+        printf("SUCCESS\n");
+        passed_test++;
+    } else {
+        printf("FAIL\n");
+        failed_test++;
+    }
+
+    size_t peak = AK_arena_peak(arena);
+    AK_arena_reset(arena);
+    if(arena != NULL && AK_arena_alloc(arena, 10) == a_1 && arena->used == AK_ARENA_ALIGN
+        && AK_arena_peak(arena) == peak && AK_arena_alloc(arena, 1000) == a_big) {
+        printf("SUCCESS\n");
+        passed_test++;
+    } else {
+        printf("FAIL\n");
+        failed_test++;
+    }
+    AK_arena_destroy(arena);
+
     printf("\nSUMMARY:\n");
     printf("Number of test that pass: %i\n", passed_test);
     printf("Number of test that fail: %i\n", failed_test);
@@ -244,6 +244,54 @@ void* AK_debmod_calloc(AK_debmod_state*, uint32_t);
 void AK_debmod_free(AK_debmod_state*, void*);
 
 
+/**
+  * @def AK_ARENA_CHUNK_SIZE
+  * @brief Default size in bytes of one arena chunk
+  */
+#define AK_ARENA_CHUNK_SIZE 16384
+
+/**
+  * @def AK_ARENA_ALIGN
+  * @brief Alignment of every arena allocation
+  */
+#define AK_ARENA_ALIGN 16
+
+/**
+* @author agent
+* @struct AK_arena_chunk
+* @brief One block of arena memory, the allocations follow the chunk header
+*/
+typedef struct AK_arena_chunk {
+    /// next chunk of the arena
+    struct AK_arena_chunk *next;
+    /// bytes available in the chunk
+    size_t size;
+    /// bytes handed out from the chunk
+    size_t used;
+} AK_arena_chunk;
+
+/**
+* @author agent
+* @struct AK_arena
+* @brief Region allocator for scratch memory of one operator or query. Allocations are taken from chunks with a
+* pointer bump and are never freed one by one; reset releases all of them at once and keeps the chunks for reuse.
+* An arena is meant to be used by one thread, so it needs no lock.
+*/
+typedef struct {
+    /// first chunk
+    AK_arena_chunk *first;
+    /// chunk allocations are currently taken from
+    AK_arena_chunk *current;
+    /// size of a new chunk
+    size_t chunk_size;
+    /// bytes handed out since the last reset
+    size_t used;
+    /// largest value of used since the arena was created
+    size_t peak;
+    /// bytes held in chunks
+    size_t reserved;
+} AK_arena;
+
 /**
 * @author Marin Rukavina, Mislav Bozicevic
 * @param num number of elements
@@ -413,6 +461,57 @@ void AK_print_function_uses();
 */
 void AK_print_active_functions();
 
+/**
+* @author agent
+* @param chunk_size size of one chunk in bytes, 0 for AK_ARENA_CHUNK_SIZE
+* @brief Creates an empty arena [public function]
+* @return arena or NULL
+*/
+AK_arena* AK_arena_create(size_t);
+
+/**
+* @author agent
+* @param arena arena
+* @param size of memory to allocate in bytes
+* @brief Allocates memory from an arena, aligned to AK_ARENA_ALIGN [public function]
+* @return allocated memory or NULL
+*/
+void* AK_arena_alloc(AK_arena*, size_t);
+
+/**
+* @author agent
+* @param arena arena
+* @param num number of elements
+* @param size of element in bytes
+* @brief Allocates zeroed memory from an arena [public function]
+* @return allocated memory or NULL
+*/
+void* AK_arena_calloc(AK_arena*, size_t, size_t);
+
+/**
+* @author agent
+* @param arena arena
+* @brief Releases all allocations of an arena at once, the chunks are kept for reuse [public function]
+* @return void
+*/
+void AK_arena_reset(AK_arena*);
+
+/**
+* @author agent
+* @param arena arena
+* @brief Frees an arena with all of its chunks [public function]
+* @return void
+*/
+void AK_arena_destroy(AK_arena*);
+
+/**
+* @author agent
+* @param arena arena
+* @brief Returns the peak usage of an arena [public function]
+* @return largest number of bytes handed out between two resets
+*/
+size_t AK_arena_peak(AK_arena*);
+
 void AK_mempro_test();
 
 #endif
@@ -28,11 +28,15 @@
 pthread_mutex_t fileLockMutex = PTHREAD_MUTEX_INITIALIZER;
 
 PtrContainer db;
+int db_fd = -1;
 unsigned int db_file_size;
 PtrContainer AK_allocationbit;
 PtrContainer AK_block_activity_info;
 PtrContainer dbmanFileLock;
 
+static ssize_t AK_pread_full(int fd, void *buf, size_t count, off_t offset);
+static ssize_t AK_pwrite_full(int fd, const void *buf, size_t count, off_t offset);
+
 /**
 * @author Markus Schatten
 * @brief  Function that initializes a new database file named DB_FILE. It opens database file. New block is allocated. In this
@@ -80,7 +84,10 @@ AK_init_db_file(int size)
 	   "\nPlease be patient, this can take several minutes depending "
 	   "on disk performance.\n");
 
-    if(AK_allocate_blocks(db.ptr, AK_init_block(), 0, MAX_BLOCK_INIT_NUM) != EXIT_SUCCESS)
+    fclose(db.ptr);
+    db.ptr = NULL;
+
+    if(AK_allocate_blocks(AK_init_block(), 0, MAX_BLOCK_INIT_NUM) != EXIT_SUCCESS)
       {
         printf("AK_init_db_file: ERROR. Problem with blocks allocation %s.\n", DB_FILE);
         AK_EPI;
@@ -424,7 +431,7 @@ int
 AK_blocktable_flush()
 {
   AK_PRO;
-  if ((db.ptr = fopen(DB_FILE, "rb+")) == NULL)
+  if (AK_open_db_file() == EXIT_ERROR)
     {
       printf("AK_allocationbit: ERROR. Cannot open db file %s.\n", DB_FILE);
       AK_EPI;
@@ -433,16 +440,15 @@ AK_blocktable_flush()
 
   pthread_mutex_lock(&fileLockMutex);
   
-  if (AK_fwrite(AK_allocationbit.ptr, AK_ALLOCATION_TABLE_SIZE, 1, db.ptr) != 1)
+  if (AK_pwrite_full(db_fd, AK_allocationbit.ptr, AK_ALLOCATION_TABLE_SIZE, 0) != AK_ALLOCATION_TABLE_SIZE)
     {
+      pthread_mutex_unlock(&fileLockMutex);
       printf("AK_allocationbit: ERROR. Cannot write bit vector \n");
       AK_EPI;
       exit(EXIT_ERROR);
     }
   pthread_mutex_unlock(&fileLockMutex);
 
-  fclose(db.ptr);
-  db.ptr = NULL;
   AK_EPI;
   
   return(EXIT_SUCCESS);
@@ -494,7 +500,7 @@ int
 AK_blocktable_get()
 {
   AK_PRO;
-  if ((db.ptr = fopen(DB_FILE, "rb+")) == NULL)
+  if (AK_open_db_file() == EXIT_ERROR)
     {
       printf("AK_allocationbit: ERROR. Cannot open db file %s.\n", DB_FILE);
       AK_EPI;
@@ -503,16 +509,14 @@ AK_blocktable_get()
 
   pthread_mutex_lock(&fileLockMutex);
   
-  if (AK_fread(AK_allocationbit.ptr, AK_ALLOCATION_TABLE_SIZE, 1, db.ptr) == 0)
+  if (AK_pread_full(db_fd, AK_allocationbit.ptr, AK_ALLOCATION_TABLE_SIZE, 0) != AK_ALLOCATION_TABLE_SIZE)
     {
+      pthread_mutex_unlock(&fileLockMutex);
       printf("AK_allocationbit:  Cannot read bit-vector %d.\n", AK_ALLOCATION_TABLE_SIZE);
       AK_EPI;
       exit(EXIT_ERROR);
     }
   pthread_mutex_unlock(&fileLockMutex);
-  
-  fclose(db.ptr);
-  db.ptr = NULL;
 
   AK_EPI;
   return (EXIT_SUCCESS);
@@ -550,7 +554,373 @@ fsize(FILE *fp)
   return sizeInBytes;
 }
 
+/**
+ * @author agent
+ * @brief  Function that opens the DB file descriptor used for block I/O. The descriptor is opened only once and
+ * kept for the whole process; subsequent calls are no-ops.
+ * @return EXIT_SUCCESS if the descriptor is open, EXIT_ERROR otherwise
+ */
+int
+AK_open_db_file()
+{
+  AK_PRO;
+  pthread_mutex_lock(&fileLockMutex);
+  if (db_fd == -1)
+    {
+      db_fd = open(DB_FILE, O_RDWR);
+      if (db_fd == -1)
+	{
+	  pthread_mutex_unlock(&fileLockMutex);
+	  printf("AK_open_db_file: ERROR. Cannot open db file %s: %s\n", DB_FILE, strerror(errno));
+	  AK_EPI;
+	  return EXIT_ERROR;
+	}
+    }
+  pthread_mutex_unlock(&fileLockMutex);
+  AK_EPI;
+  return EXIT_SUCCESS;
+}
+
+/**
+ * @author agent
+ * @brief  Function that closes the DB file descriptor opened by AK_open_db_file
+ * @return nothing
+ */
+void
+AK_close_db_file()
+{
+  AK_PRO;
+  pthread_mutex_lock(&fileLockMutex);
+  if (db_fd != -1)
+    {
+      close(db_fd);
+      db_fd = -1;
+    }
+  pthread_mutex_unlock(&fileLockMutex);
+  AK_EPI;
+}
+
+/**
+ * @author agent
+ * @brief  Helper function that reads count bytes at a given offset of a file. Reading is repeated
+ * until everything is read, so short reads and interrupted calls are handled.
+ * @param fd file descriptor (db_fd for the DB file)
+ * @param buf buffer to read into
+ * @param count number of bytes to read
+ * @param offset offset in the file
+ * @return number of bytes read (less than count on end of file), -1 on error
+ */
+static ssize_t
+AK_pread_full(int fd, void *buf, size_t count, off_t offset)
+{
+  size_t done = 0;
+  ssize_t ret;
+
+  while (done < count)
+    {
+      ret = pread(fd, (char *)buf + done, count - done, offset + done);
+      if (ret == -1)
+	{
+	  if (errno == EINTR)
+	    continue;
+	  return -1;
+	}
+      if (ret == 0)
+	break;
+      done += ret;
+    }
+  return done;
+}
+
+/**
+ * @author agent
+ * @brief  Helper function that writes count bytes at a given offset of a file. Writing is repeated
+ * until everything is written, so short writes and interrupted calls are handled.
+ * @param fd file descriptor (db_fd for the DB file)
+ * @param buf buffer to write from
+ * @param count number of bytes to write
+ * @param offset offset in the file
+ * @return number of bytes written, -1 on error
+ */
+static ssize_t
+AK_pwrite_full(int fd, const void *buf, size_t count, off_t offset)
+{
+  size_t done = 0;
+  ssize_t ret;
+
+  while (done < count)
+    {
+      ret = pwrite(fd, (const char *)buf + done, count - done, offset + done);
+      if (ret == -1)
+	{
+	  if (errno == EINTR)
+	    continue;
+	  return -1;
+	}
+      done += ret;
+    }
+  return done;
+}
+
+
+
+/// sanity check: a page has to fit into AK_PAGE_SIZE bytes
+typedef char AK_page_fits[(sizeof(AK_page) <= AK_PAGE_SIZE) ? 1 : -1];
+
+/**
+ * @author agent
+ * @var AK_db_schemas
+ * @brief Schema store of the DB file, opened by AK_init_allocation_table
+ */
+static AK_schema_store AK_db_schemas = { -1 };
+
+/**
+ * @author agent
+ * @brief  Function that computes the hash bucket of a header. Only the attribute types and names are hashed,
+ * headers with the same hash are told apart by comparing them.
+ * @param header header of a block (MAX_ATTRIBUTES attributes)
+ * @return bucket number
+ */
+static int
+AK_schema_bucket(AK_header *header)
+{
+  unsigned int hash = 5381;
+  int i, j;
+
+  for (i = 0; i < MAX_ATTRIBUTES; i++)
+    {
+      hash = hash * 33 + (unsigned int)header[i].type;
+      for (j = 0; j < MAX_ATT_NAME && header[i].att_name[j] != '\0'; j++)
+	hash = hash * 33 + (unsigned char)header[i].att_name[j];
+    }
+  return hash % AK_SCHEMA_BUCKETS;
+}
+
+/**
+ * @author agent
+ * @brief  Function that makes room for one more header in the schema store. Must be called with the store lock held.
+ * @param store schema store
+ * @return EXIT_SUCCESS if there is room, EXIT_ERROR otherwise
+ */
+static int
+AK_schema_store_grow(AK_schema_store *store)
+{
+  void *records, *next;
+  int capacity;
+
+  if (store->count < store->capacity)
+    return EXIT_SUCCESS;
+
+  capacity = store->capacity == 0 ? 16 : 2 * store->capacity;
+  records = AK_realloc(store->records, capacity * sizeof(store->records[0]));
+  if (records == NULL)
+    return EXIT_ERROR;
+  store->records = records;
+  next = AK_realloc(store->next, capacity * sizeof(int));
+  if (next == NULL)
+    return EXIT_ERROR;
+  store->next = next;
+  store->capacity = capacity;
+  return EXIT_SUCCESS;
+}
+
+/**
+ * @author agent
+ * @brief  Function that opens the schema store of a DB file and loads the stored headers into memory.
+ * @param store schema store to open
+ * @param db_file_name name of the DB file, the headers are kept in db_file_name followed by ".schema"
+ * @param truncate 1 if the stored headers should be discarded (new DB file), 0 otherwise
+ * @return EXIT_SUCCESS if the store has been opened, EXIT_ERROR otherwise
+ */
+int
+AK_schema_store_open(AK_schema_store *store, const char *db_file_name, int truncate)
+{
+  char file_name[MAX_CONFIG_VALUE + 8];
+  struct stat stats;
+  int i, bucket;
+  AK_PRO;
+
+  if (store->fd != -1)
+    AK_schema_store_close(store);
+  memset(store, 0, sizeof(AK_schema_store));
+  pthread_mutex_init(&store->lock, NULL);
+  for (i = 0; i < AK_SCHEMA_BUCKETS; i++)
+    store->buckets[i] = -1;
+
+  snprintf(file_name, sizeof(file_name), "%s.schema", db_file_name);
+  store->fd = open(file_name, O_RDWR | O_CREAT | (truncate ? O_TRUNC : 0), 0644);
+  if (store->fd == -1 || fstat(store->fd, &stats) == -1)
+    {
+      printf("AK_schema_store_open: ERROR. Cannot open schema file %s: %s\n", file_name, strerror(errno));
+      if (store->fd != -1)
+	close(store->fd);
+      store->fd = -1;
+      AK_EPI;
+      return EXIT_ERROR;
+    }
+
+  for (i = 0; i < stats.st_size / (off_t)sizeof(store->records[0]); i++)
+    {
+      if (AK_schema_store_grow(store) == EXIT_ERROR
+	  || AK_pread_full(store->fd, store->records[i], sizeof(store->records[0]), (off_t)i * sizeof(store->records[0])) != sizeof(store->records[0]))
+	{
+	  printf("AK_schema_store_open: ERROR. Cannot read header %d of %s\n", i, file_name);
+	  AK_schema_store_close(store);
+	  AK_EPI;
+	  return EXIT_ERROR;
+	}
+      bucket = AK_schema_bucket(store->records[i]);
+      store->next[i] = store->buckets[bucket];
+      store->buckets[bucket] = i;
+      store->count++;
+    }
+
+  AK_EPI;
+  return EXIT_SUCCESS;
+}
+
+/**
+ * @author agent
+ * @brief  Function that closes a schema store and frees the headers kept in memory
+ * @param store schema store to close
+ * @return nothing
+ */
+void
+AK_schema_store_close(AK_schema_store *store)
+{
+  AK_PRO;
+  if (store->fd != -1)
+    close(store->fd);
+  AK_free(store->records);
+  AK_free(store->next);
+  store->fd = -1;
+  store->records = NULL;
+  store->next = NULL;
+  store->count = store->capacity = 0;
+  AK_EPI;
+}
+
+/**
+ * @author agent
+ * @brief  Function that returns the id of a header in the schema store. A header which is not stored yet is
+ * appended to the schema file.
+ * @param store schema store
+ * @param header header of a block (MAX_ATTRIBUTES attributes)
+ * @return id of the header, EXIT_ERROR if it could not be stored
+ */
+int
+AK_schema_store_put(AK_schema_store *store, AK_header *header)
+{
+  int id, bucket;
+  AK_PRO;
+
+  bucket = AK_schema_bucket(header);
+  pthread_mutex_lock(&store->lock);
+  if (store->fd == -1)
+    {
+      pthread_mutex_unlock(&store->lock);
+      printf("AK_schema_store_put: ERROR. Schema store is not open.\n");
+      AK_EPI;
+      return EXIT_ERROR;
+    }
+  for (id = store->buckets[bucket]; id != -1; id = store->next[id])
+    if (memcmp(store->records[id], header, sizeof(store->records[0])) == 0)
+      break;
+
+  if (id == -1)
+    {
+      id = store->count;
+      if (AK_schema_store_grow(store) == EXIT_ERROR
+	  || AK_pwrite_full(store->fd, header, sizeof(store->records[0]), (off_t)id * sizeof(store->records[0])) != sizeof(store->records[0]))
+	{
+	  pthread_mutex_unlock(&store->lock);
+	  printf("AK_schema_store_put: ERROR. Cannot store header %d: %s\n", id, strerror(errno));
+	  AK_EPI;
+	  return EXIT_ERROR;
+	}
+      memcpy(store->records[id], header, sizeof(store->records[0]));
+      store->next[id] = store->buckets[bucket];
+      store->buckets[bucket] = id;
+      store->count++;
+    }
+  pthread_mutex_unlock(&store->lock);
+
+  AK_EPI;
+  return id;
+}
+
+/**
+ * @author agent
+ * @brief  Function that copies a stored header
+ * @param store schema store
+ * @param id id of the header returned by AK_schema_store_put
+ * @param header destination (MAX_ATTRIBUTES attributes)
+ * @return EXIT_SUCCESS if the header exists, EXIT_ERROR otherwise
+ */
+int
+AK_schema_store_get(AK_schema_store *store, int id, AK_header *header)
+{
+  AK_PRO;
+  pthread_mutex_lock(&store->lock);
+  if (id < 0 || id >= store->count)
+    {
+      pthread_mutex_unlock(&store->lock);
+      printf("AK_schema_store_get: ERROR. There is no header %d.\n", id);
+      AK_EPI;
+      return EXIT_ERROR;
+    }
+  memcpy(header, store->records[id], sizeof(store->records[0]));
+  pthread_mutex_unlock(&store->lock);
+  AK_EPI;
+  return EXIT_SUCCESS;
+}
+
+/**
+ * @author agent
+ * @brief  Function that converts a block into the page stored in the DB file
+ * @param store schema store receiving the block header
+ * @param block block to convert
+ * @param page destination page
+ * @return EXIT_SUCCESS if successful, EXIT_ERROR otherwise
+ */
+static int
+AK_block_to_page(AK_schema_store *store, AK_block *block, AK_page *page)
+{
+  page->schema_id = AK_schema_store_put(store, block->header);
+  if (page->schema_id == EXIT_ERROR)
+    return EXIT_ERROR;
+  page->address = block->address;
+  page->type = block->type;
+  page->chained_with = block->chained_with;
+  page->AK_free_space = block->AK_free_space;
+  page->last_tuple_dict_id = block->last_tuple_dict_id;
+  memcpy(page->tuple_dict, block->tuple_dict, sizeof(page->tuple_dict));
+  memcpy(page->data, block->data, sizeof(page->data));
+  return EXIT_SUCCESS;
+}
 
+/**
+ * @author agent
+ * @brief  Function that converts a page read from the DB file into a block
+ * @param store schema store holding the block header
+ * @param page page to convert
+ * @param block destination block
+ * @return EXIT_SUCCESS if successful, EXIT_ERROR otherwise
+ */
+static int
+AK_page_to_block(AK_schema_store *store, AK_page *page, AK_block *block)
+{
+  if (AK_schema_store_get(store, page->schema_id, block->header) == EXIT_ERROR)
+    return EXIT_ERROR;
+  block->address = page->address;
+  block->type = page->type;
+  block->chained_with = page->chained_with;
+  block->AK_free_space = page->AK_free_space;
+  block->last_tuple_dict_id = page->last_tuple_dict_id;
+  memcpy(block->tuple_dict, page->tuple_dict, sizeof(block->tuple_dict));
+  memcpy(block->data, page->data, sizeof(block->data));
+  return EXIT_SUCCESS;
+}
 
 /**
  * @author dv
@@ -584,6 +954,8 @@ AK_init_allocation_table() {
       BITCLEAR(allocationBit->bittable, i);
       allocationBit->allocationtable[i] = 0xFFFFFFFF;	    
     }
+    allocationBit->magic            = AK_DB_FORMAT_MAGIC;
+    allocationBit->format_version   = AK_DB_FORMAT_VERSION;
     allocationBit->last_allocated   = 0;
     allocationBit->last_initialized = 0;
     allocationBit->prepared         = 0;
@@ -599,12 +971,24 @@ AK_init_allocation_table() {
     printf("AK_allocationbit:  Cannot read bit-vector %d.\n", AK_ALLOCATION_TABLE_SIZE);
     AK_EPI;
     exit(EXIT_ERROR);
+  } else if (((AK_blocktable *)AK_allocationbit.ptr)->magic != AK_DB_FORMAT_MAGIC
+	     || ((AK_blocktable *)AK_allocationbit.ptr)->format_version != AK_DB_FORMAT_VERSION) {
+    printf("AK_allocationbit: ERROR. %s is not a version %d DB file. Convert it with: akdb migrate %s <new file>\n",
+	   DB_FILE, AK_DB_FORMAT_VERSION, DB_FILE);
+    AK_EPI;
+    exit(EXIT_ERROR);
   }
 
   fclose(db.ptr);
   db.ptr = NULL;
   pthread_mutex_unlock(&fileLockMutex);
 
+  // headers of blocks are kept in the schema store, a new DB file starts with an empty one
+  if (AK_schema_store_open(&AK_db_schemas, DB_FILE, fileSizeBytes == 0) == EXIT_ERROR) {
+    AK_EPI;
+    exit(EXIT_ERROR);
+  }
+
   AK_EPI;
   return (EXIT_SUCCESS);
 
@@ -921,46 +1305,49 @@ AK_print_block(AK_block * block, int num, char* gg, FILE *fpp)
 * @author Markus Schatten , rearranged by dv
 * @brief  Function that allocates new blocks by placing them to appropriate place
 * and then updates the last initialized index
+* @param block block used as a template for all allocated blocks
+* @param FromWhere address of the first block to allocate
+* @param HowMany number of blocks to allocate
 * @return EXIT_SUCCESS if the file has been written to disk, EXIT_ERROR otherwise
 */
 int
-AK_allocate_blocks(FILE* db, AK_block * block, int FromWhere, int HowMany)
+AK_allocate_blocks(AK_block * block, int FromWhere, int HowMany)
 {
   register int i = 0;
+  AK_page *page;
   AK_PRO;
-  if (db == NULL)
+  if (AK_open_db_file() == EXIT_ERROR)
     {
-      if ((db = fopen(DB_FILE, "rb+")) == NULL)
-	{
-	  printf("AK_init_db_file: ERROR. Cannot open db file %s.\n", DB_FILE);
-	  AK_EPI;
-	  return EXIT_ERROR;
-	} 
+      printf("AK_init_db_file: ERROR. Cannot open db file %s.\n", DB_FILE);
+      AK_EPI;
+      return EXIT_ERROR;
     }
-    
-    pthread_mutex_lock(&fileLockMutex);
-    if (fseek(db, AK_ALLOCATION_TABLE_SIZE + FromWhere * sizeof(AK_block), SEEK_SET) != 0)
+
+    page = (AK_page *)AK_malloc(sizeof(AK_page));
+    if (AK_block_to_page(&AK_db_schemas, block, page) == EXIT_ERROR)
       {
-	printf("AK_allocationbit: ERROR. Cannot set position to move for AK_blocktable \n");
+	AK_free(page);
 	AK_EPI;
-	return EXIT_ERROR;      
+	return EXIT_ERROR;
       }
     
+    pthread_mutex_lock(&fileLockMutex);
     for (i = FromWhere; i < FromWhere + HowMany; i++)
       {
-        block->address = i;
+        block->address = page->address = i;
 	
-        if (AK_fwrite(block, sizeof (*block), 1, db) != 1)
+        if (AK_pwrite_full(db_fd, page, sizeof (*page), (off_t)i * AK_PAGE_SIZE + AK_ALLOCATION_TABLE_SIZE) != sizeof (*page))
 	  {
+	    pthread_mutex_unlock(&fileLockMutex);
+	    AK_free(page);
 	    printf("AK_init_db_file: ERROR. Cannot write block %d\n", i);
 	    AK_EPI;
 	    return EXIT_ERROR;
 	  }
       }
     pthread_mutex_unlock(&fileLockMutex);
+    AK_free(page);
 
-    fclose(db);
-    db = NULL;
     AK_blocktable* const allocationBit = AK_allocationbit.ptr;
     allocationBit->last_initialized = i;
     AK_allocate_block_activity_modes();
@@ -998,10 +1385,11 @@ int test_threadSafeBlockAccessSucceeded = 1;
 /**
  * @author Markus Schatten, updated by dv and Domagoj Šitum (thread-safe enabled)
  * @brief  Function that reads a block at a given address (block number less than db_file_size).
- * New block is allocated. Database file is opened. Position is set to provided address block.
- * At the end function reads file from that position. Completely thread-safe.
+ * New block is allocated and its page is read from the persistent DB file descriptor with a single positioned
+ * read (pread) at address * AK_PAGE_SIZE + AK_ALLOCATION_TABLE_SIZE. The block header is copied from the
+ * schema store. Completely thread-safe.
  * @param address block number (address)
- * @return pointer to block allocated in memory
+ * @return pointer to block allocated in memory, NULL if the block is out of range or cannot be fully read
  */
 AK_block*
 AK_read_block(int address)
@@ -1011,20 +1399,21 @@ AK_read_block(int address)
   int true = 1, false = 0;
   int locked_for_writing, locked_for_reading;
   int thread_id;
+  ssize_t bytes_read;
+  AK_page page;
     
   if (DB_FILE_BLOCKS_NUM < address || 0 > address)
     {
       printf("AK_read_block: ERROR. Out of range %s  address:%d  DB_FILE_BLOCKS_NUM:%d\n", DB_FILE, address, DB_FILE_BLOCKS_NUM);
       AK_EPI;
-      exit(EXIT_ERROR);
+      return NULL;
     }
     
-  FILE * database;
-  if ((database = fopen(DB_FILE, "rb")) == NULL)
+  if (AK_open_db_file() == EXIT_ERROR)
     {
       printf("AK_read_block: ERROR. Cannot open db file %s.\n", DB_FILE);
       AK_EPI;
-      exit(EXIT_ERROR);
+      return NULL;
     } 
 
   AK_block_activity* const activityInfo = AK_block_activity_info.ptr;
@@ -1053,25 +1442,26 @@ AK_read_block(int address)
       activityInfo[address].locked_for_reading = true;
     }
     
-  // now we can safely write block to the disk
-    
-  // first we have to set position in file for reading new block
-  if (fseek(database, address * sizeof(AK_block)+AK_ALLOCATION_TABLE_SIZE, SEEK_SET) != 0)
-    {
-      printf("AK_read_block: ERROR. Cannot set position to provided address block %d.\n", address);
-      AK_EPI;
-      exit(EXIT_ERROR);
-    }
   //ERROR: a value of type "void *" cannot be used to initialize an entity of type "AK_block *"   
   AK_block * block = AK_malloc(sizeof(AK_block));
 
-  // then we simply read block from the disk
-  if (AK_fread(block, sizeof(AK_block), 1, database) == 0)
+  // now we can safely read the page from the disk with one positioned read
+  // and fill in the header from the schema store
+  bytes_read = AK_pread_full(db_fd, &page, sizeof(AK_page), (off_t)address * AK_PAGE_SIZE + AK_ALLOCATION_TABLE_SIZE);
+  if (bytes_read != sizeof(AK_page))
     {
-      printf("AK_read_block: ERROR. Cannot read block %d.\n", address);
-	  AK_free(block);
-      AK_EPI;
-      exit(EXIT_ERROR);
+      if (bytes_read == -1)
+	printf("AK_read_block: ERROR. Cannot read block %d: %s\n", address, strerror(errno));
+      else
+	printf("AK_read_block: ERROR. Short read of block %d (%d of %d bytes).\n", address, (int)bytes_read, (int)sizeof(AK_page));
+      AK_free(block);
+      block = NULL;
+    }
+  else if (AK_page_to_block(&AK_db_schemas, &page, block) == EXIT_ERROR)
+    {
+      printf("AK_read_block: ERROR. Header of block %d is missing.\n", address);
+      AK_free(block);
+      block = NULL;
     }
     
   // block of code below is used only for testing purposes!
@@ -1081,7 +1471,7 @@ AK_read_block(int address)
   // that character is then printed to the stdout. 
   // If everything goes well, we should get the same character that was written here
   // by last writing thread
-  if (testMode == TEST_MODE_ON) {
+  if (testMode == TEST_MODE_ON && block != NULL) {
     int FALSE = 0;
     if (test_lastCharacterWritten != '\0') {
       if (test_lastCharacterWritten != block->data[0]) {
@@ -1100,7 +1490,6 @@ AK_read_block(int address)
   if (activityInfo[address].thread_holding_lock == &thread_id) {
     pthread_mutex_unlock(&activityInfo[address].block_lock);
   }
-  fclose(database);
     
   AK_EPI;
   return block;
@@ -1108,8 +1497,9 @@ AK_read_block(int address)
 
 /**
 * @author Markus Schatten, updated by Domagoj Šitum (thread-safe enabled)
-* @brief  Function that writes a block to the DB file. Database file is opened. Position is set to provided address block. Block is
-  written to provided address. Completely thread-safe.
+* @brief  Function that writes a block to the DB file. Block is written to its address as a page with a single
+  positioned write (pwrite) on the persistent DB file descriptor, the header goes to the schema store.
+  Completely thread-safe.
 * @param block poiner to block allocated in memory to write
 * @return EXIT_SUCCESS if successful, EXIT_ERROR otherwise
 */
@@ -1121,17 +1511,24 @@ AK_write_block(AK_block * block)
   int true = 1, false = 0;
   int locked_for_reading = false, locked_for_writing = false, address;
   int thread_id;
+  int result = EXIT_SUCCESS;
+  AK_page page;
 
-  FILE * database;
-  if ((database = fopen(DB_FILE, "rb+")) == NULL)
+  if (AK_open_db_file() == EXIT_ERROR)
     {
       printf("AK_write_block: ERROR. Cannot open db file %s.\n", DB_FILE);
       AK_EPI;
-      exit(EXIT_ERROR);
+      return EXIT_ERROR;
     }
     
   // first we have to find out block's address
   address = block->address;
+  if (DB_FILE_BLOCKS_NUM < address || 0 > address)
+    {
+      printf("AK_write_block: ERROR. Out of range %s  address:%d  DB_FILE_BLOCKS_NUM:%d\n", DB_FILE, address, DB_FILE_BLOCKS_NUM);
+      AK_EPI;
+      return EXIT_ERROR;
+    }
   
   AK_block_activity* const activityInfo = AK_block_activity_info.ptr;
   pthread_mutex_lock(&activityInfo[address].block_lock);
@@ -1174,22 +1571,13 @@ AK_write_block(AK_block * block)
       test_lastCharacterWritten = block->data[0];
     }
     
-  // now we can safely write it to the disk
-
-  // first we have to set position in file for new block writing
-  if (fseek(database, block->address * sizeof(AK_block)+AK_ALLOCATION_TABLE_SIZE, SEEK_SET) != 0)
-    {
-      printf("AK_write_block: ERROR. Cannot set position to provided address block %d.\n", block->address);
-      AK_EPI;
-      exit(EXIT_ERROR);
-    }
-
-  // then we simply write block to the disk
-  if (AK_fwrite(block, sizeof (*block), 1, database) != 1)
+  // now we can safely write it to the disk with one positioned write
+  if (AK_block_to_page(&AK_db_schemas, block, &page) == EXIT_ERROR)
+    result = EXIT_ERROR;
+  else if (AK_pwrite_full(db_fd, &page, sizeof (page), (off_t)address * AK_PAGE_SIZE + AK_ALLOCATION_TABLE_SIZE) != sizeof (page))
     {
-      printf("AK_write_block: ERROR. Cannot write block at provided address %d.\n", block->address);
-      AK_EPI;
-      exit(EXIT_ERROR);
+      printf("AK_write_block: ERROR. Cannot write block at provided address %d: %s\n", address, strerror(errno));
+      result = EXIT_ERROR;
     }
         
   // after writing is done, we unlock this block for reading and/or writing
@@ -1204,10 +1592,8 @@ AK_write_block(AK_block * block)
       pthread_mutex_unlock(&activityInfo[address].block_lock);
     }
     
-  fclose(database);
-    
   AK_EPI;
-  return (EXIT_SUCCESS);
+  return result;
 }
 
 
@@ -1338,7 +1724,7 @@ AK_get_extent(int start_address, int desired_size, AK_allocation_set_mode* mode,
 	{
 	  //there is no space at current boundaries - try to get more
     AK_blocktable* const allocationBit = AK_allocationbit.ptr;
-	  if (AK_allocate_blocks(NULL, AK_init_block(), allocationBit->last_initialized, desired_size) != EXIT_SUCCESS)
+	  if (AK_allocate_blocks(AK_init_block(), allocationBit->last_initialized, desired_size) != EXIT_SUCCESS)
 	    {
 	      printf("AK_new_extent E1: ERROR. Problem with blocks allocation %s.\n", DB_FILE);
 	      AK_EPI;
@@ -1464,7 +1850,7 @@ AK_increase_extent(int start_address, int add_size, AK_allocation_set_mode* mode
 }
 
 /**
-* @author Nikola Bakoš, updated by Dino Laktašiæ (fixed header BUG), refurbished by dv
+* @author Nikola Bakoš, updated by Dino Laktašiæ (fixed header BUG), refurbished by dv, updated by agent (free space map)
 * @brief  Function that allocates new extent of blocks. If argument "old_size" is 0 than size of extent is INITIAL_EXTENT_SIZE.
 * Otherwise, resize factor is set according to type of extent. If writing of block is successful, number of blocks is
 *         incremented.
@@ -1520,7 +1906,7 @@ AK_new_extent(int start_address, int old_size, int extent_type, AK_header *heade
   AK_blocktable* const allocationBit = AK_allocationbit.ptr;
   if (first_element_of_set == FREE_INT)
   {
-      	if (AK_allocate_blocks(NULL, block = AK_init_block(), allocationBit->last_initialized, requested_space_in_blocks) != EXIT_SUCCESS)
+      	if (AK_allocate_blocks(block = AK_init_block(), allocationBit->last_initialized, requested_space_in_blocks) != EXIT_SUCCESS)
 		{
 	  		AK_free(block);
 	  		printf("AK_new_extent: ERROR. Problem with blocks allocation %s.\n", DB_FILE);
@@ -1556,6 +1942,8 @@ AK_new_extent(int start_address, int old_size, int extent_type, AK_header *heade
       BITSET(allocationBit->bittable, allocation_set[i]);
       if (i < (requested_space_in_blocks - 1))
 	allocationBit->allocationtable[allocation_set[i]] = allocation_set[i + 1];
+      // the blocks are empty now, whatever the free space map knew about them before
+      AK_fsm_set_empty(allocation_set[i]);
     }
   
   allocationBit->allocationtable[allocation_set[i - 1]] = allocation_set[0];
@@ -2545,12 +2933,14 @@ AK_delete_extent(int begin, int end)
       AK_blocktable* const allocationBit = AK_allocationbit.ptr;
       allocationBit->allocationtable[address] = 0xFFFFFFFF;
     }
+  /* the headers of deleted blocks are gone */
+  AK_catalog_invalidate();
   AK_EPI;
   return (EXIT_SUCCESS);
 }
 
 /**
- * @author Mislav Èakariæ, fixed by Josip Susnjara
+ * @author Mislav Èakariæ, fixed by Josip Susnjara, updated by agent (index segments)
  * @param name name of the segment
  * @param type type of the segment
  * @return EXIT_SUCCESS if extent has been successfully deleted, EXIT_ERROR otherwise
@@ -2562,7 +2952,7 @@ AK_delete_segment(char * name, int type)
   table_addresses *addresses;
   AK_PRO;
 
-  addresses = (table_addresses*)AK_get_segment_addresses(name);
+  addresses = (table_addresses*)(type == SEGMENT_TYPE_INDEX ? AK_get_index_segment_addresses(name) : AK_get_segment_addresses(name));
   for (;addresses->address_from[i] != 0; ++i)
     {
       if (AK_delete_extent(addresses->address_from[i], addresses->address_to[i] - 1) == EXIT_ERROR)
@@ -2605,6 +2995,7 @@ AK_delete_segment(char * name, int type)
   AK_Update_Existing_Element(TYPE_VARCHAR, name, system_table, "name", row_root);
   AK_delete_row(row_root);
   AK_free(row_root);
+  AK_catalog_invalidate();
 
   AK_EPI;
   return EXIT_SUCCESS;
@@ -2614,25 +3005,32 @@ AK_delete_segment(char * name, int type)
  * @author Markus Schatten
  * @return Function that calls functions AK_init_db_file() and AK_init_system_catalog() to initialize disk manager.
  * It also calls AK_allocate_array_currently_accessed_blocks() to allocate memory needed for thread-safe reading
- * and writing to disk. 
+ * and writing to disk, and opens the DB file descriptor that is used for all block I/O. 
  */
 int
 AK_init_disk_manager()
 {
-  int size = DB_FILE_BLOCKS_NUM; //1024 * 1024 * size_in_mb / sizeof ( AK_block);
+  int size = DB_FILE_BLOCKS_NUM; //1024 * 1024 * size_in_mb / AK_PAGE_SIZE
   AK_PRO;
   if (AK_init_allocation_table() == EXIT_ERROR)
     {
       AK_EPI;
       exit(EXIT_ERROR);
     }
+
+  // the DB file is opened only once and the descriptor is kept for all further block I/O
+  if (AK_open_db_file() == EXIT_ERROR)
+    {
+      AK_EPI;
+      return EXIT_ERROR;
+    }
     
   AK_allocate_block_activity_modes();
   AK_blocktable* const allocationBit = AK_allocationbit.ptr;
   if (allocationBit->prepared == 31)
     {
       printf("\n\tDisk manager has been initialized at %s\n\n", asctime(localtime(&allocationBit->ltime)));
-      AK_dbg_messg(LOW, DB_MAN, "Block size is: %d\n", sizeof (AK_block));
+      AK_dbg_messg(LOW, DB_MAN, "Block size is: %d\n", AK_PAGE_SIZE);
       AK_dbg_messg(LOW, DB_MAN, "%d blocks for %d MiB\n", size, DB_FILE_SIZE);
 	
       AK_EPI;
@@ -2640,7 +3038,7 @@ AK_init_disk_manager()
     }
 
   printf("AK_init_disk_manager: Initializing disk manager...\n\n");
-  AK_dbg_messg(LOW, DB_MAN, "AK_init_disk_manager: Block size is: %d\n", sizeof (AK_block));
+  AK_dbg_messg(LOW, DB_MAN, "AK_init_disk_manager: Block size is: %d\n", AK_PAGE_SIZE);
   AK_dbg_messg(LOW, DB_MAN, "AK_init_disk_manager: We need %d blocks for %d MiB\n", size, DB_FILE_SIZE);
 
   if (AK_init_db_file(size) == EXIT_SUCCESS)
@@ -2666,6 +3064,139 @@ AK_init_disk_manager()
 }
 
 
+/**
+ * @def DB_FILE_BLOCKS_NUM_V1
+ * @brief Number of entries of the allocation table in a version 1 DB file
+ */
+#define DB_FILE_BLOCKS_NUM_V1 (int)(1024 * 1024 * DB_FILE_SIZE_EX / sizeof(AK_block))
+
+/**
+ * @author agent
+ * @struct AK_blocktable_v1
+ * @brief Allocation table of a version 1 DB file (no format mark, followed by whole AK_block structures)
+ */
+typedef struct {
+    unsigned int allocationtable[DB_FILE_BLOCKS_NUM_V1];
+    unsigned char bittable[BITNSLOTS(DB_FILE_BLOCKS_NUM_V1)];
+    int last_allocated;
+    int last_initialized;
+    int prepared;
+    time_t ltime;
+} AK_blocktable_v1;
+
+/**
+ * @author agent
+ * @brief  Function that copies the blocks of a version 1 DB file into a version 2 DB file
+ * @param source_fd descriptor of the version 1 file
+ * @param destination_fd descriptor of the version 2 file
+ * @param store schema store of the version 2 file
+ * @param last_initialized number of initialized blocks
+ * @return EXIT_SUCCESS if all blocks have been copied, EXIT_ERROR otherwise
+ */
+static int
+AK_migrate_blocks(int source_fd, int destination_fd, AK_schema_store *store, int last_initialized)
+{
+  AK_block *block = (AK_block *)AK_malloc(sizeof(AK_block));
+  AK_page *page = (AK_page *)AK_malloc(sizeof(AK_page));
+  int i, result = EXIT_SUCCESS;
+
+  for (i = 0; i < last_initialized && result == EXIT_SUCCESS; i++)
+    {
+      if (AK_pread_full(source_fd, block, sizeof(AK_block), (off_t)i * sizeof(AK_block) + sizeof(AK_blocktable_v1)) != sizeof(AK_block))
+	{
+	  printf("AK_migrate_db_file: ERROR. Cannot read block %d.\n", i);
+	  result = EXIT_ERROR;
+	}
+      else if (AK_block_to_page(store, block, page) == EXIT_ERROR
+	       || AK_pwrite_full(destination_fd, page, sizeof(AK_page), (off_t)i * AK_PAGE_SIZE + AK_ALLOCATION_TABLE_SIZE) != sizeof(AK_page))
+	{
+	  printf("AK_migrate_db_file: ERROR. Cannot write block %d.\n", i);
+	  result = EXIT_ERROR;
+	}
+    }
+
+  AK_free(block);
+  AK_free(page);
+  return result;
+}
+
+/**
+ * @author agent
+ * @brief  Function that converts a version 1 DB file (every block stored together with its header) into the
+ * current format, where blocks are stored as pages and every distinct header is kept once in the schema
+ * store. The allocation table is carried over, block addresses do not change.
+ * @param source name of the version 1 DB file
+ * @param destination name of the new DB file (the schema store is written to destination followed by ".schema")
+ * @return EXIT_SUCCESS if the file has been converted, EXIT_ERROR otherwise
+ */
+int
+AK_migrate_db_file(char *source, char *destination)
+{
+  AK_blocktable_v1 *old_table;
+  AK_blocktable *table;
+  AK_schema_store store = { -1 };
+  int source_fd, destination_fd, i;
+  int result = EXIT_ERROR;
+  AK_PRO;
+
+  if ((source_fd = open(source, O_RDONLY)) == -1)
+    {
+      printf("AK_migrate_db_file: ERROR. Cannot open %s: %s\n", source, strerror(errno));
+      AK_EPI;
+      return EXIT_ERROR;
+    }
+  if ((destination_fd = open(destination, O_RDWR | O_CREAT | O_TRUNC, 0644)) == -1)
+    {
+      printf("AK_migrate_db_file: ERROR. Cannot create %s: %s\n", destination, strerror(errno));
+      close(source_fd);
+      AK_EPI;
+      return EXIT_ERROR;
+    }
+
+  old_table = (AK_blocktable_v1 *)AK_malloc(sizeof(AK_blocktable_v1));
+  table = (AK_blocktable *)AK_calloc(1, sizeof(AK_blocktable));
+
+  if (AK_pread_full(source_fd, old_table, sizeof(AK_blocktable_v1), 0) != sizeof(AK_blocktable_v1))
+    printf("AK_migrate_db_file: ERROR. %s is not a version 1 DB file.\n", source);
+  else if (old_table->allocationtable[0] == AK_DB_FORMAT_MAGIC)
+    printf("AK_migrate_db_file: ERROR. %s is already a version %d DB file.\n", source, ((AK_blocktable *)old_table)->format_version);
+  else if (old_table->last_initialized < 0 || old_table->last_initialized > DB_FILE_BLOCKS_NUM_V1
+	   || old_table->last_allocated < 0 || old_table->last_allocated > DB_FILE_BLOCKS_NUM_V1)
+    printf("AK_migrate_db_file: ERROR. Allocation table of %s is damaged.\n", source);
+  else if (AK_schema_store_open(&store, destination, 1) == EXIT_SUCCESS)
+    {
+      table->magic = AK_DB_FORMAT_MAGIC;
+      table->format_version = AK_DB_FORMAT_VERSION;
+      for (i = 0; i < DB_FILE_BLOCKS_NUM_EX; i++)
+	{
+	  table->allocationtable[i] = i < DB_FILE_BLOCKS_NUM_V1 ? old_table->allocationtable[i] : 0xFFFFFFFF;
+	  if (i < DB_FILE_BLOCKS_NUM_V1 && BITTEST(old_table->bittable, i))
+	    BITSET(table->bittable, i);
+	}
+      table->last_allocated = old_table->last_allocated;
+      table->last_initialized = old_table->last_initialized;
+      table->prepared = old_table->prepared;
+      table->ltime = old_table->ltime;
+
+      if (AK_migrate_blocks(source_fd, destination_fd, &store, old_table->last_initialized) == EXIT_SUCCESS
+	  && AK_pwrite_full(destination_fd, table, AK_ALLOCATION_TABLE_SIZE, 0) == AK_ALLOCATION_TABLE_SIZE)
+	{
+	  printf("AK_migrate_db_file: %d blocks of %s written to %s (%d distinct headers).\n",
+		 table->last_initialized, source, destination, store.count);
+	  result = EXIT_SUCCESS;
+	}
+      AK_schema_store_close(&store);
+    }
+
+  AK_free(old_table);
+  AK_free(table);
+  close(source_fd);
+  close(destination_fd);
+  AK_EPI;
+  return result;
+}
+
+
 TestResult AK_allocationbit_test()
 {
 	//adding test code
@@ -2725,7 +3256,6 @@ TestResult AK_allocationtable_test()
     int success=0;
     int failed=0;
     int result=AK_allocationtable_dump(1);
-    AK_EPI;
     if(result==EXIT_ERROR)
     {
       failed++;
@@ -2734,6 +3264,72 @@ TestResult AK_allocationtable_test()
     {
       success++;
     }
+
+    //a version 1 file with two copies of the first block and one empty block is converted to pages
+    AK_blocktable_v1 *old_table = (AK_blocktable_v1 *)AK_calloc(1, sizeof(AK_blocktable_v1));
+    AK_blocktable *table = (AK_blocktable *)AK_malloc(sizeof(AK_blocktable));
+    AK_block *blocks[3], *block = (AK_block *)AK_malloc(sizeof(AK_block));
+    AK_schema_store store = { -1 };
+    AK_page page;
+    int fd, i;
+
+    blocks[0] = AK_read_block(0);
+    blocks[1] = (AK_block *)AK_malloc(sizeof(AK_block));
+    memcpy(blocks[1], blocks[0], sizeof(AK_block));
+    blocks[1]->address = 1;
+    blocks[2] = AK_init_block();
+    blocks[2]->address = 2;
+    old_table->last_initialized = 3;
+    old_table->last_allocated = 2;
+    for (i = 0; i < 2; i++)
+    {
+      old_table->allocationtable[i] = i;
+      BITSET(old_table->bittable, i);
+    }
+    fd = open("migrate_test_v1.db", O_RDWR | O_CREAT | O_TRUNC, 0644);
+    AK_pwrite_full(fd, old_table, sizeof(AK_blocktable_v1), 0);
+    for (i = 0; i < 3; i++)
+      AK_pwrite_full(fd, blocks[i], sizeof(AK_block), (off_t)i * sizeof(AK_block) + sizeof(AK_blocktable_v1));
+    close(fd);
+
+    if (AK_migrate_db_file("migrate_test_v1.db", "migrate_test_v2.db") == EXIT_SUCCESS)
+    {
+      fd = open("migrate_test_v2.db", O_RDONLY);
+      AK_pread_full(fd, table, AK_ALLOCATION_TABLE_SIZE, 0);
+      result = table->magic == AK_DB_FORMAT_MAGIC && table->format_version == AK_DB_FORMAT_VERSION
+        && table->last_initialized == 3 && table->last_allocated == 2 && table->allocationtable[1] == 1
+        && BITTEST(table->bittable, 1) && !BITTEST(table->bittable, 2)
+        && AK_schema_store_open(&store, "migrate_test_v2.db", 0) == EXIT_SUCCESS && store.count == 2;
+      for (i = 0; i < 3 && result; i++)
+        result = AK_pread_full(fd, &page, sizeof(AK_page), (off_t)i * AK_PAGE_SIZE + AK_ALLOCATION_TABLE_SIZE) == sizeof(AK_page)
+          && AK_page_to_block(&store, &page, block) == EXIT_SUCCESS
+          && memcmp(block, blocks[i], sizeof(AK_block)) == 0;
+      close(fd);
+      AK_schema_store_close(&store);
+    }
+    else
+      result = 0;
+    if (result && AK_migrate_db_file("migrate_test_v2.db", "migrate_test_v3.db") == EXIT_ERROR)
+    {
+      printf("\nDB file migration: OK\n");
+      success++;
+    }
+    else
+    {
+      printf("\nDB file migration: FAILED\n");
+      failed++;
+    }
+    remove("migrate_test_v1.db");
+    remove("migrate_test_v2.db");
+    remove("migrate_test_v2.db.schema");
+    remove("migrate_test_v3.db");
+    remove("migrate_test_v3.db.schema");
+    for (i = 0; i < 3; i++)
+      AK_free(blocks[i]);
+    AK_free(block);
+    AK_free(old_table);
+    AK_free(table);
+    AK_EPI;
     
     return TEST_result(success,failed);
 }
@@ -104,6 +104,79 @@ typedef struct {
     unsigned char data[DATA_BLOCK_SIZE * DATA_ENTRY_SIZE];
 } AK_block;
 
+/**
+ * @author agent
+ * @struct AK_rid
+ * @brief Structure that identifies a row of a table (RID). A block is a slotted page: slot s of a block holds the
+ * tuple_dict entries s * num_attr to s * num_attr + num_attr - 1 of one row, so a row keeps its (block, slot)
+ * until it is deleted. A deleted slot can be reused by a later insert.
+ */
+typedef struct {
+    /// address of the block
+    int block;
+    /// slot inside the block
+    int slot;
+} AK_rid;
+
+/**
+ * @def AK_PAGE_SIZE
+ * @brief Constant declaring the size of a block on disk (in bytes)
+ */
+#define AK_PAGE_SIZE 12288
+
+/**
+ * @def AK_SCHEMA_BUCKETS
+ * @brief Constant declaring the number of hash buckets used to find stored headers
+ */
+#define AK_SCHEMA_BUCKETS 256
+
+/**
+ * @author agent
+ * @struct AK_page
+ * @brief Structure that defines how a block is stored in the DB file. The header of the block is not stored in
+ * the page; the page refers to an entry of the schema store instead, so every distinct header is written only
+ * once. AK_read_block and AK_write_block convert between AK_page and AK_block.
+ */
+typedef struct {
+    /// block number (address) in DB file
+    int address;
+    /// block type (can be BLOCK_TYPE_FREE, BLOCK_TYPE_NORMAL or BLOCK_TYPE_CHAINED)
+    int type;
+    /// address of chained block; NOT_CHAINED otherwise
+    int chained_with;
+    /// AK_free space in block
+    int AK_free_space;
+    int last_tuple_dict_id;
+    /// id of the block header in the schema store
+    int schema_id;
+    /// dictionary of data entries
+    AK_tuple_dict tuple_dict[DATA_BLOCK_SIZE];
+    /// actual data entries
+    unsigned char data[DATA_BLOCK_SIZE * DATA_ENTRY_SIZE];
+} AK_page;
+
+/**
+ * @author agent
+ * @struct AK_schema_store
+ * @brief Structure that holds the distinct block headers of a DB file. Headers are kept in memory and appended
+ * to the schema file (DB file name followed by ".schema"); the id of a header is its position in that file.
+ */
+typedef struct {
+    /// descriptor of the schema file, -1 while the store is closed
+    int fd;
+    /// number of stored headers
+    int count;
+    /// number of headers the arrays have room for
+    int capacity;
+    /// stored headers, indexed by id
+    AK_header (*records)[MAX_ATTRIBUTES];
+    /// first id in each hash bucket, -1 if the bucket is empty
+    int buckets[AK_SCHEMA_BUCKETS];
+    /// next id in the same bucket, -1 at the end of the chain
+    int *next;
+    pthread_mutex_t lock;
+} AK_schema_store;
+
 /**
  * @author Markus Schatten
  * @var db
@@ -112,6 +185,15 @@ typedef struct {
 
 extern PtrContainer db;
 
+/**
+ * @author agent
+ * @var db_fd
+ * @brief Variable that holds the DB file descriptor. It is opened once by AK_init_disk_manager and kept
+ * for the whole process, so that blocks can be read and written with positioned I/O (pread/pwrite).
+ * Value is -1 while the file is not open.
+ */
+extern int db_fd;
+
 /**
  * @author Markus Schatten
  * @var db_file_size
@@ -131,7 +213,19 @@ typedef struct {
 } table_addresses;
 
 #define DB_FILE_SIZE_EX 200
-#define DB_FILE_BLOCKS_NUM_EX (int)(1024 * 1024 * DB_FILE_SIZE_EX / sizeof(AK_block))
+#define DB_FILE_BLOCKS_NUM_EX (int)(1024 * 1024 * DB_FILE_SIZE_EX / AK_PAGE_SIZE)
+
+/**
+ * @def AK_DB_FORMAT_MAGIC
+ * @brief Constant marking the beginning of a DB file
+ */
+#define AK_DB_FORMAT_MAGIC 0x424b4441
+/**
+ * @def AK_DB_FORMAT_VERSION
+ * @brief Constant declaring the version of the DB file layout. Version 1 files (every block stored with its
+ * header, no format mark) can be converted with AK_migrate_db_file.
+ */
+#define AK_DB_FORMAT_VERSION 2
 
 /**
  * @author dv
@@ -139,6 +233,10 @@ typedef struct {
  * @brief Structure that defines bit status of blocks, last initialized and last allocated index
  */
 typedef struct {
+    /// AK_DB_FORMAT_MAGIC
+    unsigned int magic;
+    /// AK_DB_FORMAT_VERSION
+    int format_version;
     unsigned int allocationtable[DB_FILE_BLOCKS_NUM_EX];
     unsigned char bittable[BITNSLOTS(DB_FILE_BLOCKS_NUM_EX)];
     int last_allocated;
@@ -236,7 +334,7 @@ int *AK_increase_extent(int start_address, int add_size, AK_allocation_set_mode
 int *AK_get_extent(int start_address, int desired_size, AK_allocation_set_mode *mode, int border, int target, AK_header *header, int gl);
 int AK_get_allocation_set(int *bitsetbs, int fromWhere, int gaplength, int num, AK_allocation_set_mode mode, int target);
 int AK_copy_header(AK_header *header, int *blocknum, int num);
-int AK_allocate_blocks(FILE *db, AK_block *block, int FromWhere, int HowMany);
+int AK_allocate_blocks(AK_block *block, int FromWhere, int HowMany);
 AK_block *AK_init_block();
 int AK_allocationtable_dump(int zz);
 void AK_blocktable_dump(int zz);
@@ -247,6 +345,8 @@ void *AK_read_block_for_testing(void *address);
 void *AK_write_block_for_testing(void *block);
 int AK_blocktable_get();
 int fsize(FILE *fp);
+int AK_open_db_file();
+void AK_close_db_file();
 int AK_init_allocation_table();
 int AK_init_db_file(int size);
 AK_block *AK_read_block(int address);
@@ -265,5 +365,10 @@ int AK_delete_block(int address);
 int AK_delete_extent(int begin, int end);
 int AK_delete_segment(char *name, int type);
 int AK_init_disk_manager();
+int AK_schema_store_open(AK_schema_store *store, const char *db_file_name, int truncate);
+void AK_schema_store_close(AK_schema_store *store);
+int AK_schema_store_put(AK_schema_store *store, AK_header *header);
+int AK_schema_store_get(AK_schema_store *store, int id, AK_header *header);
+int AK_migrate_db_file(char *source, char *destination);
 
 #endif
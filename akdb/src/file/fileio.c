@@ -17,6 +17,7 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
  17 */
 #include "fileio.h"
+#include "idx/index.h"
 
 //START SPECIAL FUNCTIONS FOR WORK WITH row_element_structure
 
@@ -38,7 +39,7 @@ void AK_Insert_New_Element_For_Update(int newtype, void *data, char *table, char
 {
     AK_PRO;
 
-    struct list_node *newElement = (struct list_node *)AK_malloc(sizeof(struct list_node));
+    struct list_node *newElement = (struct list_node *)AK_calloc(1, sizeof(struct list_node));
     newElement->type = newtype;
     memcpy(newElement->data, data, AK_type_size(newtype, data));
 
@@ -97,88 +98,779 @@ void AK_Insert_New_Element(int newtype, void *data, char *table, char *attribute
 
 //END SPECIAL FUNCTIONS row_element_structure
 
-/** @author Matija Novak, updated by Dino Laktašić
-        @brief Function inserts one row into some block.  Firstly it checks wether block contain attributes from the list. Then
-               data, type, size and last_tuple_id are put in temp_block.
-        @param row_root list of elements to insert
-        @param temp_block block in which we insert data
-        @return EXIT SUCCES if success
+/**
+ * @author agent
+ * @brief Function that returns the number of attributes described by the header of a block
+ * @param block block of a table
+ * @return number of attributes (width of a slot in tuple_dict entries)
  */
-int AK_insert_row_to_block(struct list_node *row_root, AK_block *temp_block)
+int AK_block_num_attr(AK_block *block)
 {
-    struct list_node *some_element;
-    int type;        //type od entry data
-    int id = 0;      //id tuple dict in which is inserted next data
-    int head = 0;    //index of header which is curently inserted
-    int search_elem; //serch for tuple dict id and searc for data in list
-    char entry_data[MAX_VARCHAR_LENGTH];
-    AK_PRO;
-
-    while (strcmp(temp_block->header[head].att_name, "\0") != 0)
-    { //inserting values of the list one by one
-        while (temp_block->tuple_dict[id].size != FREE_INT)
-        { //searches for AK_free tuple dict, maybe it can be last_tuple_dict_id
-            id++;
+    int num_attr = 0;
+    AK_PRO;
+    while (num_attr < MAX_ATTRIBUTES && block->header[num_attr].att_name[0] != '\0')
+        num_attr++;
+    AK_EPI;
+    return num_attr;
+}
+
+/**
+ * @author agent
+ * @brief Function that checks whether a slot holds a deleted row. Deletion clears type, size and address of every
+ *        tuple_dict entry of the slot.
+ * @param block block of a table
+ * @param slot slot number
+ * @param num_attr number of attributes of the table
+ * @return 1 if the slot holds a deleted row, 0 otherwise
+ */
+static int AK_slot_is_deleted(AK_block *block, int slot, int num_attr)
+{
+    int id;
+    for (id = slot * num_attr; id < (slot + 1) * num_attr; id++)
+        if (block->tuple_dict[id].type != 0 || block->tuple_dict[id].size != 0)
+            return 0;
+    return 1;
+}
+
+/**
+ * @author agent
+ * @brief Function that checks whether a slot holds a row
+ * @param block block of a table
+ * @param slot slot number
+ * @param num_attr number of attributes of the table
+ * @return 1 if the slot holds a row, 0 if it is deleted, unused or out of range
+ */
+int AK_slot_is_live(AK_block *block, int slot, int num_attr)
+{
+    int live;
+    AK_PRO;
+    live = num_attr > 0 && slot >= 0 && (slot + 1) * num_attr <= DATA_BLOCK_SIZE
+        && block->tuple_dict[slot * num_attr].type != FREE_INT && !AK_slot_is_deleted(block, slot, num_attr);
+    AK_EPI;
+    return live;
+}
+
+/**
+ * @author agent
+ * @brief Function that returns the null bitmap of a row. NULL values are stored as the varchar "null".
+ * @param block block of a table
+ * @param slot slot number
+ * @param num_attr number of attributes of the table
+ * @return bitmap with bit i set if attribute i of the row is NULL
+ */
+unsigned int AK_slot_null_bitmap(AK_block *block, int slot, int num_attr)
+{
+    unsigned int nulls = 0;
+    AK_tuple_dict *entry;
+    int i;
+    AK_PRO;
+    for (i = 0; i < num_attr; i++)
+    {
+        entry = &block->tuple_dict[slot * num_attr + i];
+        if (entry->type == TYPE_VARCHAR && entry->size == 4 && memcmp(block->data + entry->address, "null", 4) == 0)
+            nulls |= 1u << i;
+    }
+    AK_EPI;
+    return nulls;
+}
+
+/**
+ * @author agent
+ * @brief Function that finds the first slot of a block where a row can be written. Unused slots and slots of deleted
+ *        rows are both free.
+ * @param block block of a table
+ * @param num_attr number of attributes of the table
+ * @return slot number, EXIT_ERROR if the block has no free slot
+ */
+int AK_find_free_slot(AK_block *block, int num_attr)
+{
+    int slot;
+    AK_PRO;
+    for (slot = 0; num_attr > 0 && (slot + 1) * num_attr <= DATA_BLOCK_SIZE; slot++)
+        if (block->tuple_dict[slot * num_attr].type == FREE_INT || AK_slot_is_deleted(block, slot, num_attr))
+        {
+            AK_EPI;
+            return slot;
+        }
+    AK_EPI;
+    return EXIT_ERROR;
+}
+
+/**
+ * @author agent
+ * @brief Function that deletes the row in a slot. Its data is cleared and its tuple_dict entries are marked deleted,
+ *        the space is reclaimed by AK_compact_block.
+ * @param block block of a table
+ * @param slot slot number
+ * @param num_attr number of attributes of the table
+ * @return nothing
+ */
+static void AK_delete_slot(AK_block *block, int slot, int num_attr)
+{
+    AK_tuple_dict *entry;
+    int id;
+    for (id = slot * num_attr; id < (slot + 1) * num_attr; id++)
+    {
+        entry = &block->tuple_dict[id];
+        if (entry->address >= 0 && entry->size > 0 && entry->address + entry->size <= DATA_BLOCK_SIZE * DATA_ENTRY_SIZE)
+            memset(block->data + entry->address, '\0', entry->size);
+        AK_dbg_messg(HIGH, FILE_MAN, "delete_slot: from: %d, to: %d\n", entry->address, entry->address + entry->size);
+        entry->size = 0;
+        entry->type = 0;
+        entry->address = 0;
+    }
+}
+
+/**
+ * @author agent
+ * @brief Function that compacts the data area of a block. Data of the remaining entries is moved to the beginning of
+ *        the area, so the space of deleted rows can be used again. Slots are not moved, RIDs stay valid.
+ * @param block block of a table
+ * @return number of bytes reclaimed
+ */
+int AK_compact_block(AK_block *block)
+{
+    int order[DATA_BLOCK_SIZE];
+    int count = 0, offset = 0, used, i, j, id;
+    AK_tuple_dict *entry;
+    AK_PRO;
+
+    for (i = 0; i < DATA_BLOCK_SIZE; i++)
+    {
+        entry = &block->tuple_dict[i];
+        if (entry->type == FREE_INT || entry->size <= 0 || entry->address < 0
+            || entry->address + entry->size > DATA_BLOCK_SIZE * DATA_ENTRY_SIZE)
+            continue;
+        //entries are mostly written in address order, insertion sort is enough
+        for (j = count; j > 0 && block->tuple_dict[order[j - 1]].address > entry->address; j--)
+            order[j] = order[j - 1];
+        order[j] = i;
+        count++;
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        id = order[i];
+        if (block->tuple_dict[id].address != offset)
+        {
+            memmove(block->data + offset, block->data + block->tuple_dict[id].address, block->tuple_dict[id].size);
+            block->tuple_dict[id].address = offset;
+        }
+        offset += block->tuple_dict[id].size;
+    }
+
+    used = block->AK_free_space;
+    if (used > DATA_BLOCK_SIZE * DATA_ENTRY_SIZE || used < offset)
+        used = DATA_BLOCK_SIZE * DATA_ENTRY_SIZE;
+    memset(block->data + offset, FREE_CHAR, used - offset);
+    block->AK_free_space = offset;
+
+    AK_EPI;
+    return used - offset;
+}
+
+/**
+ * @author agent
+ * @brief  Function that allocates a compact row for a table header
+ * @param header header of the table (not copied, it has to outlive the row)
+ * @param num_attr number of attributes of the header
+ * @return new row, NULL if it can not be allocated
+ */
+AK_row *AK_row_new(AK_header *header, int num_attr)
+{
+    AK_row *row;
+    int capacity;
+    AK_PRO;
+    if (num_attr < 0 || num_attr > MAX_ATTRIBUTES)
+    {
+        AK_EPI;
+        return NULL;
+    }
+    capacity = (num_attr > 0 ? num_attr : 1) * MAX_VARCHAR_LENGTH;
+    row = (AK_row *)AK_malloc(sizeof(AK_row) + sizeof(int) * (2 * num_attr + 1) + capacity);
+    if (row == NULL)
+    {
+        AK_EPI;
+        return NULL;
+    }
+    row->header = header;
+    row->num_attr = num_attr;
+    row->capacity = capacity;
+    row->type = (int *)(row + 1);
+    row->offset = row->type + num_attr;
+    row->data = (char *)(row->offset + num_attr + 1);
+    AK_row_reset(row);
+    AK_EPI;
+    return row;
+}
+
+/**
+ * @author agent
+ * @brief  Function that frees a compact row
+ * @param row row to free
+ */
+void AK_row_free(AK_row *row)
+{
+    AK_PRO;
+    if (row != NULL)
+        AK_free(row);
+    AK_EPI;
+}
+
+/**
+ * @author agent
+ * @brief  Function that empties a compact row so it can hold the next tuple
+ * @param row row to empty
+ */
+void AK_row_reset(AK_row *row)
+{
+    AK_PRO;
+    row->count = 0;
+    row->offset[0] = 0;
+    AK_EPI;
+}
+
+/**
+ * @author agent
+ * @brief  Function that appends a value to a compact row
+ * @param row row to append to
+ * @param type data type of the value
+ * @param value value bytes
+ * @param size number of bytes of the value
+ * @return EXIT_SUCCESS, EXIT_ERROR if the row is full
+ */
+int AK_row_append(AK_row *row, int type, const char *value, int size)
+{
+    int end;
+    AK_PRO;
+    end = row->offset[row->count];
+    if (row->count >= row->num_attr || size < 0 || end + size > row->capacity)
+    {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    memcpy(row->data + end, value, size);
+    row->type[row->count] = type;
+    row->count++;
+    row->offset[row->count] = end + size;
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @author agent
+ * @brief  Function that returns a value of a compact row
+ * @param row row
+ * @param i index of the value
+ * @param type receives the data type of the value (may be NULL)
+ * @param size receives the number of bytes of the value (may be NULL)
+ * @return pointer to the value inside the row, NULL if there is no such value
+ */
+char *AK_row_get(AK_row *row, int i, int *type, int *size)
+{
+    AK_PRO;
+    if (i < 0 || i >= row->count)
+    {
+        AK_EPI;
+        return NULL;
+    }
+    if (type != NULL)
+        *type = row->type[i];
+    if (size != NULL)
+        *size = row->offset[i + 1] - row->offset[i];
+    AK_EPI;
+    return row->data + row->offset[i];
+}
+
+/**
+ * @author agent
+ * @brief  Function that returns the index of an attribute in the header of a compact row
+ * @param row row
+ * @param attribute attribute name
+ * @return index of the attribute, EXIT_ERROR if the header has no such attribute
+ */
+int AK_row_attr_index(AK_row *row, const char *attribute)
+{
+    int i;
+    AK_PRO;
+    for (i = 0; i < row->num_attr; i++)
+        if (strcmp(row->header[i].att_name, attribute) == 0)
+        {
+            AK_EPI;
+            return i;
+        }
+    AK_EPI;
+    return EXIT_ERROR;
+}
+
+/**
+ * @author agent
+ * @brief  Function that fills a compact row from a row list. Values are taken by the attribute names of the row header,
+ * attributes missing from the list are set to null.
+ * @param row row to fill
+ * @param row_root list with the values of one row
+ * @return EXIT_SUCCESS, EXIT_ERROR if the values do not fit into the row
+ */
+int AK_row_from_list(AK_row *row, struct list_node *row_root)
+{
+    struct list_node *el;
+    int i;
+    AK_PRO;
+    AK_row_reset(row);
+    for (i = 0; i < row->num_attr; i++)
+    {
+        el = (struct list_node *)AK_First_L2(row_root);
+        while (el != NULL && !(el->constraint == NEW_VALUE && strcmp(el->attribute_name, row->header[i].att_name) == 0))
+            el = (struct list_node *)AK_Next_L2(el);
+
+        if ((el != NULL && AK_row_append(row, el->type, el->data, AK_type_size(el->type, el->data)) == EXIT_ERROR)
+            || (el == NULL && AK_row_append(row, TYPE_VARCHAR, "null", strlen("null")) == EXIT_ERROR))
+        {
+            AK_EPI;
+            return EXIT_ERROR;
+        }
+    }
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @author agent
+ * @brief  Function that adds the values of a compact row to a row list, for functions that still work on lists
+ * @param row row
+ * @param table table name written to the list elements
+ * @param row_root list the values are added to
+ */
+void AK_row_to_list(AK_row *row, char *table, struct list_node *row_root)
+{
+    char value[MAX_VARCHAR_LENGTH];
+    char *data;
+    int i, type, size;
+    AK_PRO;
+    for (i = 0; i < row->count; i++)
+    {
+        data = AK_row_get(row, i, &type, &size);
+        if (size >= MAX_VARCHAR_LENGTH)
+            size = MAX_VARCHAR_LENGTH - 1;
+        memcpy(value, data, size);
+        value[size] = '\0';
+        AK_Insert_New_Element(type, value, table, row->header[i].att_name, row_root);
+    }
+    AK_EPI;
+}
+
+/**
+ * @author agent
+ * @brief  Function that reads the row in a slot of a block into a compact row without allocating anything
+ * @param row row to fill
+ * @param block block of the table
+ * @param slot slot number
+ * @return EXIT_SUCCESS, EXIT_ERROR if the slot holds no row
+ */
+int AK_row_from_slot(AK_row *row, AK_block *block, int slot)
+{
+    AK_tuple_dict *entry;
+    int i;
+    AK_PRO;
+    AK_row_reset(row);
+    if (!AK_slot_is_live(block, slot, row->num_attr))
+    {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    for (i = 0; i < row->num_attr; i++)
+    {
+        entry = &block->tuple_dict[slot * row->num_attr + i];
+        if (entry->address < 0 || entry->size < 0 || entry->address + entry->size > DATA_BLOCK_SIZE * DATA_ENTRY_SIZE
+            || AK_row_append(row, entry->type, (const char *)(block->data + entry->address), entry->size) == EXIT_ERROR)
+        {
+            AK_row_reset(row);
+            AK_EPI;
+            return EXIT_ERROR;
         }
-        //printf("insert_row_to_block: Position to write (tuple_dict_index) %d, header_att_name %s\n", id, temp_block->header[head].att_name);
+    }
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @author agent
+ * @brief Function writes the values of one row into the first free slot of a block. If the data does not fit behind
+ *        the last entry, the block is compacted first.
+ * @param temp_block block in which we insert data
+ * @param num_attr number of attributes of the block header
+ * @param type data type of every value
+ * @param value bytes of every value
+ * @param size number of bytes of every value
+ * @return slot of the row, EXIT_ERROR if the block has no room for it
+ */
+static int AK_write_row_to_slot(AK_block *temp_block, int num_attr, int *type, const char **value, int *size)
+{
+    int head, slot, id = 0, total = 0;
+    AK_PRO;
+
+    for (head = 0; head < num_attr; head++)
+        total += size[head];
 
+    slot = num_attr > 0 ? AK_find_free_slot(temp_block, num_attr) : EXIT_ERROR;
+    if (slot == EXIT_ERROR)
+    {
+        printf("AK_insert_row_to_block: ERROR. There is no free slot in block %d.\n", temp_block->address);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    if (temp_block->AK_free_space < 0 || temp_block->AK_free_space + total > DATA_BLOCK_SIZE * DATA_ENTRY_SIZE)
+        AK_compact_block(temp_block);
+    if (temp_block->AK_free_space + total > DATA_BLOCK_SIZE * DATA_ENTRY_SIZE)
+    {
+        printf("AK_insert_row_to_block: ERROR. Row does not fit into block %d.\n", temp_block->address);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    for (head = 0; head < num_attr; head++)
+    {
+        id = slot * num_attr + head;
         AK_dbg_messg(HIGH, FILE_MAN, "insert_row_to_block: Position to write (tuple_dict_index) %d, header_att_name %s\n", id, temp_block->header[head].att_name);
 
-        search_elem = 1;
+        memcpy(temp_block->data + temp_block->AK_free_space, value[head], size[head]);
+        temp_block->tuple_dict[id].address = temp_block->AK_free_space;
+        temp_block->AK_free_space += size[head];
+        temp_block->tuple_dict[id].type = type[head];
+        temp_block->tuple_dict[id].size = size[head];
+
+        AK_dbg_messg(HIGH, FILE_MAN, "insert_row_to_block: Insert: size: %d\n", size[head]);
+    }
+    //writes the last used tuple dict id
+    if (id > temp_block->last_tuple_dict_id)
+        temp_block->last_tuple_dict_id = id;
+
+    AK_EPI;
+    return slot;
+}
+
+/**
+ * @author Matija Novak, updated by Dino Laktašić, updated by agent (slots)
+ * @brief Function inserts one row into the first free slot of a block. Values are taken from the list by the names
+ *        in the block header, attributes missing from the list are written as null.
+ * @param row_root list of elements to insert
+ * @param temp_block block in which we insert data
+ * @return slot of the row, EXIT_ERROR if the block has no room for it
+ */
+static int AK_insert_row_to_slot(struct list_node *row_root, AK_block *temp_block)
+{
+    struct list_node *some_element;
+    const char *value[MAX_ATTRIBUTES];
+    int type[MAX_ATTRIBUTES], size[MAX_ATTRIBUTES];
+    int num_attr, head, slot;
+    AK_PRO;
+
+    num_attr = AK_block_num_attr(temp_block);
+    for (head = 0; head < num_attr; head++)
+    {
         some_element = (struct list_node *)AK_First_L2(row_root);
-        while (search_elem)
+        while (some_element != NULL && !((strcmp(some_element->attribute_name, temp_block->header[head].att_name) == 0) && (some_element->constraint == NEW_VALUE)))
+            some_element = (struct list_node *)AK_Next_L2(some_element);
+
+        if (some_element != NULL)
+        { //found correct element
+            type[head] = some_element->type;
+            value[head] = some_element->data;
+        }
+        else
+        { //no data exist for this header write null
+            type[head] = TYPE_VARCHAR;
+            value[head] = "null";
+        }
+        size[head] = AK_type_size(type[head], (char *)value[head]);
+    }
+
+    slot = AK_write_row_to_slot(temp_block, num_attr, type, value, size);
+    AK_EPI;
+    return slot;
+}
+
+/**
+ * @author agent
+ * @brief Function inserts a compact row into the first free slot of a block. Values are mapped by the names in the
+ *        block header, attributes missing from the row are written as null.
+ * @param row compact row to insert
+ * @param temp_block block in which we insert data
+ * @return slot of the row, EXIT_ERROR if the block has no room for it
+ */
+static int AK_insert_compact_row_to_slot(AK_row *row, AK_block *temp_block)
+{
+    const char *value[MAX_ATTRIBUTES];
+    int type[MAX_ATTRIBUTES], size[MAX_ATTRIBUTES];
+    int num_attr, head, i, slot;
+    AK_PRO;
+
+    num_attr = AK_block_num_attr(temp_block);
+    for (head = 0; head < num_attr; head++)
+    {
+        //the block header is usually the row header, so try the same position first
+        i = head;
+        if (i >= row->count || strcmp(row->header[i].att_name, temp_block->header[head].att_name) != 0)
+            i = AK_row_attr_index(row, temp_block->header[head].att_name);
+
+        if (i >= 0 && i < row->count)
         {
-            if ((strcmp(some_element->attribute_name, temp_block->header[head].att_name) == 0) && (some_element->constraint == 0))
-            { //found correct element
-                type = some_element->type;
+            value[head] = AK_row_get(row, i, &type[head], &size[head]);
+        }
+        else
+        { //no data exist for this header write null
+            type[head] = TYPE_VARCHAR;
+            value[head] = "null";
+            size[head] = strlen("null");
+        }
+    }
 
-                memset(entry_data, '\0', MAX_VARCHAR_LENGTH);
-                memcpy(entry_data, some_element->data, AK_type_size(type, some_element->data));
+    slot = AK_write_row_to_slot(temp_block, num_attr, type, value, size);
+    AK_EPI;
+    return slot;
+}
 
-                search_elem = 0;
-            }
-            else
+/** @author Matija Novak, updated by Dino Laktašić, updated by agent (slots)
+        @brief Function inserts one row into some block. The row is written to the first free slot of the block, see
+               AK_insert_row_to_slot.
+        @param row_root list of elements to insert
+        @param temp_block block in which we insert data
+        @return EXIT_SUCCESS if success, EXIT_ERROR if the block has no room for the row
+ */
+int AK_insert_row_to_block(struct list_node *row_root, AK_block *temp_block)
+{
+    int result;
+    AK_PRO;
+    result = AK_insert_row_to_slot(row_root, temp_block) == EXIT_ERROR ? EXIT_ERROR : EXIT_SUCCESS;
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @author agent
+ * @brief Function adds the row in a slot to the indexes of its table or removes it from them
+ * @param table table name
+ * @param block block of the row
+ * @param slot slot of the row
+ * @param insert 1 to add the row, 0 to remove it
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_index_slot(char *table, AK_block *block, int slot, int insert)
+{
+    AK_row *row;
+    AK_rid rid;
+    int result;
+    AK_PRO;
+
+    //most tables have no index, the catalog cache answers that without reading a block
+    if (AK_catalog_get_indexes(table, NULL, 0) == 0)
+    {
+        AK_EPI;
+        return EXIT_SUCCESS;
+    }
+    rid.block = block->address;
+    rid.slot = slot;
+    row = AK_row_new(block->header, AK_block_num_attr(block));
+    if (row == NULL || AK_row_from_slot(row, block, slot) == EXIT_ERROR)
+        result = EXIT_ERROR;
+    else if (insert)
+        result = AK_index_insert_row(table, row, &rid);
+    else
+        result = AK_index_delete_row(table, row, &rid);
+    AK_row_free(row);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @author agent
+ * @brief Function places one row into a table. The block is taken from the free space map, a new extent is allocated
+ *        if no block has room or the offered blocks turn the row down. The row is written to the block and to the blocks chained with it, either from a row
+ *        list or from a compact row. The row is added to the indexes of the table, if one of them can not take it the row
+ *        is taken out of the table again.
+ * @param table table name
+ * @param row_root list of elements which contain data of one row, used if row is NULL
+ * @param row compact row
+ * @param row_size number of bytes of the values
+ * @param rid if not NULL, receives the RID of the new row
+ * @return EXIT_SUCCESS if success else EXIT_ERROR
+ */
+static int AK_insert_to_table(char *table, struct list_node *row_root, AK_row *row, int row_size, AK_rid *rid)
+{
+    table_addresses *table_addresses_return;
+    AK_mem_block *mem_block;
+    AK_rid placed;
+    int adr_to_write, end = EXIT_SUCCESS, slot, bitmap, attempt, new_extent;
+    AK_PRO;
+
+    AK_dbg_messg(HIGH, FILE_MAN, "insert_row: Insert into table: %s\n", table);
+    // bitmap index tables are registered in AK_index, not in AK_relation
+    bitmap = strstr(table, "_bmapIndex") != NULL;
+    if (bitmap)
+        table_addresses_return = AK_get_index_addresses(table);
+    else
+        table_addresses_return = AK_get_table_addresses(table);
+    if (table_addresses_return->address_from[0] == 0)
+    {
+        printf("Could not insert row. Table %s does not exist.\n", table);
+        AK_free(table_addresses_return);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    // a block offered by the free space map can still turn the row down, its class is corrected and the map is asked
+    // once more before a new extent is allocated
+    placed.block = EXIT_ERROR;
+    placed.slot = EXIT_ERROR;
+    for (attempt = 0; placed.slot == EXIT_ERROR; attempt++)
+    {
+        new_extent = 0;
+        if (bitmap)
+            adr_to_write = (int)AK_find_AK_free_space(table_addresses_return);
+        else
+        {
+            // the free space map answers without reading the blocks of the table
+            adr_to_write = attempt < 2 ? (int)AK_fsm_find_block(table_addresses_return, row_size) : -1;
+            if (adr_to_write == -1 || adr_to_write == placed.block)
             {
-                some_element = (struct list_node *)AK_Next_L2(some_element);
-                if (some_element == 0)
-                { //no data exist for this header write null
-                    some_element = 1;
-                    memcpy(entry_data, "null", strlen("null"));
-                    type = TYPE_VARCHAR;
-                    search_elem = 0;
-                }
+                adr_to_write = (int)AK_init_new_extent(table, SEGMENT_TYPE_TABLE);
+                new_extent = 1;
             }
         }
+        if (adr_to_write == 0)
+            break;
 
-        memcpy(temp_block->data + temp_block->AK_free_space, entry_data, (int)AK_type_size(type, entry_data));
-        temp_block->tuple_dict[id].address = temp_block->AK_free_space;
-        temp_block->AK_free_space += AK_type_size(type, entry_data);
-        temp_block->tuple_dict[id].type = type;
-        temp_block->tuple_dict[id].size = AK_type_size(type, entry_data);
+        AK_dbg_messg(HIGH, FILE_MAN, "insert_row: Insert into block on adress: %d\n", adr_to_write);
+        mem_block = (AK_mem_block *)AK_get_block(adr_to_write);
+        if (row != NULL)
+            slot = AK_insert_compact_row_to_slot(row, mem_block->block);
+        else
+            slot = AK_insert_row_to_slot(row_root, mem_block->block);
+        placed.block = adr_to_write;
+        if (slot == EXIT_ERROR)
+        {
+            // nothing was written, the block stays clean
+            AK_fsm_update_block(mem_block->block);
+            if (bitmap || new_extent)
+                break;
+            continue;
+        }
+        placed.slot = slot;
+        AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+        AK_fsm_update_block(mem_block->block);
+    }
+    AK_free(table_addresses_return);
+    if (placed.slot == EXIT_ERROR)
+    {
+        if (rid != NULL)
+            *rid = placed;
+        AK_EPI;
+        return EXIT_ERROR;
+    }
 
-        memcpy(entry_data, temp_block->data + temp_block->tuple_dict[id].address, temp_block->tuple_dict[id].size);
+    // the row continues in the blocks chained with the first one
+    adr_to_write = mem_block->block->chained_with;
+    while (adr_to_write != NOT_CHAINED)
+    {
+    	mem_block = (AK_mem_block *)AK_get_block(adr_to_write);
+    	if (row != NULL)
+    	    slot = AK_insert_compact_row_to_slot(row, mem_block->block);
+    	else
+    	    slot = AK_insert_row_to_slot(row_root, mem_block->block);
+    	if (slot == EXIT_ERROR)
+    	    end = EXIT_ERROR;
+    	AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+    	AK_fsm_update_block(mem_block->block);
+    	adr_to_write = mem_block->block->chained_with;
+    }
 
-        AK_dbg_messg(HIGH, FILE_MAN, "insert_row_to_block: Insert: data: %s, size: %d\n", entry_data, AK_type_size(type, entry_data));
-        head++; //go to next header
+    if (end == EXIT_SUCCESS)
+    {
+        mem_block = (AK_mem_block *)AK_get_block(placed.block);
+        if (AK_index_slot(table, mem_block->block, placed.slot, 1) == EXIT_ERROR)
+        {
+            AK_delete_slot(mem_block->block, placed.slot, AK_block_num_attr(mem_block->block));
+            AK_compact_block(mem_block->block);
+            AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+            AK_fsm_update_block(mem_block->block);
+            end = EXIT_ERROR;
+        }
     }
-    //writes the last used tuple dict id
+    if (rid != NULL)
+        *rid = placed;
 
-    temp_block->last_tuple_dict_id = id;
     AK_EPI;
-    return EXIT_SUCCESS;
+    return end;
 }
 
-/** @author Matija Novak, updated by Matija Šestak (function now uses caching), updated by Dejan Frankovic (added reference check), updated by Dino         Laktašić (removed variable AK_free, variable table initialized using memset), updated by Josip Šušnjara (chained blocks support)
+/** @author Matija Novak, updated by Matija Šestak (function now uses caching), updated by Dejan Frankovic (added reference check), updated by Dino         Laktašić (removed variable AK_free, variable table initialized using memset), updated by Josip Šušnjara (chained blocks support), updated by agent (free space map)
         @brief Function inserts a one row into table. Firstly it is checked whether inserted row would violite reference integrity.
         Then it is checked in which table should row be inserted. If there is no AK_free space for new table, new extent is allocated. New block is            allocated on given address. Row is inserted in this block and dirty flag is set to BLOCK_DIRTY.
+        The block is taken from the free space map, which is updated after the insert.
         @param row_root list of elements which contain data of one row
+        @param rid if not NULL, receives the RID of the new row
         @return EXIT_SUCCESS if success else EXIT_ERROR
 
  */
-int AK_insert_row(struct list_node *row_root)
+int AK_insert_row_rid(struct list_node *row_root, AK_rid *rid)
+{
+    AK_PRO;
+    AK_dbg_messg(HIGH, FILE_MAN, "insert_row: Start testing reference integrity.\n");
+
+    // recovery checkpoint
+    AK_add_to_redolog(INSERT, row_root);
+
+    if (AK_reference_check_entry(row_root) == EXIT_ERROR)
+    {
+        printf("Could not insert row. Reference integrity violation.\n");
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    AK_dbg_messg(HIGH, FILE_MAN, "insert_row: Start inserting data\n");
+    struct list_node *some_element = (struct list_node *)AK_First_L2(row_root);
+    char table[MAX_ATT_NAME];
+    int end, row_size = 0;
+
+    memset(table, '\0', MAX_ATT_NAME);
+    memcpy(&table, some_element->table, strlen(some_element->table));
+    for (struct list_node *el = some_element; el != NULL; el = (struct list_node *)AK_Next_L2(el))
+        if (el->constraint == NEW_VALUE)
+            row_size += AK_type_size(el->type, el->data);
+
+    end = AK_insert_to_table(table, row_root, NULL, row_size, rid);
+    if (end == EXIT_SUCCESS)
+        AK_redolog_commit();
+
+    AK_EPI;
+    return end;
+}
+
+/**
+ * @author agent
+ * @brief  Function that inserts a compact row into a table. Values are written by the attribute names of the row header.
+ * Referential integrity and the redo log still work on row lists, so the row is converted for them.
+ * @param table table name
+ * @param row row to insert
+ * @param rid if not NULL, receives the RID of the new row
+ * @return EXIT_SUCCESS if success else EXIT_ERROR
+ */
+int AK_insert_compact_row(char *table, AK_row *row, AK_rid *rid)
 {
+    struct list_node *row_root;
+    int end;
     AK_PRO;
-    AK_dbg_messg(HIGH, FILE_MAN, "insert_row: Start testing reference integrity.\n");
+
+    if (row->count == 0)
+    {
+        printf("Could not insert row. The row into %s is empty.\n", table);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    row_root = (struct list_node *)AK_malloc(sizeof(struct list_node));
+    AK_Init_L3(&row_root);
+    AK_row_to_list(row, table, row_root);
 
     // recovery checkpoint
     AK_add_to_redolog(INSERT, row_root);
@@ -186,293 +878,494 @@ int AK_insert_row(struct list_node *row_root)
     if (AK_reference_check_entry(row_root) == EXIT_ERROR)
     {
         printf("Could not insert row. Reference integrity violation.\n");
+        AK_DeleteAll_L3(&row_root);
+        AK_free(row_root);
         AK_EPI;
         return EXIT_ERROR;
     }
+    AK_DeleteAll_L3(&row_root);
+    AK_free(row_root);
 
-    AK_dbg_messg(HIGH, FILE_MAN, "insert_row: Start inserting data\n");
-    struct list_node *some_element = (struct list_node *)AK_First_L2(row_root);
-    char table[MAX_ATT_NAME];
-    table_addresses *table_addresses_return;
+    end = AK_insert_to_table(table, NULL, row, row->offset[row->count], rid);
+    if (end == EXIT_SUCCESS)
+        AK_redolog_commit();
 
-    memset(table, '\0', MAX_ATT_NAME);
-    memcpy(&table, some_element->table, strlen(some_element->table));
-    AK_dbg_messg(HIGH, FILE_MAN, "insert_row: Insert into table: %s\n", table);
-    int adr_to_write;
-    table_addresses_return = AK_get_table_addresses(table);
-    adr_to_write = (int)AK_find_AK_free_space(table_addresses_return);
-    AK_free(table_addresses_return);
+    AK_EPI;
+    return end;
+}
+
+/** @author Matija Novak, updated by agent (slots)
+        @brief Function inserts a one row into table, see AK_insert_row_rid.
+        @param row_root list of elements which contain data of one row
+        @return EXIT_SUCCESS if success else EXIT_ERROR
+ */
+int AK_insert_row(struct list_node *row_root)
+{
+    int result;
+    AK_PRO;
+    result = AK_insert_row_rid(row_root, NULL);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @author agent
+ * @struct AK_moved_rows
+ * @brief Updated rows that do not fit into their block any more. They are moved after all blocks of the table have
+ * been updated, so a moved row is not met and updated again.
+ */
+typedef struct {
+    /// copy of the table header, the rows point into it
+    AK_header *header;
+    /// RID of every row, the row stays in its slot until it is moved
+    AK_rid *rid;
+    /// new values of every row
+    AK_row **row;
+    /// number of rows
+    int count;
+    /// size of the arrays
+    int capacity;
+} AK_moved_rows;
+
+/**
+ * @author agent
+ * @brief Function that remembers an updated row which has to be moved to another block
+ * @param moved rows to move
+ * @param block block of the row
+ * @param rid RID of the row
+ * @param type data type of every new value
+ * @param value bytes of every new value
+ * @param size number of bytes of every new value
+ * @return EXIT_SUCCESS, EXIT_ERROR if the row can not be remembered
+ */
+static int AK_moved_rows_add(AK_moved_rows *moved, AK_block *block, AK_rid *rid, int *type, const char **value, int *size)
+{
+    int num_attr = AK_block_num_attr(block), head;
+    AK_row *row;
 
-    if (adr_to_write == -1)
-        adr_to_write = (int)AK_init_new_extent(table, SEGMENT_TYPE_TABLE);
-    if (strstr(some_element->table, "_bmapIndex"))
+    if (moved->header == NULL)
     {
-        table_addresses_return = AK_get_index_addresses(table);
-        adr_to_write = (int)AK_find_AK_free_space(table_addresses_return);
-        AK_free(table_addresses_return);
+        moved->header = (AK_header *)AK_malloc(num_attr * sizeof(AK_header));
+        memcpy(moved->header, block->header, num_attr * sizeof(AK_header));
     }
-
-    if (adr_to_write == 0)
+    if (moved->count == moved->capacity)
     {
-        AK_EPI;
-        return EXIT_ERROR;
+        moved->capacity = moved->capacity > 0 ? 2 * moved->capacity : 16;
+        moved->rid = (AK_rid *)AK_realloc(moved->rid, moved->capacity * sizeof(AK_rid));
+        moved->row = (AK_row **)AK_realloc(moved->row, moved->capacity * sizeof(AK_row *));
     }
+    row = AK_row_new(moved->header, num_attr);
+    if (row == NULL)
+        return EXIT_ERROR;
+    for (head = 0; head < num_attr; head++)
+        if (AK_row_append(row, type[head], value[head], size[head]) == EXIT_ERROR)
+        {
+            AK_row_free(row);
+            return EXIT_ERROR;
+        }
+    moved->rid[moved->count] = *rid;
+    moved->row[moved->count] = row;
+    moved->count++;
+    return EXIT_SUCCESS;
+}
 
-    table_addresses *addresses = (table_addresses *)AK_get_table_addresses(table);
-    
-    /*for(int i = 0; i < blocks_per_row; i++){
-    	AK_dbg_messg(HIGH, FILE_MAN, "insert_row: Insert into block on adress: %d\n", adr_to_write);
-    	AK_mem_block *mem_block = (AK_mem_block *)AK_get_block(adr_to_write);
-    	int end = (int)AK_insert_row_to_block(row_root, mem_block->block);
-    }*/
-    AK_dbg_messg(HIGH, FILE_MAN, "insert_row: Insert into block on adress: %d\n", adr_to_write);
-    
-    int end;
+/**
+ * @author agent
+ * @brief Function that moves the remembered rows of an update to other blocks of the table. The new row is placed
+ * with AK_insert_to_table, the update has already been checked and logged, so there is no second redo log entry or
+ * reference check. The old row is deleted once the new one has been placed. If the new row can not be placed, the old
+ * row keeps its slot and its index entries.
+ * @param table table name
+ * @param moved rows to move, freed by the function
+ * @return EXIT_SUCCESS, EXIT_ERROR if a row could not be moved
+ */
+static int AK_moved_rows_place(char *table, AK_moved_rows *moved)
+{
     AK_mem_block *mem_block;
-    int l = 0;
-    do{
-    	mem_block = (AK_mem_block *)AK_get_block(adr_to_write);
-    	end = (int)AK_insert_row_to_block(row_root, mem_block->block);
-    	AK_mem_block_modify(mem_block, BLOCK_DIRTY);
-    	adr_to_write = mem_block->block->chained_with;
-    }
-    while(mem_block->block->chained_with != NOT_CHAINED);
+    AK_row *old_row;
+    int i, num_attr, indexed, end = EXIT_SUCCESS;
 
-    if (end == EXIT_SUCCESS)
-        AK_redolog_commit();
-        
+    indexed = AK_catalog_get_indexes(table, NULL, 0) > 0;
+    for (i = 0; i < moved->count; i++)
+    {
+        mem_block = AK_pin_block(moved->rid[i].block);
+        if (mem_block == NULL)
+        {
+            end = EXIT_ERROR;
+            continue;
+        }
+        num_attr = AK_block_num_attr(mem_block->block);
+        old_row = AK_row_new(moved->header, num_attr);
+        if (old_row == NULL || AK_row_from_slot(old_row, mem_block->block, moved->rid[i].slot) == EXIT_ERROR)
+        {
+            AK_row_free(old_row);
+            AK_unpin_block(mem_block, BLOCK_CLEAN);
+            end = EXIT_ERROR;
+            continue;
+        }
 
-    AK_EPI;
+        //the old key is taken out first, the new row may keep it in a unique index
+        if ((!indexed || AK_index_delete_row(table, old_row, &moved->rid[i]) == EXIT_SUCCESS)
+            && AK_insert_to_table(table, NULL, moved->row[i], moved->row[i]->offset[moved->row[i]->count], NULL) == EXIT_SUCCESS)
+        {
+            AK_delete_slot(mem_block->block, moved->rid[i].slot, num_attr);
+            AK_compact_block(mem_block->block);
+            AK_fsm_update_block(mem_block->block);
+            AK_unpin_block(mem_block, BLOCK_DIRTY);
+        }
+        else
+        {
+            printf("AK_update_row: ERROR. Row %d in block %d of table %s could not be moved, it is not updated.\n",
+                   moved->rid[i].slot, moved->rid[i].block, table);
+            if (indexed)
+                AK_index_insert_row(table, old_row, &moved->rid[i]);
+            AK_unpin_block(mem_block, BLOCK_CLEAN);
+            end = EXIT_ERROR;
+        }
+        AK_row_free(old_row);
+    }
+
+    for (i = 0; i < moved->count; i++)
+        AK_row_free(moved->row[i]);
+    AK_free(moved->rid);
+    AK_free(moved->row);
+    AK_free(moved->header);
+    memset(moved, 0, sizeof(AK_moved_rows));
     return end;
 }
 
 /**
-   * @author Matija Novak, updated by Dino Laktašić, updated by Mario Peroković - separated from deletion, updated by Antun Tkalčec (fixed SIGSEGV)
-   * @brief Function updates row from table in given block if the data in the table is equal to data in attribute used for search. 
-   * @param temp_block block to work with
-   * @param row_list list of elements which contain data for delete or update
-   * @return Returns an "EXIT_SUCCESS"
-*/
-int AK_update_row_from_block(AK_block *temp_block, struct list_node *row_root)
+ * @author Matija Novak, updated by Dino Laktašić, updated by Mario Peroković - separated from deletion, updated by Antun Tkalčec (fixed SIGSEGV), updated by agent (slots, index maintenance)
+ * @brief Function updates rows of a table in given block. Every row whose values are equal to all search constraints
+ *        in the list gets the new values from the list. A row whose values keep their sizes is changed in its slot,
+ *        a row that still fits into the block is written again into it. Other rows are left as they are and added
+ *        to moved, see AK_moved_rows_place. The row is moved to its new key in the indexes of the table, if an index
+ *        can not take the new key the row gets back its old values and index entries.
+ * @param temp_block block to work with
+ * @param row_root list of elements which contain data for delete or update
+ * @param moved receives the rows which have to be moved to another block
+ * @return EXIT_SUCCESS, EXIT_ERROR if a row could not be updated
+ */
+static int AK_update_rows_in_block(AK_block *temp_block, struct list_node *row_root, AK_moved_rows *moved)
 {
-    int head = 0;                        //counting headers
-    int attPlace = 0;                    //place of attribute which are same
-    int del = 1;                         //if can delete gorup of tuple dicts which are in the same row of table
-    int exists_equal_attrib = 0;         //if we found at least one header in the list
-    char entry_data[MAX_VARCHAR_LENGTH]; //entry data when haeader is found in list which is copied to compare with data in block
+    char *table = ((struct list_node *)AK_First_L2(row_root))->table;
+    int num_attr = AK_block_num_attr(temp_block);
+    int slot, head, update, exists_equal_attrib, in_place, indexed, old_total, new_total, end = EXIT_SUCCESS;
+    int type[MAX_ATTRIBUTES], size[MAX_ATTRIBUTES];
+    const char *value[MAX_ATTRIBUTES];
+    AK_tuple_dict *entry;
+    AK_row *old_row, *new_row;
+    AK_rid rid;
+    struct list_node *some_element;
     AK_PRO;
-    struct list_node *new_data = (struct list_node *)AK_malloc(sizeof(struct list_node));
-    AK_Init_L3(&new_data);
 
-    struct list_node *some_element = (struct list_node *)AK_First_L2(row_root);
-
-    int i, overflow, address, size;
-
-    for (i = 0; i < DATA_BLOCK_SIZE; i++)
+    old_row = AK_row_new(temp_block->header, num_attr);
+    new_row = AK_row_new(temp_block->header, num_attr);
+    indexed = AK_catalog_get_indexes(table, NULL, 0) > 0;
+    for (slot = 0; old_row != NULL && new_row != NULL && num_attr > 0 && (slot + 1) * num_attr <= DATA_BLOCK_SIZE; slot++)
     {
+        if (temp_block->tuple_dict[slot * num_attr].type == FREE_INT)
+            break;
+        if (AK_row_from_slot(old_row, temp_block, slot) == EXIT_ERROR)
+            continue;
+
+        update = 1;
         exists_equal_attrib = 0;
-        head = 0;
-        attPlace = 0;
-        address = temp_block->tuple_dict[i].address;
-        size = temp_block->tuple_dict[i].size;
-        overflow = address + size;
+        for (some_element = row_root; some_element != NULL && update; some_element = some_element->next)
+        {
+            if (some_element->constraint != SEARCH_CONSTRAINT)
+                continue;
+            for (head = 0; head < num_attr; head++)
+                if (strcmp(some_element->attribute_name, temp_block->header[head].att_name) == 0)
+                    break;
+            if (head == num_attr)
+                continue;
+
+            //if the data in table isn't equal to data in attribute which is used for search, it won't be updated
+            exists_equal_attrib = 1;
+            entry = &temp_block->tuple_dict[slot * num_attr + head];
+            if (entry->size != AK_type_size(some_element->type, some_element->data)
+                || memcmp(temp_block->data + entry->address, some_element->data, entry->size) != 0)
+                update = 0;
+        }
+        if (!exists_equal_attrib || !update)
+            continue;
 
-        while (strcmp(temp_block->header[head].att_name, "\0") != 0)
-        { //going through headers
+        //new values from the list, the others stay as they are
+        in_place = 1;
+        old_total = new_total = 0;
+        for (head = 0; head < num_attr; head++)
+        {
+            for (some_element = (struct list_node *)AK_First_L2(row_root); some_element != NULL; some_element = some_element->next)
+                if (some_element->constraint == NEW_VALUE && strcmp(some_element->attribute_name, temp_block->header[head].att_name) == 0)
+                    break;
+            if (some_element != NULL)
+            {
+                type[head] = some_element->type;
+                value[head] = some_element->data;
+                size[head] = AK_type_size(some_element->type, some_element->data);
+            }
+            else
+                value[head] = AK_row_get(old_row, head, &type[head], &size[head]);
+            if (size[head] != temp_block->tuple_dict[slot * num_attr + head].size)
+                in_place = 0;
+            old_total += temp_block->tuple_dict[slot * num_attr + head].size;
+            new_total += size[head];
+        }
 
-            some_element = row_root;
-            while (some_element)
+        rid.block = temp_block->address;
+        rid.slot = slot;
+        if (!in_place && temp_block->AK_free_space + new_total > DATA_BLOCK_SIZE * DATA_ENTRY_SIZE)
+        {
+            //compacting keeps the slots, after it the free space tells whether the row fits without its old values
+            AK_compact_block(temp_block);
+            if (temp_block->AK_free_space - old_total + new_total > DATA_BLOCK_SIZE * DATA_ENTRY_SIZE)
             {
-                if ((strcmp(some_element->attribute_name, temp_block->header[head].att_name) == 0) && (some_element->constraint == SEARCH_CONSTRAINT))
-                {
-                    exists_equal_attrib = 1;
-                    attPlace = head;
-
-                    if (overflow < (temp_block->AK_free_space + 1) && overflow > -1)
-                    {
-                        memset(entry_data, '\0', MAX_VARCHAR_LENGTH);
-                        memcpy(entry_data, temp_block->data + address, size);
-
-                        // if the data in table isn't equal to data in attribute which is used for search, it won't be updated
-                        if (strcmp(entry_data, some_element->data) != 0)
-                            del = 0;
-                    }
-                    else
-                        del = 0;
-                }
+                if (AK_moved_rows_add(moved, temp_block, &rid, type, value, size) == EXIT_ERROR)
+                    end = EXIT_ERROR;
+                continue;
+            }
+        }
 
-                some_element = some_element->next;
+        if (indexed && AK_index_delete_row(table, old_row, &rid) == EXIT_ERROR)
+        {
+            printf("AK_update_row: ERROR. Row %d in block %d of table %s can not be removed from its indexes, it is not updated.\n",
+                   rid.slot, rid.block, table);
+            end = EXIT_ERROR;
+            continue;
+        }
+        if (in_place)
+        {
+            for (head = 0; head < num_attr; head++)
+            {
+                entry = &temp_block->tuple_dict[slot * num_attr + head];
+                memcpy(temp_block->data + entry->address, value[head], size[head]);
+                entry->type = type[head];
             }
-            head++; //next header
         }
-        if (exists_equal_attrib == 1 && del == 1)
+        else
         {
-            int j;
-            for (j = i - attPlace; j < i + head - attPlace; j++)
+            //the first free slot is this one or one before it, so the row is not met again
+            AK_delete_slot(temp_block, slot, num_attr);
+            rid.slot = AK_write_row_to_slot(temp_block, num_attr, type, value, size);
+            if (rid.slot == EXIT_ERROR)
             {
-                AK_DeleteAll_L3(&new_data);
-                int a = temp_block->tuple_dict[j].address;
-                int s = temp_block->tuple_dict[j].size;
-                if (a > 0 && s > 0)
-                {
-                    memset(entry_data, '\0', MAX_VARCHAR_LENGTH);
-                    memcpy(entry_data, temp_block->data + a, s);
-                }
-                some_element = row_root;
-                while (some_element)
-                {
-                    // save data from roow_root in a list new_data where whole row is being inserted
-                    AK_Insert_New_Element(temp_block->tuple_dict[j].type, some_element->data, some_element->table, some_element->attribute_name, new_data);
-                    if (strcmp(some_element->attribute_name, temp_block->header[j % head].att_name) == 0 && some_element->constraint == NEW_VALUE)
-                    {
-                        // we need to delete and insert row, because size of new data is larger than size of old data
-                        if (strlen(some_element->data) > s)
-                        {
-                            for (int k = i - attPlace; k < i + head - attPlace; k++)
-                            {
-                                int o = temp_block->tuple_dict[k].address;
-                                int p = temp_block->tuple_dict[k].size;
-                                memset(entry_data, '\0', MAX_VARCHAR_LENGTH);
-                                memcpy(entry_data, temp_block->data + o, p);
-                                // if att_names are different, this is old data, and we need to insert it again
-                                if (strcmp(some_element->attribute_name, temp_block->header[k % head].att_name) != 0)
-                                    AK_Insert_New_Element(temp_block->tuple_dict[k].type, entry_data, some_element->table, temp_block->header[k % head].att_name, new_data);
-
-                                temp_block->tuple_dict[k].size = 0;
-                                temp_block->tuple_dict[k].type = 0;
-                                temp_block->tuple_dict[k].address = 0;
-                            }
-                            // insert new data
-                            AK_insert_row(new_data);
-                        }
-                        // we need to update row
-                        else { 
-                            if (s > 0) {
-                                memcpy(temp_block->data + a, some_element->data, s);
-                            }
-                            else {
-                                memcpy(temp_block->data + a, some_element->data, strlen(some_element->data) + 1);
-                            }
-                            
-                        }
-                            // memcpy(temp_block->data + a, some_element->data, s);
-                    }
-                    //some_element = (struct list_node *) AK_Next_L2(some_element);
-                    some_element = some_element->next;
-                }
+                //the old values fitted before, so they are written back
+                rid.slot = AK_insert_compact_row_to_slot(old_row, temp_block);
+                if (indexed && rid.slot != EXIT_ERROR)
+                    AK_index_insert_row(table, old_row, &rid);
+                end = EXIT_ERROR;
+                continue;
             }
         }
-        del = 1;
+        if (!indexed || (AK_row_from_slot(new_row, temp_block, rid.slot) == EXIT_SUCCESS
+            && AK_index_insert_row(table, new_row, &rid) == EXIT_SUCCESS))
+            continue;
+
+        //the new key can not be indexed, the old row gets back its values and its index entries
+        printf("AK_update_row: ERROR. Row %d in block %d of table %s can not be added to its indexes, it is not updated.\n",
+               rid.slot, rid.block, table);
+        if (in_place)
+        {
+            for (head = 0; head < num_attr; head++)
+            {
+                entry = &temp_block->tuple_dict[slot * num_attr + head];
+                memcpy(temp_block->data + entry->address, AK_row_get(old_row, head, &entry->type, NULL), entry->size);
+            }
+        }
+        else
+        {
+            AK_delete_slot(temp_block, rid.slot, num_attr);
+            rid.slot = AK_insert_compact_row_to_slot(old_row, temp_block);
+        }
+        if (rid.slot != EXIT_ERROR)
+            AK_index_insert_row(table, old_row, &rid);
+        end = EXIT_ERROR;
     }
-    // everything from new data has been copied so we can deallocate all in list - corr. Elvis Popovic
-    AK_DeleteAll_L3(&new_data);
-    AK_free(new_data);
+    AK_row_free(old_row);
+    AK_row_free(new_row);
     AK_EPI;
-    return EXIT_SUCCESS;
+    return end;
+}
+
+/**
+   * @author Matija Novak, updated by Dino Laktašić, updated by Mario Peroković - separated from deletion, updated by Antun Tkalčec (fixed SIGSEGV), updated by agent (slots, index maintenance)
+   * @brief Function updates rows of a table in given block, see AK_update_rows_in_block. Rows that do not fit into
+   *        the block any more are moved to other blocks of the table afterwards.
+   * @param temp_block block to work with
+   * @param row_list list of elements which contain data for delete or update
+   * @return EXIT_SUCCESS, EXIT_ERROR if a row could not be updated
+*/
+int AK_update_row_from_block(AK_block *temp_block, struct list_node *row_root)
+{
+    AK_moved_rows moved;
+    int end;
+    AK_PRO;
+    memset(&moved, 0, sizeof(AK_moved_rows));
+    end = AK_update_rows_in_block(temp_block, row_root, &moved);
+    if (AK_moved_rows_place(((struct list_node *)AK_First_L2(row_root))->table, &moved) == EXIT_ERROR)
+        end = EXIT_ERROR;
+    AK_EPI;
+    return end;
 }
 
 /**
-   * @author Matija Novak, updated by Dino Laktašić, changed by Davorin Vukelic, updated by Mario Peroković
-   * @brief Function deletes row from table in given block. Given list of elements is firstly back-upped.
+   * @author Matija Novak, updated by Dino Laktašić, changed by Davorin Vukelic, updated by Mario Peroković, updated by agent (slots)
+   * @brief Function deletes rows from table in given block. Every row whose values are equal to all search constraints
+   *        in the list is deleted and removed from the indexes of the table, the data area is compacted afterwards.
+   *        A row that can not be removed from an index is not deleted.
    * @param temp_block block to work with
    * @param row_list list of elements which contain data for delete or update
    * @return No return value
 */
 void AK_delete_row_from_block(AK_block *temp_block, struct list_node *row_root)
 {
-    int head = 0;                        //counting headers
-    int attPlace = 0;                    //place of attribute which are same
-    int del = 1;                         //if can delete gorup of tuple dicts which are in the same row of table
-    int exists_equal_attrib = 0;         //if we found at least one header in the list
-    char entry_data[MAX_VARCHAR_LENGTH]; //entry data when haeader is found in list which is copied to compare with data in block
+    char *table = ((struct list_node *)AK_First_L2(row_root))->table;
+    int num_attr = AK_block_num_attr(temp_block);
+    int slot, head, del, exists_equal_attrib, deleted = 0;
+    AK_tuple_dict *entry;
+    struct list_node *some_element;
     AK_PRO;
-    struct list_node *row_root_backup = (struct list_node *)AK_malloc(sizeof(struct list_node));
-    AK_Init_L3(&row_root_backup);
 
-    struct list_node *some_element = (struct list_node *)AK_First_L2(row_root);
+    for (slot = 0; num_attr > 0 && (slot + 1) * num_attr <= DATA_BLOCK_SIZE; slot++)
+    {
+        if (temp_block->tuple_dict[slot * num_attr].type == FREE_INT)
+            break;
+        if (!AK_slot_is_live(temp_block, slot, num_attr))
+            continue;
+
+        del = 1;
+        exists_equal_attrib = 0;
+        for (some_element = row_root; some_element != NULL && del; some_element = some_element->next)
+        {
+            if (some_element->constraint != SEARCH_CONSTRAINT)
+                continue;
+            for (head = 0; head < num_attr; head++)
+                if (strcmp(some_element->attribute_name, temp_block->header[head].att_name) == 0)
+                    break;
+            if (head == num_attr)
+                continue;
+
+            //if one constraint doesn't match we don't delete
+            exists_equal_attrib = 1;
+            entry = &temp_block->tuple_dict[slot * num_attr + head];
+            if (entry->size != AK_type_size(some_element->type, some_element->data)
+                || memcmp(temp_block->data + entry->address, some_element->data, entry->size) != 0)
+                del = 0;
+        }
 
-    while (some_element)
-    { //make a copy of list
-        AK_Insert_New_Element_For_Update(some_element->type, some_element->data, some_element->table, some_element->attribute_name, row_root_backup, some_element->constraint);
-        //some_element = (struct list_node *) AK_Next_L2(some_element);
-        some_element = some_element->next;
+        //a row that can not be taken out of the indexes is kept, so no index entry points to a deleted slot
+        if (exists_equal_attrib && del)
+        {
+            if (AK_index_slot(table, temp_block, slot, 0) == EXIT_ERROR)
+            {
+                printf("AK_delete_row: ERROR. Row %d in block %d of table %s could not be removed from its indexes, it is not deleted.\n",
+                       slot, temp_block->address, table);
+                continue;
+            }
+            AK_delete_slot(temp_block, slot, num_attr);
+            deleted++;
+        }
     }
 
-    int i, overflow, address, size;
+    if (deleted > 0)
+        AK_compact_block(temp_block);
+    AK_EPI;
+}
 
-    for (i = 0; i < DATA_BLOCK_SIZE; i++)
-    { //AK_freeze point, if there is no i++
-        head = 0;
-        attPlace = 0;
-        address = temp_block->tuple_dict[i].address;
-        size = temp_block->tuple_dict[i].size;
-        overflow = address + size;
-
-        while (strcmp(temp_block->header[head].att_name, "\0") != 0)
-        { //going through headers
-            some_element = row_root;
-
-            while (some_element)
-            {
-                //if we found header that is constraint in list
-                if ((strcmp(some_element->attribute_name, temp_block->header[head].att_name) == 0) && (some_element->constraint == SEARCH_CONSTRAINT))
-                {
+/**
+   * @author agent
+   * @brief Function deletes the row with the given RID and removes it from the indexes of the table. Referential
+   *        integrity is not checked, see AK_delete_row.
+   * @param table table name
+   * @param rid RID of the row
+   * @return EXIT_SUCCESS if the row has been deleted, EXIT_ERROR if there is no such row or it can not be removed
+   *         from an index of the table
+*/
+int AK_delete_row_by_rid(char *table, AK_rid *rid)
+{
+    AK_mem_block *mem_block;
+    int num_attr;
+    AK_PRO;
 
-                    exists_equal_attrib = 1;
-                    attPlace = head;
+    mem_block = AK_get_block(rid->block);
+    num_attr = AK_block_num_attr(mem_block->block);
+    if (!AK_slot_is_live(mem_block->block, rid->slot, num_attr))
+    {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    if (AK_index_slot(table, mem_block->block, rid->slot, 0) == EXIT_ERROR)
+    {
+        printf("AK_delete_row_by_rid: ERROR. Row %d in block %d of table %s could not be removed from its indexes.\n",
+               rid->slot, rid->block, table);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    AK_delete_slot(mem_block->block, rid->slot, num_attr);
+    AK_compact_block(mem_block->block);
+    AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+    AK_fsm_update_block(mem_block->block);
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
 
-                    if ((overflow < (temp_block->AK_free_space + 1)) && (overflow > -1))
-                    {
-                        //before there was for loop to clear (check if memset works correct)
-                        memset(entry_data, '\0', MAX_VARCHAR_LENGTH);
-                        memcpy(entry_data, temp_block->data + address, size);
+/**
+ * @author agent
+ * @brief  Function that fetches all values of the row with the given RID and puts them on the list. Unlike
+ * AK_get_row, the row is read from its block directly.
+ * @param rid RID of the row
+ * @return row values list, NULL if there is no such row
+ */
+struct list_node *AK_get_row_by_rid(AK_rid *rid)
+{
+    AK_mem_block *mem_block;
+    struct list_node *row_root;
+    char data[MAX_VARCHAR_LENGTH];
+    int num_attr, l, id, size;
+    AK_PRO;
 
-                        if (strcmp(entry_data, some_element->data) != 0)
-                            del = 0; //if one constraint doesn't metch we dont delete or update
-                    }
-                    else
-                        del = 0;
-                }
-                some_element = some_element->next;
-            }
-            head++;
-        }
+    mem_block = AK_get_block(rid->block);
+    num_attr = AK_block_num_attr(mem_block->block);
+    if (!AK_slot_is_live(mem_block->block, rid->slot, num_attr))
+    {
+        AK_EPI;
+        return NULL;
+    }
 
-        if ((exists_equal_attrib == 1) && (del == 1))
-        {
-            for (int j = i - attPlace; j < i + head - attPlace; j++)
-            { //delete one row
-
-                int k = temp_block->tuple_dict[j].address;
-                int l = temp_block->tuple_dict[j].size;
-                memset(temp_block->data + k, '\0', l);
-                AK_dbg_messg(HIGH, FILE_MAN, "update_delete_row_from_block: from: %d, to: %d\n", k, l + k);
-
-                //clean tuple dict
-                temp_block->tuple_dict[j].size = 0;
-                temp_block->tuple_dict[j].type = 0;
-                temp_block->tuple_dict[j].address = 0;
-            }
-        }
-        del = 1;
-        exists_equal_attrib = 0;
+    row_root = (struct list_node *)AK_calloc(1, sizeof(struct list_node));
+    AK_Init_L3(&row_root);
+    for (l = 0; l < num_attr; l++)
+    {
+        id = rid->slot * num_attr + l;
+        size = mem_block->block->tuple_dict[id].size;
+        if (size >= MAX_VARCHAR_LENGTH)
+            size = MAX_VARCHAR_LENGTH - 1;
+        memcpy(data, mem_block->block->data + mem_block->block->tuple_dict[id].address, size);
+        data[size] = '\0';
+        AK_InsertAtEnd_L3(mem_block->block->tuple_dict[id].type, data, size, row_root);
     }
-    AK_free(row_root_backup);
     AK_EPI;
+    return row_root;
 }
 
 /**
-      * @author Matija Novak, updated by Matija Šestak (function now uses caching)
+      * @author Matija Novak, updated by Matija Šestak (function now uses caching), updated by agent (free space map)
       * @brief Function updates or deletes the whole segment of an table. Addresses for given table atr fetched. For each block
-        in extent row is updated or deleted according to operator del.
+        in extent row is updated or deleted according to operator del. The free space map is updated for every block.
+        Every block is pinned while it is changed. Updated rows that do not fit into their block any more are moved
+        after the last block, see AK_moved_rows_place.
       * @param row_root elements of one row
       * @param del - DELETE or UPDATE
-      * @return EXIT_SUCCESS if success
+      * @return EXIT_SUCCESS if success, EXIT_ERROR if a block could not be read or a row could not be updated
 */
 int AK_delete_update_segment(struct list_node *row_root, int del)
 {
     char table[MAX_ATT_NAME];
+    AK_moved_rows moved;
+    int end = EXIT_SUCCESS;
     AK_PRO;
+    memset(&moved, 0, sizeof(AK_moved_rows));
     struct list_node *some_element = (struct list_node *)AK_First_L2(row_root);
 
     strcpy(table, some_element->table);
@@ -494,25 +1387,34 @@ int AK_delete_update_segment(struct list_node *row_root, int del)
             for (i = startAddress; i <= addresses->address_to[j]; i++)
             { //going through blocks
                 AK_dbg_messg(HIGH, FILE_MAN, "delete_update_segment: delete_update block: %d\n", i);
-                mem_block = (AK_mem_block *)AK_get_block(i);
+                mem_block = AK_pin_block(i);
+                if (mem_block == NULL)
+                {
+                    end = EXIT_ERROR;
+                    continue;
+                }
 
                 if (del == DELETE)
                     AK_delete_row_from_block(mem_block->block, row_root);
-                else
-                    AK_update_row_from_block(mem_block->block, row_root);
-                AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+                else if (AK_update_rows_in_block(mem_block->block, row_root, &moved) == EXIT_ERROR)
+                    end = EXIT_ERROR;
+                AK_fsm_update_block(mem_block->block);
+                AK_unpin_block(mem_block, BLOCK_DIRTY);
             }
         }
         else
             break;
     }
     AK_free(addresses);
+    if (AK_moved_rows_place(table, &moved) == EXIT_ERROR)
+        end = EXIT_ERROR;
     AK_EPI;
-    return EXIT_SUCCESS;
+    return end;
 }
 
 /** @author Matija Novak, Dejan Frankovic (added referential integrity)
-        @brief Function deletes rows
+        @brief Function deletes rows. Deletes are not written to the redo log, recovery replays inserts only, so a
+        delete that has not reached the disk is lost after a crash.
         @param row_root elements of one row
         @returs EXIT_SUCCESS if success
  */
@@ -566,12 +1468,14 @@ void AK_delete_row_by_id(int id, char *tableName)
 }
 
 /** @author Matija Novak, Dejan Frankovic (added referential integrity)
-        @brief Function updates rows of some table
+        @brief Function updates rows of some table. Updates are not written to the redo log, recovery replays inserts
+        only, so an update that has not reached the disk is lost after a crash.
         @param row_root elements of one row
-        @return EXIT_SUCCESS if success
+        @return EXIT_SUCCESS if success, EXIT_ERROR if a row could not be updated
 */
 int AK_update_row(struct list_node *row_root)
 {
+    int end;
     AK_PRO;
     if (AK_reference_check_restricion(row_root, UPDATE) == EXIT_ERROR)
     {
@@ -584,9 +1488,9 @@ int AK_update_row(struct list_node *row_root)
 
     if (AK_reference_check_if_update_needed(row_root, UPDATE) == EXIT_SUCCESS)
         AK_reference_update(row_root, UPDATE);
-    AK_delete_update_segment(row_root, UPDATE);
+    end = AK_delete_update_segment(row_root, UPDATE);
     AK_EPI;
-    return EXIT_SUCCESS;
+    return end;
 }
 
 TestResult AK_fileio_test()
@@ -695,6 +1599,164 @@ TestResult AK_fileio_test()
 
     AK_print_table("testna");
 
+    //rows are addressed by RID, a deleted slot is reused and its data space reclaimed
+    AK_rid rid, reused;
+    struct list_node *row;
+    int used;
+
+    AK_DeleteAll_L3(&row_root);
+    number = 100;
+    AK_Insert_New_Element(TYPE_INT, &number, "testna", "Redni_broj", row_root);
+    AK_Insert_New_Element(TYPE_VARCHAR, "Slot", "testna", "Ime", row_root);
+    row = NULL;
+    if (AK_insert_row_rid(row_root, &rid) == EXIT_SUCCESS && (row = AK_get_row_by_rid(&rid)) != NULL
+        && memcmp(((struct list_node *)AK_First_L2(row))->data, &number, sizeof(int)) == 0
+        && AK_slot_null_bitmap(AK_get_block(rid.block)->block, rid.slot, 3) == 4)
+        ok++;
+    else
+        fail++;
+    if (row != NULL)
+    {
+        AK_DeleteAll_L3(&row);
+        AK_free(row);
+    }
+
+    used = AK_get_block(rid.block)->block->AK_free_space;
+    if (AK_delete_row_by_rid("testna", &rid) == EXIT_SUCCESS && AK_get_row_by_rid(&rid) == NULL
+        && AK_get_block(rid.block)->block->AK_free_space < used
+        && AK_insert_row_rid(row_root, &reused) == EXIT_SUCCESS && reused.block == rid.block && reused.slot == rid.slot
+        && AK_delete_row_by_rid("testna", &reused) == EXIT_SUCCESS)
+        ok++;
+    else
+        fail++;
+
+    //a compact row keeps the values in header order, missing values are null
+    AK_header *compact_header = (AK_header *)AK_get_header("testna");
+    AK_row *compact = AK_row_new(compact_header, 3), *read_back = AK_row_new(compact_header, 3);
+    char *value;
+    int value_type, value_size;
+
+    AK_DeleteAll_L3(&row_root);
+    number = 200;
+    AK_Insert_New_Element(TYPE_VARCHAR, "Kompakt", "testna", "Ime", row_root);
+    AK_Insert_New_Element(TYPE_INT, &number, "testna", "Redni_broj", row_root);
+    if (compact != NULL && AK_row_from_list(compact, row_root) == EXIT_SUCCESS && compact->count == 3
+        && (value = AK_row_get(compact, 0, &value_type, &value_size)) != NULL && value_type == TYPE_INT
+        && value_size == sizeof(int) && memcmp(value, &number, sizeof(int)) == 0
+        && (value = AK_row_get(compact, AK_row_attr_index(compact, "Prezime"), NULL, &value_size)) != NULL
+        && value_size == 4 && memcmp(value, "null", 4) == 0 && AK_row_get(compact, 3, NULL, NULL) == NULL)
+        ok++;
+    else
+        fail++;
+
+    if (compact != NULL && read_back != NULL && AK_insert_compact_row("testna", compact, &rid) == EXIT_SUCCESS
+        && AK_row_from_slot(read_back, AK_get_block(rid.block)->block, rid.slot) == EXIT_SUCCESS
+        && read_back->count == 3 && read_back->offset[3] == compact->offset[3]
+        && memcmp(read_back->data, compact->data, compact->offset[3]) == 0
+        && AK_delete_row_by_rid("testna", &rid) == EXIT_SUCCESS
+        && AK_row_from_slot(read_back, AK_get_block(rid.block)->block, rid.slot) == EXIT_ERROR)
+        ok++;
+    else
+        fail++;
+
+    //a row that grows beyond the free space of its block is moved to another block and not lost
+    char filler[MAX_VARCHAR_LENGTH];
+    int records, filled;
+
+    AK_DeleteAll_L3(&row_root);
+    number = 300;
+    AK_Insert_New_Element(TYPE_INT, &number, "testna", "Redni_broj", row_root);
+    AK_Insert_New_Element(TYPE_VARCHAR, "Raste", "testna", "Ime", row_root);
+    AK_insert_row_rid(row_root, &rid);
+
+    memset(filler, 'x', 150);
+    filler[150] = '\0';
+    AK_DeleteAll_L3(&row_root);
+    number = 301;
+    AK_Insert_New_Element(TYPE_INT, &number, "testna", "Redni_broj", row_root);
+    AK_Insert_New_Element(TYPE_VARCHAR, filler, "testna", "Prezime", row_root);
+    //the rest of the block of the row is filled, so the grown row has to leave it
+    for (filled = 0; filled < 100 && AK_insert_row_to_block(row_root, AK_get_block(rid.block)->block) == EXIT_SUCCESS; filled++)
+        ;
+    AK_mem_block_modify(AK_get_block(rid.block), BLOCK_DIRTY);
+    AK_fsm_update_block(AK_get_block(rid.block)->block);
+
+    records = AK_get_num_records("testna");
+    memset(filler, 'y', 190);
+    filler[190] = '\0';
+    AK_DeleteAll_L3(&row_root);
+    number = 300;
+    AK_Update_Existing_Element(TYPE_INT, &number, "testna", "Redni_broj", row_root);
+    AK_Insert_New_Element(TYPE_VARCHAR, filler, "testna", "Prezime", row_root);
+    if (filled < 100 && AK_update_row(row_root) == EXIT_SUCCESS && AK_get_row_by_rid(&rid) == NULL
+        && AK_get_num_records("testna") == records)
+        ok++;
+    else
+        fail++;
+
+    AK_DeleteAll_L3(&row_root);
+    AK_Update_Existing_Element(TYPE_INT, &number, "testna", "Redni_broj", row_root);
+    AK_delete_row(row_root);
+    AK_DeleteAll_L3(&row_root);
+    number = 301;
+    AK_Update_Existing_Element(TYPE_INT, &number, "testna", "Redni_broj", row_root);
+    AK_delete_row(row_root);
+
+    //a block whose slots have all been used is offered by the free space map again once one of its rows is deleted
+    AK_header fsm_header[6];
+    table_addresses *fsm_addresses;
+    char fsm_attribute[MAX_ATT_NAME];
+    int attribute, first_block = EXIT_ERROR;
+
+    memset(fsm_header, 0, sizeof(fsm_header));
+    for (attribute = 0; attribute < 5; attribute++)
+    {
+        fsm_header[attribute].type = TYPE_INT;
+        sprintf(fsm_header[attribute].att_name, "Broj%d", attribute);
+    }
+    if (!AK_table_exist("fileio_fsm_test"))
+        AK_initialize_new_segment("fileio_fsm_test", SEGMENT_TYPE_TABLE, fsm_header);
+
+    number = 7;
+    AK_DeleteAll_L3(&row_root);
+    for (attribute = 0; attribute < 5; attribute++)
+    {
+        sprintf(fsm_attribute, "Broj%d", attribute);
+        AK_Insert_New_Element(TYPE_INT, &number, "fileio_fsm_test", fsm_attribute, row_root);
+    }
+    for (filled = 0; filled < 200 && AK_insert_row_rid(row_root, &rid) == EXIT_SUCCESS; filled++)
+    {
+        if (first_block == EXIT_ERROR)
+        {
+            first_block = rid.block;
+            reused = rid;
+        }
+        else if (rid.block != first_block)
+            break;
+    }
+    fsm_addresses = AK_get_table_addresses("fileio_fsm_test");
+    if (first_block != EXIT_ERROR && rid.block != first_block && AK_delete_row_by_rid("fileio_fsm_test", &reused) == EXIT_SUCCESS
+        && AK_fsm_find_block(fsm_addresses, 5 * sizeof(int)) == first_block)
+        ok++;
+    else
+        fail++;
+    AK_free(fsm_addresses);
+
+    //a block the free space map still offers after it was filled behind its back does not make the insert fail
+    while (first_block != EXIT_ERROR && AK_insert_row_to_block(row_root, AK_get_block(first_block)->block) != EXIT_ERROR)
+        ;
+    if (first_block != EXIT_ERROR && AK_insert_row_rid(row_root, &rid) == EXIT_SUCCESS && rid.block != first_block)
+        ok++;
+    else
+        fail++;
+
+    AK_DeleteAll_L3(&row_root);
+    AK_Update_Existing_Element(TYPE_INT, &number, "fileio_fsm_test", "Broj0", row_root);
+    AK_delete_row(row_root);
+
+    AK_row_free(compact);
+    AK_row_free(read_back);
+    AK_free(compact_header);
     AK_DeleteAll_L3(&row_root);
     AK_free(row_root);
     AK_EPI;
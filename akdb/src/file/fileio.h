@@ -29,6 +29,30 @@
 #include "files.h"
 #include "../auxi/mempro.h"
 
+/**
+ * @author agent
+ * @struct AK_row
+ * @brief Structure that defines a compact row. The values of one tuple are stored back to back in one buffer; value i
+ * starts at data + offset[i] and ends at data + offset[i + 1]. The structure, its arrays and the buffer are a single
+ * allocation that is reused for every tuple of a scan.
+ */
+typedef struct {
+    /// header of the table the values belong to (not owned); value i belongs to header[i]
+    AK_header *header;
+    /// number of attributes of the header
+    int num_attr;
+    /// number of values in the row
+    int count;
+    /// size of the data buffer
+    int capacity;
+    /// data type of every value
+    int *type;
+    /// start of every value in data, offset[count] is the end of the last value
+    int *offset;
+    /// values
+    char *data;
+} AK_row;
+
 /**
    * @author Matija Novak
    * @brief !! YOU PROBABLY DON'T WANT TO USE THIS FUNCTION !! - Use AK_Update_Existing_Element or AK_Insert_New_Element instead. 
@@ -59,15 +83,70 @@ void AK_Insert_New_Element_For_Update(int newtype, void * data, char * table, ch
  */
 void AK_Insert_New_Element(int newtype, void * data, char * table, char * attribute_name, struct list_node * ElementBefore);
 
-/** @author Matija Novak, updated by Dino Laktašić
-        @brief Function inserts one row into some block.  Firstly it checks wether block contain attributes from the list. Then
-               data, type, size and last_tuple_id are put in temp_block.
+/**
+ * @author agent
+ * @brief Function that returns the number of attributes described by the header of a block
+ * @param block block of a table
+ * @return number of attributes (width of a slot in tuple_dict entries)
+ */
+int AK_block_num_attr(AK_block *block);
+
+/**
+ * @author agent
+ * @brief Function that finds the first slot of a block where a row can be written. Unused slots and slots of deleted
+ *        rows are both free.
+ * @param block block of a table
+ * @param num_attr number of attributes of the table
+ * @return slot number, EXIT_ERROR if the block has no free slot
+ */
+int AK_find_free_slot(AK_block *block, int num_attr);
+
+/**
+ * @author agent
+ * @brief Function that checks whether a slot holds a row
+ * @param block block of a table
+ * @param slot slot number
+ * @param num_attr number of attributes of the table
+ * @return 1 if the slot holds a row, 0 if it is deleted, unused or out of range
+ */
+int AK_slot_is_live(AK_block *block, int slot, int num_attr);
+
+/**
+ * @author agent
+ * @brief Function that returns the null bitmap of a row. NULL values are stored as the varchar "null".
+ * @param block block of a table
+ * @param slot slot number
+ * @param num_attr number of attributes of the table
+ * @return bitmap with bit i set if attribute i of the row is NULL
+ */
+unsigned int AK_slot_null_bitmap(AK_block *block, int slot, int num_attr);
+
+/**
+ * @author agent
+ * @brief Function that compacts the data area of a block. Data of the remaining entries is moved to the beginning of
+ *        the area, so the space of deleted rows can be used again. Slots are not moved, RIDs stay valid.
+ * @param block block of a table
+ * @return number of bytes reclaimed
+ */
+int AK_compact_block(AK_block *block);
+
+/** @author Matija Novak, updated by Dino Laktašić, updated by agent (slots)
+        @brief Function inserts one row into some block. The row is written to the first free slot of the block.
         @param row_root list of elements to insert
         @param temp_block block in which we insert data
-        @return EXIT SUCCES if success
+        @return EXIT_SUCCESS if success, EXIT_ERROR if the block has no room for the row
  */
 int AK_insert_row_to_block(struct list_node *row_root, AK_block *temp_block);
 
+/** @author Matija Novak, updated by agent (slots)
+        @brief Function inserts a one row into table and returns its RID, see AK_insert_row. The indexes of the table
+        are updated before the row is committed in the redo log, a row that can not be indexed is not inserted.
+        @param row_root list of elements which contain data of one row
+        @param rid if not NULL, receives the RID of the new row
+        @return EXIT_SUCCESS if success else EXIT_ERROR
+ */
+int AK_insert_row_rid(struct list_node *row_root, AK_rid *rid);
+
 /** @author Matija Novak, updated by Matija Šestak (function now uses caching), updated by Dejan Frankovic (added reference check), updated by Dino         Laktašić (removed variable AK_free, variable table initialized using memset)
         @brief Function inserts a one row into table. Firstly it is checked whether inserted row would violite reference integrity.
         Then it is checked in which table should row be inserted. If there is no AK_free space for new table, new extent is allocated. New block is            allocated on given address. Row is inserted in this block and dirty flag is set to BLOCK_DIRTY.
@@ -78,46 +157,166 @@ int AK_insert_row_to_block(struct list_node *row_root, AK_block *temp_block);
 int AK_insert_row(struct list_node *row_root);
 
 /**
-   * @author Matija Novak, updated by Dino Laktašić, updated by Mario Peroković - separated from deletion
-   * @brief Function updates row from table in given block.
+   * @author Matija Novak, updated by Dino Laktašić, updated by Mario Peroković - separated from deletion, updated by agent (slots, index maintenance)
+   * @brief Function updates rows of a table in given block. Every row whose values are equal to all search constraints
+   *        in the list gets the new values from the list and is moved to its new key in the indexes of the table.
+   *        Rows that do not fit into the block any more are moved to other blocks of the table afterwards.
    * @param temp_block block to work with
    * @param row_list list of elements which contain data for delete or update
-   * @return No return value
+   * @return EXIT_SUCCESS, EXIT_ERROR if a row could not be updated
 */
 int AK_update_row_from_block(AK_block *temp_block, struct list_node *row_root);
 
 /**
-   * @author Matija Novak, updated by Dino Laktašić, changed by Davorin Vukelic, updated by Mario Peroković
-   * @brief Function deletes row from table in given block. Given list of elements is firstly back-upped.
+   * @author Matija Novak, updated by Dino Laktašić, changed by Davorin Vukelic, updated by Mario Peroković, updated by agent (slots)
+   * @brief Function deletes rows from table in given block. Every row whose values are equal to all search constraints
+   *        in the list is deleted and removed from the indexes of the table, the data area is compacted afterwards.
+   *        A row that can not be removed from an index is not deleted.
    * @param temp_block block to work with
    * @param row_list list of elements which contain data for delete or update
    * @return No return value
 */
 void AK_delete_row_from_block(AK_block *temp_block, struct list_node *row_root);
 
+/**
+   * @author agent
+   * @brief Function deletes the row with the given RID and removes it from the indexes of the table. Referential
+   *        integrity is not checked, see AK_delete_row.
+   * @param table table name
+   * @param rid RID of the row
+   * @return EXIT_SUCCESS if the row has been deleted, EXIT_ERROR if there is no such row or it can not be removed
+   *         from an index of the table
+*/
+int AK_delete_row_by_rid(char *table, AK_rid *rid);
+
+/**
+ * @author agent
+ * @brief  Function that fetches all values of the row with the given RID and puts them on the list
+ * @param rid RID of the row
+ * @return row values list, NULL if there is no such row
+ */
+struct list_node *AK_get_row_by_rid(AK_rid *rid);
+
 /**
       * @author Matija Novak, updated by Matija Šestak (function now uses caching)
       * @brief Function updates or deletes the whole segment of an table. Addresses for given table atr fetched. For each block
-        in extent row is updated or deleted according to operator del.
+        in extent row is updated or deleted according to operator del. Updated rows that do not fit into their block
+        any more are moved after the last block.
       * @param row_root elements of one row
       * @param del - DELETE or UPDATE
-      * @return EXIT_SUCCESS if success
+      * @return EXIT_SUCCESS if success, EXIT_ERROR if a block could not be read or a row could not be updated
 */
 int AK_delete_update_segment(struct list_node *row_root, int del);
 
 /** @author Matija Novak, Dejan Frankovic (added referential integrity)
-        @brief Function deletes rows
+        @brief Function deletes rows. Deletes are not written to the redo log, recovery replays inserts only, so a
+        delete that has not reached the disk is lost after a crash.
         @param row_root elements of one row
         @returs EXIT_SUCCESS if success
  */
 int AK_delete_row(struct list_node *row_root) ;
 
 /** @author Matija Novak, Dejan Frankovic (added referential integrity)
-        @brief Function updates rows of some table
+        @brief Function updates rows of some table. Updates are not written to the redo log, recovery replays inserts
+        only, so an update that has not reached the disk is lost after a crash.
         @param row_root elements of one row
-        @return EXIT_SUCCESS if success
+        @return EXIT_SUCCESS if success, EXIT_ERROR if a row could not be updated
 */
 int AK_update_row(struct list_node *row_root);
+/**
+ * @author agent
+ * @brief  Function that allocates a compact row for a table header
+ * @param header header of the table (not copied, it has to outlive the row)
+ * @param num_attr number of attributes of the header
+ * @return new row, NULL if it can not be allocated
+ */
+AK_row *AK_row_new(AK_header *header, int num_attr);
+
+/**
+ * @author agent
+ * @brief  Function that frees a compact row
+ * @param row row to free
+ */
+void AK_row_free(AK_row *row);
+
+/**
+ * @author agent
+ * @brief  Function that empties a compact row so it can hold the next tuple
+ * @param row row to empty
+ */
+void AK_row_reset(AK_row *row);
+
+/**
+ * @author agent
+ * @brief  Function that appends a value to a compact row
+ * @param row row to append to
+ * @param type data type of the value
+ * @param value value bytes
+ * @param size number of bytes of the value
+ * @return EXIT_SUCCESS, EXIT_ERROR if the row is full
+ */
+int AK_row_append(AK_row *row, int type, const char *value, int size);
+
+/**
+ * @author agent
+ * @brief  Function that returns a value of a compact row
+ * @param row row
+ * @param i index of the value
+ * @param type receives the data type of the value (may be NULL)
+ * @param size receives the number of bytes of the value (may be NULL)
+ * @return pointer to the value inside the row, NULL if there is no such value
+ */
+char *AK_row_get(AK_row *row, int i, int *type, int *size);
+
+/**
+ * @author agent
+ * @brief  Function that returns the index of an attribute in the header of a compact row
+ * @param row row
+ * @param attribute attribute name
+ * @return index of the attribute, EXIT_ERROR if the header has no such attribute
+ */
+int AK_row_attr_index(AK_row *row, const char *attribute);
+
+/**
+ * @author agent
+ * @brief  Function that fills a compact row from a row list. Values are taken by the attribute names of the row header,
+ * attributes missing from the list are set to null.
+ * @param row row to fill
+ * @param row_root list with the values of one row
+ * @return EXIT_SUCCESS, EXIT_ERROR if the values do not fit into the row
+ */
+int AK_row_from_list(AK_row *row, struct list_node *row_root);
+
+/**
+ * @author agent
+ * @brief  Function that adds the values of a compact row to a row list, for functions that still work on lists
+ * @param row row
+ * @param table table name written to the list elements
+ * @param row_root list the values are added to
+ */
+void AK_row_to_list(AK_row *row, char *table, struct list_node *row_root);
+
+/**
+ * @author agent
+ * @brief  Function that reads the row in a slot of a block into a compact row without allocating anything
+ * @param row row to fill
+ * @param block block of the table
+ * @param slot slot number
+ * @return EXIT_SUCCESS, EXIT_ERROR if the slot holds no row
+ */
+int AK_row_from_slot(AK_row *row, AK_block *block, int slot);
+
+/**
+ * @author agent
+ * @brief  Function that inserts a compact row into a table. Values are written by the attribute names of the row header.
+ * Referential integrity and the redo log still work on row lists, so the row is converted for them.
+ * @param table table name
+ * @param row row to insert
+ * @param rid if not NULL, receives the RID of the new row
+ * @return EXIT_SUCCESS if success else EXIT_ERROR
+ */
+int AK_insert_compact_row(char *table, AK_row *row, AK_rid *rid);
+
 TestResult AK_fileio_test();
 
 /**
@@ -60,6 +60,7 @@ int AK_initialize_new_segment(char *name, int type, AK_header *header) {
         AK_Insert_New_Element(TYPE_INT, &end_address, sys_table, "end_address", row_root);
 
         AK_insert_row(row_root);
+        AK_catalog_invalidate();
 
         AK_dbg_messg(LOW, FILE_MAN, "AK_init_new_segment__NOTIFICATION: New segment initialized at %d\n", start_address);
 		AK_DeleteAll_L3(&row_root);
@@ -117,6 +118,7 @@ int AK_initialize_new_index_segment(char *name, char *table_id, int attr_id , AK
         AK_Insert_New_Element(TYPE_INT, &attr_id, sys_table, "attribute_id", row_root);
 
         AK_insert_row(row_root);
+        AK_catalog_invalidate();
 
         AK_dbg_messg(LOW, FILE_MAN, "AK_init_new_segment__NOTIFICATION: New segment initialized at %d\n", start_address);
         AK_EPI;
@@ -17,6 +17,7 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
  */
 #include "filesort.h"
+#include "../rel/iterator.h"
 
 /**
  * @author Unknown
@@ -86,88 +87,29 @@ int AK_get_num_of_tuples(AK_block *iBlock) {
 }
 
 /**
- * @author Tomislav Bobinac, updated by Filip Žmuk
- * @todo Make it to suport multiple sort atributes and ASC|DESC ordering
- * @brief Function that sorts a segment
- * @return No return value.
+ * @author Tomislav Bobinac, updated by Filip Žmuk, updated by agent (external merge sort)
+ * @brief Function that sorts a segment. All rows of the source table, from all of its extents, go through a sort
+ *        node of the iterator executor (see AK_sort_operator), which sorts in memory and merges sorted runs when
+ *        the table does not fit, and are written into the destination table.
+ * @param srcTable source table
+ * @param destTable destination table, it is created
+ * @param attributes attributes to sort by, each optionally followed by a TYPE_OPERATOR element "ASC" or "DESC"
+ * @return EXIT_SUCCESS or EXIT_ERROR
  */
 int AK_sort_segment(char *srcTable, char *destTable, struct list_node* attributes) {
-	//initialize variables
-	register int i, j;
-	int blocks_addr[MAX_NUM_OF_BLOCKS];	//array with block addresses
-	int num_blocks = 0;	//number of blocks in segment
-
+	AK_operator *plan;
+	int rows;
 	AK_PRO;
 
-	//Get number of blocks for given table
-	table_addresses *addresses = (table_addresses *) AK_get_table_addresses(srcTable);
-	for (i = 0; addresses->address_from[i] != 0; i++) {
-		for (j = addresses->address_from[i]; j <= addresses->address_to[i]; j++) {
-			blocks_addr[num_blocks] = j;
-			num_blocks++;
-		}
-	}
-
-	AK_header *head = AK_get_header(srcTable);
-	AK_initialize_new_segment(destTable, SEGMENT_TYPE_TABLE, head);
-
-	//SORTING ...
-	char x[DATA_ROW_SIZE]; 		//needed data
-	char y[DATA_ROW_SIZE]; 		//data needed for comparison
-	char data[DATA_TUPLE_SIZE]; //data to be copied
-
-	AK_mem_block * real_table = (AK_mem_block*) AK_get_block(blocks_addr[0]);
-
-	//get total number of headers and the number of header used to sort segment
-	int num_headers = AK_get_total_headers(real_table->block);
-	int num_sort_header = AK_get_header_number(real_table->block, AK_First_L2(attributes)->data);
-	int num_records = AK_get_num_records(srcTable);
-
-	int type, temp, address, size, temp_field[num_records];
-	for (i = 0; i<num_records; i++) {
-		temp_field[i]=i;
-	}
-
-	for (i = 0; i < num_records - 1; i++) {
-		for (j = i + 1; j < num_records; j++) {
-			//first data -> x
-			address = real_table->block->tuple_dict[(temp_field[i] * num_headers) + num_sort_header].address;
-			size = real_table->block->tuple_dict[(temp_field[i] * num_headers) + num_sort_header].size;
-			memset(x, '\0', MAX_VARCHAR_LENGTH);
-			memcpy(x, real_table->block->data + address, size);
-			//second data -> y
-			address = real_table->block->tuple_dict[(temp_field[j] * num_headers) + num_sort_header].address;
-			size = real_table->block->tuple_dict[(temp_field[j] * num_headers) + num_sort_header].size;
-			memset(y, '\0', MAX_VARCHAR_LENGTH);
-			memcpy(y, real_table->block->data + address, size);
-
-			//comparison (x > y) ASC
-			if (strcmp(x, y) >= 0) {
-				temp=temp_field[i];
-				temp_field[i]=temp_field[j];
-				temp_field[j]=temp;
-			}//end: if(strcmp(x,y) >= 0)
-		}
-	}
-
-	for (i = 0; i<num_records; i++) {
-		//initialize a new row
-		struct list_node *row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
-		AK_Init_L3(&row_root);
-		for (j = 0; j < num_headers; j++) {
-			//get data from column 'j' orginal table -> data
-			address = real_table->block->tuple_dict[j + (temp_field[i] * num_headers)].address;
-			size = real_table->block->tuple_dict[j + (temp_field[i] * num_headers)].size;
-			type = real_table->block->tuple_dict[j + (temp_field[i] * num_headers)].type;
-			memset(data, '\0', MAX_VARCHAR_LENGTH);
-			memcpy(data, real_table->block->data + address, size);
-			//add column 'j' data into struct row_root
-			AK_Insert_New_Element(type, data, destTable, real_table->block->header[j].att_name, row_root);
-		}
-		//add row to new sorted table
-		AK_insert_row(row_root);
-		AK_DeleteAll_L3(&row_root);
+	plan = AK_sort_operator(AK_scan_operator(srcTable), attributes);
+	rows = AK_iterator_materialize(plan, destTable);
+	AK_operator_free(plan);
+	if (rows == EXIT_ERROR) {
+		printf("AK_sort_segment: ERROR. Can not sort table %s into %s.\n", srcTable, destTable);
+		AK_EPI;
+		return EXIT_ERROR;
 	}
+	AK_dbg_messg(MIDDLE, FILE_MAN, "AK_sort_segment: %d rows of %s sorted into %s\n", rows, srcTable, destTable);
 
 	AK_EPI;
 	return EXIT_SUCCESS;
@@ -484,9 +426,49 @@ void AK_block_sort(AK_block * iBlock, char* attribute_name) {
     AK_EPI;
 }
 
+/**
+ * @author agent
+ * @brief Function that checks the order of a sorted table
+ * @param table table name
+ * @param attribute attribute the table is sorted by
+ * @param descending 1 if the table is sorted in descending order
+ * @return number of rows in order, EXIT_ERROR if two rows are out of order
+ */
+static int AK_filesort_check(char *table, char *attribute, int descending) {
+	AK_operator *scan = AK_scan_operator(table);
+	char previous[MAX_VARCHAR_LENGTH], *value;
+	int i, type, size, previous_size = 0, result, rows = 0, in_order = 1;
+	AK_PRO;
+	if (scan == NULL || AK_operator_open(scan) == EXIT_ERROR) {
+		AK_operator_free(scan);
+		AK_EPI;
+		return EXIT_ERROR;
+	}
+	for (i = 0; i < scan->num_attr && strcmp(scan->header[i].att_name, attribute) != 0; i++);
+	while (i < scan->num_attr && AK_operator_next(scan) == AK_ITERATOR_ROW) {
+		value = AK_row_get(scan->row, i, &type, &size);
+		if (size > MAX_VARCHAR_LENGTH)
+			size = MAX_VARCHAR_LENGTH;
+		if (rows > 0) {
+			if (type == TYPE_INT)
+				result = *(int *) previous - *(int *) value;
+			else if ((result = memcmp(previous, value, previous_size < size ? previous_size : size)) == 0)
+				result = previous_size - size;
+			if (descending ? result < 0 : result > 0)
+				in_order = 0;
+		}
+		memcpy(previous, value, size);
+		previous_size = size;
+		rows++;
+	}
+	AK_operator_free(scan);
+	AK_EPI;
+	return in_order && i < AK_num_attr(table) ? rows : EXIT_ERROR;
+}
+
 //extern int address_of_tempBlock = 0;
 /*
- * @author Unknown, updated Tomislav Bobinac, Filip Žmuk
+ * @author Unknown, updated Tomislav Bobinac, Filip Žmuk, updated by agent
  * @brief Function that sorts files
  * @return No return value
  */
@@ -497,13 +479,16 @@ TestResult AK_filesort_test() {
     int failed=0;
 	char *srcTable="student";
 	char *destTable="student_sorted";
+	char *destTable2="student_sorted_year";
 
 	AK_print_table(srcTable);
 
     struct list_node* attributes = (struct list_node*) AK_malloc(sizeof(struct list_node));
+    AK_Init_L3(&attributes);
     AK_InsertAtBegin_L3(TYPE_ATTRIBS, "firstname", sizeof("firstname"), attributes); 
 
-	if (AK_sort_segment(srcTable, destTable,  attributes) == EXIT_SUCCESS)
+	if (AK_sort_segment(srcTable, destTable,  attributes) == EXIT_SUCCESS
+		&& AK_filesort_check(destTable, "firstname", 0) == AK_get_num_records(srcTable))
     {
         AK_print_table(destTable);
         success++;
@@ -513,6 +498,77 @@ TestResult AK_filesort_test() {
         failed++;
     }    
 
+	//descending order of the first key, all rows of the table
+	AK_DeleteAll_L3(&attributes);
+	AK_InsertAtEnd_L3(TYPE_ATTRIBS, "year", sizeof("year"), attributes);
+	AK_InsertAtEnd_L3(TYPE_OPERATOR, "DESC", sizeof("DESC"), attributes);
+	AK_InsertAtEnd_L3(TYPE_ATTRIBS, "firstname", sizeof("firstname"), attributes);
+	if (AK_sort_segment(srcTable, destTable2, attributes) == EXIT_SUCCESS
+		&& AK_filesort_check(destTable2, "year", 1) == AK_get_num_records(srcTable))
+	{
+		AK_print_table(destTable2);
+		success++;
+	}
+	else
+	{
+		failed++;
+	}
+
+	//the same order through the iterator with room for one row merges one run per row
+	AK_operator *plan = AK_sort_operator(AK_scan_operator(srcTable), attributes), *full;
+	AK_operator_info info;
+	AK_row *previous;
+	int rows = 0, ordered = AK_operator_set_memory(plan, 1) == EXIT_SUCCESS, result = EXIT_ERROR;
+	int year = plan != NULL ? AK_iterator_attr_index(plan->header, plan->num_attr, "year") : EXIT_ERROR;
+	int firstname = plan != NULL ? AK_iterator_attr_index(plan->header, plan->num_attr, "firstname") : EXIT_ERROR;
+	info.partitions = 0;
+	if (ordered && AK_operator_open(plan) == EXIT_SUCCESS)
+	{
+		AK_operator_describe(plan, &info);
+		previous = AK_row_new(plan->header, plan->num_attr);
+		while ((result = AK_operator_next(plan)) == AK_ITERATOR_ROW)
+		{
+			if (rows > 0 && (AK_iterator_compare_values(previous, year, plan->row, year) < 0
+				|| (AK_iterator_compare_values(previous, year, plan->row, year) == 0
+					&& AK_iterator_compare_values(previous, firstname, plan->row, firstname) > 0)))
+				ordered = 0;
+			AK_iterator_copy_row(previous, plan->row);
+			rows++;
+		}
+		AK_row_free(previous);
+		AK_operator_close(plan);
+	}
+	AK_operator_free(plan);
+	printf("External sort by year DESC, firstname: %d rows from %d runs, %s\n", rows, info.partitions, ordered ? "ordered" : "not ordered");
+	if (ordered && result == AK_ITERATOR_END && rows == AK_get_num_records(srcTable) && info.partitions > 1)
+		success++;
+	else
+		failed++;
+
+	//the first five rows of the same order, kept in a heap, are the rows the full sort produces first
+	plan = AK_sort_limit_operator(AK_scan_operator(srcTable), attributes, 5);
+	full = AK_sort_operator(AK_scan_operator(srcTable), attributes);
+	rows = 0;
+	ordered = plan != NULL && full != NULL && AK_operator_open(plan) == EXIT_SUCCESS && AK_operator_open(full) == EXIT_SUCCESS;
+	while (ordered && AK_operator_next(plan) == AK_ITERATOR_ROW)
+	{
+		if (AK_operator_next(full) != AK_ITERATOR_ROW || AK_iterator_compare_values(plan->row, year, full->row, year) != 0
+			|| AK_iterator_compare_values(plan->row, firstname, full->row, firstname) != 0)
+			ordered = 0;
+		rows++;
+	}
+	AK_operator_free(plan);
+	AK_operator_free(full);
+	printf("Top 5 by year DESC, firstname: %d rows, %s\n", rows, ordered ? "as in the full sort" : "not as in the full sort");
+	if (ordered && rows == 5)
+		success++;
+	else
+		failed++;
+	AK_DeleteAll_L3(&attributes);
+	AK_free(attributes);
+	AK_delete_segment(destTable, SEGMENT_TYPE_TABLE);
+	AK_delete_segment(destTable2, SEGMENT_TYPE_TABLE);
+
 	AK_EPI;
     return TEST_result(success,failed);
 }
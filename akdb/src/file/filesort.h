@@ -62,10 +62,13 @@ int AK_get_header_number(AK_block *iBlock, char *attribute_name);
 int AK_get_num_of_tuples(AK_block *iBlock);
 
 /**
- * @author Tomislav Bobinac, updated by Filip Žmuk
- * @todo Make it to suport multiple sort atributes and ASC|DESC ordering
- * @brief Function that sorts a segment
- * @return No return value.
+ * @author Tomislav Bobinac, updated by Filip Žmuk, updated by agent (external merge sort)
+ * @brief Function that sorts all rows of a table into a new table by one or more attributes, each ascending or
+ *        descending. Tables larger than the sort memory are sorted in runs which are merged.
+ * @param srcTable source table
+ * @param destTable destination table, it is created
+ * @param attributes attributes to sort by, each optionally followed by a TYPE_OPERATOR element "ASC" or "DESC"
+ * @return EXIT_SUCCESS or EXIT_ERROR
  */
 int AK_sort_segment(char *srcTable, char *destTable, struct list_node* attributes);
 
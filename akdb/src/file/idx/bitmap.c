@@ -46,7 +46,7 @@
 }
 
 /**
- * @author Saša Vukšić, Lovro Predovan
+ * @author Saša Vukšić, Lovro Predovan, updated by agent (index registered on the table)
  * @brief Function that reads table on which we create index and call functions for creating index
            Elements that will be in index are put in list indexLista and headerAttributes. According to those elements new indexes
            are created.
@@ -195,8 +195,7 @@
                     strcpy(inde, tblName);
                     indexName = strcat(inde, (temp_head + i)->att_name);
                     indexName = strcat(indexName, "_bmapIndex");
-                //Error: argument of type "char" is incompatible with parameter of type "char *"
-                    startAddress = AK_initialize_new_index_segment(indexName,AK_get_table_id(tblName),indexed_attr_position, t_header);
+                    startAddress = AK_initialize_new_index_segment(indexName, tblName, indexed_attr_position, t_header);
 
 
                     if (startAddress != EXIT_ERROR)
@@ -235,8 +234,7 @@
                     strcpy(inde, tblName);
                     indexName = strcat(inde, (temp_head + i)->att_name);
                     indexName = strcat(indexName, "_bmapIndex");
-                //Error: argument of type "char" is incompatible with parameter of type "char *"
-                    startAddress = AK_initialize_new_index_segment(indexName,AK_get_table_id(tblName),indexed_attr_position, t_headerr);
+                    startAddress = AK_initialize_new_index_segment(indexName, tblName, indexed_attr_position, t_headerr);
                     if (startAddress != EXIT_ERROR)
                     {
                         printf("\nINDEX %s CREATED!\n", indexName);
@@ -725,6 +723,122 @@
 }
 
 
+/**
+ * @author agent
+ * @brief Function that adds a row of the indexed table to a bitmap index. A value without a column in the index table
+ * can not be added to it, the index is created again instead, like AK_add_to_bitmap_index does.
+ * @param tableName name of the indexed table
+ * @param attributeName name of the indexed attribute
+ * @param row row of the table
+ * @param position position of the attribute in the row
+ * @param rid RID of the row
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ **/
+int AK_bitmap_insert_row(char *tableName, char *attributeName, AK_row *row, int position, AK_rid *rid)
+{
+    char indexName[MAX_ATT_NAME], value[MAX_VARCHAR_LENGTH];
+    char *data;
+    int type, size, i, num_attr, indexTd, result;
+    AK_header *temp_head;
+    struct list_node *row_root;
+    AK_PRO;
+
+    snprintf(indexName, MAX_ATT_NAME, "%s%s_bmapIndex", tableName, attributeName);
+    data = AK_row_get(row, position, &type, &size);
+    //only integers and strings are indexed, see AK_create_Index_Table
+    if (data == NULL || (type != TYPE_INT && type != TYPE_VARCHAR))
+    {
+        AK_EPI;
+        return EXIT_SUCCESS;
+    }
+    if (type == TYPE_INT)
+        sprintf(value, "%d", *(int *)data);
+    else
+    {
+        size = size < MAX_VARCHAR_LENGTH ? size : MAX_VARCHAR_LENGTH - 1;
+        memcpy(value, data, size);
+        value[size] = '\0';
+    }
+
+    temp_head = AK_get_index_header(indexName);
+    num_attr = AK_num_index_attr(indexName);
+    for (i = 2; temp_head != NULL && i < num_attr && strcmp(temp_head[i].att_name, value) != 0; i++);
+    if (temp_head == NULL || i == num_attr)
+    {
+        AK_free(temp_head);
+        AK_dbg_messg(HIGH, INDICES, "Value %s has no column in index %s, the index is created again\n", value, indexName);
+        AK_delete_bitmap_index(indexName);
+        row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
+        AK_Init_L3(&row_root);
+        AK_Insert_New_Element(TYPE_VARCHAR, attributeName, tableName, attributeName, row_root);
+        AK_create_Index_Table(tableName, row_root);
+        AK_DeleteAll_L3(&row_root);
+        AK_free(row_root);
+        AK_EPI;
+        return AK_index_table_exist(indexName) ? EXIT_SUCCESS : EXIT_ERROR;
+    }
+    AK_free(temp_head);
+
+    indexTd = rid->slot * row->num_attr;
+    row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&row_root);
+    AK_Insert_New_Element(TYPE_INT, &rid->block, indexName, "addBlock", row_root);
+    AK_Insert_New_Element(TYPE_INT, &indexTd, indexName, "indexTd", row_root);
+    AK_Insert_New_Element(TYPE_VARCHAR, "1", indexName, value, row_root);
+    result = AK_insert_row(row_root);
+    AK_DeleteAll_L3(&row_root);
+    AK_free(row_root);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @author agent
+ * @brief Function that removes a row of the indexed table from a bitmap index
+ * @param tableName name of the indexed table
+ * @param attributeName name of the indexed attribute
+ * @param num_attr number of attributes of the indexed table
+ * @param rid RID of the row
+ * @return EXIT_SUCCESS, EXIT_ERROR if the index has no row for the RID
+ **/
+int AK_bitmap_delete_row(char *tableName, char *attributeName, int num_attr, AK_rid *rid)
+{
+    char indexName[MAX_ATT_NAME];
+    table_addresses *addresses;
+    AK_block *block;
+    AK_rid index_rid;
+    int i, index_attr, addBlock, indexTd, result = EXIT_ERROR;
+    AK_PRO;
+
+    snprintf(indexName, MAX_ATT_NAME, "%s%s_bmapIndex", tableName, attributeName);
+    addresses = (table_addresses *) AK_get_index_addresses(indexName);
+    index_attr = AK_num_index_attr(indexName);
+    for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0 && result == EXIT_ERROR; i++)
+    {
+        for (index_rid.block = addresses->address_from[i]; index_rid.block < addresses->address_to[i] && result == EXIT_ERROR; index_rid.block++)
+        {
+            block = ((AK_mem_block *) AK_get_block(index_rid.block))->block;
+            for (index_rid.slot = 0; (index_rid.slot + 1) * index_attr <= DATA_BLOCK_SIZE; index_rid.slot++)
+            {
+                if (block->tuple_dict[index_rid.slot * index_attr].type == FREE_INT)
+                    break;
+                if (!AK_slot_is_live(block, index_rid.slot, index_attr))
+                    continue;
+                //the first two attributes of a bitmap index are addBlock and indexTd
+                memcpy(&addBlock, block->data + block->tuple_dict[index_rid.slot * index_attr].address, sizeof(int));
+                memcpy(&indexTd, block->data + block->tuple_dict[index_rid.slot * index_attr + 1].address, sizeof(int));
+                if (addBlock == rid->block && indexTd == rid->slot * num_attr)
+                {
+                    result = AK_delete_row_by_rid(indexName, &index_rid);
+                    break;
+                }
+            }
+        }
+    }
+    AK_free(addresses);
+    AK_EPI;
+    return result;
+}
 
 /**
  * @author Saša Vukšić updated by Lovro Predovan
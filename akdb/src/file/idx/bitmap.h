@@ -150,4 +150,28 @@ void AK_delete_bitmap_index(char *indexName);
  **/
 void AK_add_to_bitmap_index(char *tableName, char *attributeName);
 
+/**
+ * @author agent
+ * @brief Function that adds a row of the indexed table to a bitmap index. A value without a column in the index table
+ * can not be added to it, the index is created again instead, like AK_add_to_bitmap_index does.
+ * @param tableName name of the indexed table
+ * @param attributeName name of the indexed attribute
+ * @param row row of the table
+ * @param position position of the attribute in the row
+ * @param rid RID of the row
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ **/
+int AK_bitmap_insert_row(char *tableName, char *attributeName, AK_row *row, int position, AK_rid *rid);
+
+/**
+ * @author agent
+ * @brief Function that removes a row of the indexed table from a bitmap index
+ * @param tableName name of the indexed table
+ * @param attributeName name of the indexed attribute
+ * @param num_attr number of attributes of the indexed table
+ * @param rid RID of the row
+ * @return EXIT_SUCCESS, EXIT_ERROR if the index has no row for the RID
+ **/
+int AK_bitmap_delete_row(char *tableName, char *attributeName, int num_attr, AK_rid *rid);
+
 #endif
@@ -6,873 +6,1713 @@
  * it under the terms of the GNU General Public License as published by
  * the Free Software Foundation; either version 2 of the License, or
  * (at your option) any later version.
- * 
+ *
  * This program is distributed in the hope that it will be useful,
  * but WITHOUT ANY WARRANTY; without even the implied warranty of
  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
  * GNU Library General Public License for more details.
- * 
+ *
  * You should have received a copy of the GNU General Public License
  * along with this program; if not, write to the Free Software
  * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
  */
 
 #include "btree.h"
+#include "../../rel/iterator.h"
+
+/// taken exclusively by functions that change a B+tree index and shared by scans
+static pthread_rwlock_t AK_btree_lock = PTHREAD_RWLOCK_INITIALIZER;
+
+/**
+ * @author agent
+ * @struct AK_btree_node
+ * @brief Structure that defines a node read from its page, with whole keys. Entry i has key i and, in inner nodes,
+ * child i; next is the first child of an inner node.
+ */
+typedef struct {
+    /// 1 for a leaf
+    int leaf;
+    /// number of entries
+    int count;
+    /// number of entries the arrays have room for
+    int capacity;
+    /// leaf: next leaf; inner node: first child
+    int next;
+    /// leaf: previous leaf
+    int prev;
+    /// children of the entries
+    int *child;
+    /// positions of the keys in keys
+    int *offset;
+    /// sizes of the keys
+    int *size;
+    /// sum of the sizes of the keys
+    int total;
+    /// memory of the keys
+    unsigned char *keys;
+    /// bytes of keys in use
+    int used;
+    /// size of keys
+    int room;
+} AK_btree_node;
+
+/**
+ * @author agent
+ * @struct AK_btree_tree
+ * @brief Structure that defines an index being changed: its first page and the path from the root to a leaf
+ */
+typedef struct {
+    /// index name
+    char *name;
+    /// address of the first page
+    int address;
+    /// first page
+    AK_btree_meta meta;
+    /// addresses of the pages on the path, the root first
+    int path[AK_BTREE_MAX_HEIGHT];
+    /// child taken in every inner page of the path
+    int pos[AK_BTREE_MAX_HEIGHT];
+} AK_btree_tree;
+
+/**
+ * @author agent
+ * @struct AK_btree_key
+ * @brief Structure that defines a key to be loaded into a new index
+ */
+typedef struct {
+    /// bytes of the key
+    unsigned char *key;
+    /// number of bytes
+    int size;
+} AK_btree_key;
+
+#define AK_BTREE_KEY(node, i) ((node)->keys + (node)->offset[i])
+
+static int AK_btree_key_compare(const unsigned char *a, int a_size, const unsigned char *b, int b_size)
+{
+    int c = memcmp(a, b, a_size < b_size ? a_size : b_size);
+    return c != 0 ? c : a_size - b_size;
+}
+
+static int AK_btree_common(const unsigned char *a, int a_size, const unsigned char *b, int b_size)
+{
+    int i = 0;
+    while (i < a_size && i < b_size && a[i] == b[i])
+        i++;
+    return i;
+}
+
+static int AK_btree_sort_keys(const void *a, const void *b)
+{
+    const AK_btree_key *x = (const AK_btree_key *) a, *y = (const AK_btree_key *) b;
+    return AK_btree_key_compare(x->key, x->size, y->key, y->size);
+}
+
+/**
+ * @author agent
+ * @brief  Function that checks whether a B+tree index can have a key attribute of a type
+ * @param type attribute type
+ * @return 1 if it can, 0 otherwise
+ */
+static int AK_btree_supported(int type)
+{
+    switch (type) {
+        case TYPE_INT:
+        case TYPE_DATE:
+        case TYPE_DATETIME:
+        case TYPE_TIME:
+        case TYPE_INTERVAL:
+        case TYPE_PERIOD:
+        case TYPE_FLOAT:
+        case TYPE_NUMBER:
+        case TYPE_BOOL:
+        case TYPE_VARCHAR:
+            return 1;
+    }
+    return 0;
+}
+
+/**
+ * @author agent
+ * @brief  Function that appends a value to a key so that comparing the bytes of two keys orders them like their values.
+ * A tag byte puts NULL (stored as the varchar "null") before every value. Integers are written big endian with the
+ * sign bit flipped and floating point numbers as doubles with the sign bit flipped, or all bits for negative numbers.
+ * A varchar is written with every zero byte followed by 0xFF and two zero bytes at its end, so a shorter string is
+ * ordered before the strings it is a prefix of and the values of a composite key stay apart.
+ * @param type type of the key attribute
+ * @param value_type type of the value
+ * @param value bytes of the value
+ * @param size number of bytes of the value
+ * @param key key
+ * @param at number of bytes of the key before the value
+ * @return number of bytes of the key with the value, EXIT_ERROR if the value has another type or the key is too long
+ */
+static int AK_btree_encode_value(int type, int value_type, const unsigned char *value, int size, unsigned char *key, int at)
+{
+    unsigned int integer;
+    unsigned long long bits;
+    double number;
+    float real;
+    int i;
+
+    //room for the largest fixed size value and the RID
+    if (at + 1 + sizeof(double) + 2 * sizeof(int) > AK_BTREE_MAX_KEY)
+        return EXIT_ERROR;
+    if (value_type == TYPE_VARCHAR && type != TYPE_VARCHAR && size == 4 && memcmp(value, "null", 4) == 0) {
+        key[at++] = 0;
+        return at;
+    }
+    key[at++] = 1;
+    switch (type) {
+        case TYPE_INT:
+        case TYPE_DATE:
+        case TYPE_DATETIME:
+        case TYPE_TIME:
+        case TYPE_INTERVAL:
+        case TYPE_PERIOD:
+            if (value_type == TYPE_VARCHAR || value_type == TYPE_FLOAT || value_type == TYPE_NUMBER || value_type == TYPE_BOOL || size != sizeof(int))
+                return EXIT_ERROR;
+            memcpy(&integer, value, sizeof(int));
+            integer ^= 0x80000000u;
+            for (i = 3; i >= 0; i--)
+                key[at++] = (integer >> (8 * i)) & 0xFF;
+            break;
+        case TYPE_FLOAT:
+        case TYPE_NUMBER:
+            if (value_type != TYPE_FLOAT && value_type != TYPE_NUMBER)
+                return EXIT_ERROR;
+            if (size == sizeof(float)) {
+                memcpy(&real, value, sizeof(float));
+                number = real;
+            } else if (size == sizeof(double))
+                memcpy(&number, value, sizeof(double));
+            else
+                return EXIT_ERROR;
+            //-0.0 and 0.0 are the same key
+            if (number == 0)
+                number = 0;
+            memcpy(&bits, &number, sizeof(double));
+            bits = (bits >> 63) ? ~bits : bits | 0x8000000000000000ULL;
+            for (i = 7; i >= 0; i--)
+                key[at++] = (bits >> (8 * i)) & 0xFF;
+            break;
+        case TYPE_BOOL:
+            if (value_type != TYPE_BOOL || size != 1)
+                return EXIT_ERROR;
+            key[at++] = value[0];
+            break;
+        case TYPE_VARCHAR:
+            if (value_type != TYPE_VARCHAR)
+                return EXIT_ERROR;
+            for (i = 0; i < size; i++) {
+                if (at + 4 + 2 * sizeof(int) > AK_BTREE_MAX_KEY)
+                    return EXIT_ERROR;
+                key[at++] = value[i];
+                if (value[i] == 0)
+                    key[at++] = 0xFF;
+            }
+            key[at++] = 0;
+            key[at++] = 0;
+            break;
+        default:
+            return EXIT_ERROR;
+    }
+    return at;
+}
+
+static int AK_btree_encode_rid(AK_rid *rid, unsigned char *key, int at)
+{
+    int i;
+    for (i = 3; i >= 0; i--)
+        key[at++] = ((unsigned int) rid->block >> (8 * i)) & 0xFF;
+    for (i = 3; i >= 0; i--)
+        key[at++] = ((unsigned int) rid->slot >> (8 * i)) & 0xFF;
+    return at;
+}
+
+static void AK_btree_decode_rid(const unsigned char *key, int size, AK_rid *rid)
+{
+    int i;
+    unsigned int block = 0, slot = 0;
+    for (i = 0; i < 4; i++) {
+        block = (block << 8) | key[size - 8 + i];
+        slot = (slot << 8) | key[size - 4 + i];
+    }
+    rid->block = (int) block;
+    rid->slot = (int) slot;
+}
+
+/**
+ * @author agent
+ * @brief  Function that encodes values of the key attributes, see AK_btree_encode_value
+ * @param meta first page of the index
+ * @param values values in the order of the key, may be NULL
+ * @param all 1 if there has to be a value for every key attribute
+ * @param rid RID appended to the key, NULL for none
+ * @param key receives the key, AK_BTREE_MAX_KEY bytes
+ * @return number of bytes of the key, EXIT_ERROR if it can not be encoded
+ */
+static int AK_btree_encode_key(AK_btree_meta *meta, struct list_node *values, int all, AK_rid *rid, unsigned char *key)
+{
+    struct list_node *value = values == NULL ? NULL : (struct list_node *) AK_First_L2(values);
+    int i, at = 0;
+    for (i = 0; i < meta->attributes && value != NULL; i++, value = (struct list_node *) AK_Next_L2(value)) {
+        at = AK_btree_encode_value(meta->type[i], value->type, (unsigned char *) value->data, value->size, key, at);
+        if (at == EXIT_ERROR)
+            return EXIT_ERROR;
+    }
+    if (all && i < meta->attributes)
+        return EXIT_ERROR;
+    return rid == NULL ? at : AK_btree_encode_rid(rid, key, at);
+}
 
 /**
-  * @author Anđelko Spevec
-  * @brief Function that creates new btree index on integer attribute in table
+ * @author agent
+ * @brief  Function that encodes the key of a row of the indexed table
+ * @param meta first page of the index
+ * @param block block of the row
+ * @param rid RID of the row
+ * @param num_attr number of attributes of the table
+ * @param key receives the key, AK_BTREE_MAX_KEY bytes
+ * @return number of bytes of the key, EXIT_ERROR if it can not be encoded
+ */
+static int AK_btree_encode_slot(AK_btree_meta *meta, AK_block *block, AK_rid *rid, int num_attr, unsigned char *key)
+{
+    AK_tuple_dict *entry;
+    int i, at = 0;
+    for (i = 0; i < meta->attributes; i++) {
+        entry = &block->tuple_dict[rid->slot * num_attr + meta->position[i]];
+        at = AK_btree_encode_value(meta->type[i], entry->type, block->data + entry->address, entry->size, key, at);
+        if (at == EXIT_ERROR)
+            return EXIT_ERROR;
+    }
+    return AK_btree_encode_rid(rid, key, at);
+}
+
+static void AK_btree_node_init(AK_btree_node *node, int leaf)
+{
+    memset(node, 0, sizeof(AK_btree_node));
+    node->leaf = leaf;
+}
+
+static void AK_btree_node_free(AK_btree_node *node)
+{
+    AK_free(node->child);
+    AK_free(node->offset);
+    AK_free(node->size);
+    AK_free(node->keys);
+    memset(node, 0, sizeof(AK_btree_node));
+}
+
+static void AK_btree_node_insert(AK_btree_node *node, int i, const unsigned char *key, int size, int child)
+{
+    if (node->count == node->capacity) {
+        node->capacity = node->capacity == 0 ? 64 : 2 * node->capacity;
+        node->child = (int *) AK_realloc(node->child, node->capacity * sizeof(int));
+        node->offset = (int *) AK_realloc(node->offset, node->capacity * sizeof(int));
+        node->size = (int *) AK_realloc(node->size, node->capacity * sizeof(int));
+    }
+    if (node->used + size > node->room) {
+        node->room = 2 * (node->used + size) + AK_BTREE_PAGE_SIZE;
+        node->keys = (unsigned char *) AK_realloc(node->keys, node->room);
+    }
+    memmove(node->child + i + 1, node->child + i, (node->count - i) * sizeof(int));
+    memmove(node->offset + i + 1, node->offset + i, (node->count - i) * sizeof(int));
+    memmove(node->size + i + 1, node->size + i, (node->count - i) * sizeof(int));
+    memcpy(node->keys + node->used, key, size);
+    node->child[i] = child;
+    node->offset[i] = node->used;
+    node->size[i] = size;
+    node->used += size;
+    node->total += size;
+    node->count++;
+}
+
+static void AK_btree_node_remove(AK_btree_node *node, int i)
+{
+    node->total -= node->size[i];
+    node->count--;
+    memmove(node->child + i, node->child + i + 1, (node->count - i) * sizeof(int));
+    memmove(node->offset + i, node->offset + i + 1, (node->count - i) * sizeof(int));
+    memmove(node->size + i, node->size + i + 1, (node->count - i) * sizeof(int));
+}
+
+static void AK_btree_node_truncate(AK_btree_node *node, int count)
+{
+    while (node->count > count)
+        node->total -= node->size[--node->count];
+    if (node->count == 0)
+        node->used = 0;
+}
+
+static void AK_btree_node_copy(AK_btree_node *to, AK_btree_node *from, int begin, int end)
+{
+    int i;
+    for (i = begin; i < end; i++)
+        AK_btree_node_insert(to, to->count, AK_BTREE_KEY(from, i), from->size[i], from->child[i]);
+}
+
+/**
+ * @author agent
+ * @brief  Function that finds the first entry of a node with a key not below a key
+ * @param node node
+ * @param key key
+ * @param size number of bytes of the key
+ * @return position of the entry, count if every key is below
+ */
+static int AK_btree_node_search(AK_btree_node *node, const unsigned char *key, int size)
+{
+    int low = 0, high = node->count, middle;
+    while (low < high) {
+        middle = (low + high) / 2;
+        if (AK_btree_key_compare(AK_BTREE_KEY(node, middle), node->size[middle], key, size) < 0)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return low;
+}
+
+static int AK_btree_node_prefix(AK_btree_node *node)
+{
+    if (node->count < 2)
+        return 0;
+    return AK_btree_common(AK_BTREE_KEY(node, 0), node->size[0], AK_BTREE_KEY(node, node->count - 1), node->size[node->count - 1]);
+}
+
+/**
+ * @author agent
+ * @brief  Function that computes the size of the page of a node. The keys of a sorted node share the common prefix of
+ * its first and last key, which is stored once.
+ * @param node node
+ * @return number of bytes
+ */
+static int AK_btree_node_bytes(AK_btree_node *node)
+{
+    int prefix = AK_btree_node_prefix(node);
+    int entry = 2 * sizeof(unsigned short) + (node->leaf ? 0 : sizeof(int));
+    return sizeof(AK_btree_page) + prefix + node->count * entry + node->total - node->count * prefix;
+}
+
+static unsigned char *AK_btree_page_entry(AK_block *block, int i, int *size)
+{
+    unsigned short offset, length;
+    memcpy(&offset, block->data + sizeof(AK_btree_page) + i * sizeof(unsigned short), sizeof(unsigned short));
+    memcpy(&length, block->data + offset, sizeof(unsigned short));
+    *size = length;
+    return block->data + offset + sizeof(unsigned short);
+}
+
+static unsigned char *AK_btree_page_prefix(AK_block *block)
+{
+    return block->data + sizeof(AK_btree_page) + ((AK_btree_page *) block->data)->count * sizeof(unsigned short);
+}
+
+/**
+ * @author agent
+ * @brief  Function that compares the key of an entry of a page with a key without copying the entry
+ * @param block page
+ * @param i entry
+ * @param key key
+ * @param size number of bytes of the key
+ * @return less than, equal to or greater than zero if the key of the entry is below, equal to or above the key
+ */
+static int AK_btree_page_compare(AK_block *block, int i, const unsigned char *key, int size)
+{
+    int prefix = ((AK_btree_page *) block->data)->prefix;
+    int suffix, n, c;
+    unsigned char *rest = AK_btree_page_entry(block, i, &suffix);
+
+    n = size < prefix ? size : prefix;
+    c = memcmp(AK_btree_page_prefix(block), key, n);
+    if (c != 0)
+        return c;
+    if (size <= prefix)
+        return prefix + suffix - size;
+    return AK_btree_key_compare(rest, suffix, key + prefix, size - prefix);
+}
+
+/**
+ * @author agent
+ * @brief  Function that finds an entry of a page by binary search
+ * @param block page
+ * @param key key
+ * @param size number of bytes of the key
+ * @param above 1 for the first entry with a key above the key, 0 for the first one not below it
+ * @return position of the entry, the number of entries if there is none
+ */
+static int AK_btree_page_search(AK_block *block, const unsigned char *key, int size, int above)
+{
+    int low = 0, high = ((AK_btree_page *) block->data)->count, middle, c;
+    while (low < high) {
+        middle = (low + high) / 2;
+        c = AK_btree_page_compare(block, middle, key, size);
+        if (c < 0 || (above && c == 0))
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return low;
+}
+
+static int AK_btree_page_key(AK_block *block, int i, unsigned char *key)
+{
+    int prefix = ((AK_btree_page *) block->data)->prefix;
+    int suffix;
+    unsigned char *rest = AK_btree_page_entry(block, i, &suffix);
+    memcpy(key, AK_btree_page_prefix(block), prefix);
+    memcpy(key + prefix, rest, suffix);
+    return prefix + suffix;
+}
+
+/**
+ * @author agent
+ * @brief  Function that returns a child of an inner page
+ * @param block inner page
+ * @param i 0 for the first child, i for the child of entry i - 1
+ * @return address of the child
+ */
+static int AK_btree_page_child(AK_block *block, int i)
+{
+    int suffix, child;
+    unsigned char *rest;
+    if (i == 0)
+        return ((AK_btree_page *) block->data)->next;
+    rest = AK_btree_page_entry(block, i - 1, &suffix);
+    memcpy(&child, rest + suffix, sizeof(int));
+    return child;
+}
+
+/**
+ * @author agent
+ * @brief  Function that reads a node from its page
+ * @param address address of the page
+ * @param node receives the node, it has to be freed with AK_btree_node_free
+ * @return EXIT_SUCCESS, EXIT_ERROR if the page holds no node
+ */
+static int AK_btree_read_node(int address, AK_btree_node *node)
+{
+    AK_block *block = ((AK_mem_block *) AK_get_block(address))->block;
+    AK_btree_page *page = (AK_btree_page *) block->data;
+    unsigned char key[AK_BTREE_MAX_KEY];
+    int i, size;
+
+    AK_btree_node_init(node, block->tuple_dict[0].type == BTREE_LEAF_PAGE);
+    if (block->tuple_dict[0].type != BTREE_LEAF_PAGE && block->tuple_dict[0].type != BTREE_INNER_PAGE) {
+        printf("AK_btree_read_node: block %d is not a page of a B+tree!\n", address);
+        return EXIT_ERROR;
+    }
+    node->next = page->next;
+    node->prev = page->prev;
+    for (i = 0; i < page->count; i++) {
+        size = AK_btree_page_key(block, i, key);
+        AK_btree_node_insert(node, i, key, size, node->leaf ? 0 : AK_btree_page_child(block, i + 1));
+    }
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @author agent
+ * @brief  Function that writes a node to its page, the node has to fit into it
+ * @param address address of the page
+ * @param node node
+ * @return EXIT_SUCCESS, EXIT_ERROR if the node does not fit
+ */
+static int AK_btree_write_node(int address, AK_btree_node *node)
+{
+    AK_mem_block *mem_block;
+    AK_block *block;
+    AK_btree_page page;
+    unsigned short offset, length;
+    int i, at, prefix = AK_btree_node_prefix(node);
+
+    if (AK_btree_node_bytes(node) > AK_BTREE_PAGE_SIZE) {
+        printf("AK_btree_write_node: node does not fit into block %d!\n", address);
+        return EXIT_ERROR;
+    }
+    mem_block = (AK_mem_block *) AK_get_block(address);
+    block = mem_block->block;
+    page.count = node->count;
+    page.next = node->next;
+    page.prev = node->prev;
+    page.prefix = prefix;
+    memcpy(block->data, &page, sizeof(AK_btree_page));
+    at = sizeof(AK_btree_page) + node->count * sizeof(unsigned short);
+    if (prefix > 0)
+        memcpy(block->data + at, AK_BTREE_KEY(node, 0), prefix);
+    at += prefix;
+    for (i = 0; i < node->count; i++) {
+        offset = at;
+        length = node->size[i] - prefix;
+        memcpy(block->data + sizeof(AK_btree_page) + i * sizeof(unsigned short), &offset, sizeof(unsigned short));
+        memcpy(block->data + at, &length, sizeof(unsigned short));
+        at += sizeof(unsigned short);
+        memcpy(block->data + at, AK_BTREE_KEY(node, i) + prefix, length);
+        at += length;
+        if (!node->leaf) {
+            memcpy(block->data + at, &node->child[i], sizeof(int));
+            at += sizeof(int);
+        }
+    }
+    block->tuple_dict[0].type = node->leaf ? BTREE_LEAF_PAGE : BTREE_INNER_PAGE;
+    block->tuple_dict[0].address = 0;
+    block->tuple_dict[0].size = at;
+    block->AK_free_space = at;
+    block->last_tuple_dict_id = 0;
+    AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @author agent
+ * @brief  Function that reads the first page of an index
+ * @param indexName index name
+ * @param tree receives the address and the content of the first page
+ * @return EXIT_SUCCESS, EXIT_ERROR if there is no such B+tree index
+ */
+static int AK_btree_open_tree(char *indexName, AK_btree_tree *tree)
+{
+    table_addresses *addresses = (table_addresses *) AK_get_index_addresses(indexName);
+    AK_block *block;
+
+    tree->name = indexName;
+    tree->address = addresses->address_from[0];
+    AK_free(addresses);
+    if (tree->address == 0)
+        return EXIT_ERROR;
+    block = ((AK_mem_block *) AK_get_block(tree->address))->block;
+    if (block->tuple_dict[0].type != BTREE_META_PAGE)
+        return EXIT_ERROR;
+    memcpy(&tree->meta, block->data, sizeof(AK_btree_meta));
+    return EXIT_SUCCESS;
+}
+
+static void AK_btree_write_meta(AK_btree_tree *tree)
+{
+    AK_mem_block *mem_block = (AK_mem_block *) AK_get_block(tree->address);
+    memcpy(mem_block->block->data, &tree->meta, sizeof(AK_btree_meta));
+    mem_block->block->tuple_dict[0].type = BTREE_META_PAGE;
+    mem_block->block->tuple_dict[0].address = 0;
+    mem_block->block->tuple_dict[0].size = sizeof(AK_btree_meta);
+    mem_block->block->AK_free_space = sizeof(AK_btree_meta);
+    mem_block->block->last_tuple_dict_id = 0;
+    AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+}
+
+/**
+ * @author agent
+ * @brief  Function that takes a page for a node: a freed page if there is one, otherwise the page after the last page
+ * taken from the extents of the index. A new extent is added when they are used up.
+ * @param tree index
+ * @return address of the page, EXIT_ERROR if no extent can be added
+ */
+static int AK_btree_alloc_page(AK_btree_tree *tree)
+{
+    table_addresses *addresses;
+    int i, address = 0;
+
+    if (tree->meta.free_page != 0) {
+        address = tree->meta.free_page;
+        tree->meta.free_page = ((AK_btree_page *) ((AK_mem_block *) AK_get_block(address))->block->data)->next;
+        tree->meta.pages++;
+        return address;
+    }
+    addresses = (table_addresses *) AK_get_index_addresses(tree->name);
+    for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0; i++) {
+        if (tree->meta.last_page >= addresses->address_from[i] && tree->meta.last_page < addresses->address_to[i]) {
+            if (tree->meta.last_page + 1 < addresses->address_to[i])
+                address = tree->meta.last_page + 1;
+            else if (i + 1 < MAX_EXTENTS_IN_SEGMENT)
+                address = addresses->address_from[i + 1];
+            break;
+        }
+    }
+    AK_free(addresses);
+    if (address == 0)
+        address = AK_init_new_extent(tree->name, SEGMENT_TYPE_INDEX);
+    if (address == EXIT_ERROR || address == 0) {
+        printf("AK_btree_alloc_page: index %s can not grow!\n", tree->name);
+        return EXIT_ERROR;
+    }
+    tree->meta.last_page = address;
+    tree->meta.pages++;
+    return address;
+}
+
+static void AK_btree_free_page(AK_btree_tree *tree, int address)
+{
+    AK_mem_block *mem_block = (AK_mem_block *) AK_get_block(address);
+    AK_btree_page page;
+
+    memset(&page, 0, sizeof(AK_btree_page));
+    page.next = tree->meta.free_page;
+    memcpy(mem_block->block->data, &page, sizeof(AK_btree_page));
+    mem_block->block->tuple_dict[0].type = BTREE_FREE_PAGE;
+    mem_block->block->tuple_dict[0].size = sizeof(AK_btree_page);
+    AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+    tree->meta.free_page = address;
+    tree->meta.pages--;
+}
+
+static void AK_btree_set_prev(int address, int prev)
+{
+    AK_mem_block *mem_block;
+    if (address == 0)
+        return;
+    mem_block = (AK_mem_block *) AK_get_block(address);
+    ((AK_btree_page *) mem_block->block->data)->prev = prev;
+    AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+}
+
+/**
+ * @author agent
+ * @brief  Function that computes the shortest key that is above the last key of a leaf and not above the first key
+ * of the next one, it separates them in their parent
+ * @param left last key of the left leaf
+ * @param left_size number of bytes of left
+ * @param right first key of the right leaf
+ * @param right_size number of bytes of right
+ * @param separator receives the separator
+ * @return number of bytes of the separator
+ */
+static int AK_btree_separator(const unsigned char *left, int left_size, const unsigned char *right, int right_size, unsigned char *separator)
+{
+    int size = AK_btree_common(left, left_size, right, right_size) + 1;
+    if (size > right_size)
+        size = right_size;
+    memcpy(separator, right, size);
+    return size;
+}
+
+/**
+ * @author agent
+ * @brief  Function that chooses where to split a node so that both halves get about the same number of bytes
+ * @param node node with at least two entries
+ * @return number of entries of the left half
+ */
+static int AK_btree_split_point(AK_btree_node *node)
+{
+    int i, bytes = 0, half = (node->total + 4 * node->count) / 2;
+    for (i = 0; i < node->count - 1; i++) {
+        bytes += node->size[i] + 4;
+        if (bytes >= half)
+            return i + 1;
+    }
+    return node->count - 1;
+}
+
+/**
+ * @author agent
+ * @brief  Function that walks from the root to the leaf where a key belongs and records the path
+ * @param tree index
+ * @param key key
+ * @param size number of bytes of the key
+ * @return level of the leaf in the path
+ */
+static int AK_btree_descend(AK_btree_tree *tree, const unsigned char *key, int size)
+{
+    AK_block *block;
+    int level, address = tree->meta.root;
+    for (level = 0; level < tree->meta.height - 1; level++) {
+        block = ((AK_mem_block *) AK_get_block(address))->block;
+        tree->path[level] = address;
+        tree->pos[level] = AK_btree_page_search(block, key, size, 1);
+        address = AK_btree_page_child(block, tree->pos[level]);
+    }
+    tree->path[level] = address;
+    return level;
+}
+
+/**
+ * @author agent
+ * @brief  Function that writes a node of the path to its page. A node too big for its page is split into a new page
+ * and the separator of the halves is inserted into the parent, a new root is added when the root splits.
+ * @param tree index
+ * @param level level of the node in the path
+ * @param node node
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_btree_store(AK_btree_tree *tree, int level, AK_btree_node *node)
+{
+    AK_btree_node right, parent;
+    unsigned char separator[AK_BTREE_MAX_KEY];
+    int size, m, address, root, result;
+
+    if (AK_btree_node_bytes(node) <= AK_BTREE_PAGE_SIZE)
+        return AK_btree_write_node(tree->path[level], node);
+    if (level == 0 && tree->meta.height == AK_BTREE_MAX_HEIGHT) {
+        printf("AK_btree_store: index %s is too high!\n", tree->name);
+        return EXIT_ERROR;
+    }
+    if ((address = AK_btree_alloc_page(tree)) == EXIT_ERROR)
+        return EXIT_ERROR;
+
+    m = AK_btree_split_point(node);
+    AK_btree_node_init(&right, node->leaf);
+    if (node->leaf) {
+        AK_btree_node_copy(&right, node, m, node->count);
+        size = AK_btree_separator(AK_BTREE_KEY(node, m - 1), node->size[m - 1], AK_BTREE_KEY(node, m), node->size[m], separator);
+        right.next = node->next;
+        right.prev = tree->path[level];
+        AK_btree_set_prev(node->next, address);
+        node->next = address;
+    } else {
+        //the middle key moves up, its child becomes the first child of the right half
+        AK_btree_node_copy(&right, node, m + 1, node->count);
+        size = node->size[m];
+        memcpy(separator, AK_BTREE_KEY(node, m), size);
+        right.next = node->child[m];
+    }
+    AK_btree_node_truncate(node, m);
+    result = AK_btree_write_node(tree->path[level], node);
+    if (result == EXIT_SUCCESS)
+        result = AK_btree_write_node(address, &right);
+    AK_btree_node_free(&right);
+    if (result != EXIT_SUCCESS)
+        return result;
+
+    if (level == 0) {
+        if ((root = AK_btree_alloc_page(tree)) == EXIT_ERROR)
+            return EXIT_ERROR;
+        AK_btree_node_init(&parent, 0);
+        parent.next = tree->path[0];
+        AK_btree_node_insert(&parent, 0, separator, size, address);
+        result = AK_btree_write_node(root, &parent);
+        AK_btree_node_free(&parent);
+        tree->meta.root = root;
+        tree->meta.height++;
+        return result;
+    }
+    if (AK_btree_read_node(tree->path[level - 1], &parent) != EXIT_SUCCESS) {
+        AK_btree_node_free(&parent);
+        return EXIT_ERROR;
+    }
+    AK_btree_node_insert(&parent, tree->pos[level - 1], separator, size, address);
+    result = AK_btree_store(tree, level - 1, &parent);
+    AK_btree_node_free(&parent);
+    return result;
+}
+
+/**
+ * @author agent
+ * @brief  Function that writes a node of the path that lost an entry. A node less than a quarter full is merged with
+ * a neighbour under the same parent if both fit into one page, otherwise the entries of both are shared evenly. A
+ * root without keys is replaced by its only child.
+ * @param tree index
+ * @param level level of the node in the path
+ * @param node node
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_btree_rebalance(AK_btree_tree *tree, int level, AK_btree_node *node)
+{
+    AK_btree_node parent, sibling, merged, left_half, right_half;
+    AK_btree_node *left, *right;
+    unsigned char separator[AK_BTREE_MAX_KEY];
+    int c, index, left_address, right_address, size, m, result;
+
+    if (level == 0) {
+        if (!node->leaf && node->count == 0) {
+            tree->meta.root = node->next;
+            tree->meta.height--;
+            AK_btree_free_page(tree, tree->path[0]);
+            return EXIT_SUCCESS;
+        }
+        return AK_btree_write_node(tree->path[0], node);
+    }
+    if (AK_btree_node_bytes(node) >= AK_BTREE_PAGE_SIZE / 4)
+        return AK_btree_store(tree, level, node);
+
+    if (AK_btree_read_node(tree->path[level - 1], &parent) != EXIT_SUCCESS || parent.count == 0) {
+        AK_btree_node_free(&parent);
+        return AK_btree_store(tree, level, node);
+    }
+    c = tree->pos[level - 1];
+    if (c > 0) {
+        index = c - 1;
+        left_address = index == 0 ? parent.next : parent.child[index - 1];
+        right_address = tree->path[level];
+        result = AK_btree_read_node(left_address, &sibling);
+        left = &sibling;
+        right = node;
+    } else {
+        index = 0;
+        left_address = tree->path[level];
+        right_address = parent.child[0];
+        result = AK_btree_read_node(right_address, &sibling);
+        left = node;
+        right = &sibling;
+    }
+    if (result != EXIT_SUCCESS) {
+        AK_btree_node_free(&sibling);
+        AK_btree_node_free(&parent);
+        return EXIT_ERROR;
+    }
+
+    AK_btree_node_init(&merged, node->leaf);
+    AK_btree_node_copy(&merged, left, 0, left->count);
+    //the separator of inner nodes comes down between them
+    if (!node->leaf)
+        AK_btree_node_insert(&merged, merged.count, AK_BTREE_KEY(&parent, index), parent.size[index], right->next);
+    AK_btree_node_copy(&merged, right, 0, right->count);
+    merged.next = node->leaf ? right->next : left->next;
+    merged.prev = left->prev;
+
+    if (AK_btree_node_bytes(&merged) <= AK_BTREE_PAGE_SIZE) {
+        result = AK_btree_write_node(left_address, &merged);
+        if (node->leaf)
+            AK_btree_set_prev(right->next, left_address);
+        AK_btree_free_page(tree, right_address);
+        AK_btree_node_remove(&parent, index);
+    } else {
+        m = AK_btree_split_point(&merged);
+        AK_btree_node_init(&left_half, node->leaf);
+        AK_btree_node_init(&right_half, node->leaf);
+        AK_btree_node_copy(&left_half, &merged, 0, m);
+        if (node->leaf) {
+            AK_btree_node_copy(&right_half, &merged, m, merged.count);
+            size = AK_btree_separator(AK_BTREE_KEY(&merged, m - 1), merged.size[m - 1], AK_BTREE_KEY(&merged, m), merged.size[m], separator);
+            left_half.prev = left->prev;
+            left_half.next = right_address;
+            right_half.prev = left_address;
+            right_half.next = right->next;
+        } else {
+            AK_btree_node_copy(&right_half, &merged, m + 1, merged.count);
+            size = merged.size[m];
+            memcpy(separator, AK_BTREE_KEY(&merged, m), size);
+            left_half.next = left->next;
+            right_half.next = merged.child[m];
+        }
+        result = AK_btree_write_node(left_address, &left_half);
+        if (result == EXIT_SUCCESS)
+            result = AK_btree_write_node(right_address, &right_half);
+        AK_btree_node_free(&left_half);
+        AK_btree_node_free(&right_half);
+        AK_btree_node_remove(&parent, index);
+        AK_btree_node_insert(&parent, index, separator, size, right_address);
+    }
+    AK_btree_node_free(&merged);
+    AK_btree_node_free(&sibling);
+    if (result == EXIT_SUCCESS)
+        result = AK_btree_rebalance(tree, level - 1, &parent);
+    AK_btree_node_free(&parent);
+    return result;
+}
+
+/**
+ * @author agent
+ * @brief  Function that builds a tree from sorted keys. Leaves are filled to AK_BTREE_FILL percent from left to right,
+ * then every level above them is built from the separators of the level below until one page remains.
+ * @param tree index with an empty first page
+ * @param keys sorted keys
+ * @param count number of keys
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_btree_load(AK_btree_tree *tree, AK_btree_key *keys, int count)
+{
+    AK_btree_node node;
+    AK_btree_key *separator = (AK_btree_key *) AK_malloc((count + 1) * sizeof(AK_btree_key));
+    int *address = (int *) AK_malloc((count + 1) * sizeof(int));
+    unsigned char *buffer = NULL;
+    int limit = AK_BTREE_PAGE_SIZE * AK_BTREE_FILL / 100;
+    int i, nodes = 0, level_nodes, current, next, prev = 0, used = 0, result = EXIT_SUCCESS;
+
+    for (i = 0; i < count; i++)
+        used += keys[i].size;
+    buffer = (unsigned char *) AK_malloc(used + 1);
+    used = 0;
+
+    AK_btree_node_init(&node, 1);
+    current = AK_btree_alloc_page(tree);
+    for (i = 0; i < count && current != EXIT_ERROR && result == EXIT_SUCCESS; i++) {
+        AK_btree_node_insert(&node, node.count, keys[i].key, keys[i].size, 0);
+        if (node.count > 1 && AK_btree_node_bytes(&node) > limit) {
+            AK_btree_node_truncate(&node, node.count - 1);
+            if ((next = AK_btree_alloc_page(tree)) == EXIT_ERROR) {
+                result = EXIT_ERROR;
+                break;
+            }
+            node.prev = prev;
+            node.next = next;
+            result = AK_btree_write_node(current, &node);
+            address[nodes++] = current;
+            separator[nodes].key = buffer + used;
+            separator[nodes].size = AK_btree_separator(keys[i - 1].key, keys[i - 1].size, keys[i].key, keys[i].size, buffer + used);
+            used += separator[nodes].size;
+            prev = current;
+            current = next;
+            AK_btree_node_truncate(&node, 0);
+            AK_btree_node_insert(&node, 0, keys[i].key, keys[i].size, 0);
+        }
+    }
+    if (current == EXIT_ERROR)
+        result = EXIT_ERROR;
+    if (result == EXIT_SUCCESS) {
+        node.prev = prev;
+        node.next = 0;
+        result = AK_btree_write_node(current, &node);
+        address[nodes++] = current;
+    }
+    AK_btree_node_free(&node);
+    tree->meta.height = 1;
+
+    //every inner node starts with the first child it gets, the separators before it move up
+    while (nodes > 1 && result == EXIT_SUCCESS) {
+        AK_btree_node_init(&node, 0);
+        level_nodes = 0;
+        current = AK_btree_alloc_page(tree);
+        node.next = address[0];
+        for (i = 1; i < nodes && current != EXIT_ERROR; i++) {
+            AK_btree_node_insert(&node, node.count, separator[i].key, separator[i].size, address[i]);
+            if (node.count > 1 && AK_btree_node_bytes(&node) > limit) {
+                AK_btree_node_truncate(&node, node.count - 1);
+                if (AK_btree_write_node(current, &node) != EXIT_SUCCESS)
+                    current = EXIT_ERROR;
+                address[level_nodes++] = current;
+                separator[level_nodes] = separator[i];
+                if (current != EXIT_ERROR)
+                    current = AK_btree_alloc_page(tree);
+                AK_btree_node_truncate(&node, 0);
+                node.next = address[i];
+            }
+        }
+        if (current == EXIT_ERROR || AK_btree_write_node(current, &node) != EXIT_SUCCESS)
+            result = EXIT_ERROR;
+        address[level_nodes++] = current;
+        nodes = level_nodes;
+        tree->meta.height++;
+        AK_btree_node_free(&node);
+    }
+    tree->meta.root = address[0];
+    AK_free(separator);
+    AK_free(address);
+    AK_free(buffer);
+    return result;
+}
+
+/**
+  * @author Anđelko Spevec, updated by agent (B+tree pages)
+  * @brief Function that creates new B+tree index on attributes of a table. The rows of the table are sorted by key
+  * and the tree is built bottom up, one node per page of the index segment.
   * @param tblName - name of the table on which we are creating index
-  * @param attributes - attribute on which we are creating index
+  * @param attributes - attributes on which we are creating index, in the order of the key
   * @param indexName - name of the index
+  * @return EXIT_SUCCESS or EXIT_ERROR
  */
-/* 
-NOTES: 1. For now we assume that table is sorted on attribute on which we are
-creating index. We should check that with filesort.c and include it in this function.
-That file had some errors, so I couldn't test it. 2.working with multiple blocks
-*/
-AK_block * AK_btree_create(char *tblName, struct list_node *attributes, char *indexName){
-	int i,n,exist;
-	table_addresses *addresses;
-	int num_attr;
-	AK_PRO;
-	
-	//get table address
-	addresses = (table_addresses*) AK_get_table_addresses(tblName);
-	num_attr = AK_num_attr(tblName);
-
-	while(addresses->address_from[ i ]){
-		printf("\nAddress of the TABLE is from %u to %u \n",(addresses->address_from[ i ]),(addresses->address_to[ i ]));
-		i++;
-	}
-	
-	//get table header
-	AK_header *table_header = (AK_header *)AK_get_header(tblName);
-    	struct list_node *attribute = (struct list_node *) AK_First_L2(attributes);
-	AK_header i_header[ MAX_ATTRIBUTES ];
-	AK_header* temp;
-    	n = 0;
-    	
-    	//get table attributes
-	while (attribute != 0) {
-		exist = 0;
-		for (i = 0; i < num_attr; i++) {
-		    if (strcmp((table_header + i)->att_name, attribute->data) == 0) {
-			printf("Attribute %s exist in table, found on position: %d\n", (table_header + i)->att_name, i);
-			AK_dbg_messg(HIGH, INDICES, "Attribute %s exist in table, found on position: %d\n", (table_header + i)->att_name, i);
-			exist = 1;
-			temp = (AK_header*) AK_create_header((table_header + i)->att_name, (table_header + i)->type, FREE_INT, FREE_CHAR, FREE_CHAR);
-			memcpy(i_header + n, temp, sizeof ( AK_header));
-			n++;
-			if ((table_header)->type != TYPE_INT) {
-			    printf("Unsupported data type for bree index! Only int!");
-			    AK_EPI;
-			    return NULL;
-			    //return EXIT_ERROR;
-			}
-		    }
-		}
-		if (!exist) {
-		    printf("Attribute %s does not exists in table", attribute->data);
-		    AK_EPI;
-		    return NULL;
-		    //return EXIT_ERROR;
-		}
-		attribute = attribute->next;
-	} 
-	memset(i_header + n, 0, MAX_ATTRIBUTES - n);
-
-	//creating index
-	int startAddress = AK_initialize_new_segment(indexName, SEGMENT_TYPE_INDEX, i_header);
-	if (startAddress != EXIT_ERROR)
-		printf("\nINDEX %s CREATED!\n", indexName);
-        int r;
-	table_addresses *addIndex = (table_addresses*) AK_get_index_addresses(indexName);
-	while(addIndex->address_from[ r ]){
-		printf("\nAddress of the INDEX is from %u to %u \n",(addIndex->address_from[ r ]),(addIndex->address_to[ r ]));
-		r++;
-	}
-	AK_block *block = (AK_block*) AK_read_block(startAddress);
-	int adr_to_write = (int) AK_find_AK_free_space(AK_get_index_addresses(indexName));
-	int number_el = AK_get_num_records(tblName);			
-	root_info *rootEl = (root_info*) AK_malloc(sizeof(root_info));
-
-	//number of LEAFS--------------------B=3---------------number_leaf
-	float x = (float) number_el;
-	float y = x/B;
-	int number_leaf = 0;
-	while(y > 0){
-		y = y - 1;
-		number_leaf = number_leaf + 1;
-	}//instead of ceil function
-	rootEl->level[0] = number_leaf;
-	
-	//number of NODES (level above leafs)--------(B+1)-----number_node
-	float m = (float) number_leaf;
-	float node = m/(B+1);
-	int number_node = 0;
-	while(node > 0){
-		node = node - 1;
-		number_node = number_node + 1;
-	}//instead of ceil function
-	rootEl->level[1] = number_node;
-
-	//number of NODES (remaining nodes)---------(B+1)------number_node
-	float temp_one = (float) number_node;
-	int temp_two = 0;
-	int lvl = 2;
-	int go = 1;
-	while(go == 1){
-		node = temp_one/(B+1);
-		temp_two = 0;
-		while(node > 0){
-			node = node - 1;
-			temp_two = temp_two + 1;
-		}
-		rootEl->level[lvl] = temp_two;
-		lvl++;
-		number_node = number_node + temp_two;
-		temp_one = (float) temp_two;
-		if(temp_two == 1)
-			go = 0;
-	}
-	
-	//writing root_info
-	rootEl->root = number_leaf + number_node;
-	memcpy(block->data, rootEl, sizeof(root_info));
-	block->tuple_dict[0].address = 0;
-	block->tuple_dict[0].type = BLOCK_TYPE_NORMAL;
-    	block->tuple_dict[0].size = sizeof (root_info);
-	block->AK_free_space += sizeof (root_info);
-	block->last_tuple_dict_id = 0;
-	AK_write_block(block);
-	
-	//writting leafs
-	int id,lf,b,help=0,elements=0;
-	int help_two[number_el];
-	for(lf=1;lf<=(rootEl->level[0]);lf++){
-		btree_node *leaf = (btree_node*) AK_malloc(sizeof(btree_node));
-		i=0;
-		AK_block *temp = (AK_block*) AK_read_block(addresses->address_from[ i ]);
-
-		for(b=0;b<B;b++){
-			if(elements<number_el){
-				leaf->pointers[b].addBlock = addresses->address_from[ i ];
-				leaf->pointers[b].indexTd = help;
-				void *tem = (void *) AK_calloc(MAX_VARCHAR_LENGTH, sizeof (void));
-	      		        memcpy(tem, &(temp->data[temp->tuple_dict[help].address]), sizeof (int));
-				leaf->values[b] = *((int *) tem);
-				help_two[elements] = leaf->values[b];
-				help += num_attr;
-				elements++;
-			}else{
-				leaf->values[b] = -1;
-				elements++;
-			}
-		}
-		if(lf<(rootEl->level[0])){
-			leaf->pointers[B].addBlock = addresses->address_from[ i ];
-			leaf->pointers[B].indexTd = lf+1;
-		}	
-		memcpy(&block->data[block->AK_free_space], leaf, sizeof(btree_node));    
-		id = block->last_tuple_dict_id + 1;
-		block->tuple_dict[id].address = block->AK_free_space;
-		block->tuple_dict[id].type = LEAF;
-		block->AK_free_space += sizeof(btree_node);
-		block->last_tuple_dict_id = id;
-		AK_write_block(block);
-	}
-	
-	//writting nodes
-	int no=1,v=1,d,e=0,f,h,offset,diff,skip=1,check;
-	while(no==1){
-		check=0;
-		offset=1;
-		for(h=0;h<e;h++)////instead of pow function
-			offset = offset*(B+1); 
-		diff = offset * B;//difference WITHIN node
-		offset = offset * B + 1;
-		for(d=0;d<(rootEl->level[v]);d++){
-			btree_node *nodes = (btree_node*) AK_malloc(sizeof(btree_node));
-			for(f=0;f<B;f++){
-				if((offset-1)<number_el){
-					nodes->values[f] = help_two[offset-1];
-				}else{
-					nodes->values[f] = -1;
-				}
-				offset += diff;//difference WITHIN node
-			}
-			offset += diff;//difference BETWEEN nodes is doubled
-			for(f=0;f<=B;f++){
-					if(check<(rootEl->level[v-1])){
-						nodes->pointers[f].indexTd = skip;
-						nodes->pointers[f].addBlock = adr_to_write;
-						skip++;
-						check++;
-					}	
-			}
-			memcpy(&block->data[block->AK_free_space], nodes, sizeof(btree_node)); 
-			id = block->last_tuple_dict_id + 1;
-			block->tuple_dict[id].address = block->AK_free_space;
-			block->tuple_dict[id].type = NODE;
-			block->AK_free_space += sizeof(btree_node);
-			block->last_tuple_dict_id = id;
-			AK_write_block(block);
-		}		
-		e++;
-		if(rootEl->level[v] == 1)
-			no = 0;
-		v++;
-	}
-	printf("B tree created succesfully.");
-	AK_EPI;
-	return block;
-	//return EXIT_SUCCESS;
-}
-
-/**
-  * @author unknown
+int AK_btree_create(char *tblName, struct list_node *attributes, char *indexName){
+    AK_btree_tree tree;
+    AK_header i_header[MAX_ATTRIBUTES];
+    AK_header *table_header, *temp;
+    AK_block *block;
+    AK_rid rid;
+    struct list_node *attribute;
+    table_addresses *addresses;
+    AK_btree_key *keys = NULL;
+    unsigned char *bytes = NULL;
+    unsigned char key[AK_BTREE_MAX_KEY];
+    int num_attr, i, j, size, start, count = 0, capacity = 0, used = 0, room = 0, result = EXIT_SUCCESS;
+    AK_PRO;
+
+    num_attr = AK_num_attr(tblName);
+    table_header = (AK_header *) AK_get_header(tblName);
+    if (num_attr <= 0 || table_header == NULL) {
+        printf("Table %s does not exist!\n", tblName);
+        AK_free(table_header);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    addresses = (table_addresses *) AK_get_index_addresses(indexName);
+    start = addresses->address_from[0];
+    AK_free(addresses);
+    if (start != 0) {
+        printf("Index %s already exists!\n", indexName);
+        AK_free(table_header);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    memset(&tree, 0, sizeof(AK_btree_tree));
+    memset(i_header, 0, sizeof(i_header));
+    strncpy(tree.meta.table, tblName, MAX_ATT_NAME - 1);
+    attribute = (struct list_node *) AK_First_L2(attributes);
+    while (attribute != NULL && result == EXIT_SUCCESS) {
+        for (i = 0; i < num_attr && strcmp(table_header[i].att_name, attribute->data) != 0; i++);
+        if (i == num_attr) {
+            printf("Attribute %s does not exist in table %s!\n", attribute->data, tblName);
+            result = EXIT_ERROR;
+        } else if (tree.meta.attributes == MAX_ATTRIBUTES || !AK_btree_supported(table_header[i].type)) {
+            printf("Unsupported data type for B+tree index on attribute %s!\n", attribute->data);
+            result = EXIT_ERROR;
+        } else {
+            AK_dbg_messg(HIGH, INDICES, "Attribute %s exist in table, found on position: %d\n", table_header[i].att_name, i);
+            temp = (AK_header *) AK_create_header(table_header[i].att_name, table_header[i].type, FREE_INT, FREE_CHAR, FREE_CHAR);
+            memcpy(i_header + tree.meta.attributes, temp, sizeof(AK_header));
+            AK_free(temp);
+            tree.meta.position[tree.meta.attributes] = i;
+            tree.meta.type[tree.meta.attributes] = table_header[i].type;
+            tree.meta.attributes++;
+        }
+        attribute = (struct list_node *) AK_Next_L2(attribute);
+    }
+    AK_free(table_header);
+    if (result == EXIT_SUCCESS && tree.meta.attributes == 0) {
+        printf("No attributes for index %s!\n", indexName);
+        result = EXIT_ERROR;
+    }
+
+    //the keys of all rows, in the order of the table
+    addresses = (table_addresses *) AK_get_table_addresses(tblName);
+    for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0 && result == EXIT_SUCCESS; i++) {
+        for (rid.block = addresses->address_from[i]; rid.block < addresses->address_to[i] && result == EXIT_SUCCESS; rid.block++) {
+            block = ((AK_mem_block *) AK_get_block(rid.block))->block;
+            if (block->last_tuple_dict_id == 0)
+                break;
+            for (rid.slot = 0; (rid.slot + 1) * num_attr <= DATA_BLOCK_SIZE; rid.slot++) {
+                if (!AK_slot_is_live(block, rid.slot, num_attr))
+                    continue;
+                if ((size = AK_btree_encode_slot(&tree.meta, block, &rid, num_attr, key)) == EXIT_ERROR) {
+                    printf("Row %d in block %d of table %s can not be indexed!\n", rid.slot, rid.block, tblName);
+                    result = EXIT_ERROR;
+                    break;
+                }
+                if (count == capacity) {
+                    capacity = capacity == 0 ? 256 : 2 * capacity;
+                    keys = (AK_btree_key *) AK_realloc(keys, capacity * sizeof(AK_btree_key));
+                }
+                if (used + size > room) {
+                    room = 2 * (used + size) + AK_BTREE_PAGE_SIZE;
+                    bytes = (unsigned char *) AK_realloc(bytes, room);
+                }
+                memcpy(bytes + used, key, size);
+                //offsets until the memory of the keys stops moving
+                keys[count].key = (unsigned char *) NULL + used;
+                keys[count].size = size;
+                used += size;
+                count++;
+            }
+        }
+    }
+    AK_free(addresses);
+
+    if (result == EXIT_SUCCESS) {
+        for (j = 0; j < count; j++)
+            keys[j].key = bytes + (keys[j].key - (unsigned char *) NULL);
+        qsort(keys, count, sizeof(AK_btree_key), AK_btree_sort_keys);
+
+        start = AK_initialize_new_index_segment(indexName, tblName, tree.meta.position[0], i_header);
+        if (start == EXIT_ERROR) {
+            printf("Index %s can not be created!\n", indexName);
+            result = EXIT_ERROR;
+        } else {
+            printf("\nINDEX %s CREATED!\n", indexName);
+            tree.name = indexName;
+            tree.address = start;
+            tree.meta.last_page = start;
+            pthread_rwlock_wrlock(&AK_btree_lock);
+            result = AK_btree_load(&tree, keys, count);
+            tree.meta.entries = count;
+            AK_btree_write_meta(&tree);
+            pthread_rwlock_unlock(&AK_btree_lock);
+        }
+    }
+    AK_free(keys);
+    AK_free(bytes);
+    AK_EPI;
+    return result;
+}
+
+/**
+  * @author unknown, updated by agent
   * @brief Function that deletes index
-  * @param indexName - name of the index+
+  * @param indexName - name of the index
+  * @return EXIT_SUCCESS or EXIT_ERROR
  */
 int AK_btree_delete(char *indexName){
+    int result;
     AK_PRO;
-    AK_delete_segment(indexName, SEGMENT_TYPE_INDEX);
-    printf("INDEX %s DELETED!\n", indexName);
+    pthread_rwlock_wrlock(&AK_btree_lock);
+    result = AK_delete_segment(indexName, SEGMENT_TYPE_INDEX);
+    pthread_rwlock_unlock(&AK_btree_lock);
+    if (result == EXIT_SUCCESS)
+        printf("INDEX %s DELETED!\n", indexName);
     AK_EPI;
+    return result;
 }
 
 /**
-  * @author Anđelko Spevec
-  * @brief Function that searches or deletes a value in btree index
-  * @param indexName - name of the index
-  * @param searchValue - value that we are searching in the index
-  * @param endRange - if 0 search is for 0 value, else searching in range
-  * @param toDo - if 0 we just search else we delete the element if we find it
- */
-int AK_btree_search_delete(char *indexName,int *searchValue,int *endRange,int *toDo, AK_block * inputBlock){
-	int contin = 1;
-        AK_PRO;
-	if((searchValue == endRange) || (endRange <= 0)){
-		endRange = 0;
-		contin = 0;
-	}
-	if(searchValue > endRange){
-		int help = *searchValue;
-		searchValue = endRange;
-		endRange = &help;
-	}
-	
-	//finding correct block 
-	int adr_to_read = (int) AK_find_AK_free_space(AK_get_index_addresses(indexName));
-	//AK_block *block = (AK_block*) AK_read_block(adr_to_read);     functions AK_find_AK_free_space, AK_get_index_addresses and AK_read_block should be checked for mistakes
-	AK_block *block = inputBlock;
-	root_info *root = (root_info*) AK_malloc(sizeof (root_info));
-	memset(root, 0, sizeof (root_info));
-	memcpy(root,block->data,sizeof (root_info));
-	btree_node *temp = (btree_node*) AK_malloc(sizeof(btree_node));
-	
-	//navigating through the tree
-	int address= block->tuple_dict[root->root].address;
-	int type = block->tuple_dict[root->root].type; //node == 1, leaf == 0
-	while(type == 1){
-		memset(temp,0,sizeof(btree_node));
-		memcpy(temp,&block->data[address],sizeof(btree_node));
-		int b,goTo = B,done=0;
-		for(b=0;b<B;b++){
-			if((*searchValue<(temp->values[b])) && (done == 0)){
-				goTo=b;
-				done = 1;
-			}
-		
-		}
-		address = block->tuple_dict[temp->pointers[goTo].indexTd].address;
-		type = block->tuple_dict[temp->pointers[goTo].indexTd].type;
-	}
-	memset(temp,0,sizeof(btree_node));
-	memcpy(temp,&block->data[address],sizeof(btree_node));
-	int f,found = 0,idNext;
-	
-	//searching for value
-	for(f=0;f<B;f++){
-		if(*searchValue == (temp->values[f])){
-			found = 1;
-		}
-		if((found == 1) && (temp->values[f] <= *endRange) && (*endRange > 0)) {
-			//printing data after finding node
-			printf("\n Value %i found! Block %u - IDX_TBL = %u", temp->values[f], temp->pointers[f].addBlock, temp->pointers[f].indexTd);
-				
-			//deleting node
-			if(*toDo == 1){
-				btree_delete(temp,block,address,f);
-				AK_write_block(block);
-			}
-		}
-		idNext=temp->pointers[B].indexTd;
-	}
-	if(found == 0){
-		printf("\n Value not found!");
-	}
-	while(contin == 1){
-		memset(temp,0,sizeof(btree_node));
-		memcpy(temp,&block->data[block->tuple_dict[idNext].address],sizeof(btree_node));
-		
-		//searching for value
-		for(f=0;f<B;f++){
-			if((temp->values[f]) <= *endRange){
-				//printing data after finding node
-				printf("\n Value %i found! Block %u - IDX_TBL = %u", temp->values[f], temp->pointers[f].addBlock, temp->pointers[f].indexTd);
-				
-				//deleting node
-				if(*toDo == 1){
-					btree_delete(temp,block,idNext,f);
-				}
-			}else
-				contin = 0;
-		idNext=temp->pointers[B].indexTd;
-		AK_write_block(block);
-		}
-	}
-	AK_EPI;
-	return EXIT_SUCCESS;
-}
-
-
-/**
-  * @author Anđelko Spevec
-  * @brief Function that deletes a value in btree index
-  * @param temp - node for deletion
-  * @param block - block that contains binary tree
-  * @param idNext - index of the node that is to be deleted
- */
-void btree_delete(btree_node * temp, AK_block * block, int idNext, int i){
-	temp->values[i] = -1;
-	temp->pointers[i].addBlock = 0;
-	temp->pointers[i].indexTd = 0;
-	memcpy(&block->data[idNext],temp,sizeof(btree_node));
-	printf("\n Value deleted!");
-}
-
-/**
-  * @author unknown
-  * @brief Function that inserts a value in btree index
-  * @param indexName - name of the index
-  * @param insertValue - value for insert
-  * @param insertTd - index table destination
-  * @param insertBlock - block address
-  * @param inputBlock - block containing btree
-  * @param EXIT_SUCCESS if successful 
- */
-int AK_btree_insert(char *indexName,int *insertValue, int *insertTd, int *insertBlock, AK_block * inputBlock){
-	AK_PRO;
-	//finding correct block           !!!functions AK_find_AK_free_space, AK_get_index_addresses and AK_read_block should be checked for mistakes!!!
-	int adr_to_read = (int) AK_find_AK_free_space(AK_get_index_addresses(indexName));
-	//AK_block *block = (AK_block*) AK_read_block(adr_to_read);    
-	AK_block *block = inputBlock;
-	
-	//assign root node to root_info variable
-	root_info *root = (root_info*) AK_malloc(sizeof (root_info));
-	memset(root, 0, sizeof (root_info));
-	memcpy(root,block->data,sizeof (root_info));
-	
-	//assign values to properties of root node
-	btree_node *temp = (btree_node*) AK_malloc(sizeof(btree_node));
-	int insertPath[ORDER];//id of the selected node, iP[0] root
-	int insertIndexPath[ORDER];//index of a pointer selected in node, iIP[0] is index selected in root
-	int address = block->tuple_dict[root->root].address;
-	insertPath[0] = root->root;
-	int type = block->tuple_dict[root->root].type;
-	int inc=1;
-	
-	//navigating through the tree
-	while(type == 1){
-		memset(temp,0,sizeof(btree_node));
-		memcpy(temp,&block->data[address],sizeof(btree_node));
-		int b,goTo = B,done=0;
-		for(b=0;b<B;b++){
-			if((*insertValue<(temp->values[b])) && (done == 0)){
-				goTo=b;
-				done = 1;
-			}
-		}
-		insertIndexPath[inc-1] = goTo;
-		insertPath[inc] = temp->pointers[goTo].indexTd;
-		address = block->tuple_dict[temp->pointers[goTo].indexTd].address;
-		type = block->tuple_dict[temp->pointers[goTo].indexTd].type;
-		if(type == 1){
-			inc++;
-		}//node == 1, leaf == 0
-	}
-	
-	//assign values to properties of leaf node
-	int j;
-	int destinationAddress = block->tuple_dict[insertPath[inc]].address;
-	memset(temp,0,sizeof(btree_node));
-	memcpy(temp,&block->data[destinationAddress],sizeof(btree_node));
-	int AK_freeSpace = 0;
-	for(j=0;j<B;j++){
-		if(temp->values[j] == -1){
-			AK_freeSpace++;
-		}
-	}
-	int inserted = 0,increase=0;
-	btree_node *temp_help = (btree_node*) AK_malloc(sizeof(btree_node));
-	memset(temp_help,0,sizeof(btree_node));
-	//we have FREE space in LEAF
-	if(AK_freeSpace != 0){ 
-		temp_help = searchValue(inserted, *insertValue, temp, temp_help, *insertTd,*insertBlock,&increase,-1);
-		memset(&block->data[destinationAddress],0,sizeof(btree_node));
-		memcpy(&block->data[destinationAddress],temp_help,sizeof(btree_node));
-		AK_write_block(block);
-		printf("\nNew value is added in leaf with available space");	
-	}
-	//we have to SPLIT the LEAF
-	else{
-		btree_node *temp_help_two = (btree_node*) AK_malloc(sizeof(btree_node));
-		memset(temp_help_two,0,sizeof(btree_node));
-		
-		//assign values to temporary node
-		temp_help = searchValue(inserted, *insertValue, temp, temp_help, *insertTd,*insertBlock,&increase,findCorrectNumber(1));
-		temp_help->pointers[B].indexTd = block->last_tuple_dict_id + 1; //points to new leaf
-		temp_help->pointers[B].addBlock = adr_to_read; //update when fix multiple blocks
-		memset(&block->data[destinationAddress],0,sizeof(btree_node));
-		memcpy(&block->data[destinationAddress],temp_help,sizeof(btree_node)); 
-		
-		//assign values to temporary node
-		temp_help_two = searchValue(inserted, *insertValue, temp, temp_help_two, *insertTd,*insertBlock,&increase,findCorrectNumber(2));
-		temp_help_two->pointers[B].indexTd = temp->pointers[B].indexTd; //points to next leaf
-		temp_help_two->pointers[B].addBlock = temp->pointers[B].addBlock;
-		memcpy(&block->data[block->AK_free_space], temp_help_two, sizeof(btree_node));
-		 
-		//assign values to block
-		int id = block->last_tuple_dict_id + 1;
-		block->tuple_dict[id].address = block->AK_free_space;
-		block->tuple_dict[id].type = LEAF;
-		block->AK_free_space += sizeof(btree_node);
-		block->last_tuple_dict_id = id;
-		
-		//update root_info->level[0] number of leafs
-		root->level[0]++;
-		memcpy(&block->data[0],root,sizeof(root_info));
-		AK_write_block(block);
-		
-		//checking nodes above 
-		int pathIndex = inc - 1;
-		int nodeAddress = block->tuple_dict[insertPath[pathIndex]].address;
-		int pointerIndex = insertIndexPath[pathIndex];
-		memset(temp,0,sizeof(btree_node));
-		memcpy(temp,&block->data[nodeAddress],sizeof(btree_node));
-
-		memset(temp_help,0,sizeof(btree_node));
-		int AK_freePointer = 0;
-		for(j=0;j<B;j++){
-			if(temp->values[j] == -1)
-				AK_freePointer = 1;
-		}
-		
-		int startSecond = 0, copyNode = 1,skip = 1;
-		if(AK_freePointer == 1){//in node above we have FREE POINTER to insert NEW LEAF
-			//adding value
-			temp_help = setNodePointers(temp_help,temp,pointerIndex,temp_help_two->values[0],insertPath[inc],id);
-			memset(&block->data[nodeAddress],0,sizeof(btree_node));
-			memcpy(&block->data[nodeAddress],temp_help,sizeof(btree_node)); 
-			AK_write_block(block);
-			printf("\nNew value is added in new leaf. Node above had available space.");
-		}else{//spliting nodes
-			int nodeIncrease,nodeInserted,helpAddress,helpType,nodeAboveAddress;
-			int again = 1,newRoot=0,updateIdx = 1;
-			
-			btree_node *temp_node_one = (btree_node*) AK_malloc(sizeof(btree_node));
-			btree_node *temp_node_two = (btree_node*) AK_malloc(sizeof(btree_node));
-			btree_node *value_help = (btree_node*) AK_malloc(sizeof(btree_node));
-			
-			while(again == 1){
-				memset(temp_node_one,0,sizeof(btree_node));
-				memset(temp_node_two,0,sizeof(btree_node));
-				memset(value_help,0,sizeof(btree_node));
-
-				nodeIncrease = 0;
-				nodeInserted = 0;
-				helpType=NODE;
-				
-				//pointers for first node
-				temp_node_one = findPointers(temp_node_one, temp, id, &nodeInserted, &nodeIncrease, 3, pointerIndex);
-				
-				//values for first node
-				temp_node_one = findValues(temp_node_one, block, &helpAddress, &helpType, value_help);
-				
-				//pointers for second node
-				temp_node_two = findPointers(temp_node_two, temp, id, &nodeInserted, &nodeIncrease, 4, pointerIndex);
-				
-				//values for second node
-				temp_node_two = findValues(temp_node_two, block, &helpAddress, &helpType, value_help);
-				
-				//updating block with btree
-				memset(&block->data[block->tuple_dict[insertPath[pathIndex]].address],0,sizeof(btree_node));
-				memcpy(&block->data[block->tuple_dict[insertPath[pathIndex]].address],temp_node_one,sizeof(btree_node)); 
-				memcpy(&block->data[block->AK_free_space],temp_node_two,sizeof(btree_node)); 
-				id = block->last_tuple_dict_id + 1;
-				block->tuple_dict[id].address = block->AK_free_space;
-				block->tuple_dict[id].type = NODE;
-				block->AK_free_space += sizeof(btree_node);
-				block->last_tuple_dict_id = id;
-				root->level[updateIdx]++;
-				memcpy(&block->data[0],root,sizeof(root_info));
-				updateIdx++;
-				AK_write_block(block);
-
-				if(newRoot == 1){
-					again = 0;
-					memset(temp,0,sizeof(btree_node));
-					temp->pointers[0].indexTd = insertPath[pathIndex];
-					temp->pointers[1].indexTd = id;
-					helpAddress = block->tuple_dict[id].address;
-					helpType = block->tuple_dict[id].type;
-					memset(value_help,0,sizeof(btree_node));
-					memcpy(value_help,&block->data[helpAddress],sizeof(btree_node));			
-					while(helpType == NODE){
-						helpAddress = block->tuple_dict[value_help->pointers[0].indexTd].address;
-						helpType = block->tuple_dict[value_help->pointers[0].indexTd].type;
-						memset(value_help,0,sizeof(btree_node));
-						memcpy(value_help,&block->data[helpAddress],sizeof(btree_node));
-					}
-					temp->values[0] = value_help->values[0];
-					printf("\nNew value is added and tree is updated! New root added, so order of the tree increased!");
-					//updating block with btree
-					memcpy(&block->data[block->AK_free_space],temp,sizeof(btree_node)); 
-					id = block->last_tuple_dict_id + 1;
-					block->tuple_dict[id].address = block->AK_free_space;
-					block->tuple_dict[id].type = NODE;
-					block->AK_free_space += sizeof(btree_node);
-					block->last_tuple_dict_id = id;
-					root->level[updateIdx] = 1;
-					root->root = id;
-					memcpy(&block->data[0],root,sizeof(root_info));
-					AK_write_block(block);	
-				}else{
-					//get above node !
-					if(pathIndex != 0)
-						pathIndex = pathIndex - 1; //0, insertPath[0] = 13 (root)
-					nodeAboveAddress = block->tuple_dict[insertPath[pathIndex]].address;
-					memset(temp,0,sizeof(btree_node));
-					memcpy(temp,&block->data[nodeAboveAddress],sizeof(btree_node));
-					
-					for(j=0;j<B;j++){
-						if(temp->values[j] == -1)
-							AK_freePointer = 1;
-					}
-					if(AK_freePointer == 1){
-						again = 0;
-						increase = 0;
-						memset(temp_help,0,sizeof(btree_node));
-						for(j=0;j<=B;j++){
-							if(j == (insertIndexPath[pathIndex]+1)){
-								temp_help->pointers[j].indexTd = id;
-							}else{
-								temp_help->pointers[j].indexTd = temp->pointers[increase].indexTd;
-								increase++;
-							}	
-						}
-						//updating block with btree
-						temp_help = findValues(temp_help, block, &helpAddress, &helpType, value_help);
-						memcpy(&block->data[block->AK_free_space],temp,sizeof(btree_node)); 
-						id = block->last_tuple_dict_id + 1;
-						block->tuple_dict[id].address = block->AK_free_space;
-						block->tuple_dict[id].type = NODE;
-						block->AK_free_space += sizeof(btree_node);
-						block->last_tuple_dict_id = id;
-						AK_write_block(block);	
-					}else{//if root is full->new root...
-						if(root->root == insertPath[pathIndex])
-							newRoot = 1;
-						else
-							again = 1;
-					}
-				}
-			}
-			if(newRoot != 1)
-				printf("\nNew value is added and tree is updated!");
-		}
-	}
-	AK_EPI;
-	return EXIT_SUCCESS;
-}
-
-
-/**
-  * @author unknown
-  * @brief Function that sets values for node
-  * @param temp_help - node that has it's values set
-  * @param insertValue - value for insert
-  * @param insertTd - index table destination
-  * @param insertBlock - block address
-  * @param i - determins the index of element of node
-  * @return  node that has it's values set 
- */
-btree_node * makevalues(btree_node * temp_help, int insertValue, int insertTd, int insertBlock, int i){
-	temp_help->values[i] = insertValue;
-	temp_help->pointers[i].indexTd = insertTd;
-	temp_help->pointers[i].addBlock = insertBlock;
-	return temp_help;
-}
-
-/**
-  * @author unknown
-  * @brief returns data about a leaf
-  * @return required value
- */
-int findCorrectNumber(int number){
-	int amount = B % 2;
-	if(amount == 0){//uneven number of pointers (B+1)%2 = 1
-		//we need to insert B+1 elements in two leafs -> 4+1=3+2
-		if(number == 1)
-			return (B/2) + 1; //B=4,(4/2)+1=3 elements in first leaf
-		if(number == 2)
-			return B/2; //B=4,(4/2)=2 elements in second leaf
-		if(number == 3)
-			return (B + 2)/2;  //B=4, (B+1+1)/2 = 3 pointers in first LEAF
-		if(number == 4)
-			return (B + 2)/2; //B=4, (B+1+1)/2 = 3 pointers in second LEAF
-	}else{//even number of pointers (B+1)%2 = 0
-		//we need to insert B+1 elements in two leafs -> 3+1=2+2
-		if(number == 1)
-			return (B + 1)/2; //B=3,(3+1)/2=2 elements in first leaf
-		if(number == 2)
-			return (B + 1)/2; //B=3,(3+1)/2=2 elements in second leaf 
-		if(number == 3)
-			return ((B + 1)/2) + 1; //B=3, ((3+1)/2)+1= 3 pointers in first leaf
-		if(number == 4)
-			return (B + 1)/2; //B=3 (3+1)/2=2 pointers in second leaf			
-	}
-}
-
-/**
-  * @author unknown
-  * @brief Function that sets values for node
-  * @param inserted - determins if a value in a tree smaller then the value for insert has been found
-  * @param insertValue - value for insert
-  * @param temp - node with data about existing node
-  * @param temp_help - node that has it's values set
-  * @param insertTd - index table destination
-  * @param insertBlock - block address
-  * @param increase - determins the index of element of a node
-  * @param number - gives information about the number of elements in a leaf
-  * @return  node that has it's values set 
- */
-btree_node * searchValue(int inserted, int insertValue, btree_node * temp, btree_node * temp_help, int *insertTd, int *insertBlock,int* increase, int number){
-	int stop = 0;
-	for(int j=0;j<B;j++){
-		if(stop == 0){
-			if(inserted == 0){
-				if(insertValue < temp->values[*increase]){
-					temp_help = makevalues(temp_help,insertValue,*insertTd,*insertBlock,j);
-					inserted = 1;
-				}else{
-					temp_help = makevalues(temp_help,temp->values[*increase],temp->pointers[*increase].indexTd,temp->pointers[*increase].addBlock,j);
-					*increase++;
-				}
-			}else{
-				if(temp->values[*increase] == -1 && number == -1){
-					temp_help = makevalues(temp_help,insertValue,*insertTd,*insertBlock,j);
-					inserted = 1;
-				}else{
-					temp_help = makevalues(temp_help,temp->values[*increase],temp->pointers[*increase].indexTd,temp->pointers[*increase].addBlock,j);
-					*increase++;
-				}	
-			}
-			if((j+1) == number)
-				stop = 1;
-		}else{	
-			if(number != -1) 
-				temp_help = makevalues(temp_help,-1,0,0,j);
-			else{
-				temp_help->values[j] = temp->values[*increase];
-				temp_help->pointers[j] = temp->pointers[*increase];
-				*increase++;
-			}
-		}		
-	}
-	return temp_help;
-}
-
-/**
-  * @author unknown
-  * @brief Function that sets values for node
-  * @param temp - node with data about existing node
-  * @param temp_help - node that has it's values set
-  * @param pointerIndex - indicates what pointer is used
-  * @param secondValue - value of a node
-  * @param firstPointer - value to which a pointer of a node is to be set
-  * @param secondPointer - value to which a pointer of a node is to be set
-  * @return  node that has it's values set 
- */
-btree_node * setNodePointers(btree_node * temp, btree_node * temp_help,int pointerIndex,int secondValue,int firstPointer,int secondPointer){
-	int firstValue = temp_help->values[0];
-	int AK_freePointer = 0;
-	for(int j=0;j<B;j++){
-		if(temp->values[j] == -1)
-			AK_freePointer = 1;
-	}
-	int startSecond = 0, copyNode = 1,skip = 1;
-	int increase = 0;
-	temp_help->pointers[0].indexTd = temp->pointers[0].indexTd;
-	if(pointerIndex == 0){
-		startSecond = 1;
-		copyNode = 0;
-		skip = 0;
-	}
-	for(int j=1;j<=B;j++){
-		if((copyNode == 1) && (j != pointerIndex)){
-			temp_help->values[j-1] = temp->values[increase];
-			temp_help->pointers[j].indexTd = temp->pointers[increase+1].indexTd;
-			increase++;
-		}
-		if(startSecond == 1){
-			temp_help->values[j-1] = secondValue;
-			temp_help->pointers[j].indexTd = secondPointer;
-			if(skip == 1){
-				increase++;
-			}
-			startSecond = 0;
-			copyNode = 1;
-		}
-		if(j == pointerIndex){
-			temp_help->values[j-1] = firstValue;
-			temp_help->pointers[j].indexTd = firstPointer;
-			startSecond = 1;
-			copyNode = 0;
-		}
-	}
-	return temp_help;
-}
-
-/**
-  * @author unknown
-  * @brief Function that sets values for node
-  * @param temp_node_one - node that has it's values set
-  * @param temp - node with data about existing node
-  * @param id - value to which a pointer of a node is to be set
-  * @param nodeInserted - determins if a node has value
-  * @param nodeIncrease - shows node that is currently watched
-  * @param number - determins the way node values are checked
-  * @param pointerIndex - indicates what pointer is used
-  * @return  node that has it's values set 
- */
-btree_node * findPointers(btree_node * temp_node_one, btree_node * temp, int id, int* nodeInserted,int* nodeIncrease, int number, int pointerIndex){
-	for(int j=0;j<findCorrectNumber(number);j++){
-		int compare;
-		if(number == 3)
-			compare = j;
-		else
-			compare = *nodeIncrease;
-		if((compare==(pointerIndex+1)) && (*nodeInserted == 0)){
-			temp_node_one->pointers[j].indexTd = id;
-			temp_node_one->pointers[j].addBlock = 0;//update when fixing blocks
-			if(number == 3)
-				*nodeInserted = 1;
-		}
-		else{
-			temp_node_one->pointers[j].indexTd = temp->pointers[*nodeIncrease].indexTd;
-			temp_node_one->pointers[j].addBlock = temp->pointers[*nodeIncrease].addBlock;
-			*nodeIncrease++;
-		}
-	}
-	return temp_node_one;
-}
-
-/**
-  * @author unknown
-  * @brief Function that sets values for node
-  * @param temp_node_one - node that has it's values set
-   * @param block - block containing btree
-  * @param helpAddress - address of current node
-  * @param helpType - type of current node
-  * @param value_help - node in helpAddress
-  * @return  node that has it's values set 
- */
-btree_node * findValues(btree_node * temp_node_one, AK_block * block, int* helpAddress,int* helpType, btree_node *value_help){
-	for(int j=0;j<B;j++){
-		if(temp_node_one->pointers[j+1].indexTd != 0){
-			*helpAddress = block->tuple_dict[temp_node_one->pointers[j+1].indexTd].address;
-			*helpType = block->tuple_dict[temp_node_one->pointers[j+1].indexTd].type;
-			memset(value_help,0,sizeof(btree_node));
-			memcpy(value_help,&block->data[*helpAddress],sizeof(btree_node));			
-			while(*helpType == NODE){
-				*helpAddress = block->tuple_dict[value_help->pointers[0].indexTd].address;
-				*helpType = block->tuple_dict[value_help->pointers[0].indexTd].type;
-				memset(value_help,0,sizeof(btree_node));
-				memcpy(value_help,&block->data[*helpAddress],sizeof(btree_node));
-			}
-			temp_node_one->values[j] = value_help->values[0];
-		}
-	}
-	return temp_node_one;
-}
-
-/**
- * @author unknown
- * @brief Returns the amount of successful and failed tests.
- * @return TestResult
- */ 
-TestResult AK_btree_test() {
-	int passed_tests=0;
-    	int failed_tests=0;
-    	
-	char *tblName = "student";
-	char *indexName = "student_btree_index";
-	AK_PRO;
-	struct list_node *att_list = (struct list_node *) AK_malloc(sizeof (struct list_node));
-	AK_Init_L3(&att_list);
-	AK_InsertAtEnd_L3(TYPE_ATTRIBS, "mbr\0", 4, att_list);
-
-	AK_block * block = AK_btree_create(tblName, att_list, indexName);
-	if(block == NULL){
-		failed_tests++;
-	}
-	else{
-		passed_tests++;
-	}
-	printf("\n\n---------------------------");
-	printf("\nInserting new value...\n");
-	int iv=39123;
-	int ii=101;
-	int ib=301;
-	int *insertValue = &iv; //insert in leaf with available space
-	//int *insertValue = 35901; //insert in full leaf -> new leaf, full node above - split
-	int *insertTd = &ii;
-	int *insertBlock = &ib;
-	if(AK_btree_insert(indexName,insertValue,insertTd,insertBlock,block) == EXIT_SUCCESS){
-		passed_tests++;
-	}
-	else{
-		failed_tests++;
-	}
-	//use insert function for 39123 and again for 39000 to test spliting leaf with AK_free space above
-	iv=39000;
-	insertValue = &iv; //insert in full leaf -> new leaf, AK_free space in node above
-	if(AK_btree_insert(indexName,insertValue,insertTd,insertBlock,block) == EXIT_SUCCESS){
-		passed_tests++;
-	}
-	else{
-		failed_tests++;
-	}
-	printf("\n\n---------------------------");
-	printf("\nSearching value...\n");
-	int sv=35906;
-	int er=35916;
-	int td=1;
-	int *searchValue = &sv;
-	int *endRange = &er;
-	//int *endRange = 0;
-	int *toDo = &td;//0 search, 1 delete
-	if(AK_btree_search_delete(indexName, searchValue, endRange, toDo, block) == EXIT_SUCCESS){
-		passed_tests++;
-	}
-	else{
-		failed_tests++;
-	}
-	printf("\n");
-	AK_EPI;
-	return TEST_result(passed_tests,failed_tests);
+ * @author agent
+ * @brief  Function that reads the first page of a B+tree index
+ * @param indexName name of the index
+ * @param meta receives the page
+ * @return EXIT_SUCCESS, EXIT_ERROR if there is no such B+tree index
+ */
+int AK_btree_get_meta(char *indexName, AK_btree_meta *meta)
+{
+    AK_btree_tree tree;
+    int result;
+    AK_PRO;
+    pthread_rwlock_rdlock(&AK_btree_lock);
+    result = AK_btree_open_tree(indexName, &tree);
+    pthread_rwlock_unlock(&AK_btree_lock);
+    if (result == EXIT_SUCCESS)
+        memcpy(meta, &tree.meta, sizeof(AK_btree_meta));
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @author agent
+ * @brief  Function that inserts a key into a B+tree index, splitting full pages on the way back to the root
+ * @param indexName name of the index
+ * @param key values of the key attributes in the order of the key
+ * @param rid RID of the row
+ * @return EXIT_SUCCESS, EXIT_ERROR if the key can not be encoded or is already in the index
+ */
+int AK_btree_insert(char *indexName, struct list_node *key, AK_rid *rid)
+{
+    AK_btree_tree tree;
+    AK_btree_node leaf;
+    unsigned char entry[AK_BTREE_MAX_KEY];
+    int size, level, i, result = EXIT_ERROR;
+    AK_PRO;
+    pthread_rwlock_wrlock(&AK_btree_lock);
+    if (AK_btree_open_tree(indexName, &tree) != EXIT_SUCCESS)
+        printf("B+tree index %s does not exist!\n", indexName);
+    else if ((size = AK_btree_encode_key(&tree.meta, key, 1, rid, entry)) == EXIT_ERROR)
+        printf("Key can not be inserted into index %s!\n", indexName);
+    else {
+        level = AK_btree_descend(&tree, entry, size);
+        if (AK_btree_read_node(tree.path[level], &leaf) == EXIT_SUCCESS) {
+            i = AK_btree_node_search(&leaf, entry, size);
+            if (i < leaf.count && AK_btree_key_compare(AK_BTREE_KEY(&leaf, i), leaf.size[i], entry, size) == 0)
+                printf("Key of row %d in block %d is already in index %s!\n", rid->slot, rid->block, indexName);
+            else {
+                AK_btree_node_insert(&leaf, i, entry, size, 0);
+                result = AK_btree_store(&tree, level, &leaf);
+                tree.meta.entries++;
+                AK_btree_write_meta(&tree);
+            }
+        }
+        AK_btree_node_free(&leaf);
+    }
+    pthread_rwlock_unlock(&AK_btree_lock);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @author agent
+ * @brief  Function that deletes a key from a B+tree index. A page left less than a quarter full is merged with a
+ * neighbour or takes keys from it.
+ * @param indexName name of the index
+ * @param key values of the key attributes in the order of the key
+ * @param rid RID of the row
+ * @return EXIT_SUCCESS, EXIT_ERROR if the key is not in the index
+ */
+int AK_btree_delete_key(char *indexName, struct list_node *key, AK_rid *rid)
+{
+    AK_btree_tree tree;
+    AK_btree_node leaf;
+    unsigned char entry[AK_BTREE_MAX_KEY];
+    int size, level, i, result = EXIT_ERROR;
+    AK_PRO;
+    pthread_rwlock_wrlock(&AK_btree_lock);
+    if (AK_btree_open_tree(indexName, &tree) != EXIT_SUCCESS)
+        printf("B+tree index %s does not exist!\n", indexName);
+    else if ((size = AK_btree_encode_key(&tree.meta, key, 1, rid, entry)) != EXIT_ERROR) {
+        level = AK_btree_descend(&tree, entry, size);
+        if (AK_btree_read_node(tree.path[level], &leaf) == EXIT_SUCCESS) {
+            i = AK_btree_node_search(&leaf, entry, size);
+            if (i < leaf.count && AK_btree_key_compare(AK_BTREE_KEY(&leaf, i), leaf.size[i], entry, size) == 0) {
+                AK_btree_node_remove(&leaf, i);
+                result = AK_btree_rebalance(&tree, level, &leaf);
+                tree.meta.entries--;
+                AK_btree_write_meta(&tree);
+            }
+        }
+        AK_btree_node_free(&leaf);
+    }
+    pthread_rwlock_unlock(&AK_btree_lock);
+    AK_EPI;
+    return result;
 }
 
+/**
+ * @author agent
+ * @brief  Function that opens a range scan of a B+tree index. The bounds are values of the first key attributes,
+ * fewer than all of them compare only those attributes; both bounds are included.
+ * @param indexName name of the index
+ * @param low lower bound, NULL for a scan from the first key
+ * @param high upper bound, NULL for a scan to the last key
+ * @return cursor, NULL if there is no such index or a bound can not be encoded
+ */
+AK_btree_cursor *AK_btree_open(char *indexName, struct list_node *low, struct list_node *high)
+{
+    AK_btree_tree tree;
+    AK_btree_cursor *cursor;
+    int result;
+    AK_PRO;
+    pthread_rwlock_rdlock(&AK_btree_lock);
+    result = AK_btree_open_tree(indexName, &tree);
+    pthread_rwlock_unlock(&AK_btree_lock);
+    if (result != EXIT_SUCCESS) {
+        AK_EPI;
+        return NULL;
+    }
+    cursor = (AK_btree_cursor *) AK_calloc(1, sizeof(AK_btree_cursor));
+    strncpy(cursor->index, indexName, MAX_ATT_NAME - 1);
+    cursor->last_size = AK_btree_encode_key(&tree.meta, low, 0, NULL, cursor->last);
+    cursor->high_size = high == NULL ? -1 : AK_btree_encode_key(&tree.meta, high, 0, NULL, cursor->high);
+    if (cursor->last_size == EXIT_ERROR || (high != NULL && cursor->high_size == EXIT_ERROR)) {
+        printf("Bounds can not be compared with the keys of index %s!\n", indexName);
+        AK_free(cursor);
+        cursor = NULL;
+    }
+    AK_EPI;
+    return cursor;
+}
+
+/**
+ * @author agent
+ * @brief  Function that reads the next batch of RIDs of a range scan. It walks from the root to the leaf of the last
+ * key read and follows the leaves to the right until the batch is full or a key is above the upper bound.
+ * @param cursor cursor
+ */
+static void AK_btree_fill(AK_btree_cursor *cursor)
+{
+    AK_btree_tree tree;
+    AK_block *block;
+    AK_btree_page *page;
+    unsigned char key[AK_BTREE_MAX_KEY];
+    int level, address, i, size;
+
+    cursor->count = 0;
+    cursor->position = 0;
+    pthread_rwlock_rdlock(&AK_btree_lock);
+    if (AK_btree_open_tree(cursor->index, &tree) != EXIT_SUCCESS) {
+        cursor->end = 1;
+        pthread_rwlock_unlock(&AK_btree_lock);
+        return;
+    }
+    address = tree.meta.root;
+    for (level = 0; level < tree.meta.height - 1; level++) {
+        block = ((AK_mem_block *) AK_get_block(address))->block;
+        address = AK_btree_page_child(block, AK_btree_page_search(block, cursor->last, cursor->last_size, 1));
+    }
+    block = ((AK_mem_block *) AK_get_block(address))->block;
+    i = AK_btree_page_search(block, cursor->last, cursor->last_size, cursor->started);
+    while (cursor->count < AK_BTREE_CURSOR_RIDS) {
+        page = (AK_btree_page *) block->data;
+        if (i >= page->count) {
+            if (page->next == 0) {
+                cursor->end = 1;
+                break;
+            }
+            block = ((AK_mem_block *) AK_get_block(page->next))->block;
+            i = 0;
+            continue;
+        }
+        size = AK_btree_page_key(block, i, key);
+        if (cursor->high_size >= 0 && memcmp(key, cursor->high, size < cursor->high_size ? size : cursor->high_size) > 0) {
+            cursor->end = 1;
+            break;
+        }
+        AK_btree_decode_rid(key, size, &cursor->rid[cursor->count++]);
+        memcpy(cursor->last, key, size);
+        cursor->last_size = size;
+        cursor->started = 1;
+        i++;
+    }
+    pthread_rwlock_unlock(&AK_btree_lock);
+}
+
+/**
+ * @author agent
+ * @brief  Function that moves a range scan to the next key; keys come in ascending order
+ * @param cursor cursor, may be NULL
+ * @return RID of the row, owned by the cursor and valid until the next call; NULL after the last key
+ */
+AK_rid *AK_btree_next(AK_btree_cursor *cursor)
+{
+    AK_PRO;
+    if (cursor == NULL) {
+        AK_EPI;
+        return NULL;
+    }
+    if (cursor->position == cursor->count) {
+        if (cursor->end) {
+            AK_EPI;
+            return NULL;
+        }
+        AK_btree_fill(cursor);
+        if (cursor->count == 0) {
+            AK_EPI;
+            return NULL;
+        }
+    }
+    AK_EPI;
+    return &cursor->rid[cursor->position++];
+}
+
+/**
+ * @author agent
+ * @brief  Function that closes a range scan
+ * @param cursor cursor, may be NULL
+ */
+void AK_btree_close(AK_btree_cursor *cursor)
+{
+    AK_PRO;
+    AK_free(cursor);
+    AK_EPI;
+}
+
+/**
+ * @author agent
+ * @brief  Function that counts the keys of a range scan and checks that their RIDs come in the order of the values
+ * the test gave them: the block of the RID is the position of the value in ascending order
+ * @param indexName name of the index
+ * @param low lower bound
+ * @param high upper bound
+ * @param ordered receives 0 if the RIDs are out of order
+ * @return number of keys
+ */
+static int AK_btree_test_scan(char *indexName, struct list_node *low, struct list_node *high, int *ordered)
+{
+    AK_btree_cursor *cursor = AK_btree_open(indexName, low, high);
+    AK_rid *rid;
+    int count = 0, previous = -1;
+    *ordered = cursor != NULL;
+    while ((rid = AK_btree_next(cursor)) != NULL) {
+        if (rid->block <= previous)
+            *ordered = 0;
+        previous = rid->block;
+        count++;
+    }
+    AK_btree_close(cursor);
+    return count;
+}
+
+TestResult AK_btree_test() {
+    int passed_tests = 0;
+    int failed_tests = 0;
+    char *tblName = "student";
+    char *indexName = "student_btree_index";
+    char *compositeName = "student_btree_year_name";
+    char *testTable = "btree_test";
+    char *idIndex = "btree_test_id";
+    char *nameIndex = "btree_test_name";
+    char name[MAX_VARCHAR_LENGTH], previous[MAX_VARCHAR_LENGTH];
+    AK_btree_meta meta;
+    AK_btree_cursor *cursor;
+    AK_cursor *rows;
+    AK_rid *rid, fake, placed;
+    struct list_node *row, *found, *value;
+    int i, n, id, count, matches, kept, ordered, pages, keys = 3000, year = 0;
+    float real;
+    AK_operator *plan;
+    AK_operator_info info;
+    AK_PRO;
+
+    struct list_node *att_list = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    struct list_node *key = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    struct list_node *high = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    struct list_node *row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&att_list);
+    AK_Init_L3(&key);
+    AK_Init_L3(&high);
+    AK_Init_L3(&row_root);
+
+    printf("\nB+tree index on mbr of table %s\n", tblName);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "mbr\0", 4, att_list);
+    if (AK_btree_create(tblName, att_list, indexName) == EXIT_SUCCESS && AK_btree_get_meta(indexName, &meta) == EXIT_SUCCESS
+        && meta.entries == AK_get_num_records(tblName)) {
+        passed_tests++;
+    } else {
+        printf("Index %s should have a key for every row of %s.\n", indexName, tblName);
+        failed_tests++;
+    }
+
+    printf("\nSearching every mbr...\n");
+    matches = 1;
+    rows = AK_cursor_open(tblName);
+    while ((row = AK_cursor_next(rows)) != NULL) {
+        value = (struct list_node *) AK_First_L2(row);
+        AK_DeleteAll_L3(&key);
+        AK_InsertAtEnd_L3(TYPE_INT, value->data, sizeof(int), key);
+        cursor = AK_btree_open(indexName, key, key);
+        count = 0;
+        while ((rid = AK_btree_next(cursor)) != NULL) {
+            found = AK_get_row_by_rid(rid);
+            if (found == NULL || memcmp(((struct list_node *) AK_First_L2(found))->data, value->data, sizeof(int)) != 0)
+                matches = 0;
+            if (found != NULL) {
+                AK_DeleteAll_L3(&found);
+                AK_free(found);
+            }
+            count++;
+        }
+        AK_btree_close(cursor);
+        if (count != 1)
+            matches = 0;
+    }
+    AK_cursor_close(rows);
+    if (matches) {
+        passed_tests++;
+    } else {
+        printf("Searching mbr in %s should find exactly its row.\n", indexName);
+        failed_tests++;
+    }
+
+    printf("\nComposite B+tree index on year and firstname, searching a year...\n");
+    AK_DeleteAll_L3(&att_list);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "year\0", 5, att_list);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "firstname\0", 10, att_list);
+    matches = AK_btree_create(tblName, att_list, compositeName) == EXIT_SUCCESS;
+    count = 0;
+    rows = AK_cursor_open(tblName);
+    while ((row = AK_cursor_next(rows)) != NULL) {
+        value = AK_GetNth_L2(4, row);
+        if (count == 0)
+            memcpy(&year, value->data, sizeof(int));
+        if (memcmp(&year, value->data, sizeof(int)) == 0)
+            count++;
+    }
+    AK_cursor_close(rows);
+    AK_DeleteAll_L3(&key);
+    AK_InsertAtEnd_L3(TYPE_INT, (char *) &year, sizeof(int), key);
+    cursor = AK_btree_open(compositeName, key, key);
+    n = 0;
+    previous[0] = '\0';
+    while ((rid = AK_btree_next(cursor)) != NULL) {
+        found = AK_get_row_by_rid(rid);
+        if (found == NULL)
+            matches = 0;
+        else {
+            value = AK_GetNth_L2(2, found);
+            memcpy(name, value->data, value->size);
+            name[value->size] = '\0';
+            if (memcmp(&year, AK_GetNth_L2(4, found)->data, sizeof(int)) != 0 || strcmp(previous, name) > 0)
+                matches = 0;
+            strcpy(previous, name);
+            AK_DeleteAll_L3(&found);
+            AK_free(found);
+        }
+        n++;
+    }
+    AK_btree_close(cursor);
+    if (matches && n == count) {
+        passed_tests++;
+    } else {
+        printf("Index %s found %d rows of year %d instead of %d.\n", compositeName, n, year, count);
+        failed_tests++;
+    }
+
+    printf("\nInserting %d keys into indexes of table %s...\n", keys, testTable);
+    AK_create_table_parameter *params = (AK_create_table_parameter *) AK_malloc(2 * sizeof(AK_create_table_parameter));
+    params[0] = *(AK_create_create_table_parameter(TYPE_INT, "id"));
+    params[1] = *(AK_create_create_table_parameter(TYPE_VARCHAR, "name"));
+    AK_create_table(testTable, params, 2);
+    AK_free(params);
+    AK_DeleteAll_L3(&att_list);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "id\0", 3, att_list);
+    matches = AK_btree_create(testTable, att_list, idIndex) == EXIT_SUCCESS;
+    AK_DeleteAll_L3(&att_list);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "name\0", 5, att_list);
+    matches = AK_btree_create(testTable, att_list, nameIndex) == EXIT_SUCCESS && matches;
+    //values are inserted in scrambled order, the RID of a value is its position in ascending order
+    for (i = 0; i < keys && matches; i++) {
+        n = (i * 7919) % keys;
+        fake.block = n + 1;
+        fake.slot = 0;
+        id = n - keys / 2;
+        AK_DeleteAll_L3(&key);
+        AK_InsertAtEnd_L3(TYPE_INT, (char *) &id, sizeof(int), key);
+        matches = AK_btree_insert(idIndex, key, &fake) == EXIT_SUCCESS;
+        sprintf(name, "key%05d", n);
+        AK_DeleteAll_L3(&key);
+        AK_InsertAtEnd_L3(TYPE_VARCHAR, name, strlen(name), key);
+        matches = AK_btree_insert(nameIndex, key, &fake) == EXIT_SUCCESS && matches;
+    }
+    if (matches && AK_btree_get_meta(nameIndex, &meta) == EXIT_SUCCESS && meta.height > 1 && meta.pages > 1
+        && AK_btree_test_scan(nameIndex, NULL, NULL, &ordered) == keys && ordered
+        && AK_btree_test_scan(idIndex, NULL, NULL, &ordered) == keys && ordered) {
+        printf("Index %s has %d keys on %d pages, %d levels.\n", nameIndex, meta.entries, meta.pages, meta.height);
+        passed_tests++;
+    } else {
+        printf("Indexes of %s should return all %d keys in ascending order.\n", testTable, keys);
+        failed_tests++;
+    }
+
+    printf("\nRange scans...\n");
+    AK_DeleteAll_L3(&key);
+    AK_InsertAtEnd_L3(TYPE_VARCHAR, "key01000", 8, key);
+    AK_DeleteAll_L3(&high);
+    AK_InsertAtEnd_L3(TYPE_VARCHAR, "key01999", 8, high);
+    count = AK_btree_test_scan(nameIndex, key, high, &ordered);
+    matches = count == 1000 && ordered;
+    id = -10;
+    AK_DeleteAll_L3(&key);
+    AK_InsertAtEnd_L3(TYPE_INT, (char *) &id, sizeof(int), key);
+    id = 9;
+    AK_DeleteAll_L3(&high);
+    AK_InsertAtEnd_L3(TYPE_INT, (char *) &id, sizeof(int), high);
+    count = AK_btree_test_scan(idIndex, key, high, &ordered);
+    if (matches && count == 20 && ordered) {
+        passed_tests++;
+    } else {
+        printf("Range scans of %s and %s returned wrong keys.\n", nameIndex, idIndex);
+        failed_tests++;
+    }
+
+    printf("\nDeleting keys...\n");
+    pages = meta.pages;
+    matches = 1;
+    for (i = 0; i < keys; i++) {
+        if (i % 30 == 0)
+            continue;
+        fake.block = i + 1;
+        fake.slot = 0;
+        sprintf(name, "key%05d", i);
+        AK_DeleteAll_L3(&key);
+        AK_InsertAtEnd_L3(TYPE_VARCHAR, name, strlen(name), key);
+        if (AK_btree_delete_key(nameIndex, key, &fake) != EXIT_SUCCESS)
+            matches = 0;
+    }
+    //a key that is not there
+    if (AK_btree_delete_key(nameIndex, key, &fake) != EXIT_ERROR)
+        matches = 0;
+    if (matches && AK_btree_get_meta(nameIndex, &meta) == EXIT_SUCCESS && meta.pages < pages
+        && AK_btree_test_scan(nameIndex, NULL, NULL, &ordered) == keys / 30 && ordered) {
+        printf("Index %s has %d keys on %d pages, %d levels.\n", nameIndex, meta.entries, meta.pages, meta.height);
+        passed_tests++;
+    } else {
+        printf("Index %s should keep %d keys on less than %d pages.\n", nameIndex, keys / 30, pages);
+        failed_tests++;
+    }
+
+    printf("\nInserting, updating and deleting a row of table %s...\n", testTable);
+    id = keys;
+    AK_Insert_New_Element(TYPE_INT, &id, testTable, "id", row_root);
+    AK_Insert_New_Element(TYPE_VARCHAR, "inserted", testTable, "name", row_root);
+    matches = AK_insert_row_rid(row_root, &placed) == EXIT_SUCCESS;
+    //a new value of the same size is written into the slot, a longer one moves the row
+    for (i = 0; i < 2; i++) {
+        AK_DeleteAll_L3(&row_root);
+        AK_Update_Existing_Element(TYPE_INT, &id, testTable, "id", row_root);
+        AK_Insert_New_Element(TYPE_VARCHAR, i == 0 ? "replaced" : "updated row", testTable, "name", row_root);
+        AK_update_row(row_root);
+        AK_DeleteAll_L3(&key);
+        AK_InsertAtEnd_L3(TYPE_VARCHAR, i == 0 ? "inserted" : "replaced", 8, key);
+        matches = matches && AK_btree_test_scan(nameIndex, key, key, &ordered) == 0;
+        AK_DeleteAll_L3(&key);
+        AK_InsertAtEnd_L3(TYPE_VARCHAR, i == 0 ? "replaced" : "updated row", i == 0 ? 8 : 11, key);
+        cursor = AK_btree_open(nameIndex, key, key);
+        rid = AK_btree_next(cursor);
+        found = rid == NULL ? NULL : AK_get_row_by_rid(rid);
+        if (found == NULL || memcmp(((struct list_node *) AK_First_L2(found))->data, &id, sizeof(int)) != 0
+            || (i == 0 && (rid->block != placed.block || rid->slot != placed.slot)))
+            matches = 0;
+        if (found != NULL) {
+            AK_DeleteAll_L3(&found);
+            AK_free(found);
+        }
+        AK_btree_close(cursor);
+    }
+
+    printf("\nUpdating the row of table %s to ids that can not be indexed...\n", testTable);
+    //a float is written into the slot, a longer text rewrites the row in its block, the index turns both down
+    kept = 1;
+    for (i = 0; i < 2; i++) {
+        real = 1.5;
+        AK_DeleteAll_L3(&row_root);
+        AK_Update_Existing_Element(TYPE_INT, &id, testTable, "id", row_root);
+        if (i == 0)
+            AK_Insert_New_Element(TYPE_FLOAT, &real, testTable, "id", row_root);
+        else
+            AK_Insert_New_Element(TYPE_VARCHAR, "not a number", testTable, "id", row_root);
+        kept = AK_update_row(row_root) == EXIT_ERROR && kept;
+        AK_DeleteAll_L3(&key);
+        AK_InsertAtEnd_L3(TYPE_VARCHAR, "updated row", 11, key);
+        cursor = AK_btree_open(nameIndex, key, key);
+        rid = AK_btree_next(cursor);
+        found = rid == NULL ? NULL : AK_get_row_by_rid(rid);
+        if (found == NULL || memcmp(((struct list_node *) AK_First_L2(found))->data, &id, sizeof(int)) != 0)
+            kept = 0;
+        if (found != NULL) {
+            AK_DeleteAll_L3(&found);
+            AK_free(found);
+        }
+        AK_btree_close(cursor);
+        AK_DeleteAll_L3(&key);
+        AK_InsertAtEnd_L3(TYPE_INT, (char *) &id, sizeof(int), key);
+        kept = kept && AK_btree_test_scan(idIndex, key, key, &ordered) == 1;
+    }
+    if (kept) {
+        passed_tests++;
+    } else {
+        printf("A row whose new key can not be indexed in %s should keep its values and index entries.\n", testTable);
+        failed_tests++;
+    }
+
+    AK_DeleteAll_L3(&row_root);
+    AK_Update_Existing_Element(TYPE_INT, &id, testTable, "id", row_root);
+    AK_delete_row(row_root);
+    AK_DeleteAll_L3(&key);
+    AK_InsertAtEnd_L3(TYPE_INT, (char *) &id, sizeof(int), key);
+    if (matches && AK_btree_test_scan(idIndex, key, key, &ordered) == 0 && AK_btree_get_meta(idIndex, &meta) == EXIT_SUCCESS
+        && meta.entries == keys && AK_btree_get_meta(nameIndex, &meta) == EXIT_SUCCESS && meta.entries == keys / 30) {
+        passed_tests++;
+    } else {
+        printf("Indexes of %s should follow the row changes.\n", testTable);
+        failed_tests++;
+    }
+
+    printf("\nSelections of %s by index %s...\n", tblName, indexName);
+    //a conjunction with a condition on mbr reads the rows found by the index, a disjunction scans the table
+    for (i = 0; i < 3; i++) {
+        id = i == 0 ? 35907 : 35900;
+        year = 2005;
+        AK_DeleteAll_L3(&key);
+        AK_InsertAtEnd_L3(TYPE_ATTRIBS, "mbr", sizeof("mbr"), key);
+        AK_InsertAtEnd_L3(TYPE_INT, (char *) &id, sizeof(int), key);
+        AK_InsertAtEnd_L3(TYPE_OPERATOR, i == 0 ? "=" : ">=", i == 0 ? sizeof("=") : sizeof(">="), key);
+        AK_InsertAtEnd_L3(TYPE_ATTRIBS, "year", sizeof("year"), key);
+        AK_InsertAtEnd_L3(TYPE_INT, (char *) &year, sizeof(int), key);
+        AK_InsertAtEnd_L3(TYPE_OPERATOR, ">", sizeof(">"), key);
+        AK_InsertAtEnd_L3(TYPE_OPERATOR, i == 2 ? "OR" : "AND", i == 2 ? sizeof("OR") : sizeof("AND"), key);
+        plan = AK_access_operator(tblName, key);
+        AK_operator_describe(plan, &info);
+        count = AK_iterator_count(plan = AK_select_operator(plan, key));
+        AK_operator_free(plan);
+        n = AK_iterator_count(plan = AK_select_operator(AK_scan_operator(tblName), key));
+        AK_operator_free(plan);
+        printf("Selection %d of %s by %s: %d rows, expected %d\n", i + 1, tblName, info.index_scan ? "index" : "scan", count, n);
+        if (info.index_scan == (i != 2) && count >= 0 && count == n && (i != 0 || count == 1)) {
+            passed_tests++;
+        } else {
+            failed_tests++;
+        }
+    }
+
+    printf("\nDeleting indexes...\n");
+    matches = AK_btree_delete(idIndex) == EXIT_SUCCESS && AK_btree_delete(nameIndex) == EXIT_SUCCESS;
+    matches = AK_btree_delete(compositeName) == EXIT_SUCCESS && AK_btree_delete(indexName) == EXIT_SUCCESS && matches;
+    AK_delete_segment(testTable, SEGMENT_TYPE_TABLE);
+    if (matches && AK_btree_get_meta(nameIndex, &meta) == EXIT_ERROR && AK_btree_get_meta(indexName, &meta) == EXIT_ERROR) {
+        passed_tests++;
+    } else {
+        printf("Deleted indexes should be gone.\n");
+        failed_tests++;
+    }
+
+    AK_DeleteAll_L3(&att_list);
+    AK_free(att_list);
+    AK_DeleteAll_L3(&key);
+    AK_free(key);
+    AK_DeleteAll_L3(&high);
+    AK_free(high);
+    AK_DeleteAll_L3(&row_root);
+    AK_free(row_root);
+    printf("\n");
+    AK_EPI;
+    return TEST_result(passed_tests,failed_tests);
+}
@@ -6,12 +6,12 @@
  * it under the terms of the GNU General Public License as published by
  * the Free Software Foundation; either version 2 of the License, or
  * (at your option) any later version.
- * 
+ *
  * This program is distributed in the hope that it will be useful,
  * but WITHOUT ANY WARRANTY; without even the implied warranty of
  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
  * GNU Library General Public License for more details.
- * 
+ *
  * You should have received a copy of the GNU General Public License
  * along with this program; if not, write to the Free Software
  * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
@@ -20,82 +20,184 @@
 #ifndef BTREE
 #define BTREE
 
-#define B 3
-//order of the tree 6 - it can be lowered to usual 4-5 IF the B is increased!
-#define ORDER 6
-//now we have place for ((B+1)^(0RDER-1))*B = ((3+1)^(6-1))*3 = (4^5)*3 = 1024*3 = 3072 elements
-
-//types for tuple_dict
-#define LEAF 0
-#define NODE 1
-
 #include "../../auxi/test.h"
 #include "index.h"
 #include "../../file/table.h"
+#include "../../file/fileio.h"
 #include "../../auxi/constants.h"
 #include "../../auxi/configuration.h"
 #include "../../auxi/mempro.h"
 
-typedef struct{
-	//B values
-	int values[B];
-	/*
-	B + 1 pointers
-	IF type == 1 -> it points to other B+1 nodes/leafs
-	IF type == 0 -> first B points to addresses in tblName
-	and last pointer points to the next leaf (rangeSearch)
-	*/
-	struct_add pointers[B+1];
-}btree_node;
+//types for tuple_dict[0] of the pages of a B+tree index
+#define BTREE_META_PAGE 20
+#define BTREE_INNER_PAGE 21
+#define BTREE_LEAF_PAGE 22
+#define BTREE_FREE_PAGE 23
 
-/*
-root_info->level[index] represents the number of nodes in 
-that level from leafs to root, where root is always 1 (root doesn't
-have to be on index 5 - if order of the tree is 3 it can be on 2 so we
-distinct root lvl by value == 1). This is just theoretical representation
-of the full usage of the array for B=3 and 0=6.
-
-index|	     0 |       1 |       2 |       3 |       4 |       5 |
-value| (B+1)^5 | (B+1)^4 | (B+1)^3 | (B+1)^2 | (B+1)^1 | (B+1)^0 |
-level|   leaf  |         |         |         |         |   root  |
-*/
-typedef struct{
-	//tuple_dic[ID] of the root node in the block
-	int root;
-	//array size of the 0RDER
-	int level[ORDER]; 
-}root_info;
+/// number of bytes of a page available to the B+tree
+#define AK_BTREE_PAGE_SIZE (DATA_BLOCK_SIZE * DATA_ENTRY_SIZE)
+/// largest encoded key, the RID of the row included
+#define AK_BTREE_MAX_KEY 512
+/// largest number of levels of a tree
+#define AK_BTREE_MAX_HEIGHT 16
+/// percentage of a page filled by AK_btree_create
+#define AK_BTREE_FILL 75
+/// number of RIDs a cursor reads from the tree at once
+#define AK_BTREE_CURSOR_RIDS 256
+
+/**
+ * @author agent
+ * @struct AK_btree_meta
+ * @brief Structure that defines the first page of a B+tree index. Every other page of the index holds one node.
+ * Keys are the values of the key attributes encoded so that comparing their bytes orders them like the values,
+ * followed by the RID of the row, so equal values of different rows are different keys.
+ */
+typedef struct {
+    /// name of the indexed table
+    char table[MAX_ATT_NAME];
+    /// number of key attributes
+    int attributes;
+    /// positions of the key attributes in the table
+    int position[MAX_ATTRIBUTES];
+    /// types of the key attributes
+    int type[MAX_ATTRIBUTES];
+    /// address of the root page
+    int root;
+    /// number of levels, 1 while the root is a leaf
+    int height;
+    /// number of keys
+    int entries;
+    /// number of node pages
+    int pages;
+    /// last page taken from the extents of the index
+    int last_page;
+    /// first page of the list of freed pages, 0 if it is empty
+    int free_page;
+} AK_btree_meta;
 
+/**
+ * @author agent
+ * @struct AK_btree_page
+ * @brief Structure that defines the beginning of a node page. It is followed by the offsets of the entries (two
+ * bytes each), the prefix shared by all keys of the page and the entries. An entry is the length of the rest of its
+ * key (two bytes) and the rest of the key, followed by the address of a child in inner pages. In an inner page entry
+ * i leads to the keys from its key up to the key of entry i + 1, first to the keys below the key of entry 0.
+ */
+typedef struct {
+    /// number of entries
+    int count;
+    /// leaf: address of the next leaf, 0 for the last one; inner page: first child
+    int next;
+    /// leaf: address of the previous leaf, 0 for the first one
+    int prev;
+    /// length of the prefix shared by all keys of the page
+    int prefix;
+} AK_btree_page;
 
 /**
-  * @author Anđelko Spevec
-  * @brief Function that creates new btree index on integer attribute in table
+ * @author agent
+ * @struct AK_btree_cursor
+ * @brief Structure that defines a range scan of a B+tree index. The cursor reads RIDs from the tree in batches and
+ * finds its place again by the last key it read, so the index may change between calls.
+ */
+typedef struct {
+    /// index name
+    char index[MAX_ATT_NAME];
+    /// key the next batch starts from: the lower bound, later the last key read
+    unsigned char last[AK_BTREE_MAX_KEY];
+    /// length of last
+    int last_size;
+    /// 1 once a key was read, the next batch starts after last instead of at it
+    int started;
+    /// upper bound
+    unsigned char high[AK_BTREE_MAX_KEY];
+    /// length of high, -1 for a scan without upper bound
+    int high_size;
+    /// 1 when the tree has no more keys in the range
+    int end;
+    /// RIDs of the current batch
+    AK_rid rid[AK_BTREE_CURSOR_RIDS];
+    /// number of RIDs in the batch
+    int count;
+    /// next RID of the batch to return
+    int position;
+} AK_btree_cursor;
+
+/**
+  * @author Anđelko Spevec, updated by agent (B+tree pages)
+  * @brief Function that creates new B+tree index on attributes of a table. The rows of the table are sorted by key
+  * and the tree is built bottom up, one node per page of the index segment.
   * @param tblName - name of the table on which we are creating index
-  * @param attributes - attribute on which we are creating index
+  * @param attributes - attributes on which we are creating index, in the order of the key
+  * @param indexName - name of the index
+  * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+int AK_btree_create(char *tblName, struct list_node *attributes, char *indexName);
+
+/**
+  * @author unknown, updated by agent
+  * @brief Function that deletes index
   * @param indexName - name of the index
+  * @return EXIT_SUCCESS or EXIT_ERROR
  */
-AK_block * AK_btree_create(char *tblName, struct list_node *attributes, char *indexName);
 int AK_btree_delete(char *indexName);
 
-btree_node * makevalues(btree_node * temp_help, int insertValue, int insertTd, int insertBlock, int i);
-btree_node * searchValue(int inserted, int insertValue, btree_node * temp, btree_node * temp_help, int *insertTd, int *insertBlock,int* increase, int number);
-btree_node * setNodePointers(btree_node * temp, btree_node * temp_help,int pointerIndex,int secondValue,int firstPointer,int secondPointer);
-int findCorrectNumber(int number);
-btree_node * findPointers(btree_node * temp_node_one, btree_node * temp, int id, int* nodeInserted,int* nodeIncrease, int number, int pointerIndex);
-btree_node * findValues(btree_node * temp_node_one, AK_block * block, int* helpAddress,int* helpType, btree_node *value_help);
-void btree_delete(btree_node * temp, AK_block * block, int idNext, int i);
+/**
+ * @author agent
+ * @brief  Function that reads the first page of a B+tree index
+ * @param indexName name of the index
+ * @param meta receives the page
+ * @return EXIT_SUCCESS, EXIT_ERROR if there is no such B+tree index
+ */
+int AK_btree_get_meta(char *indexName, AK_btree_meta *meta);
+
+/**
+ * @author agent
+ * @brief  Function that inserts a key into a B+tree index, splitting full pages on the way back to the root
+ * @param indexName name of the index
+ * @param key values of the key attributes in the order of the key
+ * @param rid RID of the row
+ * @return EXIT_SUCCESS, EXIT_ERROR if the key can not be encoded or is already in the index
+ */
+int AK_btree_insert(char *indexName, struct list_node *key, AK_rid *rid);
 
+/**
+ * @author agent
+ * @brief  Function that deletes a key from a B+tree index. A page left less than a quarter full is merged with a
+ * neighbour or takes keys from it.
+ * @param indexName name of the index
+ * @param key values of the key attributes in the order of the key
+ * @param rid RID of the row
+ * @return EXIT_SUCCESS, EXIT_ERROR if the key is not in the index
+ */
+int AK_btree_delete_key(char *indexName, struct list_node *key, AK_rid *rid);
 
 /**
-  * @author Anđelko Spevec
-  * @brief Function that searches or deletes a value in btree index
-  * @param indexName - name of the index
-  * @param searchValue - value that we are searching in the index
-  * @param endRange - if 0 search is for 0 value, else searching in range
-  * @param toDo - if 0 we just search else we delete the element if we find it
+ * @author agent
+ * @brief  Function that opens a range scan of a B+tree index. The bounds are values of the first key attributes,
+ * fewer than all of them compare only those attributes; both bounds are included.
+ * @param indexName name of the index
+ * @param low lower bound, NULL for a scan from the first key
+ * @param high upper bound, NULL for a scan to the last key
+ * @return cursor, NULL if there is no such index or a bound can not be encoded
  */
-int AK_btree_search_delete(char *indexName,int *searchValue,int *endRange,int *toDo,AK_block * inputBlock);
-int AK_btree_insert(char *indexName,int *insertValue, int *insertTd, int *insertBlock,AK_block * inputBlock);
+AK_btree_cursor *AK_btree_open(char *indexName, struct list_node *low, struct list_node *high);
+
+/**
+ * @author agent
+ * @brief  Function that moves a range scan to the next key; keys come in ascending order
+ * @param cursor cursor, may be NULL
+ * @return RID of the row, owned by the cursor and valid until the next call; NULL after the last key
+ */
+AK_rid *AK_btree_next(AK_btree_cursor *cursor);
+
+/**
+ * @author agent
+ * @brief  Function that closes a range scan
+ * @param cursor cursor, may be NULL
+ */
+void AK_btree_close(AK_btree_cursor *cursor);
+
 TestResult AK_btree_test();
 
 #endif
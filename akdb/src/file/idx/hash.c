@@ -19,578 +19,975 @@
 
 
 #include "hash.h"
+#include "../../rel/iterator.h"
+#include <time.h>
+
+/// taken exclusively by functions that change a hash index and shared by lookups
+static pthread_rwlock_t AK_hash_lock = PTHREAD_RWLOCK_INITIALIZER;
+
+/// number of bytes of an entry before its key: hash, block and slot of the RID and length of the key
+#define AK_HASH_ENTRY (sizeof(unsigned long long) + 2 * sizeof(int) + sizeof(unsigned short))
+/// number of bytes of a bucket page available to entries
+#define AK_HASH_PAGE_DATA ((int) (AK_HASH_PAGE_SIZE - sizeof(AK_hash_page)))
+
+#define AK_HASH_PRIME1 0x9E3779B185EBCA87ULL
+#define AK_HASH_PRIME2 0xC2B2AE3D27D4EB4FULL
+#define AK_HASH_PRIME3 0x165667B19E3779F9ULL
+#define AK_HASH_PRIME4 0x85EBCA77C2B2AE63ULL
+#define AK_HASH_PRIME5 0x27D4EB2F165667C5ULL
 
 /**
-  * @author Mislav Čakarić
-  * @brief Function that computes a hash value from varchar or integer
-  * @param elem element of row for wich value is to be computed
-  * @return hash value
- 
+ * @author agent
+ * @struct AK_hash_index
+ * @brief Structure that defines an index being used: its name and its first page
  */
-int AK_elem_hash_value(struct list_node *elem) {
-    int type = elem->type, value = 0, i = 0;
-    char temp_char[MAX_VARCHAR_LENGTH];
-    AK_PRO;
+typedef struct {
+    /// index name
+    char *name;
+    /// address of the first page
+    int address;
+    /// first page
+    AK_hash_meta meta;
+} AK_hash_index;
+
+static unsigned long long AK_hash_rotate(unsigned long long value, int bits)
+{
+    return (value << bits) | (value >> (64 - bits));
+}
+
+static unsigned long long AK_hash_round(unsigned long long accumulator, unsigned long long input)
+{
+    accumulator += input * AK_HASH_PRIME2;
+    accumulator = AK_hash_rotate(accumulator, 31);
+    return accumulator * AK_HASH_PRIME1;
+}
+
+static unsigned long long AK_hash_merge(unsigned long long hash, unsigned long long lane)
+{
+    hash ^= AK_hash_round(0, lane);
+    return hash * AK_HASH_PRIME1 + AK_HASH_PRIME4;
+}
+
+static unsigned long long AK_hash_read64(const unsigned char *p)
+{
+    unsigned long long value = 0;
+    int i;
+    for (i = 7; i >= 0; i--)
+        value = (value << 8) | p[i];
+    return value;
+}
+
+static unsigned long long AK_hash_read32(const unsigned char *p)
+{
+    return (unsigned long long) p[0] | ((unsigned long long) p[1] << 8) | ((unsigned long long) p[2] << 16)
+           | ((unsigned long long) p[3] << 24);
+}
+
+/**
+ * @author agent
+ * @brief  Function that computes a 64-bit hash of bytes in the manner of xxHash64: 32 byte stripes go through four
+ * multiply and rotate lanes, the rest through the same rounds one word at a time, and the result is mixed so that
+ * every bit of the input and of the seed affects every bit of the hash
+ * @param data bytes
+ * @param size number of bytes
+ * @param seed seed, different seeds give unrelated hashes
+ * @return hash value
+ */
+unsigned long long AK_hash_value(const void *data, int size, unsigned long long seed)
+{
+    const unsigned char *p = (const unsigned char *) data, *end = p + size;
+    unsigned long long hash, lane[4];
+    int i;
+
+    if (size >= 32) {
+        lane[0] = seed + AK_HASH_PRIME1 + AK_HASH_PRIME2;
+        lane[1] = seed + AK_HASH_PRIME2;
+        lane[2] = seed;
+        lane[3] = seed - AK_HASH_PRIME1;
+        for (; p + 32 <= end; p += 32)
+            for (i = 0; i < 4; i++)
+                lane[i] = AK_hash_round(lane[i], AK_hash_read64(p + 8 * i));
+        hash = AK_hash_rotate(lane[0], 1) + AK_hash_rotate(lane[1], 7) + AK_hash_rotate(lane[2], 12) + AK_hash_rotate(lane[3], 18);
+        for (i = 0; i < 4; i++)
+            hash = AK_hash_merge(hash, lane[i]);
+    } else
+        hash = seed + AK_HASH_PRIME5;
+    hash += (unsigned long long) size;
+    for (; p + 8 <= end; p += 8) {
+        hash ^= AK_hash_round(0, AK_hash_read64(p));
+        hash = AK_hash_rotate(hash, 27) * AK_HASH_PRIME1 + AK_HASH_PRIME4;
+    }
+    if (p + 4 <= end) {
+        hash ^= AK_hash_read32(p) * AK_HASH_PRIME1;
+        hash = AK_hash_rotate(hash, 23) * AK_HASH_PRIME2 + AK_HASH_PRIME3;
+        p += 4;
+    }
+    for (; p < end; p++) {
+        hash ^= *p * AK_HASH_PRIME5;
+        hash = AK_hash_rotate(hash, 11) * AK_HASH_PRIME1;
+    }
+    hash ^= hash >> 33;
+    hash *= AK_HASH_PRIME2;
+    hash ^= hash >> 29;
+    hash *= AK_HASH_PRIME3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+/**
+ * @author agent
+ * @brief  Function that checks whether a hash index can have a key attribute of a type
+ * @param type attribute type
+ * @return 1 if it can, 0 otherwise
+ */
+static int AK_hash_supported(int type)
+{
     switch (type) {
         case TYPE_INT:
-            memcpy(&value, elem->data, elem->size);
+        case TYPE_DATE:
+        case TYPE_DATETIME:
+        case TYPE_TIME:
+        case TYPE_INTERVAL:
+        case TYPE_PERIOD:
+        case TYPE_FLOAT:
+        case TYPE_NUMBER:
+        case TYPE_BOOL:
+        case TYPE_VARCHAR:
+            return 1;
+    }
+    return 0;
+}
+
+/**
+ * @author agent
+ * @brief  Function that appends a value to a key so that equal values give equal bytes. A tag byte tells NULL (stored
+ * as the varchar "null") from values. Floating point numbers are written as doubles with -0.0 turned into 0.0 and a
+ * varchar is preceded by its length, so the values of a composite key stay apart.
+ * @param type type of the key attribute
+ * @param value_type type of the value
+ * @param value bytes of the value
+ * @param size number of bytes of the value
+ * @param key key
+ * @param at number of bytes of the key before the value
+ * @return number of bytes of the key with the value, EXIT_ERROR if the value has another type or the key is too long
+ */
+static int AK_hash_encode_value(int type, int value_type, const unsigned char *value, int size, unsigned char *key, int at)
+{
+    unsigned short length;
+    double number;
+    float real;
+
+    if (at + 1 + (int) sizeof(double) > AK_HASH_MAX_KEY)
+        return EXIT_ERROR;
+    if (value_type == TYPE_VARCHAR && type != TYPE_VARCHAR && size == 4 && memcmp(value, "null", 4) == 0) {
+        key[at++] = 0;
+        return at;
+    }
+    key[at++] = 1;
+    switch (type) {
+        case TYPE_INT:
+        case TYPE_DATE:
+        case TYPE_DATETIME:
+        case TYPE_TIME:
+        case TYPE_INTERVAL:
+        case TYPE_PERIOD:
+            if (value_type == TYPE_VARCHAR || value_type == TYPE_FLOAT || value_type == TYPE_NUMBER || value_type == TYPE_BOOL || size != sizeof(int))
+                return EXIT_ERROR;
+            memcpy(key + at, value, sizeof(int));
+            at += sizeof(int);
+            break;
+        case TYPE_FLOAT:
+        case TYPE_NUMBER:
+            if (value_type != TYPE_FLOAT && value_type != TYPE_NUMBER)
+                return EXIT_ERROR;
+            if (size == sizeof(float)) {
+                memcpy(&real, value, sizeof(float));
+                number = real;
+            } else if (size == sizeof(double))
+                memcpy(&number, value, sizeof(double));
+            else
+                return EXIT_ERROR;
+            if (number == 0)
+                number = 0;
+            memcpy(key + at, &number, sizeof(double));
+            at += sizeof(double);
+            break;
+        case TYPE_BOOL:
+            if (value_type != TYPE_BOOL || size != 1)
+                return EXIT_ERROR;
+            key[at++] = value[0];
             break;
         case TYPE_VARCHAR:
-            memcpy(temp_char, elem->data, elem->size);
-            temp_char[ elem->size ] = '\0';
-            do {
-                value += (int) temp_char[i++];
-            } while (temp_char[i]);
+            if (value_type != TYPE_VARCHAR || at + (int) sizeof(unsigned short) + size > AK_HASH_MAX_KEY)
+                return EXIT_ERROR;
+            length = size;
+            memcpy(key + at, &length, sizeof(unsigned short));
+            at += sizeof(unsigned short);
+            memcpy(key + at, value, size);
+            at += size;
             break;
+        default:
+            return EXIT_ERROR;
     }
-    AK_EPI;
-    return value;
+    return at;
 }
 
 /**
-  * @author Mislav Čakarić
-  * @brief Function that inserts a bucket to block
-  * @param indexName name of index
-  * @param data content of bucket stored in char array
-  * @param type type of bucket (MAIN_BUCKET or HASH_BUCKET)
-  * @return address structure with data where the bucket is stored 
+ * @author agent
+ * @brief  Function that encodes values of all key attributes, see AK_hash_encode_value
+ * @param meta first page of the index
+ * @param values values in the order of the key
+ * @param key receives the key, AK_HASH_MAX_KEY bytes
+ * @return number of bytes of the key, EXIT_ERROR if it can not be encoded
  */
-struct_add* AK_insert_bucket_to_block(char *indexName, char *data, int type) {
-    int size, id;
-    AK_PRO;
-    struct_add *add = (struct_add*) AK_malloc(sizeof (struct_add));
-    add->addBlock = 0;
-    add->indexTd = 0;
+static int AK_hash_encode_key(AK_hash_meta *meta, struct list_node *values, unsigned char *key)
+{
+    struct list_node *value = values == NULL ? NULL : (struct list_node *) AK_First_L2(values);
+    int i, at = 0;
+    for (i = 0; i < meta->attributes && value != NULL; i++, value = (struct list_node *) AK_Next_L2(value)) {
+        at = AK_hash_encode_value(meta->type[i], value->type, (unsigned char *) value->data, value->size, key, at);
+        if (at == EXIT_ERROR)
+            return EXIT_ERROR;
+    }
+    return i < meta->attributes ? EXIT_ERROR : at;
+}
 
-    int adr_to_write = (int) AK_find_AK_free_space(AK_get_index_addresses(indexName));
-    if (adr_to_write == -1)
-        adr_to_write = (int) AK_init_new_extent(indexName, SEGMENT_TYPE_INDEX);
-    if (adr_to_write == 0){
-	AK_EPI;
-        return add;
+/**
+ * @author agent
+ * @brief  Function that encodes the key of a row of the indexed table
+ * @param meta first page of the index
+ * @param block block of the row
+ * @param rid RID of the row
+ * @param num_attr number of attributes of the table
+ * @param key receives the key, AK_HASH_MAX_KEY bytes
+ * @return number of bytes of the key, EXIT_ERROR if it can not be encoded
+ */
+static int AK_hash_encode_slot(AK_hash_meta *meta, AK_block *block, AK_rid *rid, int num_attr, unsigned char *key)
+{
+    AK_tuple_dict *entry;
+    int i, at = 0;
+    for (i = 0; i < meta->attributes; i++) {
+        entry = &block->tuple_dict[rid->slot * num_attr + meta->position[i]];
+        at = AK_hash_encode_value(meta->type[i], entry->type, block->data + entry->address, entry->size, key, at);
+        if (at == EXIT_ERROR)
+            return EXIT_ERROR;
     }
+    return at;
+}
 
-    AK_block *block = (AK_block*) AK_read_block(adr_to_write);
+/**
+ * @author agent
+ * @brief  Function that writes an entry of a bucket
+ * @param entry receives the entry, AK_HASH_ENTRY + size bytes
+ * @param hash hash of the key
+ * @param rid RID of the row
+ * @param key key
+ * @param size number of bytes of the key
+ * @return number of bytes of the entry
+ */
+static int AK_hash_make_entry(unsigned char *entry, unsigned long long hash, AK_rid *rid, const unsigned char *key, int size)
+{
+    unsigned short length = size;
+    memcpy(entry, &hash, sizeof(unsigned long long));
+    memcpy(entry + sizeof(unsigned long long), &rid->block, sizeof(int));
+    memcpy(entry + sizeof(unsigned long long) + sizeof(int), &rid->slot, sizeof(int));
+    memcpy(entry + AK_HASH_ENTRY - sizeof(unsigned short), &length, sizeof(unsigned short));
+    memcpy(entry + AK_HASH_ENTRY, key, size);
+    return AK_HASH_ENTRY + size;
+}
 
-    AK_dbg_messg(HIGH, INDICES, "insert_bucket_to_block: Position to write (tuple_dict_index) %d\n", adr_to_write);
+static int AK_hash_entry_size(const unsigned char *entry)
+{
+    unsigned short length;
+    memcpy(&length, entry + AK_HASH_ENTRY - sizeof(unsigned short), sizeof(unsigned short));
+    return AK_HASH_ENTRY + length;
+}
 
-    switch (type) {
-        case MAIN_BUCKET:
-            size = sizeof (main_bucket);
-            break;
-        case HASH_BUCKET:
-            size = sizeof (hash_bucket);
+static unsigned long long AK_hash_entry_hash(const unsigned char *entry)
+{
+    unsigned long long hash;
+    memcpy(&hash, entry, sizeof(unsigned long long));
+    return hash;
+}
+
+static void AK_hash_entry_rid(const unsigned char *entry, AK_rid *rid)
+{
+    memcpy(&rid->block, entry + sizeof(unsigned long long), sizeof(int));
+    memcpy(&rid->slot, entry + sizeof(unsigned long long) + sizeof(int), sizeof(int));
+}
+
+/**
+ * @author agent
+ * @brief  Function that compares an entry with a key
+ * @param entry entry of a bucket
+ * @param search entry made of the key, see AK_hash_make_entry
+ * @param rid 1 if the RIDs have to be equal too
+ * @return 1 if they are equal, 0 otherwise
+ */
+static int AK_hash_entry_equal(const unsigned char *entry, const unsigned char *search, int rid)
+{
+    int size = AK_hash_entry_size(search);
+    if (AK_hash_entry_size(entry) != size || memcmp(entry, search, sizeof(unsigned long long)) != 0)
+        return 0;
+    if (rid && memcmp(entry + sizeof(unsigned long long), search + sizeof(unsigned long long), 2 * sizeof(int)) != 0)
+        return 0;
+    return memcmp(entry + AK_HASH_ENTRY, search + AK_HASH_ENTRY, size - AK_HASH_ENTRY) == 0;
+}
+
+/**
+ * @author agent
+ * @brief  Function that reads the first page of an index
+ * @param indexName index name
+ * @param index receives the address and the content of the first page
+ * @return EXIT_SUCCESS, EXIT_ERROR if there is no such hash index
+ */
+static int AK_hash_open_index(char *indexName, AK_hash_index *index)
+{
+    table_addresses *addresses = (table_addresses *) AK_get_index_addresses(indexName);
+    AK_block *block;
+
+    index->name = indexName;
+    index->address = addresses->address_from[0];
+    AK_free(addresses);
+    if (index->address == 0)
+        return EXIT_ERROR;
+    block = ((AK_mem_block *) AK_get_block(index->address))->block;
+    if (block->tuple_dict[0].type != HASH_META_PAGE)
+        return EXIT_ERROR;
+    memcpy(&index->meta, block->data, sizeof(AK_hash_meta));
+    return EXIT_SUCCESS;
+}
+
+static void AK_hash_write_meta(AK_hash_index *index)
+{
+    AK_mem_block *mem_block = (AK_mem_block *) AK_get_block(index->address);
+    memcpy(mem_block->block->data, &index->meta, sizeof(AK_hash_meta));
+    mem_block->block->tuple_dict[0].type = HASH_META_PAGE;
+    mem_block->block->tuple_dict[0].address = 0;
+    mem_block->block->tuple_dict[0].size = sizeof(AK_hash_meta);
+    mem_block->block->AK_free_space = sizeof(AK_hash_meta);
+    mem_block->block->last_tuple_dict_id = 0;
+    AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+}
+
+/**
+ * @author agent
+ * @brief  Function that writes a page of a bucket
+ * @param address address of the page
+ * @param page beginning of the page
+ * @param entries entries of the page, page->used bytes
+ */
+static void AK_hash_write_page(int address, AK_hash_page *page, const unsigned char *entries)
+{
+    AK_mem_block *mem_block = (AK_mem_block *) AK_get_block(address);
+    AK_block *block = mem_block->block;
+    memcpy(block->data, page, sizeof(AK_hash_page));
+    if (page->used > 0)
+        memmove(block->data + sizeof(AK_hash_page), entries, page->used);
+    block->tuple_dict[0].type = HASH_BUCKET_PAGE;
+    block->tuple_dict[0].address = 0;
+    block->tuple_dict[0].size = sizeof(AK_hash_page) + page->used;
+    block->AK_free_space = sizeof(AK_hash_page) + page->used;
+    block->last_tuple_dict_id = 0;
+    AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+}
+
+/**
+ * @author agent
+ * @brief  Function that takes a page: a freed page if there is one, otherwise the page after the last page taken from
+ * the extents of the index. A new extent is added when they are used up.
+ * @param index index
+ * @return address of the page, EXIT_ERROR if no extent can be added
+ */
+static int AK_hash_alloc_page(AK_hash_index *index)
+{
+    table_addresses *addresses;
+    int i, address = 0;
+
+    if (index->meta.free_page != 0) {
+        address = index->meta.free_page;
+        index->meta.free_page = ((AK_hash_page *) ((AK_mem_block *) AK_get_block(address))->block->data)->next;
+        index->meta.pages++;
+        return address;
+    }
+    addresses = (table_addresses *) AK_get_index_addresses(index->name);
+    for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0; i++) {
+        if (index->meta.last_page >= addresses->address_from[i] && index->meta.last_page < addresses->address_to[i]) {
+            if (index->meta.last_page + 1 < addresses->address_to[i])
+                address = index->meta.last_page + 1;
+            else if (i + 1 < MAX_EXTENTS_IN_SEGMENT)
+                address = addresses->address_from[i + 1];
             break;
+        }
     }
-    id = block->last_tuple_dict_id + 1;
-    memcpy(&block->data[block->AK_free_space], data, size);
-    block->tuple_dict[id].address = block->AK_free_space;
-    block->AK_free_space += size;
-    block->tuple_dict[id].type = type;
-    block->tuple_dict[id].size = size;
-    block->last_tuple_dict_id = id;
-    AK_write_block(block);
-
-    add->addBlock = adr_to_write;
-    add->indexTd = id;
-    AK_EPI;
-    return add;
+    AK_free(addresses);
+    if (address == 0)
+        address = AK_init_new_extent(index->name, SEGMENT_TYPE_INDEX);
+    if (address == EXIT_ERROR || address == 0) {
+        printf("AK_hash_alloc_page: index %s can not grow!\n", index->name);
+        return EXIT_ERROR;
+    }
+    index->meta.last_page = address;
+    index->meta.pages++;
+    return address;
+}
+
+static void AK_hash_free_page(AK_hash_index *index, int address)
+{
+    AK_mem_block *mem_block = (AK_mem_block *) AK_get_block(address);
+    AK_hash_page page;
+
+    memset(&page, 0, sizeof(AK_hash_page));
+    page.next = index->meta.free_page;
+    memcpy(mem_block->block->data, &page, sizeof(AK_hash_page));
+    mem_block->block->tuple_dict[0].type = HASH_FREE_PAGE;
+    mem_block->block->tuple_dict[0].size = sizeof(AK_hash_page);
+    AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+    index->meta.free_page = address;
+    index->meta.pages--;
 }
 
 /**
-  *  @author Mislav Čakarić
-  *  @brief Function that updates a bucket in block
-  *  @param add address of where the bucket is stored
-  *  @param data content of bucket stored in char array
-  *  @return No return value
+ * @author agent
+ * @brief  Function that computes the bucket of a hash, see AK_hash_meta
+ * @param meta first page of the index
+ * @param hash hash of a key
+ * @return bucket number
  */
-void AK_update_bucket_in_block(struct_add *add, char *data) {
-    AK_PRO;
-    AK_block *block = (AK_block*) AK_read_block(add->addBlock);
-    int address = block->tuple_dict[add->indexTd].address;
-    int size = block->tuple_dict[add->indexTd].size;
-    memcpy(&block->data[address], data, size);
-    AK_write_block(block);
-    AK_EPI;
+static int AK_hash_bucket(AK_hash_meta *meta, unsigned long long hash)
+{
+    unsigned long long bucket = hash & (unsigned long long) (meta->round - 1);
+    if (bucket < (unsigned long long) meta->split)
+        bucket = hash & (unsigned long long) (2 * meta->round - 1);
+    return (int) bucket;
 }
 
 /**
-  * @author Mislav Čakarić
-  * @brief Function that changes a info of hash index
-  * @param indexName name of index
-  * @param modulo value for modulo hash function
-  * @param main_bucket_num number of main buckets
-  * @param hash_bucket_num number of hash buckets
-  * @return No return value
+ * @author agent
+ * @brief  Function that reads the address of the first page of a bucket from the directory
+ * @param index index
+ * @param bucket bucket number
+ * @return address of the page
  */
-void AK_change_hash_info(char *indexName, int modulo, int main_bucket_num, int hash_bucket_num) {
-    AK_PRO;
-    table_addresses *hash_addresses = (table_addresses*) AK_get_index_addresses(indexName);
-    int block_add = hash_addresses->address_from[ 0 ];
-    if (block_add == 0) {
-        printf("Hash index does not exist!\n");
-    }
-    AK_block *block = (AK_block*) AK_read_block(block_add);
-    hash_info *info = (hash_info*) AK_malloc(sizeof (hash_info));
-    info->modulo = modulo;
-    info->main_bucket_num = main_bucket_num;
-    info->hash_bucket_num = hash_bucket_num;
-
-    memcpy(block->data, info, sizeof (hash_info));
-    block->tuple_dict[0].address = 0;
-    block->tuple_dict[0].type = INFO_BUCKET;
-    block->tuple_dict[0].size = sizeof (hash_info);
-    AK_write_block(block);
-    AK_EPI;
+static int AK_hash_bucket_page(AK_hash_index *index, int bucket)
+{
+    AK_block *block = ((AK_mem_block *) AK_get_block(index->meta.directory[bucket / AK_HASH_DIRECTORY_SIZE]))->block;
+    int address;
+    memcpy(&address, block->data + (bucket % AK_HASH_DIRECTORY_SIZE) * sizeof(int), sizeof(int));
+    return address;
 }
 
 /**
-  * @author Mislav Čakarić
-  * @brief Function that fetches the info for hash index
-  * @param indexName name of index
-  * @return info bucket with info data for hash index
+ * @author agent
+ * @brief  Function that adds a bucket with an empty page to the directory, taking a new directory page if needed
+ * @param index index
+ * @param bucket bucket number
+ * @return EXIT_SUCCESS, EXIT_ERROR if the index can not grow
  */
-hash_info* AK_get_hash_info(char *indexName) {
-    AK_PRO;
-    table_addresses *hash_addresses = (table_addresses*) AK_get_index_addresses(indexName);
-    int block_add = hash_addresses->address_from[ 0 ];
-    hash_info *info = (hash_info*) AK_malloc(sizeof (hash_info));
-    memset(info, 0, sizeof (hash_info));
-    if (block_add == 0) {
-        printf("Hash index does not exist!\n");
-	AK_EPI;
-        return info;
-    }
-    AK_block *block = (AK_block*) AK_read_block(block_add);
-    memcpy(info, block->data, sizeof (hash_info));
-    AK_EPI;
-    return info;
+static int AK_hash_add_bucket(AK_hash_index *index, int bucket)
+{
+    AK_mem_block *mem_block;
+    AK_hash_page page;
+    int d = bucket / AK_HASH_DIRECTORY_SIZE, address;
+
+    if (d >= AK_HASH_MAX_DIRECTORY)
+        return EXIT_ERROR;
+    if (index->meta.directory[d] == 0) {
+        if ((address = AK_hash_alloc_page(index)) == EXIT_ERROR)
+            return EXIT_ERROR;
+        mem_block = (AK_mem_block *) AK_get_block(address);
+        memset(mem_block->block->data, 0, AK_HASH_PAGE_SIZE);
+        mem_block->block->tuple_dict[0].type = HASH_DIRECTORY_PAGE;
+        mem_block->block->tuple_dict[0].address = 0;
+        mem_block->block->tuple_dict[0].size = AK_HASH_PAGE_SIZE;
+        mem_block->block->AK_free_space = AK_HASH_PAGE_SIZE;
+        mem_block->block->last_tuple_dict_id = 0;
+        AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+        index->meta.directory[d] = address;
+    }
+    if ((address = AK_hash_alloc_page(index)) == EXIT_ERROR)
+        return EXIT_ERROR;
+    memset(&page, 0, sizeof(AK_hash_page));
+    AK_hash_write_page(address, &page, NULL);
+    mem_block = (AK_mem_block *) AK_get_block(index->meta.directory[d]);
+    memcpy(mem_block->block->data + (bucket % AK_HASH_DIRECTORY_SIZE) * sizeof(int), &address, sizeof(int));
+    AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+    return EXIT_SUCCESS;
 }
 
 /**
-  * @author Mislav Čakarić
-  * @brief Function that fetches nth main bucket
-  * @param indexName name of index
-  * @param n number of main bucket
-  * @return address structure with data where the bucket is stored
+ * @author agent
+ * @brief  Function that writes entries to the pages of a bucket. The pages are filled in order, pages are added when
+ * they are used up and pages left over are freed.
+ * @param index index
+ * @param pages pages of the bucket, the first one first
+ * @param count number of pages, at least one
+ * @param entries entries
+ * @param size number of bytes of the entries
+ * @return EXIT_SUCCESS, EXIT_ERROR if the index can not grow
  */
-struct_add* AK_get_nth_main_bucket_add(char *indexName, int n) {
-    int i = 0, j = 0, k = 0, counter = 0, end = 0;
-    AK_PRO;
-    struct_add *add = (struct_add*) AK_malloc(sizeof (struct_add));
-    add->addBlock = 301;
-    add->indexTd = 2;
-    table_addresses *addresses = (table_addresses*) AK_get_index_addresses(indexName);
-    while (addresses->address_from[i]) {
-        for (j = addresses->address_from[i]; j < addresses->address_to[i]; j++) {
-            AK_block *temp = (AK_block*) AK_read_block(j);
-            for (k = 0; k < DATA_BLOCK_SIZE; k++) {
-                if (temp->tuple_dict[k].type == FREE_INT)
-                    break;
-                if (temp->tuple_dict[k].type == MAIN_BUCKET) {
-                    if (n == counter) {
-                        add->addBlock = j;
-                        add->indexTd = k;
-                        end = 1;
-                        break;
-                    }
-                    counter++;
-                }
-            }
-            if (end) break;
+static int AK_hash_write_bucket(AK_hash_index *index, int *pages, int count, unsigned char *entries, int size)
+{
+    AK_hash_page page;
+    int i = 0, at = 0, address = pages[0], entry;
+
+    for (;;) {
+        memset(&page, 0, sizeof(AK_hash_page));
+        while (at + page.used < size && page.used + (entry = AK_hash_entry_size(entries + at + page.used)) <= AK_HASH_PAGE_DATA) {
+            page.used += entry;
+            page.count++;
         }
+        if (at + page.used < size) {
+            page.next = i + 1 < count ? pages[i + 1] : AK_hash_alloc_page(index);
+            if (page.next == EXIT_ERROR)
+                return EXIT_ERROR;
+        }
+        AK_hash_write_page(address, &page, entries + at);
+        at += page.used;
         i++;
+        if (page.next == 0)
+            break;
+        address = page.next;
     }
-    AK_EPI;
-    return add;
-    AK_free(add);
+    for (; i < count; i++)
+        AK_hash_free_page(index, pages[i]);
+    return EXIT_SUCCESS;
 }
 
 /**
-  *  @author Mislav Čakarić
-  *  @brief Function that inserts a record in hash bucket
-  *  @param indexName name of index
-  *  @param hashValue hash value of record that is being inserted
-  *  @param add address structure with data where the hash bucket is stored
-  *  @return No return value
+ * @author agent
+ * @brief  Function that splits bucket split of the index: its entries whose hash has the next bit set move to the new
+ * bucket round + split
+ * @param index index
+ * @return EXIT_SUCCESS, EXIT_ERROR if the index can not grow
  */
-void AK_insert_in_hash_index(char *indexName, int hashValue, struct_add *add) {
-    int i, address, size, hash_AK_free_space = 0;
-    AK_PRO;
-    struct_add *main_add = (struct_add*) AK_malloc(sizeof (struct_add));
-    struct_add *hash_add = (struct_add*) AK_malloc(sizeof (struct_add));
-    main_bucket *temp_main_bucket = (main_bucket*) AK_malloc(sizeof (main_bucket));
-    hash_bucket *temp_hash_bucket = (hash_bucket*) AK_malloc(sizeof (hash_bucket));
-
-    table_addresses *addresses = (table_addresses*) AK_get_index_addresses(indexName);
-    if (addresses->address_from[0] == 0)
-        printf("Hash index does not exist!\n");
-    else {
-        char data[255];
-        memset(data, 0, 255);
-        hash_info *info = (hash_info*) AK_malloc(sizeof (hash_info));
-        info = AK_get_hash_info(indexName);
-        if (info->main_bucket_num == 0) {
-            for (i = 0; i < MAIN_BUCKET_SIZE; i++) {
-                temp_main_bucket->element[i].value = i;
-                memset(&temp_main_bucket->element[i].add, 0, sizeof (struct_add));
-            }
-            memcpy(&data, temp_main_bucket, sizeof (main_bucket));
-            main_add = AK_insert_bucket_to_block(indexName, data, MAIN_BUCKET);
+static int AK_hash_split(AK_hash_index *index)
+{
+    AK_block *block;
+    AK_hash_page *page;
+    unsigned char *stay = NULL, *move = NULL, *entry;
+    int *pages = NULL;
+    int from = index->meta.split, to = index->meta.round + index->meta.split;
+    int count = 0, capacity = 0, stay_size = 0, move_size = 0, room = 0, address, i, size, result;
 
-            temp_hash_bucket->bucket_level = MAIN_BUCKET_SIZE;
-            for (i = 0; i < HASH_BUCKET_SIZE; i++) {
-                temp_hash_bucket->element[i].value = -1;
-            }
-            memcpy(&data, temp_hash_bucket, sizeof (hash_bucket));
-            for (i = 0; i < MAIN_BUCKET_SIZE; i++) {
-                hash_add = AK_insert_bucket_to_block(indexName, data, HASH_BUCKET);
-
-                memcpy(&temp_main_bucket->element[i].add, hash_add, sizeof (struct_add));
-            }
-            memcpy(&data, temp_main_bucket, sizeof (main_bucket));
-            AK_update_bucket_in_block(main_add, data);
-            AK_change_hash_info(indexName, MAIN_BUCKET_SIZE, 1, MAIN_BUCKET_SIZE);
+    if (to >= AK_HASH_MAX_DIRECTORY * AK_HASH_DIRECTORY_SIZE || AK_hash_add_bucket(index, to) == EXIT_ERROR)
+        return EXIT_ERROR;
+    for (address = AK_hash_bucket_page(index, from); address != 0; address = page->next) {
+        block = ((AK_mem_block *) AK_get_block(address))->block;
+        page = (AK_hash_page *) block->data;
+        if (count == capacity) {
+            capacity = capacity == 0 ? 4 : 2 * capacity;
+            pages = (int *) AK_realloc(pages, capacity * sizeof(int));
         }
-        int hash_bucket_id = hashValue % info->modulo;
-        int main_bucket_id = (int) (hash_bucket_id / MAIN_BUCKET_SIZE);
-
-        main_add = AK_get_nth_main_bucket_add(indexName, main_bucket_id);
-
-        AK_block *temp_block = (AK_block*) AK_read_block(main_add->addBlock);
-        address = temp_block->tuple_dict[main_add->indexTd].address;
-        size = temp_block->tuple_dict[main_add->indexTd].size;
-        memcpy(temp_main_bucket, &temp_block->data[address], size);
-
-        memcpy(hash_add, &temp_main_bucket->element[hash_bucket_id % MAIN_BUCKET_SIZE].add, sizeof (struct_add));
-
-
-        temp_block = (AK_block*) AK_read_block(hash_add->addBlock);
-        address = temp_block->tuple_dict[hash_add->indexTd].address;
-        size = temp_block->tuple_dict[hash_add->indexTd].size;
-        memcpy(temp_hash_bucket, &temp_block->data[address], size);
-        for (i = 0; i < HASH_BUCKET_SIZE; i++) {
-            if (temp_hash_bucket->element[i].value == -1) {
-                hash_AK_free_space = 1;
-                temp_hash_bucket->element[i].value = hashValue;
-                memcpy(&temp_hash_bucket->element[i].add, add, sizeof (struct_add));
-                memcpy(&data, temp_hash_bucket, sizeof (hash_bucket));
-                AK_update_bucket_in_block(hash_add, data);
-                break;
-            }
+        pages[count++] = address;
+        if (stay_size + move_size + page->used > room) {
+            room = 2 * (stay_size + move_size + page->used);
+            stay = (unsigned char *) AK_realloc(stay, room);
+            move = (unsigned char *) AK_realloc(move, room);
         }
-        if (hash_AK_free_space == 0) {
-
-            if (temp_hash_bucket->bucket_level == info->modulo) {
-                //adding new main buckets
-                for (i = 0; i < info->main_bucket_num; i++) {
-                    main_add = AK_get_nth_main_bucket_add(indexName, i);
-                    AK_block *temp_block = (AK_block*) AK_read_block(main_add->addBlock);
-                    address = temp_block->tuple_dict[main_add->indexTd].address;
-                    size = temp_block->tuple_dict[main_add->indexTd].size;
-                    memcpy(data, &temp_block->data[address], size);
-                    AK_insert_bucket_to_block(indexName, data, MAIN_BUCKET);
-                }
-                AK_change_hash_info(indexName, info->modulo * 2, info->main_bucket_num * 2, info->hash_bucket_num);
-                info = AK_get_hash_info(indexName);
-            }
-            int hash_bucket_id2 = (hash_bucket_id + info->modulo / 2) % info->modulo;
-            int main_bucket_id2 = (int) (hash_bucket_id2 / MAIN_BUCKET_SIZE);
-
-            //swapping hash bucket id's
-            if (hash_bucket_id2 < hash_bucket_id) {
-                int temp = hash_bucket_id;
-                hash_bucket_id = hash_bucket_id2;
-                hash_bucket_id2 = temp;
-                temp = main_bucket_id;
-                main_bucket_id = main_bucket_id2;
-                main_bucket_id2 = temp;
+        entry = block->data + sizeof(AK_hash_page);
+        for (i = 0; i < page->count; i++, entry += size) {
+            size = AK_hash_entry_size(entry);
+            if (AK_hash_entry_hash(entry) & (unsigned long long) index->meta.round) {
+                memcpy(move + move_size, entry, size);
+                move_size += size;
+            } else {
+                memcpy(stay + stay_size, entry, size);
+                stay_size += size;
             }
+        }
+    }
+    result = AK_hash_write_bucket(index, pages, count, stay, stay_size);
+    address = AK_hash_bucket_page(index, to);
+    if (result == EXIT_SUCCESS)
+        result = AK_hash_write_bucket(index, &address, 1, move, move_size);
+    AK_free(pages);
+    AK_free(stay);
+    AK_free(move);
+    if (result == EXIT_SUCCESS) {
+        index->meta.buckets++;
+        if (++index->meta.split == index->meta.round) {
+            index->meta.round *= 2;
+            index->meta.split = 0;
+        }
+    }
+    return result;
+}
 
-            hash_bucket *temp_hash_bucket2 = (hash_bucket*) AK_malloc(sizeof (hash_bucket));
-            temp_hash_bucket2->bucket_level = temp_hash_bucket->bucket_level * 2;
-            for (i = 0; i < HASH_BUCKET_SIZE; i++) {
-                temp_hash_bucket2->element[i].value = -1;
-                memset(&temp_hash_bucket2->element[i].add, 0, sizeof (struct_add));
-            }
-            memcpy(data, temp_hash_bucket2, sizeof (hash_bucket));
-            AK_update_bucket_in_block(hash_add, data);
-
-            main_add = AK_get_nth_main_bucket_add(indexName, main_bucket_id2);
-            temp_block = (AK_block*) AK_read_block(main_add->addBlock);
-            address = temp_block->tuple_dict[main_add->indexTd].address;
-            size = temp_block->tuple_dict[main_add->indexTd].size;
-            memcpy(temp_main_bucket, &temp_block->data[address], size);
-
-            hash_add = AK_insert_bucket_to_block(indexName, data, HASH_BUCKET);
-            memcpy(&temp_main_bucket->element[hash_bucket_id2 % MAIN_BUCKET_SIZE].add, hash_add, sizeof (struct_add));
-            memcpy(data, temp_main_bucket, sizeof (main_bucket));
-            AK_update_bucket_in_block(main_add, data);
-
-            AK_change_hash_info(indexName, info->modulo, info->main_bucket_num, info->hash_bucket_num + 1);
-            for (i = 0; i < HASH_BUCKET_SIZE; i++) {
-                int value = temp_hash_bucket->element[i].value;
-                memcpy(main_add, &temp_hash_bucket->element[i].add, sizeof (struct_add));
-                AK_insert_in_hash_index(indexName, value, main_add);
+/**
+ * @author agent
+ * @brief  Function that adds an entry to its bucket, on the first page with room for it or on a new overflow page,
+ * and splits the next bucket if the index got too full
+ * @param index index
+ * @param key encoded key
+ * @param size number of bytes of the key
+ * @param rid RID of the row
+ * @return EXIT_SUCCESS, EXIT_ERROR if the entry is already in the index or the index can not grow
+ */
+static int AK_hash_add(AK_hash_index *index, const unsigned char *key, int size, AK_rid *rid)
+{
+    AK_block *block;
+    AK_hash_page *page, empty;
+    AK_mem_block *mem_block;
+    unsigned char entry[AK_HASH_ENTRY + AK_HASH_MAX_KEY], *at;
+    unsigned long long hash = AK_hash_value(key, size, index->meta.seed);
+    int entry_size = AK_hash_make_entry(entry, hash, rid, key, size);
+    int address, last = 0, room = 0, i;
+
+    for (address = AK_hash_bucket_page(index, AK_hash_bucket(&index->meta, hash)); address != 0; address = page->next) {
+        block = ((AK_mem_block *) AK_get_block(address))->block;
+        page = (AK_hash_page *) block->data;
+        at = block->data + sizeof(AK_hash_page);
+        for (i = 0; i < page->count; i++, at += AK_hash_entry_size(at))
+            if (AK_hash_entry_equal(at, entry, 1)) {
+                printf("Key of row %d in block %d is already in index %s!\n", rid->slot, rid->block, index->name);
+                return EXIT_ERROR;
             }
-            AK_insert_in_hash_index(indexName, hashValue, add);
-        }
+        if (room == 0 && page->used + entry_size <= AK_HASH_PAGE_DATA)
+            room = address;
+        last = address;
     }
-    AK_EPI;
+    if (room == 0) {
+        if ((room = AK_hash_alloc_page(index)) == EXIT_ERROR)
+            return EXIT_ERROR;
+        mem_block = (AK_mem_block *) AK_get_block(last);
+        ((AK_hash_page *) mem_block->block->data)->next = room;
+        AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+        memset(&empty, 0, sizeof(AK_hash_page));
+        AK_hash_write_page(room, &empty, NULL);
+    }
+    mem_block = (AK_mem_block *) AK_get_block(room);
+    page = (AK_hash_page *) mem_block->block->data;
+    memcpy(mem_block->block->data + sizeof(AK_hash_page) + page->used, entry, entry_size);
+    page->used += entry_size;
+    page->count++;
+    mem_block->block->tuple_dict[0].size = mem_block->block->AK_free_space = sizeof(AK_hash_page) + page->used;
+    AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+    index->meta.entries++;
+    index->meta.bytes += entry_size;
+
+    //one split per insert keeps the work of every insert small
+    if (index->meta.bytes * 100 > (long long) index->meta.buckets * AK_HASH_PAGE_DATA * AK_HASH_FILL
+        && AK_hash_split(index) == EXIT_ERROR)
+        AK_dbg_messg(HIGH, INDICES, "AK_hash_add: index %s can not split bucket %d\n", index->name, index->meta.split);
+    return EXIT_SUCCESS;
 }
 
 /**
-  * @author Mislav Čakarić
-  * @brief Function that fetches or deletes a record from hash index
+  * @author Mislav Čakarić, updated by agent (linear hashing)
+  * @brief Function that creates a linear hash index on attributes of a table. The number of buckets is chosen by the
+  * number of rows, so adding the rows of the table splits few of them.
+  * @param tblName name of table for which the index is being created
+  * @param attributes list of attributes over which the index is being created, in the order of the key
   * @param indexName name of index
-  * @param values list of values (one row) to search in hash index
-  * @param delete if delete is 0 then record is only read otherwise it's deleted from hash index
-  * @return address structure with data where the record is in table
- 
+  * @return EXIT_SUCCESS or EXIT_ERROR
  */
-//Error: expected a ')'
-struct_add *AK_find_delete_in_hash_index(char *indexName, struct list_node *values, int delete) {
+int AK_create_hash_index(char *tblName, struct list_node *attributes, char *indexName) {
+    AK_hash_index index;
+    AK_header i_header[MAX_ATTRIBUTES];
+    AK_header *table_header, *temp;
+    AK_block *block;
+    AK_rid rid;
+    struct list_node *attribute;
+    table_addresses *addresses;
+    unsigned char key[AK_HASH_MAX_KEY];
+    time_t now = time(NULL);
+    int num_attr, i, size, start, rows, result = EXIT_SUCCESS;
     AK_PRO;
-    struct_add *add = (struct_add*) AK_malloc(sizeof (struct_add));
-    memset(add, 0, sizeof (struct_add));
-    table_addresses *addresses = (table_addresses*) AK_get_index_addresses(indexName);
-    if (addresses->address_from[0] == 0) {
-        printf("Hash index does not exist!\n");
+
+    num_attr = AK_num_attr(tblName);
+    table_header = (AK_header *) AK_get_header(tblName);
+    if (num_attr <= 0 || table_header == NULL) {
+        printf("Table %s does not exist!\n", tblName);
+        AK_free(table_header);
         AK_EPI;
-        return add;
-    } else {
-        int hashValue = 0, address, size, i, j, k, found, match;
-        struct list_node *temp_elem;
-        temp_elem = AK_First_L2(values);
-        while (temp_elem) {
-            hashValue += AK_elem_hash_value(temp_elem);
-            temp_elem = AK_Next_L2(temp_elem);
+        return EXIT_ERROR;
+    }
+    addresses = (table_addresses *) AK_get_index_addresses(indexName);
+    start = addresses->address_from[0];
+    AK_free(addresses);
+    if (start != 0) {
+        printf("Index %s already exists!\n", indexName);
+        AK_free(table_header);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    memset(&index, 0, sizeof(AK_hash_index));
+    memset(i_header, 0, sizeof(i_header));
+    strncpy(index.meta.table, tblName, MAX_ATT_NAME - 1);
+    attribute = (struct list_node *) AK_First_L2(attributes);
+    while (attribute != NULL && result == EXIT_SUCCESS) {
+        for (i = 0; i < num_attr && strcmp(table_header[i].att_name, attribute->data) != 0; i++);
+        if (i == num_attr) {
+            printf("Attribute %s does not exist in table %s!\n", attribute->data, tblName);
+            result = EXIT_ERROR;
+        } else if (index.meta.attributes == MAX_ATTRIBUTES || !AK_hash_supported(table_header[i].type)) {
+            printf("Unsupported data type for hash index on attribute %s!\n", attribute->data);
+            result = EXIT_ERROR;
+        } else {
+            AK_dbg_messg(HIGH, INDICES, "Attribute %s exist in table, found on position: %d\n", table_header[i].att_name, i);
+            temp = (AK_header *) AK_create_header(table_header[i].att_name, table_header[i].type, FREE_INT, FREE_CHAR, FREE_CHAR);
+            memcpy(i_header + index.meta.attributes, temp, sizeof(AK_header));
+            AK_free(temp);
+            index.meta.position[index.meta.attributes] = i;
+            index.meta.type[index.meta.attributes] = table_header[i].type;
+            index.meta.attributes++;
         }
-        struct_add *main_add = (struct_add*) AK_malloc(sizeof (struct_add));
-        struct_add *hash_add = (struct_add*) AK_malloc(sizeof (struct_add));
-        main_bucket *temp_main_bucket = (main_bucket*) AK_malloc(sizeof (main_bucket));
-        hash_bucket *temp_hash_bucket = (hash_bucket*) AK_malloc(sizeof (hash_bucket));
-        char data[255];
-        memset(data, 0, 255);
-        hash_info *info = (hash_info*) AK_malloc(sizeof (hash_info));
-        info = AK_get_hash_info(indexName);
-        int hash_bucket_id = hashValue % info->modulo;
-        int main_bucket_id = (int) (hash_bucket_id / MAIN_BUCKET_SIZE);
-
-        main_add = AK_get_nth_main_bucket_add(indexName, main_bucket_id);
-        AK_block *temp_block = (AK_block*) AK_read_block(main_add->addBlock);
-        address = temp_block->tuple_dict[main_add->indexTd].address;
-        size = temp_block->tuple_dict[main_add->indexTd].size;
-        memcpy(temp_main_bucket, &temp_block->data[address], size);
-
-        memcpy(hash_add, &temp_main_bucket->element[hash_bucket_id % MAIN_BUCKET_SIZE].add, sizeof (struct_add));
-
-        temp_block = (AK_block*) AK_read_block(hash_add->addBlock);
-        address = temp_block->tuple_dict[hash_add->indexTd].address;
-        size = temp_block->tuple_dict[hash_add->indexTd].size;
-        memcpy(temp_hash_bucket, &temp_block->data[address], size);
-        for (i = 0; i < HASH_BUCKET_SIZE; i++) {
-            if (temp_hash_bucket->element[i].value == hashValue) {
-                AK_block *temp_table_block = (AK_block*) AK_read_block(temp_hash_bucket->element[i].add.addBlock);
-                j = 0;
-                while (strcmp(temp_block->header[j].att_name, "\0")) {
-                    k = 0;
-                    found = 0;
-                    while (strcmp(temp_table_block->header[k].att_name, "\0")) {
-                        if (strcmp(temp_block->header[j].att_name, temp_table_block->header[k].att_name) == 0) {
-                            found = 1;
-                            match = 0;
-                            int indexTd = temp_hash_bucket->element[i].add.indexTd + k;
-                            int record_address = temp_table_block->tuple_dict[indexTd].address;
-                            int record_size = temp_table_block->tuple_dict[indexTd].size;
-                            int record_type = temp_table_block->tuple_dict[indexTd].type;
-                            memcpy(data, &temp_table_block->data[record_address], record_size);
-                            temp_elem = (struct list_node *)AK_First_L2(values);
-                            while (temp_elem) {
-                                if (temp_elem->type == record_type && memcmp(data, &temp_elem->data, record_size) == 0)
-                                    match = 1;
-                                temp_elem = temp_elem->next;
-                            }
-                            break;
-                        }
-                        k++;
-                    }
-                    if (found == 0 || match == 0) break;
-                    j++;
-                }
-                if (match) {
-                    int addBlock = temp_hash_bucket->element[i].add.addBlock;
-                    int indexTd = temp_hash_bucket->element[i].add.indexTd;
-                    //Error: expected an expression
-                    if (delete==1) {
-                        temp_hash_bucket->element[i].value = -1;
-                        memcpy(data, temp_hash_bucket, sizeof (hash_bucket));
-                        AK_update_bucket_in_block(hash_add, data);
-                    } else
-                        AK_dbg_messg(HIGH, INDICES, "Record found in table block %d and TupleDict ID %d\n", addBlock, indexTd);
-                    add->addBlock = addBlock;
-                    add->indexTd = indexTd;
-                    break;
-                }
+        attribute = (struct list_node *) AK_Next_L2(attribute);
+    }
+    AK_free(table_header);
+    if (result == EXIT_SUCCESS && index.meta.attributes == 0) {
+        printf("No attributes for index %s!\n", indexName);
+        result = EXIT_ERROR;
+    }
+    if (result == EXIT_ERROR) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    start = AK_initialize_new_index_segment(indexName, tblName, index.meta.position[0], i_header);
+    if (start == EXIT_ERROR) {
+        printf("Index %s can not be created!\n", indexName);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    printf("\nINDEX %s CREATED!\n", indexName);
+    index.name = indexName;
+    index.address = start;
+    index.meta.last_page = start;
+    index.meta.seed = AK_hash_value(indexName, strlen(indexName), (unsigned long long) now);
+    //room for the rows of the table with short keys
+    rows = AK_get_num_records(tblName);
+    index.meta.round = AK_HASH_MIN_BUCKETS;
+    while (2 * index.meta.round <= AK_HASH_MAX_DIRECTORY * AK_HASH_DIRECTORY_SIZE
+           && (long long) index.meta.round * AK_HASH_PAGE_DATA * AK_HASH_FILL < (long long) rows * (AK_HASH_ENTRY + 16) * 100)
+        index.meta.round *= 2;
+
+    pthread_rwlock_wrlock(&AK_hash_lock);
+    for (i = 0; i < index.meta.round && result == EXIT_SUCCESS; i++)
+        result = AK_hash_add_bucket(&index, i);
+    index.meta.buckets = index.meta.round;
+
+    addresses = (table_addresses *) AK_get_table_addresses(tblName);
+    for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0 && result == EXIT_SUCCESS; i++) {
+        for (rid.block = addresses->address_from[i]; rid.block < addresses->address_to[i] && result == EXIT_SUCCESS; rid.block++) {
+            block = ((AK_mem_block *) AK_get_block(rid.block))->block;
+            if (block->last_tuple_dict_id == 0)
+                break;
+            for (rid.slot = 0; (rid.slot + 1) * num_attr <= DATA_BLOCK_SIZE && result == EXIT_SUCCESS; rid.slot++) {
+                block = ((AK_mem_block *) AK_get_block(rid.block))->block;
+                if (!AK_slot_is_live(block, rid.slot, num_attr))
+                    continue;
+                if ((size = AK_hash_encode_slot(&index.meta, block, &rid, num_attr, key)) == EXIT_ERROR) {
+                    printf("Row %d in block %d of table %s can not be indexed!\n", rid.slot, rid.block, tblName);
+                    result = EXIT_ERROR;
+                } else
+                    result = AK_hash_add(&index, key, size, &rid);
             }
         }
     }
+    AK_free(addresses);
+    AK_hash_write_meta(&index);
+    pthread_rwlock_unlock(&AK_hash_lock);
     AK_EPI;
-    return add;
+    return result;
 }
 
 /**
-  * @author Mislav Čakarić
-  * @brief Function that fetches a record from the hash index
+  * @author Mislav Čakarić, updated by agent
+  * @brief Function that deletes a hash index
   * @param indexName name of index
-  * @param values list of values (one row) to search in hash index
-  * @return address structure with data where the record is in table
- 
+  * @return EXIT_SUCCESS or EXIT_ERROR
  */
-struct_add * AK_find_in_hash_index(char *indexName, struct list_node *values) {
+int AK_delete_hash_index(char *indexName) {
+    int result;
     AK_PRO;
-    struct_add* ret = AK_find_delete_in_hash_index(indexName, values, FIND);
+    pthread_rwlock_wrlock(&AK_hash_lock);
+    result = AK_delete_segment(indexName, SEGMENT_TYPE_INDEX);
+    pthread_rwlock_unlock(&AK_hash_lock);
+    if (result == EXIT_SUCCESS)
+        printf("INDEX %s DELETED!\n", indexName);
     AK_EPI;
-    return ret;
+    return result;
 }
 
 /**
-  * @author Mislav Čakarić
-  * @brief Function that deletes a record from the hash index
-  * @param indexName name of index
-  * @param values list of values (one row) to search in hash index
-  * @return No return value
- 
+ * @author agent
+ * @brief  Function that reads the first page of a hash index
+ * @param indexName name of the index
+ * @param meta receives the page
+ * @return EXIT_SUCCESS, EXIT_ERROR if there is no such hash index
  */
-void AK_delete_in_hash_index(char *indexName, struct list_node *values) {
+int AK_hash_get_meta(char *indexName, AK_hash_meta *meta)
+{
+    AK_hash_index index;
+    int result;
     AK_PRO;
-    AK_find_delete_in_hash_index(indexName, values, DELETE);
+    pthread_rwlock_rdlock(&AK_hash_lock);
+    result = AK_hash_open_index(indexName, &index);
+    pthread_rwlock_unlock(&AK_hash_lock);
+    if (result == EXIT_SUCCESS)
+        memcpy(meta, &index.meta, sizeof(AK_hash_meta));
     AK_EPI;
+    return result;
 }
 
 /**
-  * @author Mislav Čakarić
-  * @brief Function that creates a hash index
-  * @param tblName name of table for which the index is being created
-  * @param indexName name of index
-  * @param attributes list of attributes over which the index is being created
-  * @return success or error
- 
+ * @author agent
+ * @brief  Function that inserts a key into a hash index and splits the next bucket if the index got too full
+ * @param indexName name of the index
+ * @param key values of the key attributes in the order of the key
+ * @param rid RID of the row
+ * @return EXIT_SUCCESS, EXIT_ERROR if the key can not be encoded or is already in the index
  */
-int AK_create_hash_index(char *tblName, struct list_node *attributes, char *indexName) {
-    int i, j, k, l, n, exist, hashValue;
+int AK_hash_insert(char *indexName, struct list_node *key, AK_rid *rid)
+{
+    AK_hash_index index;
+    unsigned char bytes[AK_HASH_MAX_KEY];
+    int size, result = EXIT_ERROR;
     AK_PRO;
-    table_addresses *addresses = (table_addresses*) AK_get_table_addresses(tblName);
-    int num_attr = AK_num_attr(tblName);
-    AK_header *table_header = (AK_header *)AK_get_header(tblName);
-
-    AK_header i_header[ MAX_ATTRIBUTES ];
-    AK_header* temp;
-
-    struct list_node *attribute = (struct list_node *) AK_First_L2(attributes);
-    n = 0;
-    while (attribute != 0) {
-        exist = 0;
-        for (i = 0; i < num_attr; i++) {
-            if (strcmp((table_header + i)->att_name, attribute->data) == 0) {
-				AK_dbg_messg(HIGH, INDICES, "Attribute %s exist in table, found on position: %d\n", (table_header + i)->att_name, i);
-                exist = 1;
-                temp = (AK_header*) AK_create_header((table_header + i)->att_name, (table_header + i)->type, FREE_INT, FREE_CHAR, FREE_CHAR);
-                memcpy(i_header + n, temp, sizeof ( AK_header));
-                n++;
-                if ((table_header + 1)->type != TYPE_VARCHAR && (table_header + 1)->type != TYPE_INT) {
-                    printf("Unsupported data type for hash index! Only int and varchar!");
-                    AK_EPI;
-                    return EXIT_ERROR;
-                }
+    pthread_rwlock_wrlock(&AK_hash_lock);
+    if (AK_hash_open_index(indexName, &index) != EXIT_SUCCESS)
+        printf("Hash index %s does not exist!\n", indexName);
+    else if ((size = AK_hash_encode_key(&index.meta, key, bytes)) == EXIT_ERROR)
+        printf("Key can not be inserted into index %s!\n", indexName);
+    else {
+        result = AK_hash_add(&index, bytes, size, rid);
+        AK_hash_write_meta(&index);
+    }
+    pthread_rwlock_unlock(&AK_hash_lock);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @author agent
+ * @brief  Function that deletes a key from a hash index. Emptied overflow pages are freed, buckets are not merged.
+ * @param indexName name of the index
+ * @param key values of the key attributes in the order of the key
+ * @param rid RID of the row
+ * @return EXIT_SUCCESS, EXIT_ERROR if the key is not in the index
+ */
+int AK_hash_delete_key(char *indexName, struct list_node *key, AK_rid *rid)
+{
+    AK_hash_index index;
+    AK_mem_block *mem_block;
+    AK_hash_page *page;
+    unsigned char bytes[AK_HASH_MAX_KEY], entry[AK_HASH_ENTRY + AK_HASH_MAX_KEY], *at;
+    unsigned long long hash;
+    int size, entry_size, address, previous = 0, next, i, result = EXIT_ERROR;
+    AK_PRO;
+    pthread_rwlock_wrlock(&AK_hash_lock);
+    if (AK_hash_open_index(indexName, &index) != EXIT_SUCCESS)
+        printf("Hash index %s does not exist!\n", indexName);
+    else if ((size = AK_hash_encode_key(&index.meta, key, bytes)) != EXIT_ERROR) {
+        hash = AK_hash_value(bytes, size, index.meta.seed);
+        entry_size = AK_hash_make_entry(entry, hash, rid, bytes, size);
+        for (address = AK_hash_bucket_page(&index, AK_hash_bucket(&index.meta, hash)); address != 0 && result == EXIT_ERROR; address = next) {
+            mem_block = (AK_mem_block *) AK_get_block(address);
+            page = (AK_hash_page *) mem_block->block->data;
+            next = page->next;
+            at = mem_block->block->data + sizeof(AK_hash_page);
+            for (i = 0; i < page->count && !AK_hash_entry_equal(at, entry, 1); i++)
+                at += AK_hash_entry_size(at);
+            if (i == page->count) {
+                previous = address;
+                continue;
             }
+            memmove(at, at + entry_size, mem_block->block->data + sizeof(AK_hash_page) + page->used - at - entry_size);
+            page->used -= entry_size;
+            page->count--;
+            mem_block->block->tuple_dict[0].size = mem_block->block->AK_free_space = sizeof(AK_hash_page) + page->used;
+            AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+            //an empty overflow page leaves the bucket
+            if (page->count == 0 && previous != 0) {
+                mem_block = (AK_mem_block *) AK_get_block(previous);
+                ((AK_hash_page *) mem_block->block->data)->next = next;
+                AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+                AK_hash_free_page(&index, address);
+            }
+            index.meta.entries--;
+            index.meta.bytes -= entry_size;
+            AK_hash_write_meta(&index);
+            result = EXIT_SUCCESS;
         }
-        if (!exist) {
-            printf("Atribut %s ne postoji u tablici", attribute->data);
-            AK_EPI;
-            return EXIT_ERROR;
-        }
-        attribute = attribute->next;
     }
-    memset(i_header + n, 0, MAX_ATTRIBUTES - n);
-
-    int startAddress = AK_initialize_new_segment(indexName, SEGMENT_TYPE_INDEX, i_header);
-    if (startAddress != EXIT_ERROR)
-        printf("\nINDEX %s CREATED!\n", indexName);
+    pthread_rwlock_unlock(&AK_hash_lock);
+    AK_EPI;
+    return result;
+}
 
-    AK_block *block = (AK_block*) AK_read_block(startAddress);
-    hash_info *info = (hash_info*) AK_malloc(sizeof (hash_info));
-    info->modulo = 4;
-    info->main_bucket_num = 0;
-    info->hash_bucket_num = 0;
-    memcpy(block->data, info, sizeof (hash_info));
-    block->tuple_dict[0].address = 0;
-    block->tuple_dict[0].type = INFO_BUCKET;
-    block->tuple_dict[0].size = sizeof (hash_info);
-    block->AK_free_space += sizeof (hash_info);
-    block->last_tuple_dict_id = 0;
-    AK_write_block(block);
-
-    struct list_node *temp_elem;
-
-    char data[ MAX_VARCHAR_LENGTH ];
-    struct list_node *row = (struct list_node *) AK_malloc(sizeof (struct list_node));
-    AK_Init_L3(&row);
-    i = 0;
-    n = 0;
-    while (addresses->address_from[ i ]) {
-        for (j = addresses->address_from[ i ]; j < addresses->address_to[ i ]; j++) {
-            AK_block *temp = (AK_block*) AK_read_block(j);
-            for (k = 0; k < DATA_BLOCK_SIZE; k += num_attr) {
-                n++;
-                if (temp->tuple_dict[k].type == FREE_INT)
-                    break;
-                for (l = 0; l < num_attr; l++) {
-                    int type = temp->tuple_dict[ k + l ].type;
-                    int size = temp->tuple_dict[ k + l ].size;
-                    int address = temp->tuple_dict[ k + l ].address;
-                    memcpy(data, &(temp->data[address]), size);
-                    data[ size ] = '\0';
-                    AK_InsertAtEnd_L3(type, data, size, row);
-                }
-                /* *************** */
-                hashValue = 0;
-                attribute = (struct list_node *) AK_First_L2(attributes);
-                while (attribute) {
-
-                    for (l = 0; l < num_attr; l++) {
-                        if (strcmp((table_header + l)->att_name, attribute->data) == 0)
-                            break;
-                    }
-                    temp_elem = AK_GetNth_L2(l, row);
-                    hashValue += AK_elem_hash_value(temp_elem);
-
-                    attribute = attribute->next;
+/**
+ * @author agent
+ * @brief  Function that finds the rows whose key attributes are equal to values; only the bucket of their hash is read
+ * @param indexName name of the index
+ * @param key values of all key attributes in the order of the key
+ * @param count receives the number of rows found
+ * @return RIDs of the rows, to be freed with AK_free; NULL if none were found or the key can not be encoded
+ */
+AK_rid *AK_hash_find(char *indexName, struct list_node *key, int *count)
+{
+    AK_hash_index index;
+    AK_block *block;
+    AK_hash_page *page;
+    AK_rid *rids = NULL;
+    AK_rid empty = {0, 0};
+    unsigned char bytes[AK_HASH_MAX_KEY], entry[AK_HASH_ENTRY + AK_HASH_MAX_KEY], *at;
+    unsigned long long hash;
+    int size, address, i, capacity = 0;
+    AK_PRO;
+    *count = 0;
+    pthread_rwlock_rdlock(&AK_hash_lock);
+    if (AK_hash_open_index(indexName, &index) == EXIT_SUCCESS && (size = AK_hash_encode_key(&index.meta, key, bytes)) != EXIT_ERROR) {
+        hash = AK_hash_value(bytes, size, index.meta.seed);
+        AK_hash_make_entry(entry, hash, &empty, bytes, size);
+        for (address = AK_hash_bucket_page(&index, AK_hash_bucket(&index.meta, hash)); address != 0; address = page->next) {
+            block = ((AK_mem_block *) AK_get_block(address))->block;
+            page = (AK_hash_page *) block->data;
+            at = block->data + sizeof(AK_hash_page);
+            for (i = 0; i < page->count; i++, at += AK_hash_entry_size(at)) {
+                if (!AK_hash_entry_equal(at, entry, 0))
+                    continue;
+                if (*count == capacity) {
+                    capacity = capacity == 0 ? 16 : 2 * capacity;
+                    rids = (AK_rid *) AK_realloc(rids, capacity * sizeof(AK_rid));
                 }
-                AK_dbg_messg(HIGH, INDICES, "Insert in hash index %d. record\n", n);
-                struct_add *add = (struct_add*) AK_malloc(sizeof (struct_add));
-                add->addBlock = j;
-                add->indexTd = k;
-                AK_insert_in_hash_index(indexName, hashValue, add);
-                AK_DeleteAll_L3(&row);
-                /* *************** */
+                AK_hash_entry_rid(at, &rids[(*count)++]);
             }
         }
-        i++;
     }
+    pthread_rwlock_unlock(&AK_hash_lock);
     AK_EPI;
-    return EXIT_SUCCESS;
+    return rids;
 }
 
-void AK_delete_hash_index(char *indexName) {
-    AK_PRO;
-    AK_delete_segment(indexName, SEGMENT_TYPE_INDEX);
-    printf("INDEX %s DELETED!\n", indexName);
-    AK_EPI;
+/**
+ * @author agent
+ * @brief  Function that counts the rows a hash index finds for a varchar
+ * @param indexName name of the index
+ * @param value value of the key
+ * @param rid receives the first RID found, may be NULL
+ * @return number of rows found
+ */
+static int AK_hash_test_find(char *indexName, char *value, AK_rid *rid)
+{
+    struct list_node *key = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_rid *rids;
+    int count;
+    AK_Init_L3(&key);
+    AK_InsertAtEnd_L3(TYPE_VARCHAR, value, strlen(value), key);
+    rids = AK_hash_find(indexName, key, &count);
+    if (rid != NULL && count > 0)
+        *rid = rids[0];
+    AK_free(rids);
+    AK_DeleteAll_L3(&key);
+    AK_free(key);
+    return count;
 }
 
 /**
-  * @author Mislav Čakarić
+  * @author Mislav Čakarić, updated by agent (linear hashing)
   * @brief Function that tests hash index
   * @return No return value 
  */
@@ -599,60 +996,205 @@ TestResult AK_hash_test() {
     int failedTest = 0;
     char *tblName = "student";
     char *indexName = "student_hash_index";
-    //AK_print_table("AK_relation");
+    char *testTable = "hash_test";
+    char *nameIndex = "hash_test_name";
+    char name[MAX_VARCHAR_LENGTH];
+    AK_hash_meta meta;
+    AK_cursor *rows;
+    AK_rid *rids, fake, placed, found;
+    struct list_node *row, *stored, *value;
+    int i, count, matches, buckets, keys = 3000;
+    AK_operator *plan;
+    AK_operator_info info;
     AK_PRO;
     struct list_node *att_list = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    struct list_node *key = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    struct list_node *row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
     AK_Init_L3(&att_list);
+    AK_Init_L3(&key);
+    AK_Init_L3(&row_root);
+
+    printf("\nHash function...\n");
+    //values of xxHash64, anagrams and neighbouring numbers have to land apart
+    i = 1000;
+    count = 1001;
+    if (AK_hash_value("", 0, 0) == 0xEF46DB3751D8E999ULL && AK_hash_value("abc", 3, 0) == 0x44BC2CF5AD770999ULL
+        && AK_hash_value("abc", 3, 1) != AK_hash_value("abc", 3, 0) && AK_hash_value("cba", 3, 0) != AK_hash_value("abc", 3, 0)
+        && (AK_hash_value(&i, sizeof(int), 0) & 0xFF) != (AK_hash_value(&count, sizeof(int), 0) & 0xFF)) {
+        passedTest++;
+    } else {
+        printf("Hash values are wrong.\n");
+        failedTest++;
+    }
+
+    printf("\nHash index on mbr and firstname of table %s\n", tblName);
     AK_InsertAtEnd_L3(TYPE_ATTRIBS, "mbr\0", 4, att_list);
     AK_InsertAtEnd_L3(TYPE_ATTRIBS, "firstname\0", 10, att_list);
+    if (AK_create_hash_index(tblName, att_list, indexName) == EXIT_SUCCESS && AK_hash_get_meta(indexName, &meta) == EXIT_SUCCESS
+        && meta.entries == AK_get_num_records(tblName)) {
+        printf("Buckets: %d, pages: %d, keys: %d\n", meta.buckets, meta.pages, meta.entries);
+        passedTest++;
+    } else {
+        printf("Index %s should have a key for every row of %s.\n", indexName, tblName);
+        failedTest++;
+    }
+
+    printf("\nHash index search test:\n");
+    matches = 1;
+    rows = AK_cursor_open(tblName);
+    while ((row = AK_cursor_next(rows)) != NULL) {
+        AK_DeleteAll_L3(&key);
+        value = (struct list_node *) AK_First_L2(row);
+        AK_InsertAtEnd_L3(value->type, value->data, value->size, key);
+        value = AK_GetNth_L2(2, row);
+        AK_InsertAtEnd_L3(value->type, value->data, value->size, key);
+        rids = AK_hash_find(indexName, key, &count);
+        if (count != 1)
+            matches = 0;
+        else {
+            stored = AK_get_row_by_rid(rids);
+            if (stored == NULL || memcmp(((struct list_node *) AK_First_L2(stored))->data, ((struct list_node *) AK_First_L2(key))->data, sizeof(int)) != 0)
+                matches = 0;
+            if (stored != NULL) {
+                AK_DeleteAll_L3(&stored);
+                AK_free(stored);
+            }
+        }
+        AK_free(rids);
+    }
+    AK_cursor_close(rows);
+    if (matches) {
+        passedTest++;
+    } else {
+        printf("Searching mbr and firstname in %s should find exactly their row.\n", indexName);
+        failedTest++;
+    }
+
+    printf("\nInserting %d keys into index %s...\n", keys, nameIndex);
+    AK_create_table_parameter *params = (AK_create_table_parameter *) AK_malloc(2 * sizeof(AK_create_table_parameter));
+    params[0] = *(AK_create_create_table_parameter(TYPE_INT, "id"));
+    params[1] = *(AK_create_create_table_parameter(TYPE_VARCHAR, "name"));
+    AK_create_table(testTable, params, 2);
+    AK_free(params);
+    AK_DeleteAll_L3(&att_list);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "name\0", 5, att_list);
+    matches = AK_create_hash_index(testTable, att_list, nameIndex) == EXIT_SUCCESS;
+    buckets = matches && AK_hash_get_meta(nameIndex, &meta) == EXIT_SUCCESS ? meta.buckets : 0;
+    for (i = 0; i < keys && matches; i++) {
+        fake.block = i + 1;
+        fake.slot = 0;
+        sprintf(name, "key%05d", i);
+        AK_DeleteAll_L3(&key);
+        AK_InsertAtEnd_L3(TYPE_VARCHAR, name, strlen(name), key);
+        matches = AK_hash_insert(nameIndex, key, &fake) == EXIT_SUCCESS;
+    }
+    //the same key of another row is another entry, the same key of the same row is refused
+    fake.block = keys + 1;
+    matches = matches && AK_hash_insert(nameIndex, key, &fake) == EXIT_SUCCESS && AK_hash_insert(nameIndex, key, &fake) == EXIT_ERROR;
+    for (i = 0; i < keys && matches; i++) {
+        sprintf(name, "key%05d", i);
+        if (AK_hash_test_find(nameIndex, name, &found) != (i == keys - 1 ? 2 : 1) || (i < keys - 1 && found.block != i + 1))
+            matches = 0;
+    }
+    //buckets are split as keys come, so a bucket has two pages on average at most
+    if (matches && AK_hash_get_meta(nameIndex, &meta) == EXIT_SUCCESS && meta.entries == keys + 1 && meta.buckets > buckets
+        && meta.pages <= 2 * meta.buckets && AK_hash_test_find(nameIndex, "key", NULL) == 0) {
+        printf("Index %s has %d keys in %d buckets on %d pages.\n", nameIndex, meta.entries, meta.buckets, meta.pages);
+        passedTest++;
+    } else {
+        printf("Index %s should find each of its %d keys.\n", nameIndex, keys);
+        failedTest++;
+    }
+
+    printf("\nDeleting keys...\n");
+    matches = 1;
+    for (i = 0; i < keys; i++) {
+        if (i % 3 == 0)
+            continue;
+        fake.block = i + 1;
+        sprintf(name, "key%05d", i);
+        AK_DeleteAll_L3(&key);
+        AK_InsertAtEnd_L3(TYPE_VARCHAR, name, strlen(name), key);
+        if (AK_hash_delete_key(nameIndex, key, &fake) != EXIT_SUCCESS)
+            matches = 0;
+    }
+    //a key that is not there
+    if (AK_hash_delete_key(nameIndex, key, &fake) != EXIT_ERROR)
+        matches = 0;
+    for (i = 0; i < keys - 1 && matches; i++) {
+        sprintf(name, "key%05d", i);
+        if (AK_hash_test_find(nameIndex, name, NULL) != (i % 3 == 0))
+            matches = 0;
+    }
+    if (matches && AK_hash_get_meta(nameIndex, &meta) == EXIT_SUCCESS && meta.entries == keys / 3 + 1) {
+        passedTest++;
+    } else {
+        printf("Index %s should keep %d keys.\n", nameIndex, keys / 3 + 1);
+        failedTest++;
+    }
+
+    printf("\nInserting, updating and deleting a row of table %s...\n", testTable);
+    i = keys;
+    AK_Insert_New_Element(TYPE_INT, &i, testTable, "id", row_root);
+    AK_Insert_New_Element(TYPE_VARCHAR, "inserted", testTable, "name", row_root);
+    matches = AK_insert_row_rid(row_root, &placed) == EXIT_SUCCESS && AK_hash_test_find(nameIndex, "inserted", &found) == 1
+              && found.block == placed.block && found.slot == placed.slot;
+    AK_DeleteAll_L3(&row_root);
+    AK_Update_Existing_Element(TYPE_INT, &i, testTable, "id", row_root);
+    AK_Insert_New_Element(TYPE_VARCHAR, "updated", testTable, "name", row_root);
+    AK_update_row(row_root);
+    matches = matches && AK_hash_test_find(nameIndex, "inserted", NULL) == 0 && AK_hash_test_find(nameIndex, "updated", NULL) == 1;
+    AK_DeleteAll_L3(&row_root);
+    AK_Update_Existing_Element(TYPE_INT, &i, testTable, "id", row_root);
+    AK_delete_row(row_root);
+    if (matches && AK_hash_test_find(nameIndex, "updated", NULL) == 0) {
+        passedTest++;
+    } else {
+        printf("Index %s should follow the row changes.\n", nameIndex);
+        failedTest++;
+    }
+
+    printf("\nSelection of %s by a hash index on firstname...\n", tblName);
+    //an equality on the key of the index reads the rows found in its bucket
+    AK_DeleteAll_L3(&att_list);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "firstname", sizeof("firstname"), att_list);
+    matches = AK_create_hash_index(tblName, att_list, "student_hash_firstname") == EXIT_SUCCESS;
+    AK_DeleteAll_L3(&key);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "firstname", sizeof("firstname"), key);
+    AK_InsertAtEnd_L3(TYPE_VARCHAR, "Ivan", strlen("Ivan"), key);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "=", sizeof("="), key);
+    plan = AK_access_operator(tblName, key);
+    AK_operator_describe(plan, &info);
+    count = AK_iterator_count(plan = AK_select_operator(plan, key));
+    AK_operator_free(plan);
+    i = AK_iterator_count(plan = AK_select_operator(AK_scan_operator(tblName), key));
+    AK_operator_free(plan);
+    AK_delete_hash_index("student_hash_firstname");
+    printf("Selection of %s by %s: %d rows, expected %d\n", tblName, info.index_scan ? "index" : "scan", count, i);
+    if (matches && info.index_scan && count > 1 && count == i) {
+        passedTest++;
+    } else {
+        printf("A selection on the key of index student_hash_firstname should read its bucket.\n");
+        failedTest++;
+    }
+
+    printf("\nDeleting indexes...\n");
+    matches = AK_delete_hash_index(nameIndex) == EXIT_SUCCESS && AK_delete_hash_index(indexName) == EXIT_SUCCESS;
+    AK_delete_segment(testTable, SEGMENT_TYPE_TABLE);
+    if (matches && AK_hash_get_meta(nameIndex, &meta) == EXIT_ERROR && AK_hash_get_meta(indexName, &meta) == EXIT_ERROR) {
+        passedTest++;
+    } else {
+        printf("Deleted indexes should be gone.\n");
+        failedTest++;
+    }
 
-    if(AK_create_hash_index(tblName, att_list, indexName) == EXIT_ERROR){
-    	failedTest++;
-    }
-    else{
-    	passedTest++;
-    }
-
-    struct list_node *values = (struct list_node *) AK_malloc(sizeof (struct list_node));
-    struct list_node *row = (struct list_node *) AK_malloc(sizeof (struct list_node));
-    AK_Init_L3(&values);
-
-    //AK_delete_hash_index(indexName);
-
-    hash_info *info = (hash_info*) AK_malloc(sizeof (hash_info));
-    info = AK_get_hash_info(indexName);
-    if(info == NULL){
-    	failedTest++;
-    }
-    else{
-    	passedTest++;
-    }
-    printf("Main buckets:%d, Hash buckets:%d, Modulo:%d\n", info->main_bucket_num, info->hash_bucket_num, info->modulo);
-
-    //AK_delete_hash_index(indexName);
-    AK_print_table("AK_relation");
-    AK_print_table("AK_index");
-
-    printf("Hash index search test:\n");
-    int i, num_rec = AK_get_num_records(tblName);
-    for (i = 0; i < num_rec; i++) {
-        row = AK_get_row(i, tblName);
-        struct list_node *value = AK_GetNth_L2(1, row);
-        AK_InsertAtEnd_L3(value->type, value->data, value->size, values);
-        value = AK_GetNth_L2(1, row);
-        AK_InsertAtEnd_L3(value->type, value->data, value->size, values);
-        struct_add *add = AK_find_in_hash_index(indexName, values);
-        if(add->addBlock == NULL){
-    		failedTest++;
-    	}
-    	else{
-    		passedTest++;
-    	}
-        AK_DeleteAll_L3(&values);
-        if (add->addBlock && add->indexTd)
-            printf("Record found in table block %d and TupleDict ID %d\n", add->addBlock, add->indexTd);
-    }
-    printf("hash_test: Present!\n");
+    AK_DeleteAll_L3(&att_list);
+    AK_free(att_list);
+    AK_DeleteAll_L3(&key);
+    AK_free(key);
+    AK_DeleteAll_L3(&row_root);
+    AK_free(row_root);
+    printf("\n");
     AK_EPI;
     return TEST_result(passedTest,failedTest);
 }
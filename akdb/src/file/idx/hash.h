@@ -23,173 +23,155 @@
 #include "../../auxi/test.h"
 #include "index.h"
 #include "../../file/table.h"
+#include "../../file/fileio.h"
 #include "../../auxi/constants.h"
 #include "../../auxi/configuration.h"
-#include "../files.h"
 #include "../../auxi/mempro.h"
 
-/**
- * @author Unknown
- * @struct hash_info
- * @brief Structure for defining a hash info element
-*/
-typedef struct {
-	/// modulo value for hash function
-    int modulo;
-    /// bucket number
-    int main_bucket_num;
-    /// hash bucket number
-    int hash_bucket_num;
-} hash_info;
-
-/**
- * @author Unknown
- * @struct bucket_elem
- * @brief Structure for defining a single bucket element
- */
-typedef struct {
-	/// bucket element hash value
-    unsigned int value;
-    /// bucket element address values
-    struct_add add;
-} bucket_elem;
-
-/**
- * @author Unknown
- * @struct main_bucket
- * @brief Structure for defining main bucket for table hashing
+//types for tuple_dict[0] of the pages of a hash index
+#define HASH_META_PAGE 24
+#define HASH_BUCKET_PAGE 25
+#define HASH_DIRECTORY_PAGE 26
+#define HASH_FREE_PAGE 27
+
+/// number of bytes of a page available to the hash index
+#define AK_HASH_PAGE_SIZE (DATA_BLOCK_SIZE * DATA_ENTRY_SIZE)
+/// largest encoded key
+#define AK_HASH_MAX_KEY 512
+/// number of buckets of a new index, a power of two
+#define AK_HASH_MIN_BUCKETS 4
+/// percentage of the bytes of all buckets the entries may fill before the next bucket is split
+#define AK_HASH_FILL 75
+/// largest number of directory pages, every one holds the addresses of AK_HASH_DIRECTORY_SIZE buckets
+#define AK_HASH_MAX_DIRECTORY 256
+/// number of bucket addresses on a directory page
+#define AK_HASH_DIRECTORY_SIZE ((int) (AK_HASH_PAGE_SIZE / sizeof(int)))
+
+/**
+ * @author agent
+ * @struct AK_hash_meta
+ * @brief Structure that defines the first page of a linear hash index. A key goes to the bucket given by the lowest
+ * bits of its hash: as many bits as round has for buckets from split on, one more for those below split, which were
+ * split in the current round. Every insert that leaves the entries filling more than AK_HASH_FILL percent of the
+ * buckets splits bucket split into itself and bucket round + split, so buckets stay short as the table grows.
  */
 typedef struct {
-	/// main bucket array of bucket_elem elements
-    bucket_elem element[MAIN_BUCKET_SIZE];
-} main_bucket;
-
-/**
- * @author Unknown
- * @struct hash_bucket
- * @brief Structure for hash bucket for table hashing
+    /// name of the indexed table
+    char table[MAX_ATT_NAME];
+    /// number of key attributes
+    int attributes;
+    /// positions of the key attributes in the table
+    int position[MAX_ATTRIBUTES];
+    /// types of the key attributes
+    int type[MAX_ATTRIBUTES];
+    /// seed of the hash function, chosen when the index is created
+    unsigned long long seed;
+    /// number of buckets when the current round of splits started, a power of two
+    int round;
+    /// next bucket to split
+    int split;
+    /// number of buckets, round + split
+    int buckets;
+    /// number of keys
+    int entries;
+    /// number of bytes of all entries
+    long long bytes;
+    /// number of bucket and directory pages
+    int pages;
+    /// last page taken from the extents of the index
+    int last_page;
+    /// first page of the list of freed pages, 0 if it is empty
+    int free_page;
+    /// addresses of the directory pages
+    int directory[AK_HASH_MAX_DIRECTORY];
+} AK_hash_meta;
+
+/**
+ * @author agent
+ * @struct AK_hash_page
+ * @brief Structure that defines the beginning of a bucket page. It is followed by the entries: the hash of the key
+ * (eight bytes), the RID of the row, the length of the key (two bytes) and the key. A bucket whose entries do not fit
+ * into its page continues on the overflow pages linked by next.
  */
 typedef struct {
-	/// hash bucket level
-    int bucket_level;
-    /// hash bucket array of bucket_elem elements
-    bucket_elem element[HASH_BUCKET_SIZE];
-} hash_bucket;
-
-/**
-  * @author Mislav Čakarić
-  * @brief Function that computes a hash value from varchar or integer
-  * @param elem element of row for wich value is to be computed
-  * @return hash value
- 
- */
-int AK_elem_hash_value(struct list_node *elem);
-
-/**
-  * @author Mislav Čakarić
-  * @brief Function that inserts a bucket to block
-  * @param indexName name of index
-  * @param data content of bucket stored in char array
-  * @param type type of bucket (MAIN_BUCKET or HASH_BUCKET)
-  * @return address structure with data where the bucket is stored 
- */
-struct_add* AK_insert_bucket_to_block(char *indexName, char *data, int type);
-
-/**
-  *  @author Mislav Čakarić
-  *  @brief Function that updates a bucket in block
-  *  @param add address of where the bucket is stored
-  *  @param data content of bucket stored in char array
-  *  @return No return value
- */
-void AK_update_bucket_in_block(struct_add *add, char *data);
-
-/**
-  * @author Mislav Čakarić
-  * @brief Function that changes a info of hash index
+    /// number of entries
+    int count;
+    /// next page of the bucket, 0 for the last one
+    int next;
+    /// number of bytes of the entries
+    int used;
+} AK_hash_page;
+
+/**
+ * @author agent
+ * @brief  Function that computes a 64-bit hash of bytes in the manner of xxHash64: 32 byte stripes go through four
+ * multiply and rotate lanes, the rest through the same rounds one word at a time, and the result is mixed so that
+ * every bit of the input and of the seed affects every bit of the hash
+ * @param data bytes
+ * @param size number of bytes
+ * @param seed seed, different seeds give unrelated hashes
+ * @return hash value
+ */
+unsigned long long AK_hash_value(const void *data, int size, unsigned long long seed);
+
+/**
+  * @author Mislav Čakarić, updated by agent (linear hashing)
+  * @brief Function that creates a linear hash index on attributes of a table. The number of buckets is chosen by the
+  * number of rows, so adding the rows of the table splits few of them.
+  * @param tblName name of table for which the index is being created
+  * @param attributes list of attributes over which the index is being created, in the order of the key
   * @param indexName name of index
-  * @param modulo value for modulo hash function
-  * @param main_bucket_num number of main buckets
-  * @param hash_bucket_num number of hash buckets
-  * @return No return value
+  * @return EXIT_SUCCESS or EXIT_ERROR
  */
-void AK_change_hash_info(char *indexName, int modulo, int main_bucket_num, int hash_bucket_num);
+int AK_create_hash_index(char *tblName, struct list_node *attributes, char *indexName);
 
 /**
-  * @author Mislav Čakarić
-  * @brief Function that fetches the info for hash index
+  * @author Mislav Čakarić, updated by agent
+  * @brief Function that deletes a hash index
   * @param indexName name of index
-  * @return info bucket with info data for hash index
+  * @return EXIT_SUCCESS or EXIT_ERROR
  */
-hash_info* AK_get_hash_info(char *indexName);
+int AK_delete_hash_index(char *indexName);
 
 /**
-  * @author Mislav Čakarić
-  * @brief Function that fetches nth main bucket
-  * @param indexName name of index
-  * @param n number of main bucket
-  * @return address structure with data where the bucket is stored
+ * @author agent
+ * @brief  Function that reads the first page of a hash index
+ * @param indexName name of the index
+ * @param meta receives the page
+ * @return EXIT_SUCCESS, EXIT_ERROR if there is no such hash index
  */
-struct_add* AK_get_nth_main_bucket_add(char *indexName, int n);
+int AK_hash_get_meta(char *indexName, AK_hash_meta *meta);
 
 /**
-  *  @author Mislav Čakarić
-  *  @brief Function that inserts a record in hash bucket
-  *  @param indexName name of index
-  *  @param hashValue hash value of record that is being inserted
-  *  @param add address structure with data where the hash bucket is stored
-  *  @return No return value
+ * @author agent
+ * @brief  Function that inserts a key into a hash index and splits the next bucket if the index got too full
+ * @param indexName name of the index
+ * @param key values of the key attributes in the order of the key
+ * @param rid RID of the row
+ * @return EXIT_SUCCESS, EXIT_ERROR if the key can not be encoded or is already in the index
  */
-void AK_insert_in_hash_index(char *indexName, int hashValue, struct_add *add);
+int AK_hash_insert(char *indexName, struct list_node *key, AK_rid *rid);
 
 /**
-  * @author Mislav Čakarić
-  * @brief Function that fetches or deletes a record from hash index
-  * @param indexName name of index
-  * @param values list of values (one row) to search in hash index
-  * @param delete if delete is 0 then record is only read otherwise it's deleted from hash index
-  * @return address structure with data where the record is in table
- 
+ * @author agent
+ * @brief  Function that deletes a key from a hash index. Emptied overflow pages are freed, buckets are not merged.
+ * @param indexName name of the index
+ * @param key values of the key attributes in the order of the key
+ * @param rid RID of the row
+ * @return EXIT_SUCCESS, EXIT_ERROR if the key is not in the index
  */
-struct_add *AK_find_delete_in_hash_index(char *indexName, struct list_node *values, int delete);
+int AK_hash_delete_key(char *indexName, struct list_node *key, AK_rid *rid);
 
 /**
-  * @author Mislav Čakarić
-  * @brief Function that fetches a record from the hash index
-  * @param indexName name of index
-  * @param values list of values (one row) to search in hash index
-  * @return address structure with data where the record is in table
- 
+ * @author agent
+ * @brief  Function that finds the rows whose key attributes are equal to values; only the bucket of their hash is read
+ * @param indexName name of the index
+ * @param key values of all key attributes in the order of the key
+ * @param count receives the number of rows found
+ * @return RIDs of the rows, to be freed with AK_free; NULL if none were found or the key can not be encoded
  */
-struct_add * AK_find_in_hash_index(char *indexName, struct list_node *values);
+AK_rid *AK_hash_find(char *indexName, struct list_node *key, int *count);
 
-/**
-  * @author Mislav Čakarić
-  * @brief Function that deletes a record from the hash index
-  * @param indexName name of index
-  * @param values list of values (one row) to search in hash index
-  * @return No return value
- 
- */
-void AK_delete_in_hash_index(char *indexName, struct list_node *values);
-
-/**
-  * @author Mislav Čakarić
-  * @brief Function that creates a hash index
-  * @param tblName name of table for which the index is being created
-  * @param indexName name of index
-  * @param attributes list of attributes over which the index is being created
-  * @return success or error
- 
- */
-int AK_create_hash_index(char *tblName, struct list_node *attributes, char *indexName);
-void AK_delete_hash_index(char *indexName) ;
-
-/**
-  * @author Mislav Čakarić
-  * @brief Function that tests hash index
-  * @return No return value 
- */
 TestResult AK_hash_test();
 
 #endif
@@ -18,6 +18,10 @@
  17 */
 
 #include "index.h"
+#include "btree.h"
+#include "hash.h"
+#include "roaring.h"
+#include "bitmap.h"
 #include <stdlib.h>
 
 #include "../../auxi/mempro.h"
@@ -398,6 +402,131 @@ AK_header *AK_get_index_header(char *indexTblName) {
 }
 
 
+/**
+ * @author agent
+ * @brief  Function that applies a row change to one index of a table. A B+tree or hash index gets the key of the row,
+ * a compressed bitmap index the value of its attribute, a bitmap index a row of its index table.
+ * @param index index name
+ * @param table table name
+ * @param row values of the row
+ * @param rid RID of the row
+ * @param insert 1 to add the row to the index, 0 to remove it
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_index_apply(char *index, char *table, AK_row *row, AK_rid *rid, int insert) {
+    AK_btree_meta meta;
+    AK_hash_meta hash_meta;
+    AK_roaring_meta roaring_meta;
+    struct list_node *key;
+    char name[2 * MAX_ATT_NAME + sizeof("_bmapIndex")];
+    char *data;
+    int *position = NULL;
+    int i, attributes = 0, hash = 0, type, size, result = EXIT_SUCCESS;
+    AK_PRO;
+
+    if (AK_btree_get_meta(index, &meta) == EXIT_SUCCESS) {
+        position = meta.position;
+        attributes = meta.attributes;
+    } else if (AK_hash_get_meta(index, &hash_meta) == EXIT_SUCCESS) {
+        position = hash_meta.position;
+        attributes = hash_meta.attributes;
+        hash = 1;
+    }
+    if (position != NULL) {
+        key = (struct list_node *) AK_malloc(sizeof (struct list_node));
+        AK_Init_L3(&key);
+        for (i = 0; i < attributes && (data = AK_row_get(row, position[i], &type, &size)) != NULL; i++)
+            AK_InsertAtEnd_L3(type, data, size, key);
+        if (i < attributes)
+            result = EXIT_ERROR;
+        else if (hash)
+            result = insert ? AK_hash_insert(index, key, rid) : AK_hash_delete_key(index, key, rid);
+        else
+            result = insert ? AK_btree_insert(index, key, rid) : AK_btree_delete_key(index, key, rid);
+        AK_DeleteAll_L3(&key);
+        AK_free(key);
+    } else if (AK_roaring_get_meta(index, &roaring_meta) == EXIT_SUCCESS) {
+        if ((data = AK_row_get(row, roaring_meta.position, &type, &size)) == NULL)
+            result = EXIT_ERROR;
+        else if (insert)
+            result = AK_roaring_insert(index, type, data, size, rid);
+        else
+            result = AK_roaring_delete_row(index, type, data, size, rid);
+    } else {
+        //a bitmap index is named by its table and attribute, see AK_create_Index_Table
+        for (i = 0; i < row->num_attr; i++) {
+            snprintf(name, sizeof(name), "%s%s_bmapIndex", table, row->header[i].att_name);
+            if (strcmp(name, index) == 0) {
+                if (insert)
+                    result = AK_bitmap_insert_row(table, row->header[i].att_name, row, i, rid);
+                else
+                    result = AK_bitmap_delete_row(table, row->header[i].att_name, row->num_attr, rid);
+                break;
+            }
+        }
+    }
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @author agent
+ * @brief  Function that adds a new row of a table to every index of the table, see AK_catalog_get_indexes. If one
+ * index can not take the row, the row is removed from the indexes it was added to.
+ * @param table table name
+ * @param row values of the row
+ * @param rid RID of the row
+ * @return EXIT_SUCCESS, EXIT_ERROR if an index could not take the row
+ */
+int AK_index_insert_row(char *table, AK_row *row, AK_rid *rid) {
+    char indexes[AK_MAX_TABLE_INDEXES][MAX_ATT_NAME];
+    int count, i;
+    AK_PRO;
+    count = AK_catalog_get_indexes(table, indexes, AK_MAX_TABLE_INDEXES);
+    if (count > AK_MAX_TABLE_INDEXES)
+        count = AK_MAX_TABLE_INDEXES;
+    for (i = 0; i < count; i++) {
+        if (AK_index_apply(indexes[i], table, row, rid, 1) == EXIT_ERROR) {
+            printf("Row %d in block %d can not be added to index %s of table %s!\n", rid->slot, rid->block, indexes[i], table);
+            while (--i >= 0)
+                AK_index_apply(indexes[i], table, row, rid, 0);
+            AK_EPI;
+            return EXIT_ERROR;
+        }
+    }
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @author agent
+ * @brief  Function that removes a row of a table from every index of the table. If one index does not have the row,
+ *         the row is put back into the indexes it was already removed from
+ * @param table table name
+ * @param row values of the row
+ * @param rid RID of the row
+ * @return EXIT_SUCCESS, EXIT_ERROR if an index did not have the row
+ */
+int AK_index_delete_row(char *table, AK_row *row, AK_rid *rid) {
+    char indexes[AK_MAX_TABLE_INDEXES][MAX_ATT_NAME];
+    int count, i;
+    AK_PRO;
+    count = AK_catalog_get_indexes(table, indexes, AK_MAX_TABLE_INDEXES);
+    if (count > AK_MAX_TABLE_INDEXES)
+        count = AK_MAX_TABLE_INDEXES;
+    for (i = 0; i < count; i++) {
+        if (AK_index_apply(indexes[i], table, row, rid, 0) == EXIT_ERROR) {
+            printf("Row %d in block %d is not in index %s of table %s!\n", rid->slot, rid->block, indexes[i], table);
+            while (--i >= 0)
+                AK_index_apply(indexes[i], table, row, rid, 1);
+            AK_EPI;
+            return EXIT_ERROR;
+        }
+    }
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
 
 /**
  * @author Matija Šestak, modified for indexes by Lovro Predovan
@@ -25,6 +25,9 @@
 #include "../../file/fileio.h"
 #include "../../file/files.h"
 
+/// largest number of indexes of one table that row changes keep up to date
+#define AK_MAX_TABLE_INDEXES 64
+
 /**
   * @author Unknown
   * @struct struct_add
@@ -107,6 +110,36 @@ int AK_get_index_num_records(char *indexTblName);
  * */
 int AK_num_index_attr(char *indexTblName);
 
+/**
+ * @author Matija Šestak, modified for indexes by Lovro Predovan
+ * @brief  Function that gets index table header
+ * @param indexTblName index name
+ * @result array of table header, 0 if there is no such index
+ */
+AK_header *AK_get_index_header(char *indexTblName);
+
+/**
+ * @author agent
+ * @brief  Function that adds a new row of a table to every index of the table, see AK_catalog_get_indexes. If one
+ * index can not take the row, the row is removed from the indexes it was added to.
+ * @param table table name
+ * @param row values of the row
+ * @param rid RID of the row
+ * @return EXIT_SUCCESS, EXIT_ERROR if an index could not take the row
+ */
+int AK_index_insert_row(char *table, AK_row *row, AK_rid *rid);
+
+/**
+ * @author agent
+ * @brief  Function that removes a row of a table from every index of the table. If one index does not have the row,
+ * the row is put back into the indexes it was removed from.
+ * @param table table name
+ * @param row values of the row
+ * @param rid RID of the row
+ * @return EXIT_SUCCESS, EXIT_ERROR if an index did not have the row
+ */
+int AK_index_delete_row(char *table, AK_row *row, AK_rid *rid);
+
 struct list_node *AK_get_index_tuple(int row, int column, char *indexTblName);
 
 /**
@@ -0,0 +1,1533 @@
+/**
+@file roaring.c Provides functions for compressed bitmap indices
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#include "roaring.h"
+#include "../../rel/iterator.h"
+
+/// taken exclusively by functions that change a compressed bitmap index and shared by readers
+static pthread_rwlock_t AK_roaring_lock = PTHREAD_RWLOCK_INITIALIZER;
+
+//operations of AK_roaring_combine
+#define AK_ROARING_AND 0
+#define AK_ROARING_OR 1
+#define AK_ROARING_ANDNOT 2
+
+/// largest encoded value: a tag byte and the value
+#define AK_ROARING_MAX_KEY (1 + AK_ROARING_MAX_VALUE)
+
+/**
+ * @author agent
+ * @struct AK_roaring_list_page
+ * @brief Structure that defines the beginning of a value or directory page. A value page is followed by its entries:
+ * the length of the value (two bytes), the number of rows with the value, the first directory page of the value and
+ * the value. A directory page is followed by the keys and pages of the containers of a value, in the order of keys.
+ */
+typedef struct {
+    /// number of entries
+    int count;
+    /// next page of the list, 0 for the last one
+    int next;
+    /// number of bytes of the entries
+    int used;
+} AK_roaring_list_page;
+
+/**
+ * @author agent
+ * @struct AK_roaring_container_page
+ * @brief Structure that defines the beginning of a container page, it is followed by the array or the bitset
+ */
+typedef struct {
+    /// high bits of the row IDs
+    int key;
+    /// AK_ROARING_ARRAY or AK_ROARING_BITSET
+    int type;
+    /// number of row IDs
+    int cardinality;
+} AK_roaring_container_page;
+
+/**
+ * @author agent
+ * @struct AK_roaring_index
+ * @brief Structure that defines an index being used: its name and its first page
+ */
+typedef struct {
+    /// index name
+    char *name;
+    /// address of the first page
+    int address;
+    /// first page
+    AK_roaring_meta meta;
+} AK_roaring_index;
+
+/**
+ * @author agent
+ * @struct AK_roaring_value
+ * @brief Structure that defines where the entry of a value is and what it holds
+ */
+typedef struct {
+    /// value page of the entry, 0 if the value is not in the index
+    int address;
+    /// position of the entry in its page
+    int offset;
+    /// number of rows with the value
+    int rows;
+    /// first directory page of the value, 0 if it has no containers
+    int directory;
+} AK_roaring_value;
+
+/**
+ * @author agent
+ * @struct AK_roaring_directory
+ * @brief Structure that defines the directory of a value read from its pages
+ */
+typedef struct {
+    /// number of containers
+    int count;
+    /// number of containers the arrays have room for
+    int capacity;
+    /// keys of the containers
+    int *key;
+    /// pages of the containers
+    int *page;
+    /// pages of the directory
+    int *chain;
+    /// number of pages of the directory
+    int length;
+} AK_roaring_directory;
+
+/// number of bytes of a value entry before its value
+#define AK_ROARING_VALUE_ENTRY (sizeof(unsigned short) + 2 * sizeof(int))
+/// number of bytes of a value or directory page available to entries
+#define AK_ROARING_LIST_DATA ((int) (AK_ROARING_PAGE_SIZE - sizeof(AK_roaring_list_page)))
+/// number of containers on a directory page
+#define AK_ROARING_DIRECTORY_SIZE (AK_ROARING_LIST_DATA / (int) (2 * sizeof(int)))
+
+AK_roaring *AK_roaring_new()
+{
+    AK_roaring *bitmap;
+    AK_PRO;
+    bitmap = (AK_roaring *) AK_calloc(1, sizeof(AK_roaring));
+    AK_EPI;
+    return bitmap;
+}
+
+static void AK_roaring_container_free(AK_roaring_container *container)
+{
+    AK_free(container->array);
+    AK_free(container->words);
+    container->array = NULL;
+    container->words = NULL;
+}
+
+void AK_roaring_free(AK_roaring *bitmap)
+{
+    int i;
+    AK_PRO;
+    if (bitmap != NULL) {
+        for (i = 0; i < bitmap->count; i++)
+            AK_roaring_container_free(&bitmap->containers[i]);
+        AK_free(bitmap->containers);
+        AK_free(bitmap);
+    }
+    AK_EPI;
+}
+
+unsigned int AK_roaring_row_id(AK_rid *rid)
+{
+    return (unsigned int) rid->block * DATA_BLOCK_SIZE + (unsigned int) rid->slot;
+}
+
+static int AK_roaring_popcount(unsigned long long word)
+{
+    return __builtin_popcountll(word);
+}
+
+/**
+ * @author agent
+ * @brief  Function that finds a container of a bitmap by its key
+ * @param bitmap bitmap
+ * @param key key
+ * @param at receives the position of the container, or where it would be
+ * @return container, NULL if there is none with the key
+ */
+static AK_roaring_container *AK_roaring_find(AK_roaring *bitmap, int key, int *at)
+{
+    int low = 0, high = bitmap->count, middle;
+    while (low < high) {
+        middle = (low + high) / 2;
+        if (bitmap->containers[middle].key < key)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    *at = low;
+    return low < bitmap->count && bitmap->containers[low].key == key ? &bitmap->containers[low] : NULL;
+}
+
+/**
+ * @author agent
+ * @brief  Function that makes room for a container of a bitmap
+ * @param bitmap bitmap
+ * @param at position of the container
+ * @return container, an empty array container without key
+ */
+static AK_roaring_container *AK_roaring_insert_container(AK_roaring *bitmap, int at)
+{
+    if (bitmap->count == bitmap->capacity) {
+        bitmap->capacity = bitmap->capacity == 0 ? 4 : 2 * bitmap->capacity;
+        bitmap->containers = (AK_roaring_container *) AK_realloc(bitmap->containers, bitmap->capacity * sizeof(AK_roaring_container));
+    }
+    memmove(&bitmap->containers[at + 1], &bitmap->containers[at], (bitmap->count - at) * sizeof(AK_roaring_container));
+    bitmap->count++;
+    memset(&bitmap->containers[at], 0, sizeof(AK_roaring_container));
+    bitmap->containers[at].type = AK_ROARING_ARRAY;
+    return &bitmap->containers[at];
+}
+
+/**
+ * @author agent
+ * @brief  Function that adds a container at the end of a bitmap, empty containers are freed instead
+ * @param bitmap bitmap, its last key is below the key of the container
+ * @param container container, the bitmap takes its memory
+ */
+static void AK_roaring_append(AK_roaring *bitmap, AK_roaring_container *container)
+{
+    if (container->cardinality == 0) {
+        AK_roaring_container_free(container);
+        return;
+    }
+    *AK_roaring_insert_container(bitmap, bitmap->count) = *container;
+}
+
+static void AK_roaring_to_bitset(AK_roaring_container *container)
+{
+    int i;
+    container->words = (unsigned long long *) AK_calloc(AK_ROARING_WORDS, sizeof(unsigned long long));
+    for (i = 0; i < container->cardinality; i++)
+        container->words[container->array[i] >> 6] |= 1ULL << (container->array[i] & 63);
+    AK_free(container->array);
+    container->array = NULL;
+    container->type = AK_ROARING_BITSET;
+}
+
+static void AK_roaring_to_array(AK_roaring_container *container)
+{
+    unsigned long long word;
+    int i, n = 0;
+    container->array = (unsigned short *) AK_malloc((container->cardinality > 0 ? container->cardinality : 1) * sizeof(unsigned short));
+    for (i = 0; i < AK_ROARING_WORDS; i++)
+        for (word = container->words[i]; word != 0; word &= word - 1)
+            container->array[n++] = (unsigned short) (i * 64 + __builtin_ctzll(word));
+    AK_free(container->words);
+    container->words = NULL;
+    container->type = AK_ROARING_ARRAY;
+}
+
+/**
+ * @author agent
+ * @brief  Function that finds the low bits of a row ID in an array container
+ * @param container array container
+ * @param low low bits
+ * @param at receives the position of the row ID, or where it would be
+ * @return 1 if it is there, 0 otherwise
+ */
+static int AK_roaring_array_find(AK_roaring_container *container, unsigned short low, int *at)
+{
+    int first = 0, last = container->cardinality, middle;
+    //row IDs usually come in ascending order
+    if (last > 0 && container->array[last - 1] < low) {
+        *at = last;
+        return 0;
+    }
+    while (first < last) {
+        middle = (first + last) / 2;
+        if (container->array[middle] < low)
+            first = middle + 1;
+        else
+            last = middle;
+    }
+    *at = first;
+    return first < container->cardinality && container->array[first] == low;
+}
+
+static int AK_roaring_container_add(AK_roaring_container *container, unsigned short low)
+{
+    int at;
+    if (container->type == AK_ROARING_BITSET) {
+        if (container->words[low >> 6] & (1ULL << (low & 63)))
+            return 0;
+        container->words[low >> 6] |= 1ULL << (low & 63);
+        container->cardinality++;
+        return 1;
+    }
+    if (AK_roaring_array_find(container, low, &at))
+        return 0;
+    if (container->cardinality == AK_ROARING_ARRAY_MAX) {
+        AK_roaring_to_bitset(container);
+        return AK_roaring_container_add(container, low);
+    }
+    container->array = (unsigned short *) AK_realloc(container->array, (container->cardinality + 1) * sizeof(unsigned short));
+    memmove(&container->array[at + 1], &container->array[at], (container->cardinality - at) * sizeof(unsigned short));
+    container->array[at] = low;
+    container->cardinality++;
+    return 1;
+}
+
+static int AK_roaring_container_remove(AK_roaring_container *container, unsigned short low)
+{
+    int at;
+    if (container->type == AK_ROARING_BITSET) {
+        if (!(container->words[low >> 6] & (1ULL << (low & 63))))
+            return 0;
+        container->words[low >> 6] &= ~(1ULL << (low & 63));
+        if (--container->cardinality <= AK_ROARING_ARRAY_MAX)
+            AK_roaring_to_array(container);
+        return 1;
+    }
+    if (!AK_roaring_array_find(container, low, &at))
+        return 0;
+    memmove(&container->array[at], &container->array[at + 1], (container->cardinality - at - 1) * sizeof(unsigned short));
+    container->cardinality--;
+    return 1;
+}
+
+static int AK_roaring_container_contains(AK_roaring_container *container, unsigned short low)
+{
+    int at;
+    if (container->type == AK_ROARING_BITSET)
+        return (container->words[low >> 6] >> (low & 63)) & 1;
+    return AK_roaring_array_find(container, low, &at);
+}
+
+int AK_roaring_add(AK_roaring *bitmap, unsigned int id)
+{
+    AK_roaring_container *container;
+    int at, result;
+    AK_PRO;
+    container = AK_roaring_find(bitmap, id >> AK_ROARING_BITS, &at);
+    if (container == NULL) {
+        container = AK_roaring_insert_container(bitmap, at);
+        container->key = id >> AK_ROARING_BITS;
+    }
+    result = AK_roaring_container_add(container, id & (AK_ROARING_SPAN - 1));
+    AK_EPI;
+    return result;
+}
+
+int AK_roaring_remove(AK_roaring *bitmap, unsigned int id)
+{
+    AK_roaring_container *container;
+    int at, result = 0;
+    AK_PRO;
+    container = AK_roaring_find(bitmap, id >> AK_ROARING_BITS, &at);
+    if (container != NULL && (result = AK_roaring_container_remove(container, id & (AK_ROARING_SPAN - 1))) && container->cardinality == 0) {
+        AK_roaring_container_free(container);
+        memmove(&bitmap->containers[at], &bitmap->containers[at + 1], (bitmap->count - at - 1) * sizeof(AK_roaring_container));
+        bitmap->count--;
+    }
+    AK_EPI;
+    return result;
+}
+
+int AK_roaring_contains(AK_roaring *bitmap, unsigned int id)
+{
+    AK_roaring_container *container;
+    int at, result;
+    AK_PRO;
+    container = AK_roaring_find(bitmap, id >> AK_ROARING_BITS, &at);
+    result = container != NULL && AK_roaring_container_contains(container, id & (AK_ROARING_SPAN - 1));
+    AK_EPI;
+    return result;
+}
+
+int AK_roaring_cardinality(AK_roaring *bitmap)
+{
+    int i, count = 0;
+    AK_PRO;
+    for (i = 0; bitmap != NULL && i < bitmap->count; i++)
+        count += bitmap->containers[i].cardinality;
+    AK_EPI;
+    return count;
+}
+
+static void AK_roaring_copy_container(AK_roaring_container *to, AK_roaring_container *from)
+{
+    *to = *from;
+    if (from->type == AK_ROARING_BITSET) {
+        to->words = (unsigned long long *) AK_malloc(AK_ROARING_WORDS * sizeof(unsigned long long));
+        memcpy(to->words, from->words, AK_ROARING_WORDS * sizeof(unsigned long long));
+    } else {
+        to->array = (unsigned short *) AK_malloc((from->cardinality > 0 ? from->cardinality : 1) * sizeof(unsigned short));
+        memcpy(to->array, from->array, from->cardinality * sizeof(unsigned short));
+    }
+}
+
+/**
+ * @author agent
+ * @brief  Function that combines two containers with the same key. Two arrays are merged; otherwise arrays are spread
+ * into bitsets, the words are combined and counted, and a result small enough becomes an array. An array intersected
+ * with a bitset is filtered by it instead.
+ * @param a first container
+ * @param b second container
+ * @param operation AK_ROARING_AND, AK_ROARING_OR or AK_ROARING_ANDNOT
+ * @param result receives the combined container
+ */
+static void AK_roaring_combine_containers(AK_roaring_container *a, AK_roaring_container *b, int operation, AK_roaring_container *result)
+{
+    unsigned long long *words[2], word;
+    AK_roaring_container *pair[2] = {a, b}, *array, *bitset;
+    int i = 0, j = 0, k, n = 0, take;
+
+    memset(result, 0, sizeof(AK_roaring_container));
+    result->key = a->key;
+    if (a->type == AK_ROARING_ARRAY && b->type == AK_ROARING_ARRAY) {
+        result->type = AK_ROARING_ARRAY;
+        result->array = (unsigned short *) AK_malloc((a->cardinality + b->cardinality + 1) * sizeof(unsigned short));
+        while (i < a->cardinality || j < b->cardinality) {
+            if (j == b->cardinality || (i < a->cardinality && a->array[i] < b->array[j]))
+                take = operation != AK_ROARING_AND ? a->array[i] : -1, i++;
+            else if (i == a->cardinality || b->array[j] < a->array[i])
+                take = operation == AK_ROARING_OR ? b->array[j] : -1, j++;
+            else
+                take = operation != AK_ROARING_ANDNOT ? a->array[i] : -1, i++, j++;
+            if (take >= 0)
+                result->array[n++] = (unsigned short) take;
+        }
+        result->cardinality = n;
+        if (n > AK_ROARING_ARRAY_MAX)
+            AK_roaring_to_bitset(result);
+        return;
+    }
+    if (operation != AK_ROARING_OR && (a->type == AK_ROARING_ARRAY || (operation == AK_ROARING_AND && b->type == AK_ROARING_ARRAY))) {
+        array = a->type == AK_ROARING_ARRAY ? a : b;
+        bitset = array == a ? b : a;
+        result->type = AK_ROARING_ARRAY;
+        result->array = (unsigned short *) AK_malloc((array->cardinality + 1) * sizeof(unsigned short));
+        for (i = 0; i < array->cardinality; i++)
+            if (AK_roaring_container_contains(bitset, array->array[i]) == (operation == AK_ROARING_AND))
+                result->array[n++] = array->array[i];
+        result->cardinality = n;
+        return;
+    }
+    for (k = 0; k < 2; k++) {
+        words[k] = pair[k]->words;
+        if (pair[k]->type == AK_ROARING_ARRAY) {
+            words[k] = (unsigned long long *) AK_calloc(AK_ROARING_WORDS, sizeof(unsigned long long));
+            for (i = 0; i < pair[k]->cardinality; i++)
+                words[k][pair[k]->array[i] >> 6] |= 1ULL << (pair[k]->array[i] & 63);
+        }
+    }
+    result->type = AK_ROARING_BITSET;
+    result->words = (unsigned long long *) AK_malloc(AK_ROARING_WORDS * sizeof(unsigned long long));
+    for (i = 0; i < AK_ROARING_WORDS; i++) {
+        word = operation == AK_ROARING_AND ? words[0][i] & words[1][i]
+               : operation == AK_ROARING_OR ? words[0][i] | words[1][i] : words[0][i] & ~words[1][i];
+        result->words[i] = word;
+        n += AK_roaring_popcount(word);
+    }
+    result->cardinality = n;
+    for (k = 0; k < 2; k++)
+        if (words[k] != pair[k]->words)
+            AK_free(words[k]);
+    if (n <= AK_ROARING_ARRAY_MAX)
+        AK_roaring_to_array(result);
+}
+
+/**
+ * @author agent
+ * @brief  Function that combines two bitmaps, containers with the same key are combined and the others are copied or
+ * left out as the operation says
+ * @param a first bitmap
+ * @param b second bitmap
+ * @param operation AK_ROARING_AND, AK_ROARING_OR or AK_ROARING_ANDNOT
+ * @return new bitmap
+ */
+static AK_roaring *AK_roaring_combine(AK_roaring *a, AK_roaring *b, int operation)
+{
+    AK_roaring *result = AK_roaring_new();
+    AK_roaring_container container;
+    int i = 0, j = 0;
+
+    while (i < a->count || j < b->count) {
+        if (j == b->count || (i < a->count && a->containers[i].key < b->containers[j].key)) {
+            if (operation != AK_ROARING_AND) {
+                AK_roaring_copy_container(&container, &a->containers[i]);
+                AK_roaring_append(result, &container);
+            }
+            i++;
+        } else if (i == a->count || b->containers[j].key < a->containers[i].key) {
+            if (operation == AK_ROARING_OR) {
+                AK_roaring_copy_container(&container, &b->containers[j]);
+                AK_roaring_append(result, &container);
+            }
+            j++;
+        } else {
+            AK_roaring_combine_containers(&a->containers[i++], &b->containers[j++], operation, &container);
+            AK_roaring_append(result, &container);
+        }
+    }
+    return result;
+}
+
+AK_roaring *AK_roaring_and(AK_roaring *a, AK_roaring *b)
+{
+    AK_roaring *result;
+    AK_PRO;
+    result = AK_roaring_combine(a, b, AK_ROARING_AND);
+    AK_EPI;
+    return result;
+}
+
+AK_roaring *AK_roaring_or(AK_roaring *a, AK_roaring *b)
+{
+    AK_roaring *result;
+    AK_PRO;
+    result = AK_roaring_combine(a, b, AK_ROARING_OR);
+    AK_EPI;
+    return result;
+}
+
+AK_roaring *AK_roaring_andnot(AK_roaring *a, AK_roaring *b)
+{
+    AK_roaring *result;
+    AK_PRO;
+    result = AK_roaring_combine(a, b, AK_ROARING_ANDNOT);
+    AK_EPI;
+    return result;
+}
+
+AK_rid *AK_roaring_rids(AK_roaring *bitmap, int *count)
+{
+    AK_roaring_container *container;
+    AK_rid *rids;
+    unsigned long long word;
+    unsigned int id;
+    int i, j, n = 0;
+    AK_PRO;
+    *count = AK_roaring_cardinality(bitmap);
+    if (*count == 0) {
+        AK_EPI;
+        return NULL;
+    }
+    rids = (AK_rid *) AK_malloc(*count * sizeof(AK_rid));
+    for (i = 0; i < bitmap->count; i++) {
+        container = &bitmap->containers[i];
+        for (j = 0; j < (container->type == AK_ROARING_ARRAY ? container->cardinality : AK_ROARING_WORDS); j++) {
+            word = container->type == AK_ROARING_ARRAY ? 1 : container->words[j];
+            for (; word != 0; word &= word - 1) {
+                id = ((unsigned int) container->key << AK_ROARING_BITS)
+                     + (container->type == AK_ROARING_ARRAY ? container->array[j] : j * 64 + __builtin_ctzll(word));
+                rids[n].block = id / DATA_BLOCK_SIZE;
+                rids[n++].slot = id % DATA_BLOCK_SIZE;
+            }
+        }
+    }
+    AK_EPI;
+    return rids;
+}
+
+/**
+ * @author agent
+ * @brief  Function that checks whether a compressed bitmap index can have an attribute of a type
+ * @param type attribute type
+ * @return 1 if it can, 0 otherwise
+ */
+static int AK_roaring_supported(int type)
+{
+    switch (type) {
+        case TYPE_INT:
+        case TYPE_DATE:
+        case TYPE_DATETIME:
+        case TYPE_TIME:
+        case TYPE_INTERVAL:
+        case TYPE_PERIOD:
+        case TYPE_FLOAT:
+        case TYPE_NUMBER:
+        case TYPE_BOOL:
+        case TYPE_VARCHAR:
+            return 1;
+    }
+    return 0;
+}
+
+/**
+ * @author agent
+ * @brief  Function that encodes a value so that equal values give equal bytes. A tag byte tells NULL (stored as the
+ * varchar "null") from values, floating point numbers are written as doubles with -0.0 turned into 0.0.
+ * @param type type of the indexed attribute
+ * @param value_type type of the value
+ * @param value bytes of the value
+ * @param size number of bytes of the value
+ * @param key receives the encoded value, AK_ROARING_MAX_KEY bytes
+ * @return number of bytes of the encoded value, EXIT_ERROR if the value has another type or is too long
+ */
+static int AK_roaring_encode(int type, int value_type, const unsigned char *value, int size, unsigned char *key)
+{
+    double number;
+    float real;
+
+    if (value_type == TYPE_VARCHAR && type != TYPE_VARCHAR && size == 4 && memcmp(value, "null", 4) == 0) {
+        key[0] = 0;
+        return 1;
+    }
+    key[0] = 1;
+    switch (type) {
+        case TYPE_INT:
+        case TYPE_DATE:
+        case TYPE_DATETIME:
+        case TYPE_TIME:
+        case TYPE_INTERVAL:
+        case TYPE_PERIOD:
+            if (value_type == TYPE_VARCHAR || value_type == TYPE_FLOAT || value_type == TYPE_NUMBER || value_type == TYPE_BOOL || size != sizeof(int))
+                return EXIT_ERROR;
+            memcpy(key + 1, value, sizeof(int));
+            return 1 + sizeof(int);
+        case TYPE_FLOAT:
+        case TYPE_NUMBER:
+            if (value_type != TYPE_FLOAT && value_type != TYPE_NUMBER)
+                return EXIT_ERROR;
+            if (size == sizeof(float)) {
+                memcpy(&real, value, sizeof(float));
+                number = real;
+            } else if (size == sizeof(double))
+                memcpy(&number, value, sizeof(double));
+            else
+                return EXIT_ERROR;
+            if (number == 0)
+                number = 0;
+            memcpy(key + 1, &number, sizeof(double));
+            return 1 + sizeof(double);
+        case TYPE_BOOL:
+            if (value_type != TYPE_BOOL || size != 1)
+                return EXIT_ERROR;
+            key[1] = value[0];
+            return 2;
+        case TYPE_VARCHAR:
+            if (value_type != TYPE_VARCHAR || size > AK_ROARING_MAX_VALUE)
+                return EXIT_ERROR;
+            memcpy(key + 1, value, size);
+            return 1 + size;
+    }
+    return EXIT_ERROR;
+}
+
+/**
+ * @author agent
+ * @brief  Function that reads the first page of an index
+ * @param indexName index name
+ * @param index receives the address and the content of the first page
+ * @return EXIT_SUCCESS, EXIT_ERROR if there is no such compressed bitmap index
+ */
+static int AK_roaring_open_index(char *indexName, AK_roaring_index *index)
+{
+    table_addresses *addresses = (table_addresses *) AK_get_index_addresses(indexName);
+    AK_block *block;
+
+    index->name = indexName;
+    index->address = addresses->address_from[0];
+    AK_free(addresses);
+    if (index->address == 0)
+        return EXIT_ERROR;
+    block = ((AK_mem_block *) AK_get_block(index->address))->block;
+    if (block->tuple_dict[0].type != ROARING_META_PAGE)
+        return EXIT_ERROR;
+    memcpy(&index->meta, block->data, sizeof(AK_roaring_meta));
+    return EXIT_SUCCESS;
+}
+
+static void AK_roaring_write_meta(AK_roaring_index *index)
+{
+    AK_mem_block *mem_block = (AK_mem_block *) AK_get_block(index->address);
+    memcpy(mem_block->block->data, &index->meta, sizeof(AK_roaring_meta));
+    mem_block->block->tuple_dict[0].type = ROARING_META_PAGE;
+    mem_block->block->tuple_dict[0].address = 0;
+    mem_block->block->tuple_dict[0].size = sizeof(AK_roaring_meta);
+    mem_block->block->AK_free_space = sizeof(AK_roaring_meta);
+    mem_block->block->last_tuple_dict_id = 0;
+    AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+}
+
+/**
+ * @author agent
+ * @brief  Function that takes a page: a freed page if there is one, otherwise the page after the last page taken from
+ * the extents of the index. A new extent is added when they are used up.
+ * @param index index
+ * @return address of the page, EXIT_ERROR if no extent can be added
+ */
+static int AK_roaring_alloc_page(AK_roaring_index *index)
+{
+    table_addresses *addresses;
+    int i, address = 0;
+
+    if (index->meta.free_page != 0) {
+        address = index->meta.free_page;
+        index->meta.free_page = ((AK_roaring_list_page *) ((AK_mem_block *) AK_get_block(address))->block->data)->next;
+        index->meta.pages++;
+        return address;
+    }
+    addresses = (table_addresses *) AK_get_index_addresses(index->name);
+    for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0; i++) {
+        if (index->meta.last_page >= addresses->address_from[i] && index->meta.last_page < addresses->address_to[i]) {
+            if (index->meta.last_page + 1 < addresses->address_to[i])
+                address = index->meta.last_page + 1;
+            else if (i + 1 < MAX_EXTENTS_IN_SEGMENT)
+                address = addresses->address_from[i + 1];
+            break;
+        }
+    }
+    AK_free(addresses);
+    if (address == 0)
+        address = AK_init_new_extent(index->name, SEGMENT_TYPE_INDEX);
+    if (address == EXIT_ERROR || address == 0) {
+        printf("AK_roaring_alloc_page: index %s can not grow!\n", index->name);
+        return EXIT_ERROR;
+    }
+    index->meta.last_page = address;
+    index->meta.pages++;
+    return address;
+}
+
+static void AK_roaring_free_page(AK_roaring_index *index, int address)
+{
+    AK_mem_block *mem_block = (AK_mem_block *) AK_get_block(address);
+    AK_roaring_list_page page;
+
+    memset(&page, 0, sizeof(AK_roaring_list_page));
+    page.next = index->meta.free_page;
+    memcpy(mem_block->block->data, &page, sizeof(AK_roaring_list_page));
+    mem_block->block->tuple_dict[0].type = ROARING_FREE_PAGE;
+    mem_block->block->tuple_dict[0].size = sizeof(AK_roaring_list_page);
+    AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+    index->meta.free_page = address;
+    index->meta.pages--;
+}
+
+/**
+ * @author agent
+ * @brief  Function that writes a value or directory page
+ * @param address address of the page
+ * @param type ROARING_VALUE_PAGE or ROARING_DIRECTORY_PAGE
+ * @param page beginning of the page
+ * @param entries entries of the page, page->used bytes; NULL to keep those on the page
+ */
+static void AK_roaring_write_list_page(int address, int type, AK_roaring_list_page *page, const unsigned char *entries)
+{
+    AK_mem_block *mem_block = (AK_mem_block *) AK_get_block(address);
+    AK_block *block = mem_block->block;
+    memcpy(block->data, page, sizeof(AK_roaring_list_page));
+    if (entries != NULL && page->used > 0)
+        memmove(block->data + sizeof(AK_roaring_list_page), entries, page->used);
+    block->tuple_dict[0].type = type;
+    block->tuple_dict[0].address = 0;
+    block->tuple_dict[0].size = sizeof(AK_roaring_list_page) + page->used;
+    block->AK_free_space = sizeof(AK_roaring_list_page) + page->used;
+    block->last_tuple_dict_id = 0;
+    AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+}
+
+/**
+ * @author agent
+ * @brief  Function that finds the entry of a value in the value pages
+ * @param index index
+ * @param key encoded value
+ * @param size number of bytes of the encoded value
+ * @param value receives the entry, its address is 0 if the value is not in the index
+ */
+static void AK_roaring_find_value(AK_roaring_index *index, const unsigned char *key, int size, AK_roaring_value *value)
+{
+    AK_block *block;
+    AK_roaring_list_page *page;
+    unsigned char *entry;
+    unsigned short length;
+    int address, i;
+
+    memset(value, 0, sizeof(AK_roaring_value));
+    for (address = index->meta.first_value; address != 0; address = page->next) {
+        block = ((AK_mem_block *) AK_get_block(address))->block;
+        page = (AK_roaring_list_page *) block->data;
+        entry = block->data + sizeof(AK_roaring_list_page);
+        for (i = 0; i < page->count; i++, entry += AK_ROARING_VALUE_ENTRY + length) {
+            memcpy(&length, entry, sizeof(unsigned short));
+            if (length == size && memcmp(entry + AK_ROARING_VALUE_ENTRY, key, size) == 0) {
+                value->address = address;
+                value->offset = entry - block->data;
+                memcpy(&value->rows, entry + sizeof(unsigned short), sizeof(int));
+                memcpy(&value->directory, entry + sizeof(unsigned short) + sizeof(int), sizeof(int));
+                return;
+            }
+        }
+    }
+}
+
+/**
+ * @author agent
+ * @brief  Function that adds the entry of a value without rows, to the first value page with room for it
+ * @param index index
+ * @param key encoded value
+ * @param size number of bytes of the encoded value
+ * @param value receives the entry
+ * @return EXIT_SUCCESS, EXIT_ERROR if the index can not grow
+ */
+static int AK_roaring_add_value(AK_roaring_index *index, const unsigned char *key, int size, AK_roaring_value *value)
+{
+    AK_mem_block *mem_block;
+    AK_roaring_list_page *page, empty;
+    unsigned short length = size;
+    int address, last = 0, room = 0, entry_size = AK_ROARING_VALUE_ENTRY + size;
+    unsigned char *entry;
+
+    for (address = index->meta.first_value; address != 0 && room == 0; address = page->next) {
+        page = (AK_roaring_list_page *) ((AK_mem_block *) AK_get_block(address))->block->data;
+        if (page->used + entry_size <= AK_ROARING_LIST_DATA)
+            room = address;
+        last = address;
+    }
+    if (room == 0) {
+        if ((room = AK_roaring_alloc_page(index)) == EXIT_ERROR)
+            return EXIT_ERROR;
+        memset(&empty, 0, sizeof(AK_roaring_list_page));
+        AK_roaring_write_list_page(room, ROARING_VALUE_PAGE, &empty, NULL);
+        if (last == 0)
+            index->meta.first_value = room;
+        else {
+            mem_block = (AK_mem_block *) AK_get_block(last);
+            ((AK_roaring_list_page *) mem_block->block->data)->next = room;
+            AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+        }
+    }
+    mem_block = (AK_mem_block *) AK_get_block(room);
+    page = (AK_roaring_list_page *) mem_block->block->data;
+    entry = mem_block->block->data + sizeof(AK_roaring_list_page) + page->used;
+    memset(value, 0, sizeof(AK_roaring_value));
+    value->address = room;
+    value->offset = entry - mem_block->block->data;
+    memcpy(entry, &length, sizeof(unsigned short));
+    memset(entry + sizeof(unsigned short), 0, 2 * sizeof(int));
+    memcpy(entry + AK_ROARING_VALUE_ENTRY, key, size);
+    page->used += entry_size;
+    page->count++;
+    AK_roaring_write_list_page(room, ROARING_VALUE_PAGE, page, NULL);
+    index->meta.values++;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @author agent
+ * @brief  Function that writes the number of rows and the directory of a value to its entry. A value without rows
+ * leaves its value page.
+ * @param index index
+ * @param value entry
+ */
+static void AK_roaring_write_value(AK_roaring_index *index, AK_roaring_value *value)
+{
+    AK_mem_block *mem_block = (AK_mem_block *) AK_get_block(value->address);
+    AK_roaring_list_page *page = (AK_roaring_list_page *) mem_block->block->data;
+    unsigned char *entry = mem_block->block->data + value->offset;
+    unsigned short length;
+    int entry_size;
+
+    if (value->rows > 0) {
+        memcpy(entry + sizeof(unsigned short), &value->rows, sizeof(int));
+        memcpy(entry + sizeof(unsigned short) + sizeof(int), &value->directory, sizeof(int));
+    } else {
+        memcpy(&length, entry, sizeof(unsigned short));
+        entry_size = AK_ROARING_VALUE_ENTRY + length;
+        memmove(entry, entry + entry_size, sizeof(AK_roaring_list_page) + page->used - value->offset - entry_size);
+        page->used -= entry_size;
+        page->count--;
+        index->meta.values--;
+    }
+    AK_roaring_write_list_page(value->address, ROARING_VALUE_PAGE, page, NULL);
+}
+
+static void AK_roaring_directory_free(AK_roaring_directory *directory)
+{
+    AK_free(directory->key);
+    AK_free(directory->page);
+    AK_free(directory->chain);
+    memset(directory, 0, sizeof(AK_roaring_directory));
+}
+
+/**
+ * @author agent
+ * @brief  Function that reads the directory of a value
+ * @param address first directory page, 0 for none
+ * @param directory receives the directory, it has to be freed with AK_roaring_directory_free
+ */
+static void AK_roaring_read_directory(int address, AK_roaring_directory *directory)
+{
+    AK_block *block;
+    AK_roaring_list_page *page;
+    int i;
+
+    memset(directory, 0, sizeof(AK_roaring_directory));
+    for (; address != 0; address = page->next) {
+        block = ((AK_mem_block *) AK_get_block(address))->block;
+        page = (AK_roaring_list_page *) block->data;
+        directory->chain = (int *) AK_realloc(directory->chain, (directory->length + 1) * sizeof(int));
+        directory->chain[directory->length++] = address;
+        if (directory->count + page->count > directory->capacity) {
+            directory->capacity = 2 * (directory->count + page->count);
+            directory->key = (int *) AK_realloc(directory->key, directory->capacity * sizeof(int));
+            directory->page = (int *) AK_realloc(directory->page, directory->capacity * sizeof(int));
+        }
+        for (i = 0; i < page->count; i++, directory->count++) {
+            memcpy(&directory->key[directory->count], block->data + sizeof(AK_roaring_list_page) + 2 * i * sizeof(int), sizeof(int));
+            memcpy(&directory->page[directory->count], block->data + sizeof(AK_roaring_list_page) + (2 * i + 1) * sizeof(int), sizeof(int));
+        }
+    }
+}
+
+/**
+ * @author agent
+ * @brief  Function that writes the directory of a value to its pages, adding pages when they are used up and freeing
+ * pages left over
+ * @param index index
+ * @param directory directory
+ * @return first directory page, 0 for an empty directory, EXIT_ERROR if the index can not grow
+ */
+static int AK_roaring_write_directory(AK_roaring_index *index, AK_roaring_directory *directory)
+{
+    AK_roaring_list_page page;
+    unsigned char entries[AK_ROARING_PAGE_SIZE];
+    int i = 0, at = 0, n, first, address;
+
+    if (directory->count == 0) {
+        for (i = 0; i < directory->length; i++)
+            AK_roaring_free_page(index, directory->chain[i]);
+        return 0;
+    }
+    address = directory->length > 0 ? directory->chain[0] : AK_roaring_alloc_page(index);
+    first = address;
+    while (address != EXIT_ERROR) {
+        memset(&page, 0, sizeof(AK_roaring_list_page));
+        for (n = 0; n < AK_ROARING_DIRECTORY_SIZE && at < directory->count; n++, at++) {
+            memcpy(entries + 2 * n * sizeof(int), &directory->key[at], sizeof(int));
+            memcpy(entries + (2 * n + 1) * sizeof(int), &directory->page[at], sizeof(int));
+        }
+        page.count = n;
+        page.used = 2 * n * sizeof(int);
+        if (at < directory->count)
+            page.next = i + 1 < directory->length ? directory->chain[i + 1] : AK_roaring_alloc_page(index);
+        if (page.next == EXIT_ERROR)
+            return EXIT_ERROR;
+        AK_roaring_write_list_page(address, ROARING_DIRECTORY_PAGE, &page, entries);
+        i++;
+        if (page.next == 0)
+            break;
+        address = page.next;
+    }
+    if (address == EXIT_ERROR)
+        return EXIT_ERROR;
+    for (; i < directory->length; i++)
+        AK_roaring_free_page(index, directory->chain[i]);
+    return first;
+}
+
+static void AK_roaring_read_container(int address, AK_roaring_container *container)
+{
+    AK_block *block = ((AK_mem_block *) AK_get_block(address))->block;
+    AK_roaring_container_page page;
+
+    memcpy(&page, block->data, sizeof(AK_roaring_container_page));
+    memset(container, 0, sizeof(AK_roaring_container));
+    container->key = page.key;
+    container->type = page.type;
+    container->cardinality = page.cardinality;
+    if (page.type == AK_ROARING_BITSET) {
+        container->words = (unsigned long long *) AK_malloc(AK_ROARING_WORDS * sizeof(unsigned long long));
+        memcpy(container->words, block->data + sizeof(AK_roaring_container_page), AK_ROARING_WORDS * sizeof(unsigned long long));
+    } else {
+        container->array = (unsigned short *) AK_malloc((page.cardinality > 0 ? page.cardinality : 1) * sizeof(unsigned short));
+        memcpy(container->array, block->data + sizeof(AK_roaring_container_page), page.cardinality * sizeof(unsigned short));
+    }
+}
+
+static void AK_roaring_write_container(int address, AK_roaring_container *container)
+{
+    AK_mem_block *mem_block = (AK_mem_block *) AK_get_block(address);
+    AK_block *block = mem_block->block;
+    AK_roaring_container_page page;
+    int size = container->type == AK_ROARING_BITSET ? AK_ROARING_WORDS * sizeof(unsigned long long) : container->cardinality * sizeof(unsigned short);
+
+    page.key = container->key;
+    page.type = container->type;
+    page.cardinality = container->cardinality;
+    memcpy(block->data, &page, sizeof(AK_roaring_container_page));
+    memcpy(block->data + sizeof(AK_roaring_container_page), container->type == AK_ROARING_BITSET ? (void *) container->words : (void *) container->array, size);
+    block->tuple_dict[0].type = ROARING_CONTAINER_PAGE;
+    block->tuple_dict[0].address = 0;
+    block->tuple_dict[0].size = sizeof(AK_roaring_container_page) + size;
+    block->AK_free_space = sizeof(AK_roaring_container_page) + size;
+    block->last_tuple_dict_id = 0;
+    AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+}
+
+/**
+ * @author agent
+ * @brief  Function that adds or removes a row ID in the bitmap of a value: only the container of the row ID and, when
+ * a container comes or goes, the directory are written
+ * @param index index
+ * @param key encoded value
+ * @param size number of bytes of the encoded value
+ * @param id row ID
+ * @param insert 1 to add the row ID, 0 to remove it
+ * @return EXIT_SUCCESS, EXIT_ERROR if the row ID is already there when it is added or not there when it is removed
+ */
+static int AK_roaring_change(AK_roaring_index *index, const unsigned char *key, int size, unsigned int id, int insert)
+{
+    AK_roaring_value value;
+    AK_roaring_directory directory;
+    AK_roaring_container container;
+    int low = 0, high, middle, address, result = EXIT_SUCCESS;
+    int container_key = id >> AK_ROARING_BITS;
+
+    AK_roaring_find_value(index, key, size, &value);
+    if (value.address == 0 && (!insert || AK_roaring_add_value(index, key, size, &value) == EXIT_ERROR))
+        return EXIT_ERROR;
+    AK_roaring_read_directory(value.directory, &directory);
+    high = directory.count;
+    while (low < high) {
+        middle = (low + high) / 2;
+        if (directory.key[middle] < container_key)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    if (low < directory.count && directory.key[low] == container_key) {
+        AK_roaring_read_container(directory.page[low], &container);
+        if (!(insert ? AK_roaring_container_add(&container, id & (AK_ROARING_SPAN - 1))
+                     : AK_roaring_container_remove(&container, id & (AK_ROARING_SPAN - 1))))
+            result = EXIT_ERROR;
+        else if (container.cardinality > 0)
+            AK_roaring_write_container(directory.page[low], &container);
+        else {
+            //an emptied container leaves the directory
+            AK_roaring_free_page(index, directory.page[low]);
+            memmove(&directory.key[low], &directory.key[low + 1], (directory.count - low - 1) * sizeof(int));
+            memmove(&directory.page[low], &directory.page[low + 1], (directory.count - low - 1) * sizeof(int));
+            directory.count--;
+            value.directory = AK_roaring_write_directory(index, &directory);
+        }
+        AK_roaring_container_free(&container);
+    } else if (!insert || (address = AK_roaring_alloc_page(index)) == EXIT_ERROR)
+        result = EXIT_ERROR;
+    else {
+        memset(&container, 0, sizeof(AK_roaring_container));
+        container.key = container_key;
+        container.type = AK_ROARING_ARRAY;
+        AK_roaring_container_add(&container, id & (AK_ROARING_SPAN - 1));
+        AK_roaring_write_container(address, &container);
+        AK_roaring_container_free(&container);
+        if (directory.count == directory.capacity) {
+            directory.capacity = directory.capacity == 0 ? 4 : 2 * directory.capacity;
+            directory.key = (int *) AK_realloc(directory.key, directory.capacity * sizeof(int));
+            directory.page = (int *) AK_realloc(directory.page, directory.capacity * sizeof(int));
+        }
+        memmove(&directory.key[low + 1], &directory.key[low], (directory.count - low) * sizeof(int));
+        memmove(&directory.page[low + 1], &directory.page[low], (directory.count - low) * sizeof(int));
+        directory.key[low] = container_key;
+        directory.page[low] = address;
+        directory.count++;
+        value.directory = AK_roaring_write_directory(index, &directory);
+        if (value.directory == EXIT_ERROR)
+            result = EXIT_ERROR;
+    }
+    AK_roaring_directory_free(&directory);
+    if (result == EXIT_SUCCESS) {
+        value.rows += insert ? 1 : -1;
+        index->meta.entries += insert ? 1 : -1;
+    }
+    //a value added for a row that is already there has no rows and leaves again
+    AK_roaring_write_value(index, &value);
+    return result;
+}
+
+/**
+ * @author agent
+ * @brief  Function that reads the bitmap of a value from its containers
+ * @param index index
+ * @param key encoded value
+ * @param size number of bytes of the encoded value
+ * @return bitmap
+ */
+static AK_roaring *AK_roaring_read(AK_roaring_index *index, const unsigned char *key, int size)
+{
+    AK_roaring *bitmap = AK_roaring_new();
+    AK_roaring_value value;
+    AK_roaring_directory directory;
+    AK_roaring_container container;
+    int i;
+
+    AK_roaring_find_value(index, key, size, &value);
+    if (value.address == 0)
+        return bitmap;
+    AK_roaring_read_directory(value.directory, &directory);
+    for (i = 0; i < directory.count; i++) {
+        AK_roaring_read_container(directory.page[i], &container);
+        AK_roaring_append(bitmap, &container);
+    }
+    AK_roaring_directory_free(&directory);
+    return bitmap;
+}
+
+int AK_roaring_create(char *tblName, char *attribute, char *indexName)
+{
+    AK_roaring_index index;
+    AK_header i_header[MAX_ATTRIBUTES];
+    AK_header *table_header, *temp;
+    AK_block *block;
+    AK_tuple_dict *entry;
+    AK_rid rid;
+    table_addresses *addresses;
+    unsigned char key[AK_ROARING_MAX_KEY];
+    int num_attr, i, size, start, result = EXIT_SUCCESS;
+    AK_PRO;
+
+    num_attr = AK_num_attr(tblName);
+    table_header = (AK_header *) AK_get_header(tblName);
+    if (num_attr <= 0 || table_header == NULL) {
+        printf("Table %s does not exist!\n", tblName);
+        AK_free(table_header);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    addresses = (table_addresses *) AK_get_index_addresses(indexName);
+    start = addresses->address_from[0];
+    AK_free(addresses);
+    for (i = 0; i < num_attr && strcmp(table_header[i].att_name, attribute) != 0; i++);
+    if (start != 0) {
+        printf("Index %s already exists!\n", indexName);
+        result = EXIT_ERROR;
+    } else if (i == num_attr) {
+        printf("Attribute %s does not exist in table %s!\n", attribute, tblName);
+        result = EXIT_ERROR;
+    } else if (!AK_roaring_supported(table_header[i].type)) {
+        printf("Unsupported data type for compressed bitmap index on attribute %s!\n", attribute);
+        result = EXIT_ERROR;
+    }
+    if (result == EXIT_ERROR) {
+        AK_free(table_header);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    memset(&index, 0, sizeof(AK_roaring_index));
+    memset(i_header, 0, sizeof(i_header));
+    strncpy(index.meta.table, tblName, MAX_ATT_NAME - 1);
+    index.meta.position = i;
+    index.meta.type = table_header[i].type;
+    temp = (AK_header *) AK_create_header(table_header[i].att_name, table_header[i].type, FREE_INT, FREE_CHAR, FREE_CHAR);
+    memcpy(i_header, temp, sizeof(AK_header));
+    AK_free(temp);
+    AK_free(table_header);
+
+    start = AK_initialize_new_index_segment(indexName, tblName, index.meta.position, i_header);
+    if (start == EXIT_ERROR) {
+        printf("Index %s can not be created!\n", indexName);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    printf("\nINDEX %s CREATED!\n", indexName);
+    index.name = indexName;
+    index.address = start;
+    index.meta.last_page = start;
+
+    pthread_rwlock_wrlock(&AK_roaring_lock);
+    addresses = (table_addresses *) AK_get_table_addresses(tblName);
+    for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0 && result == EXIT_SUCCESS; i++) {
+        for (rid.block = addresses->address_from[i]; rid.block < addresses->address_to[i] && result == EXIT_SUCCESS; rid.block++) {
+            block = ((AK_mem_block *) AK_get_block(rid.block))->block;
+            if (block->last_tuple_dict_id == 0)
+                break;
+            for (rid.slot = 0; (rid.slot + 1) * num_attr <= DATA_BLOCK_SIZE && result == EXIT_SUCCESS; rid.slot++) {
+                block = ((AK_mem_block *) AK_get_block(rid.block))->block;
+                if (!AK_slot_is_live(block, rid.slot, num_attr))
+                    continue;
+                entry = &block->tuple_dict[rid.slot * num_attr + index.meta.position];
+                if ((size = AK_roaring_encode(index.meta.type, entry->type, block->data + entry->address, entry->size, key)) == EXIT_ERROR) {
+                    printf("Row %d in block %d of table %s can not be indexed!\n", rid.slot, rid.block, tblName);
+                    result = EXIT_ERROR;
+                } else
+                    result = AK_roaring_change(&index, key, size, AK_roaring_row_id(&rid), 1);
+            }
+        }
+    }
+    AK_free(addresses);
+    AK_roaring_write_meta(&index);
+    pthread_rwlock_unlock(&AK_roaring_lock);
+    AK_EPI;
+    return result;
+}
+
+int AK_roaring_delete(char *indexName)
+{
+    int result;
+    AK_PRO;
+    pthread_rwlock_wrlock(&AK_roaring_lock);
+    result = AK_delete_segment(indexName, SEGMENT_TYPE_INDEX);
+    pthread_rwlock_unlock(&AK_roaring_lock);
+    if (result == EXIT_SUCCESS)
+        printf("INDEX %s DELETED!\n", indexName);
+    AK_EPI;
+    return result;
+}
+
+int AK_roaring_get_meta(char *indexName, AK_roaring_meta *meta)
+{
+    AK_roaring_index index;
+    int result;
+    AK_PRO;
+    pthread_rwlock_rdlock(&AK_roaring_lock);
+    result = AK_roaring_open_index(indexName, &index);
+    pthread_rwlock_unlock(&AK_roaring_lock);
+    if (result == EXIT_SUCCESS)
+        memcpy(meta, &index.meta, sizeof(AK_roaring_meta));
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @author agent
+ * @brief  Function that adds a row to or removes it from the bitmap of its value
+ * @param indexName name of the index
+ * @param type type of the value
+ * @param value value of the indexed attribute
+ * @param size number of bytes of the value
+ * @param rid RID of the row
+ * @param insert 1 to add the row, 0 to remove it
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_roaring_update(char *indexName, int type, char *value, int size, AK_rid *rid, int insert)
+{
+    AK_roaring_index index;
+    unsigned char key[AK_ROARING_MAX_KEY];
+    int length, result = EXIT_ERROR;
+    pthread_rwlock_wrlock(&AK_roaring_lock);
+    if (AK_roaring_open_index(indexName, &index) != EXIT_SUCCESS)
+        printf("Compressed bitmap index %s does not exist!\n", indexName);
+    else if ((length = AK_roaring_encode(index.meta.type, type, (unsigned char *) value, size, key)) == EXIT_ERROR)
+        printf("Value can not be used with index %s!\n", indexName);
+    else {
+        result = AK_roaring_change(&index, key, length, AK_roaring_row_id(rid), insert);
+        AK_roaring_write_meta(&index);
+    }
+    pthread_rwlock_unlock(&AK_roaring_lock);
+    return result;
+}
+
+int AK_roaring_insert(char *indexName, int type, char *value, int size, AK_rid *rid)
+{
+    int result;
+    AK_PRO;
+    result = AK_roaring_update(indexName, type, value, size, rid, 1);
+    if (result == EXIT_ERROR)
+        printf("Row %d in block %d can not be added to index %s!\n", rid->slot, rid->block, indexName);
+    AK_EPI;
+    return result;
+}
+
+int AK_roaring_delete_row(char *indexName, int type, char *value, int size, AK_rid *rid)
+{
+    int result;
+    AK_PRO;
+    result = AK_roaring_update(indexName, type, value, size, rid, 0);
+    AK_EPI;
+    return result;
+}
+
+AK_roaring *AK_roaring_get(char *indexName, int type, char *value, int size)
+{
+    AK_roaring_index index;
+    AK_roaring *bitmap = NULL;
+    unsigned char key[AK_ROARING_MAX_KEY];
+    int length;
+    AK_PRO;
+    pthread_rwlock_rdlock(&AK_roaring_lock);
+    if (AK_roaring_open_index(indexName, &index) == EXIT_SUCCESS) {
+        length = AK_roaring_encode(index.meta.type, type, (unsigned char *) value, size, key);
+        bitmap = length == EXIT_ERROR ? AK_roaring_new() : AK_roaring_read(&index, key, length);
+    }
+    pthread_rwlock_unlock(&AK_roaring_lock);
+    AK_EPI;
+    return bitmap;
+}
+
+int AK_roaring_count(char *indexName, int type, char *value, int size)
+{
+    AK_roaring_index index;
+    AK_roaring_value entry;
+    unsigned char key[AK_ROARING_MAX_KEY];
+    int length, result = EXIT_ERROR;
+    AK_PRO;
+    pthread_rwlock_rdlock(&AK_roaring_lock);
+    if (AK_roaring_open_index(indexName, &index) == EXIT_SUCCESS) {
+        result = 0;
+        if ((length = AK_roaring_encode(index.meta.type, type, (unsigned char *) value, size, key)) != EXIT_ERROR) {
+            AK_roaring_find_value(&index, key, length, &entry);
+            result = entry.rows;
+        }
+    }
+    pthread_rwlock_unlock(&AK_roaring_lock);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @author agent
+ * @brief  Function that counts the rows of a table with the given values of two attributes by scanning the table
+ * @param tblName table name
+ * @param status value of the status attribute, NULL for any
+ * @param region value of the region attribute, -1 for any
+ * @return number of rows
+ */
+static int AK_roaring_test_scan(char *tblName, char *status, int region)
+{
+    AK_cursor *rows = AK_cursor_open(tblName);
+    struct list_node *row, *value;
+    int count = 0;
+
+    while ((row = AK_cursor_next(rows)) != NULL) {
+        value = AK_GetNth_L2(2, row);
+        if (status != NULL && (value->size != (int) strlen(status) || memcmp(value->data, status, value->size) != 0))
+            continue;
+        value = AK_GetNth_L2(3, row);
+        if (region < 0 || memcmp(value->data, &region, sizeof(int)) == 0)
+            count++;
+    }
+    AK_cursor_close(rows);
+    return count;
+}
+
+TestResult AK_roaring_test() {
+    int passedTest = 0;
+    int failedTest = 0;
+    char *tblName = "roaring_test";
+    char *statusIndex = "roaring_test_status";
+    char *regionIndex = "roaring_test_region";
+    char *status[3] = {"open", "closed", "pending"};
+    AK_roaring *a, *b, *result[3];
+    AK_roaring_meta meta;
+    AK_rid *rids;
+    struct list_node *stored;
+    unsigned int id;
+    int i, count, matches, region, expected[3], rows = 600;
+    AK_operator *plan;
+    AK_operator_info info;
+    AK_PRO;
+    struct list_node *row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&row_root);
+
+    printf("\nBitmaps in memory...\n");
+    //even row IDs fill bitsets, every third row ID below 40000 and a sparse tail stay arrays
+    a = AK_roaring_new();
+    b = AK_roaring_new();
+    for (id = 0; id < 100000; id += 2)
+        AK_roaring_add(a, id);
+    for (id = 0; id < 40000; id += 3)
+        AK_roaring_add(b, id);
+    for (id = 200000; id < 200700; id += 7)
+        AK_roaring_add(b, id);
+    matches = AK_roaring_add(a, 0) == 0 && AK_roaring_cardinality(a) == 50000 && a->containers[0].type == AK_ROARING_BITSET
+              && b->containers[0].type == AK_ROARING_BITSET && b->containers[b->count - 1].type == AK_ROARING_ARRAY;
+    result[0] = AK_roaring_and(a, b);
+    result[1] = AK_roaring_or(a, b);
+    result[2] = AK_roaring_andnot(a, b);
+    //a has 50000 row IDs, b has 13334 + 100, 6667 multiples of 6 are in both
+    expected[0] = 6667;
+    expected[1] = 50000 + 13434 - 6667;
+    expected[2] = 50000 - 6667;
+    rids = AK_roaring_rids(result[0], &count);
+    for (i = 0; i < count && matches; i++) {
+        id = AK_roaring_row_id(&rids[i]);
+        if (id % 6 != 0 || !AK_roaring_contains(a, id) || !AK_roaring_contains(b, id))
+            matches = 0;
+    }
+    AK_free(rids);
+    for (i = 0; i < 3; i++)
+        if (AK_roaring_cardinality(result[i]) != expected[i])
+            matches = 0;
+    if (matches && AK_roaring_cardinality(b) == 13434 && AK_roaring_contains(result[1], 200007)
+        && AK_roaring_contains(result[2], 2) && !AK_roaring_contains(result[2], 6)) {
+        printf("AND: %d, OR: %d, ANDNOT: %d row IDs\n", expected[0], expected[1], expected[2]);
+        passedTest++;
+    } else {
+        printf("AND, OR and ANDNOT should give the row IDs of the operands they keep.\n");
+        failedTest++;
+    }
+    for (i = 0; i < 3; i++)
+        AK_roaring_free(result[i]);
+
+    printf("\nRemoving row IDs...\n");
+    //a bitset left with few row IDs becomes an array, an empty container is dropped
+    for (id = 0; id < AK_ROARING_SPAN - 2 * 100; id += 2)
+        AK_roaring_remove(a, id);
+    count = a->count;
+    matches = a->containers[0].type == AK_ROARING_ARRAY && a->containers[0].cardinality == 100 && AK_roaring_remove(a, 1) == 0;
+    for (id = AK_ROARING_SPAN - 2 * 100; id < AK_ROARING_SPAN; id += 2)
+        AK_roaring_remove(a, id);
+    rids = AK_roaring_rids(a, &i);
+    id = AK_ROARING_SPAN;
+    if (matches && a->count == count - 1 && i == 50000 - AK_ROARING_SPAN / 2 && rids != NULL
+        && rids[0].block == id / DATA_BLOCK_SIZE && rids[0].slot == id % DATA_BLOCK_SIZE) {
+        passedTest++;
+    } else {
+        printf("Removing row IDs should shrink and drop containers.\n");
+        failedTest++;
+    }
+    AK_free(rids);
+    AK_roaring_free(a);
+    AK_roaring_free(b);
+
+    printf("\nCompressed bitmap indexes on status and region of table %s\n", tblName);
+    AK_create_table_parameter *params = (AK_create_table_parameter *) AK_malloc(3 * sizeof(AK_create_table_parameter));
+    params[0] = *(AK_create_create_table_parameter(TYPE_INT, "id"));
+    params[1] = *(AK_create_create_table_parameter(TYPE_VARCHAR, "status"));
+    params[2] = *(AK_create_create_table_parameter(TYPE_INT, "region"));
+    AK_create_table(tblName, params, 3);
+    AK_free(params);
+    //half of the rows are there when the indexes are created, the other half is added to them
+    for (i = 0; i < rows; i++) {
+        if (i == rows / 2) {
+            matches = AK_roaring_create(tblName, "status", statusIndex) == EXIT_SUCCESS
+                      && AK_roaring_create(tblName, "region", regionIndex) == EXIT_SUCCESS
+                      && AK_roaring_create(tblName, "region", regionIndex) == EXIT_ERROR;
+        }
+        region = i % 4;
+        AK_DeleteAll_L3(&row_root);
+        AK_Insert_New_Element(TYPE_INT, &i, tblName, "id", row_root);
+        AK_Insert_New_Element(TYPE_VARCHAR, status[i % 3], tblName, "status", row_root);
+        AK_Insert_New_Element(TYPE_INT, &region, tblName, "region", row_root);
+        AK_insert_row(row_root);
+    }
+    for (i = 0; i < 3 && matches; i++)
+        if (AK_roaring_count(statusIndex, TYPE_VARCHAR, status[i], strlen(status[i])) != rows / 3)
+            matches = 0;
+    region = 4;
+    if (matches && AK_roaring_count(regionIndex, TYPE_INT, (char *) &region, sizeof(int)) == 0
+        && AK_roaring_get_meta(regionIndex, &meta) == EXIT_SUCCESS && meta.values == 4 && meta.entries == rows) {
+        printf("Index %s has %d rows with %d values on %d pages.\n", regionIndex, meta.entries, meta.values, meta.pages);
+        passedTest++;
+    } else {
+        printf("Indexes should count the rows of every value.\n");
+        failedTest++;
+    }
+
+    printf("\nCombining bitmaps of the indexes...\n");
+    region = 1;
+    a = AK_roaring_get(statusIndex, TYPE_VARCHAR, "open", 4);
+    b = AK_roaring_get(regionIndex, TYPE_INT, (char *) &region, sizeof(int));
+    result[0] = AK_roaring_and(a, b);
+    result[1] = AK_roaring_or(a, b);
+    result[2] = AK_roaring_andnot(a, b);
+    matches = AK_roaring_cardinality(result[0]) == AK_roaring_test_scan(tblName, "open", region)
+              && AK_roaring_cardinality(result[1]) == AK_roaring_test_scan(tblName, "open", -1) + AK_roaring_test_scan(tblName, NULL, region) - AK_roaring_test_scan(tblName, "open", region)
+              && AK_roaring_cardinality(result[2]) == AK_roaring_test_scan(tblName, "open", -1) - AK_roaring_test_scan(tblName, "open", region);
+    //every RID of the intersection is a row with both values
+    rids = AK_roaring_rids(result[0], &count);
+    for (i = 0; i < count && matches; i++) {
+        stored = AK_get_row_by_rid(&rids[i]);
+        if (stored == NULL || memcmp(AK_GetNth_L2(2, stored)->data, "open", 4) != 0 || memcmp(AK_GetNth_L2(3, stored)->data, &region, sizeof(int)) != 0)
+            matches = 0;
+        if (stored != NULL) {
+            AK_DeleteAll_L3(&stored);
+            AK_free(stored);
+        }
+    }
+    AK_free(rids);
+    if (matches && count == rows / 12) {
+        printf("open AND region 1: %d rows\n", count);
+        passedTest++;
+    } else {
+        printf("Combined bitmaps should have the rows a scan of %s finds.\n", tblName);
+        failedTest++;
+    }
+    AK_roaring_free(a);
+    AK_roaring_free(b);
+    for (i = 0; i < 3; i++)
+        AK_roaring_free(result[i]);
+
+    printf("\nUpdating and deleting rows of table %s...\n", tblName);
+    i = 0;
+    AK_DeleteAll_L3(&row_root);
+    AK_Update_Existing_Element(TYPE_INT, &i, tblName, "id", row_root);
+    AK_Insert_New_Element(TYPE_VARCHAR, "reopened", tblName, "status", row_root);
+    AK_update_row(row_root);
+    region = 3;
+    AK_DeleteAll_L3(&row_root);
+    AK_Update_Existing_Element(TYPE_INT, &region, tblName, "region", row_root);
+    AK_delete_row(row_root);
+    matches = AK_roaring_count(statusIndex, TYPE_VARCHAR, "reopened", 8) == 1
+              && AK_roaring_count(regionIndex, TYPE_INT, (char *) &region, sizeof(int)) == 0;
+    for (i = 0; i < 3 && matches; i++)
+        if (AK_roaring_count(statusIndex, TYPE_VARCHAR, status[i], strlen(status[i])) != AK_roaring_test_scan(tblName, status[i], -1))
+            matches = 0;
+    if (matches && AK_roaring_get_meta(regionIndex, &meta) == EXIT_SUCCESS && meta.values == 3 && meta.entries == AK_get_num_records(tblName)) {
+        passedTest++;
+    } else {
+        printf("Indexes should follow the row changes.\n");
+        failedTest++;
+    }
+
+    printf("\nSelection of student by bitmap indexes on firstname and year...\n");
+    //equalities on the attributes of two indexes read the rows in both bitmaps
+    matches = AK_roaring_create("student", "firstname", "student_roaring_firstname") == EXIT_SUCCESS
+              && AK_roaring_create("student", "year", "student_roaring_year") == EXIT_SUCCESS;
+    region = 2006;
+    AK_DeleteAll_L3(&row_root);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "firstname", sizeof("firstname"), row_root);
+    AK_InsertAtEnd_L3(TYPE_VARCHAR, "Ivan", strlen("Ivan"), row_root);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "=", sizeof("="), row_root);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "year", sizeof("year"), row_root);
+    AK_InsertAtEnd_L3(TYPE_INT, (char *) &region, sizeof(int), row_root);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "=", sizeof("="), row_root);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "AND", sizeof("AND"), row_root);
+    plan = AK_access_operator("student", row_root);
+    AK_operator_describe(plan, &info);
+    count = AK_iterator_count(plan = AK_select_operator(plan, row_root));
+    AK_operator_free(plan);
+    i = AK_iterator_count(plan = AK_select_operator(AK_scan_operator("student"), row_root));
+    AK_operator_free(plan);
+    AK_DeleteAll_L3(&row_root);
+    AK_roaring_delete("student_roaring_firstname");
+    AK_roaring_delete("student_roaring_year");
+    printf("Selection of student by %s: %d rows, expected %d\n", info.index_scan ? "indexes" : "scan", count, i);
+    if (matches && info.index_scan && count == 1 && count == i) {
+        passedTest++;
+    } else {
+        printf("A selection on the keys of two bitmap indexes should read the rows in both bitmaps.\n");
+        failedTest++;
+    }
+
+    printf("\nDeleting indexes...\n");
+    matches = AK_roaring_delete(statusIndex) == EXIT_SUCCESS && AK_roaring_delete(regionIndex) == EXIT_SUCCESS;
+    AK_delete_segment(tblName, SEGMENT_TYPE_TABLE);
+    if (matches && AK_roaring_get_meta(statusIndex, &meta) == EXIT_ERROR && AK_roaring_get(regionIndex, TYPE_INT, (char *) &region, sizeof(int)) == NULL) {
+        passedTest++;
+    } else {
+        printf("Deleted indexes should be gone.\n");
+        failedTest++;
+    }
+
+    AK_DeleteAll_L3(&row_root);
+    AK_free(row_root);
+    printf("\n");
+    AK_EPI;
+    return TEST_result(passedTest,failedTest);
+}
@@ -0,0 +1,286 @@
+/**
+@file roaring.h Header file that provides data structures, functions and defines for compressed bitmap indices
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#ifndef ROARING
+#define ROARING
+
+#include "../../auxi/test.h"
+#include "index.h"
+#include "../../file/table.h"
+#include "../../file/fileio.h"
+#include "../../auxi/constants.h"
+#include "../../auxi/configuration.h"
+#include "../../auxi/mempro.h"
+
+//types for tuple_dict[0] of the pages of a compressed bitmap index
+#define ROARING_META_PAGE 28
+#define ROARING_VALUE_PAGE 29
+#define ROARING_DIRECTORY_PAGE 30
+#define ROARING_CONTAINER_PAGE 31
+#define ROARING_FREE_PAGE 32
+
+//types of containers
+#define AK_ROARING_ARRAY 1
+#define AK_ROARING_BITSET 2
+
+/// number of bytes of a page available to the index
+#define AK_ROARING_PAGE_SIZE (DATA_BLOCK_SIZE * DATA_ENTRY_SIZE)
+/// number of low bits of a row ID kept in its container, the rest is the key of the container
+#define AK_ROARING_BITS 15
+/// number of row IDs a container covers
+#define AK_ROARING_SPAN (1 << AK_ROARING_BITS)
+/// number of 64-bit words of a bitset container
+#define AK_ROARING_WORDS (AK_ROARING_SPAN / 64)
+/// largest number of row IDs of an array container, a bitset container takes no more bytes
+#define AK_ROARING_ARRAY_MAX (AK_ROARING_SPAN / 16)
+/// largest value of an indexed attribute
+#define AK_ROARING_MAX_VALUE MAX_VARCHAR_LENGTH
+
+/**
+ * @author agent
+ * @struct AK_roaring_container
+ * @brief Structure that defines the row IDs of a bitmap that share their high bits. Up to AK_ROARING_ARRAY_MAX of them
+ * are kept as a sorted array of their low bits, more as a bitset of AK_ROARING_SPAN bits.
+ */
+typedef struct {
+    /// high bits of the row IDs
+    int key;
+    /// AK_ROARING_ARRAY or AK_ROARING_BITSET
+    int type;
+    /// number of row IDs
+    int cardinality;
+    /// array container: low bits of the row IDs in ascending order
+    unsigned short *array;
+    /// bitset container: AK_ROARING_WORDS words, bit i is row ID key * AK_ROARING_SPAN + i
+    unsigned long long *words;
+} AK_roaring_container;
+
+/**
+ * @author agent
+ * @struct AK_roaring
+ * @brief Structure that defines a compressed bitmap of row IDs: its containers in the order of their keys. The row ID
+ * of a RID is block * DATA_BLOCK_SIZE + slot, so row IDs follow the table order.
+ */
+typedef struct {
+    /// number of containers
+    int count;
+    /// number of containers the array has room for
+    int capacity;
+    /// containers
+    AK_roaring_container *containers;
+} AK_roaring;
+
+/**
+ * @author agent
+ * @struct AK_roaring_meta
+ * @brief Structure that defines the first page of a compressed bitmap index. The value pages list the distinct values
+ * of the attribute with the number of rows that have them; the directory of a value lists its containers, every one
+ * on its own page.
+ */
+typedef struct {
+    /// name of the indexed table
+    char table[MAX_ATT_NAME];
+    /// position of the indexed attribute in the table
+    int position;
+    /// type of the indexed attribute
+    int type;
+    /// number of distinct values
+    int values;
+    /// number of rows in the index
+    int entries;
+    /// first value page, 0 while there are no values
+    int first_value;
+    /// number of pages after the first one
+    int pages;
+    /// last page taken from the extents of the index
+    int last_page;
+    /// first page of the list of freed pages, 0 if it is empty
+    int free_page;
+} AK_roaring_meta;
+
+/**
+ * @author agent
+ * @brief  Function that creates an empty bitmap
+ * @return bitmap, to be freed with AK_roaring_free
+ */
+AK_roaring *AK_roaring_new();
+
+/**
+ * @author agent
+ * @brief  Function that frees a bitmap
+ * @param bitmap bitmap, may be NULL
+ */
+void AK_roaring_free(AK_roaring *bitmap);
+
+/**
+ * @author agent
+ * @brief  Function that computes the row ID of a RID
+ * @param rid RID
+ * @return row ID
+ */
+unsigned int AK_roaring_row_id(AK_rid *rid);
+
+/**
+ * @author agent
+ * @brief  Function that adds a row ID to a bitmap, an array container that gets too big becomes a bitset
+ * @param bitmap bitmap
+ * @param id row ID
+ * @return 1 if it was added, 0 if it was already there
+ */
+int AK_roaring_add(AK_roaring *bitmap, unsigned int id);
+
+/**
+ * @author agent
+ * @brief  Function that removes a row ID from a bitmap, a bitset container that gets small enough becomes an array
+ * @param bitmap bitmap
+ * @param id row ID
+ * @return 1 if it was removed, 0 if it was not there
+ */
+int AK_roaring_remove(AK_roaring *bitmap, unsigned int id);
+
+/**
+ * @author agent
+ * @brief  Function that checks whether a bitmap has a row ID
+ * @param bitmap bitmap
+ * @param id row ID
+ * @return 1 if it has, 0 otherwise
+ */
+int AK_roaring_contains(AK_roaring *bitmap, unsigned int id);
+
+/**
+ * @author agent
+ * @brief  Function that counts the row IDs of a bitmap from the cardinalities of its containers
+ * @param bitmap bitmap, may be NULL
+ * @return number of row IDs
+ */
+int AK_roaring_cardinality(AK_roaring *bitmap);
+
+/**
+ * @author agent
+ * @brief  Function that intersects two bitmaps container by container; two bitsets are combined a word at a time and
+ * counted with popcount
+ * @param a first bitmap
+ * @param b second bitmap
+ * @return new bitmap with the row IDs in both
+ */
+AK_roaring *AK_roaring_and(AK_roaring *a, AK_roaring *b);
+
+/**
+ * @author agent
+ * @brief  Function that unites two bitmaps container by container
+ * @param a first bitmap
+ * @param b second bitmap
+ * @return new bitmap with the row IDs in either
+ */
+AK_roaring *AK_roaring_or(AK_roaring *a, AK_roaring *b);
+
+/**
+ * @author agent
+ * @brief  Function that subtracts a bitmap from another container by container
+ * @param a first bitmap
+ * @param b second bitmap
+ * @return new bitmap with the row IDs of a that are not in b
+ */
+AK_roaring *AK_roaring_andnot(AK_roaring *a, AK_roaring *b);
+
+/**
+ * @author agent
+ * @brief  Function that lists the RIDs of the row IDs of a bitmap
+ * @param bitmap bitmap
+ * @param count receives the number of RIDs
+ * @return RIDs in table order, to be freed with AK_free; NULL for an empty bitmap
+ */
+AK_rid *AK_roaring_rids(AK_roaring *bitmap, int *count);
+
+/**
+ * @author agent
+ * @brief  Function that creates a compressed bitmap index on an attribute of a table
+ * @param tblName name of the table
+ * @param attribute name of the attribute
+ * @param indexName name of the index
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+int AK_roaring_create(char *tblName, char *attribute, char *indexName);
+
+/**
+ * @author agent
+ * @brief  Function that deletes a compressed bitmap index
+ * @param indexName name of the index
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+int AK_roaring_delete(char *indexName);
+
+/**
+ * @author agent
+ * @brief  Function that reads the first page of a compressed bitmap index
+ * @param indexName name of the index
+ * @param meta receives the page
+ * @return EXIT_SUCCESS, EXIT_ERROR if there is no such index
+ */
+int AK_roaring_get_meta(char *indexName, AK_roaring_meta *meta);
+
+/**
+ * @author agent
+ * @brief  Function that adds a row to the bitmap of its value
+ * @param indexName name of the index
+ * @param type type of the value
+ * @param value value of the indexed attribute
+ * @param size number of bytes of the value
+ * @param rid RID of the row
+ * @return EXIT_SUCCESS, EXIT_ERROR if the row is already in the index or the value does not fit
+ */
+int AK_roaring_insert(char *indexName, int type, char *value, int size, AK_rid *rid);
+
+/**
+ * @author agent
+ * @brief  Function that removes a row from the bitmap of its value, emptied containers are freed
+ * @param indexName name of the index
+ * @param type type of the value
+ * @param value value of the indexed attribute
+ * @param size number of bytes of the value
+ * @param rid RID of the row
+ * @return EXIT_SUCCESS, EXIT_ERROR if the row is not in the index
+ */
+int AK_roaring_delete_row(char *indexName, int type, char *value, int size, AK_rid *rid);
+
+/**
+ * @author agent
+ * @brief  Function that reads the bitmap of the rows with a value
+ * @param indexName name of the index
+ * @param type type of the value
+ * @param value value of the indexed attribute
+ * @param size number of bytes of the value
+ * @return bitmap, empty if no row has the value; NULL if there is no such index
+ */
+AK_roaring *AK_roaring_get(char *indexName, int type, char *value, int size);
+
+/**
+ * @author agent
+ * @brief  Function that counts the rows with a value from the value pages, no bitmap is read
+ * @param indexName name of the index
+ * @param type type of the value
+ * @param value value of the indexed attribute
+ * @param size number of bytes of the value
+ * @return number of rows, EXIT_ERROR if there is no such index
+ */
+int AK_roaring_count(char *indexName, int type, char *value, int size);
+
+TestResult AK_roaring_test();
+
+#endif
@@ -0,0 +1,550 @@
+/**
+@file parallel.c Provides parallel table scans. A fixed pool of worker threads, sized by number_of_threads of
+config.ini, reads the blocks of a table; block ranges are tasks in per-worker deques from which idle workers steal,
+every worker builds a partial result and the partial results are merged by the thread that started the scan.
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#include "parallel.h"
+#include "../rel/iterator.h"
+#include <unistd.h>
+
+/**
+ * @author agent
+ * @struct AK_parallel_task
+ * @brief Consecutive blocks of one extent scanned by one worker
+ */
+typedef struct {
+    /// first block
+    int from;
+    /// block after the last one
+    int to;
+} AK_parallel_task;
+
+/**
+ * @author agent
+ * @struct AK_parallel_deque
+ * @brief Tasks of one worker. The owner takes tasks from the bottom, other workers steal from the top.
+ */
+typedef struct {
+    /// protects top and bottom
+    pthread_mutex_t lock;
+    /// index of the first task left
+    int top;
+    /// index after the last task left
+    int bottom;
+} AK_parallel_deque;
+
+/**
+ * @author agent
+ * @struct AK_parallel_run
+ * @brief One scan running on the pool
+ */
+typedef struct {
+    /// what the scan does
+    AK_parallel_job *job;
+    /// tasks of all workers, the deques index into it
+    AK_parallel_task *tasks;
+    /// deque of every worker
+    AK_parallel_deque *deques;
+    /// workers
+    AK_parallel_worker *workers;
+    /// number of workers
+    int count;
+    /// 1 once a function of the job failed, the workers stop taking tasks
+    volatile int failed;
+} AK_parallel_run;
+
+/**
+ * @author agent
+ * @struct AK_parallel_pool
+ * @brief Worker threads waiting for scans. The thread starting a scan is worker 0, pool thread i is worker i + 1.
+ */
+typedef struct {
+    /// protects the pool
+    pthread_mutex_t lock;
+    /// signalled when a scan starts
+    pthread_cond_t wake;
+    /// signalled when the last pool thread of a scan finished
+    pthread_cond_t done;
+    /// number of workers, 0 until the pool is started
+    int size;
+    /// 1 while a scan uses the pool
+    int busy;
+    /// number of the current scan, a thread works once for every number
+    int generation;
+    /// pool threads of the current scan that have not finished
+    int running;
+    /// current scan
+    AK_parallel_run *run;
+} AK_parallel_pool;
+
+static AK_parallel_pool AK_parallel_threads = {PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER, 0, 0, 0, 0, NULL};
+
+/// 1 in the pool threads, their scans are not parallel
+static __thread int AK_parallel_in_worker = 0;
+
+/// number of workers of automatic scans set by AK_parallel_set_workers, 0 to choose by table size and processors
+static int AK_parallel_forced = 0;
+
+/**
+ * @author agent
+ * @brief  Function that takes the next task of a worker: from the bottom of its own deque or, if it is empty, from
+ * the top of the deque of another worker
+ * @param run scan
+ * @param id worker
+ * @param task receives the task
+ * @return EXIT_SUCCESS, EXIT_ERROR if no deque has tasks left
+ */
+static int AK_parallel_take(AK_parallel_run *run, int id, AK_parallel_task *task)
+{
+    AK_parallel_deque *deque;
+    int i, found = EXIT_ERROR;
+    for (i = 0; i < run->count && found == EXIT_ERROR && !run->failed; i++)
+    {
+        deque = &run->deques[(id + i) % run->count];
+        pthread_mutex_lock(&deque->lock);
+        if (deque->top < deque->bottom)
+        {
+            *task = i == 0 ? run->tasks[--deque->bottom] : run->tasks[deque->top++];
+            found = EXIT_SUCCESS;
+        }
+        pthread_mutex_unlock(&deque->lock);
+    }
+    if (found == EXIT_SUCCESS && i > 1)
+        run->workers[id].stolen++;
+    return found;
+}
+
+/**
+ * @author agent
+ * @brief  Function that scans one block for a worker. The block is pinned and latched for reading meanwhile.
+ * @param run scan
+ * @param worker worker
+ * @param address block address
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_parallel_block(AK_parallel_run *run, AK_parallel_worker *worker, int address)
+{
+    AK_parallel_job *job = run->job;
+    AK_mem_block *mem_block;
+    AK_block *block;
+    int result = EXIT_SUCCESS, num_attr = worker->row->num_attr;
+    AK_PRO;
+    mem_block = AK_pin_block(address);
+    if (mem_block == NULL)
+    {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    AK_latch_block(mem_block, SHARED_LOCK);
+    block = mem_block->block;
+    worker->address = address;
+    worker->slot = 0;
+    if (job->block != NULL)
+        result = job->block(worker, block, job->context);
+    //a block holding one row of one attribute has last_tuple_dict_id 0 too
+    else if (block->last_tuple_dict_id != 0 || block->tuple_dict[0].type != FREE_INT)
+    {
+        for (; result == EXIT_SUCCESS && (worker->slot + 1) * num_attr <= DATA_BLOCK_SIZE && block->tuple_dict[worker->slot * num_attr].type != FREE_INT; worker->slot++)
+            if (AK_row_from_slot(worker->row, block, worker->slot) == EXIT_SUCCESS)
+                result = job->row(worker, worker->row, job->context);
+    }
+    AK_unlatch_block(mem_block);
+    AK_unpin_block(mem_block, BLOCK_CLEAN);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @author agent
+ * @brief  Function that runs one worker of a scan until no deque has tasks left
+ * @param run scan
+ * @param id worker
+ */
+static void AK_parallel_work(AK_parallel_run *run, int id)
+{
+    AK_parallel_worker *worker = &run->workers[id];
+    AK_parallel_task task;
+    int address;
+    AK_PRO;
+    while (AK_parallel_take(run, id, &task) == EXIT_SUCCESS)
+        for (address = task.from; address < task.to && !run->failed; address++)
+            if (AK_parallel_block(run, worker, address) == EXIT_ERROR)
+                run->failed = 1;
+    if (!run->failed && run->job->done != NULL && run->job->done(worker, run->job->context) == EXIT_ERROR)
+        run->failed = 1;
+    AK_EPI;
+}
+
+/**
+ * @author agent
+ * @brief  Function run by every pool thread: it waits for a scan and works on it if the scan has a worker for it
+ * @param arg index of the thread in the pool
+ * @return NULL, the threads run until the process ends
+ */
+static void *AK_parallel_thread(void *arg)
+{
+    AK_parallel_pool *pool = &AK_parallel_threads;
+    AK_parallel_run *run;
+    int id = (int)(intptr_t)arg + 1, generation = 0;
+    AK_parallel_in_worker = 1;
+    pthread_mutex_lock(&pool->lock);
+    for (;;)
+    {
+        while (pool->generation == generation)
+            pthread_cond_wait(&pool->wake, &pool->lock);
+        generation = pool->generation;
+        run = pool->run;
+        if (run == NULL || id >= run->count)
+            continue;
+        pthread_mutex_unlock(&pool->lock);
+        AK_parallel_work(run, id);
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->running == 0)
+            pthread_cond_signal(&pool->done);
+    }
+    return NULL;
+}
+
+int AK_parallel_size()
+{
+    AK_parallel_pool *pool = &AK_parallel_threads;
+    pthread_t thread;
+    int size, i;
+    AK_PRO;
+    pthread_mutex_lock(&pool->lock);
+    if (pool->size == 0)
+    {
+        size = NUMBER_OF_THREADS;
+        size = size < 1 ? 1 : size > AK_PARALLEL_MAX_WORKERS ? AK_PARALLEL_MAX_WORKERS : size;
+        for (i = 0; i < size - 1; i++)
+            if (pthread_create(&thread, NULL, AK_parallel_thread, (void *)(intptr_t)i) != 0 || pthread_detach(thread) != 0)
+                break;
+        pool->size = i + 1;
+        AK_dbg_messg(LOW, FILE_MAN, "AK_parallel_size: started %d pool threads\n", i);
+    }
+    size = pool->size;
+    pthread_mutex_unlock(&pool->lock);
+    AK_EPI;
+    return size;
+}
+
+/**
+ * @author agent
+ * @brief  Function that returns the number of workers of an automatic scan
+ * @param blocks number of blocks of the table
+ * @return number of workers
+ */
+static int AK_parallel_automatic(int blocks)
+{
+    int workers = 1;
+    if (AK_parallel_in_worker)
+        return 1;
+    if (AK_parallel_forced > 0)
+        workers = AK_parallel_forced;
+    else if (blocks >= AK_PARALLEL_MIN_BLOCKS)
+        workers = sysconf(_SC_NPROCESSORS_ONLN);
+    if (workers > 1 && workers > AK_parallel_size())
+        workers = AK_parallel_size();
+    return workers > 1 ? workers : 1;
+}
+
+int AK_parallel_workers(char *table)
+{
+    table_addresses *addresses;
+    int i, blocks = 0;
+    AK_PRO;
+    addresses = (table_addresses *)AK_get_table_addresses(table);
+    for (i = 0; addresses != NULL && i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0; i++)
+        blocks += addresses->address_to[i] - addresses->address_from[i];
+    AK_free(addresses);
+    AK_EPI;
+    return AK_parallel_automatic(blocks);
+}
+
+int AK_parallel_set_workers(int workers)
+{
+    int previous = AK_parallel_forced;
+    AK_PRO;
+    AK_parallel_forced = workers > 0 ? workers : 0;
+    AK_EPI;
+    return previous;
+}
+
+int AK_parallel_scan(char *table, AK_parallel_job *job)
+{
+    AK_parallel_pool *pool = &AK_parallel_threads;
+    AK_parallel_run run;
+    table_addresses *addresses;
+    AK_header *header;
+    int num_attr, blocks = 0, num_tasks = 0, workers, i, j, pooled = 0, result = EXIT_SUCCESS;
+    AK_PRO;
+    job->used = job->stolen = 0;
+    num_attr = AK_num_attr(table);
+    addresses = (table_addresses *)AK_get_table_addresses(table);
+    if (num_attr <= 0 || addresses == NULL)
+    {
+        AK_free(addresses);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    header = (AK_header *)AK_get_header(table);
+
+    //tasks of AK_PARALLEL_TASK_BLOCKS blocks in table order, a task does not cross extents
+    for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0; i++)
+    {
+        blocks += addresses->address_to[i] - addresses->address_from[i];
+        num_tasks += (addresses->address_to[i] - addresses->address_from[i] + AK_PARALLEL_TASK_BLOCKS - 1) / AK_PARALLEL_TASK_BLOCKS;
+    }
+    memset(&run, 0, sizeof(AK_parallel_run));
+    run.job = job;
+    run.tasks = (AK_parallel_task *)AK_calloc(num_tasks > 0 ? num_tasks : 1, sizeof(AK_parallel_task));
+    for (i = 0, num_tasks = 0; run.tasks != NULL && i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0; i++)
+        for (j = addresses->address_from[i]; j < addresses->address_to[i]; j += AK_PARALLEL_TASK_BLOCKS, num_tasks++)
+        {
+            run.tasks[num_tasks].from = j;
+            run.tasks[num_tasks].to = j + AK_PARALLEL_TASK_BLOCKS < addresses->address_to[i] ? j + AK_PARALLEL_TASK_BLOCKS : addresses->address_to[i];
+        }
+
+    //small tables, scans started by workers and scans while the pool is busy run on the calling thread
+    workers = job->workers > 0 ? job->workers : AK_parallel_automatic(blocks);
+    if (workers > 1 && !AK_parallel_in_worker)
+    {
+        i = AK_parallel_size();
+        workers = workers < i ? workers : i;
+        workers = workers < num_tasks ? workers : num_tasks;
+        pthread_mutex_lock(&pool->lock);
+        if (workers > 1 && !pool->busy)
+            pool->busy = pooled = 1;
+        pthread_mutex_unlock(&pool->lock);
+    }
+    if (!pooled)
+        workers = 1;
+
+    run.count = workers;
+    run.deques = (AK_parallel_deque *)AK_calloc(workers, sizeof(AK_parallel_deque));
+    run.workers = (AK_parallel_worker *)AK_calloc(workers, sizeof(AK_parallel_worker));
+    for (i = 0; run.deques != NULL && run.workers != NULL && i < workers; i++)
+    {
+        //every worker starts with a run of consecutive tasks
+        pthread_mutex_init(&run.deques[i].lock, NULL);
+        run.deques[i].top = (int)((long)num_tasks * i / workers);
+        run.deques[i].bottom = (int)((long)num_tasks * (i + 1) / workers);
+        run.workers[i].id = i;
+        run.workers[i].partial = AK_calloc(1, job->partial_size > 0 ? job->partial_size : 1);
+        run.workers[i].scratch = AK_arena_create(0);
+        run.workers[i].row = AK_row_new(header, num_attr);
+        if (run.workers[i].partial == NULL || run.workers[i].scratch == NULL || run.workers[i].row == NULL)
+            run.failed = 1;
+    }
+    if (run.tasks == NULL || run.deques == NULL || run.workers == NULL)
+        run.failed = 1;
+
+    if (!run.failed)
+    {
+        if (pooled)
+        {
+            pthread_mutex_lock(&pool->lock);
+            pool->run = &run;
+            pool->running = workers - 1;
+            pool->generation++;
+            pthread_cond_broadcast(&pool->wake);
+            pthread_mutex_unlock(&pool->lock);
+        }
+        AK_parallel_work(&run, 0);
+        if (pooled)
+        {
+            pthread_mutex_lock(&pool->lock);
+            while (pool->running > 0)
+                pthread_cond_wait(&pool->done, &pool->lock);
+            pool->run = NULL;
+            pthread_mutex_unlock(&pool->lock);
+        }
+    }
+    if (pooled)
+    {
+        pthread_mutex_lock(&pool->lock);
+        pool->busy = 0;
+        pthread_mutex_unlock(&pool->lock);
+    }
+    if (run.failed)
+        result = EXIT_ERROR;
+
+    //partial results are merged in order of the workers
+    for (i = 0; run.workers != NULL && i < workers; i++)
+    {
+        if (run.workers[i].partial != NULL && job->merge != NULL && job->merge(&run.workers[i], job->context) == EXIT_ERROR)
+            result = EXIT_ERROR;
+        job->stolen += run.workers[i].stolen;
+        AK_free(run.workers[i].partial);
+        AK_arena_destroy(run.workers[i].scratch);
+        AK_row_free(run.workers[i].row);
+        if (run.deques != NULL)
+            pthread_mutex_destroy(&run.deques[i].lock);
+    }
+    job->used = workers;
+    AK_dbg_messg(MIDDLE, FILE_MAN, "AK_parallel_scan: %s, %d blocks in %d tasks, %d workers, %d tasks stolen\n", table, blocks, num_tasks, workers, job->stolen);
+
+    AK_free(run.workers);
+    AK_free(run.deques);
+    AK_free(run.tasks);
+    AK_free(header);
+    AK_free(addresses);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @author agent
+ * @brief  Function that counts the rows of a worker and sums their years
+ * @param worker worker
+ * @param row row
+ * @param context index of the year attribute
+ * @return EXIT_SUCCESS
+ */
+static int AK_parallel_test_row(AK_parallel_worker *worker, AK_row *row, void *context)
+{
+    int *partial = (int *)worker->partial, type, size, year = 0;
+    char *value = AK_row_get(row, *(int *)context, &type, &size);
+    if (value != NULL && type == TYPE_INT)
+        memcpy(&year, value, sizeof(int));
+    partial[0]++;
+    partial[1] += year;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @author agent
+ * @brief  Function that adds the count and sum of a worker to the totals
+ * @param worker worker
+ * @param context index of the year attribute, followed by the totals
+ * @return EXIT_SUCCESS
+ */
+static int AK_parallel_test_merge(AK_parallel_worker *worker, void *context)
+{
+    int *partial = (int *)worker->partial, *total = (int *)context;
+    total[1] += partial[0];
+    total[2] += partial[1];
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @author agent
+ * @brief  Function for testing parallel scans. Rows and years of student are counted by a scan on the calling thread
+ * and by scans with up to four workers, which must give the same totals, as must a selection and an aggregation of
+ * student run by the iterator with one and with four workers.
+ * @return Test result - number of successful and unsuccessful tests
+ */
+TestResult AK_parallel_test()
+{
+    AK_parallel_job job;
+    int context[3], expected[2], workers, successful = 0, failed = 0;
+    struct list_node *expr = (struct list_node *)AK_malloc(sizeof(struct list_node));
+    AK_operator *plan;
+    AK_operator_info info;
+    AK_agg_input input;
+    AK_header *header;
+    double aggregates[2][4];
+    int checksum[2], parallel[2], year = 2003, rows, i, j;
+    AK_PRO;
+    printf("\n********** PARALLEL SCAN TEST **********\n");
+    printf("Worker pool of %d threads\n", AK_parallel_size());
+
+    memset(&job, 0, sizeof(AK_parallel_job));
+    job.row = AK_parallel_test_row;
+    job.merge = AK_parallel_test_merge;
+    job.context = context;
+    job.partial_size = 2 * sizeof(int);
+    for (workers = 1; workers <= 4; workers *= 2)
+    {
+        context[0] = AK_get_attr_index("student", "year");
+        context[1] = context[2] = 0;
+        job.workers = workers;
+        if (AK_parallel_scan("student", &job) == EXIT_ERROR)
+            context[1] = EXIT_ERROR;
+        if (workers == 1)
+        {
+            expected[0] = context[1];
+            expected[1] = context[2];
+        }
+        printf("Scan of student with %d of %d workers: %d rows, sum of years %d, %d tasks stolen\n", job.used, workers, context[1], context[2], job.stolen);
+        if (context[1] > 0 && context[1] == AK_get_num_records("student") && context[1] == expected[0] && context[2] == expected[1]
+            && job.used <= workers && (workers == 1 || AK_parallel_size() == 1 || job.used > 1))
+            successful++;
+        else
+            failed++;
+    }
+
+    //with four workers, a selection and an aggregation of student scan the table in parallel and give the serial results
+    AK_Init_L3(&expr);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "year", sizeof("year"), expr);
+    AK_InsertAtEnd_L3(TYPE_INT, (char *)&year, sizeof(int), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, ">", sizeof(">"), expr);
+    AK_agg_input_init(&input);
+    header = AK_get_header("student");
+    for (i = 0; i < AK_num_attr("student"); i++)
+    {
+        if (strcmp(header[i].att_name, "year") == 0)
+        {
+            AK_agg_input_add(header[i], AGG_TASK_SUM, &input);
+            AK_agg_input_add(header[i], AGG_TASK_MAX, &input);
+            AK_agg_input_add(header[i], AGG_TASK_COUNT, &input);
+        }
+        else if (strcmp(header[i].att_name, "weight") == 0)
+            AK_agg_input_add(header[i], AGG_TASK_MIN, &input);
+    }
+    AK_free(header);
+    for (i = 0; i < 2; i++)
+    {
+        AK_parallel_set_workers(i == 0 ? 1 : 4);
+        checksum[i] = parallel[i] = 0;
+        plan = AK_select_operator(AK_scan_operator("student"), expr);
+        if (plan != NULL && AK_operator_open(plan) == EXIT_SUCCESS)
+        {
+            AK_operator_describe(plan, &info);
+            parallel[i] = info.parallel;
+            //rows are weighted by their position, so the order counts as well
+            j = AK_iterator_attr_index(plan->header, plan->num_attr, "year");
+            for (rows = 1; AK_operator_next(plan) == AK_ITERATOR_ROW; rows++)
+                checksum[i] += rows * (int)AK_iterator_number(plan->row, j);
+            AK_operator_close(plan);
+        }
+        AK_operator_free(plan);
+        memset(aggregates[i], 0, sizeof(aggregates[i]));
+        plan = AK_aggregation_operator(AK_scan_operator("student"), &input);
+        if (plan != NULL && AK_operator_open(plan) == EXIT_SUCCESS && AK_operator_next(plan) == AK_ITERATOR_ROW)
+            for (j = 0; j < plan->num_attr && j < 4; j++)
+                aggregates[i][j] = AK_iterator_number(plan->row, j);
+        AK_operator_free(plan);
+    }
+    AK_parallel_set_workers(0);
+    AK_DeleteAll_L3(&expr);
+    AK_free(expr);
+    printf("Parallel selection of student: checksum %d, serial %d, %s\n", checksum[1], checksum[0], parallel[1] ? "parallel" : "serial");
+    if (parallel[1] && !parallel[0] && checksum[1] > 0 && checksum[1] == checksum[0])
+        successful++;
+    else
+        failed++;
+    printf("Parallel aggregation of student: sum of years %.0f, serial %.0f\n", aggregates[1][0], aggregates[0][0]);
+    if (aggregates[1][0] > 0 && memcmp(aggregates[0], aggregates[1], sizeof(aggregates[0])) == 0)
+        successful++;
+    else
+        failed++;
+    AK_EPI;
+    return TEST_result(successful, failed);
+}
@@ -0,0 +1,128 @@
+/**
+@file parallel.h Header file that provides data structures and functions for parallel table scans
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#ifndef PARALLEL
+#define PARALLEL
+
+#include "../auxi/test.h"
+#include "../auxi/constants.h"
+#include "../auxi/configuration.h"
+#include "../auxi/mempro.h"
+#include "fileio.h"
+#include "table.h"
+
+/// upper bound of the number of workers of the pool
+#define AK_PARALLEL_MAX_WORKERS 64
+/// number of consecutive blocks of one task
+#define AK_PARALLEL_TASK_BLOCKS 4
+/// number of blocks from which a scan uses more than one worker on its own
+#define AK_PARALLEL_MIN_BLOCKS 64
+
+/**
+ * @author agent
+ * @struct AK_parallel_worker
+ * @brief Structure that defines one worker of a parallel scan, it is passed to the functions of the scan
+ */
+typedef struct {
+    /// index of the worker, 0 is the thread that started the scan
+    int id;
+    /// partial result of the worker, AK_parallel_job.partial_size zeroed bytes
+    void *partial;
+    /// memory of the worker that lives until its partial result is merged
+    AK_arena *scratch;
+    /// row the worker reads the rows of its blocks into
+    AK_row *row;
+    /// address of the block being read
+    int address;
+    /// slot of the row being read
+    int slot;
+    /// number of tasks the worker took from the deques of other workers
+    int stolen;
+} AK_parallel_worker;
+
+/**
+ * @author agent
+ * @struct AK_parallel_job
+ * @brief Structure that defines what a parallel scan does. Every worker reads whole blocks; block or row is called in
+ * the worker for every block or row it reads, done when it has no more tasks, and merge for every worker in order
+ * of id on the calling thread once all workers finished. Every function returns EXIT_SUCCESS or EXIT_ERROR, an error
+ * stops the scan.
+ */
+typedef struct {
+    /// function called for every block, NULL to call row for every row instead
+    int (*block)(AK_parallel_worker *worker, AK_block *block, void *context);
+    /// function called for every row when block is NULL
+    int (*row)(AK_parallel_worker *worker, AK_row *row, void *context);
+    /// function called by every worker after its last block, may be NULL
+    int (*done)(AK_parallel_worker *worker, void *context);
+    /// function merging the partial result of a worker, may be NULL; it is called for every worker, even on error
+    int (*merge)(AK_parallel_worker *worker, void *context);
+    /// data shared by all workers
+    void *context;
+    /// size of the partial result of a worker
+    size_t partial_size;
+    /// maximal number of workers, 0 for the number given by AK_parallel_workers
+    int workers;
+    /// receives the number of workers that took part
+    int used;
+    /// receives the number of tasks taken from other workers
+    int stolen;
+} AK_parallel_job;
+
+/**
+ * @author agent
+ * @brief  Function that returns the number of workers of the pool, number_of_threads of config.ini
+ * @return number of workers, the thread that starts a scan included
+ */
+int AK_parallel_size();
+
+/**
+ * @author agent
+ * @brief  Function that returns the number of workers an automatic scan of a table gets: as many as there are
+ * processors, up to the size of the pool, if the table has AK_PARALLEL_MIN_BLOCKS blocks, otherwise one. A scan
+ * started by a worker gets one.
+ * @param table table name
+ * @return number of workers
+ */
+int AK_parallel_workers(char *table);
+
+/**
+ * @author agent
+ * @brief  Function that sets the number of workers of automatic scans regardless of table size and processors
+ * @param workers number of workers, 0 to choose them by table size and processors again
+ * @return previous setting
+ */
+int AK_parallel_set_workers(int workers);
+
+/**
+ * @author agent
+ * @brief  Function that scans all blocks of a table with the worker pool. The blocks of every extent are cut into
+ * tasks of AK_PARALLEL_TASK_BLOCKS blocks, which are dealt to the deques of the workers in table order. A worker takes
+ * tasks from the end of its own deque and, when it is empty, steals from the front of the deques of the others. Blocks
+ * are pinned and latched for reading while they are scanned. A scan started by a worker or while the pool runs
+ * another scan is done by the calling thread alone.
+ * @param table table name
+ * @param job functions, context and size of the partial results
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+int AK_parallel_scan(char *table, AK_parallel_job *job);
+
+TestResult AK_parallel_test();
+
+#endif
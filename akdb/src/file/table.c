@@ -18,6 +18,7 @@
  */
 
 #include "../file/table.h"
+#include "../file/parallel.h"
 
 
 /**
@@ -115,11 +116,12 @@ void AK_temp_create_table(char *table, AK_header *header, int type_segment) {
 
     AK_write_block(sys_block);
     AK_free(sys_block);
+    AK_catalog_invalidate();
     AK_EPI;
 }
 
 /**
- * @author Matija Šestak, updated by Josip Šušnjara (chained blocks support)
+ * @author Matija Šestak, updated by Josip Šušnjara (chained blocks support), agent (catalog cache)
  * @brief  Functions that determines the number of attributes in the table
  * <ol>
  * <li>Read addresses of extents</li>
@@ -127,44 +129,63 @@ void AK_temp_create_table(char *table, AK_header *header, int type_segment) {
  * <li>else read the first block</li>
  * <li>while  header tuple exists in the block, increment num_attr</li>
  * </ol>
+ * The header is read once and kept in the catalog cache.
  * @param  * tblName table name
  * @return number of attributes in the table
  */
 int AK_num_attr(char * tblName) {
-    int num_attr = 0;
-    int i;
+    int num_attr;
     AK_PRO;
-    table_addresses *addresses = (table_addresses*) AK_get_table_addresses(tblName);
-    if (addresses->address_from[0] == 0)
-        num_attr = -2;
-    else {
-        AK_mem_block *temp_block = (AK_mem_block*) AK_get_block(addresses->address_from[0]);
-		
-		while(1){
-			i = 0;
-			while (strcmp(temp_block->block->header[i++].att_name, "\0") != 0) {
-            	num_attr++;
-        	}
-        	if(temp_block->block->chained_with != NOT_CHAINED){
-        		temp_block = (AK_mem_block*) AK_get_block(temp_block->block->chained_with);
-        	}
-        	else{
-        		break;
-        	}
-		}
-    }
-    AK_free(addresses);
+    num_attr = AK_catalog_num_attr(tblName);
     AK_EPI;
     return num_attr;
 }
 
 /**
- * @author Matija Šestak, updated by Josip Šušnjara (chained blocks support)
+ * @author agent
+ * @struct AK_count_context
+ * @brief Tuple counts of the blocks of a table, filled by a parallel scan
+ */
+typedef struct {
+    /// extents of the table
+    table_addresses *addresses;
+    /// used tuple_dict entries of every block in table order, EXIT_ERROR for an empty block
+    int *counts;
+} AK_count_context;
+
+/**
+ * @author agent
+ * @brief  Function that counts the used tuple_dict entries of a block for a parallel scan
+ * @param worker worker
+ * @param block block
+ * @param context tuple counts of the blocks
+ * @return EXIT_SUCCESS
+ */
+static int AK_count_block(AK_parallel_worker *worker, AK_block *block, void *context)
+{
+    AK_count_context *count = (AK_count_context *)context;
+    int i, k, n = 0, position = 0;
+    for (i = 0; worker->address < count->addresses->address_from[i] || worker->address >= count->addresses->address_to[i]; i++)
+        position += count->addresses->address_to[i] - count->addresses->address_from[i];
+    position += worker->address - count->addresses->address_from[i];
+    if (block->last_tuple_dict_id == 0 && block->tuple_dict[0].type == FREE_INT)
+        n = EXIT_ERROR;
+    for (k = 0; n != EXIT_ERROR && k < DATA_BLOCK_SIZE; k++)
+        if (block->tuple_dict[k].size > 0)
+            n++;
+    count->counts[position] = n;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @author Matija Šestak, updated by Josip Šušnjara (chained blocks support), agent (parallel scan)
  * @brief  Function that determines the number of rows in the table
  * <ol>
  * <li>Read addresses of extents</li>
  * <li>If there is no extents in the table, return EXIT_WARNING</li>
- * <li>For each extent from table</li>
+ * <li>If a row fits into one block, count tuples of all blocks with a parallel scan and add them up per extent until
+ * the first empty block</li>
+ * <li>Otherwise, for each extent from table</li>
  * <li>For each block in the extent</li>
  * <li>Get a block</li>
  * <li>Exit if there is no records in block</li>
@@ -177,21 +198,41 @@ int AK_num_attr(char * tblName) {
 int AK_get_num_records(char *tblName) {
     int num_rec = 0;
     int blocks_per_row; //how many chained blocks are needed to store one entry of the table
-    int i = 0, j, k;
+    int i = 0, j, k, l;
     int num_head;
+    AK_parallel_job job;
+    AK_count_context context;
     AK_PRO;
     table_addresses *addresses = AK_get_table_addresses(tblName);
     blocks_per_row = (AK_num_attr(tblName) - 1) / MAX_ATTRIBUTES + 1;
     if (addresses->address_from[0] == 0){
+        AK_free(addresses);
         AK_EPI;
         return EXIT_WARNING;
     }
     AK_mem_block *temp = AK_get_block(addresses->address_from[0]);
-    
-    while (addresses->address_from[i] != 0) {
+
+    //blocks are counted in parallel, the counts are added in table order up to the first empty block of each extent
+    for (k = 0, j = 0; k < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[k] != 0; k++)
+        j += addresses->address_to[k] - addresses->address_from[k];
+    context.addresses = addresses;
+    context.counts = blocks_per_row == 1 ? (int *)AK_calloc(j > 0 ? j : 1, sizeof(int)) : NULL;
+    memset(&job, 0, sizeof(AK_parallel_job));
+    job.block = AK_count_block;
+    job.context = &context;
+    if (context.counts != NULL && AK_parallel_scan(tblName, &job) == EXIT_SUCCESS)
+    {
+        for (k = 0, j = 0; k < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[k] != 0; j += addresses->address_to[k] - addresses->address_from[k], k++)
+            for (l = 0; l < addresses->address_to[k] - addresses->address_from[k] && context.counts[j + l] != EXIT_ERROR; l++)
+                num_rec += context.counts[j + l];
+        i = MAX_EXTENTS_IN_SEGMENT;
+    }
+    AK_free(context.counts);
+
+    while (i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0) {
         for (j = addresses->address_from[i]; j < addresses->address_to[i]; j += blocks_per_row) {
             temp = AK_get_block(j);
-            if (temp->block->last_tuple_dict_id == 0)
+            if (temp->block->last_tuple_dict_id == 0 && temp->block->tuple_dict[0].type == FREE_INT)
                 break;
             for (k = 0; k < DATA_BLOCK_SIZE; k++) {
                 if (temp->block->tuple_dict[k].size > 0) {
@@ -212,7 +253,7 @@ int AK_get_num_records(char *tblName) {
 }
 
 /**
- * @author Matija Šestak, updated by Josip Šušnjara (chained blocks support)
+ * @author Matija Šestak, updated by Josip Šušnjara (chained blocks support), agent (catalog cache)
  * @brief  Function that fetches the table header
  * <ol>
  * <li>Read addresses of extents</li>
@@ -221,43 +262,17 @@ int AK_get_num_records(char *tblName) {
  * <li>allocate array</li>
  * <li>copy table header to the array</li>
  * </ol>
+ * The header is copied from the catalog cache.
  * @param  *tblName table name
  * @result array of table header
  */
 AK_header *AK_get_header(char *tblName) {
-	int num_attr;
-	int current_attr;
     AK_PRO;
-    table_addresses *addresses = AK_get_table_addresses(tblName);
-    if (addresses->address_from[0] == 0){
+    AK_header *head = AK_catalog_get_header(tblName, NULL);
+    if (head == NULL){
         AK_EPI;
         return EXIT_WARNING + 2;
     }
-    AK_mem_block *temp = AK_get_block(addresses->address_from[0]);
-
-    num_attr = AK_num_attr(tblName);
-    
-    // Is calloc the right choice here? The memory gets overridden immediately anyway
-    //AK_header *head = (AK_header*) AK_calloc(num_attr, sizeof (AK_header));
-    AK_header *head = AK_malloc(sizeof(AK_header) * num_attr);
-    current_attr = 0;
-    while(1){
-        for (int i = 0; i < MAX_ATTRIBUTES && current_attr < num_attr; i++){
-            if (strcmp(temp->block->header[i].att_name, "\0") == 0){
-                break;
-            }
-            head[current_attr] = temp->block->header[i];
-            current_attr++;
-        }
-        if(temp->block->chained_with != NOT_CHAINED){
-			temp = AK_get_block(temp->block->chained_with);
-		}
-		else{
-			break;
-		}
-	}
-
-	AK_free(addresses);
     AK_EPI;
     return head;
 }
@@ -285,7 +300,7 @@ char *AK_get_attr_name(char *tblName, int index) {
 }
 
 /**
- * @author Matija Šestak.
+ * @author Matija Šestak, updated by agent (catalog cache)
  * @brief  Function that fetches zero-based index for atrribute
  * @param  *tblName table name
  * @param *attrName attribute name
@@ -297,18 +312,9 @@ int AK_get_attr_index(char *tblName, char *attrName) {
         AK_EPI;
         return EXIT_WARNING;
     }
-    int num_attr = AK_num_attr(tblName);
-    AK_header *header = AK_get_header(tblName);
-    for(int index = 0; index < num_attr; index++) {
-        if (strcmp(attrName, (header + index)->att_name) == 0) {
-			AK_free(header);
-            AK_EPI;
-            return index;
-        }
-    }
-	AK_free(header);
+    int index = AK_catalog_get_attr_index(tblName, attrName);
     AK_EPI;
-    return EXIT_WARNING;
+    return index;
 }
 
 /**
@@ -422,6 +428,101 @@ struct list_node *AK_get_row(int num, char * tblName) {
     return NULL;
 }
 
+/**
+ * @author agent
+ * @brief  Function that opens a cursor on a table
+ * @param *tblName table name
+ * @return cursor positioned before the first row, NULL on error
+ */
+AK_cursor *AK_cursor_open(char *tblName) {
+    AK_PRO;
+    AK_cursor *cursor = (AK_cursor *) AK_calloc(1, sizeof (AK_cursor));
+    if (cursor == NULL) {
+        AK_EPI;
+        return NULL;
+    }
+    cursor->addresses = (table_addresses *) AK_get_table_addresses(tblName);
+    cursor->row = (struct list_node *) AK_calloc(1, sizeof (struct list_node));
+    if (cursor->addresses == NULL || cursor->row == NULL) {
+        AK_free(cursor->addresses);
+        AK_free(cursor->row);
+        AK_free(cursor);
+        AK_EPI;
+        return NULL;
+    }
+    AK_Init_L3(&cursor->row);
+    cursor->num_attr = AK_num_attr(tblName);
+    cursor->block = cursor->addresses->address_from[0];
+    cursor->index = -1;
+    AK_EPI;
+    return cursor;
+}
+
+/**
+ * @author agent
+ * @brief  Function that moves a cursor to the next row. Like AK_get_row, it goes on with the next extent at a block
+ * without tuples and skips slots whose first value is empty. The block is fetched from the cache on every call.
+ * @param *cursor cursor, NULL for a cursor that could not be opened
+ * @return list with the values of the row, owned by the cursor and valid until the next call; NULL after the last row
+ */
+struct list_node *AK_cursor_next(AK_cursor *cursor) {
+    AK_block *block;
+    char data[MAX_VARCHAR_LENGTH];
+    int k, l, size, address;
+    AK_PRO;
+    if (cursor == NULL) {
+        AK_EPI;
+        return NULL;
+    }
+    AK_DeleteAll_L3(&cursor->row);
+    while (cursor->num_attr > 0 && cursor->extent < MAX_EXTENTS_IN_SEGMENT && cursor->addresses->address_from[cursor->extent] != 0) {
+        block = cursor->block < cursor->addresses->address_to[cursor->extent] ? ((AK_mem_block *) AK_get_block(cursor->block))->block : NULL;
+        //a block holding one row of one attribute has last_tuple_dict_id 0 too
+        if (block == NULL || (block->last_tuple_dict_id == 0 && block->tuple_dict[0].type == FREE_INT)) {
+            cursor->extent++;
+            cursor->block = cursor->extent < MAX_EXTENTS_IN_SEGMENT ? cursor->addresses->address_from[cursor->extent] : 0;
+            cursor->slot = 0;
+            continue;
+        }
+        while (cursor->slot + cursor->num_attr <= DATA_BLOCK_SIZE) {
+            k = cursor->slot;
+            cursor->slot += cursor->num_attr;
+            if (block->tuple_dict[k].size <= 0)
+                continue;
+            for (l = 0; l < cursor->num_attr; l++) {
+                size = block->tuple_dict[k + l].size;
+                address = block->tuple_dict[k + l].address;
+                memcpy(data, &(block->data[address]), size);
+                data[size] = '\0';
+                AK_InsertAtEnd_L3(block->tuple_dict[k + l].type, data, size, cursor->row);
+            }
+            cursor->index++;
+            AK_EPI;
+            return cursor->row;
+        }
+        cursor->block++;
+        cursor->slot = 0;
+    }
+    AK_EPI;
+    return NULL;
+}
+
+/**
+ * @author agent
+ * @brief  Function that closes a cursor and frees it
+ * @param *cursor cursor, may be NULL
+ */
+void AK_cursor_close(AK_cursor *cursor) {
+    AK_PRO;
+    if (cursor != NULL) {
+        AK_DeleteAll_L3(&cursor->row);
+        AK_free(cursor->row);
+        AK_free(cursor->addresses);
+        AK_free(cursor);
+    }
+    AK_EPI;
+}
+
 /**
  * @author Barbara Tatai, updated by Josip Šušnjara (chained blocks support)
  * @brief Function that finds the tuple in memory
@@ -1104,28 +1205,15 @@ int AK_table_empty(char *tblName) {
 }
 
 /**
- * @author Dejan Frankovic
+ * @author Dejan Frankovic, updated by agent (catalog cache)
  * @brief  Function that fetches an obj_id of named table from AK_relation system table
  * @param *table table name
  * @return obj_id of the table or EXIT_ERROR if there is no table with that name
  */
 int AK_get_table_obj_id(char *table) {
-    int i = 0, table_id = -1;
-    struct list_node *row;
-
-    i = 0;
+    int table_id;
     AK_PRO;
-    while ((row = AK_get_row(i, "AK_relation")) != NULL) {
-        if (strcmp(row->next->next->data, table) == 0) {
-            memcpy(&table_id, row->next->data, sizeof (int));
-            break;
-        }
-        i++;
-    }
-    if (table_id == -1){
-        AK_EPI;
-        return EXIT_ERROR;
-    }
+    table_id = AK_catalog_get_obj_id(table);
     AK_EPI;
     return table_id;
 }
@@ -1230,6 +1318,7 @@ int AK_rename(char *old_table_name, char *old_attr, char *new_table_name, char *
             memcpy(&mem_block->block->header, newHeader, sizeof (AK_header) * MAX_ATTRIBUTES);
             AK_mem_block_modify(mem_block, BLOCK_DIRTY);
         }
+        AK_catalog_invalidate();
     }
 
     if (strcmp(old_table_name, new_table_name) != 0) {//new name is different than old, and old needs to be replaced
@@ -1258,6 +1347,7 @@ int AK_rename(char *old_table_name, char *old_attr, char *new_table_name, char *
   AK_Update_Existing_Element(TYPE_VARCHAR, old_table_name, system_table, "name", row_root);
   AK_delete_row(row_root);
   AK_free(row_root);
+  AK_catalog_invalidate();
     }
     AK_EPI;
     return EXIT_SUCCESS;
@@ -1491,15 +1581,66 @@ TestResult AK_table_test() {
         failedTests += !testConditions[i];
     }
 	
+    printf("\nTable \"student\": AK_cursor\n");
+    AK_cursor *cursor = AK_cursor_open("student");
+    struct list_node *cursor_row, *stored_row;
+    int cursor_matches = 1;
+    while ((cursor_row = AK_cursor_next(cursor)) != NULL) {
+        stored_row = AK_get_row(cursor->index, "student");
+        if (stored_row == NULL || strcmp(AK_tuple_to_string(AK_First_L2(cursor_row)), AK_tuple_to_string(AK_First_L2(stored_row))) != 0)
+            cursor_matches = 0;
+        if (stored_row != NULL) {
+            AK_DeleteAll_L3(&stored_row);
+            AK_free(stored_row);
+        }
+    }
+    if (cursor_matches && cursor->index + 1 == AK_get_num_records("student")) {
+        successfulTests++;
+    }
+    else {
+        printf("Cursor read %d rows of table \"student\", they should be the rows of AK_get_row.\n", cursor->index + 1);
+        failedTests++;
+    }
+    AK_cursor_close(cursor);
+
+    //the block of a table with one attribute and one row has last_tuple_dict_id 0
+    char *single_name = "table_c_cursor_test";
+    int single_value = 42, single_rows = 0;
+    if (!AK_table_exist(single_name)) {
+        AK_create_table_parameter *single_param = AK_create_create_table_parameter(TYPE_INT, "value");
+        AK_create_table(single_name, single_param, 1);
+        AK_free(single_param);
+        struct list_node *single_row = (struct list_node *) AK_malloc(sizeof (struct list_node));
+        AK_Init_L3(&single_row);
+        AK_Insert_New_Element(TYPE_INT, &single_value, single_name, "value", single_row);
+        AK_insert_row(single_row);
+        AK_DeleteAll_L3(&single_row);
+        AK_free(single_row);
+    }
+    cursor = AK_cursor_open(single_name);
+    while ((cursor_row = AK_cursor_next(cursor)) != NULL)
+        single_rows += memcmp(((struct list_node *) AK_First_L2(cursor_row))->data, &single_value, sizeof(int)) == 0;
+    AK_cursor_close(cursor);
+    if (single_rows == 1) {
+        successfulTests++;
+    }
+    else {
+        printf("Cursor read %d rows of table \"%s\", it has one.\n", single_rows, single_name);
+        failedTests++;
+    }
+
     char * table_name = "table_c_create_table_test";
 
     printf("\nTable \"%s\":AK_create_table\n", table_name);
 
-    AK_create_table_parameter *params = (AK_create_table_parameter *) AK_malloc(2 * sizeof(AK_create_table_parameter*));
+    AK_create_table_parameter *params = (AK_create_table_parameter *) AK_malloc(2 * sizeof(AK_create_table_parameter));
 
     params[0] = *(AK_create_create_table_parameter(TYPE_INT, "ID"));
     params[1] = *(AK_create_create_table_parameter(TYPE_VARCHAR, "Name"));
 
+    //looked up before it exists, so creating the table has to replace the miss kept in the catalog cache
+    AK_num_attr(table_name);
+
     AK_create_table(table_name, params, 2);
 
     if(AK_table_exist(table_name)){
@@ -1517,6 +1658,15 @@ TestResult AK_table_test() {
         printf("Table \"%s\" should have 2 attributes.", table_name);
         failedTests++;
     }    
+
+    AK_rename(table_name, "Name", table_name, "Title");
+    if(AK_get_attr_index(table_name, "Title") == 1 && AK_get_attr_index(table_name, "Name") == EXIT_WARNING){
+        successfulTests++;
+    }
+    else{
+        printf("Renamed attribute of table \"%s\" not found.", table_name);
+        failedTests++;
+    }
     
     AK_free(params);
 
@@ -132,6 +132,52 @@ struct list_node *AK_get_column(int num, char *tblName);
  */
 struct list_node * AK_get_row(int num, char * tblName);
 
+/**
+ * @author agent
+ * @struct AK_cursor
+ * @brief Structure that defines a cursor over the rows of a table. It keeps its block and slot, so reading all rows
+ * takes one pass over the table instead of a search from the first block for every row as with AK_get_row.
+ */
+typedef struct {
+    /// extents of the table
+    table_addresses *addresses;
+    /// number of attributes of the table
+    int num_attr;
+    /// current extent
+    int extent;
+    /// current block
+    int block;
+    /// next tuple_dict entry to read in the current block
+    int slot;
+    /// zero-based index of the current row, the number AK_get_row gives it
+    int index;
+    /// values of the current row
+    struct list_node *row;
+} AK_cursor;
+
+/**
+ * @author agent
+ * @brief  Function that opens a cursor on a table
+ * @param *tblName table name
+ * @return cursor positioned before the first row, NULL on error
+ */
+AK_cursor *AK_cursor_open(char *tblName);
+
+/**
+ * @author agent
+ * @brief  Function that moves a cursor to the next row. Rows come in the order of AK_get_row.
+ * @param *cursor cursor, NULL for a cursor that could not be opened
+ * @return list with the values of the row, owned by the cursor and valid until the next call; NULL after the last row
+ */
+struct list_node *AK_cursor_next(AK_cursor *cursor);
+
+/**
+ * @author agent
+ * @brief  Function that closes a cursor and frees it
+ * @param *cursor cursor, may be NULL
+ */
+void AK_cursor_close(AK_cursor *cursor);
+
 /**
  * @author Matija Šestak.
  * @brief Function that fetches a value in some row and column
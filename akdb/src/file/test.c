@@ -1116,7 +1116,6 @@ void AK_create_test_table_department(){
 	*/
     struct list_node *row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
 
-	AK_DeleteAll_L3(&row_root);
     AK_Init_L3(&row_root);
 
     id_department = 1;
@@ -50,6 +50,14 @@ int main(int argc, char * argv[])
     AK_synchronization_info* const fileLock = dbmanFileLock.ptr;
     printf("Init: %d, ready: %d", fileLock->init, fileLock->ready);
     AK_check_folder_blobs();
+    if((argc == 4) && !strcmp(argv[1], "migrate"))
+    {
+		//converts a DB file of an older format into the current one
+        AK_inflate_config();
+        int result = AK_migrate_db_file(argv[2], argv[3]);
+        AK_EPI;
+        return result;
+    }
     if((argc == 2) && (!strcmp(argv[1], "help") )|| (argc > 3)  || !(!strcmp(argv[1], "test") || !strcmp(argv[1], "alltest")))
 		//if we write ./akdb test help, or write any mistake or ask for any kind of help the help will pop up
        help();
@@ -21,51 +21,331 @@
  * with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <unistd.h>
 #include "memoman.h"
 #include "../dm/dbman.h"
+#include "../file/fileio.h"
 
 PtrContainer db_cache;
 PtrContainer redo_log;
 PtrContainer query_mem;
+PtrContainer catalog_cache;
+PtrContainer free_space_map;
+
+/// returned by AK_get_frame when every frame of the buffer pool is pinned
+#define AK_POOL_EXHAUSTED -2
+
+static void AK_cache_clock_access(AK_mem_block *mem_block);
+static int AK_cache_clock_victim();
+static void AK_cache_lru_k_access(AK_mem_block *mem_block);
+static int AK_cache_lru_k_victim();
+
+/**
+ * @var AK_cache_policies
+ * @brief Page replacement policies the buffer pool can be configured with
+ */
+static const AK_cache_policy AK_cache_policies[] = {
+	{"clock", &AK_cache_clock_access, &AK_cache_clock_victim},
+	{"lru-k", &AK_cache_lru_k_access, &AK_cache_lru_k_victim}
+};
+
+/**
+  * @author agent
+  * @brief Function that computes the home slot of a block address in the page table (multiplicative hashing)
+  * @param num block number (address)
+  * @return index of the home slot
+ */
+static int AK_page_table_slot(int num)
+{
+	AK_db_cache* const dbCache = db_cache.ptr;
+	return (int)(((unsigned int)num * 2654435761u) & (unsigned int)(dbCache->page_table_size - 1));
+}
+
+/**
+  * @author agent
+  * @brief Function that finds the frame holding a block by looking it up in the page table
+  * @param num block number (address)
+  * @return index of the frame, -1 if the block is not cached
+ */
+int AK_cache_lookup(int num)
+{
+	AK_db_cache* const dbCache = db_cache.ptr;
+	int mask = dbCache->page_table_size - 1;
+	int slot = AK_page_table_slot(num);
+	int frame = -1;
+
+	pthread_mutex_lock(&dbCache->pool_lock);
+	while (dbCache->page_table[slot].address != -1)
+	{
+		if (dbCache->page_table[slot].address == num)
+		{
+			frame = dbCache->page_table[slot].frame;
+			break;
+		}
+		slot = (slot + 1) & mask;
+	}
+	pthread_mutex_unlock(&dbCache->pool_lock);
+	return frame;
+}
+
+/**
+  * @author agent
+  * @brief Function that inserts a block address into the page table
+  * @param num block number (address)
+  * @param frame index of the frame holding the block
+ */
+static void AK_page_table_insert(int num, int frame)
+{
+	AK_db_cache* const dbCache = db_cache.ptr;
+	int mask = dbCache->page_table_size - 1;
+	int slot = AK_page_table_slot(num);
+
+	while (dbCache->page_table[slot].address != -1 && dbCache->page_table[slot].address != num)
+		slot = (slot + 1) & mask;
+	dbCache->page_table[slot].address = num;
+	dbCache->page_table[slot].frame = frame;
+}
+
+/**
+  * @author agent
+  * @brief Function that removes a block address from the page table. Entries following the removed one are
+  * shifted back so that lookups never need tombstones.
+  * @param num block number (address)
+ */
+static void AK_page_table_remove(int num)
+{
+	AK_db_cache* const dbCache = db_cache.ptr;
+	int mask = dbCache->page_table_size - 1;
+	int slot = AK_page_table_slot(num);
+	int next, home;
+
+	while (dbCache->page_table[slot].address != num)
+	{
+		if (dbCache->page_table[slot].address == -1)
+			return;
+		slot = (slot + 1) & mask;
+	}
+
+	next = (slot + 1) & mask;
+	while (dbCache->page_table[next].address != -1)
+	{
+		home = AK_page_table_slot(dbCache->page_table[next].address);
+		/// move the entry back if its home slot is not between the hole and its current position
+		if (((next - home) & mask) >= ((next - slot) & mask))
+		{
+			dbCache->page_table[slot] = dbCache->page_table[next];
+			slot = next;
+		}
+		next = (next + 1) & mask;
+	}
+	dbCache->page_table[slot].address = -1;
+	dbCache->page_table[slot].frame = -1;
+}
+
+/**
+  * @author agent
+  * @brief Function that removes the block held by a frame from the page table, leaving the frame free
+  * @param mem_block frame of the buffer pool
+ */
+static void AK_cache_unmap_frame(AK_mem_block *mem_block)
+{
+	if (mem_block->address != -1)
+	{
+		AK_page_table_remove(mem_block->address);
+		mem_block->address = -1;
+	}
+	mem_block->reference = 0;
+	memset(mem_block->history, 0, sizeof(mem_block->history));
+}
+
+/**
+  * @author agent
+  * @brief Function that records a reference of a frame for the CLOCK policy
+  * @param mem_block referenced frame
+ */
+static void AK_cache_clock_access(AK_mem_block *mem_block)
+{
+	mem_block->reference = 1;
+}
+
+/**
+  * @author agent
+  * @brief Function that chooses the frame to be replaced by the CLOCK (second chance) policy. The hand sweeps
+  * the frames, clearing reference bits, until it finds an unpinned frame that has not been referenced since the
+  * last sweep.
+  * @return index of the frame to be replaced, EXIT_ERROR if all frames are pinned
+ */
+static int AK_cache_clock_victim()
+{
+	AK_db_cache* const dbCache = db_cache.ptr;
+	AK_mem_block *mem_block;
+	int victim, i;
+
+	/// two sweeps clear every reference bit, so an unpinned frame is found if there is one
+	for (i = 0; i <= 2 * dbCache->size; i++)
+	{
+		victim = dbCache->next_replace;
+		dbCache->next_replace = (dbCache->next_replace + 1) % dbCache->size;
+		mem_block = dbCache->cache[victim];
+		if (mem_block->pin_count > 0)
+			continue;
+		if (mem_block->address == -1 || mem_block->reference == 0)
+			return victim;
+		mem_block->reference = 0;
+	}
+	return EXIT_ERROR;
+}
+
+/**
+  * @author agent
+  * @brief Function that records a reference of a frame for the LRU-K policy
+  * @param mem_block referenced frame
+ */
+static void AK_cache_lru_k_access(AK_mem_block *mem_block)
+{
+	AK_db_cache* const dbCache = db_cache.ptr;
+	int i;
+
+	for (i = dbCache->lru_k - 1; i > 0; i--)
+		mem_block->history[i] = mem_block->history[i - 1];
+	mem_block->history[0] = ++dbCache->access_time;
+}
+
+/**
+  * @author agent
+  * @brief Function that chooses the frame to be replaced by the LRU-K policy: the frame whose K-th most recent
+  * reference is the oldest. Frames referenced fewer than K times have an infinite backward K-distance and are
+  * replaced first, the least recently used among them. Pinned frames are skipped.
+  * @return index of the frame to be replaced, EXIT_ERROR if all frames are pinned
+ */
+static int AK_cache_lru_k_victim()
+{
+	AK_db_cache* const dbCache = db_cache.ptr;
+	AK_mem_block *mem_block;
+	int i, k = dbCache->lru_k - 1;
+	int victim = -1, victim_full = 0;
+
+	for (i = 0; i < dbCache->size; i++)
+	{
+		mem_block = dbCache->cache[i];
+		if (mem_block->pin_count > 0)
+			continue;
+		if (mem_block->address == -1)
+			return i;
+		if (victim == -1)
+		{
+			victim = i;
+			victim_full = mem_block->history[k] != 0;
+			continue;
+		}
+		if (mem_block->history[k] == 0)
+		{
+			/// fewer than K references - compare the last reference
+			if (victim_full || mem_block->history[0] < dbCache->cache[victim]->history[0])
+			{
+				victim = i;
+				victim_full = 0;
+			}
+		}
+		else if (victim_full && mem_block->history[k] < dbCache->cache[victim]->history[k])
+			victim = i;
+	}
+	return victim == -1 ? EXIT_ERROR : victim;
+}
+
+/**
+ * @author agent
+ * @brief Function that selects the replacement policy of the buffer pool
+ * @param name policy name ("clock" or "lru-k")
+ * @return EXIT_SUCCESS if the policy exists, EXIT_ERROR otherwise
+ */
+int AK_cache_set_policy(const char *name)
+{
+	int i;
+	AK_PRO;
+	AK_db_cache* const dbCache = db_cache.ptr;
+	for (i = 0; i < sizeof(AK_cache_policies) / sizeof(AK_cache_policies[0]); i++)
+	{
+		if (strcmp(AK_cache_policies[i].name, name) == 0)
+		{
+			pthread_mutex_lock(&dbCache->pool_lock);
+			dbCache->policy = &AK_cache_policies[i];
+			pthread_mutex_unlock(&dbCache->pool_lock);
+			AK_EPI;
+			return EXIT_SUCCESS;
+		}
+	}
+	printf("AK_cache_set_policy: ERROR. Unknown cache policy %s.\n", name);
+	AK_EPI;
+	return EXIT_ERROR;
+}
 
 /**
-  * @author Nikola Bakoš, Matija Šestak(revised)
-  * @brief Function that caches a block into the memory.
+  * @author Nikola Bakoš, Matija Šestak(revised), updated by agent
+  * @brief Function that caches a block into the memory. If the memory block is a frame of the buffer pool, the
+  * page table is updated so the frame is found by the block address.
   * @param num block number (address)
   * @param mem_block address of memmory block
   * @return EXIT_SUCCESS if the block has been successfully read into memory, EXIT_ERROR otherwise
  */
-
 int AK_cache_block(int num, AK_mem_block *mem_block)
 {
 	unsigned long timestamp;
 	AK_block *block_cache;
 	AK_block *block_cache_old;
+	int frame;
 	AK_PRO;
 	/// read the block from the given address
 	block_cache = AK_read_block(num);
-	block_cache_old = mem_block->block;
-	mem_block->block = block_cache;
+	if (block_cache == NULL)
+	{
+		AK_EPI;
+		return EXIT_ERROR;
+	}
+	/// refill the frame in place so block pointers already handed out stay valid
+	block_cache_old = block_cache;
+	if (mem_block->block == NULL)
+	{
+		mem_block->block = block_cache;
+		block_cache_old = NULL;
+	}
+	else
+		memcpy(mem_block->block, block_cache, sizeof(AK_block));
 	mem_block->dirty = BLOCK_CLEAN; /// set dirty bit in mem_block struct
 
 	timestamp = clock(); /// get the timestamp
 	mem_block->timestamp_read = timestamp; /// set timestamp_read
 	mem_block->timestamp_last_change = timestamp; /// set timestamp_last_change
 
-	if(sizeof(block_cache) == 0)
+	if (mem_block->frame >= 0)
 	{
-		AK_EPI;
-		return EXIT_ERROR;
+		AK_db_cache* const dbCache = db_cache.ptr;
+		pthread_mutex_lock(&dbCache->pool_lock);
+		/// a block may be held by one frame only
+		AK_cache_unmap_frame(mem_block);
+		frame = AK_cache_lookup(num);
+		if (frame != -1)
+		{
+			AK_cache_unmap_frame(dbCache->cache[frame]);
+			if (dbCache->free_count < dbCache->size)
+				dbCache->free_frames[dbCache->free_count++] = frame;
+		}
+		AK_page_table_insert(num, mem_block->frame);
+		mem_block->address = num;
+		dbCache->policy->access(mem_block);
+		pthread_mutex_unlock(&dbCache->pool_lock);
 	}
 
-	AK_free(block_cache_old);
+	if (block_cache_old != NULL)
+		AK_free(block_cache_old);
 	AK_EPI;
 	return EXIT_SUCCESS;
 }
 
 /**
   * @author Markus Schatten, Matija Šestak(revised)
-  * @brief Function that initializes the global cache memory (variable db_cache)
+  * @brief Function that initializes the global cache memory (variable db_cache). Frames are allocated up front
+  * and put on the free stack; blocks are read into them on demand by AK_get_block.
   * @return EXIT_SUCCESS if the cache memory has been initialized, EXIT_ERROR otherwise
  */
 int AK_cache_AK_malloc()
@@ -78,18 +358,67 @@ int AK_cache_AK_malloc()
 		return EXIT_ERROR;
 	}
 	AK_db_cache* const dbCache = db_cache.ptr;
-	dbCache->next_replace = -1;
-	for (i = 0; i < MAX_CACHE_MEMORY; i++)
+	dbCache->size = CACHE_SIZE;
+	if (dbCache->size <= 0)
+	{
+		printf("AK_cache_AK_malloc: ERROR. Invalid cache size %d, using %d.\n", dbCache->size, MAX_CACHE_MEMORY);
+		dbCache->size = MAX_CACHE_MEMORY;
+	}
+	dbCache->lru_k = CACHE_LRU_K;
+	if (dbCache->lru_k < 1 || dbCache->lru_k > AK_LRU_K_MAX)
+	{
+		printf("AK_cache_AK_malloc: ERROR. Invalid LRU-K parameter %d, using 2.\n", dbCache->lru_k);
+		dbCache->lru_k = 2;
+	}
+	dbCache->access_time = 0;
+	dbCache->next_replace = 0;
+	{
+		/// pool functions call each other, so the pool lock is recursive
+		pthread_mutexattr_t attr;
+		pthread_mutexattr_init(&attr);
+		pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+		pthread_mutex_init(&dbCache->pool_lock, &attr);
+		pthread_mutexattr_destroy(&attr);
+	}
+	dbCache->policy = &AK_cache_policies[0];
+	if (AK_cache_set_policy(CACHE_POLICY) == EXIT_ERROR)
+		printf("AK_cache_AK_malloc: Using %s cache policy.\n", dbCache->policy->name);
+
+	dbCache->page_table_size = 1;
+	while (dbCache->page_table_size < 2 * dbCache->size)
+		dbCache->page_table_size <<= 1;
+
+	dbCache->cache = (AK_mem_block **) AK_malloc(dbCache->size * sizeof(AK_mem_block *));
+	dbCache->page_table = (AK_page_table_entry *) AK_malloc(dbCache->page_table_size * sizeof(AK_page_table_entry));
+	dbCache->free_frames = (int *) AK_malloc(dbCache->size * sizeof(int));
+	if (dbCache->cache == NULL || dbCache->page_table == NULL || dbCache->free_frames == NULL)
+	{
+		AK_EPI;
+		return EXIT_ERROR;
+	}
+
+	for (i = 0; i < dbCache->page_table_size; i++)
 	{
-		dbCache->cache[ i ] = (AK_mem_block *) AK_malloc(sizeof(AK_mem_block));
-		dbCache->cache[ i ]->block = (AK_block *) AK_malloc(sizeof(AK_block));
+		dbCache->page_table[i].address = -1;
+		dbCache->page_table[i].frame = -1;
+	}
 
-		if ((AK_cache_block(i, dbCache->cache[ i ])) == EXIT_ERROR)
+	/// frames are pushed in reverse so the first frame is handed out first
+	dbCache->free_count = 0;
+	for (i = dbCache->size - 1; i >= 0; i--)
+	{
+		dbCache->cache[ i ] = (AK_mem_block *) AK_calloc(1, sizeof(AK_mem_block));
+		if (dbCache->cache[ i ] == NULL || (dbCache->cache[ i ]->block = (AK_block *) AK_malloc(sizeof(AK_block))) == NULL)
 		{
 			AK_EPI;
 			return EXIT_ERROR;
 		}
-		//printf( "Cached block %d with address %d\n", i,  &db_cache->cache[ i ]->block->address );
+		dbCache->cache[ i ]->dirty = BLOCK_CLEAN;
+		dbCache->cache[ i ]->frame = i;
+		dbCache->cache[ i ]->address = -1;
+		dbCache->cache[ i ]->block->address = -1;
+		pthread_rwlock_init(&dbCache->cache[ i ]->latch, NULL);
+		dbCache->free_frames[ dbCache->free_count++ ] = i;
 	}
 	AK_EPI;
 	return EXIT_SUCCESS;
@@ -320,7 +649,7 @@ void AK_query_mem_AK_free()
 
 /**
  * @author Miroslav Policki
- * @brief  Function that initializes the memory manager (cache, redo log and query memory)
+ * @brief  Function that initializes the memory manager (cache, redo log, query memory, catalog cache and free space map)
  * @return EXIT_SUCCESS if the query memory manager has been initialized, EXIT_ERROR otherwise
  */
 int AK_memoman_init()
@@ -350,6 +679,20 @@ int AK_memoman_init()
 	}
 
 
+	if (AK_catalog_AK_malloc() == EXIT_ERROR)
+	{
+		printf("AK_memoman_init: ERROR. AK_catalog_AK_malloc() failed.\n");
+		AK_EPI;
+		return EXIT_ERROR;
+	}
+
+	if (AK_fsm_AK_malloc() == EXIT_ERROR)
+	{
+		printf("AK_memoman_init: ERROR. AK_fsm_AK_malloc() failed.\n");
+		AK_EPI;
+		return EXIT_ERROR;
+	}
+
 	printf("AK_memoman_init: Memory manager initialized...\n");
 	AK_EPI;
 	return EXIT_SUCCESS;
@@ -358,131 +701,322 @@ int AK_memoman_init()
 
 
 /**
-  * @author Tomislav Fotak, updated by Matija Šestak, Antonio Martinović
-  * @brief Function that reads a block from the memory. If the block is cached, returns the cached block. Else uses AK_cache_block to read the block
-		to cache and then returns it.
+  * @author agent
+  * @brief Function that claims a frame for disk I/O. The frame is pinned, marked as being in I/O and latched
+  * exclusively, so threads asking for its block wait on the latch. Must be called with the pool lock held, the
+  * frame must not be latched.
+  * @param mem_block frame of the buffer pool
+ */
+static void AK_frame_begin_io(AK_mem_block *mem_block)
+{
+	mem_block->pin_count++;
+	mem_block->io_pending = 1;
+	pthread_rwlock_wrlock(&mem_block->latch);
+}
+
+/**
+  * @author agent
+  * @brief Function that publishes a frame claimed by AK_frame_begin_io, waking the threads waiting for it. Must be
+  * called with the pool lock held.
+  * @param mem_block frame of the buffer pool
+ */
+static void AK_frame_end_io(AK_mem_block *mem_block)
+{
+	mem_block->io_pending = 0;
+	mem_block->pin_count--;
+	pthread_rwlock_unlock(&mem_block->latch);
+}
+
+/**
+  * @author agent
+  * @brief Function that finds the frame holding a block, reading the block into a free or released frame if it
+  * is not cached. The frame is claimed under the pool lock, the lock is released while the replaced block is
+  * written and the new one read. The block is mapped to the frame before the read, so a thread asking for it
+  * meanwhile waits on the frame latch instead of reading it into another frame.
   * @param num block number (address)
-  * @return segment start address
+  * @return index of the frame, pinned; -1 if the block could not be read, AK_POOL_EXHAUSTED if every frame is
+  * pinned or the replaced block could not be written
  */
-AK_mem_block *AK_get_block(int num)
+static int AK_get_frame(int num)
 {
-	int i = 0;
-	int free_pos = 0;
-	int first_AK_free_mem_block = -1;
-	AK_PRO;
+	int frame, old_address, write_old;
+	unsigned long timestamp;
+	AK_mem_block *mem_block;
+	AK_block *block_cache;
 	AK_db_cache* const dbCache = db_cache.ptr;
-	/* search cache for already-cached block */
-	for (i = 0; i < MAX_CACHE_MEMORY; i++)
+
+	pthread_mutex_lock(&dbCache->pool_lock);
+	/* search page table for already-cached block */
+	while ((frame = AK_cache_lookup(num)) != -1)
 	{
-		if (dbCache->cache[i]->block->address == num)
+		mem_block = dbCache->cache[frame];
+		mem_block->pin_count++;
+		dbCache->policy->access(mem_block);
+		if (!mem_block->io_pending)
 		{
 			/// found cached! we're done here
-			AK_EPI;
-
-			return dbCache->cache[i];
+			pthread_mutex_unlock(&dbCache->pool_lock);
+			return frame;
+		}
+		/// another thread is reading or writing the frame, its exclusive latch is released when it is done
+		pthread_mutex_unlock(&dbCache->pool_lock);
+		pthread_rwlock_rdlock(&mem_block->latch);
+		pthread_rwlock_unlock(&mem_block->latch);
+		pthread_mutex_lock(&dbCache->pool_lock);
+		if (mem_block->address == num && !mem_block->io_pending)
+		{
+			pthread_mutex_unlock(&dbCache->pool_lock);
+			return frame;
 		}
+		/// the frame was being replaced or the read failed, look again
+		mem_block->pin_count--;
+	}
 
+	/// take a free frame; frames that got a block in the meantime are skipped
+	while (dbCache->free_count > 0)
+	{
+		frame = dbCache->free_frames[--dbCache->free_count];
+		if (dbCache->cache[frame]->address == -1 && dbCache->cache[frame]->pin_count == 0)
+			break;
+		frame = -1;
 	}
 
-	for (i = 0; i < MAX_CACHE_MEMORY; i++)
+	if (frame == -1)
 	{
-		/// while looking for block we also want to find an empty block
-		/// in case that the actual block is not found
-		/// then there is no need to run through the blocks twice
-		if (first_AK_free_mem_block == -1 && dbCache->cache[i]->timestamp_read == -1)
+		/// no free cache blocks found, we need to clear some now
+		frame = dbCache->policy->victim();
+		if (frame < 0)
 		{
-			first_AK_free_mem_block = i;
+			pthread_mutex_unlock(&dbCache->pool_lock);
+			return AK_POOL_EXHAUSTED;
 		}
-
 	}
 
-	if (first_AK_free_mem_block != -1)
+	mem_block = dbCache->cache[frame];
+	AK_frame_begin_io(mem_block);
+	old_address = mem_block->address;
+	write_old = old_address != -1 && mem_block->dirty == BLOCK_DIRTY;
+	/// a dirty block stays mapped until it is written, so it is not read from disk before that
+	if (!write_old)
+		AK_cache_unmap_frame(mem_block);
+	AK_page_table_insert(num, frame);
+	pthread_mutex_unlock(&dbCache->pool_lock);
+
+	if (write_old && AK_write_block(mem_block->block) != EXIT_SUCCESS)
 	{
-		if (AK_cache_block(num, dbCache->cache[ first_AK_free_mem_block ]) == EXIT_SUCCESS)
-		{
-			/// created new cache block for specified address
-			AK_EPI;
+		/// the frame keeps its dirty block
+		pthread_mutex_lock(&dbCache->pool_lock);
+		AK_page_table_remove(num);
+		AK_frame_end_io(mem_block);
+		pthread_mutex_unlock(&dbCache->pool_lock);
+		return AK_POOL_EXHAUSTED;
+	}
+	block_cache = AK_read_block(num);
 
-			return dbCache->cache[first_AK_free_mem_block];
-		}
+	pthread_mutex_lock(&dbCache->pool_lock);
+	if (write_old)
+	{
+		/// block is clean after successfuly writing it to disk
+		mem_block->dirty = BLOCK_CLEAN;
+		AK_cache_unmap_frame(mem_block);
+	}
+	if (block_cache == NULL)
+	{
+		AK_page_table_remove(num);
+		mem_block->address = -1;
+		if (dbCache->free_count < dbCache->size)
+			dbCache->free_frames[dbCache->free_count++] = frame;
+		AK_frame_end_io(mem_block);
+		pthread_mutex_unlock(&dbCache->pool_lock);
+		return -1;
 	}
+	/// refill the frame in place so block pointers already handed out stay valid
+	memcpy(mem_block->block, block_cache, sizeof(AK_block));
+	mem_block->dirty = BLOCK_CLEAN;
+	timestamp = clock();
+	mem_block->timestamp_read = timestamp;
+	mem_block->timestamp_last_change = timestamp;
+	mem_block->address = num;
+	dbCache->policy->access(mem_block);
+	/// the pin taken for the read is handed to the caller
+	mem_block->pin_count++;
+	AK_frame_end_io(mem_block);
+	pthread_mutex_unlock(&dbCache->pool_lock);
+	AK_free(block_cache);
+	/// created new cache block for specified address
+	return frame;
+}
 
-	/// no free cache blocks found, we need to clear some now
-	free_pos = AK_release_oldest_cache_block();
+/**
+  * @author Tomislav Fotak, updated by Matija Šestak, Antonio Martinović, agent (page table lookup)
+  * @brief Function that reads a block from the memory. If the block is cached, returns the cached block. Else uses AK_cache_block to read the block
+		to cache and then returns it. Cached blocks are found through the page table; a frame for a new block is
+		taken from the free stack or, if there are no free frames, released by the replacement policy.
+		The returned block is not pinned and may be replaced by a later call; use AK_pin_block to keep it.
+  * @param num block number (address)
+  * @return segment start address
+ */
+AK_mem_block *AK_get_block(int num)
+{
+	int frame;
+	AK_mem_block *mem_block = NULL;
+	AK_PRO;
+	AK_db_cache* const dbCache = db_cache.ptr;
+	frame = AK_get_frame(num);
+	if (frame >= 0)
+	{
+		mem_block = dbCache->cache[frame];
+		pthread_mutex_lock(&dbCache->pool_lock);
+		mem_block->pin_count--;
+		pthread_mutex_unlock(&dbCache->pool_lock);
+	}
 
-	if(free_pos == EXIT_ERROR)
+	if (frame == AK_POOL_EXHAUSTED)
 	{
 		/// no cache for you
+		printf("AK_get_block: ERROR. All %d cache frames are pinned.\n", dbCache->size);
 		AK_EPI;
 		exit(EXIT_ERROR);
 	}
+	AK_EPI;
+	return mem_block;
+}
+
+/**
+  * @author agent
+  * @brief Function that reads a block into the cache like AK_get_block and pins it. A pinned block stays in its
+  * frame until every pin is released with AK_unpin_block, so the returned pointer remains valid meanwhile.
+  * @param num block number (address)
+  * @return pinned cache block, NULL if the block could not be read or every frame is pinned
+ */
+AK_mem_block *AK_pin_block(int num)
+{
+	int frame;
+	AK_mem_block *mem_block = NULL;
+	AK_PRO;
+	AK_db_cache* const dbCache = db_cache.ptr;
+	frame = AK_get_frame(num);
+	if (frame >= 0)
+		mem_block = dbCache->cache[frame];
+	if (frame == AK_POOL_EXHAUSTED)
+		printf("AK_pin_block: ERROR. All %d cache frames are pinned.\n", dbCache->size);
+	AK_EPI;
+	return mem_block;
+}
 
-	if (AK_cache_block(num, dbCache->cache[ free_pos ]) == EXIT_SUCCESS)
+/**
+  * @author agent
+  * @brief Function that releases one pin of a cache block
+  * @param mem_block block pinned by AK_pin_block
+  * @param dirty BLOCK_DIRTY if the block has been modified while pinned, BLOCK_CLEAN otherwise
+  * @return EXIT_SUCCESS, EXIT_ERROR if the block is not pinned
+ */
+int AK_unpin_block(AK_mem_block *mem_block, int dirty)
+{
+	int result = EXIT_SUCCESS;
+	AK_PRO;
+	AK_db_cache* const dbCache = db_cache.ptr;
+	pthread_mutex_lock(&dbCache->pool_lock);
+	if (mem_block->pin_count <= 0)
 	{
-		AK_EPI;
-		return dbCache->cache[ free_pos ];
+		printf("AK_unpin_block: ERROR. Block %d is not pinned.\n", mem_block->address);
+		result = EXIT_ERROR;
+	}
+	else
+	{
+		if (dirty == BLOCK_DIRTY)
+			AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+		mem_block->pin_count--;
 	}
+	pthread_mutex_unlock(&dbCache->pool_lock);
+	AK_EPI;
+	return result;
+}
 
+/**
+  * @author agent
+  * @brief Function that latches the contents of a cache block. Readers take a shared latch, a thread modifying
+  * the block takes an exclusive latch. The block should be pinned while it is latched.
+  * @param mem_block cache block
+  * @param mode SHARED_LOCK or EXCLUSIVE_LOCK
+ */
+void AK_latch_block(AK_mem_block *mem_block, int mode)
+{
+	AK_PRO;
+	if (mode == EXCLUSIVE_LOCK)
+		pthread_rwlock_wrlock(&mem_block->latch);
+	else
+		pthread_rwlock_rdlock(&mem_block->latch);
+	AK_EPI;
+}
 
+/**
+  * @author agent
+  * @brief Function that releases a latch taken by AK_latch_block
+  * @param mem_block cache block
+ */
+void AK_unlatch_block(AK_mem_block *mem_block)
+{
+	AK_PRO;
+	pthread_rwlock_unlock(&mem_block->latch);
 	AK_EPI;
-	return NULL;
 }
 
 /**
- * @author Antonio Martinović
- * @brief Functions that flushes the oldest block to disk and recalculates the next block to remove
- * @return index of flushed cache block
+ * @author Antonio Martinović, updated by agent (page replacement, I/O outside the pool lock)
+ * @brief Function that releases the frame chosen by the replacement policy. The block it holds is flushed to disk
+ * if dirty and removed from the page table, the frame is put on the free stack. Pinned frames are never released.
+ * The pool lock is not held while the block is written; if the frame is pinned meanwhile, another one is chosen.
+ * @return index of released frame, EXIT_ERROR if no frame can be released
  */
 int AK_release_oldest_cache_block() {
-	int i;
-	int min = 0;
 	int block_written;
+	int oldest_block;
 	AK_db_cache* const dbCache = db_cache.ptr;
-	int oldest_block = dbCache->next_replace;
-	AK_block *data_block;
+	AK_mem_block *mem_block;
 
 	AK_PRO;
 
-	if (oldest_block == -1) {
-		for (i = 0; i < MAX_CACHE_MEMORY; i++)
+	pthread_mutex_lock(&dbCache->pool_lock);
+	for (;;)
+	{
+		oldest_block = dbCache->policy->victim();
+		if (oldest_block < 0)
 		{
-
-			if (dbCache->cache[i]->timestamp_read != -1 &&
-				dbCache->cache[i]->timestamp_read < dbCache->cache[ min ]->timestamp_read)
-			{
-				min = i;
-			}
+			pthread_mutex_unlock(&dbCache->pool_lock);
+			AK_EPI;
+			return EXIT_ERROR;
 		}
-		oldest_block = min;
-	}
-
+		mem_block = dbCache->cache[oldest_block];
+		if (mem_block->dirty != BLOCK_DIRTY || mem_block->address == -1)
+			break;
 
-	if (dbCache->cache[oldest_block]->dirty == BLOCK_DIRTY)
-	{
-		data_block = dbCache->cache[oldest_block]->block;
-		block_written = AK_write_block(data_block);
+		/// threads asking for the block wait on the frame latch while it is written
+		AK_frame_begin_io(mem_block);
+		pthread_mutex_unlock(&dbCache->pool_lock);
+		block_written = AK_write_block(mem_block->block);
+		pthread_mutex_lock(&dbCache->pool_lock);
+		AK_frame_end_io(mem_block);
 		/// if block form cache can not be writed to DB file -> EXIT_ERROR
 		if (block_written != EXIT_SUCCESS)
 		{
+			pthread_mutex_unlock(&dbCache->pool_lock);
 			AK_EPI;
 			return EXIT_ERROR;
 		}
 		/// block is clean after successfuly writing it to disk
-		dbCache->cache[oldest_block]->dirty = BLOCK_CLEAN;
+		mem_block->dirty = BLOCK_CLEAN;
+		if (mem_block->pin_count == 0)
+			break;
 	}
 
-	dbCache->cache[oldest_block]->timestamp_read = clock();
-
-	min = 0;
-	for (i = 0; i < MAX_CACHE_MEMORY; i++)
+	if (mem_block->address != -1)
 	{
-		if (dbCache->cache[i]->timestamp_read != -1 &&
-			dbCache->cache[i]->timestamp_read < dbCache->cache[ min ]->timestamp_read)
-		{
-			min = i;
-		}
+		AK_cache_unmap_frame(mem_block);
+		if (dbCache->free_count < dbCache->size)
+			dbCache->free_frames[dbCache->free_count++] = oldest_block;
 	}
-	dbCache->next_replace = min;
+	pthread_mutex_unlock(&dbCache->pool_lock);
 
 	AK_EPI;
 
@@ -506,25 +1040,46 @@ int AK_mem_block_modify(AK_mem_block* mem_block, int dirty)
 }
 
 /**
- * @author Matija Šestak.
- * @brief  Function that re-reads all the blocks from the disk
+ * @author Matija Šestak, updated by agent (I/O outside the pool lock)
+ * @brief  Function that re-reads all the unpinned blocks from the disk. Every frame is claimed under the pool lock
+ * and read without it, threads asking for its block wait on the frame latch.
  * @result EXIT_SUCCESS
  */
 int AK_refresh_cache()
 {
-	int i;
+	int i, address;
 	AK_block *new_block;
-	AK_block *old_block;
+	AK_mem_block *mem_block;
 
 	AK_PRO;
-	for (i = 0; i < MAX_CACHE_MEMORY; i++)
+	AK_db_cache* const dbCache = db_cache.ptr;
+	for (i = 0; i < dbCache->size; i++)
 	{
-		AK_db_cache* const dbCache = db_cache.ptr;
-		new_block = AK_read_block(dbCache->cache[i]->block->address);
-		old_block = dbCache->cache[i]->block;
-		dbCache->cache[i]->block = new_block;
-		AK_free(old_block);
+		mem_block = dbCache->cache[i];
+		pthread_mutex_lock(&dbCache->pool_lock);
+		/// pinned blocks are in use and keep their contents
+		if (mem_block->address == -1 || mem_block->pin_count > 0)
+		{
+			pthread_mutex_unlock(&dbCache->pool_lock);
+			continue;
+		}
+		AK_frame_begin_io(mem_block);
+		address = mem_block->address;
+		pthread_mutex_unlock(&dbCache->pool_lock);
+
+		new_block = AK_read_block(address);
+		if (new_block != NULL)
+		{
+			memcpy(mem_block->block, new_block, sizeof(AK_block));
+			AK_free(new_block);
+		}
+
+		pthread_mutex_lock(&dbCache->pool_lock);
+		AK_frame_end_io(mem_block);
+		pthread_mutex_unlock(&dbCache->pool_lock);
 	}
+	/// catalog blocks may have changed on disk
+	AK_catalog_invalidate();
 	AK_EPI;
 	return EXIT_SUCCESS;
 }
@@ -568,13 +1123,14 @@ table_addresses *AK_get_segment_addresses(char * segmentName)
 }
 
 /**
-* @author Matija Novak, updated by Matija Šestak, Mislav Čakarić, Antonio Martinović
-* @brief Function for getting addresses of some table
-* @param tableName table name that you search for
+* @author Matija Novak, updated by Matija Šestak, Mislav Čakarić, Antonio Martinović, agent (rows of AK_index)
+* @brief Function that reads the addresses of a segment from its system catalog table
+* @param tableName system catalog table that you search in
 * @param segmentName segment name
-* @return structure table_addresses witch contains start and end adresses of table extents, when form and to are 0 you are on the end of addresses
+* @param addresses extents of the segment, when form and to are 0 you are on the end of addresses
+* @param obj_id obj_id from the first catalog row of the segment, EXIT_ERROR if there is none
 */
-table_addresses *AK_get_segment_addresses_internal(char *tableName, char *segmentName)
+static void AK_read_segment_addresses(const char *tableName, const char *segmentName, table_addresses *addresses, int *obj_id)
 {
 	int i = 0;
 	int AK_freeVar = 0;
@@ -586,7 +1142,7 @@ table_addresses *AK_get_segment_addresses_internal(char *tableName, char *segmen
 	AK_dbg_messg(HIGH, MEMO_MAN,"get_segment_addresses: Serching for %s table \n", tableName);
 	address_sys = AK_get_system_table_address(tableName);
 	mem_block = AK_get_block(address_sys);
-	table_addresses * addresses = (table_addresses *) AK_malloc(sizeof (table_addresses));
+	*obj_id = EXIT_ERROR;
 
 	for (AK_freeVar = 0; AK_freeVar < MAX_EXTENTS_IN_SEGMENT; AK_freeVar++)
 	{
@@ -596,23 +1152,30 @@ table_addresses *AK_get_segment_addresses_internal(char *tableName, char *segmen
 	char name[MAX_VARCHAR_LENGTH];
 	int address_from;
 	int address_to;
+	int id;
 	int j = 0;
-	for (i = 0; i < DATA_BLOCK_SIZE; i++)
+	int num_attr = 0;
+	//rows of AK_index have table_id and attribute_id after the four attributes read here
+	while (num_attr < MAX_ATTRIBUTES && mem_block->block->header[num_attr].att_name[0] != '\0')
+		num_attr++;
+	if (num_attr < 4)
+		num_attr = 4;
+	for (i = 0; i + 3 < DATA_BLOCK_SIZE; i += num_attr)
 	{
 		if (mem_block->block->tuple_dict[i].type == FREE_INT)
 			break;
 		if ( (mem_block->block->last_tuple_dict_id) <= i )
 			break;
-		i++;
-		memcpy(name, &(mem_block->block->data[mem_block->block->tuple_dict[i].address]), mem_block->block->tuple_dict[i].size);
-		name[ mem_block->block->tuple_dict[i].size] = '\0';
-		i++;
-		memcpy(&address_from, &(mem_block->block->data[mem_block->block->tuple_dict[i].address]), mem_block->block->tuple_dict[i].size);
-		i++;
-		memcpy(&address_to, &(mem_block->block->data[mem_block->block->tuple_dict[i].address]), mem_block->block->tuple_dict[i].size);
+		memcpy(&id, &(mem_block->block->data[mem_block->block->tuple_dict[i].address]), sizeof(int));
+		memcpy(name, &(mem_block->block->data[mem_block->block->tuple_dict[i + 1].address]), mem_block->block->tuple_dict[i + 1].size);
+		name[ mem_block->block->tuple_dict[i + 1].size] = '\0';
+		memcpy(&address_from, &(mem_block->block->data[mem_block->block->tuple_dict[i + 2].address]), mem_block->block->tuple_dict[i + 2].size);
+		memcpy(&address_to, &(mem_block->block->data[mem_block->block->tuple_dict[i + 3].address]), mem_block->block->tuple_dict[i + 3].size);
 		//if found the table that addresses we need
 		if (strcmp(name, segmentName) == 0)
 		{
+			if (j == 0)
+				*obj_id = id;
 			addresses->address_from[j] = address_from;
 			addresses->address_to[j] = address_to;
 			j++;
@@ -621,16 +1184,15 @@ table_addresses *AK_get_segment_addresses_internal(char *tableName, char *segmen
 
 	}
 	AK_EPI;
-	return addresses;
 }
 
 /**
  * @author Matija Novak, updated by Matija Šestak, Mislav Čakarić, Antonio Martinović
- * @brief Function that gets the address of a system table by name
+ * @brief Function that reads the address of a system table from the system catalog (block 0)
  * @param name of system table
  * @return table address
  */
-int AK_get_system_table_address(const char *name) {
+static int AK_read_system_table_address(const char *name) {
 	int i;
 	int data_adr = 0;
 	int data_size = 0;
@@ -668,6 +1230,820 @@ int AK_get_system_table_address(const char *name) {
 	return address_sys;
 }
 
+/**
+ * @author agent
+ * @brief Function that initializes the schema catalog cache (variable catalog_cache)
+ * @return EXIT_SUCCESS if the catalog cache has been initialized, EXIT_ERROR otherwise
+ */
+int AK_catalog_AK_malloc()
+{
+	AK_PRO;
+	AK_catalog_cache *catalog = (AK_catalog_cache *) AK_calloc(1, sizeof(AK_catalog_cache));
+	if (catalog == NULL)
+	{
+		printf("AK_catalog_AK_malloc: ERROR. Cannot allocate catalog cache\n");
+		AK_EPI;
+		return EXIT_ERROR;
+	}
+	pthread_mutex_init(&catalog->lock, NULL);
+	catalog_cache.ptr = catalog;
+	AK_EPI;
+	return EXIT_SUCCESS;
+}
+
+/**
+ * @author agent
+ * @brief Function that computes the bucket of a catalog entry (djb2 string hash)
+ * @param sys_table system catalog table of the segment
+ * @param name segment name
+ * @return bucket index
+ */
+static int AK_catalog_bucket(const char *sys_table, const char *name)
+{
+	unsigned long hash = 5381;
+	while (*sys_table)
+		hash = ((hash << 5) + hash) + (unsigned char) *sys_table++;
+	while (*name)
+		hash = ((hash << 5) + hash) + (unsigned char) *name++;
+	return hash % AK_CATALOG_BUCKETS;
+}
+
+/**
+ * @author agent
+ * @brief Function that finds a cached catalog entry. Must be called with the catalog lock held.
+ * @param sys_table system catalog table of the segment
+ * @param name segment name
+ * @return catalog entry, NULL if the segment is not cached
+ */
+static AK_catalog_entry *AK_catalog_find(const char *sys_table, const char *name)
+{
+	AK_catalog_cache *catalog = catalog_cache.ptr;
+	AK_catalog_entry *entry = catalog->buckets[AK_catalog_bucket(sys_table, name)];
+	while (entry != NULL && (strcmp(entry->name, name) != 0 || strcmp(entry->sys_table, sys_table) != 0))
+		entry = entry->next;
+	return entry;
+}
+
+/**
+ * @author agent
+ * @brief Function that frees a catalog entry
+ * @param entry catalog entry
+ */
+static void AK_catalog_free_entry(AK_catalog_entry *entry)
+{
+	if (entry->header != NULL)
+		AK_free(entry->header);
+	if (entry->indexes != NULL)
+		AK_free(entry->indexes);
+	AK_free(entry);
+}
+
+/**
+ * @author agent
+ * @brief Function that reads the names of the indexes of a table from the rows of AK_index whose table_id is the
+ * table. An index has a row for every extent, its name is kept once.
+ * @param entry catalog entry of the table
+ */
+static void AK_catalog_read_indexes(AK_catalog_entry *entry)
+{
+	int i, j;
+	int num_attr = 0;
+	char name[MAX_ATT_NAME];
+	AK_tuple_dict *index, *table;
+	AK_mem_block *mem_block = AK_get_block(AK_get_system_table_address("AK_index"));
+
+	while (num_attr < MAX_ATTRIBUTES && mem_block->block->header[num_attr].att_name[0] != '\0')
+		num_attr++;
+	//name is the second attribute of AK_index, table_id the fifth
+	if (num_attr < 5)
+		return;
+	for (i = 0; i + num_attr <= DATA_BLOCK_SIZE; i += num_attr)
+	{
+		if (mem_block->block->tuple_dict[i].type == FREE_INT)
+			break;
+		index = &mem_block->block->tuple_dict[i + 1];
+		table = &mem_block->block->tuple_dict[i + 4];
+		if (table->size != (int) strlen(entry->name) || memcmp(mem_block->block->data + table->address, entry->name, table->size) != 0
+			|| index->size <= 0 || index->size >= MAX_ATT_NAME)
+			continue;
+		memcpy(name, mem_block->block->data + index->address, index->size);
+		name[index->size] = '\0';
+		for (j = 0; j < entry->index_count && strcmp(entry->indexes[j], name) != 0; j++);
+		if (j < entry->index_count)
+			continue;
+		entry->indexes = AK_realloc(entry->indexes, (entry->index_count + 1) * sizeof(*entry->indexes));
+		strcpy(entry->indexes[entry->index_count++], name);
+	}
+}
+
+/**
+ * @author agent
+ * @brief Function that reads a catalog entry from the system catalog: the extents and obj_id from the catalog
+ * table and the header from the first block of the segment and the blocks chained to it
+ * @param sys_table system catalog table of the segment, empty for a system table
+ * @param name segment name
+ * @return new catalog entry
+ */
+static AK_catalog_entry *AK_catalog_read_entry(const char *sys_table, const char *name)
+{
+	int i;
+	int size = 0;
+	AK_mem_block *mem_block;
+	AK_catalog_entry *entry = (AK_catalog_entry *) AK_calloc(1, sizeof(AK_catalog_entry));
+
+	strncpy(entry->sys_table, sys_table, MAX_ATT_NAME - 1);
+	strncpy(entry->name, name, MAX_ATT_NAME - 1);
+	entry->obj_id = EXIT_ERROR;
+	if (sys_table[0] == '\0')
+	{
+		entry->addresses.address_from[0] = AK_read_system_table_address(name);
+		return entry;
+	}
+
+	AK_read_segment_addresses(sys_table, name, &entry->addresses, &entry->obj_id);
+	if (entry->addresses.address_from[0] == 0)
+		return entry;
+	if (strcmp(sys_table, "AK_relation") == 0)
+		AK_catalog_read_indexes(entry);
+
+	mem_block = AK_get_block(entry->addresses.address_from[0]);
+	while (mem_block != NULL)
+	{
+		for (i = 0; i < MAX_ATTRIBUTES && strcmp(mem_block->block->header[i].att_name, "") != 0; i++)
+		{
+			if (entry->num_attr == size)
+			{
+				size += MAX_ATTRIBUTES;
+				entry->header = (AK_header *) AK_realloc(entry->header, size * sizeof(AK_header));
+			}
+			entry->header[entry->num_attr++] = mem_block->block->header[i];
+		}
+		if (mem_block->block->chained_with == NOT_CHAINED)
+			break;
+		mem_block = AK_get_block(mem_block->block->chained_with);
+	}
+	return entry;
+}
+
+/**
+ * @author agent
+ * @brief Function that finds the catalog entry of a segment, reading it from the system catalog on a miss.
+ * Returns with the catalog lock held; the caller copies what it needs and calls AK_catalog_release.
+ * @param sys_table system catalog table of the segment, empty for a system table
+ * @param name segment name
+ * @param uncached set to an entry that could not be cached because the catalog changed while it was read;
+ * it has to be freed by AK_catalog_release
+ * @return catalog entry
+ */
+static AK_catalog_entry *AK_catalog_acquire(const char *sys_table, const char *name, AK_catalog_entry **uncached)
+{
+	AK_catalog_cache *catalog = catalog_cache.ptr;
+	AK_catalog_entry *entry;
+	unsigned long generation;
+	int bucket;
+
+	*uncached = NULL;
+	pthread_mutex_lock(&catalog->lock);
+	entry = AK_catalog_find(sys_table, name);
+	if (entry != NULL)
+	{
+		catalog->hits++;
+		return entry;
+	}
+	catalog->misses++;
+	generation = catalog->generation;
+	/// the catalog is read without the catalog lock, buffer pool functions take the pool lock
+	pthread_mutex_unlock(&catalog->lock);
+	entry = AK_catalog_read_entry(sys_table, name);
+	pthread_mutex_lock(&catalog->lock);
+
+	if (catalog->generation != generation || AK_catalog_find(sys_table, name) != NULL)
+	{
+		*uncached = entry;
+		return entry;
+	}
+	bucket = AK_catalog_bucket(sys_table, name);
+	entry->next = catalog->buckets[bucket];
+	catalog->buckets[bucket] = entry;
+	return entry;
+}
+
+/**
+ * @author agent
+ * @brief Function that releases the catalog lock taken by AK_catalog_acquire
+ * @param uncached entry returned through the uncached parameter of AK_catalog_acquire
+ */
+static void AK_catalog_release(AK_catalog_entry *uncached)
+{
+	AK_catalog_cache *catalog = catalog_cache.ptr;
+	pthread_mutex_unlock(&catalog->lock);
+	if (uncached != NULL)
+		AK_catalog_free_entry(uncached);
+}
+
+/**
+ * @author agent
+ * @brief  Function that drops all cached catalog entries. Called whenever the system catalog or a table header
+ * changes (creating, dropping, extending and renaming segments).
+ */
+void AK_catalog_invalidate()
+{
+	int i;
+	AK_catalog_entry *entry, *next;
+	AK_catalog_cache *catalog = catalog_cache.ptr;
+	AK_PRO;
+	if (catalog == NULL)
+	{
+		AK_EPI;
+		return;
+	}
+	pthread_mutex_lock(&catalog->lock);
+	catalog->generation++;
+	for (i = 0; i < AK_CATALOG_BUCKETS; i++)
+	{
+		for (entry = catalog->buckets[i]; entry != NULL; entry = next)
+		{
+			next = entry->next;
+			AK_catalog_free_entry(entry);
+		}
+		catalog->buckets[i] = NULL;
+	}
+	pthread_mutex_unlock(&catalog->lock);
+	AK_EPI;
+}
+
+/**
+ * @def AK_FSM_MAGIC
+ * @brief Constant marking the beginning of a free space map file
+ */
+#define AK_FSM_MAGIC 0x4d53464b
+
+/**
+  * @author agent
+  * @struct AK_fsm_file_header
+  * @brief Structure that defines the beginning of a free space map file, followed by one class per block
+ */
+typedef struct {
+	/// AK_FSM_MAGIC
+	unsigned int magic;
+	/// creation time of the DB file the map belongs to
+	time_t ltime;
+	/// number of blocks of the DB file
+	int blocks;
+	/// 1 if the classes have been written after the last change, 0 while the DB is in use
+	int clean;
+} AK_fsm_file_header;
+
+/**
+ * @author agent
+ * @brief Function that writes the header of the free space map file
+ * @param map free space map
+ * @param clean 1 if the classes in the file are up to date, 0 otherwise
+ * @return EXIT_SUCCESS if the header has been written, EXIT_ERROR otherwise
+ */
+static int AK_fsm_write_header(AK_free_space_map *map, int clean)
+{
+	AK_fsm_file_header header;
+
+	memset(&header, 0, sizeof(header));
+	header.magic = AK_FSM_MAGIC;
+	header.ltime = ((AK_blocktable *) AK_allocationbit.ptr)->ltime;
+	header.blocks = map->blocks;
+	header.clean = clean;
+	if (pwrite(map->fd, &header, sizeof(header), 0) != sizeof(header))
+	{
+		printf("AK_fsm_write_header: ERROR. Cannot write free space map header: %s\n", strerror(errno));
+		return EXIT_ERROR;
+	}
+	return EXIT_SUCCESS;
+}
+
+/**
+ * @author agent
+ * @brief Function that initializes the free space map (variable free_space_map) and reads the classes of
+ * blocks from its file. A file written for another DB file or not closed cleanly is ignored.
+ * @return EXIT_SUCCESS if the free space map has been initialized, EXIT_ERROR otherwise
+ */
+int AK_fsm_AK_malloc()
+{
+	char file_name[MAX_CONFIG_VALUE + 8];
+	AK_fsm_file_header header;
+	AK_free_space_map *map;
+	int i;
+	AK_PRO;
+
+	map = (AK_free_space_map *) AK_calloc(1, sizeof(AK_free_space_map));
+	if (map == NULL)
+	{
+		printf("AK_fsm_AK_malloc: ERROR. Cannot allocate free space map\n");
+		AK_EPI;
+		return EXIT_ERROR;
+	}
+	map->blocks = DB_FILE_BLOCKS_NUM;
+	map->classes = (unsigned char *) AK_calloc(map->blocks, sizeof(unsigned char));
+	map->next = (int *) AK_malloc(map->blocks * sizeof(int));
+	map->prev = (int *) AK_malloc(map->blocks * sizeof(int));
+	map->owner = (AK_fsm_segment **) AK_calloc(map->blocks, sizeof(AK_fsm_segment *));
+	if (map->classes == NULL || map->next == NULL || map->prev == NULL || map->owner == NULL)
+	{
+		printf("AK_fsm_AK_malloc: ERROR. Cannot allocate free space map\n");
+		AK_EPI;
+		return EXIT_ERROR;
+	}
+	for (i = 0; i < map->blocks; i++)
+		map->next[i] = map->prev[i] = -1;
+	pthread_mutex_init(&map->lock, NULL);
+
+	snprintf(file_name, sizeof(file_name), "%s.fsm", DB_FILE);
+	if ((map->fd = open(file_name, O_RDWR | O_CREAT, 0644)) == -1)
+	{
+		printf("AK_fsm_AK_malloc: ERROR. Cannot open free space map %s: %s\n", file_name, strerror(errno));
+		AK_EPI;
+		return EXIT_ERROR;
+	}
+
+	/// classes are only trusted if they were written for this DB file when it was last closed
+	if (pread(map->fd, &header, sizeof(header), 0) != sizeof(header) || header.magic != AK_FSM_MAGIC
+		|| header.ltime != ((AK_blocktable *) AK_allocationbit.ptr)->ltime || header.blocks != map->blocks
+		|| header.clean != 1 || pread(map->fd, map->classes, map->blocks, sizeof(header)) != map->blocks)
+	{
+		AK_dbg_messg(LOW, MEMO_MAN, "AK_fsm_AK_malloc: %s is not up to date, blocks will be classified again\n", file_name);
+		memset(map->classes, AK_FSM_UNKNOWN, map->blocks);
+	}
+
+	free_space_map.ptr = map;
+	/// until the next flush the classes in the file may fall behind
+	map->dirty = 1;
+	if (AK_fsm_write_header(map, 0) == EXIT_ERROR)
+	{
+		AK_EPI;
+		return EXIT_ERROR;
+	}
+	AK_EPI;
+	return EXIT_SUCCESS;
+}
+
+/**
+ * @author agent
+ * @brief Function that computes the free space class of a block from its free bytes and its free slots. A table
+ * block without a free slot is full; last_tuple_dict_id only grows, so it is used just for blocks without a header.
+ * Slots of deleted rows count as free, so a block is offered again after a delete.
+ * @param block block to classify
+ * @return free space class of the block
+ */
+static int AK_fsm_classify(AK_block *block)
+{
+	int free_bytes, class, num_attr;
+
+	if (block->AK_free_space >= MAX_FREE_SPACE_SIZE)
+		return AK_FSM_FULL;
+	num_attr = AK_block_num_attr(block);
+	if (num_attr > 0 ? AK_find_free_slot(block, num_attr) == EXIT_ERROR
+		: block->last_tuple_dict_id >= MAX_LAST_TUPLE_DICT_SIZE_TO_USE)
+		return AK_FSM_FULL;
+	free_bytes = DATA_BLOCK_SIZE * DATA_ENTRY_SIZE - block->AK_free_space;
+	class = AK_FSM_FIRST_CLASS + free_bytes / AK_FSM_CLASS_WIDTH;
+	if (class >= AK_FSM_CLASSES)
+		class = AK_FSM_CLASSES - 1;
+	return class;
+}
+
+/**
+ * @author agent
+ * @brief Function that removes a block from the free space list it is in. Must be called with the map lock held.
+ * @param map free space map
+ * @param address address of the block
+ */
+static void AK_fsm_unlink(AK_free_space_map *map, int address)
+{
+	AK_fsm_segment *segment = map->owner[address];
+
+	if (segment == NULL)
+		return;
+	if (map->prev[address] != -1)
+		map->next[map->prev[address]] = map->next[address];
+	else
+		segment->head[map->classes[address]] = map->next[address];
+	if (map->next[address] != -1)
+		map->prev[map->next[address]] = map->prev[address];
+	map->next[address] = map->prev[address] = -1;
+	map->owner[address] = NULL;
+}
+
+/**
+ * @author agent
+ * @brief Function that puts a block at the beginning of the list of its class. Must be called with the map lock held.
+ * @param map free space map
+ * @param segment segment the block belongs to
+ * @param address address of the block
+ */
+static void AK_fsm_link(AK_free_space_map *map, AK_fsm_segment *segment, int address)
+{
+	int class = map->classes[address];
+
+	map->prev[address] = -1;
+	map->next[address] = segment->head[class];
+	if (segment->head[class] != -1)
+		map->prev[segment->head[class]] = address;
+	segment->head[class] = address;
+	map->owner[address] = segment;
+}
+
+/**
+ * @author agent
+ * @brief Function that sets the class of a block and moves it to the matching list. Must be called with the map
+ * lock held.
+ * @param map free space map
+ * @param address address of the block
+ * @param class new class of the block
+ */
+static void AK_fsm_set_class(AK_free_space_map *map, int address, int class)
+{
+	AK_fsm_segment *segment = map->owner[address];
+
+	if (map->classes[address] == class)
+		return;
+	if (!map->dirty)
+	{
+		map->dirty = 1;
+		AK_fsm_write_header(map, 0);
+	}
+	AK_fsm_unlink(map, address);
+	map->classes[address] = class;
+	if (segment != NULL)
+		AK_fsm_link(map, segment, address);
+}
+
+/**
+ * @author agent
+ * @brief Function that puts the blocks of an extent into the free space lists of a segment. Only the first
+ * block of every group of chained blocks is listed. Blocks that have not been classified yet are read once.
+ * Must be called with the map lock held.
+ * @param map free space map
+ * @param segment segment the extent belongs to
+ * @param from first block of the extent
+ * @param to block after the last block of the extent
+ */
+static void AK_fsm_attach_extent(AK_free_space_map *map, AK_fsm_segment *segment, int from, int to)
+{
+	AK_mem_block *mem_block;
+	int i;
+
+	if (from <= 0 || to > map->blocks)
+		return;
+	/// blocks are linked from the end, so every list starts with the lowest address
+	for (i = to - 1; i >= from; i--)
+	{
+		if ((i - from) % segment->stride != 0)
+			continue;
+		AK_fsm_unlink(map, i);
+		if (map->classes[i] == AK_FSM_UNKNOWN)
+		{
+			mem_block = AK_get_block(i);
+			if (mem_block == NULL)
+				continue;
+			AK_fsm_set_class(map, i, AK_fsm_classify(mem_block->block));
+		}
+		AK_fsm_link(map, segment, i);
+	}
+}
+
+/**
+ * @author agent
+ * @brief Function that finds the free space lists of a segment, building them on first use and adding extents
+ * the segment got since. Must be called with the map lock held.
+ * @param map free space map
+ * @param addresses extents of the segment
+ * @return free space lists of the segment
+ */
+static AK_fsm_segment *AK_fsm_get_segment(AK_free_space_map *map, table_addresses *addresses)
+{
+	int bucket = addresses->address_from[0] % AK_FSM_SEGMENT_BUCKETS;
+	AK_fsm_segment *segment;
+	AK_mem_block *mem_block;
+	int i, j;
+
+	for (segment = map->buckets[bucket]; segment != NULL; segment = segment->next)
+		if (segment->addresses.address_from[0] == addresses->address_from[0])
+			break;
+
+	if (segment == NULL)
+	{
+		segment = (AK_fsm_segment *) AK_calloc(1, sizeof(AK_fsm_segment));
+		for (i = 0; i < AK_FSM_CLASSES; i++)
+			segment->head[i] = -1;
+		segment->addresses.address_from[0] = addresses->address_from[0];
+		segment->next = map->buckets[bucket];
+		map->buckets[bucket] = segment;
+	}
+
+	/// the lists were built from other extents when the segment has been dropped and its first block reused
+	for (i = 0; i < segment->extents; i++)
+		if (segment->addresses.address_from[i] != addresses->address_from[i]
+			|| segment->addresses.address_to[i] != addresses->address_to[i])
+			break;
+	if (i < segment->extents)
+	{
+		for (i = 0; i < segment->extents; i++)
+			for (j = segment->addresses.address_from[i]; j < segment->addresses.address_to[i] && j < map->blocks; j++)
+				if (map->owner[j] == segment)
+					AK_fsm_unlink(map, j);
+		segment->extents = 0;
+	}
+
+	if (segment->extents == 0)
+	{
+		/// a row of a table with more than MAX_ATTRIBUTES attributes is spread over a group of chained blocks
+		segment->stride = 1;
+		for (mem_block = AK_get_block(addresses->address_from[0]);
+			 mem_block != NULL && mem_block->block->chained_with != NOT_CHAINED && segment->stride < map->blocks;
+			 mem_block = AK_get_block(mem_block->block->chained_with))
+			segment->stride++;
+	}
+
+	/// extents added since the lists were built
+	for (i = segment->extents; i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0; i++)
+	{
+		segment->addresses.address_from[i] = addresses->address_from[i];
+		segment->addresses.address_to[i] = addresses->address_to[i];
+		AK_fsm_attach_extent(map, segment, addresses->address_from[i], addresses->address_to[i]);
+		segment->extents = i + 1;
+	}
+	return segment;
+}
+
+/**
+ * @author agent
+ * @brief Function that finds a block of a segment with room for a row in constant time, using the free space
+ * lists of the segment. The chosen block is the fullest one that still has size free bytes.
+ * @param addresses extents of the segment
+ * @param size number of data bytes the row needs
+ * @return address of the block, EXIT_ERROR if no block of the segment has room
+ */
+int AK_fsm_find_block(table_addresses *addresses, int size)
+{
+	AK_free_space_map *map = free_space_map.ptr;
+	AK_fsm_segment *segment;
+	AK_mem_block *mem_block;
+	int class, address, actual;
+	AK_PRO;
+
+	if (map == NULL || addresses == NULL || addresses->address_from[0] <= 0)
+	{
+		AK_EPI;
+		return EXIT_ERROR;
+	}
+
+	pthread_mutex_lock(&map->lock);
+	segment = AK_fsm_get_segment(map, addresses);
+	/// every block of the first class whose lower bound covers size has room for the row
+	class = AK_FSM_FIRST_CLASS + (size + AK_FSM_CLASS_WIDTH - 1) / AK_FSM_CLASS_WIDTH;
+	if (class >= AK_FSM_CLASSES)
+		class = AK_FSM_CLASSES - 1;
+	while (class < AK_FSM_CLASSES)
+	{
+		address = segment->head[class];
+		if (address == -1)
+		{
+			class++;
+			continue;
+		}
+		/// blocks changed without AK_fsm_update_block (indexes, catalog) are moved to their real class
+		mem_block = AK_get_block(address);
+		actual = mem_block == NULL ? AK_FSM_FULL : AK_fsm_classify(mem_block->block);
+		if (actual != class)
+		{
+			AK_fsm_set_class(map, address, actual);
+			continue;
+		}
+		if (DATA_BLOCK_SIZE * DATA_ENTRY_SIZE - mem_block->block->AK_free_space < size)
+			break;
+		pthread_mutex_unlock(&map->lock);
+		AK_EPI;
+		return address;
+	}
+	pthread_mutex_unlock(&map->lock);
+	AK_EPI;
+	return EXIT_ERROR;
+}
+
+/**
+ * @author agent
+ * @brief Function that records the free space of a block after rows have been inserted into or deleted from it
+ * @param block changed block
+ */
+void AK_fsm_update_block(AK_block *block)
+{
+	AK_free_space_map *map = free_space_map.ptr;
+	AK_PRO;
+	if (map != NULL && block->address >= 0 && block->address < map->blocks)
+	{
+		pthread_mutex_lock(&map->lock);
+		AK_fsm_set_class(map, block->address, AK_fsm_classify(block));
+		pthread_mutex_unlock(&map->lock);
+	}
+	AK_EPI;
+}
+
+/**
+ * @author agent
+ * @brief Function that records that a block has been (re)initialized as an empty block of a new extent
+ * @param address address of the block
+ */
+void AK_fsm_set_empty(int address)
+{
+	AK_free_space_map *map = free_space_map.ptr;
+	AK_PRO;
+	if (map != NULL && address >= 0 && address < map->blocks)
+	{
+		pthread_mutex_lock(&map->lock);
+		/// the block may still be listed for a dropped segment
+		AK_fsm_unlink(map, address);
+		AK_fsm_set_class(map, address, AK_FSM_CLASSES - 1);
+		pthread_mutex_unlock(&map->lock);
+	}
+	AK_EPI;
+}
+
+/**
+ * @author agent
+ * @brief Function that writes the free space map to its file and marks the file as clean
+ * @return EXIT_SUCCESS if the map has been written, EXIT_ERROR otherwise
+ */
+int AK_fsm_flush()
+{
+	AK_free_space_map *map = free_space_map.ptr;
+	int result = EXIT_SUCCESS;
+	AK_PRO;
+	if (map == NULL)
+	{
+		AK_EPI;
+		return EXIT_SUCCESS;
+	}
+	pthread_mutex_lock(&map->lock);
+	if (map->dirty)
+	{
+		if (pwrite(map->fd, map->classes, map->blocks, sizeof(AK_fsm_file_header)) != map->blocks)
+		{
+			printf("AK_fsm_flush: ERROR. Cannot write free space map: %s\n", strerror(errno));
+			result = EXIT_ERROR;
+		}
+		else if ((result = AK_fsm_write_header(map, 1)) == EXIT_SUCCESS)
+			map->dirty = 0;
+	}
+	pthread_mutex_unlock(&map->lock);
+	AK_EPI;
+	return result;
+}
+
+/**
+* @author Matija Novak, updated by Matija Šestak, Mislav Čakarić, Antonio Martinović, agent (catalog cache)
+* @brief Function for getting addresses of some table
+* @param tableName table name that you search for
+* @param segmentName segment name
+* @return structure table_addresses witch contains start and end adresses of table extents, when form and to are 0 you are on the end of addresses
+*/
+table_addresses *AK_get_segment_addresses_internal(char *tableName, char *segmentName)
+{
+	AK_catalog_entry *entry, *uncached;
+	AK_PRO;
+	table_addresses * addresses = (table_addresses *) AK_malloc(sizeof (table_addresses));
+	entry = AK_catalog_acquire(tableName, segmentName, &uncached);
+	memcpy(addresses, &entry->addresses, sizeof(table_addresses));
+	AK_catalog_release(uncached);
+	AK_EPI;
+	return addresses;
+}
+
+/**
+ * @author Matija Novak, updated by Matija Šestak, Mislav Čakarić, Antonio Martinović, agent (catalog cache)
+ * @brief Function that gets the address of a system table by name
+ * @param name of system table
+ * @return table address
+ */
+int AK_get_system_table_address(const char *name) {
+	int address;
+	AK_catalog_entry *entry, *uncached;
+	AK_PRO;
+	entry = AK_catalog_acquire("", name, &uncached);
+	address = entry->addresses.address_from[0];
+	AK_catalog_release(uncached);
+	AK_EPI;
+	return address;
+}
+
+/**
+ * @author agent
+ * @brief  Function that fetches the number of attributes of a table from the catalog cache
+ * @param table table name
+ * @return number of attributes, EXIT_WARNING if the table has no extents
+ */
+int AK_catalog_num_attr(char *table)
+{
+	int num_attr;
+	AK_catalog_entry *entry, *uncached;
+	AK_PRO;
+	entry = AK_catalog_acquire("AK_relation", table, &uncached);
+	num_attr = entry->addresses.address_from[0] == 0 ? EXIT_WARNING : entry->num_attr;
+	AK_catalog_release(uncached);
+	AK_EPI;
+	return num_attr;
+}
+
+/**
+ * @author agent
+ * @brief  Function that fetches a copy of a table header from the catalog cache
+ * @param table table name
+ * @param num_attr number of attributes in the returned header (may be NULL)
+ * @return header array ended by an empty entry that the caller has to free, NULL if the table has no extents
+ */
+AK_header *AK_catalog_get_header(char *table, int *num_attr)
+{
+	AK_header *header = NULL;
+	AK_catalog_entry *entry, *uncached;
+	AK_PRO;
+	entry = AK_catalog_acquire("AK_relation", table, &uncached);
+	if (entry->addresses.address_from[0] != 0)
+	{
+		//one zeroed entry ends the header, AK_copy_header looks for it
+		header = (AK_header *) AK_calloc(entry->num_attr + 1, sizeof(AK_header));
+		memcpy(header, entry->header, entry->num_attr * sizeof(AK_header));
+		if (num_attr != NULL)
+			*num_attr = entry->num_attr;
+	}
+	AK_catalog_release(uncached);
+	AK_EPI;
+	return header;
+}
+
+/**
+ * @author agent
+ * @brief  Function that fetches the zero-based index of an attribute from the catalog cache
+ * @param table table name
+ * @param attribute attribute name
+ * @return index of the attribute, EXIT_WARNING if there is no such attribute
+ */
+int AK_catalog_get_attr_index(char *table, char *attribute)
+{
+	int i;
+	int index = EXIT_WARNING;
+	AK_catalog_entry *entry, *uncached;
+	AK_PRO;
+	entry = AK_catalog_acquire("AK_relation", table, &uncached);
+	for (i = 0; i < entry->num_attr; i++)
+	{
+		if (strcmp(entry->header[i].att_name, attribute) == 0)
+		{
+			index = i;
+			break;
+		}
+	}
+	AK_catalog_release(uncached);
+	AK_EPI;
+	return index;
+}
+
+/**
+ * @author agent
+ * @brief  Function that fetches the obj_id of a table from the catalog cache
+ * @param table table name
+ * @return obj_id of the table, EXIT_ERROR if the table is not in AK_relation
+ */
+int AK_catalog_get_obj_id(char *table)
+{
+	int obj_id;
+	AK_catalog_entry *entry, *uncached;
+	AK_PRO;
+	entry = AK_catalog_acquire("AK_relation", table, &uncached);
+	obj_id = entry->obj_id;
+	AK_catalog_release(uncached);
+	AK_EPI;
+	return obj_id;
+}
+
+/**
+ * @author agent
+ * @brief  Function that fetches the names of the indexes of a table from the catalog cache, the indexes whose row
+ * in AK_index has the table as table_id
+ * @param table table name
+ * @param indexes receives up to max index names (may be NULL)
+ * @param max size of indexes
+ * @return number of indexes of the table, it may be larger than max
+ */
+int AK_catalog_get_indexes(char *table, char (*indexes)[MAX_ATT_NAME], int max)
+{
+	int i, count;
+	AK_catalog_entry *entry, *uncached;
+	AK_PRO;
+	entry = AK_catalog_acquire("AK_relation", table, &uncached);
+	count = entry->index_count;
+	for (i = 0; indexes != NULL && i < count && i < max; i++)
+		strcpy(indexes[i], entry->indexes[i]);
+	AK_catalog_release(uncached);
+	AK_EPI;
+	return count;
+}
+
 /**
   * @author Mislav Čakarić
   * @brief Function for getting addresses of some table
@@ -699,46 +2075,29 @@ table_addresses *AK_get_index_addresses(char * index)
 }
 
 /**
-  * @author Matija Novak, updated by Matija Šestak( function now uses caching)
-  * @brief Function that finds AK_free space in some block betwen block addresses. It's made for insert_row()
+  * @author Matija Novak, updated by Matija Šestak( function now uses caching), updated by agent (free space map)
+  * @brief Function that finds AK_free space in some block betwen block addresses. It's made for insert_row().
+  * The block is taken from the free space map, see AK_fsm_find_block.
   * @param address addresses of extents
   * @return address of the block to write in
  */
 int AK_find_AK_free_space(table_addresses * addresses)
 {
 	AK_mem_block *mem_block;
-	int from = 0, to = 0, j = 0, i = 0;
+	int i = 0;
 	AK_PRO;
 	AK_dbg_messg(HIGH, MEMO_MAN, "find_AK_free_space: Searching for block that has AK_free space < 500 \n");
-	for (j = 0; j < MAX_EXTENTS_IN_SEGMENT; j++)
+	if (addresses->address_from[0] == 0)
 	{
-		if (addresses->address_from != 0)
-		{
-			from = addresses->address_from[j];
-			to = addresses->address_to[j];
-
-			//searching block
-			for (i = from; i <= to; i++)
-			{
-				mem_block = AK_get_block(i);
-				int AK_free_space_on = mem_block->block->AK_free_space;
-
-				AK_dbg_messg(HIGH, MEMO_MAN, "find_AK_free_space: FREE SPACE %d\n", mem_block->block->AK_free_space);
-
-				if ((AK_free_space_on < MAX_FREE_SPACE_SIZE) &&
-					(mem_block->block->last_tuple_dict_id < MAX_LAST_TUPLE_DICT_SIZE_TO_USE))  //found AK_free block to write
-				{
-					AK_EPI;
-					return i;
-				}
-			}
-		}
-		else 
-		{
-			AK_EPI;
-			return EXIT_ERROR;
-		}
+		AK_EPI;
+		return EXIT_ERROR;
+	}
+	if ((i = AK_fsm_find_block(addresses, 0)) != EXIT_ERROR)
+	{
+		AK_EPI;
+		return i;
 	}
+	mem_block = AK_get_block(addresses->address_from[0]);
 
 	//I cant call function from memoman must consider another solution to place these functions
 	int adr = -1;
@@ -772,7 +2131,7 @@ int AK_find_AK_free_space(table_addresses * addresses)
 }
 
 /**
- * @author Nikola Bakoš, updated by Matija Šestak (function now uses caching), updated by Mislav Čakarić, updated by Dino Laktašić
+ * @author Nikola Bakoš, updated by Matija Šestak (function now uses caching), updated by Mislav Čakarić, updated by Dino Laktašić, updated by agent (index extents)
  * @brief Function that extends the segment
  * @param table_name name of segment to extent
  * @param extent_type type of extent (can be one of:
@@ -790,9 +2149,10 @@ int AK_init_new_extent(char *table_name, int extent_type)
 
 	int old_size = 0;
 	int new_size = 0;
-	table_addresses *addresses = (table_addresses *) AK_get_segment_addresses(table_name);
+	table_addresses *addresses = (table_addresses *) (extent_type == SEGMENT_TYPE_INDEX ? AK_get_index_segment_addresses(table_name) : AK_get_segment_addresses(table_name));
 	int block_address = addresses->address_from[0]; //before 1
 	int block_written;
+	AK_header header[MAX_ATTRIBUTES];
 
 	AK_mem_block *mem_block = AK_get_block(block_address);
 	int start_address = 0;
@@ -822,7 +2182,12 @@ int AK_init_new_extent(char *table_name, int extent_type)
 
 	old_size++;
 
-	if ((start_address = AK_new_extent(1, old_size, extent_type, mem_block->block->header)) == EXIT_ERROR)
+	//the frame of the first block may be reused while the extent is allocated, and unused
+	//attributes of a block header are FREE_INT while AK_new_extent stops at TYPE_INTERNAL
+	memset(header, 0, sizeof(header));
+	for (i = 0; i < MAX_ATTRIBUTES && mem_block->block->header[i].att_name[0] != '\0'; i++)
+		header[i] = mem_block->block->header[i];
+	if ((start_address = AK_new_extent(1, old_size, extent_type, header)) == EXIT_ERROR)
 	{
 		printf("AK_init_new_extent: Could not allocate the new extent\n");
 		AK_EPI;
@@ -861,39 +2226,56 @@ int AK_init_new_extent(char *table_name, int extent_type)
 	AK_Insert_New_Element(TYPE_INT, &start_address, sys_table, "start_address", row_root);
 	AK_Insert_New_Element(TYPE_INT, &end_address, sys_table, "end_address", row_root);
 	AK_insert_row(row_root);
+	AK_catalog_invalidate();
 	AK_EPI;
 	return start_address;
 }
 
 /**
- * @author Matija Šestak, updated by Antonio Martinović
- * @brief Function that flushes memory blocks to disk file
+ * @author Matija Šestak, updated by Antonio Martinović, updated by agent (free space map, I/O outside the pool lock)
+ * @brief Function that flushes memory blocks to disk file. Blocks latched exclusively by another thread are
+ * skipped and stay dirty. A block is written under a shared latch and a pin, without the pool lock. The free space
+ * map is written as well.
  * @return EXIT_SUCCESS
  */
 int AK_flush_cache()
 {
 	int i = 0;
 	int block_written;
-	AK_block *data_block;
+	AK_mem_block *mem_block;
 	AK_PRO;
-	while (i < MAX_CACHE_MEMORY)
+	AK_db_cache* const dbCache = db_cache.ptr;
+	while (i < dbCache->size)
 	{
-		AK_db_cache* const dbCache = db_cache.ptr;
-		if (dbCache->cache[i]->dirty == BLOCK_DIRTY)
+		mem_block = dbCache->cache[i];
+		pthread_mutex_lock(&dbCache->pool_lock);
+		if (mem_block->dirty == BLOCK_DIRTY && mem_block->address == -1)
+			/// a free frame holds no block
+			mem_block->dirty = BLOCK_CLEAN;
+		/// a block latched exclusively is being modified and stays dirty until the next flush
+		else if (mem_block->dirty == BLOCK_DIRTY && pthread_rwlock_tryrdlock(&mem_block->latch) == 0)
 		{
-			data_block = dbCache->cache[i]->block;
-			block_written = AK_write_block(data_block);
+			/// the pin keeps the frame from being replaced while it is written without the pool lock
+			mem_block->pin_count++;
+			pthread_mutex_unlock(&dbCache->pool_lock);
+			block_written = AK_write_block(mem_block->block);
+			pthread_mutex_lock(&dbCache->pool_lock);
+			mem_block->pin_count--;
+			pthread_rwlock_unlock(&mem_block->latch);
 			/// if block form cache can not be writed to DB file -> EXIT_ERROR
 			if (block_written != EXIT_SUCCESS)
 			{
+				pthread_mutex_unlock(&dbCache->pool_lock);
 				AK_EPI;
 				exit(EXIT_ERROR);
 			}
 			/// block is clean after successfuly writing it to disk
-			dbCache->cache[i]->dirty = BLOCK_CLEAN;
+			mem_block->dirty = BLOCK_CLEAN;
 		}
+		pthread_mutex_unlock(&dbCache->pool_lock);
 		i++;
 	}
+	AK_fsm_flush();
 	AK_EPI;
 	return EXIT_SUCCESS;
 }
@@ -904,80 +2286,76 @@ TestResult AK_memoman_test()
 	int failed=0;
 	int i;
 	int released_block;
-	int min = 0;
-	int ok = 0;
+	int mapped = 0;
+	AK_mem_block *cache_block;
 	AK_PRO;
 	AK_db_cache* const dbCache = db_cache.ptr;
-	for (i = 0; i < MAX_CACHE_MEMORY; i++) {
-		printf("Block: %d \t l_address: %d \t c_address: %x\t last_read: %i\t last_change %i\t\n", i,
-			   dbCache->cache[i]->block->address, &dbCache->cache[i]->block, &dbCache->cache[i]->timestamp_read,
+	printf("Cache size: %d frames, page table: %d slots, policy: %s, free frames: %d\n", dbCache->size,
+		   dbCache->page_table_size, dbCache->policy->name, dbCache->free_count);
+	for (i = 0; i < dbCache->size; i++) {
+		printf("Frame: %d \t l_address: %d \t c_address: %p\t last_read: %lu\t last_change %lu\t\n", i,
+			   dbCache->cache[i]->address, (void *) &dbCache->cache[i]->block, dbCache->cache[i]->timestamp_read,
 			   dbCache->cache[i]->timestamp_last_change);
 
 		if(dbCache->cache[i]->block == NULL) {
-			printf("\nTEST FAILED! Cache should be full, block %i, points to NULL\n", i);
+			printf("\nTEST FAILED! Frame %i points to NULL\n", i);
 			failed++;
-		}else
+		}
+		else if (dbCache->cache[i]->address != -1 && AK_cache_lookup(dbCache->cache[i]->address) != i)
 		{
-			success++;
+			printf("\nTEST FAILED! Block %i cached in frame %i is not found in the page table\n", dbCache->cache[i]->address, i);
+			failed++;
 		}
-		
-	}
-
-	for (i = 0; i < MAX_CACHE_MEMORY; i++) {
-//        printf("\nINDEX: %i oldest is %i, current is %i, comparison %s\n",i, dbCache->cache[ min ]->timestamp_read,
-//               dbCache->cache[ i ]->timestamp_read,
-//               dbCache->cache[i]->timestamp_read < dbCache->cache[ min ]->timestamp_read ? "true" : "false");
-
-		if (dbCache->cache[i]->timestamp_read != -1 &&
-			dbCache->cache[i]->timestamp_read < dbCache->cache[ min ]->timestamp_read)
+		else
 		{
-			min = i;
+			success++;
 		}
+		if (dbCache->cache[i]->address != -1)
+			mapped++;
 	}
-	AK_blocktable* const allocationBit = ((AK_blocktable*)AK_allocationbit.ptr);
-	if(allocationBit->last_allocated == dbCache->next_replace)
+
+	if (mapped + dbCache->free_count < dbCache->size)
 	{
-		printf("\nTEST FAILED! Next block to replace can not be last allocated block, is %i, should be %i\n",
-			   allocationBit->last_allocated, min);
+		printf("\nTEST FAILED! %i frames are neither cached nor free\n", dbCache->size - mapped - dbCache->free_count);
 		failed++;
-	}else
+	}
+	else
 	{
 		success++;
 	}
-	
 
-	if(min != dbCache->next_replace)
+	/// a cached block has to be returned from the same frame
+	cache_block = AK_get_block(0);
+	if (cache_block == NULL || cache_block != AK_get_block(0) || cache_block->block->address != 0)
 	{
-		printf("\nTEST FAILED! next_replace is not set to oldest block, is %i, should be %i\n",
-			   dbCache->next_replace, min);
+		printf("\nTEST FAILED! Block 0 is not cached in a single frame\n");
 		failed++;
-	}else
+	}
+	else
 	{
 		success++;
 	}
-	
 
 	released_block = AK_release_oldest_cache_block();
 
-	if(released_block != min)
+	if(released_block < 0 || released_block >= dbCache->size || dbCache->cache[released_block]->address != -1)
 	{
-		printf("\nTEST FAILED! released block not oldest, is %i, should be %i\n", released_block, min);
+		printf("\nTEST FAILED! released frame %i still holds a block\n", released_block);
 		failed++;
 	}else
 	{
 		success++;
 	}
-	
 
 	// randomly setting 5 blocks to dirty state to ensure AK_flush_cache() has something to do
 	for(i = 0; i < 5; i++)
 	{
-		AK_mem_block_modify(dbCache->cache[rand()%MAX_CACHE_MEMORY], BLOCK_DIRTY);
+		AK_mem_block_modify(AK_get_block(rand()%((AK_blocktable*)AK_allocationbit.ptr)->last_allocated), BLOCK_DIRTY);
 	}
 
 	AK_flush_cache();
 
-	for(i = 0; i < MAX_CACHE_MEMORY; i++) {
+	for(i = 0; i < dbCache->size; i++) {
 		if(dbCache->cache[i]->dirty != BLOCK_CLEAN)
 		{
 			printf("\nTEST FAILED! block %i has not been flushed to disk\n", i);
@@ -990,23 +2368,134 @@ TestResult AK_memoman_test()
 		
 	}
 
+	/// the catalog cache answers repeated lookups and matches the system catalog
+	{
+		AK_catalog_cache *catalog = catalog_cache.ptr;
+		table_addresses cached, *addresses;
+		AK_header *header;
+		unsigned long hits;
+		int obj_id, num_attr, header_ok;
+
+		addresses = AK_get_table_addresses("student");
+		AK_read_segment_addresses("AK_relation", "student", &cached, &obj_id);
+		hits = catalog->hits;
+		header = AK_catalog_get_header("student", &num_attr);
+		/// the entry has been cached by AK_get_table_addresses, so these lookups read no catalog block
+		if (AK_catalog_get_obj_id("student") != obj_id || AK_catalog_num_attr("student") != num_attr)
+			header_ok = 0;
+		else
+			header_ok = header != NULL && num_attr > 0;
+		if (header_ok)
+		{
+			cache_block = AK_get_block(addresses->address_from[0]);
+			header_ok = memcmp(header, cache_block->block->header, (num_attr < MAX_ATTRIBUTES ? num_attr : MAX_ATTRIBUTES) * sizeof(AK_header)) == 0;
+		}
+		if (memcmp(addresses, &cached, sizeof(table_addresses)) != 0 || catalog->hits != hits + 3 || !header_ok)
+		{
+			printf("\nTEST FAILED! catalog cache does not match the system catalog\n");
+			failed++;
+		}
+		else
+		{
+			success++;
+		}
+		AK_free(addresses);
+		AK_free(header);
+	}
+
+	/// the free space map places rows in the table and skips a block once it is full
+	{
+		table_addresses *addresses;
+		AK_block *block;
+		int first, second, used, dict;
+
+		addresses = AK_get_table_addresses("student");
+		first = AK_fsm_find_block(addresses, 10);
+		block = first == EXIT_ERROR ? NULL : AK_get_block(first)->block;
+		second = EXIT_ERROR;
+		if (block != NULL)
+		{
+			used = block->AK_free_space;
+			dict = block->last_tuple_dict_id;
+			block->AK_free_space = MAX_FREE_SPACE_SIZE;
+			AK_fsm_update_block(block);
+			second = AK_fsm_find_block(addresses, 10);
+			block->AK_free_space = used;
+			block->last_tuple_dict_id = dict;
+			AK_fsm_update_block(block);
+		}
+		if (block == NULL || first < addresses->address_from[0] || second == first
+			|| AK_fsm_find_block(addresses, 10) != first || AK_fsm_flush() != EXIT_SUCCESS)
+		{
+			printf("\nTEST FAILED! free space map placed a row in block %i, then %i\n", first, second);
+			failed++;
+		}
+		else
+		{
+			success++;
+		}
+		AK_free(addresses);
+	}
+
 	//printf("\nTEST PASSED!\n");
 	AK_EPI;
 	return TEST_result(success,failed);
 }
 
+/// shared counter the buffer pool test threads increment under a block latch
+static int AK_buffer_pool_test_counter;
+
+/**
+  * @author agent
+  * @brief Thread function of the buffer pool test. Pins block 0 and increments the shared counter under its
+  * exclusive latch while reading other blocks through the pool.
+  * @param arg number of blocks the thread may read
+  * @return NULL
+ */
+static void *AK_buffer_pool_test_thread(void *arg)
+{
+	int blocks = *(int *) arg;
+	int i, value;
+	AK_mem_block *pinned, *mem_block;
+
+	for (i = 0; i < 100; i++)
+	{
+		pinned = AK_pin_block(0);
+		if (pinned == NULL)
+			continue;
+		AK_latch_block(pinned, EXCLUSIVE_LOCK);
+		value = AK_buffer_pool_test_counter;
+		sched_yield();
+		AK_buffer_pool_test_counter = value + 1;
+		AK_unlatch_block(pinned);
+
+		mem_block = AK_pin_block(rand() % blocks);
+		if (mem_block != NULL)
+		{
+			AK_latch_block(mem_block, SHARED_LOCK);
+			AK_unlatch_block(mem_block);
+			AK_unpin_block(mem_block, BLOCK_CLEAN);
+		}
+		AK_unpin_block(pinned, BLOCK_CLEAN);
+	}
+	return NULL;
+}
+
 TestResult AK_memoman_test2()
 {
 	int success=0;
 	int failed=0;
-	int i;
+	int i, p;
 	//int aa=0;
 	int aa=406;
 	int read_block = 0;
-	int ok;
-	int flushed_pos;
+	int hot_block;
+	int blocks;
+	int mapped;
+	char *policies[] = {"clock", "lru-k"};
 	table_addresses *addrs;
 	AK_mem_block *cache_block;
+	const AK_cache_policy *old_policy;
 	AK_PRO;
 	AK_blocktable* const allocationBit = ((AK_blocktable*)AK_allocationbit.ptr);
 	printf("\tPick up block from 0 to: %d \n",allocationBit->last_allocated );
@@ -1023,48 +2512,139 @@ TestResult AK_memoman_test2()
 	}
 
 	//find a block that is not loaded in cache
-	while(1) {
+	for (i = 0; i < allocationBit->last_allocated; i++) {
 		//select a random block from range 0 to last block allocated on disk
 		read_block = rand() % allocationBit->last_allocated;
-		ok = 1;
-		for (i = 0; i < MAX_CACHE_MEMORY; i++) {
-			if(dbCache->cache[i]->block->address == read_block) {
-				ok = 0;
-				break;
-			}
-		}
+		if (AK_cache_lookup(read_block) == -1)
+			break;
+	}
+
+	cache_block = AK_get_block(read_block);
 
-		if(ok) break;
+	if(cache_block == NULL || cache_block->block->address != read_block || AK_cache_lookup(read_block) != cache_block->frame) {
+		printf("\nTEST FAILED! block with address %i is not cached\n", read_block);
+		failed++;
+	}
+	else
+	{
+		success++;
 	}
 
-	for (i = 0; i < MAX_CACHE_MEMORY; i++) {
-		if(dbCache->cache[i]->block->address == read_block) {
-			printf("\nTEST FAILED! block with address %i already cached at position %i\n", read_block, i);
+	/// read more blocks than there are frames with every policy and check the page table stays consistent
+	blocks = allocationBit->last_allocated < 2 * dbCache->size ? allocationBit->last_allocated : 2 * dbCache->size;
+	old_policy = dbCache->policy;
+	for (p = 0; p < 2; p++)
+	{
+		if (AK_cache_set_policy(policies[p]) != EXIT_SUCCESS)
+		{
+			printf("\nTEST FAILED! policy %s not available\n", policies[p]);
+			failed++;
+			continue;
+		}
+		hot_block = 0;
+		AK_get_block(hot_block);
+		AK_get_block(hot_block);
+		for (i = 1; i < blocks; i++)
+		{
+			cache_block = AK_get_block(i);
+			if (cache_block == NULL || cache_block->block->address != i)
+			{
+				printf("\nTEST FAILED! policy %s returned wrong block for address %i\n", policies[p], i);
+				failed++;
+				break;
+			}
+		}
+		mapped = 0;
+		for (i = 0; i < dbCache->size; i++)
+		{
+			if (dbCache->cache[i]->address == -1)
+				continue;
+			mapped++;
+			if (AK_cache_lookup(dbCache->cache[i]->address) != i)
+				break;
+		}
+		if (i < dbCache->size || mapped > dbCache->size)
+		{
+			printf("\nTEST FAILED! page table inconsistent after scan with policy %s\n", policies[p]);
 			failed++;
-		}else
+		}
+		else
 		{
 			success++;
 		}
-		
+		/// LRU-K keeps a block referenced twice while a scan touches every other block only once
+		if (p == 1 && blocks > dbCache->size)
+		{
+			if (AK_cache_lookup(hot_block) == -1)
+			{
+				printf("\nTEST FAILED! LRU-K evicted the hot block during a scan\n");
+				failed++;
+			}
+			else
+			{
+				success++;
+			}
+		}
 	}
+	dbCache->policy = old_policy;
 
-	flushed_pos = AK_release_oldest_cache_block();
-	AK_cache_block(read_block, dbCache->cache[flushed_pos]);
-
-	if(dbCache->cache[flushed_pos]->block->address != read_block) {
-		printf("\nTEST FAILED! block with address %i is not cached at position %i\n", read_block, flushed_pos);
+	/// a pinned block is never replaced, however many other blocks are read
+	cache_block = AK_pin_block(0);
+	for (i = 1; i < blocks; i++)
+		AK_get_block(i);
+	if (cache_block == NULL || AK_cache_lookup(0) != cache_block->frame || cache_block->block->address != 0)
+	{
+		printf("\nTEST FAILED! pinned block 0 has been replaced\n");
 		failed++;
 	}
 	else
 	{
 		success++;
 	}
-	
+	if (cache_block == NULL || AK_unpin_block(cache_block, BLOCK_CLEAN) != EXIT_SUCCESS
+		|| AK_unpin_block(cache_block, BLOCK_CLEAN) != EXIT_ERROR)
+	{
+		printf("\nTEST FAILED! pin count of block 0 is wrong\n");
+		failed++;
+	}
+	else
+	{
+		success++;
+	}
+
+	/// threads sharing the pool: updates under an exclusive latch are not lost
+	{
+		pthread_t threads[4];
+		AK_buffer_pool_test_counter = 0;
+		for (i = 0; i < 4; i++)
+			pthread_create(&threads[i], NULL, AK_buffer_pool_test_thread, &blocks);
+		for (i = 0; i < 4; i++)
+			pthread_join(threads[i], NULL);
+		mapped = 0;
+		for (i = 0; i < dbCache->size; i++)
+		{
+			mapped += dbCache->cache[i]->pin_count;
+			/// every block is read into one frame only and no frame is left in I/O
+			if ((dbCache->cache[i]->address != -1 && AK_cache_lookup(dbCache->cache[i]->address) != i)
+				|| dbCache->cache[i]->io_pending)
+				mapped = -1;
+		}
+		if (AK_buffer_pool_test_counter != 400 || mapped != 0)
+		{
+			printf("\nTEST FAILED! concurrent pool access: counter %d (expected 400), pin count %d\n",
+				   AK_buffer_pool_test_counter, mapped);
+			failed++;
+		}
+		else
+		{
+			success++;
+		}
+	}
 
 	char *AK_relation_name = "AK_relation";
 	addrs = AK_get_segment_addresses_internal(AK_relation_name, AK_REFERENCE);
 
-	cache_block = AK_get_block(addrs->address_from[i]);
+	cache_block = AK_get_block(addrs->address_from[0]);
 
 	if(!strcmp(cache_block->block->data, AK_relation_name)) {
 		printf("\nTEST FAILED! returned wrong cache block, is %s, should be %s\n", cache_block->block->data, "AK_relation");
@@ -1074,7 +2654,7 @@ TestResult AK_memoman_test2()
 	{
 		success++;
 	}
-	
+	AK_free(addrs);
 
 	//printf("\nTEST PASSED!\n");
 	AK_EPI;
@@ -26,9 +26,15 @@
 #include "../auxi/ptrcontainer.h"
 
 /**
-  * @author Unknown
+ * @def AK_LRU_K_MAX
+ * @brief Constant declaring the maximum number of references remembered per frame by the LRU-K policy
+ */
+#define AK_LRU_K_MAX 4
+
+/**
+  * @author Unknown, updated by agent (buffer pool frames)
   * @struct AK_mem_block
-  * @brief Structure that defines a block of data in memory
+  * @brief Structure that defines a block of data in memory (one frame of the buffer pool)
  */
 typedef struct {
     /// pointer to block from DB file
@@ -39,18 +45,76 @@ typedef struct {
     unsigned long timestamp_read;
     /// timestamp when the block has lastly been changed
     unsigned long timestamp_last_change;
+    /// index of the frame in the buffer pool (-1 if the block is not part of the pool)
+    int frame;
+    /// address of the block held by the frame (-1 if the frame is free)
+    int address;
+    /// reference bit used by the CLOCK policy
+    int reference;
+    /// logical times of the last AK_LRU_K_MAX references used by the LRU-K policy (0 is the most recent)
+    unsigned long history[ AK_LRU_K_MAX ];
+    /// number of users that pinned the frame; pinned frames are never replaced
+    int pin_count;
+    /// 1 while the frame is read from or written to disk; the thread doing the I/O holds the exclusive latch
+    int io_pending;
+    /// latch protecting the block contents (shared for readers, exclusive for writers)
+    pthread_rwlock_t latch;
 } AK_mem_block;
 
 /**
-  * @author Unknown
+  * @author agent
+  * @struct AK_page_table_entry
+  * @brief Structure that defines one slot of the open-addressing page table (block address -> frame)
+ */
+typedef struct {
+    /// block address (-1 if the slot is empty)
+    int address;
+    /// index of the frame holding the block
+    int frame;
+} AK_page_table_entry;
+
+/**
+  * @author agent
+  * @struct AK_cache_policy
+  * @brief Structure that defines a pluggable page replacement policy of the buffer pool
+ */
+typedef struct {
+    /// policy name as used in config.ini (memory:cache_policy)
+    const char *name;
+    /// records a reference of the given frame
+    void (*access)(AK_mem_block *mem_block);
+    /// chooses the frame to be replaced, returns its index or EXIT_ERROR
+    int (*victim)();
+} AK_cache_policy;
+
+/**
+  * @author Unknown, updated by agent (hash-indexed buffer pool)
   * @struct AK_db_cache
-  * @brief Structure that defines global cache memory
+  * @brief Structure that defines global cache memory (buffer pool)
  */
 typedef struct {
-    /// last recently read blocks
-    AK_mem_block * cache[ MAX_CACHE_MEMORY ];
-    /// next cached block to be replaced (0 - MAX_CACHE_MEMORY-1); depends on caching algorithm
+    /// frames of the buffer pool
+    AK_mem_block ** cache;
+    /// number of frames (memory:cache_size in config.ini)
+    int size;
+    /// next frame to be examined by the replacement policy (CLOCK hand)
     int next_replace;
+    /// open-addressing page table that maps block addresses to frames
+    AK_page_table_entry * page_table;
+    /// number of page table slots (power of two, at least twice the number of frames)
+    int page_table_size;
+    /// stack of free frames
+    int * free_frames;
+    /// number of frames on the free stack
+    int free_count;
+    /// active replacement policy
+    const AK_cache_policy * policy;
+    /// number of references remembered by the LRU-K policy
+    int lru_k;
+    /// logical clock incremented on every reference
+    unsigned long access_time;
+    /// lock protecting the page table, the free stack, pin counts and the policy state; it is not held during disk I/O
+    pthread_mutex_t pool_lock;
 } AK_db_cache;
 
 /**
@@ -153,6 +217,124 @@ typedef struct {
     AK_query_mem_result * result;
 } AK_query_mem;
 
+/**
+ * @def AK_CATALOG_BUCKETS
+ * @brief Constant declaring the number of hash buckets of the schema catalog cache
+ */
+#define AK_CATALOG_BUCKETS 64
+
+/**
+  * @author agent
+  * @struct AK_catalog_entry
+  * @brief Structure that defines a cached system catalog entry: the extents, object id and header of a segment, for a
+  * table also the names of its indexes
+ */
+typedef struct AK_catalog_entry {
+    /// system catalog table the segment is registered in (AK_relation, AK_index); empty for system tables
+    char sys_table[ MAX_ATT_NAME ];
+    /// segment name
+    char name[ MAX_ATT_NAME ];
+    /// extents of the segment; for a system table address_from[0] is its address in block 0
+    table_addresses addresses;
+    /// object id from the first catalog row of the segment, EXIT_ERROR if there is none
+    int obj_id;
+    /// number of attributes of the segment header
+    int num_attr;
+    /// header of the segment (num_attr attributes, chained blocks included)
+    AK_header * header;
+    /// names of the indexes registered on the table in AK_index (index_count names)
+    char (* indexes)[ MAX_ATT_NAME ];
+    /// number of indexes of the table
+    int index_count;
+    /// next entry in the bucket
+    struct AK_catalog_entry * next;
+} AK_catalog_entry;
+
+/**
+  * @author agent
+  * @struct AK_catalog_cache
+  * @brief Structure that defines the schema catalog cache (segment name -> catalog entry)
+ */
+typedef struct {
+    /// hash buckets of catalog entries
+    AK_catalog_entry * buckets[ AK_CATALOG_BUCKETS ];
+    /// incremented on every invalidation; entries read before an invalidation are not stored
+    unsigned long generation;
+    /// number of lookups answered from the cache
+    unsigned long hits;
+    /// number of lookups that read the system catalog
+    unsigned long misses;
+    /// lock protecting the buckets and counters
+    pthread_mutex_t lock;
+} AK_catalog_cache;
+
+/**
+ * @def AK_FSM_CLASSES
+ * @brief Constant declaring the number of free space classes of the free space map. Class AK_FSM_UNKNOWN means
+ * the block has not been classified yet, AK_FSM_FULL that no row should be placed in it; the other classes
+ * hold blocks with at least (class - AK_FSM_FIRST_CLASS) * AK_FSM_CLASS_WIDTH free bytes.
+ */
+#define AK_FSM_CLASSES 16
+#define AK_FSM_UNKNOWN 0
+#define AK_FSM_FULL 1
+#define AK_FSM_FIRST_CLASS 2
+/**
+ * @def AK_FSM_CLASS_WIDTH
+ * @brief Constant declaring the number of free bytes covered by one free space class
+ */
+#define AK_FSM_CLASS_WIDTH ((DATA_BLOCK_SIZE * DATA_ENTRY_SIZE + AK_FSM_CLASSES - AK_FSM_FIRST_CLASS - 1) / (AK_FSM_CLASSES - AK_FSM_FIRST_CLASS))
+/**
+ * @def AK_FSM_SEGMENT_BUCKETS
+ * @brief Constant declaring the number of hash buckets of free space map segments
+ */
+#define AK_FSM_SEGMENT_BUCKETS 64
+
+/**
+  * @author agent
+  * @struct AK_fsm_segment
+  * @brief Structure that defines the free space lists of one segment. Blocks of every class are kept in a
+  * doubly linked list threaded through the next and prev arrays of the free space map.
+ */
+typedef struct AK_fsm_segment {
+    /// extents of the segment the lists were built from; address_from[0] identifies the segment
+    table_addresses addresses;
+    /// number of extents in addresses
+    int extents;
+    /// number of chained blocks a row is spread over; only the first block of every group is listed
+    int stride;
+    /// first block of every class, -1 if the class is empty
+    int head[ AK_FSM_CLASSES ];
+    /// next segment in the bucket
+    struct AK_fsm_segment * next;
+} AK_fsm_segment;
+
+/**
+  * @author agent
+  * @struct AK_free_space_map
+  * @brief Structure that defines the free space map. The class of every block is kept in the file
+  * DB_FILE followed by ".fsm"; the per segment lists are built from it the first time a segment is used.
+ */
+typedef struct {
+    /// descriptor of the free space map file
+    int fd;
+    /// number of blocks of the DB file
+    int blocks;
+    /// free space class of every block
+    unsigned char * classes;
+    /// next block of the same class and segment, -1 at the end of a list
+    int * next;
+    /// previous block of the same class and segment, -1 at the beginning of a list
+    int * prev;
+    /// segment whose lists hold the block, NULL if it is in no list
+    AK_fsm_segment ** owner;
+    /// hash buckets of segments (address_from[0] -> segment)
+    AK_fsm_segment * buckets[ AK_FSM_SEGMENT_BUCKETS ];
+    /// set when classes changed since the map was last written; the file is then marked as not clean
+    int dirty;
+    /// lock protecting the map
+    pthread_mutex_t lock;
+} AK_free_space_map;
+
 /**
  * @var db_cache
  * @brief Variable that defines the db cache
@@ -168,6 +350,16 @@ extern PtrContainer redo_log;
  * @brief Variable that defines the global query memory
  */
 extern PtrContainer query_mem;
+/**
+ * @var catalog_cache
+ * @brief Variable that defines the schema catalog cache
+ */
+extern PtrContainer catalog_cache;
+/**
+ * @var free_space_map
+ * @brief Variable that defines the free space map
+ */
+extern PtrContainer free_space_map;
 
 /**
   * @author Mario Novoselec
@@ -225,6 +417,104 @@ int AK_query_mem_AK_malloc();
  */
 void AK_query_mem_AK_free();
 
+/**
+ * @author agent
+ * @brief  Function that initializes the schema catalog cache (variable catalog_cache)
+ * @return EXIT_SUCCESS if the catalog cache has been initialized, EXIT_ERROR otherwise
+ */
+int AK_catalog_AK_malloc();
+
+/**
+ * @author agent
+ * @brief  Function that drops all cached catalog entries. Called whenever the system catalog or a table header
+ * changes (creating, dropping, extending and renaming segments).
+ */
+void AK_catalog_invalidate();
+
+/**
+ * @author agent
+ * @brief  Function that fetches the number of attributes of a table from the catalog cache
+ * @param table table name
+ * @return number of attributes, EXIT_WARNING if the table has no extents
+ */
+int AK_catalog_num_attr(char *table);
+
+/**
+ * @author agent
+ * @brief  Function that fetches a copy of a table header from the catalog cache
+ * @param table table name
+ * @param num_attr number of attributes in the returned header (may be NULL)
+ * @return header array ended by an empty entry that the caller has to free, NULL if the table has no extents
+ */
+AK_header *AK_catalog_get_header(char *table, int *num_attr);
+
+/**
+ * @author agent
+ * @brief  Function that fetches the zero-based index of an attribute from the catalog cache
+ * @param table table name
+ * @param attribute attribute name
+ * @return index of the attribute, EXIT_WARNING if there is no such attribute
+ */
+int AK_catalog_get_attr_index(char *table, char *attribute);
+
+/**
+ * @author agent
+ * @brief  Function that fetches the obj_id of a table from the catalog cache
+ * @param table table name
+ * @return obj_id of the table, EXIT_ERROR if the table is not in AK_relation
+ */
+int AK_catalog_get_obj_id(char *table);
+
+/**
+ * @author agent
+ * @brief  Function that fetches the names of the indexes of a table from the catalog cache, the indexes whose row
+ * in AK_index has the table as table_id
+ * @param table table name
+ * @param indexes receives up to max index names (may be NULL)
+ * @param max size of indexes
+ * @return number of indexes of the table, it may be larger than max
+ */
+int AK_catalog_get_indexes(char *table, char (*indexes)[MAX_ATT_NAME], int max);
+
+/**
+ * @author agent
+ * @brief  Function that initializes the free space map (variable free_space_map) and reads the classes of
+ * blocks from its file. A file written for another DB file or not closed cleanly is ignored.
+ * @return EXIT_SUCCESS if the free space map has been initialized, EXIT_ERROR otherwise
+ */
+int AK_fsm_AK_malloc();
+
+/**
+ * @author agent
+ * @brief  Function that finds a block of a segment with room for a row in constant time, using the free space
+ * lists of the segment. The chosen block is the fullest one that still has size free bytes.
+ * @param addresses extents of the segment
+ * @param size number of data bytes the row needs
+ * @return address of the block, EXIT_ERROR if no block of the segment has room
+ */
+int AK_fsm_find_block(table_addresses *addresses, int size);
+
+/**
+ * @author agent
+ * @brief  Function that records the free space of a block after rows have been inserted into or deleted from it
+ * @param block changed block
+ */
+void AK_fsm_update_block(AK_block *block);
+
+/**
+ * @author agent
+ * @brief  Function that records that a block has been (re)initialized as an empty block of a new extent
+ * @param address address of the block
+ */
+void AK_fsm_set_empty(int address);
+
+/**
+ * @author agent
+ * @brief  Function that writes the free space map to its file and marks the file as clean
+ * @return EXIT_SUCCESS if the map has been written, EXIT_ERROR otherwise
+ */
+int AK_fsm_flush();
+
 /**
  * @author Miroslav Policki
  * @brief  Function that initializes the memory manager (cache, redo log and query memory)
@@ -242,11 +532,55 @@ int AK_memoman_init();
  */
 AK_mem_block *AK_get_block(int num);
 /**
- * @author Antonio Martinović
- * @brief Functions that flushes the oldest block to disk and recalculates the next block to remove
- * @return index of flushed cache block
+ * @author agent
+ * @brief Function that reads a block into the buffer pool and pins it. A pinned frame is never replaced, so the
+ * returned pointer stays valid until the matching AK_unpin_block call.
+ * @param num block number (address)
+ * @return pinned frame holding the block, NULL if the block can not be read or all frames are pinned
+ */
+AK_mem_block *AK_pin_block(int num);
+/**
+ * @author agent
+ * @brief Function that releases a pin obtained with AK_pin_block
+ * @param mem_block pinned frame
+ * @param dirty BLOCK_DIRTY if the block has been changed while pinned, BLOCK_CLEAN otherwise
+ * @return EXIT_SUCCESS if the frame has been unpinned, EXIT_ERROR if it was not pinned
+ */
+int AK_unpin_block(AK_mem_block *mem_block, int dirty);
+/**
+ * @author agent
+ * @brief Function that latches the contents of a pinned frame
+ * @param mem_block pinned frame
+ * @param mode SHARED_LOCK for reading, EXCLUSIVE_LOCK for changing the block
+ */
+void AK_latch_block(AK_mem_block *mem_block, int mode);
+/**
+ * @author agent
+ * @brief Function that releases a latch obtained with AK_latch_block
+ * @param mem_block latched frame
+ */
+void AK_unlatch_block(AK_mem_block *mem_block);
+/**
+ * @author Antonio Martinović, updated by agent
+ * @brief Function that releases the frame chosen by the replacement policy. The block it holds is flushed to disk
+ * if dirty and removed from the page table.
+ * @return index of released frame, EXIT_ERROR if no frame can be released
  */
 int AK_release_oldest_cache_block();
+/**
+ * @author agent
+ * @brief Function that finds the frame holding a block by looking it up in the page table
+ * @param num block number (address)
+ * @return index of the frame, -1 if the block is not cached
+ */
+int AK_cache_lookup(int num);
+/**
+ * @author agent
+ * @brief Function that selects the replacement policy of the buffer pool
+ * @param name policy name ("clock" or "lru-k")
+ * @return EXIT_SUCCESS if the policy exists, EXIT_ERROR otherwise
+ */
+int AK_cache_set_policy(const char *name);
 /**
  * @author Alen Novosel.
  * @brief  Function that modifies the "dirty" bit of a block, and update the timestamps accordingly.
@@ -254,7 +588,7 @@ int AK_release_oldest_cache_block();
 int AK_mem_block_modify(AK_mem_block* mem_block, int dirty);
 /**
  * @author Matija Šestak.
- * @brief  Function that re-reads all the blocks from the disk
+ * @brief  Function that re-reads all the unpinned blocks from the disk
  * @result EXIT_SUCCESS
  */
 int AK_refresh_cache();
@@ -18,8 +18,7 @@
  */
 
 #include "aggregation.h"
-
-extern search_result AK_search_unsorted(char *szRelation, search_params *aspParams, int iNum_search_params);
+#include "iterator.h"
 
 /**
  @author Dejan Frankovic
@@ -132,13 +131,12 @@ void AK_agg_input_fix(AK_agg_input *input) {
 }
 
 /**
-   @author Dejan Frankovic
-   @brief Function that aggregates a given table by given attributes. Firstly, AGG_TASK_AVG_COUNT and
-          AGG_TASK_AVG_SUM are put on the beginning of the input object. Then for loop iterates through
-          input tasks and assignes the type of aggregation operation according to aggregation operation.
-	  New table has to be created. For loop goes through given table. GROUP operation is executed separately
-	  from other operations. Addresses of records are put in needed_values array and
-	  results are put in new table.
+   @author Dejan Frankovic, updated by agent (hash aggregation)
+   @brief Function that aggregates a given table by given attributes. The rows of the source table are read once by
+          an aggregation node of the iterator executor, which keeps one group per distinct combination of grouping
+          values in a hash table and updates the COUNT, SUM, MIN, MAX and AVG accumulators of the group in place.
+          Groups that do not fit into memory are aggregated from hash partitions. The groups are written into the
+          new table once at the end, in order of their first row.
    @param input input object with list of atributes by which we aggregate and types of aggregations
    @param source_table - table name for the source table
    @param agg_table  table name for aggregated table
@@ -146,534 +144,21 @@ void AK_agg_input_fix(AK_agg_input *input) {
 
  */
 int AK_aggregation(AK_agg_input *input, char *source_table, char *agg_table) {
-    int i, j;
+    AK_operator *plan;
+    int rows;
     AK_PRO;
-    AK_agg_input_fix(input);
-    AK_header *att_root = (*input).attributes;
-    int *att_tasks = (*input).tasks;
-    int num_aggregations = (*input).counter;
-	AK_header *agg_head_ptr[MAX_ATTRIBUTES];
-    AK_header agg_head[MAX_ATTRIBUTES];
-    int agg_group_number = 0;
-    int inttemp = 0;
-    double doubletemp = 0;
-    float floattemp = 0;
-
-    char agg_h_name[MAX_ATT_NAME];
-    int agg_h_type;
-    char group_h_name[MAX_ATT_NAME];
-
-    AK_agg_value *needed_values = AK_malloc(sizeof (AK_agg_value) * num_aggregations);
-
-    char new_table[MAX_ATT_NAME];
-    sprintf(new_table, "_%s", agg_table);
-
-    for (i = 0; i < num_aggregations; i++) 
-	{
-        agg_h_type = att_root[i].type;
-        switch (att_tasks[i]) {
-            case AGG_TASK_GROUP:
-                strcpy(agg_h_name, att_root[i].att_name);
-                strcpy(group_h_name, att_root[i].att_name);
-                agg_group_number++;
-                break;
-            case AGG_TASK_COUNT:
-                sprintf(agg_h_name, "Cnt(%s)", att_root[i].att_name);
-                agg_h_type = TYPE_INT;
-                break;
-            case AGG_TASK_SUM:
-                sprintf(agg_h_name, "Sum(%s)", att_root[i].att_name);
-                if (agg_h_type != TYPE_INT && agg_h_type != TYPE_FLOAT && agg_h_type != TYPE_NUMBER)
-                    agg_h_type = TYPE_INT;
-                break;
-            case AGG_TASK_MAX:
-                sprintf(agg_h_name, "Max(%s)", att_root[i].att_name);
-                if (agg_h_type != TYPE_INT && agg_h_type != TYPE_FLOAT && agg_h_type != TYPE_NUMBER)
-                    agg_h_type = TYPE_INT;
-                break;
-            case AGG_TASK_MIN:
-                sprintf(agg_h_name, "Min(%s)", att_root[i].att_name);
-                if (agg_h_type != TYPE_INT && agg_h_type != TYPE_FLOAT && agg_h_type != TYPE_NUMBER)
-                    agg_h_type = TYPE_INT;
-                break;
-            case AGG_TASK_AVG:
-                sprintf(agg_h_name, "Avg(%s)", att_root[i].att_name);
-                agg_h_type = TYPE_FLOAT;
-                break;
-            case AGG_TASK_AVG_COUNT:
-                sprintf(agg_h_name, "_cAvg(%s)", att_root[i].att_name);
-                agg_h_type = TYPE_INT;
-                break;
-            case AGG_TASK_AVG_SUM:
-                sprintf(agg_h_name, "_sAvg(%s)", att_root[i].att_name);
-                agg_h_type = TYPE_FLOAT;
-                break;
-        }
-        needed_values[i].agg_task = att_tasks[i];
-        strcpy(needed_values[i].att_name, att_root[i].att_name);
-		agg_head_ptr[i] = AK_create_header(agg_h_name, agg_h_type, FREE_INT, FREE_CHAR, FREE_CHAR);
-        agg_head[i] = *(agg_head_ptr[i]);
-    }
-
-    // removing rest of the unneeded attributes (where attribute id is greater than number of used aggregations)
-    for (i = num_aggregations; i < MAX_ATTRIBUTES; i++) 
-	{
-        memcpy(&agg_head[i], "\0", sizeof ( "\0"));
-    }
-    
-
-    int startAddress = AK_initialize_new_segment(new_table, SEGMENT_TYPE_TABLE, agg_head);
-
-    if (startAddress != EXIT_ERROR)
-        printf("\nTABLE %s CREATED!\n", new_table);
-
-    // this was an optimisation or something, so that sort works normally
-    //sort_segment(source_table,group_h_name);
-
-    search_params search_parameters[agg_group_number];
-    search_result sresult;
-    j = 0;
-
-
-    table_addresses *addresses = (table_addresses*) AK_get_table_addresses(source_table);
-    int num_attr = AK_num_attr(source_table);
-
-    int k, l, m, n, o, counter;
-
-    AK_block *temp;
-    AK_mem_block *mem_block;
-
-
-	rowroot_struct rowroot_table = {.row_root = (struct list_node*) AK_malloc(sizeof(struct list_node))};
-
-    AK_Init_L3(&rowroot_table);
 
+    plan = AK_aggregation_operator(AK_scan_operator(source_table), input);
+    rows = AK_iterator_materialize(plan, agg_table);
+    AK_operator_free(plan);
 
-    i = 0;
-    counter = 0;
-
-    while (addresses->address_from[ i ] != 0) {
-        for (j = addresses->address_from[ i ]; j < addresses->address_to[ i ]; j++) {
-            temp = (AK_block*) AK_read_block(j);
-            if ( temp->last_tuple_dict_id == 0 )
-            	break;
-            for (k = 0; k < temp->last_tuple_dict_id; k += num_attr) {
-                counter++;
-                n = 0;
-
-                //aggregation when no grouping is done will be executed separately to skip the unsorted search
-                if(agg_group_number == 0){
-                	for (l = 0; l < num_attr; l++) {
-						for (m = 0; m < num_aggregations; m++) {
-							if (strcmp(needed_values[m].att_name, temp->header[l].att_name) == 0) {
-								switch (needed_values[m].agg_task) {
-									case AGG_TASK_COUNT:
-										//no break is intentional
-									case AGG_TASK_AVG_COUNT:
-										memcpy(needed_values[m].data, &counter, sizeof(int));
-										needed_values[m].data[sizeof(int)] = '\0';
-										break;
-
-									case AGG_TASK_MAX:
-										switch (agg_head[m].type) {
-											case TYPE_INT:
-												memcpy(&inttemp, &(temp->data[temp->tuple_dict[k + l].address]), temp->tuple_dict[k + l].size);
-												if (*((int*)needed_values[m].data) < inttemp || counter == 1)
-													memcpy(needed_values[m].data, &inttemp, sizeof (int));
-												break;
-
-											case TYPE_FLOAT:
-												memcpy(&floattemp, &(temp->data[temp->tuple_dict[k + l].address]), temp->tuple_dict[k + l].size);
-												if (*((float *)needed_values[m].data) < floattemp || counter == 1)
-													memcpy(needed_values[m].data, &floattemp, sizeof(float));
-												break;
-
-											case TYPE_NUMBER:
-												memcpy(&doubletemp, &(temp->data[temp->tuple_dict[k + l].address]), temp->tuple_dict[k + l].size);
-												if (*((double *)needed_values[m].data) < doubletemp || counter == 1)
-													memcpy(needed_values[m].data, &doubletemp, sizeof(double));
-												break;
-										}
-										needed_values[m].data[temp->tuple_dict[k + l].size] = '\0';
-										break;
-
-									case AGG_TASK_MIN:
-										switch (agg_head[m].type) {
-											case TYPE_INT:
-												memcpy(&inttemp, &(temp->data[temp->tuple_dict[k + l].address]), temp->tuple_dict[k + l].size);
-												if (*((int*)needed_values[m].data) > inttemp || counter == 1)
-													memcpy(needed_values[m].data, &inttemp, sizeof (int));
-												break;
-
-											case TYPE_FLOAT:
-												memcpy(&floattemp, &(temp->data[temp->tuple_dict[k + l].address]), temp->tuple_dict[k + l].size);
-												if (*((float *)needed_values[m].data) > floattemp || counter == 1)
-													memcpy(needed_values[m].data, &floattemp, sizeof(float));
-												break;
-
-											case TYPE_NUMBER:
-												memcpy(&doubletemp, &(temp->data[temp->tuple_dict[k + l].address]), temp->tuple_dict[k + l].size);
-												if (*((double *)needed_values[m].data) > doubletemp || counter == 1)
-													memcpy(needed_values[m].data, &doubletemp, sizeof(double));
-												break;
-										}
-										needed_values[m].data[temp->tuple_dict[k + l].size] = '\0';
-										break;
-
-									case AGG_TASK_SUM:
-										//no break is intentional
-									case AGG_TASK_AVG_SUM:
-										switch (agg_head[m].type) {
-											case TYPE_INT:
-												memcpy(&inttemp, &(temp->data[temp->tuple_dict[k + l].address]), temp->tuple_dict[k + l].size);
-												inttemp += *((int*) needed_values[m].data);
-												memcpy(needed_values[m].data, &inttemp, sizeof (int));
-												break;
-
-											case TYPE_FLOAT:
-												memcpy(&floattemp, &(temp->data[temp->tuple_dict[k + l].address]), temp->tuple_dict[k + l].size);
-												floattemp += *((float *)needed_values[m].data);
-												memcpy(needed_values[m].data, &floattemp, sizeof (float));
-												break;
-
-											case TYPE_NUMBER:
-												memcpy(&doubletemp, &(temp->data[temp->tuple_dict[k + l].address]), temp->tuple_dict[k + l].size);
-												doubletemp += *((double*) needed_values[m].data);
-												memcpy(needed_values[m].data, &doubletemp, sizeof (double));
-												break;
-										}
-										needed_values[m].data[temp->tuple_dict[k + l].size] = '\0';
-								}
-							}
-						}
-					}
-				}
-				else{
-
-					for (l = 0; l < num_attr; l++) {
-						for (m = 0; m < num_aggregations; m++) {
-							if (strcmp(needed_values[m].att_name, temp->header[l].att_name) == 0) {
-
-								memcpy(needed_values[m].data, &(temp->data[temp->tuple_dict[k + l].address]), temp->tuple_dict[k + l].size);
-								needed_values[m].data[temp->tuple_dict[k + l].size] = '\0';
-
-								if (needed_values[m].agg_task == AGG_TASK_GROUP) {
-									search_parameters[n].iSearchType = SEARCH_PARTICULAR;
-									search_parameters[n].pData_lower = AK_malloc(temp->tuple_dict[k + l].size + 1);
-									memcpy(search_parameters[n].pData_lower, &(temp->data[temp->tuple_dict[k + l].address]), temp->tuple_dict[k + l].size);
-									((char *) search_parameters[n].pData_lower)[ temp->tuple_dict[k + l].size ] = '\0';
-									search_parameters[n].szAttribute = (temp->header[l].att_name);
-									n++;
-								}
-							}
-						}
-					}
-
-					sresult = AK_search_unsorted(new_table, search_parameters, agg_group_number);
-
-					if (sresult.iNum_tuple_addresses == 0) {
-						AK_DeleteAll_L3(&rowroot_table);
-
-						for (l = 0; l < num_aggregations; l++) {
-							switch (needed_values[l].agg_task) {
-								case AGG_TASK_COUNT:
-									//no break is intentional
-								case AGG_TASK_AVG_COUNT:
-									inttemp = 1;
-									/**
-									 * THIS SINGLE LINE BELOW (memcpy) is the purpose of ALL evil in the world!
-									 * This line is the reason why test function prints one extra empty 
-									 * row with "nulls" at the end! Trust me! Comment it, and you will see - 
-									 * test function will not print extra row with nulls (but counts and averages 
-									 * in table will be all messed up!)
-									 * After two days of hard research, I still have not found what is the
-									 * reason behind printing extra row at the end! Fellow programmer,
-									 * if you really really want to solve this issue, arm yourself with
-									 * at least 2 liters of hot coffee!
-									 *
-									 * What this line does? What is the purpose of this line in the universe?
-									 * Well, fellow programmer, this line sets the initial count to 1.
-									 * That means if name "Ivan" is found, it will have count of 1
-									 * because, well, that's the first Ivan that is found!
-									 * If function finds another Ivan (which, actually, will happen),
-									 * this part of code will not handle it (other part of code will).
-									 *
-									 * That actually means that this little piece of code 
-									 * (this line below) only (and ONLY) sets count to 1! And besides that
-									 * causes every other evil in the world. :O
-									 *
-									 * P.S. The reason for that may be in linked list, or in AK_insert_row()
-									 * You'll have to check every piece of AKDB code to find cause!
-									 * I have found out that additional line is added when k == 25.
-									 * There may be problem in linked lists or in AK_insert_row function
-									 * or somewhere else. Who knows.
-									 *
-									 * If I didn't handle that last row (which has one attribute of size 0),
-									 * test would not pass!
-									 *
-									 * Good luck, fellow programmer!
-									 */
-									memcpy(needed_values[l].data, &inttemp, sizeof(int));
-									needed_values[l].data[sizeof (int) ] = '\0';
-									AK_Insert_New_Element(agg_head[l].type, needed_values[l].data, new_table, agg_head[l].att_name, rowroot_table.row_root);
-									break;
-
-								case AGG_TASK_AVG:
-									//no break is intentional
-								case AGG_TASK_MAX:
-									//no break is intentional
-								case AGG_TASK_MIN:
-									//no break is intentional
-								case AGG_TASK_SUM:
-									//no break is intentional
-								case AGG_TASK_GROUP:
-									//no break is intentional
-								case AGG_TASK_AVG_SUM:
-									//no break is intentional
-								default:
-									AK_Insert_New_Element(agg_head[l].type, needed_values[l].data, new_table, agg_head[l].att_name, rowroot_table.row_root);
-							}
-
-						}
-                        //FILE  -  fix this!
-						AK_insert_row(rowroot_table.row_root);
-
-					} else {
-						mem_block = AK_get_block(sresult.aiBlocks[0]);
-
-						for (l = 0; l < num_attr; l++) {
-							for (m = 0; m < num_aggregations; m++) {
-								if (strcmp(needed_values[m].att_name, temp->header[l].att_name) == 0) {
-									switch (needed_values[m].agg_task) {
-										case AGG_TASK_COUNT:
-											//no break is intentional
-										case AGG_TASK_AVG_COUNT:
-											inttemp = *((int *) (mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address)) + 1;
-											memcpy(&mem_block->block->data[mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address], &inttemp, sizeof (int));
-											break;
-
-										case AGG_TASK_SUM:
-											//no break is intentional
-										case AGG_TASK_AVG_SUM:
-											switch (agg_head[m].type) {
-												case TYPE_INT:
-													inttemp = *((int*) needed_values[m].data) + *((int *) (mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address));
-													memcpy(mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address, &inttemp, sizeof (int));
-													break;
-
-												case TYPE_FLOAT:
-													floattemp = *((float*) needed_values[m].data) + *((float *) (mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address));
-													memcpy(mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address, &floattemp, sizeof (float));
-													break;
-
-												case TYPE_NUMBER:
-													doubletemp = *((double*) needed_values[m].data) + *((double *) (mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address));
-													memcpy(mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address, &doubletemp, sizeof (double));
-													break;
-											}
-											break;
-
-										case AGG_TASK_MAX:
-											switch (agg_head[m].type) {
-												case TYPE_INT:
-													inttemp = *((int *) (mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address));
-													if (*((int*) needed_values[m].data) > inttemp) {
-														inttemp = *((int*) needed_values[m].data);
-														memcpy(mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address, &inttemp, sizeof (int));
-													}
-													break;
-
-												case TYPE_FLOAT:
-													floattemp = *((float *) (mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address));
-													if (*((float*) needed_values[m].data) > floattemp) {
-														floattemp = *((float*) needed_values[m].data);
-														memcpy(mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address, &floattemp, sizeof (float));
-													}
-													break;
-
-												case TYPE_NUMBER:
-													doubletemp = *((double *) (mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address));
-													if (*((double*) needed_values[m].data) > doubletemp) {
-														doubletemp = *((double*) needed_values[m].data);
-														memcpy(mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address, &doubletemp, sizeof (double));
-													}
-													break;
-											}
-											break;
-
-										case AGG_TASK_MIN:
-											switch (agg_head[m].type) {
-												case TYPE_INT:
-													inttemp = *((int *) (mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address));
-													if (*((int*) needed_values[m].data) < inttemp) {
-														inttemp = *((int*) needed_values[m].data);
-														memcpy(mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address, &inttemp, sizeof (int));
-													}
-													break;
-
-												case TYPE_FLOAT:
-													floattemp = *((float *) (mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address));
-													if (*((float*) needed_values[m].data) < floattemp) {
-														floattemp = *((float*) needed_values[m].data);
-														memcpy(mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address, &floattemp, sizeof (float));
-													}
-													break;
-
-												case TYPE_NUMBER:
-													doubletemp = *((double *) (mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address));
-													if (*((double*) needed_values[m].data) < doubletemp) {
-														doubletemp = *((double*) needed_values[m].data);
-														memcpy(mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address, &doubletemp, sizeof (double));
-													}
-													break;
-											}
-											break;
-
-										case AGG_TASK_AVG:
-											inttemp = floattemp = -1;
-											for (o = 0; o < num_aggregations; o++) {
-												sprintf(agg_h_name, "_cAvg(%s)", needed_values[m].att_name);
-
-												if (strcmp(agg_h_name, mem_block->block->header[o].att_name) == 0) {
-													inttemp = *((int*) (mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + o].address));
-												}
-												sprintf(agg_h_name, "_sAvg(%s)", needed_values[m].att_name);
-
-												if (strcmp(agg_h_name, mem_block->block->header[o].att_name) == 0) {
-													floattemp = *((float*) (mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + o].address));
-												}
-
-												if (inttemp != -1 && doubletemp != -1)
-													break;
-											}
-											floattemp = floattemp / (float) inttemp;
-											memcpy(mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address, &floattemp, sizeof (float));
-											break;
-
-										case AGG_TASK_GROUP:
-											break;
-									}
-								}
-							}
-						}
-						AK_deallocate_search_result(sresult);
-						
-						AK_DeleteAll_L3(&rowroot_table);
-
-						for (l = 0; l<num_aggregations;l++) {
-							if (needed_values[l].agg_task == AGG_TASK_GROUP)
-							   inttemp = 1;
-							else
-								inttemp = 0;
-							AK_Insert_New_Element_For_Update(agg_head[l].type, needed_values[l].data, new_table, agg_head[l].att_name, rowroot_table.row_root, inttemp);
-						}
-
-						//AK_update_delete_row_from_block(mem_block->block, row_root, 0);
-                        AK_mem_block_modify(mem_block, BLOCK_DIRTY);
-					}
-				}
-            }
-        }
-        i++;
-    }
-
-    //if there is no grouping, we only need to insert one row into the table and we can insert it straight into the destination table
-    if(agg_group_number == 0)
-	{
-
-    	AK_header agg_head_final[MAX_ATTRIBUTES];
-    	j = 0;
-
-    	for (i = 0; i < num_aggregations; i++) {
-			if (agg_head[i].att_name[0] != '_') {
-				agg_head_final[j] = agg_head[i];
-				j++;
-			}
-		}
-
-    	startAddress = AK_initialize_new_segment(agg_table, SEGMENT_TYPE_TABLE, agg_head_final);
-
-		if (startAddress != EXIT_ERROR)
-			printf("\nTABLE %s CREATED!\n", agg_table);
-
-    	
-	AK_DeleteAll_L3(&rowroot_table);
-
-		for (l = 0; l < num_aggregations; l++) 
-		{
-
-			switch (needed_values[l].agg_task) {
-
-				case AGG_TASK_AVG_SUM:
-					floattemp = *((float *)needed_values[l].data);
-					break;
-
-				case AGG_TASK_AVG_COUNT:
-					inttemp = *((int *)needed_values[l].data);
-					break;
-
-				case AGG_TASK_AVG:
-					floattemp = floattemp/inttemp;
-					memcpy(needed_values[l].data, &floattemp, sizeof(float));
-					needed_values[l].data[sizeof(float)] = '\0';
-					//no break is intentional
-				case AGG_TASK_COUNT:
-					//no break is intentional
-				case AGG_TASK_MAX:
-					//no break is intentional
-				case AGG_TASK_MIN:
-					//no break is intentional
-				case AGG_TASK_SUM:
-					//no break is intentional
-				default:
-					AK_Insert_New_Element(agg_head[l].type, needed_values[l].data, agg_table, agg_head[l].att_name, rowroot_table.row_root);
-					break;
-			}
-		}
-		AK_insert_row(rowroot_table.row_root);
-    }
-    else
-	{
-
-	
-	projection_att_struct projection_att_table = {.projection_att = (struct list_node*) AK_malloc(sizeof(struct list_node))};
-	
-	AK_Init_L3(&projection_att_table);
-
-
-
-	for (i = 0; i < num_aggregations; i++) 
-		{
-			if (agg_head[i].att_name[0] != '_') 
-			{
-				AK_InsertAtEnd_L3(TYPE_ATTRIBS, agg_head[i].att_name, strlen(agg_head[i].att_name), projection_att_table.projection_att);
-
-			}
-		}
-
-		AK_projection(new_table, agg_table, projection_att_table.projection_att,NULL);
-
-		
-		AK_DeleteAll_L3(&projection_att_table);
-		AK_free(projection_att_table.projection_att);
+    if (rows == EXIT_ERROR) {
+        printf("AK_aggregation: ERROR. Can not aggregate table %s into %s.\n", source_table, agg_table);
+        AK_EPI;
+        return EXIT_ERROR;
     }
-	AK_free(addresses);
-		
-
-        //TODO replace this segment with AK_drop_table() once when it's done
-	addresses = (table_addresses*) AK_get_table_addresses(new_table);
-	i = 0;
-	while (addresses->address_from[i] != 0) 
-	{
-		AK_delete_extent(addresses->address_from[i], addresses->address_to[i]);
-		i++;
-	}
-	for (i = 0; i < num_aggregations; i++)
-		AK_free(agg_head_ptr[i]);
-    AK_free(needed_values);
-    AK_free(rowroot_table.row_root);
-    AK_free(temp);
-	AK_free(addresses);
+    printf("\nTABLE %s CREATED!\n", agg_table);
+    AK_dbg_messg(MIDDLE, REL_OP, "AK_aggregation: %d groups written to %s\n", rows, agg_table);
     AK_EPI;
     return EXIT_SUCCESS;
 }
@@ -950,5 +435,102 @@ TestResult AK_aggregation_test() {
     	printf("\nTEST FAILED! Number of errors: %d\n", num_errors);
     }
 
+
+    /* Grouping employee by department through the iterator, then with room for one group */
+    int successful = num_errors == 0, failed = num_errors != 0, groups, rows, sum, maximum_year, count;
+    float minimum_weight;
+    AK_operator *plan;
+    AK_operator_info info;
+    AK_agg_input input;
+    AK_header *header;
+
+    AK_agg_input_init(&input);
+    header = AK_get_header("employee");
+    for (i = 0; i < AK_num_attr("employee"); i++) {
+        if (strcmp(header[i].att_name, "id_department") == 0)
+            AK_agg_input_add(header[i], AGG_TASK_GROUP, &input);
+        else if (strcmp(header[i].att_name, "id_prof") == 0)
+            AK_agg_input_add(header[i], AGG_TASK_COUNT, &input);
+    }
+    AK_free(header);
+    groups = 0;
+    for (k = 0; k < 2; k++) {
+        plan = AK_aggregation_operator(AK_scan_operator("employee"), &input);
+        sum = rows = 0;
+        if (k == 1)
+            AK_operator_set_memory(plan, 1);
+        if (plan != NULL && AK_operator_open(plan) == EXIT_SUCCESS) {
+            AK_operator_describe(plan, &info);
+            j = AK_iterator_attr_index(plan->header, plan->num_attr, "Cnt(id_prof)");
+            while (AK_operator_next(plan) == AK_ITERATOR_ROW) {
+                sum += (int)AK_iterator_number(plan->row, j);
+                rows++;
+            }
+            AK_operator_close(plan);
+        }
+        AK_operator_free(plan);
+        if (k == 0) {
+            groups = rows;
+            continue;
+        }
+        printf("Partitioned aggregation of employee: %d groups in %d partitions, %d rows, expected %d groups\n", rows, info.partitions, sum, groups);
+        if (rows > 0 && rows == groups && sum == AK_get_num_records("employee") && info.partitions == AK_AGGREGATION_PARTITIONS)
+            successful++;
+        else
+            failed++;
+    }
+
+    /* Aggregates without grouping over 80 copies of student are computed in batches */
+    AK_agg_input_init(&input);
+    header = AK_get_header("student");
+    for (i = 0; i < AK_num_attr("student"); i++) {
+        if (strcmp(header[i].att_name, "year") == 0) {
+            AK_agg_input_add(header[i], AGG_TASK_SUM, &input);
+            AK_agg_input_add(header[i], AGG_TASK_MAX, &input);
+            AK_agg_input_add(header[i], AGG_TASK_COUNT, &input);
+        }
+        else if (strcmp(header[i].att_name, "weight") == 0)
+            AK_agg_input_add(header[i], AGG_TASK_MIN, &input);
+    }
+    AK_free(header);
+    sum = count = maximum_year = 0;
+    minimum_weight = 0;
+    plan = AK_scan_operator("student");
+    if (AK_operator_open(plan) == EXIT_SUCCESS) {
+        i = AK_iterator_attr_index(plan->header, plan->num_attr, "year");
+        j = AK_iterator_attr_index(plan->header, plan->num_attr, "weight");
+        while (AK_operator_next(plan) == AK_ITERATOR_ROW) {
+            if (count == 0 || AK_iterator_number(plan->row, j) < minimum_weight)
+                minimum_weight = AK_iterator_number(plan->row, j);
+            if (count == 0 || AK_iterator_number(plan->row, i) > maximum_year)
+                maximum_year = AK_iterator_number(plan->row, i);
+            sum += 80 * (int)AK_iterator_number(plan->row, i);
+            count += 80;
+        }
+        AK_operator_close(plan);
+    }
+    AK_operator_free(plan);
+    plan = AK_scan_operator("student");
+    for (i = 1; i < 80; i++)
+        plan = AK_set_operator(plan, AK_scan_operator("student"), AK_SET_UNION, 1);
+    plan = AK_aggregation_operator(plan, &input);
+    k = 0;
+    if (plan != NULL && AK_operator_open(plan) == EXIT_SUCCESS) {
+        AK_operator_describe(plan, &info);
+        k = info.batched && AK_operator_next(plan) == AK_ITERATOR_ROW
+            && (int)AK_iterator_number(plan->row, AK_iterator_attr_index(plan->header, plan->num_attr, "Sum(year)")) == sum
+            && (int)AK_iterator_number(plan->row, AK_iterator_attr_index(plan->header, plan->num_attr, "Max(year)")) == maximum_year
+            && (int)AK_iterator_number(plan->row, AK_iterator_attr_index(plan->header, plan->num_attr, "Cnt(year)")) == count
+            && (float)AK_iterator_number(plan->row, AK_iterator_attr_index(plan->header, plan->num_attr, "Min(weight)")) == minimum_weight;
+        AK_operator_close(plan);
+    }
+    AK_operator_free(plan);
+    printf("Batched aggregation of 80 copies of student: sum of years %d, %d rows, %s\n", sum, count, k ? "as expected" : "not as expected");
+    if (k && count > 0)
+        successful++;
+    else
+        failed++;
+
     AK_EPI;
+    return TEST_result(successful, failed);
 }
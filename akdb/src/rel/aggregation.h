@@ -155,13 +155,11 @@ int AK_agg_input_add_to_beginning(AK_header header, int agg_task, AK_agg_input *
 void AK_agg_input_fix(AK_agg_input *input);
 
 /**
-   @author Dejan Frankovic
-   @brief Function that aggregates a given table by given attributes. Firstly, AGG_TASK_AVG_COUNT and
-          AGG_TASK_AVG_SUM are put on the beginning of the input object. Then for loop iterates through
-          input tasks and assignes the type of aggregation operation according to aggregation operation.
-	  New table has to be created. For loop goes through given table. GROUP operation is executed separately
-	  from other operations. Addresses of records are put in needed_values array and
-	  results are put in new table.
+   @author Dejan Frankovic, updated by agent (hash aggregation)
+   @brief Function that aggregates a given table by given attributes. The source table is read once by an
+          aggregation node (see AK_aggregation_operator), which keeps the groups in a hash table and updates their
+          accumulators in place; groups that do not fit into memory are aggregated from hash partitions. The result
+          is written into the new table once at the end, in order of the first row of every group.
    @param input input object with list of atributes by which we aggregate and types of aggregations
    @param source_table - table name for the source table
    @param agg_table  table name for aggregated table
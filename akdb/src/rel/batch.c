@@ -0,0 +1,712 @@
+/**
+@file batch.c Provides vectorized evaluation of numeric predicates and aggregates. Values of a batch of rows are kept in
+arrays per attribute; comparisons with constants produce masks and selection vectors, and aggregates run over whole
+arrays. The kernels use AVX2 or SSE4.1 when the processor has them and scalar code otherwise.
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#include "batch.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define AK_BATCH_X86
+#include <immintrin.h>
+#endif
+
+/// instruction set of the kernels, EXIT_ERROR until it is detected
+static int AK_batch_instructions = EXIT_ERROR;
+
+/**
+ * @author agent
+ * @brief  Function that detects the best instruction set of the processor
+ * @return AK_BATCH_SCALAR, AK_BATCH_SSE4 or AK_BATCH_AVX2
+ */
+static int AK_batch_detect()
+{
+#ifdef AK_BATCH_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return AK_BATCH_AVX2;
+    if (__builtin_cpu_supports("sse4.1"))
+        return AK_BATCH_SSE4;
+#endif
+    return AK_BATCH_SCALAR;
+}
+
+int AK_batch_level()
+{
+    AK_PRO;
+    if (AK_batch_instructions == EXIT_ERROR)
+    {
+        AK_batch_instructions = AK_batch_detect();
+        AK_dbg_messg(LOW, REL_OP, "AK_batch_level: using instruction set %d\n", AK_batch_instructions);
+    }
+    AK_EPI;
+    return AK_batch_instructions;
+}
+
+int AK_batch_set_level(int level)
+{
+    int supported;
+    AK_PRO;
+    supported = AK_batch_detect();
+    AK_batch_instructions = level < AK_BATCH_SCALAR ? AK_BATCH_SCALAR : level > supported ? supported : level;
+    AK_EPI;
+    return AK_batch_instructions;
+}
+
+/**
+ * @author agent
+ * @brief  Function that derives the result of a comparison from the lanes that are smaller and greater than the
+ * constant. Equal values and values without order (NaN) are neither, as in AK_expression_check.
+ * @param comparison AK_EXPR_EQ, AK_EXPR_NE, ...
+ * @param lt bit of every lane smaller than the constant
+ * @param gt bit of every lane greater than the constant
+ * @param lanes bits of all lanes
+ * @return bit of every lane satisfying the comparison
+ */
+static inline unsigned int AK_batch_bits(int comparison, unsigned int lt, unsigned int gt, unsigned int lanes)
+{
+    switch (comparison)
+    {
+    case AK_EXPR_EQ:
+        return ~(lt | gt) & lanes;
+    case AK_EXPR_NE:
+        return lt | gt;
+    case AK_EXPR_LT:
+        return lt;
+    case AK_EXPR_GT:
+        return gt;
+    case AK_EXPR_LE:
+        return ~gt & lanes;
+    default:
+        return ~lt & lanes;
+    }
+}
+
+/**
+ * @author agent
+ * @brief  Function that writes the bits of some lanes into a mask
+ * @param mask mask
+ * @param bits bit of every lane
+ * @param lanes number of lanes
+ */
+static inline void AK_batch_store(unsigned char *mask, unsigned int bits, int lanes)
+{
+    int i;
+    for (i = 0; i < lanes; i++)
+        mask[i] = (bits >> i) & 1;
+}
+
+/**
+ * @author agent
+ * @brief  Function that compares integers with a constant in scalar code
+ * @param values integers
+ * @param count number of integers
+ * @param comparison AK_EXPR_EQ, AK_EXPR_NE, ...
+ * @param constant constant
+ * @param mask receives the results
+ */
+static void AK_batch_compare_int(int *values, int count, int comparison, int constant, unsigned char *mask)
+{
+    int i;
+    for (i = 0; i < count; i++)
+        mask[i] = AK_batch_bits(comparison, values[i] < constant, values[i] > constant, 1);
+}
+
+/**
+ * @author agent
+ * @brief  Function that compares floats with a constant in scalar code
+ * @param values floats
+ * @param count number of floats
+ * @param comparison AK_EXPR_EQ, AK_EXPR_NE, ...
+ * @param constant constant
+ * @param mask receives the results
+ */
+static void AK_batch_compare_float(float *values, int count, int comparison, float constant, unsigned char *mask)
+{
+    int i;
+    for (i = 0; i < count; i++)
+        mask[i] = AK_batch_bits(comparison, values[i] < constant, values[i] > constant, 1);
+}
+
+/**
+ * @author agent
+ * @brief  Function that compares doubles with a constant in scalar code
+ * @param values doubles
+ * @param count number of doubles
+ * @param comparison AK_EXPR_EQ, AK_EXPR_NE, ...
+ * @param constant constant
+ * @param mask receives the results
+ */
+static void AK_batch_compare_number(double *values, int count, int comparison, double constant, unsigned char *mask)
+{
+    int i;
+    for (i = 0; i < count; i++)
+        mask[i] = AK_batch_bits(comparison, values[i] < constant, values[i] > constant, 1);
+}
+
+#ifdef AK_BATCH_X86
+
+/**
+ * @author agent
+ * @brief  Function that compares integers with a constant, eight at a time with AVX2
+ * @see AK_batch_compare_int
+ */
+__attribute__((target("avx2")))
+static void AK_batch_compare_int_avx2(int *values, int count, int comparison, int constant, unsigned char *mask)
+{
+    __m256i c = _mm256_set1_epi32(constant), v;
+    int i;
+    for (i = 0; i + 8 <= count; i += 8)
+    {
+        v = _mm256_loadu_si256((__m256i *)(values + i));
+        AK_batch_store(mask + i, AK_batch_bits(comparison,
+                       _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(c, v))),
+                       _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(v, c))), 0xff), 8);
+    }
+    AK_batch_compare_int(values + i, count - i, comparison, constant, mask + i);
+}
+
+/**
+ * @author agent
+ * @brief  Function that compares floats with a constant, eight at a time with AVX2
+ * @see AK_batch_compare_float
+ */
+__attribute__((target("avx2")))
+static void AK_batch_compare_float_avx2(float *values, int count, int comparison, float constant, unsigned char *mask)
+{
+    __m256 c = _mm256_set1_ps(constant), v;
+    int i;
+    for (i = 0; i + 8 <= count; i += 8)
+    {
+        v = _mm256_loadu_ps(values + i);
+        AK_batch_store(mask + i, AK_batch_bits(comparison,
+                       _mm256_movemask_ps(_mm256_cmp_ps(v, c, _CMP_LT_OQ)),
+                       _mm256_movemask_ps(_mm256_cmp_ps(v, c, _CMP_GT_OQ)), 0xff), 8);
+    }
+    AK_batch_compare_float(values + i, count - i, comparison, constant, mask + i);
+}
+
+/**
+ * @author agent
+ * @brief  Function that compares doubles with a constant, four at a time with AVX2
+ * @see AK_batch_compare_number
+ */
+__attribute__((target("avx2")))
+static void AK_batch_compare_number_avx2(double *values, int count, int comparison, double constant, unsigned char *mask)
+{
+    __m256d c = _mm256_set1_pd(constant), v;
+    int i;
+    for (i = 0; i + 4 <= count; i += 4)
+    {
+        v = _mm256_loadu_pd(values + i);
+        AK_batch_store(mask + i, AK_batch_bits(comparison,
+                       _mm256_movemask_pd(_mm256_cmp_pd(v, c, _CMP_LT_OQ)),
+                       _mm256_movemask_pd(_mm256_cmp_pd(v, c, _CMP_GT_OQ)), 0xf), 4);
+    }
+    AK_batch_compare_number(values + i, count - i, comparison, constant, mask + i);
+}
+
+/**
+ * @author agent
+ * @brief  Function that compares integers with a constant, four at a time with SSE4.1
+ * @see AK_batch_compare_int
+ */
+__attribute__((target("sse4.1")))
+static void AK_batch_compare_int_sse4(int *values, int count, int comparison, int constant, unsigned char *mask)
+{
+    __m128i c = _mm_set1_epi32(constant), v;
+    int i;
+    for (i = 0; i + 4 <= count; i += 4)
+    {
+        v = _mm_loadu_si128((__m128i *)(values + i));
+        AK_batch_store(mask + i, AK_batch_bits(comparison,
+                       _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(c, v))),
+                       _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(v, c))), 0xf), 4);
+    }
+    AK_batch_compare_int(values + i, count - i, comparison, constant, mask + i);
+}
+
+/**
+ * @author agent
+ * @brief  Function that compares floats with a constant, four at a time with SSE4.1
+ * @see AK_batch_compare_float
+ */
+__attribute__((target("sse4.1")))
+static void AK_batch_compare_float_sse4(float *values, int count, int comparison, float constant, unsigned char *mask)
+{
+    __m128 c = _mm_set1_ps(constant), v;
+    int i;
+    for (i = 0; i + 4 <= count; i += 4)
+    {
+        v = _mm_loadu_ps(values + i);
+        AK_batch_store(mask + i, AK_batch_bits(comparison, _mm_movemask_ps(_mm_cmplt_ps(v, c)), _mm_movemask_ps(_mm_cmpgt_ps(v, c)), 0xf), 4);
+    }
+    AK_batch_compare_float(values + i, count - i, comparison, constant, mask + i);
+}
+
+/**
+ * @author agent
+ * @brief  Function that compares doubles with a constant, two at a time with SSE4.1
+ * @see AK_batch_compare_number
+ */
+__attribute__((target("sse4.1")))
+static void AK_batch_compare_number_sse4(double *values, int count, int comparison, double constant, unsigned char *mask)
+{
+    __m128d c = _mm_set1_pd(constant), v;
+    int i;
+    for (i = 0; i + 2 <= count; i += 2)
+    {
+        v = _mm_loadu_pd(values + i);
+        AK_batch_store(mask + i, AK_batch_bits(comparison, _mm_movemask_pd(_mm_cmplt_pd(v, c)), _mm_movemask_pd(_mm_cmpgt_pd(v, c)), 0x3), 2);
+    }
+    AK_batch_compare_number(values + i, count - i, comparison, constant, mask + i);
+}
+
+/**
+ * @author agent
+ * @brief  Function that loads four numbers for AVX2, consecutive ones or the ones at four positions of a selection
+ * @param values numbers
+ * @param selection positions, NULL for consecutive numbers
+ * @param i index of the first number or position
+ * @return the numbers
+ */
+__attribute__((target("avx2")))
+static inline __m256d AK_batch_load_avx2(double *values, int *selection, int i)
+{
+    if (selection == NULL)
+        return _mm256_loadu_pd(values + i);
+    return _mm256_i32gather_pd(values, _mm_loadu_si128((__m128i *)(selection + i)), sizeof(double));
+}
+
+/**
+ * @author agent
+ * @brief  Function that loads two numbers for SSE4.1, consecutive ones or the ones at two positions of a selection
+ * @param values numbers
+ * @param selection positions, NULL for consecutive numbers
+ * @param i index of the first number or position
+ * @return the numbers
+ */
+__attribute__((target("sse4.1")))
+static inline __m128d AK_batch_load_sse4(double *values, int *selection, int i)
+{
+    if (selection == NULL)
+        return _mm_loadu_pd(values + i);
+    return _mm_set_pd(values[selection[i + 1]], values[selection[i]]);
+}
+
+/**
+ * @author agent
+ * @brief  Function that sums numbers with AVX2, see AK_batch_sum
+ * @param values numbers
+ * @param selection positions, NULL for consecutive numbers
+ * @param count number of positions
+ * @param i receives the number of summed positions, the rest is left to scalar code
+ * @return sum
+ */
+__attribute__((target("avx2")))
+static double AK_batch_sum_avx2(double *values, int *selection, int count, int *i)
+{
+    __m256d sum = _mm256_setzero_pd();
+    double lanes[4];
+    for (*i = 0; *i + 4 <= count; *i += 4)
+        sum = _mm256_add_pd(sum, AK_batch_load_avx2(values, selection, *i));
+    _mm256_storeu_pd(lanes, sum);
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+}
+
+/**
+ * @author agent
+ * @brief  Function that sums numbers with SSE4.1, see AK_batch_sum_avx2
+ */
+__attribute__((target("sse4.1")))
+static double AK_batch_sum_sse4(double *values, int *selection, int count, int *i)
+{
+    __m128d sum = _mm_setzero_pd();
+    double lanes[2];
+    for (*i = 0; *i + 2 <= count; *i += 2)
+        sum = _mm_add_pd(sum, AK_batch_load_sse4(values, selection, *i));
+    _mm_storeu_pd(lanes, sum);
+    return lanes[0] + lanes[1];
+}
+
+/**
+ * @author agent
+ * @brief  Function that finds the smallest or largest of some numbers with AVX2. A NaN never replaces a number, as
+ * in the scalar code.
+ * @param values numbers
+ * @param selection positions, NULL for consecutive numbers
+ * @param count number of positions, at least four
+ * @param largest 1 for the maximum, 0 for the minimum
+ * @param i receives the number of compared positions, the rest is left to scalar code
+ * @return minimum or maximum
+ */
+__attribute__((target("avx2")))
+static double AK_batch_extreme_avx2(double *values, int *selection, int count, int largest, int *i)
+{
+    __m256d extreme = AK_batch_load_avx2(values, selection, 0), v;
+    double lanes[4], result;
+    int j;
+    for (*i = 4; *i + 4 <= count; *i += 4)
+    {
+        v = AK_batch_load_avx2(values, selection, *i);
+        extreme = largest ? _mm256_max_pd(v, extreme) : _mm256_min_pd(v, extreme);
+    }
+    _mm256_storeu_pd(lanes, extreme);
+    result = lanes[0];
+    for (j = 1; j < 4; j++)
+        if (largest ? lanes[j] > result : lanes[j] < result)
+            result = lanes[j];
+    return result;
+}
+
+/**
+ * @author agent
+ * @brief  Function that finds the smallest or largest of some numbers with SSE4.1, see AK_batch_extreme_avx2
+ */
+__attribute__((target("sse4.1")))
+static double AK_batch_extreme_sse4(double *values, int *selection, int count, int largest, int *i)
+{
+    __m128d extreme = AK_batch_load_sse4(values, selection, 0), v;
+    double lanes[2];
+    for (*i = 2; *i + 2 <= count; *i += 2)
+    {
+        v = AK_batch_load_sse4(values, selection, *i);
+        extreme = largest ? _mm_max_pd(v, extreme) : _mm_min_pd(v, extreme);
+    }
+    _mm_storeu_pd(lanes, extreme);
+    return (largest ? lanes[1] > lanes[0] : lanes[1] < lanes[0]) ? lanes[1] : lanes[0];
+}
+
+#endif
+
+void AK_batch_compare(AK_batch_column *column, int count, int comparison, char *constant, unsigned char *mask)
+{
+    int level, int_value;
+    float float_value;
+    double double_value;
+    AK_PRO;
+    level = AK_batch_level();
+    switch (column->type)
+    {
+    case TYPE_INT:
+        memcpy(&int_value, constant, sizeof(int));
+#ifdef AK_BATCH_X86
+        if (level == AK_BATCH_AVX2)
+            AK_batch_compare_int_avx2(column->value.integer, count, comparison, int_value, mask);
+        else if (level == AK_BATCH_SSE4)
+            AK_batch_compare_int_sse4(column->value.integer, count, comparison, int_value, mask);
+        else
+#endif
+            AK_batch_compare_int(column->value.integer, count, comparison, int_value, mask);
+        break;
+    case TYPE_FLOAT:
+        memcpy(&float_value, constant, sizeof(float));
+#ifdef AK_BATCH_X86
+        if (level == AK_BATCH_AVX2)
+            AK_batch_compare_float_avx2(column->value.real, count, comparison, float_value, mask);
+        else if (level == AK_BATCH_SSE4)
+            AK_batch_compare_float_sse4(column->value.real, count, comparison, float_value, mask);
+        else
+#endif
+            AK_batch_compare_float(column->value.real, count, comparison, float_value, mask);
+        break;
+    default:
+        memcpy(&double_value, constant, sizeof(double));
+#ifdef AK_BATCH_X86
+        if (level == AK_BATCH_AVX2)
+            AK_batch_compare_number_avx2(column->value.number, count, comparison, double_value, mask);
+        else if (level == AK_BATCH_SSE4)
+            AK_batch_compare_number_sse4(column->value.number, count, comparison, double_value, mask);
+        else
+#endif
+            AK_batch_compare_number(column->value.number, count, comparison, double_value, mask);
+    }
+    AK_EPI;
+}
+
+int AK_batch_select(unsigned char *mask, int count, int *selection)
+{
+    int i, selected = 0;
+    AK_PRO;
+    //branch free: every position is written, only selected ones advance
+    for (i = 0; i < count; i++)
+    {
+        selection[selected] = i;
+        selected += mask[i];
+    }
+    AK_EPI;
+    return selected;
+}
+
+int AK_batch_count(unsigned char *mask, int count)
+{
+    int i, selected = 0;
+    AK_PRO;
+    for (i = 0; i < count; i++)
+        selected += mask[i];
+    AK_EPI;
+    return selected;
+}
+
+double AK_batch_sum(double *values, int *selection, int count)
+{
+    double sum = 0;
+    int i = 0, level;
+    AK_PRO;
+    level = AK_batch_level();
+#ifdef AK_BATCH_X86
+    if (level == AK_BATCH_AVX2)
+        sum = AK_batch_sum_avx2(values, selection, count, &i);
+    else if (level == AK_BATCH_SSE4)
+        sum = AK_batch_sum_sse4(values, selection, count, &i);
+#endif
+    for (; i < count; i++)
+        sum += values[selection != NULL ? selection[i] : i];
+    AK_EPI;
+    return sum;
+}
+
+/**
+ * @author agent
+ * @brief  Function that finds the smallest or largest of some numbers with the kernel of the current instruction set
+ * @param values numbers
+ * @param selection positions, NULL for consecutive numbers
+ * @param count number of positions, at least one
+ * @param largest 1 for the maximum, 0 for the minimum
+ * @return minimum or maximum
+ */
+static double AK_batch_extreme(double *values, int *selection, int count, int largest)
+{
+    double extreme, value;
+    int i = 1, level;
+    AK_PRO;
+    level = AK_batch_level();
+    extreme = values[selection != NULL ? selection[0] : 0];
+#ifdef AK_BATCH_X86
+    if (level == AK_BATCH_AVX2 && count >= 4)
+        extreme = AK_batch_extreme_avx2(values, selection, count, largest, &i);
+    else if (level >= AK_BATCH_SSE4 && count >= 2)
+        extreme = AK_batch_extreme_sse4(values, selection, count, largest, &i);
+#endif
+    for (; i < count; i++)
+    {
+        value = values[selection != NULL ? selection[i] : i];
+        if (largest ? value > extreme : value < extreme)
+            extreme = value;
+    }
+    AK_EPI;
+    return extreme;
+}
+
+double AK_batch_min(double *values, int *selection, int count)
+{
+    double min;
+    AK_PRO;
+    min = AK_batch_extreme(values, selection, count, 0);
+    AK_EPI;
+    return min;
+}
+
+double AK_batch_max(double *values, int *selection, int count)
+{
+    double max;
+    AK_PRO;
+    max = AK_batch_extreme(values, selection, count, 1);
+    AK_EPI;
+    return max;
+}
+
+AK_batch *AK_batch_new(AK_expression_program *program)
+{
+    AK_expression_instruction *value[AK_EXPRESSION_STACK_SIZE], *column, *constant;
+    AK_batch *batch;
+    int type[MAX_ATTRIBUTES];
+    int values = 0, pc, i, operands;
+    AK_PRO;
+    if (program == NULL || program->interpreted || program->length == 0)
+    {
+        AK_EPI;
+        return NULL;
+    }
+
+    //every comparison must be between a numeric attribute and a constant of the same type
+    memset(type, 0, sizeof(type));
+    for (pc = 0; pc < program->length; pc++)
+    {
+        switch (program->code[pc].opcode)
+        {
+        case AK_EXPR_COLUMN:
+        case AK_EXPR_CONSTANT:
+            value[values++] = &program->code[pc];
+            continue;
+        case AK_EXPR_COMPARE:
+        case AK_EXPR_BETWEEN:
+            operands = program->code[pc].opcode == AK_EXPR_COMPARE ? 2 : 3;
+            values -= operands;
+            column = value[values]->opcode == AK_EXPR_COLUMN || operands == 3 ? value[values] : value[values + 1];
+            for (i = 0; i < operands; i++)
+            {
+                constant = value[values + i];
+                if (constant != column && (constant->opcode != AK_EXPR_CONSTANT || constant->value.type != program->code[pc].type))
+                    break;
+            }
+            if (i == operands && column->opcode == AK_EXPR_COLUMN && column->column < MAX_ATTRIBUTES
+                && (program->code[pc].type == TYPE_INT || program->code[pc].type == TYPE_FLOAT || program->code[pc].type == TYPE_NUMBER)
+                && (type[column->column] == 0 || type[column->column] == program->code[pc].type))
+            {
+                type[column->column] = program->code[pc].type;
+                continue;
+            }
+            break;
+        case AK_EXPR_AND:
+        case AK_EXPR_OR:
+            continue;
+        }
+        AK_EPI;
+        return NULL;
+    }
+
+    batch = (AK_batch *)AK_calloc(1, sizeof(AK_batch));
+    for (i = 0; batch != NULL && i < MAX_ATTRIBUTES; i++)
+    {
+        if (type[i] == 0)
+            continue;
+        if ((batch->column[i] = (AK_batch_column *)AK_calloc(1, sizeof(AK_batch_column))) == NULL)
+        {
+            AK_batch_free(batch);
+            batch = NULL;
+            break;
+        }
+        batch->column[i]->type = type[i];
+    }
+    AK_EPI;
+    return batch;
+}
+
+void AK_batch_add(AK_batch *batch, AK_row *row)
+{
+    AK_batch_column *column;
+    int i, n = batch->count++, size;
+    char *value;
+    AK_PRO;
+    batch->row[n] = row;
+    batch->slow[n] = 0;
+    for (i = 0; i < MAX_ATTRIBUTES; i++)
+    {
+        if ((column = batch->column[i]) == NULL)
+            continue;
+        value = AK_row_get(row, i, NULL, &size);
+        if (value == NULL || row->type[i] != column->type || size < (column->type == TYPE_INT ? sizeof(int) : column->type == TYPE_FLOAT ? sizeof(float) : sizeof(double)))
+        {
+            //nulls and values of other types are left to the row by row evaluation
+            batch->slow[n] = 1;
+            column->value.number[n] = 0;
+            continue;
+        }
+        switch (column->type)
+        {
+        case TYPE_INT:
+            memcpy(&column->value.integer[n], value, sizeof(int));
+            break;
+        case TYPE_FLOAT:
+            memcpy(&column->value.real[n], value, sizeof(float));
+            break;
+        default:
+            memcpy(&column->value.number[n], value, sizeof(double));
+        }
+    }
+    AK_EPI;
+}
+
+int AK_batch_filter(AK_batch *batch, AK_expression_program *program)
+{
+    AK_expression_instruction *value[AK_EXPRESSION_STACK_SIZE], *instruction, *column, *constant;
+    int values = 0, results = 0, pc, i, comparison, selected;
+    unsigned char *mask, *other;
+    AK_PRO;
+    for (pc = 0; pc < program->length; pc++)
+    {
+        instruction = &program->code[pc];
+        switch (instruction->opcode)
+        {
+        case AK_EXPR_COLUMN:
+        case AK_EXPR_CONSTANT:
+            value[values++] = instruction;
+            break;
+        case AK_EXPR_COMPARE:
+            values -= 2;
+            comparison = instruction->comparison;
+            column = value[values];
+            constant = value[values + 1];
+            if (column->opcode != AK_EXPR_COLUMN)
+            {
+                //constant < attribute is attribute > constant
+                column = value[values + 1];
+                constant = value[values];
+                if (comparison == AK_EXPR_LT || comparison == AK_EXPR_GT)
+                    comparison = AK_EXPR_LT + AK_EXPR_GT - comparison;
+                else if (comparison == AK_EXPR_LE || comparison == AK_EXPR_GE)
+                    comparison = AK_EXPR_LE + AK_EXPR_GE - comparison;
+            }
+            AK_batch_compare(batch->column[column->column], batch->count, comparison, constant->value.data, batch->mask[results++]);
+            break;
+        case AK_EXPR_BETWEEN:
+            values -= 3;
+            mask = batch->mask[results++];
+            other = batch->mask[results];
+            AK_batch_compare(batch->column[value[values]->column], batch->count, AK_EXPR_GE, value[values + 1]->value.data, mask);
+            AK_batch_compare(batch->column[value[values]->column], batch->count, AK_EXPR_LE, value[values + 2]->value.data, other);
+            for (i = 0; i < batch->count; i++)
+                mask[i] &= other[i];
+            break;
+        case AK_EXPR_AND:
+        case AK_EXPR_OR:
+            results--;
+            mask = batch->mask[results - 1];
+            other = batch->mask[results];
+            if (instruction->opcode == AK_EXPR_AND)
+                for (i = 0; i < batch->count; i++)
+                    mask[i] &= other[i];
+            else
+                for (i = 0; i < batch->count; i++)
+                    mask[i] |= other[i];
+            break;
+        }
+    }
+
+    mask = batch->mask[0];
+    for (i = 0; i < batch->count; i++)
+        if (batch->slow[i])
+            mask[i] = AK_expression_run(program, batch->row[i], NULL);
+    selected = AK_batch_select(mask, batch->count, batch->selection);
+    AK_EPI;
+    return selected;
+}
+
+void AK_batch_free(AK_batch *batch)
+{
+    int i;
+    AK_PRO;
+    if (batch != NULL)
+    {
+        for (i = 0; i < MAX_ATTRIBUTES; i++)
+            AK_free(batch->column[i]);
+        AK_free(batch);
+    }
+    AK_EPI;
+}
@@ -0,0 +1,184 @@
+/**
+@file batch.h Header file that provides data structures and functions for vectorized (batch) evaluation of numeric
+predicates and aggregates
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#ifndef BATCH
+#define BATCH
+
+#include "../auxi/test.h"
+#include "../auxi/constants.h"
+#include "../auxi/mempro.h"
+#include "../file/fileio.h"
+#include "expression_check.h"
+
+/// number of rows of a batch
+#define AK_BATCH_SIZE 1024
+
+/// instruction sets of the kernels
+#define AK_BATCH_SCALAR 0
+#define AK_BATCH_SSE4 1
+#define AK_BATCH_AVX2 2
+
+/**
+ * @author agent
+ * @struct AK_batch_column
+ * @brief Structure that defines the values of one attribute of a batch, stored as an array of their type
+ */
+typedef struct {
+    /// TYPE_INT, TYPE_FLOAT or TYPE_NUMBER
+    int type;
+    /// values of the rows of the batch
+    union {
+        int integer[AK_BATCH_SIZE];
+        float real[AK_BATCH_SIZE];
+        double number[AK_BATCH_SIZE];
+    } value;
+} AK_batch_column;
+
+/**
+ * @author agent
+ * @struct AK_batch
+ * @brief Structure that defines a batch of rows for a compiled expression. The attributes the expression compares
+ * are copied into columns when a row is added, so the comparisons run over arrays instead of rows.
+ */
+typedef struct {
+    /// number of rows in the batch
+    int count;
+    /// rows of the batch, not owned
+    AK_row *row[AK_BATCH_SIZE];
+    /// column of every attribute the expression compares, NULL for other attributes
+    AK_batch_column *column[MAX_ATTRIBUTES];
+    /// 1 for rows with a value that is missing or not of the column type, they are evaluated row by row
+    unsigned char slow[AK_BATCH_SIZE];
+    /// results of the comparisons, one per entry of the result stack of the expression and one for BETWEEN
+    unsigned char mask[AK_EXPRESSION_STACK_SIZE + 1][AK_BATCH_SIZE];
+    /// positions of the rows satisfying the expression
+    int selection[AK_BATCH_SIZE];
+} AK_batch;
+
+/**
+ * @author agent
+ * @brief  Function that returns the instruction set used by the kernels. It is detected on the first call: AVX2 or
+ * SSE4.1 if the processor has it, scalar code otherwise.
+ * @return AK_BATCH_SCALAR, AK_BATCH_SSE4 or AK_BATCH_AVX2
+ */
+int AK_batch_level();
+
+/**
+ * @author agent
+ * @brief  Function that sets the instruction set used by the kernels, it is lowered to what the processor has
+ * @param level AK_BATCH_SCALAR, AK_BATCH_SSE4 or AK_BATCH_AVX2
+ * @return instruction set that is used
+ */
+int AK_batch_set_level(int level);
+
+/**
+ * @author agent
+ * @brief  Function that compares the values of a column with a constant
+ * @param column column
+ * @param count number of values
+ * @param comparison AK_EXPR_EQ, AK_EXPR_NE, ...
+ * @param constant bytes of a constant of the column type
+ * @param mask receives 1 for every value satisfying the comparison and 0 for the others
+ */
+void AK_batch_compare(AK_batch_column *column, int count, int comparison, char *constant, unsigned char *mask);
+
+/**
+ * @author agent
+ * @brief  Function that turns a mask into a selection vector
+ * @param mask 1 for selected positions
+ * @param count number of positions
+ * @param selection receives the selected positions in ascending order
+ * @return number of selected positions
+ */
+int AK_batch_select(unsigned char *mask, int count, int *selection);
+
+/**
+ * @author agent
+ * @brief  Function that counts the selected positions of a mask
+ * @param mask 1 for selected positions
+ * @param count number of positions
+ * @return number of selected positions
+ */
+int AK_batch_count(unsigned char *mask, int count);
+
+/**
+ * @author agent
+ * @brief  Function that sums numbers
+ * @param values numbers
+ * @param selection positions to sum, NULL for all positions below count
+ * @param count number of positions
+ * @return sum, 0 for no positions
+ */
+double AK_batch_sum(double *values, int *selection, int count);
+
+/**
+ * @author agent
+ * @brief  Function that returns the smallest of some numbers
+ * @param values numbers
+ * @param selection positions to compare, NULL for all positions below count
+ * @param count number of positions, at least one
+ * @return minimum
+ */
+double AK_batch_min(double *values, int *selection, int count);
+
+/**
+ * @author agent
+ * @brief  Function that returns the largest of some numbers
+ * @param values numbers
+ * @param selection positions to compare, NULL for all positions below count
+ * @param count number of positions, at least one
+ * @return maximum
+ */
+double AK_batch_max(double *values, int *selection, int count);
+
+/**
+ * @author agent
+ * @brief  Function that creates a batch for a compiled expression. Only expressions of comparisons between a numeric
+ * attribute and a constant of the same type, BETWEEN of such values, AND and OR are evaluated in batches.
+ * @param program compiled expression
+ * @return new batch, NULL if the expression can not be evaluated in batches or on error
+ */
+AK_batch *AK_batch_new(AK_expression_program *program);
+
+/**
+ * @author agent
+ * @brief  Function that adds a row to a batch and copies the values it compares into the columns
+ * @param batch batch with less than AK_BATCH_SIZE rows
+ * @param row row, it must not change until the batch is filtered
+ */
+void AK_batch_add(AK_batch *batch, AK_row *row);
+
+/**
+ * @author agent
+ * @brief  Function that evaluates a compiled expression on all rows of a batch
+ * @param batch batch created for the expression
+ * @param program compiled expression
+ * @return number of rows satisfying the expression, their positions are in batch->selection
+ */
+int AK_batch_filter(AK_batch *batch, AK_expression_program *program);
+
+/**
+ * @author agent
+ * @brief  Function that frees a batch
+ * @param batch batch
+ */
+void AK_batch_free(AK_batch *batch);
+
+#endif
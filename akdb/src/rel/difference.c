@@ -20,211 +20,55 @@
 #include "difference.h"
 
 /**
- * @author Dino Laktašić edited by Elena Kržina
- * @brief  Auxiliary function for printing data depending on the variable that enters the switch statement. Original code written 
- * by Dino Lakšatić, section separated and edited by Elena Kržina for code transparency
- * @param data accessed for later comparison
- * @param address address of block for accessing data
- * @param size size of block for accessing data
- * @param type type of block for accessing data
- * @param tbl_temp_block temporary block from which data is accessed
- * @return returns void
- */
-void AK_difference_Print_By_Type(char* data, int address, int size, int type, AK_mem_block *tbl_temp_block){
-	AK_PRO;
-	int temp_int = 0;	
-	float temp_float = 0;
-
-	switch (type) {
-		case TYPE_INT: 
-			memcpy(&temp_int, &(tbl_temp_block->block->data[address]), size);
-			sprintf(data, "%d", temp_int);
-			break;
-		case TYPE_FLOAT:
-			memcpy(&temp_float, &(tbl_temp_block->block->data[address]), size);
-			sprintf(data, "%f", temp_float);
-			break;
-		case TYPE_VARCHAR:
-		default:
-			memset(data, '\0', MAX_VARCHAR_LENGTH);
-			memcpy(data, &(tbl_temp_block->block->data[address]), size);
-	}
-	AK_EPI;
-}
-
-/**
- * @author Dino Laktašić; updated by Elena Kržina
- * @brief  Function that produces a difference of two tables. Table addresses are gotten by providing names of the tables.
- *         Specifically start addresses are taken from them. They are used to allocate blocks for them. It is checked whether
-           the tables have same table schemas. If not, it returns EXIT_ERROR. New segment for result of difference operation is
-           initialized. Function compares every block in extent of the first table with every block in extent of second table. If there 
-	   is a difference between their rows, they are put in dstTable.
+ * @author Dino Laktašić; updated by Elena Kržina, updated by agent (hash set operators)
+ * @brief  Function that writes the difference of two tables into a new table. The rows are produced by a set operation
+ *         node (see AK_set_operator) over scans of the two tables.
  * @param srcTable1 name of the first table
  * @param srcTable2 name of the second table
  * @param dstTable name of the new table
+ * @param all 1 to keep duplicate rows, 0 to write every row once
  * @return if success returns EXIT_SUCCESS, else returns EXIT_ERROR
  */
-int AK_difference(char *srcTable1, char *srcTable2, char *dstTable) {
+static int AK_difference_tables(char *srcTable1, char *srcTable2, char *dstTable, int all) {
+    AK_operator *plan;
+    int rows;
     AK_PRO;
+    plan = AK_set_operator(AK_scan_operator(srcTable1), AK_scan_operator(srcTable2), AK_SET_DIFFERENCE, all);
+    if (plan == NULL) {
+        AK_dbg_messg(LOW, REL_OP, "\nAK_difference: Table/s doesn't exist!");
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    rows = AK_iterator_materialize(plan, dstTable);
+    AK_operator_free(plan);
+    if (rows == EXIT_ERROR) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    AK_dbg_messg(LOW, REL_OP, "DIFFERENCE_TEST_SUCCESS\n\n");
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
 
-    table_addresses *src_addr1 = (table_addresses*) AK_get_table_addresses(srcTable1);
-    table_addresses *src_addr2 = (table_addresses*) AK_get_table_addresses(srcTable2);
-
-    int startAddress1 = src_addr1->address_from[0];
-    int startAddress2 = src_addr2->address_from[0];
-
-    if ((startAddress1 != 0) && (startAddress2 != 0)) {
-	
-		//for greater speed, integers are put into CPU registers
-        register int i, j, k, l, m, n, o;
-        i = j = k = l = 0;
-
-        AK_mem_block *tbl1_temp_block = (AK_mem_block *) AK_get_block(startAddress1);
-        AK_mem_block *tbl2_temp_block = (AK_mem_block *) AK_get_block(startAddress2);
-		
-		int num_att = AK_check_tables_scheme(tbl1_temp_block, tbl2_temp_block, "Difference");
-		
-		if (num_att == EXIT_ERROR) {
-
-			AK_free(src_addr1);
-       		AK_free(src_addr2);
-			AK_free(tbl1_temp_block);
-			AK_free(tbl2_temp_block);
-			
-			AK_EPI;
-			return EXIT_ERROR;
-		}
-
-		//initializing variables for table difference
-		int address, type, size;
-		int different, num_rows, summ;
-		different = num_rows = summ = 0;
-		
-        char data1[MAX_VARCHAR_LENGTH];
-		char data2[MAX_VARCHAR_LENGTH];
-
-		//initializing new segment
-		AK_header *header = (AK_header *) AK_malloc(num_att * sizeof (AK_header));
-		memcpy(header, tbl1_temp_block->block->header, num_att * sizeof (AK_header));
-		AK_initialize_new_segment(dstTable, SEGMENT_TYPE_TABLE, header);
-		AK_free(header);
-
-		struct list_node * row_root = (struct list_node *) AK_malloc(sizeof(struct list_node));
-
-		//START ADDRESS: for each bit in the address
-		for (i = 0; src_addr1->address_from[i] != 0; i++) {
-		
-			startAddress1 = src_addr1->address_from[i];
-			//BLOCK: for each block in table1 extent until reaching the end of the allocated address of the table
-			for (j = startAddress1; j < src_addr1->address_to[i]; j++) {
-			
-				//read block from first table
-				tbl1_temp_block = (AK_mem_block *) AK_get_block(j); 
-
-				//if there is data in the block, continue
-				if (tbl1_temp_block->block->AK_free_space != 0) {
-							
-					//TABLE2: for each extent in table2
-						for (k = 0; k < (src_addr2->address_from[k] != 0); k++) {
-							startAddress2 = src_addr2->address_from[k];
-							
-							if (startAddress2 != 0) {
-								//BLOCK: for each block in table2 extent
-								for (l = startAddress2; l < src_addr2->address_to[k]; l++) {
-									tbl2_temp_block = (AK_mem_block *) AK_get_block(l);
-
-									//if there is data in the block, continue
-									if (tbl2_temp_block->block->AK_free_space != 0) {
-									
-									//check whether the next block is free for m and n
-									//TUPLE_DICTS: for each tuple_dict in the block
-										for (m = 0; m < DATA_BLOCK_SIZE; m += num_att) {
-											if (tbl1_temp_block->block->tuple_dict[m + 1].type == FREE_INT)
-												break;
-											
-										for (n = 0; n < DATA_BLOCK_SIZE; n += num_att) {
-											if (tbl2_temp_block->block->tuple_dict[n + 1].type == FREE_INT)
-													break;
-											
-											//for each element in row
-											for (o = 0; o < num_att; o++) {
-												address = tbl1_temp_block->block->tuple_dict[m + o].address;
-												size = tbl1_temp_block->block->tuple_dict[m + o].size;
-												type = tbl1_temp_block->block->tuple_dict[m + o].type;
-												AK_difference_Print_By_Type(data1,address, size, type, tbl1_temp_block);
-
-												address = tbl2_temp_block->block->tuple_dict[n + o].address;
-												size = tbl2_temp_block->block->tuple_dict[n + o].size;
-												type = tbl2_temp_block->block->tuple_dict[n + o].type;
-												AK_difference_Print_By_Type(data2,address, size, type, tbl2_temp_block);
-
-												//if they are the same
-												if(strcmp(data1,data2)==0){
-													different++;
-												}
-												if(different==(num_att-1)) 
-													summ=1;
-											}
-											
-											//if same rows are found don't keep searching
-												if(summ==1)
-													break;
-										}
-										//if there is a difference between tuple_dicts
-										if (summ == 0) {
-											AK_DeleteAll_L3(&row_root);	
-											for (o = 0; o < num_att; o++) {
-												address = tbl1_temp_block->block->tuple_dict[m + o].address;
-												size = tbl1_temp_block->block->tuple_dict[m + o].size;
-												type = tbl1_temp_block->block->tuple_dict[m + o].type;
-														
-												memset(data1, '\0', MAX_VARCHAR_LENGTH);
-												memcpy(data1, tbl1_temp_block->block->data + address, size);
-
-												AK_Insert_New_Element(type, data1, dstTable, tbl1_temp_block->block->header[o].att_name, row_root);
-											}
+int AK_difference(char *srcTable1, char *srcTable2, char *dstTable) {
+    int result;
+    AK_PRO;
+    result = AK_difference_tables(srcTable1, srcTable2, dstTable, 0);
+    AK_EPI;
+    return result;
+}
 
-											AK_insert_row(row_root);
-										}
-										num_rows = different = summ = 0;
-									}
-								}
-							}
-						} else break;
-					}
-				}
-			}
-		}
-			
-		AK_free(src_addr1);
-		AK_free(src_addr2);
-		
-		AK_free(tbl1_temp_block);
-		AK_free(tbl2_temp_block);
-		
-		AK_DeleteAll_L3(&row_root);	
-		AK_free(row_root);
-		AK_dbg_messg(LOW, REL_OP, "DIFFERENCE_TEST_SUCCESS\n\n");
-		AK_EPI;
-		
-		return EXIT_SUCCESS;
-	} 
-	
-	else {
-		AK_dbg_messg(LOW, REL_OP, "\nAK_difference: Table/s doesn't exist!");
-		
-        AK_free(src_addr1);
-        AK_free(src_addr2);
-		
-		AK_EPI;
-		return EXIT_ERROR;
-	}
-	AK_EPI;
+int AK_difference_all(char *srcTable1, char *srcTable2, char *dstTable) {
+    int result;
+    AK_PRO;
+    result = AK_difference_tables(srcTable1, srcTable2, dstTable, 1);
+    AK_EPI;
+    return result;
 }
 
 /**
  * @brief  Function for difference operator testing
- * @author Dino Laktašić
+ * @author Dino Laktašić, updated by agent
  */
 TestResult AK_op_difference_test() {
     AK_PRO;
@@ -256,6 +100,26 @@ TestResult AK_op_difference_test() {
 		printf("\n\nTest failed!\n");
 		failed++;
     }
+
+    //rows left after removing a table once from the union of itself with itself, which has every row twice
+    if (AK_union_all(tblName1, tblName1, "difference_test_twice") == EXIT_SUCCESS
+        && AK_difference("difference_test_twice", tblName1, "difference_test_distinct") == EXIT_SUCCESS
+        && AK_difference_all("difference_test_twice", tblName1, "difference_test_all") == EXIT_SUCCESS
+        && AK_get_num_records("difference_test_distinct") == 0
+        && AK_get_num_records("difference_test_all") == AK_get_num_records(tblName1))
+        success++;
+    else
+        failed++;
+    printf("EXCEPT: %d rows, EXCEPT ALL: %d rows, %s has %d rows\n", AK_get_num_records("difference_test_distinct"),
+           AK_get_num_records("difference_test_all"), tblName1, AK_get_num_records(tblName1));
+    AK_delete_segment("difference_test_twice", SEGMENT_TYPE_TABLE);
+    AK_delete_segment("difference_test_distinct", SEGMENT_TYPE_TABLE);
+    AK_delete_segment("difference_test_all", SEGMENT_TYPE_TABLE);
+
+    //bags of years, in memory and partitioned
+    TestResult sets = AK_set_operation_test(AK_SET_DIFFERENCE);
+    success += sets.testSucceded;
+    failed += sets.testFailed;
 	
     AK_EPI;
     return TEST_result(success,failed);
@@ -24,20 +24,31 @@
 #include "../file/fileio.h"
 #include "../auxi/mempro.h"
 #include "../sql/drop.h"
+#include "iterator.h"
+#include "union.h"
 
 /**
- * @author Dino Laktašić
- * @brief  Function that produces a difference of the two tables. Table addresses are get through names of tables.
- *         Specially start addresses are taken from them. They are used to allocate blocks for them. It is checked whether
-           the tables have same table schemas. If not, it returns EXIT_ERROR. New segment for result of difference operation is
-           initialized. Function compares every block in extent of the first table with every block in extent of second table. If there 
-	   is a difference between their rows, they are put in dstTable.
+ * @author Dino Laktašić, updated by agent (hash set operators)
+ * @brief  Function that produces a difference of the two tables (EXCEPT). The tables must have the same number and
+ *         types of attributes, otherwise EXIT_ERROR is returned. The rows of the second table are read into a hash
+ *         table, rows of the first table that are not in it are written once.
  * @param srcTable1 name of the first table
  * @param srcTable2 name of the second table
  * @param dstTable name of the new table
  * @return if success returns EXIT_SUCCESS, else returns EXIT_ERROR
  */
 int AK_difference(char *srcTable1, char *srcTable2, char *dstTable);
+
+/**
+ * @author agent
+ * @brief  Function that produces a difference of the two tables keeping duplicates (EXCEPT ALL): a row that is m times
+ *         in the first and n times in the second table is written max(m - n, 0) times
+ * @param srcTable1 name of the first table
+ * @param srcTable2 name of the second table
+ * @param dstTable name of the new table
+ * @return if success returns EXIT_SUCCESS, else returns EXIT_ERROR
+ */
+int AK_difference_all(char *srcTable1, char *srcTable2, char *dstTable);
 TestResult AK_op_difference_test();
 
 #endif
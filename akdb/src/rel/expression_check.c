@@ -345,16 +345,49 @@ int AK_check_regex_operator_expression(const char * value, const char * expressi
     return isMatched;
 }
 /**
- * @author Matija Šestak, updated by Dino Laktašić,Nikola Miljancic, abstracted by Tomislav Mikulček, updated by Fran Turković
+ * @author agent
+ * @brief  Function that appends an element to a list of the expression evaluation. The element is taken from the
+           scratch arena, so the list is released with the arena instead of element by element.
+ * @param scratch arena of the evaluation
+ * @param type data type
+ * @param data data to copy
+ * @param size number of bytes to copy
+ * @param L root of the list
+ * @result new element, NULL if the arena is out of memory
+ */
+static struct list_node *AK_expression_push(AK_arena *scratch, int type, const char *data, int size, struct list_node *L) {
+    struct list_node *last = L;
+    struct list_node *new_elem = (struct list_node *) AK_arena_alloc(scratch, sizeof (struct list_node));
+
+    if (new_elem == NULL)
+        return NULL;
+    if (size > MAX_VARCHAR_LENGTH)
+        size = MAX_VARCHAR_LENGTH;
+    new_elem->type = type;
+    new_elem->size = size;
+    memcpy(new_elem->data, data, size);
+    if (size < MAX_VARCHAR_LENGTH)
+        new_elem->data[size] = '\0';
+    new_elem->next = NULL;
+    while (last->next != NULL)
+        last = last->next;
+    last->next = new_elem;
+    return new_elem;
+}
+
+/**
+ * @author Matija Šestak, updated by Dino Laktašić,Nikola Miljancic, abstracted by Tomislav Mikulček, updated by Fran Turković, updated by agent (compact rows, arena, ALL operators)
  * @brief  Function that evaluates whether one record (row) satisfies logical expression. It goes through
            given row. If it comes to logical operator, it evaluates by itself. For arithmetic operators
-           function AK_check_arithmetic_statement() is called.
+           function AK_check_arithmetic_statement() is called. Attribute values are taken from the row list or,
+           if it is given, from the compact row. The value and result stacks live in the scratch arena.
  * @param row_root beginning of the row that is to be evaluated
+ * @param compact compact row that is to be evaluated, NULL if row_root is used
  * @param *expr list with the logical expression in postfix notation
+ * @param scratch arena for the evaluation, released by the caller
  * @result 0 if row does not satisfy, 1 if row satisfies expression
  */
-//int AK_check_if_row_satisfies_expression(AK_list_elem row_root, AK_list *expr) {
-int AK_check_if_row_satisfies_expression(struct list_node *row_root, struct list_node *expr) {
+static int AK_check_row_expression(struct list_node *row_root, AK_row *compact, struct list_node *expr, AK_arena *scratch) {
 
     AK_PRO;
     if (expr == 0) {
@@ -367,11 +400,14 @@ int AK_check_if_row_satisfies_expression(struct list_node *row_root, struct list
     char result = 0;
    
     //list of values
-    struct list_node *temp = (struct list_node *) AK_malloc(sizeof (struct list_node));
-    AK_Init_L3(&temp);
+    struct list_node *temp = (struct list_node *) AK_arena_alloc(scratch, sizeof (struct list_node));
     //list of results (0,1)
-    struct list_node *temp_result = (struct list_node *) AK_malloc(sizeof (struct list_node));
-    AK_Init_L3(&temp_result);
+    struct list_node *temp_result = (struct list_node *) AK_arena_alloc(scratch, sizeof (struct list_node));
+    if (temp == NULL || temp_result == NULL) {
+        AK_EPI;
+        return 0;
+    }
+    temp->next = temp_result->next = NULL;
 
     struct list_node *el = AK_First_L2(expr);
     struct list_node *row;
@@ -381,7 +417,21 @@ int AK_check_if_row_satisfies_expression(struct list_node *row_root, struct list
     int i = 0;
     while (el) {
 
-        if (el->type == TYPE_ATTRIBS) {
+        if (el->type == TYPE_ATTRIBS && compact != NULL) {
+
+            int type, size, index = AK_row_attr_index(compact, el->data);
+            char *value = AK_row_get(compact, index, &type, &size);
+
+            if (value == NULL) {
+            	AK_dbg_messg(MIDDLE, REL_OP, "Expression ckeck was not able to find column: %s\n", el->data);
+				AK_EPI;
+                return 0;
+            }
+            memset(data, 0, MAX_VARCHAR_LENGTH);
+            memcpy(data, value, size < MAX_VARCHAR_LENGTH ? size : MAX_VARCHAR_LENGTH - 1);
+            AK_expression_push(scratch, type, data, sizeof(data), temp);
+
+        } else if (el->type == TYPE_ATTRIBS) {
 
             found = 0;
             row = row_root;
@@ -412,7 +462,7 @@ int AK_check_if_row_satisfies_expression(struct list_node *row_root, struct list
                 memcpy(data, &row->data, sizeof(row->data));
 
      
-				AK_InsertAtEnd_L3(type, data, sizeof(row->data), temp);
+				AK_expression_push(scratch, type, data, sizeof(row->data), temp);
             }
 
         } else if (el->type == TYPE_OPERATOR) {
@@ -426,11 +476,11 @@ int AK_check_if_row_satisfies_expression(struct list_node *row_root, struct list
             if (strcmp(el->data, "=") == 0) {
                 if (memcmp(a->data, b->data, sizeof(a->type)) == 0){
                 	
-					AK_InsertAtEnd_L3(TYPE_INT, &true, sizeof (char), temp_result);
+					AK_expression_push(scratch, TYPE_INT, &true, sizeof (char), temp_result);
 
 				}else{
 
-					AK_InsertAtEnd_L3(TYPE_INT, &false, sizeof (int), temp_result);
+					AK_expression_push(scratch, TYPE_INT, &false, sizeof (int), temp_result);
 
 				}
 
@@ -439,12 +489,12 @@ int AK_check_if_row_satisfies_expression(struct list_node *row_root, struct list
 
                 if (memcmp(a->data, b->data, a->size) != 0){
 
-					AK_InsertAtEnd_L3(TYPE_INT, &true, sizeof (int), temp_result);
+					AK_expression_push(scratch, TYPE_INT, &true, sizeof (int), temp_result);
 
 				}
                 else{
 
-					AK_InsertAtEnd_L3(TYPE_INT, &false, sizeof (int), temp_result);
+					AK_expression_push(scratch, TYPE_INT, &false, sizeof (int), temp_result);
 
 				}
 
@@ -458,11 +508,11 @@ int AK_check_if_row_satisfies_expression(struct list_node *row_root, struct list
 
                 if (val_a || val_b){
 
-					AK_InsertAtEnd_L3(TYPE_INT, &true, sizeof (int), temp_result);
+					AK_expression_push(scratch, TYPE_INT, &true, sizeof (int), temp_result);
 				}
                 else{
 
-					AK_InsertAtEnd_L3(TYPE_INT, &false, sizeof (int), temp_result);
+					AK_expression_push(scratch, TYPE_INT, &false, sizeof (int), temp_result);
 
 				}
 
@@ -475,9 +525,9 @@ int AK_check_if_row_satisfies_expression(struct list_node *row_root, struct list
 
                 if (val_a && val_b){
                 	
-					AK_InsertAtEnd_L3(TYPE_INT, &true, sizeof (int), temp_result);
+					AK_expression_push(scratch, TYPE_INT, &true, sizeof (int), temp_result);
 				}else{
-					AK_InsertAtEnd_L3(TYPE_INT, &false, sizeof (int), temp_result);
+					AK_expression_push(scratch, TYPE_INT, &false, sizeof (int), temp_result);
 				}
 
             } else if(strcmp(el->data,"BETWEEN")==0){
@@ -490,10 +540,10 @@ int AK_check_if_row_satisfies_expression(struct list_node *row_root, struct list
                 
 
 	            if(rs && rs2){
-	            	AK_InsertAtEnd_L3(TYPE_INT, &true, sizeof (int), temp_result);
+	            	AK_expression_push(scratch, TYPE_INT, &true, sizeof (int), temp_result);
 	            }
 	            else{
-	            	AK_InsertAtEnd_L3(TYPE_INT, &false, sizeof (int), temp_result);
+	            	AK_expression_push(scratch, TYPE_INT, &false, sizeof (int), temp_result);
 	            }
 			}else if(strcmp(el->data,"IN")==0 || strcmp(el->data,"=ANY")==0 || strcmp(el->data,"= ANY")==0){
             	
@@ -520,10 +570,10 @@ int AK_check_if_row_satisfies_expression(struct list_node *row_root, struct list
 				free(tofree);
 
 	            if(rs){
-	            	AK_InsertAtEnd_L3(TYPE_INT, &true, sizeof (int), temp_result);
+	            	AK_expression_push(scratch, TYPE_INT, &true, sizeof (int), temp_result);
 	            }
 	            else{
-	            	AK_InsertAtEnd_L3(TYPE_INT, &false, sizeof (int), temp_result);
+	            	AK_expression_push(scratch, TYPE_INT, &false, sizeof (int), temp_result);
 	            }
 			}else if(strcmp(el->data,">ANY")==0 || strcmp(el->data,"> ANY")==0){
             	
@@ -551,10 +601,10 @@ int AK_check_if_row_satisfies_expression(struct list_node *row_root, struct list
 				free(tofree);
 
 	            if(rs){
-	            	AK_InsertAtEnd_L3(TYPE_INT, &true, sizeof (int), temp_result);
+	            	AK_expression_push(scratch, TYPE_INT, &true, sizeof (int), temp_result);
 	            }
 	            else{
-	            	AK_InsertAtEnd_L3(TYPE_INT, &false, sizeof (int), temp_result);
+	            	AK_expression_push(scratch, TYPE_INT, &false, sizeof (int), temp_result);
 	            }
 			}else if(strcmp(el->data,"<ANY")==0 || strcmp(el->data,"< ANY")==0){
             	
@@ -582,10 +632,10 @@ int AK_check_if_row_satisfies_expression(struct list_node *row_root, struct list
 				free(tofree);
 
 	            if(rs){
-	            	AK_InsertAtEnd_L3(TYPE_INT, &true, sizeof (int), temp_result);
+	            	AK_expression_push(scratch, TYPE_INT, &true, sizeof (int), temp_result);
 	            }
 	            else{
-	            	AK_InsertAtEnd_L3(TYPE_INT, &false, sizeof (int), temp_result);
+	            	AK_expression_push(scratch, TYPE_INT, &false, sizeof (int), temp_result);
 	            }
 			}else if(strcmp(el->data,"<=ANY")==0 || strcmp(el->data,"<= ANY")==0){
             	
@@ -613,10 +663,10 @@ int AK_check_if_row_satisfies_expression(struct list_node *row_root, struct list
 				free(tofree);
 
 	            if(rs){
-	            	AK_InsertAtEnd_L3(TYPE_INT, &true, sizeof (int), temp_result);
+	            	AK_expression_push(scratch, TYPE_INT, &true, sizeof (int), temp_result);
 	            }
 	            else{
-	            	AK_InsertAtEnd_L3(TYPE_INT, &false, sizeof (int), temp_result);
+	            	AK_expression_push(scratch, TYPE_INT, &false, sizeof (int), temp_result);
 	            }
 			}else if(strcmp(el->data,">=ANY")==0 || strcmp(el->data,">= ANY")==0){
             	
@@ -644,10 +694,10 @@ int AK_check_if_row_satisfies_expression(struct list_node *row_root, struct list
 				free(tofree);
 
 	            if(rs){
-	            	AK_InsertAtEnd_L3(TYPE_INT, &true, sizeof (int), temp_result);
+	            	AK_expression_push(scratch, TYPE_INT, &true, sizeof (int), temp_result);
 	            }
 	            else{
-	            	AK_InsertAtEnd_L3(TYPE_INT, &false, sizeof (int), temp_result);
+	            	AK_expression_push(scratch, TYPE_INT, &false, sizeof (int), temp_result);
 	            }
 			}else if(strcmp(el->data,"!=ANY")==0 || strcmp(el->data,"!= ANY")==0 || strcmp(el->data,"<>ANY")==0 || strcmp(el->data,"<> ANY")==0){
             	
@@ -675,10 +725,10 @@ int AK_check_if_row_satisfies_expression(struct list_node *row_root, struct list
 				free(tofree);
 
 	            if(rs){
-	            	AK_InsertAtEnd_L3(TYPE_INT, &true, sizeof (int), temp_result);
+	            	AK_expression_push(scratch, TYPE_INT, &true, sizeof (int), temp_result);
 	            }
 	            else{
-	            	AK_InsertAtEnd_L3(TYPE_INT, &false, sizeof (int), temp_result);
+	            	AK_expression_push(scratch, TYPE_INT, &false, sizeof (int), temp_result);
 	            }
 			}else if(strcmp(el->data,">ALL")==0 || strcmp(el->data,"> ALL")==0){
             	
@@ -690,14 +740,14 @@ int AK_check_if_row_satisfies_expression(struct list_node *row_root, struct list
 				while ((token = strsep(&str, ","))){
 					if(b->type==TYPE_INT){
 						int token2 = atoi(token);
-						rs = AK_check_arithmetic_statement(b, "<", a->data, (char *)&token2);
+						rs = AK_check_arithmetic_statement(b, "<=", a->data, (char *)&token2);
 					}
 					else if(b->type==TYPE_FLOAT){
 						float token2 = atof(token);
-						rs = AK_check_arithmetic_statement(b, "<", a->data, (char *)&token2);
+						rs = AK_check_arithmetic_statement(b, "<=", a->data, (char *)&token2);
 					}
 					else{
-						rs = AK_check_arithmetic_statement(b, "<", a->data, token);
+						rs = AK_check_arithmetic_statement(b, "<=", a->data, token);
 					}
 					if(rs){
 						break;
@@ -706,10 +756,10 @@ int AK_check_if_row_satisfies_expression(struct list_node *row_root, struct list
 				free(tofree);
 
 	            if(!rs){
-	            	AK_InsertAtEnd_L3(TYPE_INT, &true, sizeof (int), temp_result);
+	            	AK_expression_push(scratch, TYPE_INT, &true, sizeof (int), temp_result);
 	            }
 	            else{
-	            	AK_InsertAtEnd_L3(TYPE_INT, &false, sizeof (int), temp_result);
+	            	AK_expression_push(scratch, TYPE_INT, &false, sizeof (int), temp_result);
 	            }
 			}else if(strcmp(el->data,"<ALL")==0 || strcmp(el->data,"< ALL")==0){
             	
@@ -721,14 +771,14 @@ int AK_check_if_row_satisfies_expression(struct list_node *row_root, struct list
 				while ((token = strsep(&str, ","))){
 					if(b->type==TYPE_INT){
 						int token2 = atoi(token);
-						rs = AK_check_arithmetic_statement(b, ">", a->data, (char *)&token2);
+						rs = AK_check_arithmetic_statement(b, ">=", a->data, (char *)&token2);
 					}
 					else if(b->type==TYPE_FLOAT){
 						float token2 = atof(token);
-						rs = AK_check_arithmetic_statement(b, ">", a->data, (char *)&token2);
+						rs = AK_check_arithmetic_statement(b, ">=", a->data, (char *)&token2);
 					}
 					else{
-						rs = AK_check_arithmetic_statement(b, ">", a->data, token);
+						rs = AK_check_arithmetic_statement(b, ">=", a->data, token);
 					}
 					if(rs){
 						break;
@@ -737,10 +787,10 @@ int AK_check_if_row_satisfies_expression(struct list_node *row_root, struct list
 				free(tofree);
 
 	            if(!rs){
-	            	AK_InsertAtEnd_L3(TYPE_INT, &true, sizeof (int), temp_result);
+	            	AK_expression_push(scratch, TYPE_INT, &true, sizeof (int), temp_result);
 	            }
 	            else{
-	            	AK_InsertAtEnd_L3(TYPE_INT, &false, sizeof (int), temp_result);
+	            	AK_expression_push(scratch, TYPE_INT, &false, sizeof (int), temp_result);
 	            }
 			}else if(strcmp(el->data,">=ALL")==0 || strcmp(el->data,">= ALL")==0){
             	
@@ -752,14 +802,14 @@ int AK_check_if_row_satisfies_expression(struct list_node *row_root, struct list
 				while ((token = strsep(&str, ","))){
 					if(b->type==TYPE_INT){
 						int token2 = atoi(token);
-						rs = AK_check_arithmetic_statement(b, "<=", a->data, (char *)&token2);
+						rs = AK_check_arithmetic_statement(b, "<", a->data, (char *)&token2);
 					}
 					else if(b->type==TYPE_FLOAT){
 						float token2 = atof(token);
-						rs = AK_check_arithmetic_statement(b, "<=", a->data, (char *)&token2);
+						rs = AK_check_arithmetic_statement(b, "<", a->data, (char *)&token2);
 					}
 					else{
-						rs = AK_check_arithmetic_statement(b, "<=", a->data, token);
+						rs = AK_check_arithmetic_statement(b, "<", a->data, token);
 					}
 					if(rs){
 						break;
@@ -768,10 +818,10 @@ int AK_check_if_row_satisfies_expression(struct list_node *row_root, struct list
 				free(tofree);
 
 	            if(!rs){
-	            	AK_InsertAtEnd_L3(TYPE_INT, &true, sizeof (int), temp_result);
+	            	AK_expression_push(scratch, TYPE_INT, &true, sizeof (int), temp_result);
 	            }
 	            else{
-	            	AK_InsertAtEnd_L3(TYPE_INT, &false, sizeof (int), temp_result);
+	            	AK_expression_push(scratch, TYPE_INT, &false, sizeof (int), temp_result);
 	            }
 			}else if(strcmp(el->data,"<=ALL")==0 || strcmp(el->data,"<= ALL")==0){
             	
@@ -783,14 +833,14 @@ int AK_check_if_row_satisfies_expression(struct list_node *row_root, struct list
 				while ((token = strsep(&str, ","))){
 					if(b->type==TYPE_INT){
 						int token2 = atoi(token);
-						rs = AK_check_arithmetic_statement(b, ">=", a->data, (char *)&token2);
+						rs = AK_check_arithmetic_statement(b, ">", a->data, (char *)&token2);
 					}
 					else if(b->type==TYPE_FLOAT){
 						float token2 = atof(token);
-						rs = AK_check_arithmetic_statement(b, ">=", a->data, (char *)&token2);
+						rs = AK_check_arithmetic_statement(b, ">", a->data, (char *)&token2);
 					}
 					else{
-						rs = AK_check_arithmetic_statement(b, ">=", a->data, token);
+						rs = AK_check_arithmetic_statement(b, ">", a->data, token);
 					}
 					if(rs){
 						break;
@@ -799,10 +849,10 @@ int AK_check_if_row_satisfies_expression(struct list_node *row_root, struct list
 				free(tofree);
 
 	            if(!rs){
-	            	AK_InsertAtEnd_L3(TYPE_INT, &true, sizeof (int), temp_result);
+	            	AK_expression_push(scratch, TYPE_INT, &true, sizeof (int), temp_result);
 	            }
 	            else{
-	            	AK_InsertAtEnd_L3(TYPE_INT, &false, sizeof (int), temp_result);
+	            	AK_expression_push(scratch, TYPE_INT, &false, sizeof (int), temp_result);
 	            }
 			}else if(strcmp(el->data,"!=ALL")==0 || strcmp(el->data,"!= ALL")==0 || strcmp(el->data,"<>ALL")==0 || strcmp(el->data,"<> ALL")==0){
             	
@@ -830,10 +880,10 @@ int AK_check_if_row_satisfies_expression(struct list_node *row_root, struct list
 				free(tofree);
 
 	            if(!rs){
-	            	AK_InsertAtEnd_L3(TYPE_INT, &true, sizeof (int), temp_result);
+	            	AK_expression_push(scratch, TYPE_INT, &true, sizeof (int), temp_result);
 	            }
 	            else{
-	            	AK_InsertAtEnd_L3(TYPE_INT, &false, sizeof (int), temp_result);
+	            	AK_expression_push(scratch, TYPE_INT, &false, sizeof (int), temp_result);
 	            }
 			}else if(strcmp(el->data,"=ALL")==0 || strcmp(el->data,"= ALL")==0){
             	
@@ -861,10 +911,10 @@ int AK_check_if_row_satisfies_expression(struct list_node *row_root, struct list
 				free(tofree);
 
 	            if(!rs){
-	            	AK_InsertAtEnd_L3(TYPE_INT, &true, sizeof (int), temp_result);
+	            	AK_expression_push(scratch, TYPE_INT, &true, sizeof (int), temp_result);
 	            }
 	            else{
-	            	AK_InsertAtEnd_L3(TYPE_INT, &false, sizeof (int), temp_result);
+	            	AK_expression_push(scratch, TYPE_INT, &false, sizeof (int), temp_result);
 	            }
 
             }else if(strcmp(el->data,"LIKE")==0 || strcmp(el->data,"~~")==0){
@@ -877,9 +927,9 @@ int AK_check_if_row_satisfies_expression(struct list_node *row_root, struct list
             		rs = AK_check_regex_expression(a->data,b->data,1,1);
 
 					if(rs){
-            			AK_InsertAtEnd_L3(TYPE_INT, &true, sizeof (int), temp_result);
+            			AK_expression_push(scratch, TYPE_INT, &true, sizeof (int), temp_result);
 					} else{
-						AK_InsertAtEnd_L3(TYPE_INT, &false, sizeof (int), temp_result);
+						AK_expression_push(scratch, TYPE_INT, &false, sizeof (int), temp_result);
 					}
             	}else{
             		printf("Could not compile LIKE expression, check your sintax.\n");
@@ -895,12 +945,12 @@ int AK_check_if_row_satisfies_expression(struct list_node *row_root, struct list
             		rs = AK_check_regex_expression(a->data,b->data,1,1);
 
 					if(!rs){
-            			AK_InsertAtEnd_L3(TYPE_INT, &true, sizeof (int), temp_result);
+            			AK_expression_push(scratch, TYPE_INT, &true, sizeof (int), temp_result);
 					} else{
-						AK_InsertAtEnd_L3(TYPE_INT, &false, sizeof (int), temp_result);
+						AK_expression_push(scratch, TYPE_INT, &false, sizeof (int), temp_result);
 					}
             	}else{
-            		AK_InsertAtEnd_L3(TYPE_INT, &false, sizeof (int), temp_result);
+            		AK_expression_push(scratch, TYPE_INT, &false, sizeof (int), temp_result);
             	}
 
             }else if(strcmp(el->data,"ILIKE")==0 || strcmp(el->data,"~~*")==0){
@@ -913,12 +963,12 @@ int AK_check_if_row_satisfies_expression(struct list_node *row_root, struct list
             		rs = AK_check_regex_expression(a->data,b->data,0,1);
 
 					if(rs){
-            			AK_InsertAtEnd_L3(TYPE_INT, &true, sizeof (int), temp_result);
+            			AK_expression_push(scratch, TYPE_INT, &true, sizeof (int), temp_result);
 					} else {
-						AK_InsertAtEnd_L3(TYPE_INT, &false, sizeof (int), temp_result);
+						AK_expression_push(scratch, TYPE_INT, &false, sizeof (int), temp_result);
 					}
             	}else{
-            		AK_InsertAtEnd_L3(TYPE_INT, &false, sizeof (int), temp_result);
+            		AK_expression_push(scratch, TYPE_INT, &false, sizeof (int), temp_result);
             	}
             }else if(strcmp(el->data,"NOT ILIKE")==0){
 
@@ -930,12 +980,12 @@ int AK_check_if_row_satisfies_expression(struct list_node *row_root, struct list
             		rs = AK_check_regex_expression(a->data,b->data,0,1);
 
 					if(!rs){
-            			AK_InsertAtEnd_L3(TYPE_INT, &true, sizeof (int), temp_result);
+            			AK_expression_push(scratch, TYPE_INT, &true, sizeof (int), temp_result);
 					} else {
-						AK_InsertAtEnd_L3(TYPE_INT, &false, sizeof (int), temp_result);
+						AK_expression_push(scratch, TYPE_INT, &false, sizeof (int), temp_result);
 					}
             	}else{
-            		AK_InsertAtEnd_L3(TYPE_INT, &false, sizeof (int), temp_result);
+            		AK_expression_push(scratch, TYPE_INT, &false, sizeof (int), temp_result);
             	}
             }else if(strcmp(el->data,"SIMILAR TO")==0){
             	char similar_regex[] = "([]:alpha:[!%_^|*+()!]*)";
@@ -943,9 +993,9 @@ int AK_check_if_row_satisfies_expression(struct list_node *row_root, struct list
 
             	if(AK_check_regex_operator_expression(b->data,similar_regex)){
             		rs = AK_check_regex_expression(a->data,b->data,1,1);
-            		AK_InsertAtEnd_L3(TYPE_INT, &true, sizeof (int), temp_result);
+            		AK_expression_push(scratch, TYPE_INT, &true, sizeof (int), temp_result);
             	}else{
-            		AK_InsertAtEnd_L3(TYPE_INT, &false, sizeof (int), temp_result);
+            		AK_expression_push(scratch, TYPE_INT, &false, sizeof (int), temp_result);
             	}
             	
             }else if(strcmp(el->data,"~")==0){
@@ -953,50 +1003,647 @@ int AK_check_if_row_satisfies_expression(struct list_node *row_root, struct list
             	int rs;
             	rs = AK_check_regex_expression(a->data,b->data,1,0);
 				if(rs){
-            		AK_InsertAtEnd_L3(TYPE_INT, &true, sizeof (int), temp_result);
+            		AK_expression_push(scratch, TYPE_INT, &true, sizeof (int), temp_result);
 				} else {
-					AK_InsertAtEnd_L3(TYPE_INT, &false, sizeof (int), temp_result);
+					AK_expression_push(scratch, TYPE_INT, &false, sizeof (int), temp_result);
 				}
             }else if(strcmp(el->data,"!~")==0){
             	//regex match implementation case sensitive
             	int rs;
             	rs = AK_check_regex_expression(a->data,b->data,1,0);
 				if(!rs){
-            		AK_InsertAtEnd_L3(TYPE_INT, &true, sizeof (int), temp_result);
+            		AK_expression_push(scratch, TYPE_INT, &true, sizeof (int), temp_result);
 				} else {
-					AK_InsertAtEnd_L3(TYPE_INT, &false, sizeof (int), temp_result);
+					AK_expression_push(scratch, TYPE_INT, &false, sizeof (int), temp_result);
 				}
             }else if(strcmp(el->data,"~*")==0){
             	//regex match implementation case sensitive insensitive
             	int rs;
             	rs = AK_check_regex_expression(a->data,b->data,0,0);
 				if(rs){
-            		AK_InsertAtEnd_L3(TYPE_INT, &true, sizeof (int), temp_result);
+            		AK_expression_push(scratch, TYPE_INT, &true, sizeof (int), temp_result);
 				} else {
-					AK_InsertAtEnd_L3(TYPE_INT, &false, sizeof (int), temp_result);
+					AK_expression_push(scratch, TYPE_INT, &false, sizeof (int), temp_result);
 				}
             }else{
 
             		char rs;
 
                 	rs = AK_check_arithmetic_statement(b, el->data, a->data, b->data);
-					AK_InsertAtEnd_L3(TYPE_INT, &rs, sizeof (int), temp_result);
+					AK_expression_push(scratch, TYPE_INT, &rs, sizeof (int), temp_result);
             }      
 
         } else {
-			AK_InsertAtEnd_L3(el->type, el->data, el->size, temp);
+			AK_expression_push(scratch, el->type, el->data, sizeof (el->data), temp)->size = el->size;
         }
         el = el->next;
     }
 
     memcpy(&result, ((struct list_node *) AK_End_L2(temp_result))->data, sizeof (char));
-    AK_DeleteAll_L3(&temp);
-    AK_free(temp);
-    AK_DeleteAll_L3(&temp_result);
-    AK_free(temp_result);
     AK_EPI;
     return result;
 }
+/**
+ * @author Matija Šestak, updated by agent (compact rows, arena)
+ * @brief  Function that evaluates whether one record (row) satisfies logical expression, see AK_check_row_expression
+ * @param row_root beginning of the row that is to be evaluated
+ * @param *expr list with the logical expression in postfix notation
+ * @result 0 if row does not satisfy, 1 if row satisfies expression
+ */
+int AK_check_if_row_satisfies_expression(struct list_node *row_root, struct list_node *expr) {
+    int result;
+    AK_PRO;
+    AK_arena *scratch = AK_arena_create(AK_EXPRESSION_ARENA_SIZE);
+    result = AK_check_row_expression(row_root, NULL, expr, scratch);
+    AK_arena_destroy(scratch);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @author agent
+ * @brief  Function that evaluates whether a compact row satisfies logical expression, see AK_check_row_expression
+ * @param row compact row that is to be evaluated
+ * @param *expr list with the logical expression in postfix notation
+ * @param scratch arena of the calling operator, reset by the caller between rows; NULL to use a temporary one
+ * @result 0 if row does not satisfy, 1 if row satisfies expression
+ */
+int AK_check_if_compact_row_satisfies_expression(AK_row *row, struct list_node *expr, AK_arena *scratch) {
+    int result;
+    AK_PRO;
+    if (scratch != NULL) {
+        result = AK_check_row_expression(NULL, row, expr, scratch);
+    } else {
+        scratch = AK_arena_create(AK_EXPRESSION_ARENA_SIZE);
+        result = AK_check_row_expression(NULL, row, expr, scratch);
+        AK_arena_destroy(scratch);
+    }
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @author agent
+ * @brief  Function that checks whether a data type is compared as a number
+ * @param type data type
+ * @return 1 for TYPE_INT, TYPE_FLOAT and TYPE_NUMBER, 0 otherwise
+ */
+static int AK_expression_is_numeric(int type) {
+    return type == TYPE_INT || type == TYPE_FLOAT || type == TYPE_NUMBER;
+}
+
+/**
+ * @author agent
+ * @brief  Function that chooses the type in which two operands of known types are compared
+ * @param left type of the left operand
+ * @param right type of the right operand
+ * @return the common numeric type, AK_EXPR_MIXED for different numeric types, TYPE_VARCHAR for a byte comparison
+ */
+static int AK_expression_compare_type(int left, int right) {
+    if (left == right && AK_expression_is_numeric(left))
+        return left;
+    if (AK_expression_is_numeric(left) && AK_expression_is_numeric(right))
+        return AK_EXPR_MIXED;
+    return TYPE_VARCHAR;
+}
+
+/**
+ * @author agent
+ * @brief  Function that reads a numeric value as a double
+ * @param value value of type TYPE_INT, TYPE_FLOAT or TYPE_NUMBER
+ * @return value as a double
+ */
+static double AK_expression_number(AK_expression_value *value) {
+    int i;
+    float f;
+    double d;
+
+    switch (value->type) {
+        case TYPE_INT:
+            memcpy(&i, value->data, sizeof (int));
+            return i;
+        case TYPE_FLOAT:
+            memcpy(&f, value->data, sizeof (float));
+            return f;
+        default:
+            memcpy(&d, value->data, sizeof (double));
+            return d;
+    }
+}
+
+/**
+ * @author agent
+ * @brief  Function that compares two values of a compiled expression. Values whose type does not fit the numeric
+ * comparison type (e.g. a null stored as varchar) never satisfy the comparison.
+ * @param a left value
+ * @param b right value
+ * @param type comparison type chosen by AK_expression_compare_type
+ * @param comparison AK_EXPR_EQ, AK_EXPR_NE, ...
+ * @return 1 if the comparison holds, 0 otherwise
+ */
+static int AK_expression_compare(AK_expression_value *a, AK_expression_value *b, int type, int comparison) {
+    int diff, len_a, len_b;
+    int int_a, int_b;
+    float float_a, float_b;
+    double number_a, number_b;
+
+    switch (type) {
+        case TYPE_INT:
+            if (a->type != TYPE_INT || b->type != TYPE_INT)
+                return 0;
+            memcpy(&int_a, a->data, sizeof (int));
+            memcpy(&int_b, b->data, sizeof (int));
+            diff = (int_a > int_b) - (int_a < int_b);
+            break;
+        case TYPE_FLOAT:
+            if (a->type != TYPE_FLOAT || b->type != TYPE_FLOAT)
+                return 0;
+            memcpy(&float_a, a->data, sizeof (float));
+            memcpy(&float_b, b->data, sizeof (float));
+            diff = (float_a > float_b) - (float_a < float_b);
+            break;
+        case TYPE_NUMBER:
+        case AK_EXPR_MIXED:
+            if (!AK_expression_is_numeric(a->type) || !AK_expression_is_numeric(b->type))
+                return 0;
+            number_a = AK_expression_number(a);
+            number_b = AK_expression_number(b);
+            diff = (number_a > number_b) - (number_a < number_b);
+            break;
+        default:
+            len_a = strnlen(a->data, a->size);
+            len_b = strnlen(b->data, b->size);
+            diff = memcmp(a->data, b->data, len_a < len_b ? len_a : len_b);
+            if (diff == 0)
+                diff = len_a - len_b;
+            break;
+    }
+
+    switch (comparison) {
+        case AK_EXPR_EQ:
+            return diff == 0;
+        case AK_EXPR_NE:
+            return diff != 0;
+        case AK_EXPR_LT:
+            return diff < 0;
+        case AK_EXPR_GT:
+            return diff > 0;
+        case AK_EXPR_LE:
+            return diff <= 0;
+        default:
+            return diff >= 0;
+    }
+}
+
+/**
+ * @author agent
+ * @brief  Function that copies a constant of the expression into the memory of the program. All given bytes are
+ * kept, because lists of IN, ANY and ALL operators are strings even if their type is numeric.
+ * @param program compiled expression
+ * @param type data type of the constant
+ * @param data bytes of the constant
+ * @param size number of bytes in data
+ * @param value value to fill
+ * @return EXIT_SUCCESS or EXIT_ERROR if out of memory
+ */
+static int AK_expression_constant(AK_expression_program *program, int type, const char *data, int size, AK_expression_value *value) {
+    value->data = AK_arena_calloc(program->arena, 1, (size > sizeof (double) ? size : sizeof (double)) + 1);
+    if (value->data == NULL)
+        return EXIT_ERROR;
+    memcpy(value->data, data, size);
+    value->type = type;
+    if (type == TYPE_INT)
+        value->size = sizeof (int);
+    else if (type == TYPE_FLOAT)
+        value->size = sizeof (float);
+    else if (type == TYPE_NUMBER)
+        value->size = sizeof (double);
+    else
+        value->size = strnlen(data, size);
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @author agent
+ * @brief  Function that converts the comma separated list of an IN, ANY or ALL operator into values of the list type
+ * @param program compiled expression
+ * @param constant list constant
+ * @param instruction instruction that gets the values
+ * @return EXIT_SUCCESS or EXIT_ERROR if out of memory
+ */
+static int AK_expression_list(AK_expression_program *program, AK_expression_value *constant, AK_expression_instruction *instruction) {
+    char *str, *token;
+    int count = 1, i = 0;
+    int int_value;
+    float float_value;
+    double number_value;
+
+    for (str = constant->data; *str; str++)
+        count += (*str == ',');
+    instruction->list = AK_arena_calloc(program->arena, count, sizeof (AK_expression_value));
+    str = AK_arena_alloc(program->arena, strlen(constant->data) + 1);
+    if (instruction->list == NULL || str == NULL)
+        return EXIT_ERROR;
+    strcpy(str, constant->data);
+
+    while ((token = strsep(&str, ",")) != NULL) {
+        int size = strlen(token);
+
+        if (constant->type == TYPE_INT) {
+            int_value = atoi(token);
+            token = (char *) &int_value;
+            size = sizeof (int);
+        } else if (constant->type == TYPE_FLOAT) {
+            float_value = atof(token);
+            token = (char *) &float_value;
+            size = sizeof (float);
+        } else if (constant->type == TYPE_NUMBER) {
+            number_value = atof(token);
+            token = (char *) &number_value;
+            size = sizeof (double);
+        }
+        if (AK_expression_constant(program, constant->type, token, size, &instruction->list[i++]) == EXIT_ERROR)
+            return EXIT_ERROR;
+    }
+    instruction->count = i;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @author agent
+ * @brief  Function that compiles the pattern of a LIKE or regular expression operator, the same way as
+ * AK_check_regex_expression does for every row
+ * @param program compiled expression
+ * @param pattern pattern constant
+ * @param sensitive 1 for a case sensitive match
+ * @param wild_card 1 for SQL wildcards (LIKE), 0 for a POSIX regular expression
+ * @param instruction instruction that gets the compiled pattern
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_expression_regex(AK_expression_program *program, AK_expression_value *pattern, int sensitive, int wild_card, AK_expression_instruction *instruction) {
+    char *anchored, *regex, *result;
+    regex_t *compiled = AK_arena_alloc(program->arena, sizeof (regex_t));
+
+    if (compiled == NULL)
+        return EXIT_ERROR;
+    if (wild_card) {
+        anchored = AK_malloc(pattern->size + 3);
+        sprintf(anchored, "^%s$", pattern->data);
+        result = AK_replace_wild_card(anchored, '%', ".*");
+        regex = AK_replace_wild_card(result, '_', ".");
+        AK_free(result);
+        AK_free(anchored);
+    } else {
+        regex = pattern->data;
+    }
+    if (regcomp(compiled, regex, sensitive ? REG_EXTENDED : REG_ICASE)) {
+        if (wild_card)
+            AK_free(regex);
+        return EXIT_ERROR;
+    }
+    if (wild_card)
+        AK_free(regex);
+    instruction->regex = compiled;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @author agent
+ * @brief  Function that releases the compiled patterns of a program
+ * @param program compiled expression
+ */
+static void AK_expression_release(AK_expression_program *program) {
+    int i;
+
+    for (i = 0; i < program->length; i++)
+        if (program->code[i].regex != NULL)
+            regfree(program->code[i].regex);
+    program->length = 0;
+}
+
+/**
+ * @author agent
+ * @brief  Function that compiles a logical expression in postfix notation for rows with the given header. Every
+ * element becomes one instruction: attributes are resolved to ordinals, comparisons get the type their operands are
+ * compared in, IN/ANY/ALL lists are split and converted and LIKE and regular expression patterns are compiled. The
+ * depth of both stacks is checked here, so AK_expression_run needs no checks. Expressions with operators that have
+ * no instruction (arithmetic, SIMILAR TO), with unknown attributes or with malformed patterns are kept for
+ * AK_check_if_compact_row_satisfies_expression.
+ * @param expr list with the logical expression in postfix notation, NULL for an expression that is always true
+ * @param header header of the rows
+ * @param num_attr number of attributes in header
+ * @return compiled expression, NULL if out of memory
+ */
+AK_expression_program *AK_expression_compile(struct list_node *expr, AK_header *header, int num_attr) {
+    AK_PRO;
+    char like_regex[] = "([]:alpha:[!%_^]*)";
+    int value_type[AK_EXPRESSION_STACK_SIZE];
+    int values = 0, results = 0, count = 0, i;
+    struct list_node *el;
+    AK_expression_instruction *instruction;
+    AK_expression_program *program = AK_calloc(1, sizeof (AK_expression_program));
+
+    if (program == NULL) {
+        AK_EPI;
+        return NULL;
+    }
+    program->expr = expr;
+    program->arena = AK_arena_create(AK_EXPRESSION_ARENA_SIZE);
+    if (program->arena == NULL) {
+        AK_free(program);
+        AK_EPI;
+        return NULL;
+    }
+    if (expr == NULL) {
+        AK_EPI;
+        return program;
+    }
+
+    for (el = AK_First_L2(expr); el; el = el->next)
+        count++;
+    program->code = AK_arena_calloc(program->arena, count, sizeof (AK_expression_instruction));
+    if (program->code == NULL)
+        goto interpret;
+
+    for (el = AK_First_L2(expr); el; el = el->next) {
+        char *op = el->data;
+        int comparison = 0, quantifier = 0, sensitive = 1, wild_card = 0, negate = 0;
+
+        instruction = &program->code[program->length];
+
+        if (el->type == TYPE_ATTRIBS) {
+            for (i = 0; i < num_attr; i++)
+                if (strcmp(header[i].att_name, el->data) == 0)
+                    break;
+            if (i == num_attr || values == AK_EXPRESSION_STACK_SIZE)
+                goto interpret;
+            instruction->opcode = AK_EXPR_COLUMN;
+            instruction->column = i;
+            value_type[values++] = header[i].type;
+            program->length++;
+            continue;
+        }
+
+        if (el->type != TYPE_OPERATOR) {
+            if (values == AK_EXPRESSION_STACK_SIZE)
+                goto interpret;
+            instruction->opcode = AK_EXPR_CONSTANT;
+            if (AK_expression_constant(program, el->type, el->data, el->size < MAX_VARCHAR_LENGTH ? el->size : MAX_VARCHAR_LENGTH, &instruction->value) == EXIT_ERROR)
+                goto interpret;
+            value_type[values++] = el->type;
+            program->length++;
+            continue;
+        }
+
+        if (strcmp(op, "=") == 0) comparison = AK_EXPR_EQ;
+        else if (strcmp(op, "<>") == 0 || strcmp(op, "!=") == 0) comparison = AK_EXPR_NE;
+        else if (strcmp(op, "<") == 0) comparison = AK_EXPR_LT;
+        else if (strcmp(op, ">") == 0) comparison = AK_EXPR_GT;
+        else if (strcmp(op, "<=") == 0) comparison = AK_EXPR_LE;
+        else if (strcmp(op, ">=") == 0) comparison = AK_EXPR_GE;
+
+        if (comparison) {
+            if (values < 2)
+                goto interpret;
+            values -= 2;
+            instruction->opcode = AK_EXPR_COMPARE;
+            instruction->comparison = comparison;
+            instruction->type = AK_expression_compare_type(value_type[values], value_type[values + 1]);
+            results++;
+            program->length++;
+            continue;
+        }
+
+        if (strcmp(op, "AND") == 0 || strcmp(op, "OR") == 0) {
+            if (results < 2)
+                goto interpret;
+            results--;
+            instruction->opcode = strcmp(op, "AND") == 0 ? AK_EXPR_AND : AK_EXPR_OR;
+            program->length++;
+            continue;
+        }
+
+        if (strcmp(op, "BETWEEN") == 0) {
+            if (values < 3)
+                goto interpret;
+            values -= 3;
+            instruction->opcode = AK_EXPR_BETWEEN;
+            instruction->type = AK_expression_compare_type(value_type[values], value_type[values + 1]);
+            results++;
+            program->length++;
+            continue;
+        }
+
+        if (strcmp(op, "IN") == 0 || strcmp(op, "=ANY") == 0 || strcmp(op, "= ANY") == 0) quantifier = AK_EXPR_ANY, comparison = AK_EXPR_EQ;
+        else if (strcmp(op, ">ANY") == 0 || strcmp(op, "> ANY") == 0) quantifier = AK_EXPR_ANY, comparison = AK_EXPR_GT;
+        else if (strcmp(op, "<ANY") == 0 || strcmp(op, "< ANY") == 0) quantifier = AK_EXPR_ANY, comparison = AK_EXPR_LT;
+        else if (strcmp(op, "<=ANY") == 0 || strcmp(op, "<= ANY") == 0) quantifier = AK_EXPR_ANY, comparison = AK_EXPR_LE;
+        else if (strcmp(op, ">=ANY") == 0 || strcmp(op, ">= ANY") == 0) quantifier = AK_EXPR_ANY, comparison = AK_EXPR_GE;
+        else if (strcmp(op, "!=ANY") == 0 || strcmp(op, "!= ANY") == 0 || strcmp(op, "<>ANY") == 0 || strcmp(op, "<> ANY") == 0) quantifier = AK_EXPR_ANY, comparison = AK_EXPR_NE;
+        else if (strcmp(op, ">ALL") == 0 || strcmp(op, "> ALL") == 0) quantifier = AK_EXPR_ALL, comparison = AK_EXPR_GT;
+        else if (strcmp(op, "<ALL") == 0 || strcmp(op, "< ALL") == 0) quantifier = AK_EXPR_ALL, comparison = AK_EXPR_LT;
+        else if (strcmp(op, ">=ALL") == 0 || strcmp(op, ">= ALL") == 0) quantifier = AK_EXPR_ALL, comparison = AK_EXPR_GE;
+        else if (strcmp(op, "<=ALL") == 0 || strcmp(op, "<= ALL") == 0) quantifier = AK_EXPR_ALL, comparison = AK_EXPR_LE;
+        else if (strcmp(op, "!=ALL") == 0 || strcmp(op, "!= ALL") == 0 || strcmp(op, "<>ALL") == 0 || strcmp(op, "<> ALL") == 0) quantifier = AK_EXPR_ALL, comparison = AK_EXPR_NE;
+        else if (strcmp(op, "=ALL") == 0 || strcmp(op, "= ALL") == 0) quantifier = AK_EXPR_ALL, comparison = AK_EXPR_EQ;
+
+        if (strcmp(op, "LIKE") == 0 || strcmp(op, "~~") == 0) wild_card = 1;
+        else if (strcmp(op, "NOT LIKE") == 0) wild_card = 1, negate = 1;
+        else if (strcmp(op, "ILIKE") == 0 || strcmp(op, "~~*") == 0) wild_card = 1, sensitive = 0;
+        else if (strcmp(op, "NOT ILIKE") == 0) wild_card = 1, sensitive = 0, negate = 1;
+        else if (strcmp(op, "~") == 0) wild_card = 0;
+        else if (strcmp(op, "!~") == 0) negate = 1;
+        else if (strcmp(op, "~*") == 0) sensitive = 0;
+        else if (!quantifier)
+            goto interpret;
+
+        /* the list or pattern is the constant pushed just before the operator, it becomes part of the instruction */
+        if (values < 2 || program->length == 0 || program->code[program->length - 1].opcode != AK_EXPR_CONSTANT)
+            goto interpret;
+        AK_expression_value constant = program->code[program->length - 1].value;
+        program->length--;
+        instruction = &program->code[program->length];
+        memset(instruction, 0, sizeof (AK_expression_instruction));
+        values -= 2;
+
+        if (quantifier) {
+            instruction->opcode = quantifier;
+            instruction->comparison = comparison;
+            instruction->type = AK_expression_compare_type(value_type[values], constant.type);
+            if (AK_expression_list(program, &constant, instruction) == EXIT_ERROR)
+                goto interpret;
+        } else {
+            if (wild_card && !AK_check_regex_operator_expression(constant.data, like_regex))
+                goto interpret;
+            instruction->opcode = AK_EXPR_MATCH;
+            instruction->negate = negate;
+            if (AK_expression_regex(program, &constant, sensitive, wild_card, instruction) == EXIT_ERROR)
+                goto interpret;
+        }
+        results++;
+        program->length++;
+    }
+
+    if (results > 0) {
+        AK_dbg_messg(HIGH, REL_OP, "AK_expression_compile: %d instructions\n", program->length);
+        AK_EPI;
+        return program;
+    }
+
+interpret:
+    AK_dbg_messg(MIDDLE, REL_OP, "AK_expression_compile: expression is interpreted\n");
+    AK_expression_release(program);
+    program->interpreted = 1;
+    AK_EPI;
+    return program;
+}
+
+/**
+ * @author agent
+ * @brief  Function that evaluates a compiled expression on a compact row. Values point into the row and the
+ * program, both stacks are local, so nothing is allocated per row.
+ * @param program compiled expression
+ * @param row compact row with the header the expression was compiled for
+ * @param scratch arena used if the expression is interpreted, NULL to use a temporary one
+ * @result 0 if row does not satisfy, 1 if row satisfies expression
+ */
+int AK_expression_run(AK_expression_program *program, AK_row *row, AK_arena *scratch) {
+    AK_PRO;
+    AK_expression_value value[AK_EXPRESSION_STACK_SIZE];
+    char result[AK_EXPRESSION_STACK_SIZE];
+    char data[MAX_VARCHAR_LENGTH + 1];
+    int values = 0, results = 0, pc, i, satisfied;
+    AK_expression_instruction *instruction;
+
+    if (program->interpreted) {
+        satisfied = AK_check_if_compact_row_satisfies_expression(row, program->expr, scratch);
+        AK_EPI;
+        return satisfied;
+    }
+    if (program->length == 0) {
+        AK_EPI;
+        return 1;
+    }
+
+    for (pc = 0; pc < program->length; pc++) {
+        instruction = &program->code[pc];
+        switch (instruction->opcode) {
+            case AK_EXPR_COLUMN:
+                value[values].data = AK_row_get(row, instruction->column, &value[values].type, &value[values].size);
+                if (value[values].data == NULL) {
+                    AK_EPI;
+                    return 0;
+                }
+                values++;
+                break;
+            case AK_EXPR_CONSTANT:
+                value[values++] = instruction->value;
+                break;
+            case AK_EXPR_COMPARE:
+                values -= 2;
+                result[results++] = AK_expression_compare(&value[values], &value[values + 1], instruction->type, instruction->comparison);
+                break;
+            case AK_EXPR_BETWEEN:
+                values -= 3;
+                result[results++] = AK_expression_compare(&value[values], &value[values + 1], instruction->type, AK_EXPR_GE)
+                        && AK_expression_compare(&value[values], &value[values + 2], instruction->type, AK_EXPR_LE);
+                break;
+            case AK_EXPR_ANY:
+            case AK_EXPR_ALL:
+                values--;
+                satisfied = instruction->opcode == AK_EXPR_ALL;
+                for (i = 0; i < instruction->count; i++) {
+                    if (AK_expression_compare(&value[values], &instruction->list[i], instruction->type, instruction->comparison) != satisfied) {
+                        satisfied = !satisfied;
+                        break;
+                    }
+                }
+                result[results++] = satisfied;
+                break;
+            case AK_EXPR_MATCH:
+                values--;
+                i = value[values].size < MAX_VARCHAR_LENGTH ? value[values].size : MAX_VARCHAR_LENGTH;
+                memcpy(data, value[values].data, i);
+                data[i] = '\0';
+                satisfied = regexec(instruction->regex, data, 0, NULL, 0) != REG_NOMATCH;
+                result[results++] = satisfied != instruction->negate;
+                break;
+            case AK_EXPR_AND:
+                results--;
+                result[results - 1] = result[results - 1] && result[results];
+                break;
+            case AK_EXPR_OR:
+                results--;
+                result[results - 1] = result[results - 1] || result[results];
+                break;
+        }
+    }
+    AK_EPI;
+    return result[results - 1];
+}
+
+/**
+ * @author agent
+ * @brief  Function that frees a compiled expression
+ * @param program compiled expression
+ */
+void AK_expression_free(AK_expression_program *program) {
+    AK_PRO;
+    if (program == NULL) {
+        AK_EPI;
+        return;
+    }
+    AK_expression_release(program);
+    AK_arena_destroy(program->arena);
+    AK_free(program);
+    AK_EPI;
+}
+
+/**
+ * @author agent
+ * @brief  Function for testing compiled expressions. Every row of a table is evaluated by the compiled expression
+ * and by the interpreter, the results must be the same for every row.
+ * @param table table name
+ * @param expr list with the logical expression in postfix notation
+ * @param matches receives the number of rows satisfying the expression
+ * @return 1 if the expression was compiled and both evaluations agree on all rows, 0 otherwise
+ */
+static int AK_expression_compile_check(char *table, struct list_node *expr, int *matches) {
+    int num_attr = AK_num_attr(table), rows = 0, same = 1, compiled, interpreted;
+    AK_header *header = (AK_header *) AK_get_header(table);
+    table_addresses *addresses = (table_addresses *) AK_get_table_addresses(table);
+    AK_row *row = AK_row_new(header, num_attr);
+    AK_expression_program *program = AK_expression_compile(expr, header, num_attr);
+
+    *matches = 0;
+    if (program != NULL && !program->interpreted && row != NULL) {
+        for (int i = 0; addresses->address_from[i] != 0; i++) {
+            for (int j = addresses->address_from[i]; j < addresses->address_to[i]; j++) {
+                AK_block *block = AK_get_block(j)->block;
+                for (int k = 0; (k + 1) * num_attr <= DATA_BLOCK_SIZE && block->tuple_dict[k * num_attr].type != FREE_INT; k++) {
+                    if (AK_row_from_slot(row, block, k) == EXIT_ERROR)
+                        continue;
+                    compiled = AK_expression_run(program, row, NULL);
+                    interpreted = AK_check_if_compact_row_satisfies_expression(row, expr, NULL);
+                    if (compiled != interpreted) {
+                        printf("Compiled expression gives %d, interpreted %d\n", compiled, interpreted);
+                        same = 0;
+                    }
+                    *matches += compiled;
+                    rows++;
+                }
+            }
+        }
+    }
+    printf("Compiled expression: %d of %d rows satisfy it\n", *matches, rows);
+
+    AK_expression_free(program);
+    AK_row_free(row);
+    AK_free(addresses);
+    AK_free(header);
+    return program != NULL && rows > 0 && same;
+}
+
 //TODO: Add description
 TestResult AK_expression_check_test()
 {
@@ -1298,6 +1945,75 @@ TestResult AK_expression_check_test()
 	AK_free(attributes6);
 	AK_free(condition6);
 
+	printf("EXPRESSION CHECK TEST 3 (compiled expressions):\n");
+
+	struct list_node *compiled = (struct list_node *) AK_malloc(sizeof (struct list_node));
+	int year = 2008, low = 2003, high = 2006, matches, all_matches, any_matches;
+	float weight = 80;
+
+	// year < 2008
+	AK_Init_L3(&compiled);
+	AK_InsertAtEnd_L3(TYPE_ATTRIBS, "year", sizeof("year"), compiled);
+	AK_InsertAtEnd_L3(TYPE_INT, (char *) &year, sizeof(int), compiled);
+	AK_InsertAtEnd_L3(TYPE_OPERATOR, "<", sizeof("<"), compiled);
+	if (AK_expression_compile_check(srcTable, compiled, &matches) && matches > 0)
+		successful++;
+	else failed++;
+	AK_DeleteAll_L3(&compiled);
+
+	// year BETWEEN 2003 AND 2006 OR weight > 80 AND firstname NOT ILIKE 'm%'
+	AK_InsertAtEnd_L3(TYPE_ATTRIBS, "year", sizeof("year"), compiled);
+	AK_InsertAtEnd_L3(TYPE_INT, (char *) &low, sizeof(int), compiled);
+	AK_InsertAtEnd_L3(TYPE_INT, (char *) &high, sizeof(int), compiled);
+	AK_InsertAtEnd_L3(TYPE_OPERATOR, "BETWEEN", sizeof("BETWEEN"), compiled);
+	AK_InsertAtEnd_L3(TYPE_ATTRIBS, "weight", sizeof("weight"), compiled);
+	AK_InsertAtEnd_L3(TYPE_FLOAT, (char *) &weight, sizeof(float), compiled);
+	AK_InsertAtEnd_L3(TYPE_OPERATOR, ">", sizeof(">"), compiled);
+	AK_InsertAtEnd_L3(TYPE_OPERATOR, "OR", sizeof("OR"), compiled);
+	AK_InsertAtEnd_L3(TYPE_ATTRIBS, "firstname", sizeof("firstname"), compiled);
+	AK_InsertAtEnd_L3(TYPE_VARCHAR, "m%", sizeof("m%"), compiled);
+	AK_InsertAtEnd_L3(TYPE_OPERATOR, "NOT ILIKE", sizeof("NOT ILIKE"), compiled);
+	AK_InsertAtEnd_L3(TYPE_OPERATOR, "AND", sizeof("AND"), compiled);
+	if (AK_expression_compile_check(srcTable, compiled, &matches))
+		successful++;
+	else failed++;
+	AK_DeleteAll_L3(&compiled);
+
+	// firstname IN ('Marina','Dino') OR firstname ~ '^Ma'
+	AK_InsertAtEnd_L3(TYPE_ATTRIBS, "firstname", sizeof("firstname"), compiled);
+	AK_InsertAtEnd_L3(TYPE_VARCHAR, conditionAtributes, sizeof(conditionAtributes), compiled);
+	AK_InsertAtEnd_L3(TYPE_OPERATOR, "IN", sizeof("IN"), compiled);
+	AK_InsertAtEnd_L3(TYPE_ATTRIBS, "firstname", sizeof("firstname"), compiled);
+	AK_InsertAtEnd_L3(TYPE_VARCHAR, conditionAtributes6, sizeof(conditionAtributes6), compiled);
+	AK_InsertAtEnd_L3(TYPE_OPERATOR, "~", sizeof("~"), compiled);
+	AK_InsertAtEnd_L3(TYPE_OPERATOR, "OR", sizeof("OR"), compiled);
+	if (AK_expression_compile_check(srcTable, compiled, &matches) && matches > 0)
+		successful++;
+	else failed++;
+	AK_DeleteAll_L3(&compiled);
+
+	// year <=ALL (2012,2013,2014) is year <= 2012, year <=ANY (2012,2013,2014) is year <= 2014
+	AK_InsertAtEnd_L3(TYPE_ATTRIBS, "year", sizeof("year"), compiled);
+	AK_InsertAtEnd_L3(TYPE_INT, conditionAtributes3, sizeof(conditionAtributes3), compiled);
+	AK_InsertAtEnd_L3(TYPE_OPERATOR, "<=ALL", sizeof("<=ALL"), compiled);
+	int all_compiled = AK_expression_compile_check(srcTable, compiled, &all_matches);
+	AK_DeleteAll_L3(&compiled);
+	year = 2012;
+	AK_InsertAtEnd_L3(TYPE_ATTRIBS, "year", sizeof("year"), compiled);
+	AK_InsertAtEnd_L3(TYPE_INT, (char *) &year, sizeof(int), compiled);
+	AK_InsertAtEnd_L3(TYPE_OPERATOR, "<=", sizeof("<="), compiled);
+	if (all_compiled && AK_expression_compile_check(srcTable, compiled, &matches) && matches == all_matches)
+		successful++;
+	else failed++;
+	AK_DeleteAll_L3(&compiled);
+	AK_InsertAtEnd_L3(TYPE_ATTRIBS, "year", sizeof("year"), compiled);
+	AK_InsertAtEnd_L3(TYPE_INT, conditionAtributes3, sizeof(conditionAtributes3), compiled);
+	AK_InsertAtEnd_L3(TYPE_OPERATOR, "<=ANY", sizeof("<=ANY"), compiled);
+	if (AK_expression_compile_check(srcTable, compiled, &any_matches) && any_matches >= all_matches)
+		successful++;
+	else failed++;
+	AK_DeleteAll_L3(&compiled);
+	AK_free(compiled);
 
     AK_EPI;
     return TEST_result(successful, failed);
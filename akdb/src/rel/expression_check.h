@@ -25,6 +25,101 @@
 #include "../file/fileio.h"
 #include "../auxi/mempro.h"
 #include <regex.h>
+
+/**
+ * @def AK_EXPRESSION_ARENA_SIZE
+ * @brief Chunk size of the scratch arena of one expression evaluation
+ */
+#define AK_EXPRESSION_ARENA_SIZE 4096
+
+/**
+ * @def AK_EXPRESSION_STACK_SIZE
+ * @brief Depth of the value and result stacks of a compiled expression
+ */
+#define AK_EXPRESSION_STACK_SIZE 32
+
+/// instructions of a compiled expression
+#define AK_EXPR_COLUMN 1
+#define AK_EXPR_CONSTANT 2
+#define AK_EXPR_COMPARE 3
+#define AK_EXPR_BETWEEN 4
+#define AK_EXPR_ANY 5
+#define AK_EXPR_ALL 6
+#define AK_EXPR_MATCH 7
+#define AK_EXPR_AND 8
+#define AK_EXPR_OR 9
+
+/// comparisons of a compiled expression
+#define AK_EXPR_EQ 1
+#define AK_EXPR_NE 2
+#define AK_EXPR_LT 3
+#define AK_EXPR_GT 4
+#define AK_EXPR_LE 5
+#define AK_EXPR_GE 6
+
+/// comparison type of numeric operands of different types, they are compared as doubles
+#define AK_EXPR_MIXED -1
+
+/**
+ * @author agent
+ * @struct AK_expression_value
+ * @brief Structure that defines one value of a compiled expression
+ */
+typedef struct {
+    /// data type
+    int type;
+    /// number of bytes in data
+    int size;
+    /// value bytes
+    char *data;
+} AK_expression_value;
+
+/**
+ * @author agent
+ * @struct AK_expression_instruction
+ * @brief Structure that defines one instruction of a compiled expression
+ */
+typedef struct {
+    /// AK_EXPR_COLUMN, AK_EXPR_CONSTANT, ...
+    int opcode;
+    /// type in which operands are compared: TYPE_INT, TYPE_FLOAT, TYPE_NUMBER, AK_EXPR_MIXED or TYPE_VARCHAR for bytes
+    int type;
+    /// AK_EXPR_EQ, AK_EXPR_NE, ...
+    int comparison;
+    /// attribute ordinal of AK_EXPR_COLUMN
+    int column;
+    /// 1 if the result of AK_EXPR_MATCH is negated
+    int negate;
+    /// value of AK_EXPR_CONSTANT
+    AK_expression_value value;
+    /// values of AK_EXPR_ANY and AK_EXPR_ALL
+    AK_expression_value *list;
+    /// number of values in list
+    int count;
+    /// compiled pattern of AK_EXPR_MATCH
+    regex_t *regex;
+} AK_expression_instruction;
+
+/**
+ * @author agent
+ * @struct AK_expression_program
+ * @brief Structure that defines an expression compiled against a table header. Attribute names are resolved to
+ * ordinals, constants and IN lists are converted and regular expressions compiled once, so evaluation of a row
+ * does not parse or allocate anything.
+ */
+typedef struct {
+    /// instructions
+    AK_expression_instruction *code;
+    /// number of instructions
+    int length;
+    /// source expression
+    struct list_node *expr;
+    /// 1 if the expression could not be compiled and rows are evaluated by AK_check_if_compact_row_satisfies_expression
+    int interpreted;
+    /// memory of the program
+    AK_arena *arena;
+} AK_expression_program;
+
 /*
 int AK_check_arithmetic_statement(AK_list_elem el, const char *op, const char *a, const char *b);
 int AK_check_if_row_satisfies_expression(AK_list_elem row_root, AK_list *expr);
@@ -50,6 +145,41 @@ int AK_check_arithmetic_statement(struct list_node *el, const char *op, const ch
 
 */
 int AK_check_if_row_satisfies_expression(struct list_node *row_root, struct list_node *expr);
+/**
+ * @author agent
+ * @brief  Function that evaluates whether a compact row satisfies logical expression
+ * @param row compact row that is to be evaluated
+ * @param *expr list with the logical expression in postfix notation
+ * @param scratch arena of the calling operator, reset by the caller between rows; NULL to use a temporary one
+ * @result 0 if row does not satisfy, 1 if row satisfies expression
+ */
+int AK_check_if_compact_row_satisfies_expression(AK_row *row, struct list_node *expr, AK_arena *scratch);
+/**
+ * @author agent
+ * @brief  Function that compiles a logical expression in postfix notation for rows with the given header. Expressions
+ * with operators that have no instruction (arithmetic, SIMILAR TO) or with unknown attributes are kept for
+ * AK_check_if_compact_row_satisfies_expression.
+ * @param expr list with the logical expression in postfix notation, NULL for an expression that is always true
+ * @param header header of the rows
+ * @param num_attr number of attributes in header
+ * @return compiled expression, NULL if out of memory
+ */
+AK_expression_program *AK_expression_compile(struct list_node *expr, AK_header *header, int num_attr);
+/**
+ * @author agent
+ * @brief  Function that evaluates a compiled expression on a compact row
+ * @param program compiled expression
+ * @param row compact row with the header the expression was compiled for
+ * @param scratch arena used if the expression is interpreted, NULL to use a temporary one
+ * @result 0 if row does not satisfy, 1 if row satisfies expression
+ */
+int AK_expression_run(AK_expression_program *program, AK_row *row, AK_arena *scratch);
+/**
+ * @author agent
+ * @brief  Function that frees a compiled expression
+ * @param program compiled expression
+ */
+void AK_expression_free(AK_expression_program *program);
 /**
 	* @Author Leon Palaić
 	* @brief Function that evaluates regex expression on a given string input.
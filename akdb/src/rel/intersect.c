@@ -21,175 +21,54 @@
 #include "intersect.h"
 
 /**
- * @author Dino Laktašić; updated by Elena Kržina
- * @brief  Function that makes an intersect of two tables. Intersect is implemented for working with multiple sets of data, i.e. duplicate 
-          tuples can be written in same table (intersect)
+ * @author Dino Laktašić; updated by Elena Kržina, updated by agent (hash set operators)
+ * @brief  Function that writes the intersection of two tables into a new table. The rows are produced by a set operation
+ *         node (see AK_set_operator) over scans of the two tables.
  * @param srcTable1 name of the first table
  * @param srcTable2 name of the second table
  * @param dstTable name of the new table
+ * @param all 1 to keep duplicate rows, 0 to write every row once
  * @return if success returns EXIT_SUCCESS, else returns EXIT_ERROR
  */
+static int AK_intersect_tables(char *srcTable1, char *srcTable2, char *dstTable, int all) {
+    AK_operator *plan;
+    int rows;
+    AK_PRO;
+    plan = AK_set_operator(AK_scan_operator(srcTable1), AK_scan_operator(srcTable2), AK_SET_INTERSECT, all);
+    if (plan == NULL) {
+        AK_dbg_messg(LOW, REL_OP, "\nAK_intersect: Table/s doesn't exist!");
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    rows = AK_iterator_materialize(plan, dstTable);
+    AK_operator_free(plan);
+    if (rows == EXIT_ERROR) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    AK_dbg_messg(LOW, REL_OP, "INTERSECT_TEST_SUCCESS\n\n");
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
 
 int AK_intersect(char *srcTable1, char *srcTable2, char *dstTable) {
+    int result;
     AK_PRO;
-    table_addresses *src_addr1 = (table_addresses*) AK_get_table_addresses(srcTable1);
-    table_addresses *src_addr2 = (table_addresses*) AK_get_table_addresses(srcTable2);
-
-    int startAddress1 = src_addr1->address_from[0];
-    int startAddress2 = src_addr2->address_from[0];
-
-    if ((startAddress1 != 0) && (startAddress2 != 0)) 
-	{
-		//register int used for faster processing
-        register int i, j, k, l;
-        i = j = k = l = 0;
-
-        AK_mem_block *tbl1_temp_block = (AK_mem_block *) AK_get_block(startAddress1);
-        AK_mem_block *tbl2_temp_block = (AK_mem_block *) AK_get_block(startAddress2);
-        
-        int num_att = AK_check_tables_scheme(tbl1_temp_block, tbl2_temp_block, "Intersect");
-
-        if (num_att == EXIT_ERROR) {
-
-			AK_free(src_addr1);
-       		AK_free(src_addr2);
-			AK_free(tbl1_temp_block);
-			AK_free(tbl2_temp_block);
-			
-			AK_EPI;
-			return EXIT_ERROR;
-		}
-
-        int m, n, o;
-		int address, type, size,thesame;
-		thesame = 0;
-		
-        char data1[MAX_VARCHAR_LENGTH];
-        char data2[MAX_VARCHAR_LENGTH];
-
-        //initialize new segment
-        AK_header *header = (AK_header *) AK_malloc(num_att * sizeof (AK_header));
-        memcpy(header, tbl1_temp_block->block->header, num_att * sizeof (AK_header));
-        AK_initialize_new_segment(dstTable, SEGMENT_TYPE_TABLE, header);
-        AK_free(header);
-
-		struct list_node *row_root = (struct list_node * ) AK_malloc(sizeof(struct list_node));
-
-        //TABLE1: for each extent in table1
-        for (i = 0; src_addr1->address_from[i] != 0; i++) 
-		{
-            startAddress1 = src_addr1->address_from[i];
-
-                //BLOCK: for each block in table1 extent
-                for (j = startAddress1; j < src_addr1->address_to[i]; j++) 
-				{
-                    tbl1_temp_block = (AK_mem_block *) AK_get_block(j);
-
-                    //if there is data in the block
-                    if (tbl1_temp_block->block->AK_free_space != 0) 
-					{
-
-                        //TABLE2: for each extent in table2
-                        for (k = 0; k < (src_addr2->address_from[k] != 0); k++) 
-						{
-                            startAddress2 = src_addr2->address_from[k];
-
-                            if (startAddress2 != 0) 
-							{
-                                //BLOCK: for each block in table2 extent
-                                for (l = startAddress2; l < src_addr2->address_to[k]; l++) 
-								{
-                                    tbl2_temp_block = (AK_mem_block *) AK_get_block(l);
-
-                                    //if there is data in the block
-                                    if (tbl2_temp_block->block->AK_free_space != 0) 
-									{
-                                        //TUPLE_DICTS: for each tuple_dict in the block
-                                        for (m = 0; m < DATA_BLOCK_SIZE; m += num_att) 
-										{
-                                            if (tbl1_temp_block->block->tuple_dict[m + 1].type == FREE_INT)
-                                                break;
-
-                                            for (o = 0; o < DATA_BLOCK_SIZE; o += num_att) 
-											{
-                                                if (tbl2_temp_block->block->tuple_dict[o + 1].type == FREE_INT)
-                                                    break;
-
-                                                for (n = 0; n < num_att; n++) 
-												{
-                                                    type = tbl1_temp_block->block->tuple_dict[m + n].type;
-                                                    size = tbl1_temp_block->block->tuple_dict[m + n].size;
-                                                    address = tbl1_temp_block->block->tuple_dict[m + n].address;
-													
-                                                    memcpy(data1, &(tbl1_temp_block->block->data[address]), size);
-                                                    data1[size] = '\0';
-
-                                                    type = tbl2_temp_block->block->tuple_dict[o + n].type;
-                                                    size = tbl2_temp_block->block->tuple_dict[o + n].size;
-                                                    address = tbl2_temp_block->block->tuple_dict[o + n].address;
-													
-                                                    memcpy(data2, &(tbl2_temp_block->block->data[address]), size);
-                                                    data2[size] = '\0';
-
-                                                    //if two attributes are different, stop searching that row
-													if(strcmp(data1,data2)!=0)break;
-													else if(strcmp(data1, data2) == 0 && n==(num_att-1)) thesame=1;
-                                                }
-
-                                                if (thesame == 1) 
-												{
-                                                    for (n = 0; n < num_att; n++) 
-													{
-                                                        type = tbl1_temp_block->block->tuple_dict[m + n].type;
-                                                        size = tbl1_temp_block->block->tuple_dict[m + n].size;
-                                                        address = tbl1_temp_block->block->tuple_dict[m + n].address;
-														
-                                                        memcpy(data1, &(tbl1_temp_block->block->data[address]), size);
-                                                        data1[size] = '\0';
-														
-                                                        AK_Insert_New_Element(type, data1, dstTable, tbl1_temp_block->block->header[n].att_name, row_root);
-                                                    }
-                                                    AK_insert_row(row_root);
-                                                    
-                        						    AK_DeleteAll_L3(&row_root);
-                                                    thesame=0;
-                                                }
-                                            }
-                                        }
-                                    }
-                                }
-                            } else break;
-                        }
-                    }
-                }
-        }
-
-        AK_free(src_addr1);
-        AK_free(src_addr2);
-		AK_free(tbl1_temp_block);
-		AK_free(tbl2_temp_block);
-		AK_free(row_root);
-		
-		AK_dbg_messg(LOW, REL_OP, "INTERSECT_TEST_SUCCESS\n\n");
-	
-		AK_EPI;
-		return EXIT_SUCCESS;
-		} 
+    result = AK_intersect_tables(srcTable1, srcTable2, dstTable, 0);
+    AK_EPI;
+    return result;
+}
 
-	else 
-	{
-        AK_dbg_messg(LOW, REL_OP, "\nAK_intersect: Table/s doesn't exist!");
-        AK_free(src_addr1);
-        AK_free(src_addr2);
-		
-		AK_EPI;
-		return EXIT_ERROR;
-    }
+int AK_intersect_all(char *srcTable1, char *srcTable2, char *dstTable) {
+    int result;
+    AK_PRO;
+    result = AK_intersect_tables(srcTable1, srcTable2, dstTable, 1);
     AK_EPI;
+    return result;
 }
 
 /**
- * @author Dino Laktašić
+ * @author Dino Laktašić, updated by agent
  * @brief  Function for intersect operator testing
  * @return No return value
  */
@@ -224,6 +103,26 @@ TestResult AK_op_intersect_test() {
 	    printf("\nTest failed!\n");
         failed++;
     }
+
+    //a table intersected with the union of itself with itself holds every row once, with ALL also once
+    if (AK_union_all(tblName1, tblName1, "intersect_test_twice") == EXIT_SUCCESS
+        && AK_intersect(tblName1, "intersect_test_twice", "intersect_test_distinct") == EXIT_SUCCESS
+        && AK_intersect_all("intersect_test_twice", tblName1, "intersect_test_all") == EXIT_SUCCESS
+        && AK_get_num_records("intersect_test_distinct") == AK_get_num_records(tblName1)
+        && AK_get_num_records("intersect_test_all") == AK_get_num_records(tblName1))
+        success++;
+    else
+        failed++;
+    printf("%s INTERSECT: %d rows, INTERSECT ALL: %d rows, %s has %d rows\n", tblName1, AK_get_num_records("intersect_test_distinct"),
+           AK_get_num_records("intersect_test_all"), tblName1, AK_get_num_records(tblName1));
+    AK_delete_segment("intersect_test_twice", SEGMENT_TYPE_TABLE);
+    AK_delete_segment("intersect_test_distinct", SEGMENT_TYPE_TABLE);
+    AK_delete_segment("intersect_test_all", SEGMENT_TYPE_TABLE);
+
+    //bags of years, in memory and partitioned
+    TestResult sets = AK_set_operation_test(AK_SET_INTERSECT);
+    success += sets.testSucceded;
+    failed += sets.testFailed;
     
     AK_EPI;
     return TEST_result(success,failed);
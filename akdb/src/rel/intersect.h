@@ -25,6 +25,8 @@
 #include "../rec/archive_log.h"
 #include "../auxi/mempro.h"
 #include "../sql/drop.h"
+#include "iterator.h"
+#include "union.h"
 
 /**
  * @author Dino Laktašić
@@ -39,15 +41,26 @@ typedef struct {
 } intersect_attr;
 
 /**
- * @author Dino Laktašić
- * @brief  Function that makes a intersect of the two tables. Intersect is implemented for working with multiple sets of data, i.e. duplicate 
-          tuples can be written in same table (intersect)
+ * @author Dino Laktašić, updated by agent (hash set operators)
+ * @brief  Function that makes a intersect of the two tables (INTERSECT). The rows of the second table are read into a
+ *         hash table, rows of the first table found in it are written once.
  * @param srcTable1 name of the first table
  * @param srcTable2 name of the second table
  * @param dstTable name of the new table
  * @return if success returns EXIT_SUCCESS, else returns EXIT_ERROR
  */
 int AK_intersect(char *srcTable1, char *srcTable2, char *dstTable);
+
+/**
+ * @author agent
+ * @brief  Function that makes a intersect of the two tables keeping duplicates (INTERSECT ALL): a row that is m times
+ *         in the first and n times in the second table is written min(m, n) times
+ * @param srcTable1 name of the first table
+ * @param srcTable2 name of the second table
+ * @param dstTable name of the new table
+ * @return if success returns EXIT_SUCCESS, else returns EXIT_ERROR
+ */
+int AK_intersect_all(char *srcTable1, char *srcTable2, char *dstTable);
 TestResult AK_op_intersect_test();
 
 #endif
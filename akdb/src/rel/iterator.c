@@ -0,0 +1,4578 @@
+/**
+@file iterator.c Provides the pipelined (iterator) executor. Relational operators are nodes of a plan which pull rows
+from their children with open/next/close, so a query runs without writing intermediate tables. Only sort, the inner
+input of a join and aggregation groups are held in memory.
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#include "iterator.h"
+
+/**
+ * @author agent
+ * @struct AK_scan_state
+ * @brief Position of a table scan
+ */
+typedef struct {
+    /// table name
+    char table[MAX_ATT_NAME];
+    /// extents of the table, read when the scan is opened
+    table_addresses *addresses;
+    /// current extent
+    int extent;
+    /// current block
+    int block;
+    /// next slot to read in the current block
+    int slot;
+} AK_scan_state;
+
+/**
+ * @author agent
+ * @struct AK_index_scan_state
+ * @brief Bounds and RIDs of an index scan. A B+tree index is scanned from the lower to the upper bound, a hash index
+ * is searched for the values of all its key attributes, compressed bitmap indexes for a value each.
+ */
+typedef struct {
+    /// table name
+    char table[MAX_ATT_NAME];
+    /// name of the index
+    char index[MAX_ATT_NAME];
+    /// 1 if there is a lower bound (0) or an upper bound (1)
+    int bounded[2];
+    /// data types of the bounds
+    int type[2];
+    /// sizes of the bounds
+    int size[2];
+    /// values of the bounds
+    char value[2][MAX_VARCHAR_LENGTH];
+    /// number of values searched in a hash index or compressed bitmap indexes
+    int keys;
+    /// data types of the searched values
+    int key_type[MAX_ATTRIBUTES];
+    /// sizes of the searched values
+    int key_size[MAX_ATTRIBUTES];
+    /// searched values
+    char key[MAX_ATTRIBUTES][MAX_VARCHAR_LENGTH];
+    /// compressed bitmap indexes searched for the values, one for every value
+    char bitmap[MAX_ATTRIBUTES][MAX_ATT_NAME];
+    /// RIDs found in the index, sorted by address
+    AK_rid *rids;
+    /// number of RIDs
+    int count;
+    /// next RID to read
+    int pos;
+} AK_index_scan_state;
+
+/**
+ * @author agent
+ * @struct AK_access_term
+ * @brief Comparison of an attribute with constants found in an expression
+ */
+typedef struct {
+    /// attribute ordinal
+    int column;
+    /// AK_EXPR_EQ, AK_EXPR_LT, AK_EXPR_GT, AK_EXPR_LE or AK_EXPR_GE
+    int comparison;
+    /// constant, the lower bound of BETWEEN
+    AK_expression_value *value;
+    /// upper bound of BETWEEN, NULL for other comparisons
+    AK_expression_value *high;
+    /// 1 if the expression can only be satisfied when the comparison is
+    int conjunct;
+} AK_access_term;
+
+/**
+ * @author agent
+ * @struct AK_select_state
+ * @brief Expression of a selection
+ */
+typedef struct {
+    /// list with postfix notation of the logical expression
+    struct list_node *expr;
+    /// expression compiled against the child header, from open to close
+    AK_expression_program *program;
+    /// batch of child rows if the expression is evaluated in batches, NULL otherwise
+    AK_batch *batch;
+    /// next selected row of the batch to produce
+    int pos;
+    /// number of selected rows of the batch
+    int selected;
+    /// 1 once the child has no more rows
+    int end;
+    /// rows selected by a parallel scan of the child table in table order, NULL if the child is read
+    struct AK_select_hit **hits;
+    /// number of rows in hits
+    int count;
+    /// size of the hits array
+    int capacity;
+} AK_select_state;
+
+/**
+ * @author agent
+ * @struct AK_select_hit
+ * @brief Row selected by a worker of a parallel selection and its position in the table
+ */
+typedef struct AK_select_hit {
+    /// block address
+    int address;
+    /// slot in the block
+    int slot;
+    /// selected row
+    AK_row *row;
+} AK_select_hit;
+
+/**
+ * @author agent
+ * @struct AK_select_partial
+ * @brief Partial result of a worker of a parallel selection
+ */
+typedef struct {
+    /// batch of copies of the rows of the worker, NULL if the expression is not evaluated in batches
+    AK_batch *batch;
+    /// memory of the copies in the batch, reset after every batch
+    AK_arena *rows;
+    /// block address of every row in the batch
+    int address[AK_BATCH_SIZE];
+    /// slot of every row in the batch
+    int slot[AK_BATCH_SIZE];
+    /// selected rows, kept in the memory of the worker
+    AK_select_hit **hits;
+    /// number of selected rows
+    int count;
+    /// size of the hits array
+    int capacity;
+} AK_select_partial;
+
+/**
+ * @author agent
+ * @struct AK_project_state
+ * @brief Source of every produced attribute of a projection
+ */
+typedef struct {
+    /// index of the copied child attribute, EXIT_ERROR for arithmetic attributes
+    int source[MAX_ATTRIBUTES];
+    /// left operand of an arithmetic attribute
+    int left[MAX_ATTRIBUTES];
+    /// right operand of an arithmetic attribute
+    int right[MAX_ATTRIBUTES];
+    /// arithmetic operator
+    char op[MAX_ATTRIBUTES];
+} AK_project_state;
+
+/**
+ * @author agent
+ * @struct AK_sort_state
+ * @brief Materialized and sorted input of a sort
+ */
+typedef struct {
+    /// child attributes to sort by
+    int key[MAX_ATTRIBUTES];
+    /// 1 for attributes sorted in descending order
+    int descending[MAX_ATTRIBUTES];
+    /// number of sort attributes
+    int num_keys;
+    /// rows kept in the node arena, for a top-N sort rows owned by the node
+    AK_row **rows;
+    /// number of rows
+    int count;
+    /// size of the rows array
+    int capacity;
+    /// next row to produce
+    int pos;
+    /// maximal number of produced rows, 0 for all rows
+    int limit;
+    /// input order of the rows of a top-N sort, it decides between equal rows
+    int *sequence;
+    /// bytes of rows sorted in memory before they are written into a run
+    size_t memory;
+    /// bytes of the rows in memory
+    size_t used;
+    /// temporary tables holding the sorted runs
+    char **run;
+    /// number of runs
+    int num_runs;
+    /// size of the run array
+    int run_capacity;
+    /// scans of the runs while they are merged, the rows in memory are the last source
+    AK_operator **sources;
+    /// heap of the sources with rows left, ordered by their current rows
+    int *heap;
+    /// number of sources in the heap
+    int heap_size;
+    /// source whose row was produced last, it moves to its next row on the next call
+    int last;
+} AK_sort_state;
+
+/**
+ * @author agent
+ * @struct AK_hash_entry
+ * @brief Row of the build input of a hash join, chained in its bucket
+ */
+typedef struct AK_hash_entry {
+    /// hash of the join attributes
+    unsigned int hash;
+    /// row kept in the node arena
+    AK_row *row;
+    /// next entry of the bucket
+    struct AK_hash_entry *next;
+} AK_hash_entry;
+
+/**
+ * @author agent
+ * @brief State of a hash join. The smaller input is read into a hash table, the other one probes it. If the build
+ * input does not fit into memory, both inputs are split by hash into temporary tables and the pairs of partitions
+ * are joined one after another.
+ */
+typedef struct {
+    /// join attributes in the left input
+    int left_key[MAX_ATTRIBUTES];
+    /// join attributes in the right input
+    int right_key[MAX_ATTRIBUTES];
+    /// number of join attributes
+    int num_keys;
+    /// left attributes that are copied to the result
+    int left_out[MAX_ATTRIBUTES];
+    /// number of copied left attributes
+    int num_left_out;
+    /// bytes of build rows kept in memory before the inputs are partitioned
+    size_t memory;
+    /// 1 if the hash table is built from the left input
+    int build_left;
+    /// entries of the build input, chained through next until the buckets are built
+    AK_hash_entry *entries;
+    /// number of entries
+    int num_entries;
+    /// bytes of the kept build rows
+    size_t used;
+    /// hash table, the number of buckets is a power of two
+    AK_hash_entry **buckets;
+    /// number of buckets minus one
+    unsigned int mask;
+    /// input that probes the hash table, a child or the scan of a probe partition
+    AK_operator *probe;
+    /// next entry to compare with the current probe row
+    AK_hash_entry *match;
+    /// hash of the current probe row
+    unsigned int probe_hash;
+    /// 1 while the current probe row is being joined
+    int have_probe;
+    /// number of partitions, 0 while the build input fits into memory
+    int partitions;
+    /// partition being joined
+    int partition;
+    /// temporary tables of the partitions, [0] build and [1] probe
+    char spill[2][AK_HASH_JOIN_PARTITIONS][MAX_ATT_NAME];
+} AK_join_state;
+
+/**
+ * @author agent
+ * @struct AK_band_join_state
+ * @brief State of a band join, the inputs are kept sorted in the node arena
+ */
+typedef struct {
+    /// 1 if the left input holds the points
+    int point_left;
+    /// point attribute
+    int point;
+    /// lower bound in the interval input, EXIT_ERROR if there is none
+    int low;
+    /// AK_EXPR_LT or AK_EXPR_LE
+    int low_comparison;
+    /// upper bound in the interval input, EXIT_ERROR if there is none
+    int high;
+    /// AK_EXPR_LT or AK_EXPR_LE
+    int high_comparison;
+    /// rows of the point input sorted by the point attribute
+    AK_sort_state points;
+    /// rows of the interval input sorted by the lower bound, pos is the current interval
+    AK_sort_state intervals;
+    /// first point that is not below the lower bound of the current interval
+    int begin;
+    /// next point of the window of the current interval, EXIT_ERROR before the window is found
+    int current;
+} AK_band_join_state;
+
+/**
+ * @author agent
+ * @struct AK_iterator_group
+ * @brief One group of an aggregation
+ */
+typedef struct AK_iterator_group {
+    /// first row of the group, it holds the grouping values (NULL without grouping)
+    AK_row *first;
+    /// sum, minimum or maximum of every aggregated attribute
+    double value[MAX_ATTRIBUTES];
+    /// number of aggregated values of every attribute
+    int count[MAX_ATTRIBUTES];
+    /// hash of the grouping values
+    unsigned int hash;
+    /// next group of the bucket
+    struct AK_iterator_group *next;
+} AK_iterator_group;
+
+/**
+ * @author agent
+ * @struct AK_aggregation_state
+ * @brief Tasks and groups of an aggregation
+ */
+typedef struct {
+    /// child attribute of every task
+    int source[MAX_ATTRIBUTES];
+    /// aggregation task of every produced attribute
+    int task[MAX_ATTRIBUTES];
+    /// number of grouping attributes
+    int num_group;
+    /// child attributes of the grouping attributes
+    int group_key[MAX_ATTRIBUTES];
+    /// groups in order of their first row, kept in the node arena
+    AK_iterator_group **groups;
+    /// number of groups
+    int count;
+    /// size of the groups array
+    int capacity;
+    /// next group to produce
+    int pos;
+    /// hash table of the groups, the number of buckets is a power of two
+    AK_iterator_group **buckets;
+    /// number of buckets minus one
+    unsigned int mask;
+    /// bytes of the groups in memory
+    size_t used;
+    /// bytes of groups kept in memory before rows of further groups are partitioned
+    size_t memory;
+    /// number of partitions, 0 while all groups fit into memory
+    int partitions;
+    /// partition whose groups are produced, EXIT_ERROR while the groups in memory are produced
+    int partition;
+    /// temporary tables of the partitions
+    char spill[AK_AGGREGATION_PARTITIONS][MAX_ATT_NAME];
+    /// 1 if rows are aggregated in batches: there is no grouping and all aggregated attributes are numeric
+    int batched;
+    /// values of the rows of the current batch for every child attribute that is summed, minimized or maximized
+    double *numbers[MAX_ATTRIBUTES];
+    /// number of rows in the current batch
+    int batch_rows;
+} AK_aggregation_state;
+
+/**
+ * @author agent
+ * @struct AK_aggregation_partial
+ * @brief Partial result of a worker of a parallel aggregation without grouping
+ */
+typedef struct {
+    /// aggregates of the rows of the worker
+    AK_iterator_group group;
+    /// values of the rows of the current batch of the worker for every child attribute
+    double number[MAX_ATTRIBUTES][AK_BATCH_SIZE];
+    /// number of rows in the current batch
+    int rows;
+} AK_aggregation_partial;
+
+/**
+ * @author agent
+ * @struct AK_set_entry
+ * @brief Distinct row in the hash table of a set operation
+ */
+typedef struct AK_set_entry {
+    /// hash of all values of the row
+    unsigned int hash;
+    /// row kept in the node arena
+    AK_row *row;
+    /// copies of the row in the right input that are not matched yet, 0 for rows that only the left input has
+    int count;
+    /// next entry of the bucket
+    struct AK_set_entry *next;
+} AK_set_entry;
+
+/**
+ * @author agent
+ * @struct AK_set_state
+ * @brief State of a set operation. Intersection and difference read the right input into a hash table and stream the
+ * left input; if the right input does not fit into memory, both inputs are split by hash into temporary tables and the
+ * pairs of partitions are processed one after another. A distinct union streams both inputs and keeps the rows it
+ * produced; once they do not fit into memory, new rows go to the partitions, which are processed afterwards.
+ */
+typedef struct {
+    /// AK_SET_UNION, AK_SET_INTERSECT or AK_SET_DIFFERENCE
+    int operation;
+    /// 1 if duplicates are kept (ALL), 0 if every row is produced once
+    int all;
+    /// positions of all attributes, rows are compared on all of them
+    int key[MAX_ATTRIBUTES];
+    /// hash table, the number of buckets is a power of two
+    AK_set_entry **buckets;
+    /// number of buckets minus one
+    unsigned int mask;
+    /// number of entries
+    int count;
+    /// bytes of the entries in memory
+    size_t used;
+    /// bytes of entries kept in memory before the inputs are partitioned
+    size_t memory;
+    /// input whose rows are streamed: a child or scan
+    AK_operator *input;
+    /// scan of the partition being streamed
+    AK_operator *scan;
+    /// number of partitions, 0 while the entries fit into memory
+    int partitions;
+    /// partition being streamed, EXIT_ERROR while the children are streamed
+    int partition;
+    /// temporary tables of the partitions, [0] rows of the hash table and [1] streamed rows
+    char spill[2][AK_SET_PARTITIONS][MAX_ATT_NAME];
+} AK_set_state;
+
+int AK_iterator_attr_index(AK_header *header, int num_attr, char *attribute)
+{
+    int i;
+    AK_PRO;
+    for (i = 0; i < num_attr; i++)
+        if (strcmp(header[i].att_name, attribute) == 0)
+        {
+            AK_EPI;
+            return i;
+        }
+    AK_EPI;
+    return EXIT_ERROR;
+}
+
+/**
+ * @author agent
+ * @brief  Function that allocates a node. The header is copied, children become owned by the node; if the node can not
+ * be allocated the children are freed.
+ * @param header header of the produced rows
+ * @param num_attr number of attributes in header
+ * @param child input node
+ * @param right second input node
+ * @param state_size size of the private state
+ * @param own_row 1 if the node builds its own rows
+ * @return new node, NULL on error
+ */
+static AK_operator *AK_operator_create(AK_header *header, int num_attr, AK_operator *child, AK_operator *right, size_t state_size, int own_row)
+{
+    AK_operator *op;
+    AK_PRO;
+    if (num_attr <= 0 || num_attr > MAX_ATTRIBUTES)
+    {
+        printf("AK_operator_create: ERROR. A node can not have %d attributes.\n", num_attr);
+        AK_operator_free(child);
+        AK_operator_free(right);
+        AK_EPI;
+        return NULL;
+    }
+    op = (AK_operator *)AK_calloc(1, sizeof(AK_operator));
+    if (op == NULL)
+    {
+        AK_operator_free(child);
+        AK_operator_free(right);
+        AK_EPI;
+        return NULL;
+    }
+    op->child = child;
+    op->right = right;
+    op->num_attr = num_attr;
+    op->header = (AK_header *)AK_calloc(MAX_ATTRIBUTES + 1, sizeof(AK_header));
+    if (op->header != NULL)
+        memcpy(op->header, header, num_attr * sizeof(AK_header));
+    if (state_size > 0)
+        op->state = AK_calloc(1, state_size);
+    if (own_row && op->header != NULL)
+        op->buffer = AK_row_new(op->header, num_attr);
+    op->scratch = AK_arena_create(0);
+    op->row = op->buffer;
+
+    if (op->header == NULL || (state_size > 0 && op->state == NULL) || (own_row && op->buffer == NULL) || op->scratch == NULL)
+    {
+        AK_operator_free(op);
+        AK_EPI;
+        return NULL;
+    }
+    AK_EPI;
+    return op;
+}
+
+/**
+ * @author agent
+ * @brief  Function that copies a row into an arena, so it outlives the next call of next of the node it came from
+ * @param arena arena receiving the copy
+ * @param row row to copy
+ * @param header header of the copy
+ * @return copy of the row, NULL if it can not be allocated
+ */
+static AK_row *AK_iterator_keep_row(AK_arena *arena, AK_row *row, AK_header *header)
+{
+    AK_row *copy;
+    int used;
+    AK_PRO;
+    used = row->offset[row->count];
+    copy = (AK_row *)AK_arena_alloc(arena, sizeof(AK_row) + sizeof(int) * (2 * row->count + 1) + used);
+    if (copy == NULL)
+    {
+        AK_EPI;
+        return NULL;
+    }
+    copy->header = header;
+    copy->num_attr = row->count;
+    copy->count = row->count;
+    copy->capacity = used;
+    copy->type = (int *)(copy + 1);
+    copy->offset = copy->type + row->count;
+    copy->data = (char *)(copy->offset + row->count + 1);
+    memcpy(copy->type, row->type, sizeof(int) * row->count);
+    memcpy(copy->offset, row->offset, sizeof(int) * (row->count + 1));
+    memcpy(copy->data, row->data, used);
+    AK_EPI;
+    return copy;
+}
+
+/**
+ * @author agent
+ * @brief  Function that appends an item to a growing array of pointers
+ * @param items array, reallocated when it is full
+ * @param count number of items in the array
+ * @param capacity size of the array
+ * @param item item to append
+ * @return EXIT_SUCCESS, EXIT_ERROR if the array can not grow
+ */
+static int AK_iterator_push(void ***items, int *count, int *capacity, void *item)
+{
+    void **grown;
+    AK_PRO;
+    if (item == NULL)
+    {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    if (*count == *capacity)
+    {
+        grown = (void **)AK_realloc(*items, sizeof(void *) * (*capacity > 0 ? 2 * *capacity : 64));
+        if (grown == NULL)
+        {
+            AK_EPI;
+            return EXIT_ERROR;
+        }
+        *items = grown;
+        *capacity = *capacity > 0 ? 2 * *capacity : 64;
+    }
+    (*items)[(*count)++] = item;
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+double AK_iterator_number(AK_row *row, int i)
+{
+    char text[MAX_VARCHAR_LENGTH];
+    char *value;
+    int type, size, int_value = 0;
+    float float_value = 0;
+    double double_value = 0;
+    AK_PRO;
+    value = AK_row_get(row, i, &type, &size);
+    if (value == NULL)
+    {
+        AK_EPI;
+        return 0;
+    }
+    switch (type)
+    {
+    case TYPE_INT:
+        memcpy(&int_value, value, size < sizeof(int) ? size : sizeof(int));
+        double_value = int_value;
+        break;
+    case TYPE_FLOAT:
+        memcpy(&float_value, value, size < sizeof(float) ? size : sizeof(float));
+        double_value = float_value;
+        break;
+    case TYPE_NUMBER:
+        memcpy(&double_value, value, size < sizeof(double) ? size : sizeof(double));
+        break;
+    default:
+        if (size >= MAX_VARCHAR_LENGTH)
+            size = MAX_VARCHAR_LENGTH - 1;
+        memcpy(text, value, size);
+        text[size] = '\0';
+        double_value = strtod(text, NULL);
+    }
+    AK_EPI;
+    return double_value;
+}
+
+/**
+ * @author agent
+ * @brief  Function that appends a number to a row, stored as the given numeric type
+ * @param row row
+ * @param type TYPE_INT, TYPE_FLOAT or TYPE_NUMBER
+ * @param value value
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_iterator_append_number(AK_row *row, int type, double value)
+{
+    int int_value, result;
+    float float_value;
+    AK_PRO;
+    switch (type)
+    {
+    case TYPE_INT:
+        int_value = (int)value;
+        result = AK_row_append(row, type, (char *)&int_value, sizeof(int));
+        break;
+    case TYPE_FLOAT:
+        float_value = (float)value;
+        result = AK_row_append(row, type, (char *)&float_value, sizeof(float));
+        break;
+    default:
+        result = AK_row_append(row, TYPE_NUMBER, (char *)&value, sizeof(double));
+    }
+    AK_EPI;
+    return result;
+}
+
+int AK_iterator_compare_values(AK_row *a, int i, AK_row *b, int j)
+{
+    char *x, *y;
+    int x_type, y_type, x_size, y_size, result;
+    double x_number, y_number;
+    AK_PRO;
+    x = AK_row_get(a, i, &x_type, &x_size);
+    y = AK_row_get(b, j, &y_type, &y_size);
+    if (x == NULL || y == NULL)
+    {
+        AK_EPI;
+        return (x != NULL) - (y != NULL);
+    }
+    if ((x_type == TYPE_INT || x_type == TYPE_FLOAT || x_type == TYPE_NUMBER)
+        && (y_type == TYPE_INT || y_type == TYPE_FLOAT || y_type == TYPE_NUMBER))
+    {
+        x_number = AK_iterator_number(a, i);
+        y_number = AK_iterator_number(b, j);
+        AK_EPI;
+        return (x_number > y_number) - (x_number < y_number);
+    }
+    result = memcmp(x, y, x_size < y_size ? x_size : y_size);
+    if (result == 0)
+        result = x_size - y_size;
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @author agent
+ * @brief  Function that returns the bytes of a value that take part in comparisons: numbers as stored, other values up
+ * to their first zero byte
+ * @param row row
+ * @param i index of the value
+ * @param size receives the number of bytes
+ * @return value, NULL if the row has no such value
+ */
+static char *AK_iterator_key_value(AK_row *row, int i, int *size)
+{
+    int type;
+    char *value = AK_row_get(row, i, &type, size);
+    if (value != NULL && type != TYPE_INT && type != TYPE_FLOAT && type != TYPE_NUMBER)
+        *size = strnlen(value, *size);
+    return value;
+}
+
+/**
+ * @author agent
+ * @brief  Function that checks whether two rows have the same values in the given attributes
+ * @param a first row
+ * @param a_key attributes of the first row
+ * @param b second row
+ * @param b_key attributes of the second row
+ * @param num_keys number of attributes to compare
+ * @return 1 if all values are equal, 0 otherwise
+ */
+static int AK_iterator_keys_equal(AK_row *a, int *a_key, AK_row *b, int *b_key, int num_keys)
+{
+    char *x, *y;
+    int i, x_size, y_size;
+    for (i = 0; i < num_keys; i++)
+    {
+        x = AK_iterator_key_value(a, a_key[i], &x_size);
+        y = AK_iterator_key_value(b, b_key[i], &y_size);
+        if (x == NULL || y == NULL || x_size != y_size || memcmp(x, y, x_size) != 0)
+            return 0;
+    }
+    return 1;
+}
+
+/**
+ * @author agent
+ * @brief  Function that hashes the values of the given attributes (FNV-1a), rows with equal keys get equal hashes
+ * @param row row
+ * @param key attributes to hash
+ * @param num_keys number of attributes
+ * @return hash value
+ */
+static unsigned int AK_iterator_hash_keys(AK_row *row, int *key, int num_keys)
+{
+    unsigned int hash = 2166136261u;
+    unsigned char *value;
+    int i, j, size;
+    for (i = 0; i < num_keys; i++)
+    {
+        value = (unsigned char *)AK_iterator_key_value(row, key[i], &size);
+        for (j = 0; value != NULL && j < size; j++)
+            hash = (hash ^ value[j]) * 16777619u;
+        hash = (hash ^ 0xff) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @author agent
+ * @brief  Function that opens a scan, it reads the extents of the table
+ * @param op scan node
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_scan_open(AK_operator *op)
+{
+    AK_scan_state *state = (AK_scan_state *)op->state;
+    AK_PRO;
+    state->addresses = (table_addresses *)AK_get_table_addresses(state->table);
+    if (state->addresses == NULL)
+    {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    state->extent = 0;
+    state->block = state->addresses->address_from[0];
+    state->slot = 0;
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @author agent
+ * @brief  Function that reads the next live slot of a table into the row of the scan. The block is fetched from the
+ * cache on every call, so a block evicted while the parents worked on the previous row is read again.
+ * @param op scan node
+ * @return AK_ITERATOR_ROW or AK_ITERATOR_END
+ */
+static int AK_scan_next(AK_operator *op)
+{
+    AK_scan_state *state = (AK_scan_state *)op->state;
+    AK_block *block;
+    AK_PRO;
+    while (state->addresses->address_from[state->extent] != 0)
+    {
+        if (state->block >= state->addresses->address_to[state->extent])
+        {
+            state->extent++;
+            state->block = state->addresses->address_from[state->extent];
+            state->slot = 0;
+            continue;
+        }
+        block = ((AK_mem_block *)AK_get_block(state->block))->block;
+        //a block holding one row of one attribute has last_tuple_dict_id 0 too
+        if (block->last_tuple_dict_id != 0 || block->tuple_dict[0].type != FREE_INT)
+        {
+            while ((state->slot + 1) * op->num_attr <= DATA_BLOCK_SIZE && block->tuple_dict[state->slot * op->num_attr].type != FREE_INT)
+                if (AK_row_from_slot(op->buffer, block, state->slot++) == EXIT_SUCCESS)
+                {
+                    AK_EPI;
+                    return AK_ITERATOR_ROW;
+                }
+        }
+        state->block++;
+        state->slot = 0;
+    }
+    AK_EPI;
+    return AK_ITERATOR_END;
+}
+
+/**
+ * @author agent
+ * @brief  Function that closes a scan
+ * @param op scan node
+ */
+static void AK_scan_close(AK_operator *op)
+{
+    AK_scan_state *state = (AK_scan_state *)op->state;
+    AK_PRO;
+    AK_free(state->addresses);
+    state->addresses = NULL;
+    AK_EPI;
+}
+
+AK_operator *AK_scan_operator(char *table)
+{
+    AK_operator *op;
+    AK_header *header;
+    int num_attr = 0;
+    AK_PRO;
+    header = AK_catalog_get_header(table, &num_attr);
+    if (header == NULL)
+    {
+        printf("AK_scan_operator: ERROR. Table %s does not exist.\n", table);
+        AK_EPI;
+        return NULL;
+    }
+    op = AK_operator_create(header, num_attr, NULL, NULL, sizeof(AK_scan_state), 1);
+    AK_free(header);
+    if (op == NULL)
+    {
+        AK_EPI;
+        return NULL;
+    }
+    strncpy(((AK_scan_state *)op->state)->table, table, MAX_ATT_NAME - 1);
+    op->open = AK_scan_open;
+    op->next = AK_scan_next;
+    op->close = AK_scan_close;
+    AK_EPI;
+    return op;
+}
+
+/**
+ * @author agent
+ * @brief  Function that orders RIDs by block and slot
+ * @param a first RID
+ * @param b second RID
+ * @return negative, 0 or positive
+ */
+static int AK_index_scan_compare(const void *a, const void *b)
+{
+    const AK_rid *x = (const AK_rid *)a, *y = (const AK_rid *)b;
+    if (x->block != y->block)
+        return x->block < y->block ? -1 : 1;
+    return x->slot - y->slot;
+}
+
+/**
+ * @author agent
+ * @brief  Function that opens an index scan: it reads the RIDs of the range from the index and sorts them
+ * @param op index scan node
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_index_scan_open(AK_operator *op)
+{
+    AK_index_scan_state *state = (AK_index_scan_state *)op->state;
+    struct list_node *bound[2] = {NULL, NULL};
+    AK_btree_cursor *cursor;
+    AK_rid *rid, *grown;
+    int i, capacity = 0, result = EXIT_SUCCESS;
+    AK_PRO;
+    for (i = 0; i < 2; i++)
+        if (state->bounded[i])
+        {
+            bound[i] = (struct list_node *)AK_malloc(sizeof(struct list_node));
+            AK_Init_L3(&bound[i]);
+            AK_InsertAtEnd_L3(state->type[i], state->value[i], state->size[i], bound[i]);
+        }
+    cursor = AK_btree_open(state->index, bound[0], bound[1]);
+    for (i = 0; i < 2; i++)
+        if (bound[i] != NULL)
+        {
+            AK_DeleteAll_L3(&bound[i]);
+            AK_free(bound[i]);
+        }
+    if (cursor == NULL)
+    {
+        printf("AK_index_scan_open: ERROR. Index %s can not be read.\n", state->index);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    state->count = state->pos = 0;
+    while (result == EXIT_SUCCESS && (rid = AK_btree_next(cursor)) != NULL)
+    {
+        if (state->count == capacity)
+        {
+            capacity = capacity == 0 ? 64 : 2 * capacity;
+            grown = (AK_rid *)AK_realloc(state->rids, capacity * sizeof(AK_rid));
+            if (grown == NULL)
+            {
+                result = EXIT_ERROR;
+                break;
+            }
+            state->rids = grown;
+        }
+        state->rids[state->count++] = *rid;
+    }
+    AK_btree_close(cursor);
+    if (state->count > 1)
+        qsort(state->rids, state->count, sizeof(AK_rid), AK_index_scan_compare);
+    AK_dbg_messg(MIDDLE, REL_OP, "AK_index_scan_open: %d rows of %s found by index %s\n", state->count, state->table, state->index);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @author agent
+ * @brief  Function that reads the row of the next RID of an index scan. RIDs of slots that hold no row are skipped.
+ * @param op index scan node
+ * @return AK_ITERATOR_ROW or AK_ITERATOR_END
+ */
+static int AK_index_scan_next(AK_operator *op)
+{
+    AK_index_scan_state *state = (AK_index_scan_state *)op->state;
+    AK_rid *rid;
+    AK_PRO;
+    while (state->pos < state->count)
+    {
+        rid = &state->rids[state->pos++];
+        if (rid->slot < 0 || (rid->slot + 1) * op->num_attr > DATA_BLOCK_SIZE)
+            continue;
+        if (AK_row_from_slot(op->buffer, ((AK_mem_block *)AK_get_block(rid->block))->block, rid->slot) == EXIT_SUCCESS)
+        {
+            AK_EPI;
+            return AK_ITERATOR_ROW;
+        }
+    }
+    AK_EPI;
+    return AK_ITERATOR_END;
+}
+
+/**
+ * @author agent
+ * @brief  Function that closes an index scan
+ * @param op index scan node
+ */
+static void AK_index_scan_close(AK_operator *op)
+{
+    AK_index_scan_state *state = (AK_index_scan_state *)op->state;
+    AK_PRO;
+    AK_free(state->rids);
+    state->rids = NULL;
+    state->count = state->pos = 0;
+    AK_EPI;
+}
+
+AK_operator *AK_index_scan_operator(char *table, char *index, struct list_node *low, struct list_node *high)
+{
+    AK_operator *op;
+    AK_index_scan_state *state;
+    AK_header *header;
+    struct list_node *bound;
+    int num_attr = 0, i;
+    AK_PRO;
+    header = AK_catalog_get_header(table, &num_attr);
+    if (header == NULL)
+    {
+        printf("AK_index_scan_operator: ERROR. Table %s does not exist.\n", table);
+        AK_EPI;
+        return NULL;
+    }
+    op = AK_operator_create(header, num_attr, NULL, NULL, sizeof(AK_index_scan_state), 1);
+    AK_free(header);
+    if (op == NULL)
+    {
+        AK_EPI;
+        return NULL;
+    }
+    state = (AK_index_scan_state *)op->state;
+    strncpy(state->table, table, MAX_ATT_NAME - 1);
+    strncpy(state->index, index, MAX_ATT_NAME - 1);
+    for (i = 0; i < 2; i++)
+    {
+        bound = i == 0 ? low : high;
+        bound = bound == NULL ? NULL : (struct list_node *)AK_First_L2(bound);
+        if (bound == NULL)
+            continue;
+        state->bounded[i] = 1;
+        state->type[i] = bound->type;
+        state->size[i] = bound->size < MAX_VARCHAR_LENGTH ? bound->size : MAX_VARCHAR_LENGTH;
+        memcpy(state->value[i], bound->data, state->size[i]);
+    }
+    op->open = AK_index_scan_open;
+    op->next = AK_index_scan_next;
+    op->close = AK_index_scan_close;
+    AK_EPI;
+    return op;
+}
+
+/**
+ * @author agent
+ * @brief  Function that opens a hash index scan: it reads the RIDs of the rows with the searched values from the index
+ * and sorts them
+ * @param op index scan node
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_hash_scan_open(AK_operator *op)
+{
+    AK_index_scan_state *state = (AK_index_scan_state *)op->state;
+    AK_hash_meta meta;
+    struct list_node *key;
+    int i;
+    AK_PRO;
+    if (AK_hash_get_meta(state->index, &meta) == EXIT_ERROR)
+    {
+        printf("AK_hash_scan_open: ERROR. Index %s can not be read.\n", state->index);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    key = (struct list_node *)AK_malloc(sizeof(struct list_node));
+    AK_Init_L3(&key);
+    for (i = 0; i < state->keys; i++)
+        AK_InsertAtEnd_L3(state->key_type[i], state->key[i], state->key_size[i], key);
+    state->pos = 0;
+    state->rids = AK_hash_find(state->index, key, &state->count);
+    AK_DeleteAll_L3(&key);
+    AK_free(key);
+    if (state->count > 1)
+        qsort(state->rids, state->count, sizeof(AK_rid), AK_index_scan_compare);
+    AK_dbg_messg(MIDDLE, REL_OP, "AK_hash_scan_open: %d rows of %s found by index %s\n", state->count, state->table, state->index);
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+AK_operator *AK_hash_scan_operator(char *table, char *index, struct list_node *key)
+{
+    AK_operator *op;
+    AK_index_scan_state *state;
+    AK_header *header;
+    struct list_node *value;
+    int num_attr = 0;
+    AK_PRO;
+    header = AK_catalog_get_header(table, &num_attr);
+    if (header == NULL)
+    {
+        printf("AK_hash_scan_operator: ERROR. Table %s does not exist.\n", table);
+        AK_EPI;
+        return NULL;
+    }
+    op = AK_operator_create(header, num_attr, NULL, NULL, sizeof(AK_index_scan_state), 1);
+    AK_free(header);
+    if (op == NULL)
+    {
+        AK_EPI;
+        return NULL;
+    }
+    state = (AK_index_scan_state *)op->state;
+    strncpy(state->table, table, MAX_ATT_NAME - 1);
+    strncpy(state->index, index, MAX_ATT_NAME - 1);
+    for (value = key == NULL ? NULL : (struct list_node *)AK_First_L2(key); value != NULL && state->keys < MAX_ATTRIBUTES;
+         value = (struct list_node *)AK_Next_L2(value), state->keys++)
+    {
+        state->key_type[state->keys] = value->type;
+        state->key_size[state->keys] = value->size < MAX_VARCHAR_LENGTH ? value->size : MAX_VARCHAR_LENGTH;
+        memcpy(state->key[state->keys], value->data, state->key_size[state->keys]);
+    }
+    op->open = AK_hash_scan_open;
+    op->next = AK_index_scan_next;
+    op->close = AK_index_scan_close;
+    AK_EPI;
+    return op;
+}
+
+/**
+ * @author agent
+ * @brief  Function that opens a compressed bitmap index scan: it intersects the bitmaps of the searched values and
+ * reads the RIDs of the result, which come in table order
+ * @param op index scan node
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_roaring_scan_open(AK_operator *op)
+{
+    AK_index_scan_state *state = (AK_index_scan_state *)op->state;
+    AK_roaring *result = NULL, *bitmap, *both;
+    int i;
+    AK_PRO;
+    for (i = 0; i < state->keys; i++)
+    {
+        bitmap = AK_roaring_get(state->bitmap[i], state->key_type[i], state->key[i], state->key_size[i]);
+        if (bitmap == NULL)
+        {
+            printf("AK_roaring_scan_open: ERROR. Index %s can not be read.\n", state->bitmap[i]);
+            AK_roaring_free(result);
+            AK_EPI;
+            return EXIT_ERROR;
+        }
+        if (result == NULL)
+            result = bitmap;
+        else
+        {
+            both = AK_roaring_and(result, bitmap);
+            AK_roaring_free(result);
+            AK_roaring_free(bitmap);
+            result = both;
+        }
+    }
+    state->pos = 0;
+    state->rids = AK_roaring_rids(result, &state->count);
+    AK_roaring_free(result);
+    AK_dbg_messg(MIDDLE, REL_OP, "AK_roaring_scan_open: %d rows of %s found by %d bitmaps\n", state->count, state->table, state->keys);
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+AK_operator *AK_roaring_scan_operator(char *table, struct list_node *indexes, struct list_node *values)
+{
+    AK_operator *op;
+    AK_index_scan_state *state;
+    AK_header *header;
+    struct list_node *index, *value;
+    int num_attr = 0, size;
+    AK_PRO;
+    header = AK_catalog_get_header(table, &num_attr);
+    if (header == NULL)
+    {
+        printf("AK_roaring_scan_operator: ERROR. Table %s does not exist.\n", table);
+        AK_EPI;
+        return NULL;
+    }
+    op = AK_operator_create(header, num_attr, NULL, NULL, sizeof(AK_index_scan_state), 1);
+    AK_free(header);
+    if (op == NULL)
+    {
+        AK_EPI;
+        return NULL;
+    }
+    state = (AK_index_scan_state *)op->state;
+    strncpy(state->table, table, MAX_ATT_NAME - 1);
+    index = indexes == NULL ? NULL : (struct list_node *)AK_First_L2(indexes);
+    value = values == NULL ? NULL : (struct list_node *)AK_First_L2(values);
+    for (; index != NULL && value != NULL && state->keys < MAX_ATTRIBUTES;
+         index = (struct list_node *)AK_Next_L2(index), value = (struct list_node *)AK_Next_L2(value), state->keys++)
+    {
+        size = index->size < MAX_ATT_NAME - 1 ? index->size : MAX_ATT_NAME - 1;
+        memcpy(state->bitmap[state->keys], index->data, size);
+        state->key_type[state->keys] = value->type;
+        state->key_size[state->keys] = value->size < MAX_VARCHAR_LENGTH ? value->size : MAX_VARCHAR_LENGTH;
+        memcpy(state->key[state->keys], value->data, state->key_size[state->keys]);
+    }
+    op->open = AK_roaring_scan_open;
+    op->next = AK_index_scan_next;
+    op->close = AK_index_scan_close;
+    AK_EPI;
+    return op;
+}
+
+/**
+ * @author agent
+ * @brief  Function that finds the comparisons of attributes with constants in a compiled expression. The program is
+ * run on descriptions of its values instead of rows: a comparison below an OR is not a conjunct of the expression.
+ * @param program compiled expression
+ * @param terms receives the comparisons, program->length entries
+ * @return number of comparisons, 0 if the expression is interpreted
+ */
+static int AK_access_terms(AK_expression_program *program, AK_access_term *terms)
+{
+    AK_expression_instruction *instruction;
+    //attribute ordinal or EXIT_ERROR, constant or NULL and the first comparison below every value of the stack
+    int column[AK_EXPRESSION_STACK_SIZE], from[AK_EXPRESSION_STACK_SIZE];
+    AK_expression_value *constant[AK_EXPRESSION_STACK_SIZE];
+    int pc, top = 0, count = 0, a, b, c, i, comparison;
+    AK_PRO;
+    if (program == NULL || program->interpreted)
+    {
+        AK_EPI;
+        return 0;
+    }
+    for (pc = 0; pc < program->length; pc++)
+    {
+        instruction = &program->code[pc];
+        switch (instruction->opcode)
+        {
+            case AK_EXPR_COLUMN:
+            case AK_EXPR_CONSTANT:
+                column[top] = instruction->opcode == AK_EXPR_COLUMN ? instruction->column : EXIT_ERROR;
+                constant[top] = instruction->opcode == AK_EXPR_CONSTANT ? &instruction->value : NULL;
+                from[top++] = count;
+                continue;
+            case AK_EXPR_COMPARE:
+                top -= 2;
+                a = top, b = top + 1;
+                comparison = instruction->comparison;
+                //a constant on the left turns the comparison around
+                if (column[a] == EXIT_ERROR && column[b] != EXIT_ERROR)
+                {
+                    a = top + 1, b = top;
+                    comparison = comparison == AK_EXPR_LT ? AK_EXPR_GT : comparison == AK_EXPR_GT ? AK_EXPR_LT
+                                 : comparison == AK_EXPR_LE ? AK_EXPR_GE : comparison == AK_EXPR_GE ? AK_EXPR_LE : comparison;
+                }
+                if (column[a] != EXIT_ERROR && constant[b] != NULL && comparison != AK_EXPR_NE)
+                {
+                    terms[count].column = column[a];
+                    terms[count].comparison = comparison;
+                    terms[count].value = constant[b];
+                    terms[count].high = NULL;
+                    terms[count++].conjunct = 1;
+                }
+                break;
+            case AK_EXPR_BETWEEN:
+                top -= 3;
+                a = top, b = top + 1, c = top + 2;
+                if (column[a] != EXIT_ERROR && constant[b] != NULL && constant[c] != NULL)
+                {
+                    terms[count].column = column[a];
+                    terms[count].comparison = AK_EXPR_GE;
+                    terms[count].value = constant[b];
+                    terms[count].high = constant[c];
+                    terms[count++].conjunct = 1;
+                }
+                break;
+            case AK_EXPR_ANY:
+            case AK_EXPR_ALL:
+            case AK_EXPR_MATCH:
+                top--;
+                break;
+            case AK_EXPR_AND:
+                top -= 2;
+                break;
+            case AK_EXPR_OR:
+                top -= 2;
+                for (i = from[top]; i < count; i++)
+                    terms[i].conjunct = 0;
+                break;
+        }
+        //a result replaces its operands on the stack, the comparisons below it start at those of its first operand
+        column[top] = EXIT_ERROR;
+        constant[top] = NULL;
+        top++;
+    }
+    AK_EPI;
+    return count;
+}
+
+/**
+ * @author agent
+ * @brief  Function that checks whether a constant compared with an attribute can bound a scan of an index on it: the
+ * expression has to order values as the index does, which holds for numbers of the attribute type and for strings
+ * @param type type of the attribute
+ * @param value constant
+ * @return 1 if it can, 0 otherwise
+ */
+static int AK_access_bound(int type, AK_expression_value *value)
+{
+    if (type == TYPE_INT || type == TYPE_VARCHAR)
+        return value->type == type;
+    if (type == TYPE_FLOAT || type == TYPE_NUMBER)
+        return value->type == TYPE_FLOAT || value->type == TYPE_NUMBER;
+    return 0;
+}
+
+AK_operator *AK_access_operator(char *table, struct list_node *expr)
+{
+    AK_header *header;
+    AK_expression_program *program;
+    AK_access_term *terms;
+    AK_expression_value *bound[2], *best_bound[2], *key[MAX_ATTRIBUTES], *best_key[MAX_ATTRIBUTES];
+    AK_btree_meta meta;
+    AK_hash_meta hash_meta;
+    AK_roaring_meta roaring_meta;
+    AK_expression_value *bitmap_key[MAX_ATTRIBUTES];
+    AK_cursor *catalog;
+    AK_operator *op;
+    struct list_node *row, *name, *list[2];
+    char index[MAX_ATT_NAME], best[MAX_ATT_NAME] = "", bitmap[MAX_ATTRIBUTES][MAX_ATT_NAME];
+    int num_attr = 0, count, i, t, rank, best_rank = 0, best_keys = 0, bitmaps = 0, size;
+    int bitmap_column[MAX_ATTRIBUTES];
+    AK_PRO;
+    header = expr == NULL ? NULL : AK_catalog_get_header(table, &num_attr);
+    program = header == NULL ? NULL : AK_expression_compile(expr, header, num_attr);
+    terms = program == NULL || program->interpreted ? NULL : (AK_access_term *)AK_calloc(program->length, sizeof(AK_access_term));
+    count = terms == NULL ? 0 : AK_access_terms(program, terms);
+
+    //every B+tree index of the table whose first attribute is compared with a constant is a candidate, every hash
+    //index whose attributes are all equal to constants and every compressed bitmap index whose attribute is equal to one
+    catalog = count > 0 ? AK_cursor_open("AK_index") : NULL;
+    while (catalog != NULL && (row = AK_cursor_next(catalog)) != NULL)
+    {
+        name = AK_GetNth_L2(2, row);
+        if (name == NULL || name->type != TYPE_VARCHAR)
+            continue;
+        size = name->size < MAX_ATT_NAME - 1 ? name->size : MAX_ATT_NAME - 1;
+        memcpy(index, name->data, size);
+        index[size] = '\0';
+        if (strcmp(index, best) == 0)
+            continue;
+        if (AK_hash_get_meta(index, &hash_meta) == EXIT_SUCCESS)
+        {
+            if (strcmp(hash_meta.table, table) != 0)
+                continue;
+            for (i = 0; i < hash_meta.attributes; i++)
+            {
+                for (t = 0; t < count; t++)
+                    if (terms[t].conjunct && terms[t].comparison == AK_EXPR_EQ && terms[t].column == hash_meta.position[i]
+                        && AK_access_bound(header[terms[t].column].type, terms[t].value))
+                        break;
+                if (t == count)
+                    break;
+                key[i] = terms[t].value;
+            }
+            //one bucket is read instead of a path from the root, an equality is found faster than by a B+tree
+            if (i == hash_meta.attributes)
+            {
+                best_rank = 4;
+                strcpy(best, index);
+                best_keys = hash_meta.attributes;
+                memcpy(best_key, key, best_keys * sizeof(AK_expression_value *));
+            }
+            continue;
+        }
+        if (AK_roaring_get_meta(index, &roaring_meta) == EXIT_SUCCESS)
+        {
+            if (strcmp(roaring_meta.table, table) != 0 || bitmaps == MAX_ATTRIBUTES)
+                continue;
+            for (t = 0; t < count; t++)
+                if (terms[t].conjunct && terms[t].comparison == AK_EXPR_EQ && terms[t].column == roaring_meta.position
+                    && AK_access_bound(header[terms[t].column].type, terms[t].value))
+                    break;
+            //a second index on the same attribute would give the same bitmap
+            for (i = 0; t < count && i < bitmaps && bitmap_column[i] != terms[t].column; i++);
+            if (t < count && i == bitmaps)
+            {
+                strcpy(bitmap[bitmaps], index);
+                bitmap_key[bitmaps] = terms[t].value;
+                bitmap_column[bitmaps++] = terms[t].column;
+            }
+            continue;
+        }
+        if (AK_btree_get_meta(index, &meta) == EXIT_ERROR || strcmp(meta.table, table) != 0)
+            continue;
+        bound[0] = bound[1] = NULL;
+        rank = 0;
+        for (t = 0; t < count && rank < 3; t++)
+        {
+            if (!terms[t].conjunct || terms[t].column != meta.position[0] || !AK_access_bound(header[terms[t].column].type, terms[t].value)
+                || (terms[t].high != NULL && !AK_access_bound(header[terms[t].column].type, terms[t].high)))
+                continue;
+            if (terms[t].comparison == AK_EXPR_EQ)
+            {
+                bound[0] = bound[1] = terms[t].value;
+                rank = 3;
+                continue;
+            }
+            if (terms[t].high != NULL)
+            {
+                bound[0] = terms[t].value;
+                bound[1] = terms[t].high;
+            }
+            else if (terms[t].comparison == AK_EXPR_GT || terms[t].comparison == AK_EXPR_GE)
+                bound[0] = bound[0] == NULL ? terms[t].value : bound[0];
+            else
+                bound[1] = bound[1] == NULL ? terms[t].value : bound[1];
+            rank = bound[0] != NULL && bound[1] != NULL ? 2 : 1;
+        }
+        if (rank > best_rank)
+        {
+            best_rank = rank;
+            strcpy(best, index);
+            best_bound[0] = bound[0];
+            best_bound[1] = bound[1];
+        }
+    }
+    AK_cursor_close(catalog);
+
+    //bitmaps of several attributes are intersected before a row is read, which narrows the rows more than an index on
+    //one of them; one bitmap is as good as a B+tree equality
+    if (bitmaps > 1 || (bitmaps == 1 && best_rank < 3))
+    {
+        list[0] = (struct list_node *)AK_malloc(sizeof(struct list_node));
+        list[1] = (struct list_node *)AK_malloc(sizeof(struct list_node));
+        AK_Init_L3(&list[0]);
+        AK_Init_L3(&list[1]);
+        for (i = 0; i < bitmaps; i++)
+        {
+            AK_InsertAtEnd_L3(TYPE_VARCHAR, bitmap[i], strlen(bitmap[i]), list[0]);
+            AK_InsertAtEnd_L3(bitmap_key[i]->type, bitmap_key[i]->data, bitmap_key[i]->size, list[1]);
+        }
+        AK_dbg_messg(MIDDLE, REL_OP, "AK_access_operator: %s is read by %d compressed bitmap indexes\n", table, bitmaps);
+        op = AK_roaring_scan_operator(table, list[0], list[1]);
+        for (i = 0; i < 2; i++)
+        {
+            AK_DeleteAll_L3(&list[i]);
+            AK_free(list[i]);
+        }
+    }
+    else if (best_rank == 0)
+        op = AK_scan_operator(table);
+    else if (best_keys > 0)
+    {
+        list[0] = (struct list_node *)AK_malloc(sizeof(struct list_node));
+        AK_Init_L3(&list[0]);
+        for (i = 0; i < best_keys; i++)
+            AK_InsertAtEnd_L3(best_key[i]->type, best_key[i]->data, best_key[i]->size, list[0]);
+        AK_dbg_messg(MIDDLE, REL_OP, "AK_access_operator: %s is read by hash index %s\n", table, best);
+        op = AK_hash_scan_operator(table, best, list[0]);
+        AK_DeleteAll_L3(&list[0]);
+        AK_free(list[0]);
+    }
+    else
+    {
+        for (i = 0; i < 2; i++)
+        {
+            list[i] = NULL;
+            if (best_bound[i] == NULL)
+                continue;
+            list[i] = (struct list_node *)AK_malloc(sizeof(struct list_node));
+            AK_Init_L3(&list[i]);
+            AK_InsertAtEnd_L3(best_bound[i]->type, best_bound[i]->data, best_bound[i]->size, list[i]);
+        }
+        AK_dbg_messg(MIDDLE, REL_OP, "AK_access_operator: %s is read by index %s\n", table, best);
+        op = AK_index_scan_operator(table, best, list[0], list[1]);
+        for (i = 0; i < 2; i++)
+            if (list[i] != NULL)
+            {
+                AK_DeleteAll_L3(&list[i]);
+                AK_free(list[i]);
+            }
+    }
+    AK_free(terms);
+    AK_expression_free(program);
+    AK_free(header);
+    AK_EPI;
+    return op;
+}
+
+/**
+ * @author agent
+ * @brief  Function that opens a node without own resources
+ * @param op node
+ * @return EXIT_SUCCESS
+ */
+static int AK_operator_open_nothing(AK_operator *op)
+{
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @author agent
+ * @brief  Function that closes a node without own resources
+ * @param op node
+ */
+static void AK_operator_close_nothing(AK_operator *op)
+{
+}
+
+/**
+ * @author agent
+ * @brief  Function that keeps a row selected by a worker of a parallel selection
+ * @param worker worker
+ * @param row selected row
+ * @param address block address of the row
+ * @param slot slot of the row
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_select_parallel_keep(AK_parallel_worker *worker, AK_row *row, int address, int slot)
+{
+    AK_select_partial *partial = (AK_select_partial *)worker->partial;
+    AK_select_hit *hit = (AK_select_hit *)AK_arena_alloc(worker->scratch, sizeof(AK_select_hit));
+    if (hit == NULL || (hit->row = AK_iterator_keep_row(worker->scratch, row, row->header)) == NULL)
+        return EXIT_ERROR;
+    hit->address = address;
+    hit->slot = slot;
+    return AK_iterator_push((void ***)&partial->hits, &partial->count, &partial->capacity, hit);
+}
+
+/**
+ * @author agent
+ * @brief  Function that filters the batch of a worker of a parallel selection and keeps the selected rows
+ * @param worker worker
+ * @param op selection node
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_select_parallel_filter(AK_parallel_worker *worker, AK_operator *op)
+{
+    AK_select_partial *partial = (AK_select_partial *)worker->partial;
+    AK_batch *batch = partial->batch;
+    int i, selected, result = EXIT_SUCCESS;
+    if (batch == NULL || batch->count == 0)
+        return EXIT_SUCCESS;
+    selected = AK_batch_filter(batch, ((AK_select_state *)op->state)->program);
+    for (i = 0; i < selected && result == EXIT_SUCCESS; i++)
+        result = AK_select_parallel_keep(worker, batch->row[batch->selection[i]], partial->address[batch->selection[i]], partial->slot[batch->selection[i]]);
+    batch->count = 0;
+    AK_arena_reset(partial->rows);
+    return result;
+}
+
+/**
+ * @author agent
+ * @brief  Function that evaluates the expression of a parallel selection on a row of a worker. Rows are copied into
+ * the batch of the worker if the expression is evaluated in batches.
+ * @param worker worker
+ * @param row row of the child table
+ * @param context selection node
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_select_parallel_row(AK_parallel_worker *worker, AK_row *row, void *context)
+{
+    AK_operator *op = (AK_operator *)context;
+    AK_select_state *state = (AK_select_state *)op->state;
+    AK_select_partial *partial = (AK_select_partial *)worker->partial;
+    AK_row *copy;
+    if (state->batch == NULL)
+        return AK_expression_run(state->program, row, NULL) ? AK_select_parallel_keep(worker, row, worker->address, worker->slot) : EXIT_SUCCESS;
+    if (partial->batch == NULL && ((partial->batch = AK_batch_new(state->program)) == NULL || (partial->rows = AK_arena_create(0)) == NULL))
+        return EXIT_ERROR;
+    if ((copy = AK_iterator_keep_row(partial->rows, row, row->header)) == NULL)
+        return EXIT_ERROR;
+    partial->address[partial->batch->count] = worker->address;
+    partial->slot[partial->batch->count] = worker->slot;
+    AK_batch_add(partial->batch, copy);
+    return partial->batch->count == AK_BATCH_SIZE ? AK_select_parallel_filter(worker, op) : EXIT_SUCCESS;
+}
+
+/**
+ * @author agent
+ * @brief  Function that filters the last batch of a worker of a parallel selection
+ * @param worker worker
+ * @param context selection node
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_select_parallel_done(AK_parallel_worker *worker, void *context)
+{
+    return AK_select_parallel_filter(worker, (AK_operator *)context);
+}
+
+/**
+ * @author agent
+ * @brief  Function that copies the rows selected by a worker of a parallel selection into the node arena and frees
+ * the partial result of the worker
+ * @param worker worker
+ * @param context selection node
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_select_parallel_merge(AK_parallel_worker *worker, void *context)
+{
+    AK_operator *op = (AK_operator *)context;
+    AK_select_state *state = (AK_select_state *)op->state;
+    AK_select_partial *partial = (AK_select_partial *)worker->partial;
+    AK_select_hit *hit;
+    int i, result = EXIT_SUCCESS;
+    AK_PRO;
+    for (i = 0; i < partial->count && result == EXIT_SUCCESS; i++)
+    {
+        hit = (AK_select_hit *)AK_arena_alloc(op->scratch, sizeof(AK_select_hit));
+        if (hit == NULL || (hit->row = AK_iterator_keep_row(op->scratch, partial->hits[i]->row, op->header)) == NULL)
+            result = EXIT_ERROR;
+        else
+        {
+            hit->address = partial->hits[i]->address;
+            hit->slot = partial->hits[i]->slot;
+            result = AK_iterator_push((void ***)&state->hits, &state->count, &state->capacity, hit);
+        }
+    }
+    AK_free(partial->hits);
+    AK_batch_free(partial->batch);
+    if (partial->rows != NULL)
+        AK_arena_destroy(partial->rows);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @author agent
+ * @brief  Function that orders the rows of a parallel selection by their position in the table
+ * @param a first row
+ * @param b second row
+ * @return negative, 0 or positive
+ */
+static int AK_select_hit_compare(const void *a, const void *b)
+{
+    const AK_select_hit *x = *(const AK_select_hit **)a, *y = *(const AK_select_hit **)b;
+    if (x->address != y->address)
+        return x->address < y->address ? -1 : 1;
+    return x->slot - y->slot;
+}
+
+/**
+ * @author agent
+ * @brief  Function that compiles the expression of the selection for the rows of its child. If the child scans a
+ * table for which AK_parallel_workers gives more than one worker and the expression is compiled, the table is
+ * filtered by a parallel scan here and the selected rows are produced in table order.
+ * @param op selection node
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_select_open(AK_operator *op)
+{
+    AK_select_state *state = (AK_select_state *)op->state;
+    AK_parallel_job job;
+    char *table;
+    int result;
+    AK_PRO;
+    state->program = AK_expression_compile(state->expr, op->child->header, op->child->num_attr);
+    //numeric comparisons with constants are evaluated in batches
+    state->batch = AK_batch_new(state->program);
+    state->pos = state->selected = state->end = 0;
+    state->count = 0;
+    if (state->program == NULL)
+    {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    //interpreted expressions are not evaluated by several threads
+    table = op->child->next == AK_scan_next ? ((AK_scan_state *)op->child->state)->table : NULL;
+    if (table == NULL || state->program->interpreted || AK_parallel_workers(table) <= 1)
+    {
+        AK_EPI;
+        return EXIT_SUCCESS;
+    }
+    AK_operator_close(op->child);
+    memset(&job, 0, sizeof(AK_parallel_job));
+    job.row = AK_select_parallel_row;
+    job.done = AK_select_parallel_done;
+    job.merge = AK_select_parallel_merge;
+    job.context = op;
+    job.partial_size = sizeof(AK_select_partial);
+    result = AK_parallel_scan(table, &job);
+    if (result == EXIT_SUCCESS && state->hits == NULL)
+        state->hits = (AK_select_hit **)AK_malloc(sizeof(AK_select_hit *));
+    if (state->hits != NULL)
+        qsort(state->hits, state->count, sizeof(AK_select_hit *), AK_select_hit_compare);
+    AK_dbg_messg(MIDDLE, REL_OP, "AK_select_open: %d rows of %s selected by %d workers\n", state->count, table, job.used);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @author agent
+ * @brief  Function that frees the compiled expression of the selection
+ * @param op selection node
+ */
+static void AK_select_close(AK_operator *op)
+{
+    AK_select_state *state = (AK_select_state *)op->state;
+    AK_PRO;
+    AK_expression_free(state->program);
+    AK_batch_free(state->batch);
+    AK_free(state->hits);
+    state->program = NULL;
+    state->batch = NULL;
+    state->hits = NULL;
+    state->count = state->capacity = 0;
+    AK_EPI;
+}
+
+/**
+ * @author agent
+ * @brief  Function that produces the next selected row of a selection evaluated in batches. When the selected rows of
+ * a batch are used up, up to AK_BATCH_SIZE child rows are copied into the node arena and filtered together.
+ * @param op selection node
+ * @return AK_ITERATOR_ROW, AK_ITERATOR_END or EXIT_ERROR
+ */
+static int AK_select_batch_next(AK_operator *op)
+{
+    AK_select_state *state = (AK_select_state *)op->state;
+    AK_batch *batch = state->batch;
+    int result = AK_ITERATOR_ROW;
+    AK_PRO;
+    while (state->pos >= state->selected)
+    {
+        if (state->end)
+        {
+            AK_EPI;
+            return AK_ITERATOR_END;
+        }
+        AK_arena_reset(op->scratch);
+        batch->count = state->pos = state->selected = 0;
+        while (batch->count < AK_BATCH_SIZE && (result = AK_operator_next(op->child)) == AK_ITERATOR_ROW)
+        {
+            op->row = AK_iterator_keep_row(op->scratch, op->child->row, op->child->row->header);
+            if (op->row == NULL)
+            {
+                AK_EPI;
+                return EXIT_ERROR;
+            }
+            AK_batch_add(batch, op->row);
+        }
+        if (result == EXIT_ERROR)
+        {
+            AK_EPI;
+            return EXIT_ERROR;
+        }
+        state->end = result == AK_ITERATOR_END;
+        state->selected = AK_batch_filter(batch, state->program);
+    }
+    op->row = batch->row[batch->selection[state->pos++]];
+    AK_EPI;
+    return AK_ITERATOR_ROW;
+}
+
+/**
+ * @author agent
+ * @brief  Function that passes on the next child row satisfying the expression of the selection. The row is not
+ * copied; the memory of an interpreted expression is released once per row. Expressions accepted by AK_batch_new are
+ * evaluated by AK_select_batch_next instead, rows of a parallel selection come from the rows selected by open.
+ * @param op selection node
+ * @return AK_ITERATOR_ROW, AK_ITERATOR_END or EXIT_ERROR
+ */
+static int AK_select_next(AK_operator *op)
+{
+    AK_select_state *state = (AK_select_state *)op->state;
+    int result;
+    AK_PRO;
+    if (state->hits != NULL)
+    {
+        if (state->pos >= state->count)
+        {
+            AK_EPI;
+            return AK_ITERATOR_END;
+        }
+        op->row = state->hits[state->pos++]->row;
+        AK_EPI;
+        return AK_ITERATOR_ROW;
+    }
+    if (state->batch != NULL)
+    {
+        result = AK_select_batch_next(op);
+        AK_EPI;
+        return result;
+    }
+    while ((result = AK_operator_next(op->child)) == AK_ITERATOR_ROW)
+    {
+        AK_arena_reset(op->scratch);
+        if (AK_expression_run(state->program, op->child->row, op->scratch))
+        {
+            op->row = op->child->row;
+            break;
+        }
+    }
+    AK_EPI;
+    return result;
+}
+
+AK_operator *AK_select_operator(AK_operator *child, struct list_node *expr)
+{
+    AK_operator *op;
+    AK_PRO;
+    if (child == NULL)
+    {
+        AK_EPI;
+        return NULL;
+    }
+    op = AK_operator_create(child->header, child->num_attr, child, NULL, sizeof(AK_select_state), 0);
+    if (op == NULL)
+    {
+        AK_EPI;
+        return NULL;
+    }
+    ((AK_select_state *)op->state)->expr = expr;
+    op->open = AK_select_open;
+    op->next = AK_select_next;
+    op->close = AK_select_close;
+    AK_EPI;
+    return op;
+}
+
+/**
+ * @author agent
+ * @brief  Function that builds the next projected row from the next child row
+ * @param op projection node
+ * @return AK_ITERATOR_ROW, AK_ITERATOR_END or EXIT_ERROR
+ */
+static int AK_project_next(AK_operator *op)
+{
+    AK_project_state *state = (AK_project_state *)op->state;
+    AK_row *row;
+    char *value;
+    int result, i, type, size, a, b;
+    double x, y;
+    AK_PRO;
+    result = AK_operator_next(op->child);
+    if (result != AK_ITERATOR_ROW)
+    {
+        AK_EPI;
+        return result;
+    }
+    row = op->child->row;
+    AK_row_reset(op->buffer);
+    for (i = 0; i < op->num_attr; i++)
+    {
+        if (state->source[i] != EXIT_ERROR)
+        {
+            value = AK_row_get(row, state->source[i], &type, &size);
+            if (value == NULL || AK_row_append(op->buffer, type, value, size) == EXIT_ERROR)
+            {
+                AK_EPI;
+                return EXIT_ERROR;
+            }
+            continue;
+        }
+
+        x = AK_iterator_number(row, state->left[i]);
+        y = AK_iterator_number(row, state->right[i]);
+        if ((state->op[i] == '/' || state->op[i] == '%') && y == 0)
+        {
+            printf("AK_project_next: ERROR. Division by zero in %s.\n", op->header[i].att_name);
+            AK_EPI;
+            return EXIT_ERROR;
+        }
+        if (op->header[i].type == TYPE_INT)
+        {
+            a = (int)x;
+            b = (int)y;
+            switch (state->op[i])
+            {
+            case '+': a += b; break;
+            case '-': a -= b; break;
+            case '*': a *= b; break;
+            case '/': a /= b; break;
+            case '%': a %= b; break;
+            }
+            x = a;
+        }
+        else
+        {
+            switch (state->op[i])
+            {
+            case '+': x += y; break;
+            case '-': x -= y; break;
+            case '*': x *= y; break;
+            case '/': x /= y; break;
+            }
+        }
+        if (AK_iterator_append_number(op->buffer, op->header[i].type, x) == EXIT_ERROR)
+        {
+            AK_EPI;
+            return EXIT_ERROR;
+        }
+    }
+    op->row = op->buffer;
+    AK_EPI;
+    return AK_ITERATOR_ROW;
+}
+
+AK_operator *AK_project_operator(AK_operator *child, struct list_node *attributes)
+{
+    AK_operator *op;
+    AK_project_state state;
+    AK_header header[MAX_ATTRIBUTES + 1];
+    AK_header *temp;
+    struct list_node *attribute;
+    char operand[MAX_ATT_NAME];
+    char *name, *position;
+    int num_attr = 0, type;
+    AK_PRO;
+    if (child == NULL)
+    {
+        AK_EPI;
+        return NULL;
+    }
+    memset(header, 0, sizeof(header));
+    for (attribute = (struct list_node *)AK_First_L2(attributes); attribute != NULL; attribute = (struct list_node *)AK_Next_L2(attribute))
+    {
+        name = attribute->data;
+        if (num_attr == MAX_ATTRIBUTES)
+        {
+            printf("AK_project_operator: ERROR. Too many attributes.\n");
+            AK_operator_free(child);
+            AK_EPI;
+            return NULL;
+        }
+        state.source[num_attr] = AK_iterator_attr_index(child->header, child->num_attr, name);
+        if (state.source[num_attr] != EXIT_ERROR)
+        {
+            memcpy(&header[num_attr], &child->header[state.source[num_attr]], sizeof(AK_header));
+            num_attr++;
+            continue;
+        }
+
+        //arithmetic attribute: <attribute><operator><attribute>
+        position = strpbrk(name, "+-*/%");
+        if (position == NULL || position == name || position - name >= MAX_ATT_NAME)
+        {
+            printf("AK_project_operator: ERROR. Unknown attribute %s.\n", name);
+            AK_operator_free(child);
+            AK_EPI;
+            return NULL;
+        }
+        memcpy(operand, name, position - name);
+        operand[position - name] = '\0';
+        state.op[num_attr] = *position;
+        state.left[num_attr] = AK_iterator_attr_index(child->header, child->num_attr, operand);
+        state.right[num_attr] = AK_iterator_attr_index(child->header, child->num_attr, position + 1);
+        if (state.left[num_attr] == EXIT_ERROR || state.right[num_attr] == EXIT_ERROR)
+        {
+            printf("AK_project_operator: ERROR. Unknown attribute in %s.\n", name);
+            AK_operator_free(child);
+            AK_EPI;
+            return NULL;
+        }
+        type = AK_determine_header_type(child->header[state.left[num_attr]].type, child->header[state.right[num_attr]].type);
+        if (type != TYPE_INT && type != TYPE_FLOAT && type != TYPE_NUMBER)
+        {
+            printf("AK_project_operator: ERROR. %s needs numeric attributes.\n", name);
+            AK_operator_free(child);
+            AK_EPI;
+            return NULL;
+        }
+        temp = (AK_header *)AK_create_header(name, type, FREE_INT, FREE_CHAR, FREE_CHAR);
+        memcpy(&header[num_attr++], temp, sizeof(AK_header));
+        AK_free(temp);
+    }
+
+    op = AK_operator_create(header, num_attr, child, NULL, sizeof(AK_project_state), 1);
+    if (op == NULL)
+    {
+        AK_EPI;
+        return NULL;
+    }
+    memcpy(op->state, &state, sizeof(AK_project_state));
+    op->open = AK_operator_open_nothing;
+    op->next = AK_project_next;
+    op->close = AK_operator_close_nothing;
+    AK_EPI;
+    return op;
+}
+
+/**
+ * @author agent
+ * @brief  Function that compares two rows by the sort attributes
+ * @param a first row
+ * @param b second row
+ * @param state sort state
+ * @return negative, zero or positive like strcmp
+ */
+static int AK_sort_compare_rows(AK_row *a, AK_row *b, AK_sort_state *state)
+{
+    int i, result = 0;
+    AK_PRO;
+    for (i = 0; i < state->num_keys && result == 0; i++)
+    {
+        result = AK_iterator_compare_values(a, state->key[i], b, state->key[i]);
+        if (state->descending[i])
+            result = -result;
+    }
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @author agent
+ * @brief  Function that sorts the materialized rows with a bottom-up merge sort, so equal rows keep their input order
+ * @param state sort state
+ * @param temp array of the same size as the rows
+ */
+static void AK_sort_rows(AK_sort_state *state, AK_row **temp)
+{
+    int width, low, middle, high, i, j, k;
+    AK_PRO;
+    for (width = 1; width < state->count; width *= 2)
+    {
+        for (low = 0; low < state->count; low += 2 * width)
+        {
+            middle = low + width < state->count ? low + width : state->count;
+            high = low + 2 * width < state->count ? low + 2 * width : state->count;
+            i = low;
+            j = middle;
+            k = low;
+            while (i < middle && j < high)
+                temp[k++] = AK_sort_compare_rows(state->rows[j], state->rows[i], state) < 0 ? state->rows[j++] : state->rows[i++];
+            while (i < middle)
+                temp[k++] = state->rows[i++];
+            while (j < high)
+                temp[k++] = state->rows[j++];
+        }
+        memcpy(state->rows, temp, sizeof(AK_row *) * state->count);
+    }
+    AK_EPI;
+}
+
+/**
+ * @author agent
+ * @brief  Function that reads all rows of an input into the arena of a node and sorts them by the keys of a sort
+ * state. The input is closed afterwards.
+ * @param op node keeping the rows
+ * @param input input node
+ * @param state sort state receiving the rows, without keys the rows stay in input order
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_sort_read(AK_operator *op, AK_operator *input, AK_sort_state *state)
+{
+    AK_row **temp;
+    int result;
+    AK_PRO;
+    state->count = state->pos = 0;
+    while ((result = AK_operator_next(input)) == AK_ITERATOR_ROW)
+        if (AK_iterator_push((void ***)&state->rows, &state->count, &state->capacity, AK_iterator_keep_row(op->scratch, input->row, input->header)) == EXIT_ERROR)
+        {
+            result = EXIT_ERROR;
+            break;
+        }
+    AK_operator_close(input);
+    if (result == EXIT_ERROR)
+    {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    if (state->count > 1 && state->num_keys > 0)
+    {
+        temp = (AK_row **)AK_malloc(sizeof(AK_row *) * state->count);
+        if (temp == NULL)
+        {
+            AK_EPI;
+            return EXIT_ERROR;
+        }
+        AK_sort_rows(state, temp);
+        AK_free(temp);
+    }
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+int AK_iterator_copy_row(AK_row *copy, AK_row *row)
+{
+    char *value;
+    int i, type, size;
+    AK_row_reset(copy);
+    for (i = 0; i < row->count; i++)
+        if ((value = AK_row_get(row, i, &type, &size)) == NULL || AK_row_append(copy, type, value, size) == EXIT_ERROR)
+            return EXIT_ERROR;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @author agent
+ * @brief  Function that sorts the rows in memory and writes them into a new run. The rows and the node arena are
+ * released afterwards.
+ * @param op sort node
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_sort_spill(AK_operator *op)
+{
+    static int AK_sort_runs = 0;
+    AK_sort_state *state = (AK_sort_state *)op->state;
+    AK_row **temp;
+    char *name;
+    int i;
+    AK_PRO;
+    temp = (AK_row **)AK_malloc(sizeof(AK_row *) * state->count);
+    name = (char *)AK_calloc(MAX_ATT_NAME, sizeof(char));
+    if (temp == NULL || name == NULL)
+    {
+        AK_free(temp);
+        AK_free(name);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    AK_sort_rows(state, temp);
+    AK_free(temp);
+
+    sprintf(name, "sort_run_%d", ++AK_sort_runs);
+    if (AK_initialize_new_segment(name, SEGMENT_TYPE_TABLE, op->header) == EXIT_ERROR)
+    {
+        printf("AK_sort_spill: ERROR. Can not create run %s.\n", name);
+        AK_free(name);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    if (AK_iterator_push((void ***)&state->run, &state->num_runs, &state->run_capacity, name) == EXIT_ERROR)
+    {
+        AK_delete_segment(name, SEGMENT_TYPE_TABLE);
+        AK_free(name);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    for (i = 0; i < state->count; i++)
+        if (AK_insert_compact_row(name, state->rows[i], NULL) == EXIT_ERROR)
+        {
+            AK_EPI;
+            return EXIT_ERROR;
+        }
+    AK_dbg_messg(MIDDLE, REL_OP, "Sort: run %s holds %d rows\n", name, state->count);
+    state->count = 0;
+    state->used = 0;
+    AK_arena_reset(op->scratch);
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @author agent
+ * @brief  Function that returns the current row of a source of a merge
+ * @param state sort state
+ * @param source source, a run or the rows in memory
+ * @return current row
+ */
+static AK_row *AK_sort_source_row(AK_sort_state *state, int source)
+{
+    return source < state->num_runs ? state->sources[source]->row : state->rows[state->pos];
+}
+
+/**
+ * @author agent
+ * @brief  Function that moves the heap entry at a position down to its place, the source with the smallest row is
+ * on top. Between equal rows the earlier source comes first, so the merge keeps the input order.
+ * @param state sort state
+ * @param i position in the heap
+ */
+static void AK_sort_heap_down(AK_sort_state *state, int i)
+{
+    int child, result, source;
+    for (;;)
+    {
+        child = 2 * i + 1;
+        if (child >= state->heap_size)
+            return;
+        if (child + 1 < state->heap_size)
+        {
+            result = AK_sort_compare_rows(AK_sort_source_row(state, state->heap[child + 1]), AK_sort_source_row(state, state->heap[child]), state);
+            if (result < 0 || (result == 0 && state->heap[child + 1] < state->heap[child]))
+                child++;
+        }
+        result = AK_sort_compare_rows(AK_sort_source_row(state, state->heap[child]), AK_sort_source_row(state, state->heap[i]), state);
+        if (result > 0 || (result == 0 && state->heap[child] > state->heap[i]))
+            return;
+        source = state->heap[i];
+        state->heap[i] = state->heap[child];
+        state->heap[child] = source;
+        i = child;
+    }
+}
+
+/**
+ * @author agent
+ * @brief  Function that opens the scans of all runs and puts every source with a row into the merge heap
+ * @param op sort node
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_sort_merge_open(AK_operator *op)
+{
+    AK_sort_state *state = (AK_sort_state *)op->state;
+    int i, result;
+    AK_PRO;
+    state->sources = (AK_operator **)AK_calloc(state->num_runs, sizeof(AK_operator *));
+    state->heap = (int *)AK_malloc(sizeof(int) * (state->num_runs + 1));
+    if (state->sources == NULL || state->heap == NULL)
+    {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    state->heap_size = 0;
+    state->last = EXIT_ERROR;
+    for (i = 0; i < state->num_runs; i++)
+    {
+        state->sources[i] = AK_scan_operator(state->run[i]);
+        if (state->sources[i] == NULL || AK_operator_open(state->sources[i]) == EXIT_ERROR
+            || (result = AK_operator_next(state->sources[i])) == EXIT_ERROR)
+        {
+            AK_EPI;
+            return EXIT_ERROR;
+        }
+        if (result == AK_ITERATOR_ROW)
+            state->heap[state->heap_size++] = i;
+    }
+    if (state->pos < state->count)
+        state->heap[state->heap_size++] = state->num_runs;
+    for (i = state->heap_size / 2 - 1; i >= 0; i--)
+        AK_sort_heap_down(state, i);
+    AK_dbg_messg(MIDDLE, REL_OP, "Sort: merging %d runs and %d rows in memory\n", state->num_runs, state->count);
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @author agent
+ * @brief  Function that checks whether a kept row of a top-N sort comes after another one
+ * @param state sort state
+ * @param i position of the first row
+ * @param j position of the second row
+ * @return 1 if row i comes after row j
+ */
+static int AK_sort_top_after(AK_sort_state *state, int i, int j)
+{
+    int result = AK_sort_compare_rows(state->rows[i], state->rows[j], state);
+    return result > 0 || (result == 0 && state->sequence[i] > state->sequence[j]);
+}
+
+/**
+ * @author agent
+ * @brief  Function that exchanges two kept rows of a top-N sort
+ * @param state sort state
+ * @param i position of the first row
+ * @param j position of the second row
+ */
+static void AK_sort_top_swap(AK_sort_state *state, int i, int j)
+{
+    AK_row *row = state->rows[i];
+    int sequence = state->sequence[i];
+    state->rows[i] = state->rows[j];
+    state->sequence[i] = state->sequence[j];
+    state->rows[j] = row;
+    state->sequence[j] = sequence;
+}
+
+/**
+ * @author agent
+ * @brief  Function that moves a kept row of a top-N sort down to its place in a heap with the last row on top
+ * @param state sort state
+ * @param i position of the row
+ * @param size number of rows in the heap
+ */
+static void AK_sort_top_down(AK_sort_state *state, int i, int size)
+{
+    int child;
+    while ((child = 2 * i + 1) < size)
+    {
+        if (child + 1 < size && AK_sort_top_after(state, child + 1, child))
+            child++;
+        if (!AK_sort_top_after(state, child, i))
+            return;
+        AK_sort_top_swap(state, i, child);
+        i = child;
+    }
+}
+
+/**
+ * @author agent
+ * @brief  Function that keeps the first limit rows of the input of a top-N sort in a heap and sorts them. Every kept
+ * row is owned by the node and reused when a better row replaces it, so memory does not grow with the input.
+ * @param op sort node
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_sort_top(AK_operator *op)
+{
+    AK_sort_state *state = (AK_sort_state *)op->state;
+    int result, sequence = 0, i;
+    AK_PRO;
+    if (state->rows == NULL)
+    {
+        state->rows = (AK_row **)AK_calloc(state->limit, sizeof(AK_row *));
+        state->sequence = (int *)AK_calloc(state->limit, sizeof(int));
+        if (state->rows == NULL || state->sequence == NULL)
+        {
+            AK_EPI;
+            return EXIT_ERROR;
+        }
+        state->capacity = state->limit;
+    }
+
+    while ((result = AK_operator_next(op->child)) == AK_ITERATOR_ROW)
+    {
+        sequence++;
+        if (state->count < state->limit)
+        {
+            i = state->count;
+            if ((state->rows[i] == NULL && (state->rows[i] = AK_row_new(op->child->header, op->child->num_attr)) == NULL)
+                || AK_iterator_copy_row(state->rows[i], op->child->row) == EXIT_ERROR)
+            {
+                result = EXIT_ERROR;
+                break;
+            }
+            state->sequence[i] = sequence;
+            state->count++;
+            for (; i > 0 && AK_sort_top_after(state, i, (i - 1) / 2); i = (i - 1) / 2)
+                AK_sort_top_swap(state, i, (i - 1) / 2);
+        }
+        else if (AK_sort_compare_rows(op->child->row, state->rows[0], state) < 0)
+        {
+            //the row replaces the last kept row, equal rows keep the earlier one
+            if (AK_iterator_copy_row(state->rows[0], op->child->row) == EXIT_ERROR)
+            {
+                result = EXIT_ERROR;
+                break;
+            }
+            state->sequence[0] = sequence;
+            AK_sort_top_down(state, 0, state->count);
+        }
+    }
+    AK_operator_close(op->child);
+    if (result == EXIT_ERROR)
+    {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    //heap sort, the last row goes to the end
+    for (i = state->count - 1; i > 0; i--)
+    {
+        AK_sort_top_swap(state, 0, i);
+        AK_sort_top_down(state, 0, i);
+    }
+    AK_dbg_messg(MIDDLE, REL_OP, "Sort: kept %d of %d rows\n", state->count, sequence);
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @author agent
+ * @brief  Function that sorts the input of a sort. Rows are collected and sorted in memory; whenever they use more
+ * than the memory of the node they are written into a run, and the runs are merged at the end. A top-N sort keeps
+ * only the first rows.
+ * @param op sort node
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_sort_open(AK_operator *op)
+{
+    AK_sort_state *state = (AK_sort_state *)op->state;
+    AK_row **temp;
+    AK_row *row;
+    int result;
+    AK_PRO;
+    state->count = state->pos = 0;
+    state->used = 0;
+    state->heap_size = 0;
+    if (state->limit > 0)
+    {
+        result = AK_sort_top(op);
+        AK_EPI;
+        return result;
+    }
+
+    while ((result = AK_operator_next(op->child)) == AK_ITERATOR_ROW)
+    {
+        row = op->child->row;
+        if (AK_iterator_push((void ***)&state->rows, &state->count, &state->capacity, AK_iterator_keep_row(op->scratch, row, op->child->header)) == EXIT_ERROR)
+        {
+            result = EXIT_ERROR;
+            break;
+        }
+        state->used += sizeof(AK_row *) + sizeof(AK_row) + sizeof(int) * (2 * row->count + 1) + row->offset[row->count];
+        if (state->used > state->memory && AK_sort_spill(op) == EXIT_ERROR)
+        {
+            result = EXIT_ERROR;
+            break;
+        }
+    }
+    AK_operator_close(op->child);
+    if (result == EXIT_ERROR)
+    {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    if (state->count > 1)
+    {
+        temp = (AK_row **)AK_malloc(sizeof(AK_row *) * state->count);
+        if (temp == NULL)
+        {
+            AK_EPI;
+            return EXIT_ERROR;
+        }
+        AK_sort_rows(state, temp);
+        AK_free(temp);
+    }
+    AK_dbg_messg(MIDDLE, REL_OP, "AK_sort_open: %d rows sorted in memory, %d runs, arena peak %zu bytes\n", state->count, state->num_runs, AK_arena_peak(op->scratch));
+    result = state->num_runs > 0 ? AK_sort_merge_open(op) : EXIT_SUCCESS;
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @author agent
+ * @brief  Function that produces the next sorted row, from memory or from the merge of the runs
+ * @param op sort node
+ * @return AK_ITERATOR_ROW, AK_ITERATOR_END or EXIT_ERROR
+ */
+static int AK_sort_next(AK_operator *op)
+{
+    AK_sort_state *state = (AK_sort_state *)op->state;
+    int result, source;
+    AK_PRO;
+    if (state->num_runs == 0)
+    {
+        if (state->pos >= state->count)
+        {
+            AK_EPI;
+            return AK_ITERATOR_END;
+        }
+        op->row = state->rows[state->pos++];
+        AK_EPI;
+        return AK_ITERATOR_ROW;
+    }
+
+    //the source of the previous row moves on only now, its row had to stay valid until this call
+    if ((source = state->last) != EXIT_ERROR)
+    {
+        if (source < state->num_runs)
+            result = AK_operator_next(state->sources[source]);
+        else
+            result = ++state->pos < state->count ? AK_ITERATOR_ROW : AK_ITERATOR_END;
+        if (result == EXIT_ERROR)
+        {
+            AK_EPI;
+            return EXIT_ERROR;
+        }
+        if (result == AK_ITERATOR_END)
+            state->heap[0] = state->heap[--state->heap_size];
+        AK_sort_heap_down(state, 0);
+        state->last = EXIT_ERROR;
+    }
+    if (state->heap_size == 0)
+    {
+        AK_EPI;
+        return AK_ITERATOR_END;
+    }
+    state->last = state->heap[0];
+    op->row = AK_sort_source_row(state, state->last);
+    AK_EPI;
+    return AK_ITERATOR_ROW;
+}
+
+/**
+ * @author agent
+ * @brief  Function that closes a sort and deletes its runs, the rows in memory are released with the node arena
+ * @param op sort node
+ */
+static void AK_sort_close(AK_operator *op)
+{
+    AK_sort_state *state = (AK_sort_state *)op->state;
+    int i;
+    AK_PRO;
+    for (i = 0; state->limit > 0 && i < state->capacity; i++)
+        AK_row_free(state->rows[i]);
+    for (i = 0; i < state->num_runs; i++)
+    {
+        if (state->sources != NULL)
+            AK_operator_free(state->sources[i]);
+        AK_delete_segment(state->run[i], SEGMENT_TYPE_TABLE);
+        AK_free(state->run[i]);
+    }
+    AK_free(state->rows);
+    AK_free(state->sequence);
+    AK_free(state->run);
+    AK_free(state->sources);
+    AK_free(state->heap);
+    state->rows = NULL;
+    state->sequence = NULL;
+    state->run = NULL;
+    state->sources = NULL;
+    state->heap = NULL;
+    state->count = state->capacity = state->pos = 0;
+    state->num_runs = state->run_capacity = state->heap_size = 0;
+    AK_EPI;
+}
+
+AK_operator *AK_sort_operator(AK_operator *child, struct list_node *attributes)
+{
+    AK_PRO;
+    AK_operator *op = AK_sort_limit_operator(child, attributes, 0);
+    AK_EPI;
+    return op;
+}
+
+AK_operator *AK_sort_limit_operator(AK_operator *child, struct list_node *attributes, int limit)
+{
+    AK_operator *op;
+    AK_sort_state *state;
+    struct list_node *attribute;
+    AK_PRO;
+    if (child == NULL || limit < 0)
+    {
+        AK_operator_free(child);
+        AK_EPI;
+        return NULL;
+    }
+    op = AK_operator_create(child->header, child->num_attr, child, NULL, sizeof(AK_sort_state), 0);
+    if (op == NULL)
+    {
+        AK_EPI;
+        return NULL;
+    }
+    state = (AK_sort_state *)op->state;
+    for (attribute = (struct list_node *)AK_First_L2(attributes); attribute != NULL; attribute = (struct list_node *)AK_Next_L2(attribute))
+    {
+        //ASC or DESC after an attribute gives its order
+        if (attribute->type == TYPE_OPERATOR && state->num_keys > 0
+            && (strcmp(attribute->data, "ASC") == 0 || strcmp(attribute->data, "DESC") == 0))
+        {
+            state->descending[state->num_keys - 1] = strcmp(attribute->data, "DESC") == 0;
+            continue;
+        }
+        if (state->num_keys == MAX_ATTRIBUTES
+            || (state->key[state->num_keys] = AK_iterator_attr_index(op->header, op->num_attr, attribute->data)) == EXIT_ERROR)
+        {
+            printf("AK_sort_operator: ERROR. Can not sort by %s.\n", attribute->data);
+            AK_operator_free(op);
+            AK_EPI;
+            return NULL;
+        }
+        state->num_keys++;
+    }
+    state->limit = limit;
+    state->memory = AK_SORT_MEMORY;
+    op->open = AK_sort_open;
+    op->next = AK_sort_next;
+    op->close = AK_sort_close;
+    AK_EPI;
+    return op;
+}
+
+/**
+ * @author agent
+ * @brief  Function that estimates the number of rows a node produces, from the tables scanned below it
+ * @param op node
+ * @return estimated number of rows
+ */
+static int AK_operator_rows(AK_operator *op)
+{
+    int rows;
+    AK_PRO;
+    if (op->open == AK_scan_open)
+        rows = AK_get_num_records(((AK_scan_state *)op->state)->table);
+    else
+        rows = op->child != NULL ? AK_operator_rows(op->child) : 0;
+    AK_EPI;
+    return rows > 0 ? rows : 0;
+}
+
+/**
+ * @author agent
+ * @brief  Function that adds a row of the build input to the entries of a hash join
+ * @param op join node
+ * @param row row, it is copied into the node arena
+ * @param hash hash of the join attributes of the row
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_hash_join_keep(AK_operator *op, AK_row *row, unsigned int hash)
+{
+    AK_join_state *state = (AK_join_state *)op->state;
+    AK_hash_entry *entry = (AK_hash_entry *)AK_arena_alloc(op->scratch, sizeof(AK_hash_entry));
+    if (entry == NULL || (entry->row = AK_iterator_keep_row(op->scratch, row, row->header)) == NULL)
+        return EXIT_ERROR;
+    entry->hash = hash;
+    entry->next = state->entries;
+    state->entries = entry;
+    state->num_entries++;
+    state->used += sizeof(AK_hash_entry) + sizeof(AK_row) + sizeof(int) * (2 * row->count + 1) + row->offset[row->count];
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @author agent
+ * @brief  Function that distributes the kept entries of a hash join into buckets
+ * @param op join node
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_hash_join_build(AK_operator *op)
+{
+    AK_join_state *state = (AK_join_state *)op->state;
+    AK_hash_entry *entry, *next;
+    unsigned int num_buckets = 1;
+    AK_PRO;
+    while (num_buckets < (unsigned int)state->num_entries)
+        num_buckets *= 2;
+    state->buckets = (AK_hash_entry **)AK_arena_calloc(op->scratch, num_buckets, sizeof(AK_hash_entry *));
+    if (state->buckets == NULL)
+    {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    state->mask = num_buckets - 1;
+    for (entry = state->entries; entry != NULL; entry = next)
+    {
+        next = entry->next;
+        entry->next = state->buckets[entry->hash & state->mask];
+        state->buckets[entry->hash & state->mask] = entry;
+    }
+    state->entries = NULL;
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @author agent
+ * @brief  Function that returns the partition of a hash, taken from other bits than the bucket
+ * @param hash hash of the key attributes
+ * @param partitions number of partitions
+ * @return partition number
+ */
+static int AK_iterator_partition(unsigned int hash, int partitions)
+{
+    return (hash >> 24) % partitions;
+}
+
+/**
+ * @author agent
+ * @brief  Function that starts partitioning a hash join whose build input does not fit into memory. Temporary tables
+ * are created for both inputs and the rows kept so far are moved into the build partitions.
+ * @param op join node
+ * @param build build input
+ * @param probe probe input
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_hash_join_spill(AK_operator *op, AK_operator *build, AK_operator *probe)
+{
+    static int AK_hash_join_spills = 0;
+    AK_join_state *state = (AK_join_state *)op->state;
+    AK_hash_entry *entry;
+    int side, i;
+    AK_PRO;
+    AK_hash_join_spills++;
+    for (side = 0; side < 2; side++)
+        for (i = 0; i < AK_HASH_JOIN_PARTITIONS; i++)
+        {
+            sprintf(state->spill[side][i], "hash_join_%d_%s%d", AK_hash_join_spills, side == 0 ? "build" : "probe", i);
+            if (AK_initialize_new_segment(state->spill[side][i], SEGMENT_TYPE_TABLE, side == 0 ? build->header : probe->header) == EXIT_ERROR)
+            {
+                printf("AK_hash_join_spill: ERROR. Can not create partition %s.\n", state->spill[side][i]);
+                state->spill[side][i][0] = '\0';
+                AK_EPI;
+                return EXIT_ERROR;
+            }
+        }
+    state->partitions = AK_HASH_JOIN_PARTITIONS;
+    AK_dbg_messg(LOW, REL_OP, "Hash join: build input larger than %zu bytes, using %d partitions\n", state->memory, state->partitions);
+
+    for (entry = state->entries; entry != NULL; entry = entry->next)
+        if (AK_insert_compact_row(state->spill[0][AK_iterator_partition(entry->hash, AK_HASH_JOIN_PARTITIONS)], entry->row, NULL) == EXIT_ERROR)
+        {
+            AK_EPI;
+            return EXIT_ERROR;
+        }
+    state->entries = NULL;
+    state->num_entries = 0;
+    state->used = 0;
+    AK_arena_reset(op->scratch);
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @author agent
+ * @brief  Function that loads the next pair of partitions of a partitioned hash join: the build partition is read
+ * into the hash table and a scan of the probe partition becomes the probe input
+ * @param op join node
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_hash_join_load(AK_operator *op)
+{
+    AK_join_state *state = (AK_join_state *)op->state;
+    int *build_key = state->build_left ? state->left_key : state->right_key;
+    AK_operator *scan;
+    int result;
+    AK_PRO;
+    AK_operator_free(state->probe);
+    state->probe = NULL;
+    state->entries = NULL;
+    state->num_entries = 0;
+    state->used = 0;
+    state->have_probe = 0;
+    AK_arena_reset(op->scratch);
+
+    scan = AK_scan_operator(state->spill[0][state->partition]);
+    if (scan == NULL || AK_operator_open(scan) == EXIT_ERROR)
+    {
+        AK_operator_free(scan);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    while ((result = AK_operator_next(scan)) == AK_ITERATOR_ROW)
+        if (AK_hash_join_keep(op, scan->row, AK_iterator_hash_keys(scan->row, build_key, state->num_keys)) == EXIT_ERROR)
+        {
+            result = EXIT_ERROR;
+            break;
+        }
+    AK_operator_free(scan);
+    if (result == EXIT_ERROR || AK_hash_join_build(op) == EXIT_ERROR)
+    {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    AK_dbg_messg(MIDDLE, REL_OP, "Hash join: partition %d holds %d build rows\n", state->partition, state->num_entries);
+
+    state->probe = AK_scan_operator(state->spill[1][state->partition]);
+    if (state->probe == NULL || AK_operator_open(state->probe) == EXIT_ERROR)
+    {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @author agent
+ * @brief  Function that reads the smaller input of a join into a hash table. If the hash table would use more than
+ * the memory of the join, both inputs are written into partitions and the first pair of partitions is loaded. The
+ * build input is closed afterwards.
+ * @param op join node
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_join_open(AK_operator *op)
+{
+    AK_join_state *state = (AK_join_state *)op->state;
+    AK_operator *build, *probe;
+    int *build_key, *probe_key;
+    unsigned int hash;
+    int result;
+    AK_PRO;
+    state->build_left = AK_operator_rows(op->child) < AK_operator_rows(op->right);
+    build = state->build_left ? op->child : op->right;
+    probe = state->build_left ? op->right : op->child;
+    build_key = state->build_left ? state->left_key : state->right_key;
+    probe_key = state->build_left ? state->right_key : state->left_key;
+    state->entries = NULL;
+    state->num_entries = state->have_probe = state->partitions = state->partition = 0;
+    state->used = 0;
+
+    while ((result = AK_operator_next(build)) == AK_ITERATOR_ROW)
+    {
+        hash = AK_iterator_hash_keys(build->row, build_key, state->num_keys);
+        if (state->partitions > 0)
+            result = AK_insert_compact_row(state->spill[0][AK_iterator_partition(hash, AK_HASH_JOIN_PARTITIONS)], build->row, NULL);
+        else if ((result = AK_hash_join_keep(op, build->row, hash)) == EXIT_SUCCESS && state->used > state->memory)
+            result = AK_hash_join_spill(op, build, probe);
+        if (result == EXIT_ERROR)
+            break;
+    }
+    AK_operator_close(build);
+    if (result == EXIT_ERROR)
+    {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    if (state->partitions == 0)
+    {
+        AK_dbg_messg(MIDDLE, REL_OP, "Hash join: %d build rows in memory\n", state->num_entries);
+        AK_EPI;
+        return AK_hash_join_build(op);
+    }
+
+    while ((result = AK_operator_next(probe)) == AK_ITERATOR_ROW)
+    {
+        hash = AK_iterator_hash_keys(probe->row, probe_key, state->num_keys);
+        if (AK_insert_compact_row(state->spill[1][AK_iterator_partition(hash, AK_HASH_JOIN_PARTITIONS)], probe->row, NULL) == EXIT_ERROR)
+        {
+            result = EXIT_ERROR;
+            break;
+        }
+    }
+    AK_operator_close(probe);
+    AK_EPI;
+    return result == EXIT_ERROR ? EXIT_ERROR : AK_hash_join_load(op);
+}
+
+/**
+ * @author agent
+ * @brief  Function that produces the next pair of left and right rows with equal join attributes. Each probe row is
+ * compared only with the build rows of its bucket.
+ * @param op join node
+ * @return AK_ITERATOR_ROW, AK_ITERATOR_END or EXIT_ERROR
+ */
+static int AK_join_next(AK_operator *op)
+{
+    AK_join_state *state = (AK_join_state *)op->state;
+    AK_operator *probe;
+    AK_hash_entry *entry;
+    AK_row *left, *right;
+    int *probe_key = state->build_left ? state->right_key : state->left_key;
+    int *build_key = state->build_left ? state->left_key : state->right_key;
+    char *value;
+    int result, i, type, size;
+    AK_PRO;
+    for (;;)
+    {
+        probe = state->partitions > 0 ? state->probe : (state->build_left ? op->right : op->child);
+        if (!state->have_probe)
+        {
+            result = AK_operator_next(probe);
+            if (result == AK_ITERATOR_END && state->partitions > 0 && state->partition + 1 < state->partitions)
+            {
+                state->partition++;
+                if (AK_hash_join_load(op) == EXIT_ERROR)
+                {
+                    AK_EPI;
+                    return EXIT_ERROR;
+                }
+                continue;
+            }
+            if (result != AK_ITERATOR_ROW)
+            {
+                AK_EPI;
+                return result;
+            }
+            state->probe_hash = AK_iterator_hash_keys(probe->row, probe_key, state->num_keys);
+            state->match = state->buckets[state->probe_hash & state->mask];
+            state->have_probe = 1;
+        }
+        while ((entry = state->match) != NULL)
+        {
+            state->match = entry->next;
+            if (entry->hash != state->probe_hash || !AK_iterator_keys_equal(probe->row, probe_key, entry->row, build_key, state->num_keys))
+                continue;
+
+            left = state->build_left ? entry->row : probe->row;
+            right = state->build_left ? probe->row : entry->row;
+            AK_row_reset(op->buffer);
+            for (i = 0; i < state->num_left_out + right->count; i++)
+            {
+                value = i < state->num_left_out ? AK_row_get(left, state->left_out[i], &type, &size)
+                                                : AK_row_get(right, i - state->num_left_out, &type, &size);
+                if (value == NULL || AK_row_append(op->buffer, type, value, size) == EXIT_ERROR)
+                {
+                    AK_EPI;
+                    return EXIT_ERROR;
+                }
+            }
+            op->row = op->buffer;
+            AK_EPI;
+            return AK_ITERATOR_ROW;
+        }
+        state->have_probe = 0;
+    }
+}
+
+/**
+ * @author agent
+ * @brief  Function that closes a join and deletes its partitions, the kept rows are released with the node arena
+ * @param op join node
+ */
+static void AK_join_close(AK_operator *op)
+{
+    AK_join_state *state = (AK_join_state *)op->state;
+    int side, i;
+    AK_PRO;
+    AK_operator_free(state->probe);
+    state->probe = NULL;
+    for (side = 0; side < 2; side++)
+        for (i = 0; i < AK_HASH_JOIN_PARTITIONS; i++)
+            if (state->spill[side][i][0] != '\0')
+            {
+                AK_delete_segment(state->spill[side][i], SEGMENT_TYPE_TABLE);
+                state->spill[side][i][0] = '\0';
+            }
+    state->entries = NULL;
+    state->buckets = NULL;
+    state->match = NULL;
+    state->num_entries = state->have_probe = state->partitions = state->partition = 0;
+    AK_EPI;
+}
+
+/**
+ * @author agent
+ * @brief  Function that creates a hash join node from join attributes given by their positions in the inputs
+ * @param left left input node, owned by the new node
+ * @param right right input node, owned by the new node
+ * @param state join attributes and copied left attributes
+ * @return new node, NULL on error
+ */
+static AK_operator *AK_hash_join_create(AK_operator *left, AK_operator *right, AK_join_state *state)
+{
+    AK_operator *op;
+    AK_header header[2 * MAX_ATTRIBUTES];
+    int i, num_attr = 0;
+    AK_PRO;
+    //copied left attributes, then all right attributes
+    for (i = 0; i < state->num_left_out; i++)
+        memcpy(&header[num_attr++], &left->header[state->left_out[i]], sizeof(AK_header));
+    for (i = 0; i < right->num_attr; i++)
+        memcpy(&header[num_attr++], &right->header[i], sizeof(AK_header));
+    state->memory = AK_HASH_JOIN_MEMORY;
+
+    op = AK_operator_create(header, num_attr, left, right, sizeof(AK_join_state), 1);
+    if (op == NULL)
+    {
+        AK_EPI;
+        return NULL;
+    }
+    memcpy(op->state, state, sizeof(AK_join_state));
+    op->open = AK_join_open;
+    op->next = AK_join_next;
+    op->close = AK_join_close;
+    AK_EPI;
+    return op;
+}
+
+AK_operator *AK_join_operator(AK_operator *left, AK_operator *right, struct list_node *attributes)
+{
+    AK_operator *op;
+    AK_join_state *state;
+    struct list_node *attribute;
+    int i;
+    AK_PRO;
+    if (left == NULL || right == NULL)
+    {
+        AK_operator_free(left);
+        AK_operator_free(right);
+        AK_EPI;
+        return NULL;
+    }
+    state = (AK_join_state *)AK_calloc(1, sizeof(AK_join_state));
+    if (state == NULL)
+    {
+        AK_operator_free(left);
+        AK_operator_free(right);
+        AK_EPI;
+        return NULL;
+    }
+    for (attribute = (struct list_node *)AK_First_L2(attributes); attribute != NULL; attribute = (struct list_node *)AK_Next_L2(attribute))
+    {
+        if (state->num_keys == MAX_ATTRIBUTES
+            || (state->left_key[state->num_keys] = AK_iterator_attr_index(left->header, left->num_attr, attribute->data)) == EXIT_ERROR
+            || (state->right_key[state->num_keys] = AK_iterator_attr_index(right->header, right->num_attr, attribute->data)) == EXIT_ERROR)
+        {
+            printf("AK_join_operator: ERROR. Can not join on %s.\n", attribute->data);
+            AK_free(state);
+            AK_operator_free(left);
+            AK_operator_free(right);
+            AK_EPI;
+            return NULL;
+        }
+        state->num_keys++;
+    }
+
+    //left attributes which are not join attributes
+    for (i = 0; i < left->num_attr; i++)
+    {
+        for (attribute = (struct list_node *)AK_First_L2(attributes); attribute != NULL; attribute = (struct list_node *)AK_Next_L2(attribute))
+            if (strcmp(attribute->data, left->header[i].att_name) == 0)
+                break;
+        if (attribute == NULL)
+            state->left_out[state->num_left_out++] = i;
+    }
+
+    op = AK_hash_join_create(left, right, state);
+    AK_free(state);
+    AK_EPI;
+    return op;
+}
+
+AK_operator *AK_equi_join_operator(AK_operator *left, AK_operator *right, int num_keys, int *left_keys, int *right_keys)
+{
+    AK_operator *op;
+    AK_join_state *state;
+    int i;
+    AK_PRO;
+    if (left == NULL || right == NULL || num_keys <= 0 || num_keys > MAX_ATTRIBUTES
+        || (state = (AK_join_state *)AK_calloc(1, sizeof(AK_join_state))) == NULL)
+    {
+        AK_operator_free(left);
+        AK_operator_free(right);
+        AK_EPI;
+        return NULL;
+    }
+    for (i = 0; i < num_keys; i++)
+    {
+        if (left_keys[i] < 0 || left_keys[i] >= left->num_attr || right_keys[i] < 0 || right_keys[i] >= right->num_attr)
+        {
+            printf("AK_equi_join_operator: ERROR. Join attribute %d does not exist.\n", i);
+            AK_free(state);
+            AK_operator_free(left);
+            AK_operator_free(right);
+            AK_EPI;
+            return NULL;
+        }
+        state->left_key[i] = left_keys[i];
+        state->right_key[i] = right_keys[i];
+    }
+    state->num_keys = num_keys;
+    for (i = 0; i < left->num_attr; i++)
+        state->left_out[state->num_left_out++] = i;
+
+    op = AK_hash_join_create(left, right, state);
+    AK_free(state);
+    AK_EPI;
+    return op;
+}
+
+/**
+ * @author agent
+ * @brief  Function that checks whether a point lies below the lower bound of an interval
+ * @param state band join state
+ * @param point row of the point input
+ * @param interval row of the interval input
+ * @return 1 if the point is below the lower bound, 0 otherwise
+ */
+static int AK_band_join_below(AK_band_join_state *state, AK_row *point, AK_row *interval)
+{
+    int result;
+    if (state->low == EXIT_ERROR)
+        return 0;
+    result = AK_iterator_compare_values(point, state->point, interval, state->low);
+    return result < 0 || (result == 0 && state->low_comparison == AK_EXPR_LT);
+}
+
+/**
+ * @author agent
+ * @brief  Function that checks whether a point lies above the upper bound of an interval
+ * @param state band join state
+ * @param point row of the point input
+ * @param interval row of the interval input
+ * @return 1 if the point is above the upper bound, 0 otherwise
+ */
+static int AK_band_join_above(AK_band_join_state *state, AK_row *point, AK_row *interval)
+{
+    int result;
+    if (state->high == EXIT_ERROR)
+        return 0;
+    result = AK_iterator_compare_values(point, state->point, interval, state->high);
+    return result > 0 || (result == 0 && state->high_comparison == AK_EXPR_LT);
+}
+
+/**
+ * @author agent
+ * @brief  Function that reads and sorts both inputs of a band join. The inputs are closed afterwards.
+ * @param op band join node
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_band_join_open(AK_operator *op)
+{
+    AK_band_join_state *state = (AK_band_join_state *)op->state;
+    int result;
+    AK_PRO;
+    state->begin = 0;
+    state->current = EXIT_ERROR;
+    result = AK_sort_read(op, state->point_left ? op->child : op->right, &state->points);
+    if (result == EXIT_SUCCESS)
+        result = AK_sort_read(op, state->point_left ? op->right : op->child, &state->intervals);
+    AK_dbg_messg(MIDDLE, REL_OP, "Band join: %d points, %d intervals\n", state->points.count, state->intervals.count);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @author agent
+ * @brief  Function that produces the next pair of a point and an interval containing it. The intervals are taken in
+ * order of their lower bounds, so the first point of the window of the next interval is never before the one of the
+ * current interval.
+ * @param op band join node
+ * @return AK_ITERATOR_ROW, AK_ITERATOR_END or EXIT_ERROR
+ */
+static int AK_band_join_next(AK_operator *op)
+{
+    AK_band_join_state *state = (AK_band_join_state *)op->state;
+    AK_row *interval, *point, *left, *right;
+    char *value;
+    int i, type, size;
+    AK_PRO;
+    while (state->intervals.pos < state->intervals.count)
+    {
+        interval = state->intervals.rows[state->intervals.pos];
+        if (state->current == EXIT_ERROR)
+        {
+            while (state->begin < state->points.count && AK_band_join_below(state, state->points.rows[state->begin], interval))
+                state->begin++;
+            state->current = state->begin;
+        }
+        if (state->current < state->points.count && !AK_band_join_above(state, state->points.rows[state->current], interval))
+        {
+            point = state->points.rows[state->current++];
+            left = state->point_left ? point : interval;
+            right = state->point_left ? interval : point;
+            AK_row_reset(op->buffer);
+            for (i = 0; i < left->count + right->count; i++)
+            {
+                value = i < left->count ? AK_row_get(left, i, &type, &size) : AK_row_get(right, i - left->count, &type, &size);
+                if (value == NULL || AK_row_append(op->buffer, type, value, size) == EXIT_ERROR)
+                {
+                    AK_EPI;
+                    return EXIT_ERROR;
+                }
+            }
+            op->row = op->buffer;
+            AK_EPI;
+            return AK_ITERATOR_ROW;
+        }
+        state->intervals.pos++;
+        state->current = EXIT_ERROR;
+    }
+    AK_EPI;
+    return AK_ITERATOR_END;
+}
+
+/**
+ * @author agent
+ * @brief  Function that closes a band join, the kept rows are released with the node arena
+ * @param op band join node
+ */
+static void AK_band_join_close(AK_operator *op)
+{
+    AK_band_join_state *state = (AK_band_join_state *)op->state;
+    AK_PRO;
+    AK_free(state->points.rows);
+    AK_free(state->intervals.rows);
+    state->points.rows = state->intervals.rows = NULL;
+    state->points.count = state->points.capacity = state->points.pos = 0;
+    state->intervals.count = state->intervals.capacity = state->intervals.pos = 0;
+    AK_EPI;
+}
+
+AK_operator *AK_band_join_operator(AK_operator *left, AK_operator *right, int point_left, int point, int low, int low_comparison, int high, int high_comparison)
+{
+    AK_operator *op, *points, *intervals;
+    AK_band_join_state *state;
+    AK_header header[2 * MAX_ATTRIBUTES];
+    int i, num_attr = 0;
+    AK_PRO;
+    if (left == NULL || right == NULL)
+    {
+        AK_operator_free(left);
+        AK_operator_free(right);
+        AK_EPI;
+        return NULL;
+    }
+    points = point_left ? left : right;
+    intervals = point_left ? right : left;
+    if (point < 0 || point >= points->num_attr || (low == EXIT_ERROR && high == EXIT_ERROR)
+        || (low != EXIT_ERROR && (low < 0 || low >= intervals->num_attr || (low_comparison != AK_EXPR_LT && low_comparison != AK_EXPR_LE)))
+        || (high != EXIT_ERROR && (high < 0 || high >= intervals->num_attr || (high_comparison != AK_EXPR_LT && high_comparison != AK_EXPR_LE))))
+    {
+        printf("AK_band_join_operator: ERROR. Invalid band condition.\n");
+        AK_operator_free(left);
+        AK_operator_free(right);
+        AK_EPI;
+        return NULL;
+    }
+
+    for (i = 0; i < left->num_attr; i++)
+        memcpy(&header[num_attr++], &left->header[i], sizeof(AK_header));
+    for (i = 0; i < right->num_attr; i++)
+        memcpy(&header[num_attr++], &right->header[i], sizeof(AK_header));
+    op = AK_operator_create(header, num_attr, left, right, sizeof(AK_band_join_state), 1);
+    if (op == NULL)
+    {
+        AK_EPI;
+        return NULL;
+    }
+    state = (AK_band_join_state *)op->state;
+    state->point_left = point_left != 0;
+    state->point = point;
+    state->low = low;
+    state->low_comparison = low_comparison;
+    state->high = high;
+    state->high_comparison = high_comparison;
+    state->points.key[0] = point;
+    state->points.num_keys = 1;
+    //without a lower bound every window starts at the first point, so the intervals need no order
+    state->intervals.key[0] = low;
+    state->intervals.num_keys = low != EXIT_ERROR;
+    op->open = AK_band_join_open;
+    op->next = AK_band_join_next;
+    op->close = AK_band_join_close;
+    AK_EPI;
+    return op;
+}
+
+/**
+ * @author agent
+ * @brief  Function that looks up the group of a row in the hash table of an aggregation
+ * @param state aggregation state
+ * @param row row
+ * @param hash hash of the grouping values of the row
+ * @return group, NULL if the row starts a new group
+ */
+static AK_iterator_group *AK_aggregation_find(AK_aggregation_state *state, AK_row *row, unsigned int hash)
+{
+    AK_iterator_group *group;
+    if (state->buckets == NULL)
+        return NULL;
+    for (group = state->buckets[hash & state->mask]; group != NULL; group = group->next)
+        if (group->hash == hash && AK_iterator_keys_equal(row, state->group_key, group->first, state->group_key, state->num_group))
+            return group;
+    return NULL;
+}
+
+/**
+ * @author agent
+ * @brief  Function that adds a new group to an aggregation. The hash table doubles when it has as many groups as
+ * buckets.
+ * @param op aggregation node
+ * @param row first row of the group, it is copied into the node arena
+ * @param hash hash of the grouping values of the row
+ * @return new group, NULL on error
+ */
+static AK_iterator_group *AK_aggregation_add(AK_operator *op, AK_row *row, unsigned int hash)
+{
+    AK_aggregation_state *state = (AK_aggregation_state *)op->state;
+    AK_iterator_group *group, **buckets;
+    unsigned int num_buckets, g;
+    AK_PRO;
+    if (state->buckets == NULL || (unsigned int)state->count > state->mask)
+    {
+        num_buckets = state->buckets == NULL ? 64 : 2 * (state->mask + 1);
+        buckets = (AK_iterator_group **)AK_calloc(num_buckets, sizeof(AK_iterator_group *));
+        if (buckets == NULL)
+        {
+            AK_EPI;
+            return NULL;
+        }
+        AK_free(state->buckets);
+        state->buckets = buckets;
+        state->mask = num_buckets - 1;
+        for (g = 0; g < (unsigned int)state->count; g++)
+        {
+            state->groups[g]->next = buckets[state->groups[g]->hash & state->mask];
+            buckets[state->groups[g]->hash & state->mask] = state->groups[g];
+        }
+    }
+
+    group = (AK_iterator_group *)AK_arena_calloc(op->scratch, 1, sizeof(AK_iterator_group));
+    if (group == NULL || (group->first = AK_iterator_keep_row(op->scratch, row, row->header)) == NULL
+        || AK_iterator_push((void ***)&state->groups, &state->count, &state->capacity, group) == EXIT_ERROR)
+    {
+        AK_EPI;
+        return NULL;
+    }
+    group->hash = hash;
+    group->next = state->buckets[hash & state->mask];
+    state->buckets[hash & state->mask] = group;
+    state->used += sizeof(AK_iterator_group) + sizeof(AK_iterator_group *) + sizeof(AK_row) + sizeof(int) * (2 * row->count + 1) + row->offset[row->count];
+    AK_EPI;
+    return group;
+}
+
+/**
+ * @author agent
+ * @brief  Function that adds the values of a row to the accumulators of its group
+ * @param op aggregation node
+ * @param group group of the row
+ * @param row row
+ */
+static void AK_aggregation_update(AK_operator *op, AK_iterator_group *group, AK_row *row)
+{
+    AK_aggregation_state *state = (AK_aggregation_state *)op->state;
+    double value;
+    int m;
+    for (m = 0; m < op->num_attr; m++)
+    {
+        if (state->task[m] == AGG_TASK_GROUP)
+            continue;
+        value = AK_iterator_number(row, state->source[m]);
+        switch (state->task[m])
+        {
+        case AGG_TASK_SUM:
+        case AGG_TASK_AVG:
+        case AGG_TASK_AVG_SUM:
+            group->value[m] += value;
+            break;
+        case AGG_TASK_MAX:
+            if (group->count[m] == 0 || value > group->value[m])
+                group->value[m] = value;
+            break;
+        case AGG_TASK_MIN:
+            if (group->count[m] == 0 || value < group->value[m])
+                group->value[m] = value;
+            break;
+        }
+        group->count[m]++;
+    }
+}
+
+/**
+ * @author agent
+ * @brief  Function that adds the aggregates of a batch of values to a group of an aggregation without grouping
+ * @param state aggregation state
+ * @param num_attr number of produced attributes
+ * @param group group
+ * @param numbers values of the batch for every child attribute that is summed, minimized or maximized
+ * @param n number of rows in the batch
+ */
+static void AK_aggregation_accumulate(AK_aggregation_state *state, int num_attr, AK_iterator_group *group, double **numbers, int n)
+{
+    double value;
+    int m;
+    AK_PRO;
+    for (m = 0; m < num_attr && n > 0; m++)
+    {
+        switch (state->task[m])
+        {
+        case AGG_TASK_SUM:
+        case AGG_TASK_AVG:
+        case AGG_TASK_AVG_SUM:
+            group->value[m] += AK_batch_sum(numbers[state->source[m]], NULL, n);
+            break;
+        case AGG_TASK_MAX:
+            value = AK_batch_max(numbers[state->source[m]], NULL, n);
+            if (group->count[m] == 0 || value > group->value[m])
+                group->value[m] = value;
+            break;
+        case AGG_TASK_MIN:
+            value = AK_batch_min(numbers[state->source[m]], NULL, n);
+            if (group->count[m] == 0 || value < group->value[m])
+                group->value[m] = value;
+            break;
+        }
+        group->count[m] += n;
+    }
+    AK_EPI;
+}
+
+/**
+ * @author agent
+ * @brief  Function that adds the aggregates of the rows in the current batch to the only group of an aggregation
+ * @param op aggregation node without grouping
+ */
+static void AK_aggregation_flush(AK_operator *op)
+{
+    AK_aggregation_state *state = (AK_aggregation_state *)op->state;
+    AK_PRO;
+    AK_aggregation_accumulate(state, op->num_attr, state->groups[0], state->numbers, state->batch_rows);
+    state->batch_rows = 0;
+    AK_EPI;
+}
+
+/**
+ * @author agent
+ * @brief  Function that aggregates the batch of a worker of a parallel aggregation into the group of the worker
+ * @param worker worker
+ * @param context aggregation node without grouping
+ * @return EXIT_SUCCESS
+ */
+static int AK_aggregation_parallel_done(AK_parallel_worker *worker, void *context)
+{
+    AK_operator *op = (AK_operator *)context;
+    AK_aggregation_partial *partial = (AK_aggregation_partial *)worker->partial;
+    double *numbers[MAX_ATTRIBUTES];
+    int i;
+    for (i = 0; i < MAX_ATTRIBUTES; i++)
+        numbers[i] = partial->number[i];
+    AK_aggregation_accumulate((AK_aggregation_state *)op->state, op->num_attr, &partial->group, numbers, partial->rows);
+    partial->rows = 0;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @author agent
+ * @brief  Function that copies the aggregated values of a row of a worker of a parallel aggregation into the batch
+ * of the worker, the batch is aggregated into the group of the worker once it is full
+ * @param worker worker
+ * @param row row of the child table
+ * @param context aggregation node without grouping
+ * @return EXIT_SUCCESS
+ */
+static int AK_aggregation_parallel_row(AK_parallel_worker *worker, AK_row *row, void *context)
+{
+    AK_operator *op = (AK_operator *)context;
+    AK_aggregation_state *state = (AK_aggregation_state *)op->state;
+    AK_aggregation_partial *partial = (AK_aggregation_partial *)worker->partial;
+    int i;
+    for (i = 0; i < row->count && i < MAX_ATTRIBUTES; i++)
+        if (state->numbers[i] != NULL)
+            partial->number[i][partial->rows] = AK_iterator_number(row, i);
+    if (++partial->rows == AK_BATCH_SIZE)
+        return AK_aggregation_parallel_done(worker, context);
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @author agent
+ * @brief  Function that adds the group of a worker of a parallel aggregation to the only group of the aggregation
+ * @param worker worker
+ * @param context aggregation node without grouping
+ * @return EXIT_SUCCESS
+ */
+static int AK_aggregation_parallel_merge(AK_parallel_worker *worker, void *context)
+{
+    AK_operator *op = (AK_operator *)context;
+    AK_aggregation_state *state = (AK_aggregation_state *)op->state;
+    AK_iterator_group *group = state->groups[0], *partial = &((AK_aggregation_partial *)worker->partial)->group;
+    int m;
+    AK_PRO;
+    for (m = 0; m < op->num_attr; m++)
+    {
+        if (partial->count[m] == 0)
+            continue;
+        switch (state->task[m])
+        {
+        case AGG_TASK_SUM:
+        case AGG_TASK_AVG:
+        case AGG_TASK_AVG_SUM:
+            group->value[m] += partial->value[m];
+            break;
+        case AGG_TASK_MAX:
+            if (group->count[m] == 0 || partial->value[m] > group->value[m])
+                group->value[m] = partial->value[m];
+            break;
+        case AGG_TASK_MIN:
+            if (group->count[m] == 0 || partial->value[m] < group->value[m])
+                group->value[m] = partial->value[m];
+            break;
+        }
+        group->count[m] += partial->count[m];
+    }
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @author agent
+ * @brief  Function that copies the aggregated values of a row into the current batch of an aggregation without
+ * grouping, the batch is aggregated once it is full
+ * @param op aggregation node without grouping
+ * @param row row
+ */
+static void AK_aggregation_batch(AK_operator *op, AK_row *row)
+{
+    AK_aggregation_state *state = (AK_aggregation_state *)op->state;
+    int i;
+    for (i = 0; i < row->count && i < MAX_ATTRIBUTES; i++)
+        if (state->numbers[i] != NULL)
+            state->numbers[i][state->batch_rows] = AK_iterator_number(row, i);
+    if (++state->batch_rows == AK_BATCH_SIZE)
+        AK_aggregation_flush(op);
+}
+
+/**
+ * @author agent
+ * @brief  Function that creates the temporary tables of a partitioned aggregation
+ * @param op aggregation node
+ * @param input input whose rows are partitioned
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_aggregation_spill(AK_operator *op, AK_operator *input)
+{
+    static int AK_aggregation_spills = 0;
+    AK_aggregation_state *state = (AK_aggregation_state *)op->state;
+    int i;
+    AK_PRO;
+    AK_aggregation_spills++;
+    for (i = 0; i < AK_AGGREGATION_PARTITIONS; i++)
+    {
+        sprintf(state->spill[i], "aggregation_%d_%d", AK_aggregation_spills, i);
+        if (AK_initialize_new_segment(state->spill[i], SEGMENT_TYPE_TABLE, input->header) == EXIT_ERROR)
+        {
+            printf("AK_aggregation_spill: ERROR. Can not create partition %s.\n", state->spill[i]);
+            state->spill[i][0] = '\0';
+            AK_EPI;
+            return EXIT_ERROR;
+        }
+    }
+    state->partitions = AK_AGGREGATION_PARTITIONS;
+    AK_dbg_messg(LOW, REL_OP, "Aggregation: groups larger than %zu bytes, using %d partitions\n", state->memory, state->partitions);
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @author agent
+ * @brief  Function that reads all rows of an input into the groups of an aggregation. Rows of groups that are in
+ * memory update them in place; once the groups use more than the memory of the node, rows of other groups go to the
+ * partitions. The input is closed afterwards.
+ * @param op aggregation node
+ * @param input input node
+ * @param partition 1 if rows may be partitioned, 0 to keep all groups in memory
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_aggregation_read(AK_operator *op, AK_operator *input, int partition)
+{
+    AK_aggregation_state *state = (AK_aggregation_state *)op->state;
+    AK_iterator_group *group;
+    unsigned int hash;
+    int result;
+    AK_PRO;
+    while ((result = AK_operator_next(input)) == AK_ITERATOR_ROW)
+    {
+        if (state->num_group == 0)
+        {
+            if (state->batched)
+                AK_aggregation_batch(op, input->row);
+            else
+                AK_aggregation_update(op, state->groups[0], input->row);
+            continue;
+        }
+        hash = AK_iterator_hash_keys(input->row, state->group_key, state->num_group);
+        if ((group = AK_aggregation_find(state, input->row, hash)) == NULL)
+        {
+            if (state->partitions > 0 && partition)
+            {
+                if (AK_insert_compact_row(state->spill[AK_iterator_partition(hash, state->partitions)], input->row, NULL) == EXIT_ERROR)
+                {
+                    result = EXIT_ERROR;
+                    break;
+                }
+                continue;
+            }
+            if ((group = AK_aggregation_add(op, input->row, hash)) == NULL
+                || (partition && state->used > state->memory && AK_aggregation_spill(op, input) == EXIT_ERROR))
+            {
+                result = EXIT_ERROR;
+                break;
+            }
+        }
+        AK_aggregation_update(op, group, input->row);
+    }
+    if (state->batched)
+        AK_aggregation_flush(op);
+    AK_operator_close(input);
+    AK_EPI;
+    return result == EXIT_ERROR ? EXIT_ERROR : EXIT_SUCCESS;
+}
+
+/**
+ * @author agent
+ * @brief  Function that reads all child rows of an aggregation into groups
+ * @param op aggregation node
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_aggregation_open(AK_operator *op)
+{
+    AK_aggregation_state *state = (AK_aggregation_state *)op->state;
+    AK_parallel_job job;
+    char *table;
+    int i, result;
+    AK_PRO;
+    state->count = state->pos = 0;
+    state->used = 0;
+    state->partitions = 0;
+    state->partition = EXIT_ERROR;
+
+    //without grouping there is exactly one group, even for an empty input
+    if (state->num_group == 0
+        && AK_iterator_push((void ***)&state->groups, &state->count, &state->capacity, AK_arena_calloc(op->scratch, 1, sizeof(AK_iterator_group))) == EXIT_ERROR)
+    {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    //a batch holds the values of every attribute that is summed, minimized or maximized
+    state->batch_rows = 0;
+    memset(state->numbers, 0, sizeof(state->numbers));
+    for (i = 0; state->batched && i < op->num_attr; i++)
+    {
+        if (state->task[i] == AGG_TASK_COUNT || state->task[i] == AGG_TASK_AVG_COUNT || state->numbers[state->source[i]] != NULL)
+            continue;
+        state->numbers[state->source[i]] = (double *)AK_arena_alloc(op->scratch, sizeof(double) * AK_BATCH_SIZE);
+        if (state->numbers[state->source[i]] == NULL)
+        {
+            AK_EPI;
+            return EXIT_ERROR;
+        }
+    }
+
+    //without grouping, the rows of a table are aggregated by a parallel scan if it gets more than one worker
+    table = op->child->next == AK_scan_next ? ((AK_scan_state *)op->child->state)->table : NULL;
+    if (state->batched && table != NULL && AK_parallel_workers(table) > 1)
+    {
+        AK_operator_close(op->child);
+        memset(&job, 0, sizeof(AK_parallel_job));
+        job.row = AK_aggregation_parallel_row;
+        job.done = AK_aggregation_parallel_done;
+        job.merge = AK_aggregation_parallel_merge;
+        job.context = op;
+        job.partial_size = sizeof(AK_aggregation_partial);
+        result = AK_parallel_scan(table, &job);
+        AK_dbg_messg(MIDDLE, REL_OP, "AK_aggregation_open: %s aggregated by %d workers\n", table, job.used);
+    }
+    else
+        result = AK_aggregation_read(op, op->child, 1);
+    AK_dbg_messg(MIDDLE, REL_OP, "AK_aggregation_open: %d groups in memory, %d partitions, arena peak %zu bytes\n", state->count, state->partitions, AK_arena_peak(op->scratch));
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @author agent
+ * @brief  Function that replaces the groups of an aggregation by the groups of its next partition
+ * @param op aggregation node
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_aggregation_load(AK_operator *op)
+{
+    AK_aggregation_state *state = (AK_aggregation_state *)op->state;
+    AK_operator *scan;
+    int result;
+    AK_PRO;
+    state->partition++;
+    state->count = state->pos = 0;
+    state->used = 0;
+    memset(state->buckets, 0, sizeof(AK_iterator_group *) * (state->mask + 1));
+    AK_arena_reset(op->scratch);
+
+    scan = AK_scan_operator(state->spill[state->partition]);
+    if (scan == NULL || AK_operator_open(scan) == EXIT_ERROR)
+    {
+        AK_operator_free(scan);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    result = AK_aggregation_read(op, scan, 0);
+    AK_operator_free(scan);
+    AK_dbg_messg(MIDDLE, REL_OP, "Aggregation: partition %d holds %d groups\n", state->partition, state->count);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @author agent
+ * @brief  Function that produces the row of the next group
+ * @param op aggregation node
+ * @return AK_ITERATOR_ROW, AK_ITERATOR_END or EXIT_ERROR
+ */
+static int AK_aggregation_next(AK_operator *op)
+{
+    AK_aggregation_state *state = (AK_aggregation_state *)op->state;
+    AK_iterator_group *group;
+    char *value;
+    int m, type, size, result;
+    AK_PRO;
+    while (state->pos >= state->count)
+    {
+        if (state->partition + 1 >= state->partitions)
+        {
+            AK_EPI;
+            return AK_ITERATOR_END;
+        }
+        if (AK_aggregation_load(op) == EXIT_ERROR)
+        {
+            AK_EPI;
+            return EXIT_ERROR;
+        }
+    }
+    group = state->groups[state->pos++];
+    AK_row_reset(op->buffer);
+    for (m = 0; m < op->num_attr; m++)
+    {
+        switch (state->task[m])
+        {
+        case AGG_TASK_GROUP:
+            value = AK_row_get(group->first, state->source[m], &type, &size);
+            result = value == NULL ? EXIT_ERROR : AK_row_append(op->buffer, type, value, size);
+            break;
+        case AGG_TASK_COUNT:
+        case AGG_TASK_AVG_COUNT:
+            result = AK_row_append(op->buffer, TYPE_INT, (char *)&group->count[m], sizeof(int));
+            break;
+        case AGG_TASK_AVG:
+            result = AK_iterator_append_number(op->buffer, TYPE_FLOAT, group->count[m] > 0 ? group->value[m] / group->count[m] : 0);
+            break;
+        default:
+            result = AK_iterator_append_number(op->buffer, op->header[m].type, group->value[m]);
+        }
+        if (result == EXIT_ERROR)
+        {
+            AK_EPI;
+            return EXIT_ERROR;
+        }
+    }
+    op->row = op->buffer;
+    AK_EPI;
+    return AK_ITERATOR_ROW;
+}
+
+/**
+ * @author agent
+ * @brief  Function that closes an aggregation and deletes its partitions, the groups themselves are released with
+ * the node arena
+ * @param op aggregation node
+ */
+static void AK_aggregation_close(AK_operator *op)
+{
+    AK_aggregation_state *state = (AK_aggregation_state *)op->state;
+    int i;
+    AK_PRO;
+    AK_free(state->groups);
+    AK_free(state->buckets);
+    state->groups = NULL;
+    state->buckets = NULL;
+    state->count = state->capacity = state->pos = 0;
+    state->mask = 0;
+    for (i = 0; i < AK_AGGREGATION_PARTITIONS; i++)
+        if (state->spill[i][0] != '\0')
+        {
+            AK_delete_segment(state->spill[i], SEGMENT_TYPE_TABLE);
+            state->spill[i][0] = '\0';
+        }
+    state->partitions = 0;
+    AK_EPI;
+}
+
+AK_operator *AK_aggregation_operator(AK_operator *child, AK_agg_input *input)
+{
+    AK_operator *op;
+    AK_aggregation_state state;
+    AK_header header[MAX_ATTRIBUTES + 1];
+    AK_header *temp;
+    char name[MAX_ATT_NAME], *prefix;
+    int i, type;
+    AK_PRO;
+    if (child == NULL)
+    {
+        AK_EPI;
+        return NULL;
+    }
+    memset(&state, 0, sizeof(AK_aggregation_state));
+    memset(header, 0, sizeof(header));
+    for (i = 0; i < input->counter && i < MAX_ATTRIBUTES; i++)
+    {
+        state.task[i] = input->tasks[i];
+        state.source[i] = AK_iterator_attr_index(child->header, child->num_attr, input->attributes[i].att_name);
+        if (state.source[i] == EXIT_ERROR)
+        {
+            printf("AK_aggregation_operator: ERROR. Unknown attribute %s.\n", input->attributes[i].att_name);
+            AK_operator_free(child);
+            AK_EPI;
+            return NULL;
+        }
+        type = child->header[state.source[i]].type;
+        if (type != TYPE_INT && type != TYPE_FLOAT && type != TYPE_NUMBER)
+            type = TYPE_INT;
+
+        //attribute names follow AK_aggregation
+        switch (state.task[i])
+        {
+        case AGG_TASK_GROUP:
+            memcpy(&header[i], &child->header[state.source[i]], sizeof(AK_header));
+            state.group_key[state.num_group++] = state.source[i];
+            continue;
+        case AGG_TASK_COUNT:
+            prefix = "Cnt";
+            type = TYPE_INT;
+            break;
+        case AGG_TASK_SUM:
+            prefix = "Sum";
+            break;
+        case AGG_TASK_MAX:
+            prefix = "Max";
+            break;
+        case AGG_TASK_MIN:
+            prefix = "Min";
+            break;
+        case AGG_TASK_AVG:
+            prefix = "Avg";
+            type = TYPE_FLOAT;
+            break;
+        case AGG_TASK_AVG_COUNT:
+            prefix = "_cAvg";
+            type = TYPE_INT;
+            break;
+        case AGG_TASK_AVG_SUM:
+            prefix = "_sAvg";
+            type = TYPE_FLOAT;
+            break;
+        default:
+            printf("AK_aggregation_operator: ERROR. Unknown aggregation task %d.\n", state.task[i]);
+            AK_operator_free(child);
+            AK_EPI;
+            return NULL;
+        }
+        //a name that does not fit would be cut short and no longer tell the aggregate
+        if (snprintf(name, sizeof(name), "%s(%s)", prefix, input->attributes[i].att_name) >= (int)sizeof(name))
+        {
+            printf("AK_aggregation_operator: ERROR. Attribute name %s is too long.\n", input->attributes[i].att_name);
+            AK_operator_free(child);
+            AK_EPI;
+            return NULL;
+        }
+        temp = (AK_header *)AK_create_header(name, type, FREE_INT, FREE_CHAR, FREE_CHAR);
+        memcpy(&header[i], temp, sizeof(AK_header));
+        AK_free(temp);
+    }
+
+    op = AK_operator_create(header, i, child, NULL, sizeof(AK_aggregation_state), 1);
+    if (op == NULL)
+    {
+        AK_EPI;
+        return NULL;
+    }
+    state.memory = AK_AGGREGATION_MEMORY;
+    //without grouping numeric attributes are aggregated in batches
+    state.batched = state.num_group == 0;
+    for (i = 0; i < op->num_attr; i++)
+    {
+        type = child->header[state.source[i]].type;
+        if (state.task[i] != AGG_TASK_COUNT && state.task[i] != AGG_TASK_AVG_COUNT && type != TYPE_INT && type != TYPE_FLOAT && type != TYPE_NUMBER)
+            state.batched = 0;
+    }
+    memcpy(op->state, &state, sizeof(AK_aggregation_state));
+    op->open = AK_aggregation_open;
+    op->next = AK_aggregation_next;
+    op->close = AK_aggregation_close;
+    AK_EPI;
+    return op;
+}
+
+/**
+ * @author agent
+ * @brief  Function that looks up a row in the hash table of a set operation
+ * @param state set operation state
+ * @param row row
+ * @param hash hash of all values of the row
+ * @return entry with the same values, NULL if there is none
+ */
+static AK_set_entry *AK_set_find(AK_set_state *state, AK_row *row, unsigned int hash)
+{
+    AK_set_entry *entry;
+    if (state->buckets == NULL)
+        return NULL;
+    for (entry = state->buckets[hash & state->mask]; entry != NULL; entry = entry->next)
+        if (entry->hash == hash && AK_iterator_keys_equal(row, state->key, entry->row, state->key, row->count))
+            return entry;
+    return NULL;
+}
+
+/**
+ * @author agent
+ * @brief  Function that adds a row to the hash table of a set operation. The hash table doubles when it has as many
+ * entries as buckets.
+ * @param op set operation node
+ * @param row row, it is copied into the node arena
+ * @param hash hash of all values of the row
+ * @return new entry, NULL on error
+ */
+static AK_set_entry *AK_set_add(AK_operator *op, AK_row *row, unsigned int hash)
+{
+    AK_set_state *state = (AK_set_state *)op->state;
+    AK_set_entry *entry, *next, **buckets;
+    unsigned int num_buckets, b;
+    AK_PRO;
+    if (state->buckets == NULL || (unsigned int)state->count > state->mask)
+    {
+        num_buckets = state->buckets == NULL ? 64 : 2 * (state->mask + 1);
+        buckets = (AK_set_entry **)AK_calloc(num_buckets, sizeof(AK_set_entry *));
+        if (buckets == NULL)
+        {
+            AK_EPI;
+            return NULL;
+        }
+        for (b = 0; state->buckets != NULL && b <= state->mask; b++)
+            for (entry = state->buckets[b]; entry != NULL; entry = next)
+            {
+                next = entry->next;
+                entry->next = buckets[entry->hash & (num_buckets - 1)];
+                buckets[entry->hash & (num_buckets - 1)] = entry;
+            }
+        AK_free(state->buckets);
+        state->buckets = buckets;
+        state->mask = num_buckets - 1;
+    }
+
+    entry = (AK_set_entry *)AK_arena_alloc(op->scratch, sizeof(AK_set_entry));
+    if (entry == NULL || (entry->row = AK_iterator_keep_row(op->scratch, row, op->header)) == NULL)
+    {
+        AK_EPI;
+        return NULL;
+    }
+    entry->hash = hash;
+    entry->count = 0;
+    entry->next = state->buckets[hash & state->mask];
+    state->buckets[hash & state->mask] = entry;
+    state->count++;
+    state->used += sizeof(AK_set_entry) + sizeof(AK_set_entry *) + sizeof(AK_row) + sizeof(int) * (2 * row->count + 1) + row->offset[row->count];
+    AK_EPI;
+    return entry;
+}
+
+/**
+ * @author agent
+ * @brief  Function that empties the hash table of a set operation, the entries are released with the node arena
+ * @param op set operation node
+ */
+static void AK_set_clear(AK_operator *op)
+{
+    AK_set_state *state = (AK_set_state *)op->state;
+    AK_PRO;
+    if (state->buckets != NULL)
+        memset(state->buckets, 0, sizeof(AK_set_entry *) * (state->mask + 1));
+    state->count = 0;
+    state->used = 0;
+    AK_arena_reset(op->scratch);
+    AK_EPI;
+}
+
+/**
+ * @author agent
+ * @brief  Function that creates the temporary tables of a partitioned set operation. The rows kept in the hash table
+ * so far are moved into the partitions of the hash table, every one as many times as the right input holds it.
+ * @param op set operation node
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_set_spill(AK_operator *op)
+{
+    static int AK_set_spills = 0;
+    AK_set_state *state = (AK_set_state *)op->state;
+    AK_set_entry *entry;
+    unsigned int b;
+    int side, i, n;
+    AK_PRO;
+    AK_set_spills++;
+    //a union only partitions the rows it streams
+    for (side = state->operation == AK_SET_UNION; side < 2; side++)
+        for (i = 0; i < AK_SET_PARTITIONS; i++)
+        {
+            sprintf(state->spill[side][i], "set_%d_%s%d", AK_set_spills, side == 0 ? "build" : "probe", i);
+            if (AK_initialize_new_segment(state->spill[side][i], SEGMENT_TYPE_TABLE, op->header) == EXIT_ERROR)
+            {
+                printf("AK_set_spill: ERROR. Can not create partition %s.\n", state->spill[side][i]);
+                state->spill[side][i][0] = '\0';
+                AK_EPI;
+                return EXIT_ERROR;
+            }
+        }
+    state->partitions = AK_SET_PARTITIONS;
+    AK_dbg_messg(LOW, REL_OP, "Set operation: rows larger than %zu bytes, using %d partitions\n", state->memory, state->partitions);
+    if (state->operation == AK_SET_UNION)
+    {
+        AK_EPI;
+        return EXIT_SUCCESS;
+    }
+
+    for (b = 0; b <= state->mask; b++)
+        for (entry = state->buckets[b]; entry != NULL; entry = entry->next)
+            for (n = 0; n < entry->count; n++)
+                if (AK_insert_compact_row(state->spill[0][AK_iterator_partition(entry->hash, AK_SET_PARTITIONS)], entry->row, NULL) == EXIT_ERROR)
+                {
+                    AK_EPI;
+                    return EXIT_ERROR;
+                }
+    AK_set_clear(op);
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @author agent
+ * @brief  Function that reads the rows of the right input of an intersection or difference into the hash table,
+ * counting the copies of every row. Once the entries use more than the memory of the node, the rows go to the
+ * partitions instead. The input is closed afterwards.
+ * @param op set operation node
+ * @param input right input or the scan of a partition
+ * @param partition 1 if rows may be partitioned, 0 to keep all rows in memory
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_set_build(AK_operator *op, AK_operator *input, int partition)
+{
+    AK_set_state *state = (AK_set_state *)op->state;
+    AK_set_entry *entry;
+    unsigned int hash;
+    int result;
+    AK_PRO;
+    while ((result = AK_operator_next(input)) == AK_ITERATOR_ROW)
+    {
+        hash = AK_iterator_hash_keys(input->row, state->key, op->num_attr);
+        if (state->partitions > 0 && partition)
+            result = AK_insert_compact_row(state->spill[0][AK_iterator_partition(hash, AK_SET_PARTITIONS)], input->row, NULL);
+        else if ((entry = AK_set_find(state, input->row, hash)) != NULL || (entry = AK_set_add(op, input->row, hash)) != NULL)
+        {
+            entry->count++;
+            if (partition && state->used > state->memory)
+                result = AK_set_spill(op);
+        }
+        else
+            result = EXIT_ERROR;
+        if (result == EXIT_ERROR)
+            break;
+    }
+    AK_operator_close(input);
+    AK_EPI;
+    return result == EXIT_ERROR ? EXIT_ERROR : EXIT_SUCCESS;
+}
+
+/**
+ * @author agent
+ * @brief  Function that loads the next partition of a partitioned set operation: the rows of its hash table partition
+ * are read into the hash table and a scan of its streamed partition becomes the input
+ * @param op set operation node
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_set_load(AK_operator *op)
+{
+    AK_set_state *state = (AK_set_state *)op->state;
+    AK_operator *scan;
+    AK_PRO;
+    AK_operator_free(state->scan);
+    state->scan = state->input = NULL;
+    state->partition++;
+    AK_set_clear(op);
+
+    if (state->operation != AK_SET_UNION)
+    {
+        scan = AK_scan_operator(state->spill[0][state->partition]);
+        if (scan == NULL || AK_operator_open(scan) == EXIT_ERROR || AK_set_build(op, scan, 0) == EXIT_ERROR)
+        {
+            AK_operator_free(scan);
+            AK_EPI;
+            return EXIT_ERROR;
+        }
+        AK_operator_free(scan);
+    }
+    AK_dbg_messg(MIDDLE, REL_OP, "Set operation: partition %d holds %d rows\n", state->partition, state->count);
+
+    state->scan = AK_scan_operator(state->spill[1][state->partition]);
+    if (state->scan == NULL || AK_operator_open(state->scan) == EXIT_ERROR)
+    {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    state->input = state->scan;
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @author agent
+ * @brief  Function that opens a set operation. Intersection and difference read their right input into the hash
+ * table; if it was partitioned, the left input is partitioned too and the first pair of partitions is loaded.
+ * @param op set operation node
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_set_open(AK_operator *op)
+{
+    AK_set_state *state = (AK_set_state *)op->state;
+    int result;
+    AK_PRO;
+    state->count = state->partitions = 0;
+    state->used = 0;
+    state->partition = EXIT_ERROR;
+    state->input = op->child;
+    if (state->operation == AK_SET_UNION)
+    {
+        AK_EPI;
+        return EXIT_SUCCESS;
+    }
+
+    if (AK_set_build(op, op->right, 1) == EXIT_ERROR)
+    {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    if (state->partitions == 0)
+    {
+        AK_dbg_messg(MIDDLE, REL_OP, "Set operation: %d distinct right rows in memory\n", state->count);
+        AK_EPI;
+        return EXIT_SUCCESS;
+    }
+
+    while ((result = AK_operator_next(op->child)) == AK_ITERATOR_ROW)
+        if (AK_insert_compact_row(state->spill[1][AK_iterator_partition(AK_iterator_hash_keys(op->child->row, state->key, op->num_attr), AK_SET_PARTITIONS)], op->child->row, NULL) == EXIT_ERROR)
+        {
+            result = EXIT_ERROR;
+            break;
+        }
+    AK_operator_close(op->child);
+    AK_EPI;
+    return result == EXIT_ERROR ? EXIT_ERROR : AK_set_load(op);
+}
+
+/**
+ * @author agent
+ * @brief  Function that decides whether a streamed row of a set operation is produced, updating the hash table
+ * @param op set operation node
+ * @param row streamed row
+ * @return 1 if the row is produced, 0 if it is skipped, EXIT_ERROR on error
+ */
+static int AK_set_accept(AK_operator *op, AK_row *row)
+{
+    AK_set_state *state = (AK_set_state *)op->state;
+    AK_set_entry *entry;
+    unsigned int hash = AK_iterator_hash_keys(row, state->key, op->num_attr);
+    entry = AK_set_find(state, row, hash);
+    switch (state->operation)
+    {
+    case AK_SET_INTERSECT:
+        //every copy in the right input matches one left copy, or only the first one without ALL
+        if (entry == NULL || entry->count == 0)
+            return 0;
+        entry->count = state->all ? entry->count - 1 : 0;
+        return 1;
+    case AK_SET_DIFFERENCE:
+        if (state->all)
+        {
+            if (entry == NULL || entry->count == 0)
+                return 1;
+            entry->count--;
+            return 0;
+        }
+        //without ALL, a produced left row is kept with count 0 so its copies are skipped
+        if (entry != NULL)
+            return 0;
+        return AK_set_add(op, row, hash) == NULL ? EXIT_ERROR : 1;
+    default:
+        if (entry != NULL)
+            return 0;
+        //rows that are not in memory once it is full are produced when their partition is streamed
+        if (state->partitions > 0 && state->partition == EXIT_ERROR)
+            return AK_insert_compact_row(state->spill[1][AK_iterator_partition(hash, AK_SET_PARTITIONS)], row, NULL) == EXIT_ERROR ? EXIT_ERROR : 0;
+        if (AK_set_add(op, row, hash) == NULL
+            || (state->partition == EXIT_ERROR && state->used > state->memory && AK_set_spill(op) == EXIT_ERROR))
+            return EXIT_ERROR;
+        return 1;
+    }
+}
+
+/**
+ * @author agent
+ * @brief  Function that produces the next row of a set operation. A union streams the left and then the right child,
+ * the other operations the left child; the partitions follow.
+ * @param op set operation node
+ * @return AK_ITERATOR_ROW, AK_ITERATOR_END or EXIT_ERROR
+ */
+static int AK_set_next(AK_operator *op)
+{
+    AK_set_state *state = (AK_set_state *)op->state;
+    int result;
+    AK_PRO;
+    for (;;)
+    {
+        result = AK_operator_next(state->input);
+        if (result == AK_ITERATOR_END)
+        {
+            if (state->input == op->child && state->operation == AK_SET_UNION)
+            {
+                state->input = op->right;
+                continue;
+            }
+            if (state->partition + 1 < state->partitions)
+            {
+                if (AK_set_load(op) == EXIT_ERROR)
+                {
+                    AK_EPI;
+                    return EXIT_ERROR;
+                }
+                continue;
+            }
+        }
+        if (result != AK_ITERATOR_ROW)
+        {
+            AK_EPI;
+            return result;
+        }
+        if (!state->all || state->operation != AK_SET_UNION)
+            result = AK_set_accept(op, state->input->row);
+        if (result == EXIT_ERROR)
+        {
+            AK_EPI;
+            return EXIT_ERROR;
+        }
+        if (result)
+        {
+            op->row = state->input->row;
+            AK_EPI;
+            return AK_ITERATOR_ROW;
+        }
+    }
+}
+
+/**
+ * @author agent
+ * @brief  Function that closes a set operation and deletes its partitions, the kept rows are released with the node
+ * arena
+ * @param op set operation node
+ */
+static void AK_set_close(AK_operator *op)
+{
+    AK_set_state *state = (AK_set_state *)op->state;
+    int side, i;
+    AK_PRO;
+    AK_operator_free(state->scan);
+    state->scan = state->input = NULL;
+    AK_free(state->buckets);
+    state->buckets = NULL;
+    state->mask = 0;
+    state->count = 0;
+    for (side = 0; side < 2; side++)
+        for (i = 0; i < AK_SET_PARTITIONS; i++)
+            if (state->spill[side][i][0] != '\0')
+            {
+                AK_delete_segment(state->spill[side][i], SEGMENT_TYPE_TABLE);
+                state->spill[side][i][0] = '\0';
+            }
+    state->partitions = 0;
+    AK_EPI;
+}
+
+AK_operator *AK_set_operator(AK_operator *left, AK_operator *right, int operation, int all)
+{
+    AK_operator *op;
+    AK_set_state *state;
+    int i;
+    AK_PRO;
+    if (left == NULL || right == NULL)
+    {
+        AK_operator_free(left);
+        AK_operator_free(right);
+        AK_EPI;
+        return NULL;
+    }
+    if (operation != AK_SET_UNION && operation != AK_SET_INTERSECT && operation != AK_SET_DIFFERENCE)
+    {
+        printf("AK_set_operator: ERROR. Unknown set operation %d.\n", operation);
+        AK_operator_free(left);
+        AK_operator_free(right);
+        AK_EPI;
+        return NULL;
+    }
+    if (left->num_attr != right->num_attr)
+    {
+        printf("AK_set_operator: ERROR. Not same number of the attributes!\n");
+        AK_operator_free(left);
+        AK_operator_free(right);
+        AK_EPI;
+        return NULL;
+    }
+    for (i = 0; i < left->num_attr; i++)
+        if (left->header[i].type != right->header[i].type)
+        {
+            printf("AK_set_operator: ERROR. Attributes %s and %s are not of the same type!\n", left->header[i].att_name, right->header[i].att_name);
+            AK_operator_free(left);
+            AK_operator_free(right);
+            AK_EPI;
+            return NULL;
+        }
+
+    op = AK_operator_create(left->header, left->num_attr, left, right, sizeof(AK_set_state), 0);
+    if (op == NULL)
+    {
+        AK_EPI;
+        return NULL;
+    }
+    state = (AK_set_state *)op->state;
+    state->operation = operation;
+    state->all = all != 0;
+    for (i = 0; i < op->num_attr; i++)
+        state->key[i] = i;
+    state->memory = AK_SET_MEMORY;
+    state->partition = EXIT_ERROR;
+    op->open = AK_set_open;
+    op->next = AK_set_next;
+    op->close = AK_set_close;
+    AK_EPI;
+    return op;
+}
+
+int AK_operator_open(AK_operator *op)
+{
+    AK_PRO;
+    if (op == NULL)
+    {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    AK_operator_close(op);
+    if ((op->child != NULL && AK_operator_open(op->child) == EXIT_ERROR)
+        || (op->right != NULL && AK_operator_open(op->right) == EXIT_ERROR))
+    {
+        AK_operator_close(op->child);
+        AK_operator_close(op->right);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    op->is_open = 1;
+    if (op->open(op) == EXIT_ERROR)
+    {
+        AK_operator_close(op);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+int AK_operator_next(AK_operator *op)
+{
+    int result;
+    AK_PRO;
+    if (op == NULL || !op->is_open)
+    {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    result = op->next(op);
+    AK_EPI;
+    return result;
+}
+
+void AK_operator_close(AK_operator *op)
+{
+    AK_PRO;
+    if (op == NULL || !op->is_open)
+    {
+        AK_EPI;
+        return;
+    }
+    op->close(op);
+    op->is_open = 0;
+    op->row = op->buffer;
+    AK_arena_reset(op->scratch);
+    AK_operator_close(op->child);
+    AK_operator_close(op->right);
+    AK_EPI;
+}
+
+void AK_operator_free(AK_operator *op)
+{
+    AK_PRO;
+    if (op == NULL)
+    {
+        AK_EPI;
+        return;
+    }
+    AK_operator_close(op);
+    AK_operator_free(op->child);
+    AK_operator_free(op->right);
+    AK_row_free(op->buffer);
+    AK_arena_destroy(op->scratch);
+    AK_free(op->state);
+    AK_free(op->header);
+    AK_free(op);
+    AK_EPI;
+}
+
+int AK_iterator_materialize(AK_operator *root, char *table)
+{
+    int rows;
+    AK_PRO;
+    if (root == NULL)
+    {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    if (AK_initialize_new_segment(table, SEGMENT_TYPE_TABLE, root->header) == EXIT_ERROR)
+    {
+        printf("AK_iterator_materialize: ERROR. Can not create table %s.\n", table);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    rows = AK_iterator_insert(root, table);
+    AK_EPI;
+    return rows;
+}
+
+int AK_iterator_insert(AK_operator *root, char *table)
+{
+    int result, rows = 0;
+    AK_PRO;
+    if (root == NULL || AK_operator_open(root) == EXIT_ERROR)
+    {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    while ((result = AK_operator_next(root)) == AK_ITERATOR_ROW)
+    {
+        if (AK_insert_compact_row(table, root->row, NULL) == EXIT_ERROR)
+        {
+            result = EXIT_ERROR;
+            break;
+        }
+        rows++;
+    }
+    AK_operator_close(root);
+    AK_dbg_messg(LOW, REL_OP, "AK_iterator_insert: %d rows written to %s\n", rows, table);
+    AK_EPI;
+    return result == EXIT_ERROR ? EXIT_ERROR : rows;
+}
+
+int AK_iterator_count(AK_operator *op)
+{
+    int result, rows = 0;
+    AK_PRO;
+    if (AK_operator_open(op) == EXIT_ERROR)
+    {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    while ((result = AK_operator_next(op)) == AK_ITERATOR_ROW)
+        rows++;
+    AK_operator_close(op);
+    AK_EPI;
+    return result == EXIT_ERROR ? EXIT_ERROR : rows;
+}
+
+int AK_operator_set_memory(AK_operator *op, size_t memory)
+{
+    AK_PRO;
+    if (op == NULL || op->is_open || memory == 0)
+    {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    if (op->next == AK_sort_next)
+        ((AK_sort_state *)op->state)->memory = memory;
+    else if (op->next == AK_join_next)
+        ((AK_join_state *)op->state)->memory = memory;
+    else if (op->next == AK_aggregation_next)
+        ((AK_aggregation_state *)op->state)->memory = memory;
+    else if (op->next == AK_set_next)
+        ((AK_set_state *)op->state)->memory = memory;
+    else
+    {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+void AK_operator_describe(AK_operator *op, AK_operator_info *info)
+{
+    AK_PRO;
+    memset(info, 0, sizeof(AK_operator_info));
+    if (op == NULL)
+    {
+        AK_EPI;
+        return;
+    }
+    info->index_scan = op->next == AK_index_scan_next;
+    if (op->next == AK_select_next)
+    {
+        info->batched = ((AK_select_state *)op->state)->batch != NULL;
+        info->parallel = ((AK_select_state *)op->state)->hits != NULL;
+    }
+    else if (op->next == AK_sort_next)
+        info->partitions = ((AK_sort_state *)op->state)->num_runs;
+    else if (op->next == AK_join_next)
+        info->partitions = ((AK_join_state *)op->state)->partitions;
+    else if (op->next == AK_aggregation_next)
+    {
+        info->batched = ((AK_aggregation_state *)op->state)->batched;
+        info->partitions = ((AK_aggregation_state *)op->state)->partitions;
+    }
+    else if (op->next == AK_set_next)
+        info->partitions = ((AK_set_state *)op->state)->partitions;
+    AK_EPI;
+}
+
+/**
+ * @author agent
+ * @brief  Function for testing the iterator executor
+ * @return Test result - number of successful and unsuccessful tests
+ */
+TestResult AK_iterator_test()
+{
+    AK_operator *plan, *inner;
+    AK_agg_input input;
+    AK_header *header;
+    struct list_node *list = (struct list_node *)AK_malloc(sizeof(struct list_node));
+    int successful = 0, failed = 0, rows, expected, result, year, i, j, sorted, sum;
+    AK_row *previous;
+    char *value;
+    AK_PRO;
+    printf("\n********** ITERATOR TEST **********\n");
+    AK_Init_L3(&list);
+
+    //scan produces every row of the table
+    rows = AK_iterator_count(plan = AK_scan_operator("student"));
+    expected = AK_get_num_records("student");
+    AK_operator_free(plan);
+    printf("Scan of student: %d rows, expected %d\n", rows, expected);
+    if (rows > 0 && rows == expected)
+        successful++;
+    else
+        failed++;
+
+    //selection with year < 2008 equals the rows counted by hand
+    year = 2008;
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "year", sizeof("year"), list);
+    AK_InsertAtEnd_L3(TYPE_INT, (char *)&year, sizeof(int), list);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "<", sizeof("<"), list);
+    plan = AK_scan_operator("student");
+    expected = 0;
+    if (AK_operator_open(plan) == EXIT_SUCCESS)
+    {
+        i = AK_iterator_attr_index(plan->header, plan->num_attr, "year");
+        while (AK_operator_next(plan) == AK_ITERATOR_ROW)
+            if (AK_iterator_number(plan->row, i) < year)
+                expected++;
+    }
+    plan = AK_select_operator(plan, list);
+    rows = AK_iterator_count(plan);
+    AK_operator_free(plan);
+    AK_DeleteAll_L3(&list);
+    printf("Selection year < 2008: %d rows, expected %d\n", rows, expected);
+    if (rows > 0 && rows == expected)
+        successful++;
+    else
+        failed++;
+
+    //sort by firstname produces ordered rows, projection computes weight+year
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "firstname", sizeof("firstname"), list);
+    plan = AK_sort_operator(AK_scan_operator("student"), list);
+    AK_DeleteAll_L3(&list);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "firstname", sizeof("firstname"), list);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "weight", sizeof("weight"), list);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "year", sizeof("year"), list);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "weight+year", sizeof("weight+year"), list);
+    plan = AK_project_operator(plan, list);
+    AK_DeleteAll_L3(&list);
+    rows = 0;
+    sorted = plan != NULL && plan->num_attr == 4 && plan->header[3].type == TYPE_FLOAT
+        && strcmp(plan->header[3].att_name, "weight+year") == 0;
+    if (sorted && AK_operator_open(plan) == EXIT_SUCCESS)
+    {
+        previous = AK_row_new(plan->header, plan->num_attr);
+        while ((result = AK_operator_next(plan)) == AK_ITERATOR_ROW)
+        {
+            if ((rows > 0 && AK_iterator_compare_values(previous, 0, plan->row, 0) > 0)
+                || AK_iterator_number(plan->row, 3) != (float)(AK_iterator_number(plan->row, 1) + AK_iterator_number(plan->row, 2)))
+                sorted = 0;
+            AK_row_reset(previous);
+            value = AK_row_get(plan->row, 0, &i, &j);
+            AK_row_append(previous, i, value, j);
+            rows++;
+        }
+        AK_row_free(previous);
+        AK_operator_close(plan);
+        sorted = sorted && result == AK_ITERATOR_END;
+    }
+    AK_operator_free(plan);
+    printf("Sort and projection: %d rows, %s\n", rows, sorted ? "ordered" : "not ordered");
+    if (sorted && rows == AK_get_num_records("student"))
+        successful++;
+    else
+        failed++;
+
+    //join employee and department on id_department, expected rows are counted with two scans
+    expected = 0;
+    plan = AK_scan_operator("employee");
+    inner = AK_scan_operator("department");
+    if (AK_operator_open(plan) == EXIT_SUCCESS)
+    {
+        i = AK_iterator_attr_index(plan->header, plan->num_attr, "id_department");
+        j = AK_iterator_attr_index(inner->header, inner->num_attr, "id_department");
+        while (AK_operator_next(plan) == AK_ITERATOR_ROW)
+        {
+            AK_operator_open(inner);
+            while (AK_operator_next(inner) == AK_ITERATOR_ROW)
+                if (AK_iterator_number(plan->row, i) == AK_iterator_number(inner->row, j))
+                    expected++;
+            AK_operator_close(inner);
+        }
+        AK_operator_close(plan);
+    }
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "id_department", sizeof("id_department"), list);
+    plan = AK_join_operator(plan, inner, list);
+    AK_DeleteAll_L3(&list);
+    rows = AK_iterator_count(plan);
+    printf("Join of employee and department: %d rows, expected %d\n", rows, expected);
+    if (plan != NULL && rows > 0 && rows == expected && plan->num_attr == plan->child->num_attr - 1 + plan->right->num_attr)
+        successful++;
+    else
+        failed++;
+    AK_operator_free(plan);
+
+    //grouping employee by department, the counts add up to the number of rows
+    AK_agg_input_init(&input);
+    header = AK_get_header("employee");
+    for (i = 0; i < AK_num_attr("employee"); i++)
+    {
+        if (strcmp(header[i].att_name, "id_department") == 0)
+            AK_agg_input_add(header[i], AGG_TASK_GROUP, &input);
+        else if (strcmp(header[i].att_name, "id_prof") == 0)
+            AK_agg_input_add(header[i], AGG_TASK_COUNT, &input);
+    }
+    AK_free(header);
+    plan = AK_aggregation_operator(AK_scan_operator("employee"), &input);
+    sum = rows = 0;
+    if (plan != NULL && AK_operator_open(plan) == EXIT_SUCCESS)
+    {
+        j = AK_iterator_attr_index(plan->header, plan->num_attr, "Cnt(id_prof)");
+        while (AK_operator_next(plan) == AK_ITERATOR_ROW)
+        {
+            sum += (int)AK_iterator_number(plan->row, j);
+            rows++;
+        }
+        AK_operator_close(plan);
+    }
+    AK_operator_free(plan);
+    printf("Aggregation of employee by id_department: %d groups, %d rows\n", rows, sum);
+    if (rows > 0 && sum == AK_get_num_records("employee"))
+        successful++;
+    else
+        failed++;
+
+    //a whole plan written into a table
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "firstname", sizeof("firstname"), list);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "year", sizeof("year"), list);
+    rows = AK_iterator_materialize(plan = AK_project_operator(AK_scan_operator("student"), list), "iterator_result");
+    AK_operator_free(plan);
+    AK_DeleteAll_L3(&list);
+    AK_print_table("iterator_result");
+    printf("Materialized %d rows into iterator_result\n", rows);
+    if (rows > 0 && rows == AK_get_num_records("iterator_result") && AK_num_attr("iterator_result") == 2)
+        successful++;
+    else
+        failed++;
+    AK_delete_segment("iterator_result", SEGMENT_TYPE_TABLE);
+
+    AK_free(list);
+    AK_EPI;
+    return TEST_result(successful, failed);
+}
@@ -0,0 +1,410 @@
+/**
+@file iterator.h Header file that provides data structures and functions for the pipelined (iterator) executor
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#ifndef ITERATOR
+#define ITERATOR
+
+#include "../auxi/test.h"
+#include "../auxi/constants.h"
+#include "../auxi/mempro.h"
+#include "../file/fileio.h"
+#include "../file/table.h"
+#include "../file/parallel.h"
+#include "../file/idx/btree.h"
+#include "../file/idx/hash.h"
+#include "../file/idx/roaring.h"
+#include "expression_check.h"
+#include "batch.h"
+#include "projection.h"
+#include "aggregation.h"
+
+/// value returned by next when the operator produced a row
+#define AK_ITERATOR_ROW 1
+/// value returned by next when the operator has no more rows
+#define AK_ITERATOR_END 0
+/// bytes of build rows a hash join keeps in memory before it partitions its inputs
+#define AK_HASH_JOIN_MEMORY (4 * 1024 * 1024)
+/// number of partitions of each input of a hash join that does not fit into memory
+#define AK_HASH_JOIN_PARTITIONS 8
+/// bytes of rows a sort keeps in memory before it writes them into a sorted run
+#define AK_SORT_MEMORY (4 * 1024 * 1024)
+/// bytes of groups an aggregation keeps in memory before it partitions the rows of further groups
+#define AK_AGGREGATION_MEMORY (4 * 1024 * 1024)
+/// number of partitions of the rows of an aggregation whose groups do not fit into memory
+#define AK_AGGREGATION_PARTITIONS 8
+/// bytes of rows a set operation keeps in its hash table before it partitions its inputs
+#define AK_SET_MEMORY (4 * 1024 * 1024)
+/// number of partitions of each input of a set operation that does not fit into memory
+#define AK_SET_PARTITIONS 8
+/// set operations of AK_set_operator
+#define AK_SET_UNION 0
+#define AK_SET_INTERSECT 1
+#define AK_SET_DIFFERENCE 2
+
+/**
+ * @author agent
+ * @struct AK_operator
+ * @brief Structure that defines one node of a query plan. Nodes are opened, pulled row by row with next and closed;
+ * a node pulls the rows of its children on demand, so a plan does not write intermediate tables. After next returned
+ * AK_ITERATOR_ROW the current row is in row, it stays valid until the next call of next or close.
+ */
+typedef struct AK_operator {
+    /// prepares the node (and its children) for producing rows
+    int (*open)(struct AK_operator *op);
+    /// produces the next row: AK_ITERATOR_ROW, AK_ITERATOR_END or EXIT_ERROR
+    int (*next)(struct AK_operator *op);
+    /// releases everything open acquired
+    void (*close)(struct AK_operator *op);
+    /// input of the node (NULL for scans)
+    struct AK_operator *child;
+    /// second input of binary nodes
+    struct AK_operator *right;
+    /// header of the produced rows (MAX_ATTRIBUTES entries, ended by an empty entry)
+    AK_header *header;
+    /// number of attributes in header
+    int num_attr;
+    /// current row, it may belong to a child or to a materialized input
+    AK_row *row;
+    /// row owned by the node, for nodes that build their own rows
+    AK_row *buffer;
+    /// memory of the node that lives from open to close
+    AK_arena *scratch;
+    /// private state of the node
+    void *state;
+    /// 1 between open and close
+    int is_open;
+} AK_operator;
+
+/**
+ * @author agent
+ * @struct AK_operator_info
+ * @brief Structure that describes how a node produces its rows, see AK_operator_describe
+ */
+typedef struct {
+    /// 1 for a node reading the rows found by an index
+    int index_scan;
+    /// 1 for a selection or aggregation working on batches of rows
+    int batched;
+    /// 1 for a selection whose table was scanned by parallel workers
+    int parallel;
+    /// runs of a sort, partitions of a hash join, aggregation or set operation, 0 if its rows fit into memory
+    int partitions;
+} AK_operator_info;
+
+/**
+ * @author agent
+ * @brief  Function that creates a node reading all rows of a table
+ * @param table table name
+ * @return new node, NULL if the table does not exist
+ */
+AK_operator *AK_scan_operator(char *table);
+
+/**
+ * @author agent
+ * @brief  Function that creates a node reading the rows of a table found by a range scan of a B+tree index on it.
+ * The bounds are values of the first key attribute and both are included. All RIDs are read from the index when the
+ * node is opened and sorted by address, so every block is read once and rows come in table order.
+ * @param table table name
+ * @param index name of a B+tree index of the table
+ * @param low lower bound, NULL for none
+ * @param high upper bound, NULL for none
+ * @return new node, NULL if the table does not exist
+ */
+AK_operator *AK_index_scan_operator(char *table, char *index, struct list_node *low, struct list_node *high);
+
+/**
+ * @author agent
+ * @brief  Function that creates a node reading the rows of a table whose key attributes of a hash index on it are
+ * equal to values. The RIDs are read from the bucket of the values when the node is opened and sorted by address.
+ * @param table table name
+ * @param index name of a hash index of the table
+ * @param key values of all key attributes in the order of the key
+ * @return new node, NULL if the table does not exist
+ */
+AK_operator *AK_hash_scan_operator(char *table, char *index, struct list_node *key);
+
+/**
+ * @author agent
+ * @brief  Function that creates a node reading the rows of a table whose attributes of compressed bitmap indexes on
+ * it are equal to values. The bitmaps of the values are intersected when the node is opened; their row IDs are in
+ * table order already.
+ * @param table table name
+ * @param indexes names of compressed bitmap indexes of the table
+ * @param values values of the indexed attributes, one for every index
+ * @return new node, NULL if the table does not exist
+ */
+AK_operator *AK_roaring_scan_operator(char *table, struct list_node *indexes, struct list_node *values);
+
+/**
+ * @author agent
+ * @brief  Function that chooses how the rows of a table are read for a selection. If the expression is a conjunction
+ * in which the attributes of two or more compressed bitmap indexes of the table (per the AK_index catalog) are equal
+ * to constants, the rows come from the intersection of their bitmaps. Otherwise, if every key attribute of a hash
+ * index of the table is equal to a constant, the rows come from a hash index scan. Otherwise, if an equality or a range
+ * compares the first key attribute of a B+tree index of the table with a constant, they come from an index scan; an
+ * equality is preferred to a range bounded on both sides and that to a range bounded on one side. The bitmap of one
+ * compressed bitmap index whose attribute is equal to a constant is preferred to a range, not to an equality on a
+ * B+tree index. Otherwise the whole table is scanned.
+ * The node may produce rows that do not satisfy the expression, it has to be the child of a selection with the same
+ * expression.
+ * @param table table name
+ * @param expr list with postfix notation of the logical expression, may be NULL
+ * @return new node, NULL if the table does not exist
+ */
+AK_operator *AK_access_operator(char *table, struct list_node *expr);
+
+/**
+ * @author agent
+ * @brief  Function that creates a node passing on the rows of its child which satisfy an expression. Expressions of
+ * comparisons between numeric attributes and constants joined by AND and OR are evaluated on batches of
+ * AK_BATCH_SIZE child rows with the kernels of batch.c; other expressions are evaluated row by row.
+ * @param child input node, owned by the new node
+ * @param expr list with postfix notation of the logical expression
+ * @return new node, NULL on error
+ */
+AK_operator *AK_select_operator(AK_operator *child, struct list_node *expr);
+
+/**
+ * @author agent
+ * @brief  Function that creates a node producing the given attributes of its child rows. An attribute may also be an
+ * arithmetic expression of two numeric attributes, like "weight+year".
+ * @param child input node, owned by the new node
+ * @param attributes list of attribute names in output order
+ * @return new node, NULL on error
+ */
+AK_operator *AK_project_operator(AK_operator *child, struct list_node *attributes);
+
+/**
+ * @author agent
+ * @brief  Function that creates a node producing the rows of its child ordered by the given attributes. When the
+ * node is opened the input is read and sorted in memory; each time the rows use more than AK_SORT_MEMORY bytes they
+ * are written into a sorted temporary table (a run), and all runs are merged while the rows are produced. Equal rows
+ * keep their input order.
+ * @param child input node, owned by the new node
+ * @param attributes list of attribute names to sort by, most significant first; an attribute may be followed by a
+ * TYPE_OPERATOR element "ASC" or "DESC", ascending order is the default
+ * @return new node, NULL on error
+ */
+AK_operator *AK_sort_operator(AK_operator *child, struct list_node *attributes);
+
+/**
+ * @author agent
+ * @brief  Function that creates a sort node producing only the first rows, as ORDER BY ... LIMIT does. The node
+ * keeps at most limit rows in a heap while it reads the input, see AK_sort_operator.
+ * @param child input node, owned by the new node
+ * @param attributes list of attribute names to sort by, as for AK_sort_operator
+ * @param limit maximal number of produced rows, 0 for all rows
+ * @return new node, NULL on error
+ */
+AK_operator *AK_sort_limit_operator(AK_operator *child, struct list_node *attributes, int limit);
+
+/**
+ * @author agent
+ * @brief  Function that creates a natural join node on the given attributes. Rows hold the attributes of the left
+ * input that are not join attributes followed by all attributes of the right input. When the node is opened the
+ * input with fewer rows is read into a hash table which the other input probes; if it needs more than
+ * AK_HASH_JOIN_MEMORY bytes, both inputs are first split into AK_HASH_JOIN_PARTITIONS temporary tables by hash.
+ * @param left left input node, owned by the new node
+ * @param right right input node, owned by the new node
+ * @param attributes list of join attribute names
+ * @return new node, NULL on error
+ */
+AK_operator *AK_join_operator(AK_operator *left, AK_operator *right, struct list_node *attributes);
+
+/**
+ * @author agent
+ * @brief  Function that creates a hash join node on pairs of attributes with equal values, see AK_join_operator.
+ * Rows hold all attributes of the left input followed by all attributes of the right input.
+ * @param left left input node, owned by the new node
+ * @param right right input node, owned by the new node
+ * @param num_keys number of attribute pairs
+ * @param left_keys positions of the join attributes in the left input
+ * @param right_keys positions of the join attributes in the right input
+ * @return new node, NULL on error
+ */
+AK_operator *AK_equi_join_operator(AK_operator *left, AK_operator *right, int num_keys, int *left_keys, int *right_keys);
+
+/**
+ * @author agent
+ * @brief  Function that creates a sort-merge join node for a band condition low < point < high, where point is an
+ * attribute of one input and low and high are attributes of the other one. When the node is opened both inputs are
+ * read into the memory of the node, the points are sorted by value and the intervals by their lower bound; every
+ * interval is then joined with the window of points between its bounds, whose start only moves forward. Rows hold all
+ * attributes of the left input followed by all attributes of the right input.
+ * @param left left input node, owned by the new node
+ * @param right right input node, owned by the new node
+ * @param point_left 1 if point is an attribute of the left input, 0 if it is one of the right input
+ * @param point position of the point attribute
+ * @param low position of the lower bound in the other input, EXIT_ERROR if there is none
+ * @param low_comparison AK_EXPR_LT or AK_EXPR_LE, comparison of the lower bound with the point
+ * @param high position of the upper bound in the other input, EXIT_ERROR if there is none
+ * @param high_comparison AK_EXPR_LT or AK_EXPR_LE, comparison of the point with the upper bound
+ * @return new node, NULL on error
+ */
+AK_operator *AK_band_join_operator(AK_operator *left, AK_operator *right, int point_left, int point, int low, int low_comparison, int high, int high_comparison);
+
+/**
+ * @author agent
+ * @brief  Function that creates an aggregation node. The attributes and tasks are given as for AK_aggregation and
+ * produce attributes named the same way (Cnt(x), Sum(x), ...). Groups are built in a hash table on the grouping
+ * attributes when the node is opened and produced in order of their first row. Once the groups use more than
+ * AK_AGGREGATION_MEMORY bytes, rows of groups that are not in memory yet are split by hash into
+ * AK_AGGREGATION_PARTITIONS temporary tables, which are aggregated one after another. Without grouping attributes the
+ * numeric values of AK_BATCH_SIZE rows are collected into arrays and summed, minimized and maximized by the kernels
+ * of batch.c.
+ * @param child input node, owned by the new node
+ * @param input attributes and aggregation tasks
+ * @return new node, NULL on error
+ */
+AK_operator *AK_aggregation_operator(AK_operator *child, AK_agg_input *input);
+
+/**
+ * @author agent
+ * @brief  Function that creates a union, intersection or difference node. Rows are equal when all their values are
+ * equal; the produced rows have the attribute names of the left input. A union produces the left and then the right
+ * rows. Intersection and difference read the right input into a hash table when the node is opened and produce rows
+ * of the left input in their order; if the right input needs more than AK_SET_MEMORY bytes, both inputs are first
+ * split into AK_SET_PARTITIONS temporary tables by hash. Without ALL every row is produced once. With ALL a row that
+ * is m times in the left and n times in the right input is produced m + n times by a union, min(m, n) times by an
+ * intersection and max(m - n, 0) times by a difference.
+ * @param left left input node, owned by the new node
+ * @param right right input node with the same number and types of attributes, owned by the new node
+ * @param operation AK_SET_UNION, AK_SET_INTERSECT or AK_SET_DIFFERENCE
+ * @param all 1 to keep duplicates (UNION ALL, INTERSECT ALL, EXCEPT ALL), 0 for distinct rows
+ * @return new node, NULL on error
+ */
+AK_operator *AK_set_operator(AK_operator *left, AK_operator *right, int operation, int all);
+
+/**
+ * @author agent
+ * @brief  Function that opens a node
+ * @param op node
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+int AK_operator_open(AK_operator *op);
+
+/**
+ * @author agent
+ * @brief  Function that pulls the next row of an open node into op->row
+ * @param op node
+ * @return AK_ITERATOR_ROW, AK_ITERATOR_END or EXIT_ERROR
+ */
+int AK_operator_next(AK_operator *op);
+
+/**
+ * @author agent
+ * @brief  Function that closes a node
+ * @param op node
+ */
+void AK_operator_close(AK_operator *op);
+
+/**
+ * @author agent
+ * @brief  Function that frees a node together with its children, closing it first if needed
+ * @param op node
+ */
+void AK_operator_free(AK_operator *op);
+
+/**
+ * @author agent
+ * @brief  Function that runs a plan and writes its rows into a new table
+ * @param root root node of the plan
+ * @param table name of the new table
+ * @return number of written rows, EXIT_ERROR on error
+ */
+int AK_iterator_materialize(AK_operator *root, char *table);
+
+/**
+ * @author agent
+ * @brief  Function that runs a plan and inserts its rows into an existing table
+ * @param root root node of the plan
+ * @param table table name
+ * @return number of inserted rows, EXIT_ERROR on error
+ */
+int AK_iterator_insert(AK_operator *root, char *table);
+
+/**
+ * @author agent
+ * @brief  Function that counts the rows of a plan
+ * @param op root node
+ * @return number of rows, EXIT_ERROR on error
+ */
+int AK_iterator_count(AK_operator *op);
+
+/**
+ * @author agent
+ * @brief  Function that returns the index of an attribute in a header
+ * @param header header
+ * @param num_attr number of attributes in header
+ * @param attribute attribute name
+ * @return index of the attribute, EXIT_ERROR if there is no such attribute
+ */
+int AK_iterator_attr_index(AK_header *header, int num_attr, char *attribute);
+
+/**
+ * @author agent
+ * @brief  Function that reads a value of a row as a number. Values that are not stored as numbers are parsed.
+ * @param row row
+ * @param i index of the value
+ * @return value as double, 0 if the row has no such value
+ */
+double AK_iterator_number(AK_row *row, int i);
+
+/**
+ * @author agent
+ * @brief  Function that compares two values. Numbers are compared by value, other values byte by byte as
+ * AK_sort_segment does.
+ * @param a first row
+ * @param i index of the value in the first row
+ * @param b second row
+ * @param j index of the value in the second row
+ * @return negative, zero or positive like strcmp
+ */
+int AK_iterator_compare_values(AK_row *a, int i, AK_row *b, int j);
+
+/**
+ * @author agent
+ * @brief  Function that copies the values of a row into a row owned by a node
+ * @param copy row receiving the values, it is reset first
+ * @param row row to copy
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+int AK_iterator_copy_row(AK_row *copy, AK_row *row);
+
+/**
+ * @author agent
+ * @brief  Function that sets the bytes of rows a sort, hash join, aggregation or set operation keeps in memory before
+ * it writes runs or partitions, see AK_SORT_MEMORY, AK_HASH_JOIN_MEMORY, AK_AGGREGATION_MEMORY and AK_SET_MEMORY
+ * @param op node that is not open
+ * @param memory number of bytes, at least one
+ * @return EXIT_SUCCESS, EXIT_ERROR if the node keeps no rows in memory or is open
+ */
+int AK_operator_set_memory(AK_operator *op, size_t memory);
+
+/**
+ * @author agent
+ * @brief  Function that tells how an open node produces its rows
+ * @param op node
+ * @param info receives the description
+ */
+void AK_operator_describe(AK_operator *op, AK_operator_info *info);
+
+TestResult AK_iterator_test();
+
+#endif
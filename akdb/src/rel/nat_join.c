@@ -89,186 +89,9 @@ void AK_create_join_block_header(int table_address1, int table_address2, char *n
 }
 
 /**
- * @author Matija Novak, updated by Dino Laktašić
- * @brief  Function that searches the second block and when found matches with the first one makes a join and writes a row to join the tables
- * @param row_root - list of values from the first table to be marged with table2
- * @param row_root_insert - list of values from the first table to be inserted into nat_join table
- * @param temp_block - block from the second table to be merged
- * @param new_table - name of the nat_join table
- * @return No return value
- */
-void AK_merge_block_join(struct list_node *row_root, struct list_node *row_root_insert, AK_block *temp_block, char *new_table) {
-//void AK_merge_block_join(AK_list *row_root, AK_list *row_root_insert, AK_block *temp_block, char *new_table) {
-    AK_PRO;
-    AK_dbg_messg(HIGH, REL_OP, "\n MERGE NAT JOIN...");
-
-    struct list_node *some_element;
-
-    int i; //counter of tuple_dicts
-    int head; //counter of the headers
-    int something_to_copy = 1; //boolean variable to indicate if there is data to copy in these set of tuple_dicts
-    int size;
-    int overflow;
-    int not_in_list = 1;
-
-    char data[MAX_VARCHAR_LENGTH];
-
-    //going through tuple_dicts of the second table
-    for (i = 0; i < DATA_BLOCK_SIZE;) {
-        head = 0;
-        something_to_copy = 1;
-
-        //make a copy of insert row list of the first table
-        //some_element = (AK_list_elem) AK_First_L2(row_root_insert);
-	some_element = AK_First_L2(row_root_insert);
-
-        //going through headers of the second table
-        while (strcmp(temp_block->header[head].att_name, "") != 0) {
-            //going through list of elements to compare
-            //some_element = (AK_list_elem) AK_First_L2(row_root);
-	    some_element = AK_First_L2(row_root);
-	    
-            while (some_element != NULL) {
-                size = temp_block->tuple_dict[i].size;
-                overflow = size + temp_block->tuple_dict[i].address;
-
-                //if isn't element in the list, and if data is correct, and size is not null
-                if ((strcmp(some_element->attribute_name, temp_block->header[head].att_name) == 0) && (size != 0)
-                        && (overflow < (temp_block->AK_free_space + 1)) && (overflow > -1)) {
-                    
-                    memset(data, '\0', MAX_VARCHAR_LENGTH);
-                    memcpy(data, temp_block->data + temp_block->tuple_dict[i].address, temp_block->tuple_dict[i].size);
-
-                    //if merge data is not equal
-                    if (strcmp(some_element->data, data) != 0) {
-                        //dont copy these set of tuple_dicts
-                        something_to_copy = 0;
-			break;
-                    }
-                    not_in_list = 0;
-                } else if ((size == 0) || (overflow > (temp_block->AK_free_space + 1)) || (overflow < -1)) {
-                    something_to_copy = 0;
-                }
-                //if there are more elements to compare for merge
-                some_element = some_element->next;
-            }
-
-            //if it isn't header which is in compare list then I can copy these tuple dicts becouse it not exist in the insert_row_list2
-            if ((not_in_list == 1) && (size != 0) && (overflow < temp_block->AK_free_space + 1) && (overflow > -1)) {
-                memset(data, '\0', MAX_VARCHAR_LENGTH);
-                //data[MAX_VARCHAR_LENGHT] = '\0';
-                memcpy(data, temp_block->data + temp_block->tuple_dict[i].address, temp_block->tuple_dict[i].size);
-
-                //insert data from second table to insert_list
-                //AK_Insert_New_Element(temp_block->tuple_dict[i].type, data, new_table, temp_block->header[head].att_name, &row_root_insert);
-                AK_Insert_New_Element(temp_block->tuple_dict[i].type, data, new_table, temp_block->header[head].att_name, row_root_insert);
-
-            }
-            not_in_list = 1;
-            head++; //next header
-            i++; //next tuple dict
-        ;}
-
-        //if these set is one that is passes merge then insert the list of data to join table
-        if (something_to_copy) {
-            AK_insert_row(row_root_insert);
-        }
-    }
-    AK_EPI;
-}
-
-/**
- * @author Matija Novak, optimized, and updated to work with AK_list by Dino Laktašić
- * @brief Function that iterates through block of the first table and copies data that needs for join, then it calls a merge function to
-        merge with the second table
- * @param tbl1_temp_block block of the first table
- * @param tbl2_temp_block block of the second join table
- * @param att attributes on which we make nat_join
- * @param new_table name of the nat_join table
- * @return No return value
- */
-void AK_copy_blocks_join(AK_block *tbl1_temp_block, AK_block *tbl2_temp_block, struct list_node *att, char *new_table) {
-    AK_PRO;
-    AK_dbg_messg(HIGH, REL_OP, "\n COPYING NAT JOIN");
-    
-    struct list_node *row_root = (struct list_node *) AK_malloc(sizeof(struct list_node));
-    struct list_node *row_root_insert = (struct list_node *) AK_malloc(sizeof(struct list_node));
-    AK_Init_L3(&row_root);
-    AK_Init_L3(&row_root_insert);
-    struct list_node *list_elem;
-    
-    int i;
-    int head;
-    int something_to_copy = 0;
-    int size;
-    int overflow;
-    int not_in_list = 1;
-    char data[MAX_VARCHAR_LENGTH];
-
-    //going through tuple_dict of the table block
-    for (i = 0; i < DATA_BLOCK_SIZE;) {
-        head = something_to_copy = 0;
-
-        while (strcmp(tbl1_temp_block->header[head].att_name, "") != 0) {
-            
-	  list_elem = AK_First_L2(att);
-            //going through list of elements on which we merge
-            while (list_elem != NULL) {
-                
-                size = tbl1_temp_block->tuple_dict[i].size;
-                overflow = size + tbl1_temp_block->tuple_dict[i].address;
-
-                //if there is an element that we need, and it's correct we copy it
-                if ((strcmp(list_elem->data, tbl1_temp_block->header[head].att_name) == 0) && (size != 0)
-                        && (overflow < (tbl1_temp_block->AK_free_space + 1)) && (overflow > -1)) {
-                    memset(data, '\0', MAX_VARCHAR_LENGTH);
-
-                    memcpy(data, tbl1_temp_block->data + tbl1_temp_block->tuple_dict[i].address, tbl1_temp_block->tuple_dict[i].size);
-                    //insert element into list on which we compare
-                    AK_Insert_New_Element(tbl1_temp_block->tuple_dict[i].type, data, new_table, list_elem->data, row_root);
-                    //insert element into list which we insert into join_table together with second table data
-                    AK_Insert_New_Element(tbl1_temp_block->tuple_dict[i].type, data, new_table, list_elem->data, row_root_insert);
-                    
-
-                    something_to_copy = 1;
-                    not_in_list = 0;
-                    
-                    break; //check for break here, to speed up execution  
-                }
-                list_elem = list_elem->next;
-            }
-
-            //copy element which is not for merge only for insert
-            if ((not_in_list == 1) && (size != 0) && (overflow < tbl1_temp_block->AK_free_space + 1) && (overflow > -1)) {
-                    memset(data, '\0', MAX_VARCHAR_LENGTH);
-                    //data[MAX_VARCHAR_LENGHT] = '\0';
-                    memcpy(data, tbl1_temp_block->data + tbl1_temp_block->tuple_dict[i].address, tbl1_temp_block->tuple_dict[i].size);
-                    AK_Insert_New_Element(tbl1_temp_block->tuple_dict[i].type, data, new_table, tbl1_temp_block->header[head].att_name, row_root_insert);
-
-            }
-            not_in_list = 1; //reset not_in_list
-            head++; //next header
-            i++; //next tuple dict
-        }
-
-        //if there is a data to copy
-        if (something_to_copy) {
-            //merge data with second table
-            AK_merge_block_join(row_root, row_root_insert, tbl2_temp_block, new_table);
-            
-            
-	    AK_DeleteAll_L3(&row_root);
-	    AK_DeleteAll_L3(&row_root_insert);
-        }
-    }
-    AK_free(row_root);
-    AK_free(row_root_insert);
-    AK_EPI;
-}
-
-/**
- * @author Matija Novak, updated to work with AK_list and support cacheing by Dino Laktašić
- * @brief Function that makes a  nat_join betwen two tables on some attributes
+ * @author Matija Novak, updated to work with AK_list and support cacheing by Dino Laktašić, updated by agent (hash join)
+ * @brief Function that makes a  nat_join betwen two tables on some attributes. The rows are produced by a hash join of
+ *        the two tables, see AK_join_operator.
  * @param srcTable1 name of the first table to join
  * @param srcTable2 name of the second table to join
  * @param att attributes on which we make nat_join
@@ -284,152 +107,192 @@ int AK_join(char *srcTable1, char * srcTable2, char * dstTable, struct list_node
     int startAddress1 = src_addr1->address_from[0];
     int startAddress2 = src_addr2->address_from[0];
 
+    AK_free(src_addr1);
+    AK_free(src_addr2);
+
     if ((startAddress1 != 0) && (startAddress2 != 0)) {
         AK_create_join_block_header(startAddress1, startAddress2, dstTable, att);
 
         AK_dbg_messg(LOW, REL_OP, "\nTABLE %s CREATED from %s and %s\n", dstTable, srcTable1, srcTable2);
 		AK_dbg_messg(MIDDLE, REL_OP, "\nAK_join: start copying data\n");
 
-        AK_mem_block *tbl1_temp_block, *tbl2_temp_block;
-
-        int i, j, k, l;
-        i = j = k = l = 0;
-
-
-        //for each extent in table1 that contains blocks needed for join
-        for (i = 0; i < (src_addr1->address_from[i] != 0); i++) {
-            startAddress1 = src_addr1->address_from[i];
-
-            if (startAddress1 != 0) {
-                AK_dbg_messg(MIDDLE, REL_OP, "\nNatural join: copy extent1: %d\n", i);
+        //without join attributes the join table stays empty
+        if (AK_First_L2(att) != NULL) {
+            AK_operator *plan = AK_join_operator(AK_scan_operator(srcTable1), AK_scan_operator(srcTable2), att);
+            int rows = plan != NULL ? AK_iterator_insert(plan, dstTable) : 0;
 
-                //for each block in table1 extent
-                for (j = startAddress1; j < src_addr1->address_to[i]; j++) {
-                    AK_dbg_messg(MIDDLE, REL_OP, "Natural join: copy block1: %d\n", j);
-
-                    tbl1_temp_block = (AK_mem_block *) AK_get_block(j);
-
-
-                    //if there is data in the block
-                    if (tbl1_temp_block->block->AK_free_space != 0) {
-                        //for each extent in table2 that contains blocks needed for join
-                        for (k = 0; k < (src_addr2->address_from[k] != 0); k++) {
-                            startAddress2 = src_addr2->address_from[k];
-
-
-                            if (startAddress2 != 0) {
-                                AK_dbg_messg(MIDDLE, REL_OP, "Natural join: copy extent2: %d\n", k);
-
-                                //for each block in table2 extent
-                                for (l = startAddress2; l < src_addr2->address_to[k]; l++) {
-                                    AK_dbg_messg(MIDDLE, REL_OP, "Natural join: copy block2: %d\n", l);
-
-                                    tbl2_temp_block = (AK_mem_block *) AK_get_block(l);
-
-                                    //if there is data in the block
-                                    if (tbl2_temp_block->block->AK_free_space != 0) {
-                                        AK_copy_blocks_join(tbl1_temp_block->block, tbl2_temp_block->block, att, dstTable);
-                                    }
-                                }
-                            } else break;
-                        }
-                    }
-                }
-            } else break;
+            AK_operator_free(plan);
+            if (rows == EXIT_ERROR) {
+                AK_EPI;
+                return EXIT_ERROR;
+            }
         }
-        AK_free(src_addr1);
-        AK_free(src_addr2);
 		AK_dbg_messg(LOW, REL_OP, "NAT_JOIN_TEST_SUCCESS\n\n");
         AK_EPI;
         return EXIT_SUCCESS;
     } else {
         AK_dbg_messg(LOW, REL_OP, "\n AK_join: Table/s doesn't exist!");
-        AK_free(src_addr1);
-        AK_free(src_addr2);
         AK_EPI;
         return EXIT_ERROR;
     }
-    AK_EPI;
-    
 }
 
 /**
- * @author Matija Novak, edited by Marin Bogešić
+ * @author Matija Novak, edited by Marin Bogešić, updated by agent
  * @brief Function for natural join testing
- * @return No return value
+ * @return Test result - number of successful and unsuccessful tests
  */
-
-
-struct list_node* create_row(const char* type, const char* attribute_name, const char* table, const char* data) {
-    struct list_node* row = (struct list_node*)malloc(sizeof(struct list_node));
-    row->type = TYPE_ATTRIBS;
-    row->size = strlen(data);
-    strncpy(row->data, data, MAX_VARCHAR_LENGTH);
-    strncpy(row->table, table, MAX_ATT_NAME);
-    strncpy(row->attribute_name, attribute_name, MAX_ATT_NAME);
-    row->constraint = 0;
-    row->next = NULL;
-    return row;
-}
-
-
-
 TestResult AK_op_join_test() {
     AK_PRO;
     char *srcTable1 = "table1";
     char *srcTable2 = "table2";
     char *dstTable = "join_table";
+    char *names[3] = {"John", "Michael", "Sarah"};
+    int ids[3] = {1, 2, 4}, ages[3] = {25, 30, 40};
     
+    //type is the code of the attribute type, and a header ends at the first empty attribute name
     AK_header header1[MAX_ATTRIBUTES];
+    memset(header1, 0, sizeof(header1));
     strcpy(header1[0].att_name, "id");
-    strcpy(header1[0].type, "int");
+    header1[0].type = TYPE_INT;
     strcpy(header1[1].att_name, "name");
-    strcpy(header1[1].type, "varchar(255)");
+    header1[1].type = TYPE_VARCHAR;
     
     AK_header header2[MAX_ATTRIBUTES];
+    memset(header2, 0, sizeof(header2));
     
     strcpy(header2[0].att_name, "id");
-    strcpy(header2[0].type, "int");
+    header2[0].type = TYPE_INT;
     strcpy(header2[1].att_name, "age");
-    strcpy(header2[1].type, "int");
+    header2[1].type = TYPE_INT;
     
     AK_temp_create_table(srcTable1, header1, SEGMENT_TYPE_TABLE);
     AK_temp_create_table(srcTable2, header2, SEGMENT_TYPE_TABLE);
     
-    // Insert data into the first table
-    AK_insert_row(create_row("int", "id", srcTable1, "1"));
-    AK_insert_row(create_row("varchar(255)", "name", srcTable1, "John"));
-    AK_insert_row(create_row("int", "id", srcTable1, "2"));
-    AK_insert_row(create_row("varchar(255)", "name", srcTable1, "Michael"));
-    AK_insert_row(create_row("int", "id", srcTable1, "3"));
-    AK_insert_row(create_row("varchar(255)", "name", srcTable1, "Sarah"));
-    
-    // Insert data into the second table
-    AK_insert_row(create_row("int", "id", srcTable2, "1"));
-    AK_insert_row(create_row("int", "age", srcTable2, "25"));
-    AK_insert_row(create_row("int", "id", srcTable2, "2"));
-    AK_insert_row(create_row("int", "age", srcTable2, "30"));
-    AK_insert_row(create_row("int", "id", srcTable2, "4"));
-    AK_insert_row(create_row("int", "age", srcTable2, "40"));
-    
-    // Define the attributes for natural join
-    struct list_node *att = NULL;
-    att = create_row("int", "id", "", "");
+    // Insert data into the tables: ids 1, 2 and 3 into the first, ids 1, 2 and 4 into the second
+    int successful = 0, failed = 0, rows, expected, i, j, band;
+    struct list_node *list = (struct list_node *)AK_malloc(sizeof(struct list_node));
+    AK_Init_L3(&list);
+    for (i = 0; i < 3; i++) {
+        j = i + 1;
+        AK_Insert_New_Element(TYPE_INT, &j, srcTable1, "id", list);
+        AK_Insert_New_Element(TYPE_VARCHAR, names[i], srcTable1, "name", list);
+        AK_insert_row(list);
+        AK_DeleteAll_L3(&list);
+        AK_Insert_New_Element(TYPE_INT, &ids[i], srcTable2, "id", list);
+        AK_Insert_New_Element(TYPE_INT, &ages[i], srcTable2, "age", list);
+        AK_insert_row(list);
+        AK_DeleteAll_L3(&list);
+    }
     
-    // Perform the natural join operation
-    AK_join(srcTable1, srcTable2, dstTable, att);
+    // Perform the natural join operation on id
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "id", sizeof("id"), list);
+    if (AK_join(srcTable1, srcTable2, dstTable, list) == EXIT_SUCCESS && AK_get_num_records(dstTable) == 2)
+        successful++;
+    else
+        failed++;
+    AK_DeleteAll_L3(&list);
     
     // Print the resulting joined table
     AK_print_table(dstTable);
     
     // Clean up
-    free(att);
-    
-    AK_drop_table(srcTable1);
-    AK_drop_table(srcTable2);
-    AK_drop_table(dstTable);
-    
+    AK_delete_segment(srcTable1, SEGMENT_TYPE_TABLE);
+    AK_delete_segment(srcTable2, SEGMENT_TYPE_TABLE);
+    AK_delete_segment(dstTable, SEGMENT_TYPE_TABLE);
+
+    AK_operator *plan, *inner;
+    AK_operator_info info;
+
+    //hash join of employee and department with room for one build row is split into partitions, expected rows are
+    //counted with two scans
+    expected = 0;
+    plan = AK_scan_operator("employee");
+    inner = AK_scan_operator("department");
+    if (AK_operator_open(plan) == EXIT_SUCCESS)
+    {
+        i = AK_iterator_attr_index(plan->header, plan->num_attr, "id_department");
+        j = AK_iterator_attr_index(inner->header, inner->num_attr, "id_department");
+        while (AK_operator_next(plan) == AK_ITERATOR_ROW)
+        {
+            AK_operator_open(inner);
+            while (AK_operator_next(inner) == AK_ITERATOR_ROW)
+                if (AK_iterator_number(plan->row, i) == AK_iterator_number(inner->row, j))
+                    expected++;
+            AK_operator_close(inner);
+        }
+        AK_operator_close(plan);
+    }
+    AK_operator_free(plan);
+    AK_operator_free(inner);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "id_department", sizeof("id_department"), list);
+    plan = AK_join_operator(AK_scan_operator("employee"), AK_scan_operator("department"), list);
+    AK_DeleteAll_L3(&list);
+    rows = 0;
+    info.partitions = 0;
+    if (AK_operator_set_memory(plan, 1) == EXIT_SUCCESS && AK_operator_open(plan) == EXIT_SUCCESS)
+    {
+        AK_operator_describe(plan, &info);
+        while (AK_operator_next(plan) == AK_ITERATOR_ROW)
+            rows++;
+        AK_operator_close(plan);
+    }
+    AK_operator_free(plan);
+    printf("Partitioned join of employee and department: %d rows in %d partitions, expected %d\n", rows, info.partitions, expected);
+    if (rows > 0 && rows == expected && info.partitions == AK_HASH_JOIN_PARTITIONS)
+        successful++;
+    else
+        failed++;
+
+    //equi join keeps all attributes of both inputs
+    plan = AK_scan_operator("employee");
+    inner = AK_scan_operator("department");
+    i = AK_iterator_attr_index(plan->header, plan->num_attr, "id_department");
+    j = AK_iterator_attr_index(inner->header, inner->num_attr, "id_department");
+    plan = AK_equi_join_operator(plan, inner, 1, &i, &j);
+    rows = AK_iterator_count(plan);
+    printf("Equi join of employee and department: %d rows, expected %d\n", rows, expected);
+    if (plan != NULL && rows == expected && plan->num_attr == plan->child->num_attr + plan->right->num_attr)
+        successful++;
+    else
+        failed++;
+    AK_operator_free(plan);
+
+    //band joins of student with itself: a later year, then the same year with the points in the right input
+    for (band = 0; band < 2; band++)
+    {
+        expected = 0;
+        plan = AK_scan_operator("student");
+        inner = AK_scan_operator("student");
+        i = AK_iterator_attr_index(plan->header, plan->num_attr, "year");
+        if (AK_operator_open(plan) == EXIT_SUCCESS)
+        {
+            while (AK_operator_next(plan) == AK_ITERATOR_ROW)
+            {
+                AK_operator_open(inner);
+                while (AK_operator_next(inner) == AK_ITERATOR_ROW)
+                    if (band ? AK_iterator_number(plan->row, i) == AK_iterator_number(inner->row, i)
+                               : AK_iterator_number(inner->row, i) < AK_iterator_number(plan->row, i))
+                        expected++;
+                AK_operator_close(inner);
+            }
+            AK_operator_close(plan);
+        }
+        if (band)
+            plan = AK_band_join_operator(plan, inner, 0, i, i, AK_EXPR_LE, i, AK_EXPR_LE);
+        else
+            plan = AK_band_join_operator(plan, inner, 1, i, i, AK_EXPR_LT, EXIT_ERROR, 0);
+        rows = AK_iterator_count(plan);
+        printf("Band join of student %s: %d rows, expected %d\n", band ? "on the same year" : "on a later year", rows, expected);
+        if (plan != NULL && rows > 0 && rows == expected && plan->num_attr == 2 * plan->child->num_attr)
+            successful++;
+        else
+            failed++;
+        AK_operator_free(plan);
+    }
+    AK_free(list);
+
     AK_EPI;
-    return TEST_result(1, 0);
+    return TEST_result(successful, failed);
 }
 
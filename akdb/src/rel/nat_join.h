@@ -25,6 +25,7 @@
 #include "../rel/projection.h"
 #include "../auxi/mempro.h"
 #include "../sql/drop.h"
+#include "iterator.h"
 /*
 void AK_create_join_block_header(int table_address1, int table_address2, char *new_table, AK_list *att);
 void AK_merge_block_join(AK_list *row_root, AK_list *row_root_insert, AK_block *temp_block, char *new_table);
@@ -41,33 +42,12 @@ void AK_copy_blocks_join(AK_block *tbl1_temp_block, AK_block *tbl2_temp_block, A
  */
 void AK_create_join_block_header(int table_address1, int table_address2, char *new_table, struct list_node *att);
 
-/**
- * @author Matija Novak, updated by Dino Laktašić
- * @brief  Function that searches the second block and when found matches with the first one makes a join and writes a row to join the tables
- * @param row_root - list of values from the first table to be marged with table2
- * @param row_root_insert - list of values from the first table to be inserted into nat_join table
- * @param temp_block - block from the second table to be merged
- * @param new_table - name of the nat_join table
- * @return No return value
- */
-void AK_merge_block_join(struct list_node *row_root, struct list_node *row_root_insert, AK_block *temp_block, char *new_table);
-
-/**
- * @author Matija Novak, optimized, and updated to work with AK_list by Dino Laktašić
- * @brief Function that iterates through block of the first table and copies data that needs for join, then it calls a merge function to
-        merge with the second table
- * @param tbl1_temp_block block of the first table
- * @param tbl2_temp_block block of the second join table
- * @param att attributes on which we make nat_join
- * @param new_table name of the nat_join table
- * @return No return value
- */
-void AK_copy_blocks_join(AK_block *tbl1_temp_block, AK_block *tbl2_temp_block, struct list_node *att, char *new_table);
 //int AK_join(char *srcTable1, char * srcTable2, char * dstTable, AK_list *att);
 
 /**
- * @author Matija Novak, updated to work with AK_list and support cacheing by Dino Laktašić
- * @brief Function that makes a  nat_join betwen two tables on some attributes
+ * @author Matija Novak, updated to work with AK_list and support cacheing by Dino Laktašić, updated by agent (hash join)
+ * @brief Function that makes a  nat_join betwen two tables on some attributes. The rows are produced by a hash join of
+ *        the two tables, see AK_join_operator.
  * @param srcTable1 name of the first table to join
  * @param srcTable2 name of the second table to join
  * @param att attributes on which we make nat_join
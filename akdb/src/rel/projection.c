@@ -40,7 +40,7 @@ void AK_create_block_header(int old_block, char *dstTable, struct list_node *att
     struct list_node *list_elem,*list_elem2;
     struct list_node *att_operation_elem,*a,*b,*c,*d,*operator,*cached_elem;
 
-    AK_header header[MAX_ATTRIBUTES];
+    AK_header header[MAX_ATTRIBUTES + 1]; //last header terminates the list
     
     int head = 0; //counter of the headers
     int new_head = 0; //counter of the new headers created for the projection table
@@ -53,7 +53,8 @@ void AK_create_block_header(int old_block, char *dstTable, struct list_node *att
     while (strcmp(temp_block->header[head].att_name, "") != 0) {
    
 	list_elem = AK_First_L2(att);	
-        while (list_elem != NULL ) {
+        //an expression matches every attribute it uses, so the header count is bounded
+        while (list_elem != NULL && new_head < MAX_ATTRIBUTES) {
             
             //if header is found than copy header       
             if (strcmp(list_elem->data, temp_block->header[head].att_name) == 0) {
@@ -93,7 +94,7 @@ void AK_create_block_header(int old_block, char *dstTable, struct list_node *att
         head++;     
     }
     
-    memset(header + new_head, '\0', MAX_ATTRIBUTES - new_head);
+    memset(header + new_head, '\0', (MAX_ATTRIBUTES + 1 - new_head) * sizeof(AK_header));
 
     AK_free(temp_block);
     AK_temp_create_table(dstTable, header, SEGMENT_TYPE_TABLE); // creates new table - destination table with given attributes
@@ -515,12 +516,13 @@ TestResult AK_op_projection_test() {
     struct list_node * att4 = (struct list_node *) AK_malloc(sizeof(struct list_node));
     struct list_node * expr4 = (struct list_node *) AK_malloc(sizeof(struct list_node));
     AK_Init_L3(&att4);   
+    AK_Init_L3(&expr4);
     char expression4 []= "%dino%";
 
     printf("\nSelect firstname,lastname from student where firstname ILIKE dino\n\n");
 
     AK_InsertAtEnd_L3(TYPE_ATTRIBS, "firstname", sizeof ("firstname"), expr4);
-    AK_InsertAtEnd_L3(TYPE_VARCHAR, &expression4, sizeof (char), expr4);
+    AK_InsertAtEnd_L3(TYPE_VARCHAR, &expression4, sizeof (expression4), expr4);
     AK_InsertAtEnd_L3(TYPE_OPERATOR, "ILIKE", sizeof ("ILIKE"), expr4);
     AK_InsertAtEnd_L3(TYPE_ATTRIBS, "lastname", sizeof ("lastname"), att4);
     
@@ -567,12 +569,13 @@ TestResult AK_op_projection_test() {
     struct list_node * att2 = (struct list_node *) AK_malloc(sizeof(struct list_node));
     struct list_node * expr2 = (struct list_node *) AK_malloc(sizeof(struct list_node));
     AK_Init_L3(&att2);   
+    AK_Init_L3(&expr2);
     char expression []= "%in%";
 
     printf("\nSelect firstname,lastname from student where firstname LIKE %in%\n\n");
 
     AK_InsertAtEnd_L3(TYPE_ATTRIBS, "firstname", sizeof ("firstname"), expr2);
-    AK_InsertAtEnd_L3(TYPE_VARCHAR, &expression, sizeof (char), expr2);
+    AK_InsertAtEnd_L3(TYPE_VARCHAR, &expression, sizeof (expression), expr2);
     AK_InsertAtEnd_L3(TYPE_OPERATOR, "LIKE", sizeof ("LIKE"), expr2);
     AK_InsertAtEnd_L3(TYPE_ATTRIBS, "lastname", sizeof ("lastname"), att2);  
     
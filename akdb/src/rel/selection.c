@@ -19,10 +19,13 @@
 
 #include "selection.h"
 #include "aggregation.h"
+#include "iterator.h"
 
 /**
- * @author Matija Šestak, updated by Elena Kržina
- * @brief  Function that which implements selection
+ * @author Matija Šestak, updated by Elena Kržina, updated by agent (compact rows, arena, compiled expression, batches, index access)
+ * @brief  Function that which implements selection. The source table is read by a selection node of the iterator
+ * executor, so the expression is compiled once and numeric comparisons are evaluated on batches of rows. Rows are
+ * read through a B+tree or hash index when the expression allows it, see AK_access_operator.
  * @param *srcTable source table name
  * @param *dstTable destination table name
  * @param *expr list with posfix notation of the logical expression
@@ -47,45 +50,18 @@
 	}
 
 	AK_dbg_messg(LOW, REL_OP, "\nTable %s created from %s.\n", dstTable, srcTable);
-	
-	table_addresses *src_addr = (table_addresses*) AK_get_table_addresses(srcTable);
-	struct list_node * row_root = (struct list_node *) AK_malloc(sizeof(struct list_node));
-	AK_Init_L3(&row_root);
-		
-	int type, size, address;
-	char data[MAX_VARCHAR_LENGTH];
-
-	/* code steps through all addresses of table, gets the block of each current address, counts the number of attributes, 
-	fetches values for each attribute and inserts data into the destination table if row satisfies given expression */ 
-	for (int i = 0; src_addr->address_from[i] != 0; i++) {
 
-		for (int j = src_addr->address_from[i]; j < src_addr->address_to[i]; j++) {
+	AK_operator *plan = num_attr > 0 ? AK_select_operator(AK_access_operator(srcTable, expr), expr) : NULL;
+	int rows = AK_iterator_insert(plan, dstTable);
 
-			AK_mem_block *temp = (AK_mem_block *) AK_get_block(j);
+	AK_operator_free(plan);
+	AK_free(t_header);
 
-			if (temp->block->last_tuple_dict_id != 0){
-				for (int k = 0; k < DATA_BLOCK_SIZE && !(temp->block->tuple_dict[k].type == FREE_INT); k += num_attr) {
-					for (int l = 0; l < num_attr; l++) {
-						type = temp->block->tuple_dict[k + l].type;
-						size = temp->block->tuple_dict[k + l].size;
-						address = temp->block->tuple_dict[k + l].address;
-						memcpy(data, &(temp->block->data[address]), size);
-						data[size] = '\0';
-						AK_Insert_New_Element(type, data, dstTable, t_header[l].att_name, row_root);
-					}
-					if (AK_check_if_row_satisfies_expression(row_root, expr)){
-						AK_insert_row(row_root);
-					}
-					AK_DeleteAll_L3(&row_root);
-				}
-			}
-		}
+	if (rows == EXIT_ERROR) {
+		AK_EPI;
+		return EXIT_ERROR;
 	}
 
-	AK_free(src_addr);
-	AK_free(t_header);
-	AK_free(row_root);
-
 	AK_print_table(dstTable);
 	
 	AK_dbg_messg(LOW, REL_OP, "\nSelection test success.\n\n");
@@ -96,7 +72,90 @@
 //------------------------------------------------------------------------------------------------------test 36
 
 /**
- * @author Matija Šestak, updated by Dino Laktašić, Nikola Miljancic, Tea Jelavić
+ * @author agent
+ * @brief  Function that checks the batch kernels of every instruction set of the processor against plain loops
+ * @return number of instruction sets whose kernels agree with the loops on all comparisons and aggregates, EXIT_ERROR
+ * if one does not
+ */
+static int AK_selection_test_kernels() {
+    AK_batch_column *column[3];
+    unsigned char mask[AK_BATCH_SIZE];
+    int selection[AK_BATCH_SIZE], selected, count = AK_BATCH_SIZE - 3, detected, level, c, comparison, i, diff, same = 1;
+    unsigned int seed = 1;
+    double value, sum, min, max, constant[3] = {7, 7.25, -3.125};
+    int int_constant = 7;
+    float float_constant = 7.25f;
+    char *constants[3] = {(char *)&int_constant, (char *)&float_constant, (char *)&constant[2]};
+    AK_PRO;
+    detected = AK_batch_level();
+    for (c = 0; c < 3; c++)
+        column[c] = (AK_batch_column *)AK_calloc(1, sizeof(AK_batch_column));
+    column[0]->type = TYPE_INT;
+    column[1]->type = TYPE_FLOAT;
+    column[2]->type = TYPE_NUMBER;
+    for (i = 0; i < count; i++)
+    {
+        seed = seed * 1103515245u + 12345u;
+        column[0]->value.integer[i] = (int)((seed >> 16) % 41) - 20;
+        column[1]->value.real[i] = column[0]->value.integer[i] / 4.0f + 2;
+        column[2]->value.number[i] = column[0]->value.integer[i] / 8.0;
+    }
+
+    //every third number, for aggregates over a selection
+    for (i = 0; i < count; i++)
+        mask[i] = i % 3 == 0;
+    selected = AK_batch_select(mask, count, selection);
+    same = selected == (count + 2) / 3 && AK_batch_count(mask, count) == selected;
+
+    for (level = AK_BATCH_SCALAR; level <= detected && same; level++)
+    {
+        AK_batch_set_level(level);
+        for (c = 0; c < 3; c++)
+            for (comparison = AK_EXPR_EQ; comparison <= AK_EXPR_GE; comparison++)
+            {
+                //NaN is neither smaller nor greater than the constant
+                if (c == 2)
+                    column[2]->value.number[5] = strtod("nan", NULL);
+                AK_batch_compare(column[c], count, comparison, constants[c], mask);
+                for (i = 0; i < count; i++)
+                {
+                    value = c == 0 ? column[0]->value.integer[i] : c == 1 ? column[1]->value.real[i] : column[2]->value.number[i];
+                    diff = (value > constant[c]) - (value < constant[c]);
+                    if (mask[i] != (comparison == AK_EXPR_EQ ? diff == 0 : comparison == AK_EXPR_NE ? diff != 0 : comparison == AK_EXPR_LT ? diff < 0
+                                    : comparison == AK_EXPR_GT ? diff > 0 : comparison == AK_EXPR_LE ? diff <= 0 : diff >= 0))
+                        same = 0;
+                }
+                if (c == 2)
+                    column[2]->value.number[5] = column[0]->value.integer[5] / 8.0;
+            }
+        for (c = 0; c < 2; c++)
+        {
+            sum = 0;
+            min = max = column[2]->value.number[c ? selection[0] : 0];
+            for (i = 0; i < (c ? selected : count); i++)
+            {
+                value = column[2]->value.number[c ? selection[i] : i];
+                sum += value;
+                min = value < min ? value : min;
+                max = value > max ? value : max;
+            }
+            if (AK_batch_sum(column[2]->value.number, c ? selection : NULL, c ? selected : count) != sum
+                || AK_batch_min(column[2]->value.number, c ? selection : NULL, c ? selected : count) != min
+                || AK_batch_max(column[2]->value.number, c ? selection : NULL, c ? selected : count) != max)
+                same = 0;
+        }
+        if (!same)
+            printf("Batch kernels of instruction set %d do not agree with plain loops\n", level);
+    }
+    AK_batch_set_level(detected);
+    for (c = 0; c < 3; c++)
+        AK_free(column[c]);
+    AK_EPI;
+    return same ? detected + 1 : EXIT_ERROR;
+}
+
+/**
+ * @author Matija Šestak, updated by Dino Laktašić, Nikola Miljancic, Tea Jelavić, updated by agent
  * @brief  Function for selection operator testing
  * using WHERE clause and operators BETWEEN, AND
  *
@@ -220,6 +279,60 @@ TestResult AK_op_selection_test() { //test 36
         }
     } 
 
+    AK_DeleteAll_L3(&expr);
+
+    //the kernels of every instruction set the processor has agree with plain loops
+    int level = AK_selection_test_kernels();
+    printf("\nBatch kernels: %s at %d instruction sets, using %d\n", level > 0 ? "correct" : "wrong", level, AK_batch_level());
+    if (level > 0)
+        successful++;
+    else
+        failed++;
+
+    //a numeric selection over 80 copies of student is evaluated in batches, as the interpreter does row by row
+    float weight = 88.25f;
+    num = 2005;
+    AK_InsertAtEnd_L3(TYPE_INT, &num, sizeof (int), expr);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "year", sizeof ("year"), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "<", sizeof ("<"), expr);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "weight", sizeof ("weight"), expr);
+    AK_InsertAtEnd_L3(TYPE_FLOAT, &weight, sizeof (float), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "<=", sizeof ("<="), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "AND", sizeof ("AND"), expr);
+    a = 1999;
+    b = 2001;
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "year", sizeof ("year"), expr);
+    AK_InsertAtEnd_L3(TYPE_INT, &a, sizeof (int), expr);
+    AK_InsertAtEnd_L3(TYPE_INT, &b, sizeof (int), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "BETWEEN", sizeof ("BETWEEN"), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "OR", sizeof ("OR"), expr);
+    AK_operator *plan = AK_scan_operator(srcTable);
+    AK_operator_info info;
+    int expected = 0, rows = 0, i;
+    if (AK_operator_open(plan) == EXIT_SUCCESS) {
+        while (AK_operator_next(plan) == AK_ITERATOR_ROW)
+            expected += 80 * AK_check_if_compact_row_satisfies_expression(plan->row, expr, NULL);
+        AK_operator_close(plan);
+    }
+    AK_operator_free(plan);
+    plan = AK_scan_operator(srcTable);
+    for (i = 1; i < 80; i++)
+        plan = AK_set_operator(plan, AK_scan_operator(srcTable), AK_SET_UNION, 1);
+    plan = AK_select_operator(plan, expr);
+    info.batched = 0;
+    if (plan != NULL && AK_operator_open(plan) == EXIT_SUCCESS) {
+        AK_operator_describe(plan, &info);
+        while (AK_operator_next(plan) == AK_ITERATOR_ROW)
+            rows++;
+        AK_operator_close(plan);
+    }
+    AK_operator_free(plan);
+    printf("Batched selection of 80 copies of student: %d rows, expected %d, %s\n", rows, expected, info.batched ? "in batches" : "row by row");
+    if (info.batched && rows > 0 && rows == expected)
+        successful++;
+    else
+        failed++;
+
     AK_DeleteAll_L3(&expr);
     AK_free(expr);
 	test_run_count++;
@@ -585,8 +698,9 @@ void AK_free_expr_node(ExprNode* exprNode) {
     free(exprNode);
 }
 
-/*@author: Marin Bogešić
-* @brief: HAVING SQL command function and its test (below)
+/*@author: Marin Bogešić, updated by agent (compact rows, compiled expressions)
+* @brief: HAVING SQL command function and its test (below). Rows are read into a compact row; both expressions are
+* compiled when the first row is read and run for every row.
 */
 int AK_selection_having(char *srcTable, char *dstTable, struct list_node *expr, struct list_node *havingExpr)
 {
@@ -609,13 +723,22 @@ int AK_selection_having(char *srcTable, char *dstTable, struct list_node *expr,
 	AK_dbg_messg(LOW, REL_OP, "\nTable %s created from %s.\n", dstTable, srcTable);
 
 	table_addresses *src_addr = (table_addresses *)AK_get_table_addresses(srcTable);
-	struct list_node *row_root = (struct list_node *)AK_malloc(sizeof(struct list_node));
-	AK_Init_L3(&row_root);
+	AK_row *row = AK_row_new(t_header, num_attr);
+	AK_expression_program *where_program = NULL, *having_program = NULL;
+	AK_arena *scratch = AK_arena_create(0);
 
-	int type, size, address;
-	char data[MAX_VARCHAR_LENGTH];
-	/* Code steps through all addresses of the table, gets the block of each current address, counts the number of attributes,
-	   fetches values for each attribute and inserts data into the destination table if the row satisfies the given expression */
+	if (row == NULL || scratch == NULL)
+	{
+		AK_arena_destroy(scratch);
+		AK_row_free(row);
+		AK_free(src_addr);
+		AK_free(t_header);
+		AK_EPI;
+		return EXIT_ERROR;
+	}
+
+	/* Code steps through all addresses of the table, gets the block of each current address, reads every live slot
+	   into the compact row and inserts it into the destination table if the row satisfies both expressions */
 	for (int i = 0; src_addr->address_from[i] != 0; i++)
 	{
 		for (int j = src_addr->address_from[i]; j < src_addr->address_to[i]; j++)
@@ -624,38 +747,37 @@ int AK_selection_having(char *srcTable, char *dstTable, struct list_node *expr,
 
 			if (temp->block->last_tuple_dict_id != 0)
 			{
-				for (int k = 0; k < DATA_BLOCK_SIZE && !(temp->block->tuple_dict[k].type == FREE_INT); k += num_attr)
+				for (int k = 0; (k + 1) * num_attr <= DATA_BLOCK_SIZE && temp->block->tuple_dict[k * num_attr].type != FREE_INT; k++)
 				{
-					for (int l = 0; l < num_attr; l++)
+					if (AK_row_from_slot(row, temp->block, k) == EXIT_ERROR)
+						continue;
+
+					if (where_program == NULL)
 					{
-						type = temp->block->tuple_dict[k + l].type;
-						size = temp->block->tuple_dict[k + l].size;
-						address = temp->block->tuple_dict[k + l].address;
-						memcpy(data, &(temp->block->data[address]), size);
-						data[size] = '\0';
-						AK_Insert_New_Element(type, data, dstTable, t_header[l].att_name, row_root);
+						where_program = AK_expression_compile(expr, t_header, num_attr);
+						having_program = AK_expression_compile(havingExpr, t_header, num_attr);
+						if (where_program == NULL || having_program == NULL)
+							goto done;
 					}
 
-					// Check if the row satisfies the WHERE expression
-					if (AK_check_if_row_satisfies_expression(row_root, expr))
+					// Check if the row satisfies the WHERE expression and evaluate the HAVING condition
+					if (AK_expression_run(where_program, row, scratch) && AK_expression_run(having_program, row, scratch))
 					{
-						// Evaluate the HAVING condition
-						if (AK_check_if_row_satisfies_expression(row_root, havingExpr))
-						{
-							AK_insert_row(row_root);
-						}
+						AK_insert_compact_row(dstTable, row, NULL);
 					}
-
-					AK_DeleteAll_L3(&row_root);
+					AK_arena_reset(scratch);
 				}
 			}
 		}
 	}
 
+done:
+	AK_expression_free(where_program);
+	AK_expression_free(having_program);
+	AK_arena_destroy(scratch);
+	AK_row_free(row);
 	AK_free(src_addr);
 	AK_free(t_header);
-	AK_DeleteAll_L3(&row_root);
-	AK_free(row_root);
 
 	AK_print_table(dstTable);
 
@@ -139,78 +139,207 @@ int AK_create_theta_join_header(char *srcTable1, char * srcTable2, char *new_tab
 }
 
 /**
- * @author Tomislav Mikulček
- * @brief Function that iterates through blocks of the two tables and copies the rows which pass the constraint check into the new table
+ * @author Tomislav Mikulček, updated by agent (compact rows, compiled expression)
+ * @brief Function that iterates through blocks of the two tables and copies the rows which pass the constraint check into the new table.
+ *        Every pair of rows is put together in one compact row with the header of the new table.
  * @param tbl1_temp_block block of the first table
  * @param tbl2_temp_block block of the second join table
  * @param tbl1_num_att number of attributes in the first table
  * @param tbl2_num_att number of attributes in the second table
- * @param constraints list of attributes, (in)equality and logical operators which are the conditions for the join in postfix notation
+ * @param program conditions for the join compiled against the header of the theta_join table
  * @param new_table name of the theta_join table
  * @return No return value
  */
-void AK_check_constraints(AK_block *tbl1_temp_block, AK_block *tbl2_temp_block, int tbl1_num_att, int tbl2_num_att, struct list_node *constraints, char *new_table) {
+void AK_check_constraints(AK_block *tbl1_temp_block, AK_block *tbl2_temp_block, int tbl1_num_att, int tbl2_num_att, AK_expression_program *program, char *new_table) {
     AK_PRO;
     AK_dbg_messg(HIGH, REL_OP, "\n COPYING THETA JOIN");
 
-    int tbl1_att, tbl2_att, tbl1_row, tbl2_row;
-    int address, size, type;
-    char data[MAX_VARCHAR_LENGTH];
-
-    struct list_node *row_root_init = (struct list_node *) AK_malloc(sizeof (struct list_node));
-    struct list_node *row_root_full;
+    int tbl1_row, tbl2_row, att, type, size;
+    char *value;
 
     AK_header *t_header = (AK_header *) AK_get_header(new_table);
+    AK_row *tbl1 = AK_row_new(t_header, tbl1_num_att);
+    AK_row *tbl2 = AK_row_new(t_header, tbl2_num_att);
+    AK_row *row = AK_row_new(t_header, tbl1_num_att + tbl2_num_att);
+    AK_arena *scratch = AK_arena_create(0);
 
-    AK_Init_L3(&row_root_init);
+    if (t_header != NULL && tbl1 != NULL && tbl2 != NULL && row != NULL && scratch != NULL) {
 
-    for (tbl1_row = 0; tbl1_row < DATA_BLOCK_SIZE; tbl1_row += tbl1_num_att){
+        for (tbl1_row = 0; (tbl1_row + 1) * tbl1_num_att <= DATA_BLOCK_SIZE; tbl1_row++) {
 
-    	if (tbl1_temp_block->tuple_dict[tbl1_row].type == FREE_INT)
-			break;
+            if (tbl1_temp_block->tuple_dict[tbl1_row * tbl1_num_att].type == FREE_INT)
+                break;
+            if (AK_row_from_slot(tbl1, tbl1_temp_block, tbl1_row) == EXIT_ERROR)
+                continue;
 
-		for (tbl1_att = 0; tbl1_att < tbl1_num_att; tbl1_att++){
-			address = tbl1_temp_block->tuple_dict[tbl1_row + tbl1_att].address;
-			size = tbl1_temp_block->tuple_dict[tbl1_row + tbl1_att].size;
-			type = tbl1_temp_block->tuple_dict[tbl1_row + tbl1_att].type;
-			memset(data, 0, MAX_VARCHAR_LENGTH);
-			memcpy(data, &(tbl1_temp_block->data[address]), size);
-			AK_Insert_New_Element(type, data, new_table, t_header[tbl1_att].att_name, row_root_init);
-		}
+            for (tbl2_row = 0; (tbl2_row + 1) * tbl2_num_att <= DATA_BLOCK_SIZE; tbl2_row++) {
 
+                if (tbl2_temp_block->tuple_dict[tbl2_row * tbl2_num_att].type == FREE_INT)
+                    break;
+                if (AK_row_from_slot(tbl2, tbl2_temp_block, tbl2_row) == EXIT_ERROR)
+                    continue;
 
-    	for (tbl2_row = 0; tbl2_row < DATA_BLOCK_SIZE; tbl2_row += tbl2_num_att){
+                AK_row_reset(row);
+                for (att = 0; att < tbl1_num_att; att++) {
+                    value = AK_row_get(tbl1, att, &type, &size);
+                    AK_row_append(row, type, value, size);
+                }
+                for (att = 0; att < tbl2_num_att; att++) {
+                    value = AK_row_get(tbl2, att, &type, &size);
+                    AK_row_append(row, type, value, size);
+                }
 
-    		if (tbl2_temp_block->tuple_dict[tbl2_row].type == FREE_INT)
-				break;
+                if (AK_expression_run(program, row, scratch)) {
+                    AK_insert_compact_row(new_table, row, NULL);
+                }
+                AK_arena_reset(scratch);
+            }
+        }
+    }
 
-    		row_root_full = row_root_init;
+    AK_arena_destroy(scratch);
+    AK_row_free(row);
+    AK_row_free(tbl2);
+    AK_row_free(tbl1);
+    AK_free(t_header);
+    AK_EPI;
+}
 
-    		for (tbl2_att = 0; tbl2_att < tbl2_num_att; tbl2_att++){
-				address = tbl2_temp_block->tuple_dict[tbl2_row + tbl2_att].address;
-				size = tbl2_temp_block->tuple_dict[tbl2_row + tbl2_att].size;
-				type = tbl2_temp_block->tuple_dict[tbl2_row + tbl2_att].type;
-				memset(data, 0, MAX_VARCHAR_LENGTH);
-				memcpy(data, &(tbl2_temp_block->data[address]), size);
-				AK_Insert_New_Element(type, data, new_table, t_header[tbl1_att + tbl2_att].att_name, row_root_full);
-			}
+/**
+ * @author agent
+ * @brief Function that checks whether the constraints of a theta join are a conjunction of equalities between an
+ *        attribute of the first and an attribute of the second table of the same type, so the join can be done by hashing
+ * @param constraints conditions for the join in postfix notation
+ * @param header header of the theta_join table
+ * @param tbl1_num_att number of attributes in the first table
+ * @param tbl2_num_att number of attributes in the second table
+ * @param left_keys receives the positions of the attributes in the first table
+ * @param right_keys receives the positions of the attributes in the second table
+ * @return number of equalities, 0 if the constraints are not such a conjunction
+ */
+static int AK_theta_join_equi_keys(struct list_node *constraints, AK_header *header, int tbl1_num_att, int tbl2_num_att, int *left_keys, int *right_keys) {
+    AK_PRO;
+    struct list_node *el;
+    int attribute[2], pending = 0, results = 0, num_keys = 0, i, swap;
+
+    for (el = AK_First_L2(constraints); el != NULL; el = el->next) {
+        if (el->type == TYPE_ATTRIBS && pending < 2) {
+            for (i = 0; i < tbl1_num_att + tbl2_num_att; i++)
+                if (strcmp(header[i].att_name, el->data) == 0)
+                    break;
+            if (i == tbl1_num_att + tbl2_num_att)
+                break;
+            attribute[pending++] = i;
+        } else if (el->type == TYPE_OPERATOR && strcmp(el->data, "=") == 0 && pending == 2 && num_keys < MAX_ATTRIBUTES) {
+            swap = attribute[0] >= tbl1_num_att;
+            if ((attribute[swap] >= tbl1_num_att) || (attribute[!swap] < tbl1_num_att) || header[attribute[0]].type != header[attribute[1]].type)
+                break;
+            left_keys[num_keys] = attribute[swap];
+            right_keys[num_keys] = attribute[!swap] - tbl1_num_att;
+            num_keys++;
+            results++;
+            pending = 0;
+        } else if (el->type == TYPE_OPERATOR && strcmp(el->data, "AND") == 0 && pending == 0 && results >= 2) {
+            results--;
+        } else {
+            break;
+        }
+    }
+    AK_EPI;
+    return el == NULL && pending == 0 && results == 1 ? num_keys : 0;
+}
 
-			if (AK_check_if_row_satisfies_expression(row_root_full, constraints)){
-    			AK_insert_row(row_root_full);
-			}
-    	}
+/**
+ * @author agent
+ * @brief Function that checks whether the constraints of a theta join are a band condition: one or two comparisons
+ *        (<, <=, >, >= or BETWEEN) that bound the same numeric attribute of one table by numeric attributes of the
+ *        other table from below, from above or both, so the join can be done by sorting and merging
+ * @param constraints conditions for the join in postfix notation
+ * @param header header of the theta_join table
+ * @param tbl1_num_att number of attributes in the first table
+ * @param tbl2_num_att number of attributes in the second table
+ * @param band receives the arguments of AK_band_join_operator: point_left, point, low, low_comparison, high and
+ *        high_comparison
+ * @return 1 if the constraints are a band condition, 0 otherwise
+ */
+static int AK_theta_join_band(struct list_node *constraints, AK_header *header, int tbl1_num_att, int tbl2_num_att, int *band) {
+    AK_PRO;
+    struct list_node *el;
+    //every comparison as lower[i] < upper[i], or <= if it is not strict
+    int lower[2], upper[2], strict[2], num_comparisons = 0;
+    int attribute[3], pending = 0, results = 0, point, bound, i, k, type;
+
+    for (el = AK_First_L2(constraints); el != NULL; el = el->next) {
+        if (el->type == TYPE_ATTRIBS && pending < 3) {
+            for (i = 0; i < tbl1_num_att + tbl2_num_att; i++)
+                if (strcmp(header[i].att_name, el->data) == 0)
+                    break;
+            type = i < tbl1_num_att + tbl2_num_att ? header[i].type : TYPE_VARCHAR;
+            if (type != TYPE_INT && type != TYPE_FLOAT && type != TYPE_NUMBER)
+                break;
+            attribute[pending++] = i;
+        } else if (el->type == TYPE_OPERATOR && pending == 2 && num_comparisons < 2
+                && (strcmp(el->data, "<") == 0 || strcmp(el->data, "<=") == 0 || strcmp(el->data, ">") == 0 || strcmp(el->data, ">=") == 0)) {
+            k = el->data[0] == '<';
+            lower[num_comparisons] = attribute[!k];
+            upper[num_comparisons] = attribute[k];
+            strict[num_comparisons++] = el->data[1] == '\0';
+            results++;
+            pending = 0;
+        } else if (el->type == TYPE_OPERATOR && pending == 3 && num_comparisons == 0 && strcmp(el->data, "BETWEEN") == 0) {
+            lower[0] = attribute[1];
+            upper[0] = lower[1] = attribute[0];
+            upper[1] = attribute[2];
+            strict[0] = strict[1] = 0;
+            num_comparisons = 2;
+            results++;
+            pending = 0;
+        } else if (el->type == TYPE_OPERATOR && strcmp(el->data, "AND") == 0 && pending == 0 && results >= 2) {
+            results--;
+        } else {
+            break;
+        }
+    }
+    if (el != NULL || pending != 0 || results != 1) {
+        AK_EPI;
+        return 0;
+    }
+
+    //every comparison joins the two tables
+    for (i = 0; i < num_comparisons; i++)
+        if ((lower[i] < tbl1_num_att) == (upper[i] < tbl1_num_att)) {
+            AK_EPI;
+            return 0;
+        }
 
-    	
-    	AK_DeleteAll_L3(&row_root_init);
+    //the point is the attribute of the first table, or the one both comparisons share
+    if (num_comparisons == 1)
+        point = lower[0] < tbl1_num_att ? lower[0] : upper[0];
+    else if (lower[0] == upper[1] || upper[0] == lower[1])
+        point = lower[0] == upper[1] ? lower[0] : upper[0];
+    else {
+        AK_EPI;
+        return 0;
     }
 
-    AK_free(row_root_init);
+    band[0] = point < tbl1_num_att;
+    band[1] = band[0] ? point : point - tbl1_num_att;
+    band[2] = band[4] = EXIT_ERROR;
+    band[3] = band[5] = AK_EXPR_LE;
+    for (i = 0; i < num_comparisons; i++) {
+        bound = upper[i] == point ? lower[i] : upper[i];
+        k = upper[i] == point ? 2 : 4;
+        band[k] = band[0] ? bound - tbl1_num_att : bound;
+        band[k + 1] = strict[i] ? AK_EXPR_LT : AK_EXPR_LE;
+    }
     AK_EPI;
+    return 1;
 }
 
 /**
- * @author Tomislav Mikulček,updated by Nikola Miljancic
- * @brief Function that creates a theta join betwen two tables on specified conditions. Names of the attibutes in the constraints parameter must be prefixed
+ * @author Tomislav Mikulček,updated by Nikola Miljancic, updated by agent (compiled constraints, hash and band join)
+ * @brief Function that creates a theta join betwen two tables on specified conditions. A conjunction of equalities is joined by hashing,
+ *        a range condition like a.x < b.y or a.t BETWEEN b.lo AND b.hi by sorting and merging. Names of the attibutes in the constraints parameter must be prefixed
  *         with the table name followed by a dot if and only if they exist in both tables. This is left for the preprocessing. Also, for now the constraints  
  *	   must come from the two source tables and not from a third.
  * @param srcTable1 name of the first table to join
@@ -241,6 +370,60 @@ int AK_theta_join(char *srcTable1, char * srcTable2, char * dstTable, struct lis
 		AK_dbg_messg(MIDDLE, REL_OP, "\nAK_theta_join: start copying data\n");
 
         AK_mem_block *tbl1_temp_block, *tbl2_temp_block;
+        AK_header *t_header = (AK_header *) AK_get_header(dstTable);
+        int left_keys[MAX_ATTRIBUTES], right_keys[MAX_ATTRIBUTES];
+        int num_keys = AK_theta_join_equi_keys(constraints, t_header, tbl1_num_att, tbl2_num_att, left_keys, right_keys);
+
+        //equalities are joined by hashing instead of comparing all pairs of rows
+        if (num_keys > 0) {
+            AK_operator *plan = AK_equi_join_operator(AK_scan_operator(srcTable1), AK_scan_operator(srcTable2), num_keys, left_keys, right_keys);
+            int rows = EXIT_ERROR;
+
+            if (plan != NULL) {
+                //rows are inserted by attribute name, so they take the renamed attributes of the theta_join table
+                memcpy(plan->header, t_header, (tbl1_num_att + tbl2_num_att) * sizeof(AK_header));
+                rows = AK_iterator_insert(plan, dstTable);
+            }
+
+            AK_dbg_messg(MIDDLE, REL_OP, "\nAK_theta_join: hash join on %d attributes\n", num_keys);
+            AK_operator_free(plan);
+            AK_free(t_header);
+            AK_free(src_addr1);
+            AK_free(src_addr2);
+            AK_EPI;
+            return rows == EXIT_ERROR ? EXIT_ERROR : EXIT_SUCCESS;
+        }
+
+        //a range of values of one table bounded by the other is joined by sorting both tables
+        int band[6];
+        if (AK_theta_join_band(constraints, t_header, tbl1_num_att, tbl2_num_att, band)) {
+            AK_operator *plan = AK_band_join_operator(AK_scan_operator(srcTable1), AK_scan_operator(srcTable2), band[0], band[1], band[2], band[3], band[4], band[5]);
+            int rows = EXIT_ERROR;
+
+            if (plan != NULL) {
+                memcpy(plan->header, t_header, (tbl1_num_att + tbl2_num_att) * sizeof(AK_header));
+                rows = AK_iterator_insert(plan, dstTable);
+            }
+
+            AK_dbg_messg(MIDDLE, REL_OP, "\nAK_theta_join: band join\n");
+            AK_operator_free(plan);
+            AK_free(t_header);
+            AK_free(src_addr1);
+            AK_free(src_addr2);
+            AK_EPI;
+            return rows == EXIT_ERROR ? EXIT_ERROR : EXIT_SUCCESS;
+        }
+
+        //the constraints are compiled once for all pairs of blocks
+        AK_expression_program *program = AK_expression_compile(constraints, t_header, tbl1_num_att + tbl2_num_att);
+
+        AK_free(t_header);
+        if (program == NULL) {
+            AK_free(src_addr1);
+            AK_free(src_addr2);
+            AK_EPI;
+            return EXIT_ERROR;
+        }
 
         int i, j, k, l;
         i = j = k = l = 0;
@@ -277,7 +460,7 @@ int AK_theta_join(char *srcTable1, char * srcTable2, char * dstTable, struct lis
                                     //if there is data in the block
                                     if (tbl2_temp_block->block->AK_free_space != 0) {
 
-                                    		AK_check_constraints(tbl1_temp_block->block, tbl2_temp_block->block, tbl1_num_att, tbl2_num_att, constraints, dstTable);
+                                    		AK_check_constraints(tbl1_temp_block->block, tbl2_temp_block->block, tbl1_num_att, tbl2_num_att, program, dstTable);
                                     }
                                 }
                             } else break;
@@ -287,6 +470,7 @@ int AK_theta_join(char *srcTable1, char * srcTable2, char * dstTable, struct lis
             } else break;
         }
 
+        AK_expression_free(program);
         AK_free(src_addr1);
         AK_free(src_addr2);
 
@@ -304,12 +488,48 @@ int AK_theta_join(char *srcTable1, char * srcTable2, char * dstTable, struct lis
     }
 }
 
+/**
+ * @author agent
+ * @brief Function that counts the pairs of rows of two tables in which an integer attribute of the first table lies
+ *        between two integer attributes of the second, by a nested loop over both tables
+ * @param table1 first table
+ * @param point attribute of the first table
+ * @param table2 second table
+ * @param low attribute of the second table, lower bound
+ * @param high attribute of the second table, upper bound
+ * @return number of pairs
+ */
+static int AK_theta_join_test_between(char *table1, char *point, char *table2, char *low, char *high) {
+    AK_cursor *outer, *inner;
+    struct list_node *row1, *row2;
+    int value, from, to, count = 0;
+    int point_pos = AK_get_attr_index(table1, point);
+    int low_pos = AK_get_attr_index(table2, low);
+    int high_pos = AK_get_attr_index(table2, high);
+
+    outer = AK_cursor_open(table1);
+    while ((row1 = AK_cursor_next(outer)) != NULL) {
+        memcpy(&value, AK_GetNth_L2(point_pos + 1, row1)->data, sizeof(int));
+        inner = AK_cursor_open(table2);
+        while ((row2 = AK_cursor_next(inner)) != NULL) {
+            memcpy(&from, AK_GetNth_L2(low_pos + 1, row2)->data, sizeof(int));
+            memcpy(&to, AK_GetNth_L2(high_pos + 1, row2)->data, sizeof(int));
+            if (from <= value && value <= to)
+                count++;
+        }
+        AK_cursor_close(inner);
+    }
+    AK_cursor_close(outer);
+    return count;
+}
+
 /**
  * @author Tomislav Mikulček
  * @brief Function for testing the theta join
  * @return No return value
  */
 TestResult AK_op_theta_join_test() {
+    int passed = 0, failed = 0, rows, expected;
     AK_PRO;
     printf("\n********** THETA JOIN TEST **********\n\n");
 
@@ -348,21 +568,43 @@ TestResult AK_op_theta_join_test() {
     AK_theta_join("employee", "department", "theta_join_test3", constraints);
     AK_print_table("theta_join_test3");
     AK_DeleteAll_L3(&constraints);
-    char num = 102;
+    int num = 102;
     printf("SELECT * FROM student, professor2 WHERE year + id_prof > 37895;\n");
     AK_InsertAtEnd_L3(TYPE_ATTRIBS, "year", sizeof ("year"), constraints);
     AK_InsertAtEnd_L3(TYPE_ATTRIBS, "id_prof", sizeof ("id_prof"), constraints);
     AK_InsertAtEnd_L3(TYPE_OPERATOR, "+", sizeof ("+"), constraints);
-    AK_InsertAtEnd_L3(TYPE_INT, &num, sizeof (int), constraints);
+    AK_InsertAtEnd_L3(TYPE_INT, (char *)&num, sizeof (int), constraints);
     AK_InsertAtEnd_L3(TYPE_OPERATOR, ">", sizeof (">"), constraints);
 
     AK_theta_join("student", "professor2", "theta_join_test4", constraints);
     AK_print_table("theta_join_test4");
-    printf("Test is successful :) \n");
+    AK_DeleteAll_L3(&constraints);
+
+    //range condition, joined by sorting both tables
+    printf("SELECT * FROM student, professor2 WHERE mbr BETWEEN id_prof AND tel;\n");
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "mbr", sizeof ("mbr"), constraints);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "id_prof", sizeof ("id_prof"), constraints);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "tel", sizeof ("tel"), constraints);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "BETWEEN", sizeof ("BETWEEN"), constraints);
+
+    AK_theta_join("student", "professor2", "theta_join_test5", constraints);
+    AK_print_table("theta_join_test5");
+    //the band join has to produce the pairs a nested loop finds
+    rows = AK_get_num_records("theta_join_test5");
+    expected = AK_theta_join_test_between("student", "mbr", "professor2", "id_prof", "tel");
+    printf("Band join: %d rows, nested loop: %d rows\n", rows, expected);
+    if (rows > 0 && rows == expected) {
+        passed++;
+        printf("Test is successful :) \n");
+    } else {
+        failed++;
+        printf("Test failed :( \n");
+    }
+    AK_delete_segment("theta_join_test5", SEGMENT_TYPE_TABLE);
     AK_DeleteAll_L3(&constraints);
     
     AK_free(constraints);
     AK_EPI;
-    return TEST_result(0,0);
+    return TEST_result(passed,failed);
 }
 
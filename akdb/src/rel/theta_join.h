@@ -23,6 +23,7 @@
 
 #include "../auxi/test.h"
 #include "expression_check.h"
+#include "iterator.h"
 #include "../file/fileio.h"
 #include "../auxi/mempro.h"
 
@@ -53,17 +54,17 @@ void AK_check_constraints(AK_block *tbl1_temp_block, AK_block *tbl2_temp_block,
 int AK_theta_join(char *srcTable1, char * srcTable2, char * dstTable, AK_list *constraints);*/
 
 /**
- * @author Tomislav Mikulček
+ * @author Tomislav Mikulček, updated by agent (compact rows, compiled expression)
  * @brief Function that iterates through blocks of the two tables and copies the rows which pass the constraint check into the new table
  * @param tbl1_temp_block block of the first table
  * @param tbl2_temp_block block of the second join table
  * @param tbl1_num_att number of attributes in the first table
  * @param tbl2_num_att number of attributes in the second table
- * @param constraints list of attributes, (in)equality and logical operators which are the conditions for the join in postfix notation
+ * @param program conditions for the join compiled against the header of the theta_join table
  * @param new_table name of the theta_join table
  * @return No return value
  */
-void AK_check_constraints(AK_block *tbl1_temp_block, AK_block *tbl2_temp_block, int tbl1_num_att, int tbl2_num_att, struct list_node *constraints, char *new_table);
+void AK_check_constraints(AK_block *tbl1_temp_block, AK_block *tbl2_temp_block, int tbl1_num_att, int tbl2_num_att, AK_expression_program *program, char *new_table);
 int AK_theta_join(char *srcTable1, char * srcTable2, char * dstTable, struct list_node *constraints);
 TestResult AK_op_theta_join_test();
 
@@ -21,136 +21,188 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "union.h"
 
 /**
- * @author Dino Laktašić; updated by Elena Kržina
- * @brief  Function that makes a union of two tables. Union is implemented for working with multiple sets of data, i.e. duplicate tuples can be written in same table (union) 
+ * @author Dino Laktašić; updated by Elena Kržina, updated by agent (hash set operators)
+ * @brief  Function that writes the union of two tables into a new table. The rows are produced by a set operation node
+ *         (see AK_set_operator) over scans of the two tables.
  * @param srcTable1 name of the first table
  * @param srcTable2 name of the second table
  * @param dstTable name of the new table
+ * @param all 1 to keep duplicate rows, 0 to write every row once
  * @return if success returns EXIT_SUCCESS, else returns EXIT_ERROR
  */
-int AK_union(char *srcTable1, char *srcTable2, char *dstTable) {
+static int AK_union_tables(char *srcTable1, char *srcTable2, char *dstTable, int all) {
+    AK_operator *plan;
+    int rows;
     AK_PRO;
-    table_addresses *src_addr1 = (table_addresses*) AK_get_table_addresses(srcTable1);
-    table_addresses *src_addr2 = (table_addresses*) AK_get_table_addresses(srcTable2);
-
-    int startAddress1 = src_addr1->address_from[0];
-    int startAddress2 = src_addr2->address_from[0];
-	
-    if ((startAddress1 != 0) && (startAddress2 != 0)) {
-
-        AK_mem_block *tbl1_temp_block = (AK_mem_block *) AK_get_block(startAddress1);
-        AK_mem_block *tbl2_temp_block = (AK_mem_block *) AK_get_block(startAddress2);
-        
-        int num_att = AK_check_tables_scheme(tbl1_temp_block, tbl2_temp_block, "Union");
-
-		if (num_att == EXIT_ERROR) {
-			AK_EPI;
-			return EXIT_ERROR;
-		}
-
-		//initialize new segment
-		AK_header *header = (AK_header *) AK_malloc(num_att * sizeof (AK_header));
-		memcpy(header, tbl1_temp_block->block->header, num_att * sizeof (AK_header));
-		AK_initialize_new_segment(dstTable, SEGMENT_TYPE_TABLE, header);
-		AK_free(header);
-
-		struct list_node *row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    plan = AK_set_operator(AK_scan_operator(srcTable1), AK_scan_operator(srcTable2), AK_SET_UNION, all);
+    if (plan == NULL) {
+        AK_dbg_messg(LOW, REL_OP, "\nAK_union: Table/s doesn't exist!");
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    rows = AK_iterator_materialize(plan, dstTable);
+    AK_operator_free(plan);
+    if (rows == EXIT_ERROR) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    AK_dbg_messg(LOW, REL_OP, "UNION_TEST_SUCCESS\n\n");
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
 
-		AK_Write_Segments(dstTable, num_att, src_addr1, startAddress1, tbl1_temp_block, row_root);
-		AK_Write_Segments(dstTable, num_att, src_addr2, startAddress2, tbl2_temp_block,row_root);
-		
-		AK_free(src_addr1);
-		AK_free(src_addr2);
-		AK_free(row_root);
+int AK_union(char *srcTable1, char *srcTable2, char *dstTable) {
+    int result;
+    AK_PRO;
+    result = AK_union_tables(srcTable1, srcTable2, dstTable, 0);
+    AK_EPI;
+    return result;
+}
 
-		AK_dbg_messg(LOW, REL_OP, "UNION_TEST_SUCCESS\n\n");
-		AK_EPI;
-		return EXIT_SUCCESS;
-	} 
-	else {
-		AK_dbg_messg(LOW, REL_OP, "\nAK_union: Table/s doesn't exist!");
-		AK_free(src_addr1);
-		AK_free(src_addr2);
-		AK_EPI;
-		return EXIT_ERROR;
-	}
-	AK_EPI;
+int AK_union_all(char *srcTable1, char *srcTable2, char *dstTable) {
+    int result;
+    AK_PRO;
+    result = AK_union_tables(srcTable1, srcTable2, dstTable, 1);
+    AK_EPI;
+    return result;
 }
 
 /**
- * @author Dino Laktašić edited by Elena Kržina
- * @brief  Auxiliary function for writing blocks or tables into new segment, made by Dino Laktašić originally and separated and 
- * edited by Elena Kržina for code transparency
- * @param dstTable destination table of function
- * @param num_att number of attributes of table
- * @param src_addr1 source address
- * @param startAddress1 starting address
- * @param tbl1_temp_block table block that is accessed
- * @param row_root root of linked list
- * @return void
+ * @author agent
+ * @brief  Function that creates a node producing the years of the students selected by an expression
+ * @param expr selection expression
+ * @param twice 1 to produce every year twice, through a UNION ALL of two such nodes
+ * @return new node
  */
-void AK_Write_Segments(char *dstTable, int num_att, table_addresses *src_addr1, int startAddress1, AK_mem_block *tbl1_temp_block, struct list_node *row_root){
-	AK_PRO;
-	//registers used for faster working speed of variables
-    register int i, j, k;
-    i = j = k = 0;
-
-	int address, type, size;
-    char data[MAX_VARCHAR_LENGTH];
-
-	for (i = 0; src_addr1->address_from[i] != 0; i++) {
-            startAddress1 = src_addr1->address_from[i];
-
-            //BLOCK: for each block in table1 extent
-            for (j = startAddress1; j < src_addr1->address_to[i]; j++) {
-                tbl1_temp_block = (AK_mem_block *) AK_get_block(j); //read block from first table
-
-                //if there is data in the block
-                if (tbl1_temp_block->block->AK_free_space != 0) {
-
-					for (k = 0; k < DATA_BLOCK_SIZE; k++) {
-						if (tbl1_temp_block->block->tuple_dict[k].type == FREE_INT)
-							break;
-								
-						address = tbl1_temp_block->block->tuple_dict[k].address;
-						size = tbl1_temp_block->block->tuple_dict[k].size;
-						type = tbl1_temp_block->block->tuple_dict[k].type;
+static AK_operator *AK_set_test_years(struct list_node *expr, int twice) {
+    struct list_node *list = (struct list_node *)AK_malloc(sizeof(struct list_node));
+    AK_operator *plan[2];
+    int i;
+    AK_PRO;
+    AK_Init_L3(&list);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "year", sizeof("year"), list);
+    for (i = 0; i <= twice; i++)
+        plan[i] = AK_project_operator(AK_select_operator(AK_scan_operator("student"), expr), list);
+    AK_DeleteAll_L3(&list);
+    AK_free(list);
+    AK_EPI;
+    return twice ? AK_set_operator(plan[0], plan[1], AK_SET_UNION, 1) : plan[0];
+}
 
-						memset(data, '\0', MAX_VARCHAR_LENGTH);
-						memcpy(data, tbl1_temp_block->block->data + address, size);
-						
-						AK_Insert_New_Element(type, data, dstTable, tbl1_temp_block->block->header[k % num_att].att_name, row_root);
-							
-						if ((k + 1) % num_att == 0 && k != 0) {
-							AK_insert_row(row_root);
-							AK_DeleteAll_L3(&row_root);
-						}
-					}
-				}
-			}
-		}
-	AK_EPI;
+TestResult AK_set_operation_test(int operation) {
+    struct list_node *left = (struct list_node *)AK_malloc(sizeof(struct list_node));
+    struct list_node *right = (struct list_node *)AK_malloc(sizeof(struct list_node));
+    AK_operator *plan;
+    AK_operator_info info;
+    int years[100], success = 0, failed = 0, rows, expected, year, all, partitioned, l, r, result;
+    AK_PRO;
+    memset(years, 0, sizeof(years));
+    plan = AK_scan_operator("student");
+    if (AK_operator_open(plan) == EXIT_SUCCESS) {
+        l = AK_iterator_attr_index(plan->header, plan->num_attr, "year");
+        while (AK_operator_next(plan) == AK_ITERATOR_ROW)
+            if ((year = (int)AK_iterator_number(plan->row, l) - 1950) >= 0 && year < 100)
+                years[year]++;
+    }
+    AK_operator_free(plan);
+
+    //the years before 2020 against the years before 2012 taken twice
+    AK_Init_L3(&left);
+    year = 2020;
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "year", sizeof("year"), left);
+    AK_InsertAtEnd_L3(TYPE_INT, (char *)&year, sizeof(int), left);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "<", sizeof("<"), left);
+    AK_Init_L3(&right);
+    year = 2012;
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "year", sizeof("year"), right);
+    AK_InsertAtEnd_L3(TYPE_INT, (char *)&year, sizeof(int), right);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "<", sizeof("<"), right);
+    for (partitioned = 0; partitioned < 2; partitioned++) {
+        for (all = 0; all < 2; all++) {
+            plan = AK_set_operator(AK_set_test_years(left, 0), AK_set_test_years(right, 1), operation, all);
+            if (partitioned)
+                AK_operator_set_memory(plan, 1);
+            expected = 0;
+            for (year = 0; year < 100; year++) {
+                l = years[year] * (year + 1950 < 2020);
+                r = 2 * years[year] * (year + 1950 < 2012);
+                if (operation == AK_SET_UNION)
+                    expected += all ? l + r : (l + r > 0);
+                else if (operation == AK_SET_INTERSECT)
+                    expected += all ? (l < r ? l : r) : (l > 0 && r > 0);
+                else
+                    expected += all ? (l > r ? l - r : 0) : (l > 0 && r == 0);
+            }
+            rows = EXIT_ERROR;
+            info.partitions = 0;
+            if (plan != NULL && AK_operator_open(plan) == EXIT_SUCCESS) {
+                for (rows = 0; (result = AK_operator_next(plan)) == AK_ITERATOR_ROW; rows++);
+                AK_operator_describe(plan, &info);
+                if (result == EXIT_ERROR)
+                    rows = EXIT_ERROR;
+                AK_operator_close(plan);
+            }
+            AK_operator_free(plan);
+            printf("%s%s of years%s: %d rows in %d partitions, expected %d\n",
+                   operation == AK_SET_UNION ? "Union" : operation == AK_SET_INTERSECT ? "Intersection" : "Difference",
+                   all ? " ALL" : "", partitioned ? " with room for one row" : "", rows, info.partitions, expected);
+            //a UNION ALL only appends its inputs and never needs partitions
+            if (rows == expected && info.partitions == (partitioned && (operation != AK_SET_UNION || !all) ? AK_SET_PARTITIONS : 0))
+                success++;
+            else
+                failed++;
+        }
+    }
+    AK_DeleteAll_L3(&left);
+    AK_DeleteAll_L3(&right);
+    AK_free(left);
+    AK_free(right);
+    AK_EPI;
+    return TEST_result(success, failed);
 }
 
 /**
- * @author Dino Laktašić
+ * @author Dino Laktašić, updated by agent
  * @brief  Function for union operator testing
  * @return No return value
  * 
  */
 TestResult AK_op_union_test() {
     AK_PRO;
+    int success = 0, failed = 0;
+    int rows = AK_get_num_records("professor");
+
     printf("\n********** UNION TEST **********\n\n");
     AK_print_table("professor");
     AK_print_table("assistant");
     int test = AK_union("professor", "assistant", "union_test");
     AK_print_table("union_test");
-	
+    if (test == EXIT_SUCCESS)
+        success++;
+    else
+        failed++;
+
+    //a table united with itself keeps every row once, or twice with ALL
+    if (AK_union("professor", "professor", "union_test_distinct") == EXIT_SUCCESS
+        && AK_get_num_records("union_test_distinct") == rows)
+        success++;
+    else
+        failed++;
+    if (AK_union_all("professor", "professor", "union_test_all") == EXIT_SUCCESS
+        && AK_get_num_records("union_test_all") == 2 * rows)
+        success++;
+    else
+        failed++;
+    printf("professor UNION professor: %d rows, UNION ALL: %d rows, professor has %d rows\n",
+           AK_get_num_records("union_test_distinct"), AK_get_num_records("union_test_all"), rows);
+    AK_delete_segment("union_test_distinct", SEGMENT_TYPE_TABLE);
+    AK_delete_segment("union_test_all", SEGMENT_TYPE_TABLE);
+
+    //bags of years, in memory and partitioned
+    TestResult sets = AK_set_operation_test(AK_SET_UNION);
+    success += sets.testSucceded;
+    failed += sets.testFailed;
+
 	AK_EPI;
-	if (test == EXIT_SUCCESS){
-		return TEST_result(1,0);
-    }
-    else{
-		return TEST_result(0,1);
-    }	
-}
\ No newline at end of file
+	return TEST_result(success, failed);
+}
@@ -25,16 +25,39 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "../file/table.h"
 #include "../file/fileio.h"
 #include "../auxi/mempro.h"
+#include "iterator.h"
 
 /**
- * @author Dino Laktašić
- * @brief  Function that makes a union of two tables. 
+ * @author Dino Laktašić, updated by agent (hash set operators)
+ * @brief  Function that makes a union of two tables with the same number and types of attributes (UNION). Every row
+ *         is written once, duplicates are found in a hash table of the written rows.
  * @param srcTable1 name of the first table
  * @param srcTable2 name of the second table
  * @param dstTable name of the new table
  * @return if success returns EXIT_SUCCESS, else returns EXIT_ERROR
  */
 int AK_union(char *srcTable1, char *srcTable2, char *dstTable);
+
+/**
+ * @author agent
+ * @brief  Function that makes a union of two tables keeping duplicate rows (UNION ALL): the rows of the first table
+ *         followed by the rows of the second one
+ * @param srcTable1 name of the first table
+ * @param srcTable2 name of the second table
+ * @param dstTable name of the new table
+ * @return if success returns EXIT_SUCCESS, else returns EXIT_ERROR
+ */
+int AK_union_all(char *srcTable1, char *srcTable2, char *dstTable);
+
+/**
+ * @author agent
+ * @brief  Function that checks a set operation node on bags of years of the students, with and without ALL, in memory
+ *         and with room for one row, against the multiplicities of the years. Used by the tests of the set operators.
+ * @param operation AK_SET_UNION, AK_SET_INTERSECT or AK_SET_DIFFERENCE
+ * @return Test result - number of successful and unsuccessful checks
+ */
+TestResult AK_set_operation_test(int operation);
+
 TestResult AK_op_union_test();
 
 #endif
\ No newline at end of file
@@ -163,8 +163,7 @@ int AK_read_constraint_between(char* tableName, char* newValue, char* attNamePar
 
     int systemTableAddress = AK_find_table_address(AK_CONSTRAINTS_BEWTEEN);
     int num_rows = AK_get_num_records(AK_CONSTRAINTS_BEWTEEN);
-    int loop_count;
-    AK_block *tempBlock;
+    AK_cursor *cursor;
     struct list_node *row;
     struct list_node *constraint_table;
     struct list_node *constraint_attribute;
@@ -181,8 +180,8 @@ int AK_read_constraint_between(char* tableName, char* newValue, char* attNamePar
     }
 
     if (num_rows != 0) {
-        for (loop_count = 0; loop_count < num_rows; loop_count++) {
-            row = AK_get_row(loop_count, AK_CONSTRAINTS_BEWTEEN);
+        cursor = AK_cursor_open(AK_CONSTRAINTS_BEWTEEN);
+        while ((row = AK_cursor_next(cursor)) != NULL) {
             constraint_table = AK_GetNth_L2(2, row);
             
             if(strcmp(constraint_table->data, tableName) == 0){
@@ -195,6 +194,7 @@ int AK_read_constraint_between(char* tableName, char* newValue, char* attNamePar
 
                     if(strcmp(start_value->data,newValue) > 0){
                         printf("\nFAILURE: Value '%s' is smaller than minimal allowed value: '%s' \n",newValue,start_value->data);
+                        AK_cursor_close(cursor);
 
                         AK_EPI;
                         return EXIT_FAILURE;
@@ -203,6 +203,7 @@ int AK_read_constraint_between(char* tableName, char* newValue, char* attNamePar
                     if(strcmp(end_value->data,newValue) < 0){
 
                         printf("\nFAILURE: Value '%s' is bigger than maximum allowed value: '%s' \n",newValue,end_value->data);
+                        AK_cursor_close(cursor);
 
                         AK_EPI;
                         return EXIT_FAILURE;
@@ -210,13 +211,9 @@ int AK_read_constraint_between(char* tableName, char* newValue, char* attNamePar
                 }
             }
         }
+        AK_cursor_close(cursor);
     }
 
-    AK_free(tempBlock);
-    AK_free(constraint_table);
-    AK_free(constraint_attribute);
-    AK_free(start_value);
-    AK_free(end_value);
     AK_EPI;
 
     return EXIT_SUCCESS;
@@ -157,9 +157,9 @@ int condition_passed(char *condition, int type, void *value, void *row_data) {
  * @return 1 - result, 0 - failure 
  */
 int AK_set_check_constraint(char *table_name, char *constraint_name, char *attribute_name, char *condition, int type, void *value) {
-    int i;
     int attribute_position;
     int num_rows = AK_get_num_records(table_name);
+    AK_cursor *cursor;
     struct list_node *row;
     struct list_node *attribute;
     void *data = (void *) AK_calloc(MAX_VARCHAR_LENGTH, sizeof (void));
@@ -169,20 +169,22 @@ int AK_set_check_constraint(char *table_name, char *constraint_name, char *attri
     if (num_rows > 0) {
         attribute_position = AK_get_attr_index(table_name, attribute_name) + 1;
 
-        for (i = 0; i < num_rows; ++i) {
-            row = AK_get_row(i, table_name);
+        cursor = AK_cursor_open(table_name);
+        while ((row = AK_cursor_next(cursor)) != NULL) {
             attribute = AK_GetNth_L2(attribute_position, row);
 
             memmove(data, attribute->data, attribute->size);
 
             if (!condition_passed(condition, type, value, data)) {
                 printf("\n*** ERROR ***\nFailed to add 'check constraint' on TABLE: %s\nEntry in table caused 'constraint violation'!\n\n", table_name);
+                AK_cursor_close(cursor);
 
                 AK_EPI;
 
                 return EXIT_ERROR;
             }
         }
+        AK_cursor_close(cursor);
     }
 
     if (AK_check_constraint_name(constraint_name, AK_CONSTRAINTS_CHECK_CONSTRAINT) == EXIT_ERROR) {
@@ -239,9 +241,9 @@ int AK_set_check_constraint(char *table_name, char *constraint_name, char *attri
  * @return 1 - result, 0 - failure 
  */
 int AK_check_constraint(char *table, char *attribute, void *value) {
-    int i;
     int num_rows = AK_get_num_records(AK_CONSTRAINTS_CHECK_CONSTRAINT);
     int _row_data; // check constraint value
+    AK_cursor *cursor;
     struct list_node *row;
     struct list_node *constraint_attribute;
     void *row_data = (void *) AK_calloc(MAX_VARCHAR_LENGTH, sizeof (void)); // check constraint value
@@ -249,8 +251,8 @@ int AK_check_constraint(char *table, char *attribute, void *value) {
     AK_PRO;
 
     if (num_rows != 0) {
-        for (i = 0; i < num_rows; ++i) {
-            row = AK_get_row(i, AK_CONSTRAINTS_CHECK_CONSTRAINT);
+        cursor = AK_cursor_open(AK_CONSTRAINTS_CHECK_CONSTRAINT);
+        while ((row = AK_cursor_next(cursor)) != NULL) {
             constraint_attribute = AK_GetNth_L2(7, row);
 
             memmove(row_data, constraint_attribute->data, AK_type_size(constraint_attribute->type, constraint_attribute->data));  
@@ -261,6 +263,7 @@ int AK_check_constraint(char *table, char *attribute, void *value) {
                     _row_data = *((int *) row_data);
 
                     if (!condition_passed(AK_GetNth_L2(6, row)->data, AK_GetNth_L2(7, row)->type, _row_data, &value)) {
+                        AK_cursor_close(cursor);
                         AK_EPI;
 
                         return EXIT_ERROR;
@@ -271,6 +274,7 @@ int AK_check_constraint(char *table, char *attribute, void *value) {
                 }
 
                 if (!condition_passed(AK_GetNth_L2(6, row)->data, AK_GetNth_L2(7, row)->type, row_data, value)) {
+                    AK_cursor_close(cursor);
                     AK_EPI;
 
                     return EXIT_ERROR;
@@ -280,6 +284,7 @@ int AK_check_constraint(char *table, char *attribute, void *value) {
                 }
             }
         }
+        AK_cursor_close(cursor);
     }
 
     AK_EPI;
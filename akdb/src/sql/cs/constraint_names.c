@@ -28,8 +28,7 @@
  * @return EXIT_ERROR or EXIT_SUCCESS
  **/
 int AK_check_constraint_name(char *constraintName, char *constraintTable) {
-	int i, j;
-	int num_rows;
+	int i;
 
 	/**
 	 * Updated by Matej Lipovača
@@ -49,6 +48,7 @@ int AK_check_constraint_name(char *constraintName, char *constraintTable) {
 
 	size_t constraint_table_names_size = sizeof(constraint_table_names) / sizeof(constraint_table_names[0]);
 
+	AK_cursor *cursor;
 	struct list_node *row;
 	struct list_node *attribute;
 
@@ -62,23 +62,19 @@ int AK_check_constraint_name(char *constraintName, char *constraintTable) {
 
 	for (i = 0; i < constraint_table_names_size; ++i)
 	{
-		num_rows = AK_get_num_records(constraint_table_names[i]);
-
-		for (j = 0; j < num_rows; ++j)
+		cursor = AK_cursor_open(constraint_table_names[i]);
+		while ((row = AK_cursor_next(cursor)) != NULL)
 		{
-			row = AK_get_row(j, constraint_table_names[i]);
 			attribute = AK_GetNth_L2(3, row);
 			
 			if (strcmp(attribute->data, constraintName) == 0)
 			{
-				AK_DeleteAll_L3(&row);
-				AK_free(row);
+				AK_cursor_close(cursor);
 				AK_EPI;
 				return EXIT_ERROR;
 			}
-			AK_DeleteAll_L3(&row);
-			AK_free(row);
 		}
+		AK_cursor_close(cursor);
 	}
 	
 	AK_EPI;
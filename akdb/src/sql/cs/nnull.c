@@ -84,12 +84,12 @@ int AK_set_constraint_not_null(char* tableName, char* attName, char* constraintN
  * @return EXIT_ERROR or EXIT_SUCCESS
  **/
 int AK_check_constraint_not_null(char* tableName, char* attName, char* constraintName) {
-	int i;
 	int numRows;
 	int newConstraint;
 	int uniqueConstraintName;
 	struct list_node *row;
 	struct list_node *attribute;
+	AK_cursor *cursor;
 	
 	char *tupple_to_string_return;
 
@@ -101,24 +101,22 @@ int AK_check_constraint_not_null(char* tableName, char* attName, char* constrain
 	{
 		int positionOfAtt = AK_get_attr_index(tableName, attName) + 1;
 		
-		for(i=0; i<numRows; i++)
+		cursor = AK_cursor_open(tableName);
+		while((row = AK_cursor_next(cursor)) != NULL)
 		{
-			row = AK_get_row(i, tableName);
 			attribute = AK_GetNth_L2(positionOfAtt, row);
 			
 			if((tupple_to_string_return=AK_tuple_to_string(attribute)) == NULL)
 			{
 				printf("\nFAILURE!\nTable: %s\ncontains NULL sign and that would violate NOT NULL constraint which You would like to set on attribute: %s\n\n", tableName, attName);
-				AK_DeleteAll_L3(&row);
-				AK_free(row);
+				AK_cursor_close(cursor);
 				AK_EPI;
 				return EXIT_ERROR;
 			}
 			else
 				AK_free(tupple_to_string_return);
-			AK_DeleteAll_L3(&row);
-			AK_free(row);
 		}
+		AK_cursor_close(cursor);
 	}
 
 	uniqueConstraintName = AK_check_constraint_name(constraintName, AK_CONSTRAINTS_NOT_NULL);
@@ -150,15 +148,15 @@ int AK_read_constraint_not_null(char* tableName, char* attName, char* newValue)
 	struct list_node *row;
 	struct list_node *attribute;
 	struct list_node *table;
-	int i;
+	AK_cursor *cursor;
 	
 	AK_PRO;
 
 	if(newValue == NULL) {
 		if(numRecords != 0) {
-			for (i = 0; i < numRecords; i++) 
+			cursor = AK_cursor_open("AK_constraints_not_null");
+			while ((row = AK_cursor_next(cursor)) != NULL) 
 			{
-				row = AK_get_row(i, "AK_constraints_not_null");
 				attribute = AK_GetNth_L2(4, row);
 				
 				if(strcmp(attribute->data, attName) == 0) 
@@ -167,15 +165,13 @@ int AK_read_constraint_not_null(char* tableName, char* attName, char* newValue)
 					
 					if(strcmp(table->data, tableName) == 0) 
 					{
-						AK_DeleteAll_L3(&row);
-						AK_free(row);
+						AK_cursor_close(cursor);
 						AK_EPI;
 						return EXIT_ERROR;
 					}
 				}
-				AK_DeleteAll_L3(&row);
-				AK_free(row);
 			}			
+			AK_cursor_close(cursor);
 		}
 	}
 
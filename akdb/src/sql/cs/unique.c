@@ -20,7 +20,7 @@
 #include "unique.h"
 
 /**
- * @author Domagoj Tuličić, updated by Nenad Makar 
+ * @author Domagoj Tuličić, updated by Nenad Makar, updated by agent (cursor)
  * @brief Function that sets unique constraint on attribute(s)
  * @param char* tableName name of table
  * @param char attName[] name(s) of attribute(s), if you want to set UNIQUE constraint on combination of attributes seperate their names with constant SEPARATOR (see test)
@@ -41,6 +41,7 @@ int AK_set_constraint_unique(char* tableName, char attName[], char constraintNam
 	struct list_node *attribute;
 	struct list_node *attribute2;
 	dictionary* dict;
+	AK_cursor *cursor;
 	AK_PRO;
 
 	strcat(attributeName, "tableName");
@@ -64,16 +65,13 @@ int AK_set_constraint_unique(char* tableName, char attName[], char constraintNam
 	
 	if(numRows > 0)
 	{
-		row = AK_get_row(0, tableName);
-		int numOfAttsInTable = AK_Size_L2(row);
+		int numOfAttsInTable = AK_num_attr(tableName);
 		int positionsOfAtts[numOfAttsInTable];
 		int numOfImpAttPos = 0;
 		char attNameCopy[MAX_VARCHAR_LENGTH];
 		char *nameOfOneAtt;
 		char namesOfAtts[numOfAttsInTable][MAX_VARCHAR_LENGTH];
 		char *key, *val;
-		AK_DeleteAll_L3(&row);
-		AK_free(row);
 		strncpy(attNameCopy, attName, sizeof(attNameCopy));
 
 		nameOfOneAtt = strtok(attNameCopy, SEPARATOR);
@@ -98,9 +96,9 @@ int AK_set_constraint_unique(char* tableName, char attName[], char constraintNam
 			AK_EPI;
 			return EXIT_ERROR;
 		}
-		for(i=0; i<numRows-1; i++)
+		cursor = AK_cursor_open(tableName);
+		for(i=0; i<numRows-1 && (row = AK_cursor_next(cursor)) != NULL; i++)
 		{
-			row = AK_get_row(i, tableName);
 				
 			match = 1;
 			for(impoIndexInArray=0; (impoIndexInArray<numOfImpAttPos)&&(match==1); impoIndexInArray++)
@@ -127,14 +125,12 @@ int AK_set_constraint_unique(char* tableName, char attName[], char constraintNam
 			{
 				printf("\nFAILURE!\nExisting values in table: %s\nwould violate UNIQUE constraint which You would like to set on (combination of) attribute(s): %s\n\n", tableName, attName);
 				dictionary_del(dict);
-				AK_DeleteAll_L3(&row);
-				AK_free(row);
+				AK_cursor_close(cursor);
 				AK_EPI;
 				return EXIT_ERROR;
 			}
-			AK_DeleteAll_L3(&row);
-			AK_free(row);
 		}
+		AK_cursor_close(cursor);
 	dictionary_del(dict);
 	}
 
@@ -166,7 +162,7 @@ int AK_set_constraint_unique(char* tableName, char attName[], char constraintNam
 }
 
 /**
- * @author Domagoj Tuličić, updated by Nenad Makar 
+ * @author Domagoj Tuličić, updated by Nenad Makar, updated by agent (cursor)
  * @brief Function that checks if the insertion of some value(s) would violate the UNIQUE constraint
  * @param char* tableName name of table
  * @param char attName[] name(s) of attribute(s), if you want to check combination of values of more attributes seperate names of attributes with constant SEPARATOR (see test)
@@ -226,11 +222,11 @@ int AK_read_constraint_unique(char* tableName, char attName[], char newValue[]){
 		struct list_node *row;
 		struct list_node *attribute;
 		struct list_node *table;
-		int i;
+		AK_cursor *cursor = AK_cursor_open("AK_constraints_unique");
+		AK_cursor *cursor2;
 		
-		for(i=0; i<numRecords; i++)
+		while((row = AK_cursor_next(cursor)) != NULL)
 		{
-			row = AK_get_row(i, "AK_constraints_unique");
 			attribute = AK_GetNth_L2(4, row);
 			
 			if(strcmp(attribute->data, attName) == 0)
@@ -243,12 +239,13 @@ int AK_read_constraint_unique(char* tableName, char attName[], char newValue[]){
 					
 					if(numRows == 0)
 					{
+						AK_cursor_close(cursor);
 						AK_EPI;
 						return EXIT_SUCCESS;
 					}
 					
-					struct list_node *row2 = AK_get_row(0, table->data);
-					int numOfAttsInTable = AK_Size_L2(row2);
+					struct list_node *row2;
+					int numOfAttsInTable = AK_num_attr(table->data);
 					int positionsOfAtts[numOfAttsInTable];
 					int numOfImpAttPos = 0;
 					char attNameCopy[MAX_VARCHAR_LENGTH];
@@ -287,10 +284,9 @@ int AK_read_constraint_unique(char* tableName, char attName[], char newValue[]){
 					}
 
 					
-					for(h=0; h<numRows; h++)
+					cursor2 = AK_cursor_open(table->data);
+					for(h=0; h<numRows && (row2 = AK_cursor_next(cursor2)) != NULL; h++)
 					{
-						row2 = AK_get_row(h, table->data);
-
 						match = 1;
 						
 						for(impoIndexInArray=0; (impoIndexInArray<numOfImpAttPos)&&(match==1); impoIndexInArray++)
@@ -309,32 +305,36 @@ int AK_read_constraint_unique(char* tableName, char attName[], char newValue[]){
 						
 						if(match == 1)
 						{
+							AK_cursor_close(cursor2);
+							AK_cursor_close(cursor);
 							AK_EPI;
 							return EXIT_ERROR;
 						}
 					}
 					
+					AK_cursor_close(cursor2);
+					AK_cursor_close(cursor);
 					AK_EPI;
 					return EXIT_SUCCESS;
 				}
 			}
 		}
 		
+		AK_cursor_close(cursor);
 		AK_EPI;
 		return EXIT_SUCCESS;
 	}
 	else if(numRecords !=0 && strcmpTableName==0 && strcmpAttName!=0)
 	{
-		struct list_node *row = AK_get_row(0, tableName);
-		int numOfAttsInTable = AK_Size_L2(row);
+		struct list_node *row;
+		int numOfAttsInTable = AK_num_attr(tableName);
 		int positionsOfAtts[numOfAttsInTable];
 		int numOfImpAttPos = 0;
 		char attNameCopy[MAX_VARCHAR_LENGTH];
 		char *nameOfOneAtt;
 		char namesOfAtts[numOfAttsInTable][MAX_VARCHAR_LENGTH];
 		struct list_node *attribute2;
-		AK_DeleteAll_L3(&row);
-		AK_free(row);
+		AK_cursor *cursor;
 		
 		strncpy(attNameCopy, attName, sizeof(attNameCopy));
 
@@ -368,10 +368,9 @@ int AK_read_constraint_unique(char* tableName, char attName[], char newValue[]){
 
 		int numRows = AK_get_num_records(tableName);
 
-		for(h=0; h<numRows; h++)
+		cursor = AK_cursor_open(tableName);
+		for(h=0; h<numRows && (row = AK_cursor_next(cursor)) != NULL; h++)
 		{
-			row = AK_get_row(h, tableName);
-
 			match = 1;
 			
 			for(impoIndexInArray=0; (impoIndexInArray<numOfImpAttPos)&&(match==1); impoIndexInArray++)
@@ -390,15 +389,15 @@ int AK_read_constraint_unique(char* tableName, char attName[], char newValue[]){
 				else
 					AK_free(tuple_to_string_return);
 			}
-			AK_DeleteAll_L3(&row);
-			AK_free(row);
 			if(match == 1)
 			{
+				AK_cursor_close(cursor);
 				AK_EPI;
 				return EXIT_ERROR;
 			}
 		}
 		
+		AK_cursor_close(cursor);
 		AK_EPI;
 		return EXIT_SUCCESS;
 	}
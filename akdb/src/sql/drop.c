@@ -461,6 +461,7 @@ void AK_drop_help_function(char *tblName, char *sys_table) {
     AK_free(row_root);
     AK_free(addresses);
     AK_free(addresses2);
+    AK_catalog_invalidate();
 
     AK_EPI;
 }
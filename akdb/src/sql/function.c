@@ -29,14 +29,16 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
  */
 int AK_get_function_obj_id(char *function, struct list_node *arguments_list)
 {
-    int i = 0, id = -1, result, arg_num;
+    int id = -1, result, arg_num;
+    AK_cursor *cursor;
     struct list_node *row;
 
     int num_args;
     AK_PRO;
     num_args = AK_Size_L2(arguments_list) / 2; // u paru "naziv" - "vrsta" argumenta pa / 2
 
-    while ((row = (struct list_node *)AK_get_row(i, "AK_function")) != NULL)
+    cursor = AK_cursor_open("AK_function");
+    while ((row = AK_cursor_next(cursor)) != NULL)
     {
         struct list_node *elem_in_memcpy = AK_GetNth_L2(3, row);
         memcpy(&arg_num, elem_in_memcpy->data, sizeof(int));
@@ -57,13 +59,14 @@ int AK_get_function_obj_id(char *function, struct list_node *arguments_list)
 
             if (result != EXIT_ERROR)
             {
+                AK_cursor_close(cursor);
                 AK_EPI;
                 return id;
             }
         }
-        i++;
     }
 
+    AK_cursor_close(cursor);
     AK_EPI;
     return EXIT_ERROR;
 }
@@ -79,8 +82,9 @@ int AK_check_function_arguments(int function_id, struct list_node *arguments_lis
 {
     //int AK_check_function_arguments(int function_id, AK_list *arguments_list) {
 
+    AK_cursor *cursor;
     struct list_node *row;
-    int i = 0, fid;
+    int fid;
     AK_PRO;
 
     struct list_node *arguments_list_current = arguments_list->next;
@@ -90,7 +94,8 @@ int AK_check_function_arguments(int function_id, struct list_node *arguments_lis
     char *arguments_list_argname;
     char *arguments_list_argtype;
 
-    while ((row = (struct list_node *)AK_get_row(i, "AK_function_arguments")) != NULL)
+    cursor = AK_cursor_open("AK_function_arguments");
+    while ((row = AK_cursor_next(cursor)) != NULL)
     {
         struct list_node *current_elem = AK_First_L2(row); //set current_elem to first element in a list
         memcpy(&fid, current_elem->data, sizeof(int));
@@ -114,12 +119,13 @@ int AK_check_function_arguments(int function_id, struct list_node *arguments_lis
 
             if (strcmp(argtype_catalog, arguments_list_argtype) != 0 || strcmp(argname_catalog, arguments_list_argname) != 0)
             {
+                AK_cursor_close(cursor);
                 AK_EPI;
                 return EXIT_ERROR;
             }
         }
-        i++;
     }
+    AK_cursor_close(cursor);
     AK_EPI;
     return EXIT_SUCCESS;
 }
@@ -133,14 +139,16 @@ int AK_check_function_arguments(int function_id, struct list_node *arguments_lis
  */
 int AK_check_function_arguments_type(int function_id, struct list_node *args)
 {
+    AK_cursor *cursor;
     struct list_node *row;
-    int i = 0, tip = 0, fid;
+    int tip = 0, fid;
     AK_PRO;
     struct list_node *arguments_list_current = args->next;
 
     char *argtype;
     char *args_argtype;
-    while ((row = (struct list_node *)AK_get_row(i, "AK_function_arguments")) != NULL)
+    cursor = AK_cursor_open("AK_function_arguments");
+    while ((row = AK_cursor_next(cursor)) != NULL)
     {
         struct list_node *current_elem = AK_First_L2(row);
 
@@ -162,12 +170,13 @@ int AK_check_function_arguments_type(int function_id, struct list_node *args)
 
             if (strcmp(argtype, args_argtype) != 0)
             {
+                AK_cursor_close(cursor);
                 AK_EPI;
                 return EXIT_ERROR;
             }
         }
-        i++;
     }
+    AK_cursor_close(cursor);
     AK_EPI;
     return EXIT_SUCCESS;
 }
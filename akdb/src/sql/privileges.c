@@ -66,18 +66,18 @@ int AK_user_add(char *username, int *password, int set_id) {
  * @return user_id, otherwise EXIT_ERROR
  */
 int AK_user_get_id(char *username) {
-    int i = 0, id = EXIT_ERROR;
+    int id = EXIT_ERROR;
+    AK_cursor *cursor;
     struct list_node *row;
     AK_PRO;
-    while ((row = (struct list_node *) AK_get_row(i, "AK_user")) != NULL && id == EXIT_ERROR) {
+    cursor = AK_cursor_open("AK_user");
+    while (id == EXIT_ERROR && (row = AK_cursor_next(cursor)) != NULL) {
         struct list_node *elem_in_strcmp = AK_GetNth_L2(2, row);
         if (strcmp(elem_in_strcmp->data, username) == 0) {
             id = (int) *(AK_GetNth_L2(1, row)->data);            
         }
-        i++;
-        AK_DeleteAll_L3(&row);
-        AK_free(row);  
     }
+    AK_cursor_close(cursor);
     AK_EPI;
     return id;
 }
@@ -90,30 +90,28 @@ int AK_user_get_id(char *username) {
  * @return check 0 if false or 1 if true
  */
 int AK_user_check_pass(char *username, int *password) {
-    int i = 0;
     int check = 0;
+    AK_cursor *cursor;
     struct list_node *row;
     
     AK_PRO;
 
-    while ((row = (struct list_node *) AK_get_row(i, "AK_user")) != NULL) {
+    cursor = AK_cursor_open("AK_user");
+    while ((row = AK_cursor_next(cursor)) != NULL) {
        struct list_node *elem_in_strcmp = AK_GetNth_L2(2, row);
         if (strcmp(elem_in_strcmp->data, username) == 0) {                                 
             elem_in_strcmp = AK_GetNth_L2(3, row);
                              
             if (strcmp(elem_in_strcmp->data, &password) == 0) {
                 check = 1;
-                AK_free(elem_in_strcmp);
-                AK_free(row);
+                AK_cursor_close(cursor);
                 AK_EPI;                
                 return check;
             }
         }   
-             
-        i++;        
     }
 
-    AK_free(row);   
+    AK_cursor_close(cursor);
 
     AK_EPI;
     return check;
@@ -207,20 +205,21 @@ int AK_group_add(char *name, int set_id) {
  */
 int AK_group_get_id(char *name) {
     int i = 0;
+    AK_cursor *cursor;
     struct list_node *row;
     AK_PRO;
 
-    while ((row = (struct list_node *) AK_get_row(i, "AK_group")) != NULL) {
+    cursor = AK_cursor_open("AK_group");
+    while ((row = AK_cursor_next(cursor)) != NULL) {
         struct list_node *elem_in_strcmp = AK_GetNth_L2(2, row);
         if (strcmp(elem_in_strcmp->data, name) == 0) {
             i = (int) * row->next->data;
-            AK_free(row);
+            AK_cursor_close(cursor);
             AK_EPI;
             return i;
         }
-        i++;
     }
-    AK_free(row);
+    AK_cursor_close(cursor);
 
     AK_EPI;
     return EXIT_ERROR;
@@ -662,7 +661,7 @@ int AK_add_user_to_group(char *user, char *group) {
     AK_PRO;
     int user_id = AK_user_get_id(user);
     int group_id = AK_group_get_id(group);
-    int i = 0;
+    AK_cursor *cursor;
     struct list_node *row;
 
     if (group_id == EXIT_ERROR || user_id == EXIT_ERROR) {
@@ -671,16 +670,18 @@ int AK_add_user_to_group(char *user, char *group) {
         return EXIT_ERROR;
     }
 
-    while ((row = (struct list_node *) AK_get_row(i, "AK_user_group")) != NULL) {
+    cursor = AK_cursor_open("AK_user_group");
+    while ((row = AK_cursor_next(cursor)) != NULL) {
 
         // if user is already in group, return error
         if (user_id == (int) *row->next->data) {
             printf("User '%s' under ID %d is already a member of group '%s' under ID %d!\n", user, user_id, group, group_id);
+            AK_cursor_close(cursor);
             AK_EPI;
             return EXIT_ERROR;
         }
-        i++;
     }
+    AK_cursor_close(cursor);
 
     struct list_node *row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
     AK_Init_L3(&row_root);
@@ -812,13 +813,16 @@ int AK_check_privilege(char *username, char *table, char *privilege) {
         return EXIT_ERROR;
     }
 
+    AK_cursor *cursor;
     struct list_node *row;
+    int j;
 
     if (strcmp(privilege, "ALL") == 0) {
 
         int checking_privileges[4] = {0, 0, 0, 0};
         char found_privilege[10];
-        while ((row = (struct list_node *) AK_get_row(i, "AK_user_right")) != NULL) {
+        cursor = AK_cursor_open("AK_user_right");
+        while ((row = AK_cursor_next(cursor)) != NULL) {
 
             struct list_node *username_elem = AK_GetNth_L2(2, row);
             struct list_node *table_elem = AK_GetNth_L2(3, row);
@@ -835,9 +839,8 @@ int AK_check_privilege(char *username, char *table, char *privilege) {
                 if (strcmp(found_privilege, "SELECT") == 0)
                     checking_privileges[3] = 1;
             }
-            i++;
-            AK_free(row);
         }
+        AK_cursor_close(cursor);
         for (i = 0; i < 4; i++) {
             if (checking_privileges[i] == 1) {
                 has_right = 1;
@@ -852,61 +855,59 @@ int AK_check_privilege(char *username, char *table, char *privilege) {
             return EXIT_SUCCESS;
         }
 
-        i = 0;
-        while ((row = (struct list_node *) AK_get_row(i, "AK_user_group")) != NULL) {
-            while ((row = (AK_list *) AK_get_row(i, "AK_user_group")) != NULL) {
-                struct list_node *user = AK_GetNth_L2(1, row);
-                if (user_id == (int) * user->data) {
-                    struct list_node *group = AK_GetNth_L2(2, row);
-                    groups[number_of_groups] = (int) * group->data;
-                    number_of_groups++;
-                }
-                i++;
-                AK_free(row);
-            }
-            // set "flags" to 0
-            checking_privileges[0] = 0;
-            checking_privileges[1] = 0;
-            checking_privileges[2] = 0;
-            checking_privileges[3] = 0;
-            for (i = 0; i < number_of_groups; i++) {
-                int j = 0;
-                while ((row = (AK_list *) AK_get_row(j, "AK_group_right")) != NULL) {
-                    struct list_node *group_elem = AK_GetNth_L2(2, row);
-                    struct list_node *table_elem = AK_GetNth_L2(3, row);
-                    struct list_node *privilege_elem = AK_GetNth_L2(4, row);
-
-                    if ((groups[i] == (int) * group_elem->data) && (table_id == (int) * table_elem->data)) {
-                        strcpy(found_privilege, privilege_elem->data);
-                        if (strcmp(found_privilege, "UPDATE") == 0)
-                            checking_privileges[0] = 1;
-                        if (strcmp(found_privilege, "DELETE") == 0)
-                            checking_privileges[1] = 1;
-                        if (strcmp(found_privilege, "INSERT") == 0)
-                            checking_privileges[2] = 1;
-                        if (strcmp(found_privilege, "SELECT") == 0)
-                            checking_privileges[3] = 1;
-                    }
-                    j++;
-                    AK_free(row);
-                }
+        cursor = AK_cursor_open("AK_user_group");
+        while ((row = AK_cursor_next(cursor)) != NULL && number_of_groups < 100) {
+            struct list_node *user = AK_GetNth_L2(1, row);
+            if (user_id == (int) * user->data) {
+                struct list_node *group = AK_GetNth_L2(2, row);
+                groups[number_of_groups] = (int) * group->data;
+                number_of_groups++;
             }
-            for (i = 0; i < 4; i++) {
-                if (checking_privileges[i] == 1) {
-                    has_right = 1;
-                } else {
-                    has_right = 0;
-                    break;
-                }
+        }
+        AK_cursor_close(cursor);
+        // set "flags" to 0
+        checking_privileges[0] = 0;
+        checking_privileges[1] = 0;
+        checking_privileges[2] = 0;
+        checking_privileges[3] = 0;
+        //rights of all groups of the user are collected in one pass
+        cursor = number_of_groups > 0 ? AK_cursor_open("AK_group_right") : NULL;
+        while ((row = AK_cursor_next(cursor)) != NULL) {
+            struct list_node *group_elem = AK_GetNth_L2(2, row);
+            struct list_node *table_elem = AK_GetNth_L2(3, row);
+            struct list_node *privilege_elem = AK_GetNth_L2(4, row);
+
+            for (j = 0; j < number_of_groups && groups[j] != (int) * group_elem->data; j++)
+                ;
+            if (j < number_of_groups && (table_id == (int) * table_elem->data)) {
+                strcpy(found_privilege, privilege_elem->data);
+                if (strcmp(found_privilege, "UPDATE") == 0)
+                    checking_privileges[0] = 1;
+                if (strcmp(found_privilege, "DELETE") == 0)
+                    checking_privileges[1] = 1;
+                if (strcmp(found_privilege, "INSERT") == 0)
+                    checking_privileges[2] = 1;
+                if (strcmp(found_privilege, "SELECT") == 0)
+                    checking_privileges[3] = 1;
             }
-            if (has_right == 1) {
-                printf("User '%s' under ID %d has all privileges in the '%s' table under ID %d!", username, user_id, table, table_id);
-                AK_EPI;
-                return EXIT_SUCCESS;
+        }
+        AK_cursor_close(cursor);
+        for (i = 0; i < 4; i++) {
+            if (checking_privileges[i] == 1) {
+                has_right = 1;
+            } else {
+                has_right = 0;
+                break;
             }
         }
+        if (has_right == 1) {
+            printf("User '%s' under ID %d has all privileges in the '%s' table under ID %d!", username, user_id, table, table_id);
+            AK_EPI;
+            return EXIT_SUCCESS;
+        }
     } else {        
-        while ((row = (struct list_node *) AK_get_row(i, "AK_user_right")) != NULL) {           
+        cursor = AK_cursor_open("AK_user_right");
+        while ((row = AK_cursor_next(cursor)) != NULL) {           
             struct list_node *username_elem = AK_GetNth_L2(2, row);
             struct list_node *table_elem = AK_GetNth_L2(3, row);
             struct list_node *privilege_elem = AK_GetNth_L2(4, row);                
@@ -915,14 +916,14 @@ int AK_check_privilege(char *username, char *table, char *privilege) {
 
                 has_right = 1;
                 printf("User '%s' under ID %d has the right to %s data in the '%s' table under ID %d!", username, user_id, privilege, table, table_id);                
+                AK_cursor_close(cursor);
                 AK_EPI;
                 return EXIT_SUCCESS;
             }
-            i++;
-            AK_free(row);
         }
-        i = 0;
-        while ((row = (struct list_node *) AK_get_row(i, "AK_user_group")) != NULL) {
+        AK_cursor_close(cursor);
+        cursor = AK_cursor_open("AK_user_group");
+        while ((row = AK_cursor_next(cursor)) != NULL && number_of_groups < 100) {
             struct list_node *user = AK_GetNth_L2(1, row);
 
             if (user_id == (int) * user->data) {
@@ -930,26 +931,25 @@ int AK_check_privilege(char *username, char *table, char *privilege) {
                 groups[number_of_groups] = (int) * group->data;
                 number_of_groups++;
             }
-            i++;
-            AK_free(row);
         }
-        for (i = 0; i < number_of_groups; i++) {
-            int j = 0;
-
-            while ((row = (struct list_node *) AK_get_row(j, "AK_group_right")) != NULL) {
-                struct list_node *groups_elem = AK_GetNth_L2(2, row);
-                struct list_node *table_elem = AK_GetNth_L2(3, row);
-                struct list_node *privilege_elem = AK_GetNth_L2(4, row);
-                if ((groups[i] == (int) * groups_elem->data) && (table_id == (int) * table_elem->data) && (strcmp(privilege_elem->data, privilege) == 0)) {
-                    has_right = 1;
-                    printf("User '%s' under ID %d has the right to %s data in the '%s' table under ID %d!", username, user_id, privilege, table, table_id);
-                    AK_EPI;
-                    return EXIT_SUCCESS;
-                }
-                j++;
-                AK_free(row);
+        AK_cursor_close(cursor);
+        //rights of all groups of the user are checked in one pass
+        cursor = number_of_groups > 0 ? AK_cursor_open("AK_group_right") : NULL;
+        while ((row = AK_cursor_next(cursor)) != NULL) {
+            struct list_node *groups_elem = AK_GetNth_L2(2, row);
+            struct list_node *table_elem = AK_GetNth_L2(3, row);
+            struct list_node *privilege_elem = AK_GetNth_L2(4, row);
+            for (j = 0; j < number_of_groups && groups[j] != (int) * groups_elem->data; j++)
+                ;
+            if (j < number_of_groups && (table_id == (int) * table_elem->data) && (strcmp(privilege_elem->data, privilege) == 0)) {
+                has_right = 1;
+                printf("User '%s' under ID %d has the right to %s data in the '%s' table under ID %d!", username, user_id, privilege, table, table_id);
+                AK_cursor_close(cursor);
+                AK_EPI;
+                return EXIT_SUCCESS;
             }
         }
+        AK_cursor_close(cursor);
     }
 
     printf("User '%s' under ID %d has no right to %s data in the '%s' table under ID %d!", username, user_id, privilege, table, table_id);
@@ -966,7 +966,6 @@ int AK_check_privilege(char *username, char *table, char *privilege) {
 int AK_check_user_privilege(char *user) {
     AK_PRO;
     int user_id = AK_user_get_id(user);
-    int i = 0;
 
     if (user_id == EXIT_ERROR) {
         printf("Invalid username!\n");
@@ -974,33 +973,35 @@ int AK_check_user_privilege(char *user) {
         return EXIT_ERROR;
     }
 
+    AK_cursor *cursor;
     struct list_node *row;
     int privilege = 0;
 
-    while ((row = (struct list_node *) AK_get_row(i, "AK_user_right")) != NULL) {
+    cursor = AK_cursor_open("AK_user_right");
+    while ((row = AK_cursor_next(cursor)) != NULL) {
         struct list_node *user_elem = AK_GetNth_L2(2, row);
         if ((int) *user_elem->data == user_id) {
             privilege = 1;
             printf("User '%s' under ID %d has some privileges!", user, user_id);
+            AK_cursor_close(cursor);
             AK_EPI;
             return EXIT_SUCCESS;
         }
-        i++;
-        AK_free(row);
     }
+    AK_cursor_close(cursor);
 
-    int j = 0;
-    while ((row = (struct list_node *) AK_get_row(j, "AK_user_group")) != NULL) {
+    cursor = AK_cursor_open("AK_user_group");
+    while ((row = AK_cursor_next(cursor)) != NULL) {
         struct list_node *user_elem = AK_GetNth_L2(1, row);
         if ((int) *user_elem->data == user_id) {
             privilege = 1;
             printf("User '%s' under ID %d belongs to some group!", user, user_id);
+            AK_cursor_close(cursor);
             AK_EPI;
             return EXIT_SUCCESS;
         }
-        j++;
-        AK_free(row);
     }
+    AK_cursor_close(cursor);
 
     if (privilege == 0) {
         printf("User '%s' under ID %d hasn't got any privileges!", user, user_id);
@@ -1021,7 +1022,6 @@ int AK_check_user_privilege(char *user) {
 int AK_check_group_privilege(char *group) {
     AK_PRO;
     int group_id = AK_group_get_id(group);
-    int i = 0;
 
     if (group_id == EXIT_ERROR) {
         printf("Invalid group name or username!\n");
@@ -1029,20 +1029,22 @@ int AK_check_group_privilege(char *group) {
         return EXIT_ERROR;
     }
 
+    AK_cursor *cursor;
     struct list_node *row;
     int privilege = 0;
 
-    while ((row = (struct list_node *) AK_get_row(i, "AK_group_right")) != NULL) {
+    cursor = AK_cursor_open("AK_group_right");
+    while ((row = AK_cursor_next(cursor)) != NULL) {
         struct list_node *group_elem = AK_GetNth_L2(2, row);
         if ((int) *group_elem->data == group_id) {
             privilege = 1;
             printf("Group '%s' under ID %d has some privileges!", group, group_id);
+            AK_cursor_close(cursor);
             AK_EPI;
             return EXIT_SUCCESS;
         }
-        i++;
-        AK_free(row);
     }
+    AK_cursor_close(cursor);
 
     if (privilege == 0) {
         printf("Group '%s' under ID %d hasn't got any privileges!", group, group_id);
@@ -20,125 +20,10 @@
 #include "../mm/memoman.h"
 
 /**
- * @author Filip Žmuk, Edited by: Marko Belusic
- * @brief Helper function in SELECT clause which filters by condition
- * @param src_table - original table that is used for selection
- * @param selection_table - table in which result of applied condition is stored
- * @param condition - condition for selection
- * @return EXIT_SUCCESS if there was no error applying condition 
- */
-int AK_apply_select_by_condition(char *src_table, char *selection_table, struct list_node *condition){
-    strcat(selection_table, src_table);
-    if(condition != NULL)
-    {
-        strcat(selection_table, "__selection");
-        //select required rows
-        return AK_selection(src_table, selection_table, condition);
-    }
-    return EXIT_SUCCESS;
-}
-
-/**
- * @author Filip Žmuk, Edited by: Marko Belusic
- * @brief Helper function in SELECT clause which does the ordering
- * @param ordering - condition on which to order
- * @param sorted_table - table in which result of applied ordering is stored
- * @param selection_table - table in which result of applied condition is stored
- * @return EXIT_SUCCESS if there was no error ordering
- */
-int AK_apply_select_by_sorting(char *sorted_table, char *selection_table, struct list_node *ordering){
-    strcat(sorted_table, selection_table);
-    //sort required rows
-    if (ordering != NULL)
-    {
-        strcat(sorted_table, "__sorted");
-        return AK_sort_segment(selection_table, sorted_table, ordering);
-    }
-    return EXIT_SUCCESS;
-}
-
-/**
- * @author Filip Žmuk, Edited by: Marko Belusic
- * @brief Function that clears temporary tables
- * @param sorted_table - table in which result of applied ordering is stored
- * @param selection_table - table in which result of applied condition is stored
- * @param src_table - original table that is used for selection
- */
-void AK_apply_select_free_temp_tables(char *src_table, char *selection_table, char *sorted_table){
-    if(strcmp(src_table, selection_table) != 0)
-    {
-        AK_delete_segment(selection_table, SEGMENT_TYPE_TABLE);
-        if(strcmp(selection_table, sorted_table) != 0)
-        {
-            AK_delete_segment(sorted_table, SEGMENT_TYPE_TABLE);
-        }
-    }
-    else
-    {
-        if(strcmp(src_table, sorted_table) != 0)
-        {
-            AK_delete_segment(sorted_table, SEGMENT_TYPE_TABLE);
-        }
-    }
-}
-
-/**
- * @author Emma Uđbinac
- * @brief Helper function that create copy of attributes
- * @param attributes - atributes to be selected
- * @param projection_attributes - projected atributes
- */
-void AK_create_copy_of_attributes(struct list_node *attributes, struct list_node *projection_attributes){
-    struct list_node *attribute;
-
-    AK_Init_L3(&projection_attributes);
-
-    for (attribute = AK_First_L2(attributes); attribute; attribute = AK_Next_L2(attribute))
-    {
-        AK_InsertAtEnd_L3(TYPE_ATTRIBS, attribute->data, strlen(attribute->data), projection_attributes);
-    }
-}
-
-/**
- * @author Emma Uđbinac
- * @brief Helper function that clears projection of attributes
- * @param projection_attributes - projected atributes for delete
- */
-void AK_clear_projection_attributes(struct list_node *projection_attributes){
-    AK_DeleteAll_L3(&projection_attributes);
-    AK_free(projection_attributes);
-}
-
-/**
- * @author Emma Uđbinac
- * @brief Helper function that apply select by condition or by sorting
- * @param srcTable - original table that is used for selection
- * @param selection_table - temp table tfor selection
- * @param condition - condition for selection
- * @param attributes - atributes to be selected
- * @param projection_attributes - projected attributes
- * @param sorted_table - temp table for sorting
- * @param ordering - atributes for result sorting
- * @return EXIT_SUCCESS or EXIT_ERROR
- */
-int AK_apply_select(char *srcTable, char *selection_table, struct list_node *condition, struct list_node *attributes, struct list_node *projection_attributes, char *sorted_table, struct list_node *ordering){
-    if (AK_apply_select_by_condition(srcTable, selection_table, condition) != EXIT_SUCCESS){
-        return EXIT_ERROR;
-    }
-
-    // create copy of attributes
-    AK_create_copy_of_attributes(attributes, projection_attributes);
-
-    //create help table name for sorting
-    if (AK_apply_select_by_sorting(sorted_table, selection_table, ordering) != EXIT_SUCCESS){
-        return EXIT_ERROR;
-    }
-    return EXIT_SUCCESS;
-}
-
-/**
- * @author Filip Žmuk, Edited by: Marko Belusic
- * @brief Function that implements SELECT relational operator
+ * @author Filip Žmuk, Edited by: Marko Belusic, updated by agent (iterator executor, index access)
+ * @brief Function that implements SELECT relational operator. The query runs as one pipeline of scan, selection, sort
+ * and projection nodes, only the result table is written. The scan uses a B+tree index of the source table when the
+ * condition compares its key with constants, see AK_access_operator.
  * @param src_table - original table that is used for selection
  * @param dest_table - table that contains the result
  * @param condition - condition for selection
@@ -148,32 +33,23 @@ int AK_apply_select(char *srcTable, char *selection_table, struct list_node *con
  */
 int AK_select(char *src_table, char *dest_table, struct list_node *attributes, struct list_node *condition, struct list_node *ordering)
 {
+    AK_operator *plan;
+    int rows;
     AK_PRO;
-    //create help table name for selection
-    char selection_table[MAX_ATT_NAME] = "";
-    struct list_node *projectionAttributes = (struct list_node *)AK_malloc(sizeof(struct list_node));
-    char sorted_table[ MAX_ATT_NAME ] = "";
-
-    if(AK_apply_select(src_table, selection_table, condition, attributes, projectionAttributes, sorted_table, ordering) != EXIT_SUCCESS){
-        AK_clear_projection_attributes(projectionAttributes);
-        AK_EPI;
-        return EXIT_ERROR;
-    }
-
-    //project required rows
-    if (AK_projection(sorted_table, dest_table, projectionAttributes, NULL) != EXIT_SUCCESS)
-    {
-        AK_clear_projection_attributes(projectionAttributes);
-        AK_EPI;
-        return EXIT_ERROR;
-    }
-
-    // free temp tables
-    AK_apply_select_free_temp_tables(src_table, &selection_table, &sorted_table);
 
-    AK_clear_projection_attributes(projectionAttributes);
+    plan = AK_access_operator(src_table, condition);
+    if (plan != NULL && condition != NULL)
+        plan = AK_select_operator(plan, condition);
+    //sorting comes before the projection, the result does not have to contain the ordering attributes
+    if (plan != NULL && ordering != NULL)
+        plan = AK_sort_operator(plan, ordering);
+    if (plan != NULL)
+        plan = AK_project_operator(plan, attributes);
+
+    rows = plan != NULL ? AK_iterator_materialize(plan, dest_table) : EXIT_ERROR;
+    AK_operator_free(plan);
     AK_EPI;
-    return EXIT_SUCCESS;
+    return rows == EXIT_ERROR ? EXIT_ERROR : EXIT_SUCCESS;
 }
 
 /**
@@ -26,6 +26,7 @@
 #include "../auxi/auxiliary.h"
 #include "../auxi/mempro.h"
 #include "../file/filesort.h"
+#include "../rel/iterator.h"
 
 /**
  * @author Filip Žmuk
@@ -147,7 +147,7 @@ int AK_trigger_add(char *name, char* event, struct list_node *condition, char* t
  */
 int AK_trigger_get_id(char *name, char *table) {
     int trigger_index = 0, table_id = -1;
-    
+    AK_cursor *cursor;
     struct list_node *row;
     AK_PRO;
     table_id = AK_get_table_obj_id(table);
@@ -156,19 +156,19 @@ int AK_trigger_get_id(char *name, char *table) {
         return EXIT_ERROR;
     }
 
-    while ((row = (struct list_node *)AK_get_row(trigger_index, "AK_trigger")) != NULL) {
+    cursor = AK_cursor_open("AK_trigger");
+    while ((row = AK_cursor_next(cursor)) != NULL) {
         struct list_node *name_elem = AK_GetNth_L2(2,row);
         struct list_node *table_elem = AK_GetNth_L2(6,row);
         if (strcmp(name_elem->data, name) == 0 && table_id == (int) * table_elem->data) {
             trigger_index = (int) * row->next->data;
-            AK_free(row);
+            AK_cursor_close(cursor);
 	    AK_EPI;
             return trigger_index;
         }
-        trigger_index++;
     }
 
-    AK_free(row);
+    AK_cursor_close(cursor);
     AK_EPI;
     return EXIT_ERROR;
 }
@@ -314,19 +314,17 @@ struct list_node *AK_trigger_get_conditions(int trigger) {
     struct list_node *result = (struct list_node *) AK_malloc(sizeof(struct list_node));
     AK_Init_L3(&result);
     
-    int i = 0;
-
+    AK_cursor *cursor = AK_cursor_open("AK_trigger_conditions_temp");
     struct list_node *row;
 
-    while((row = (struct list_node *)AK_get_row(i, "AK_trigger_conditions_temp")) != NULL){
+    while((row = AK_cursor_next(cursor)) != NULL){
         struct list_node *first_arg_elem = AK_GetNth_L2(4,row);
         struct list_node *second_arg_elem = AK_GetNth_L2(3,row);
         AK_InsertAtEnd_L3(strtol(first_arg_elem->data, &endPtr, 10), second_arg_elem->data, second_arg_elem->size, result);
-        i++;
     }
+    AK_cursor_close(cursor);
 
     AK_delete_segment("AK_trigger_conditions_temp", SEGMENT_TYPE_TABLE);
-    AK_free(row);
     AK_EPI;
     return result;
 }
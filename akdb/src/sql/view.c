@@ -28,13 +28,13 @@
  */
 char *AK_check_view_name(char *name)
 {
-    int i = 0;
-    char *result;
-
+    char *result = name;
+    AK_cursor *cursor;
     struct list_node *row;
     AK_PRO;
 
-    while ((row = (struct list_node *)AK_get_row(i++, "AK_view")))
+    cursor = AK_cursor_open("AK_view");
+    while ((row = AK_cursor_next(cursor)))
     {
         struct list_node *name_elem = AK_GetNth_L2(2, row);
         if (strcmp(name_elem->data, name) == 0)
@@ -47,6 +47,7 @@ char *AK_check_view_name(char *name)
             result = name;
         }
     }
+    AK_cursor_close(cursor);
     AK_EPI;
     return result;
 }
@@ -59,20 +60,23 @@ char *AK_check_view_name(char *name)
  */
 int AK_get_view_object_id(char *name)
 {
-    int id, i = 0;
-
+    int id;
+    AK_cursor *cursor;
     struct list_node *row;
     AK_PRO;
-    while ((row = (struct list_node *)AK_get_row(i++, "AK_view")))
+    cursor = AK_cursor_open("AK_view");
+    while ((row = AK_cursor_next(cursor)))
     {
         struct list_node *name_elem = AK_GetNth_L2(2, row);
         if (!strcmp(name_elem->data, name))
         {
             memcpy(&id, row->next->data, sizeof(int));
+            AK_cursor_close(cursor);
             AK_EPI;
             return id;
         }
     }
+    AK_cursor_close(cursor);
     AK_EPI;
     return EXIT_ERROR;
 }
@@ -85,23 +89,27 @@ int AK_get_view_object_id(char *name)
  */
 char *AK_get_view_query(char *name)
 {
-    int i = 0;
     char *query;
-
+    AK_cursor *cursor;
     struct list_node *row;
     AK_PRO;
 
-    while ((row = (struct list_node *)AK_get_row(i++, "AK_view")))
+    cursor = AK_cursor_open("AK_view");
+    while ((row = AK_cursor_next(cursor)))
     {
         struct list_node *name_elem = AK_GetNth_L2(2, row);
         if (!strcmp(name_elem->data, name))
         {
+            //the row belongs to the cursor, the query is copied
             struct list_node *query_elem = AK_GetNth_L2(3, row);
-            query = query_elem->data;
+            query = (char *)AK_malloc(strlen(query_elem->data) + 1);
+            strcpy(query, query_elem->data);
+            AK_cursor_close(cursor);
             AK_EPI;
             return query;
         }
     }
+    AK_cursor_close(cursor);
     AK_EPI;
     return (char *)(EXIT_ERROR);
 }
@@ -114,23 +122,27 @@ char *AK_get_view_query(char *name)
  */
 char *AK_get_relation_expression(char *name)
 {
-    int i = 0;
     char *rel_exp;
-
+    AK_cursor *cursor;
     struct list_node *row;
     AK_PRO;
 
-    while ((row = (struct list_node *)AK_get_row(i++, "AK_view")))
+    cursor = AK_cursor_open("AK_view");
+    while ((row = AK_cursor_next(cursor)))
     {
         struct list_node *name_elem = AK_GetNth_L2(2, row);
         if (!strcmp(name_elem->data, name))
         {
+            //the row belongs to the cursor, the expression is copied
             struct list_node *rel_exp_elem = AK_GetNth_L2(3, row);
-            rel_exp = rel_exp_elem->data;
+            rel_exp = (char *)AK_malloc(strlen(rel_exp_elem->data) + 1);
+            strcpy(rel_exp, rel_exp_elem->data);
+            AK_cursor_close(cursor);
             AK_EPI;
             return rel_exp;
         }
     }
+    AK_cursor_close(cursor);
     AK_EPI;
     return (char *)(EXIT_ERROR);
 }
@@ -200,11 +212,11 @@ int AK_view_remove_by_object_id(int obj_id)
  */
 int AK_view_rename(char *name, char *new_name)
 {
-    int result = 0, i = 0;
+    int result = 0;
     int view_id;
-    char *query;
-    char *rel_exp;
-
+    char query[MAX_VARCHAR_LENGTH];
+    char rel_exp[MAX_VARCHAR_LENGTH];
+    AK_cursor *cursor;
     struct list_node *row;
     AK_PRO;
 
@@ -214,7 +226,8 @@ int AK_view_rename(char *name, char *new_name)
         return EXIT_ERROR;
     }
 
-    while ((row = (struct list_node *)AK_get_row(i++, "AK_view")))
+    cursor = AK_cursor_open("AK_view");
+    while ((row = AK_cursor_next(cursor)))
     {
         struct list_node *name_elem = AK_GetNth_L2(2, row);
         if (!strcmp(name_elem->data, name))
@@ -222,11 +235,12 @@ int AK_view_rename(char *name, char *new_name)
             struct list_node *view_elem = AK_GetNth_L2(1, row);
             struct list_node *query_rel_exp_elem = AK_GetNth_L2(3, row);
             memcpy(&view_id, view_elem->data, sizeof(int));
-            query = query_rel_exp_elem->data;
-            rel_exp = query_rel_exp_elem->data;
+            strcpy(query, query_rel_exp_elem->data);
+            strcpy(rel_exp, query_rel_exp_elem->data);
         }
     }
-   
+    AK_cursor_close(cursor);
+
     result = AK_view_remove_by_name(name);
     result = AK_view_add(new_name, query, rel_exp, view_id);
     AK_EPI;
@@ -74,9 +74,11 @@ AK_filesort_test,
 AK_filesearch_test,
 AK_sequence_test,
 AK_table_test,
+AK_parallel_test,
 AK_bitmap_test,
 AK_btree_test,
 AK_hash_test,
+AK_roaring_test,
 AK_memoman_test,
 AK_memoman_test2,
 AK_rel_eq_assoc_test,
@@ -96,6 +98,7 @@ AK_expression_check_test,
 AK_op_difference_test,
 AK_op_projection_test,
 AK_op_theta_join_test,
+AK_iterator_test,
 AK_test_command,
 AK_drop_test,
 AK_view_test,
@@ -130,9 +133,11 @@ listTestsStrings=[
 ["file:","AK_filesearch_test"],
 ["file:","AK_sequence_test"],
 ["file:","AK_table_test"],
+["file:","AK_parallel_test"],
 ["idx:","AK_bitmap_test"],
 ["idx:","AK_btree_test"],
 ["idx:","AK_hash_test"],
+["idx:","AK_roaring_test"],
 ["mm:","AK_memoman_test"],
 ["mm:","AK_block_test2"],
 ["opti:","AK_rel_eq_assoc_test"],
@@ -152,6 +157,7 @@ listTestsStrings=[
 ["rel:","AK_op_difference_test"],
 ["rel:","AK_op_projection_test"],
 ["rel:","AK_op_theta_join_test"],
+["rel:","AK_iterator_test"],
 ["sql:","AK_test_command"],
 ["sql:","AK_drop_test"],
 ["sql:","AK_view_test"],
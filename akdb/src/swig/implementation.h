@@ -24,6 +24,7 @@
 #include "../file/filesearch.c"
 #include "../file/files.c"
 #include "../file/table.c"
+#include "../file/parallel.c"
 #include "../file/id.c"
 #include "../file/fileio.c"
 #include "../file/filesort.c"
@@ -32,6 +33,7 @@
 #include "../file/idx/btree.c"
 #include "../file/idx/bitmap.c"
 #include "../file/idx/hash.c"
+#include "../file/idx/roaring.c"
 #include "../file/test.c"
 #include "../trans/transaction.c"
 #include "../mm/memoman.c"
@@ -57,6 +59,8 @@
 #include "../rel/difference.c"
 #include "../rel/intersect.c"
 #include "../rel/projection.c"
+#include "../rel/iterator.c"
+#include "../rel/batch.c"
 #include "../sql/cs/constraint_names.c"
 
 
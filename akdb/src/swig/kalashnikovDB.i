@@ -269,6 +269,8 @@ extern table_addresses *AK_get_segment_addresses(char * segmentName);
 
 %include "../file/table.c"
 %include "../file/table.h"
+%include "../file/parallel.c"
+%include "../file/parallel.h"
 
 %include "../file/idx/index.h"
 
@@ -281,6 +283,8 @@ extern void AK_Insert_NewelementAd(int addBlock, int indexTd, char *attName, ele
 
 %include "../file/idx/hash.c"
 %include "../file/idx/hash.h"
+%include "../file/idx/roaring.c"
+%include "../file/idx/roaring.h"
 
 %include "../file/idx/btree.c"
 %include "../file/idx/btree.h"
@@ -297,6 +301,10 @@ extern void AK_Insert_NewelementAd(int addBlock, int indexTd, char *attName, ele
 
 %include "../rel/theta_join.c"
 %include "../rel/theta_join.h"
+%include "../rel/iterator.c"
+%include "../rel/iterator.h"
+%include "../rel/batch.c"
+%include "../rel/batch.h"
 %include "../rel/product.c"
 %include "../rel/product.h"
 %include "../rel/aggregation.c"
@@ -18,10 +18,12 @@
 #include "file/filesearch.h"
 #include "file/filesort.h"
 #include "file/table.h"
+#include "file/parallel.h"
 #include "file/test.h"
 #include "file/sequence.h"
 // Indices
 #include "file/idx/hash.h"
+#include "file/idx/roaring.h"
 #include "file/idx/btree.h"
 #include "file/idx/bitmap.h"
 // Query processing
@@ -36,6 +38,7 @@
 #include "rel/union.h"
 #include "rel/aggregation.h"
 #include "rel/product.h"
+#include "rel/iterator.h"
 //Command
 #include "sql/command.h"
 #include "sql/select.h"
@@ -88,18 +91,20 @@ Test tests[] = {
 {"file: AK_filesearch", &AK_filesearch_test}, //file/filesearch.c
 {"file: AK_sequence", &AK_sequence_test}, //file/sequence.c  //old 14, new 17, old user  rinkovec  named this as btree which is not 14=btree??
 {"file: AK_table_test", &AK_table_test}, //file/table.c //old 15, new 18
-//9+9=18 total
+{"file: AK_parallel", &AK_parallel_test}, //file/parallel.c
+//10+9=19 total
 //file/idx:
 //-------------
 {"idx: AK_bitmap", &AK_bitmap_test}, //file/idx/bitmap.c
 {"idx: AK_btree", &AK_btree_test}, //file/idx/btree.c
 {"idx: AK_hash", &AK_hash_test}, //file/idx/hash.c
-//3+18=21 total
+{"idx: AK_roaring", &AK_roaring_test}, //file/idx/roaring.c
+//4+19=23 total
 //mm:
 //-------
 {"mm: AK_memoman", &AK_memoman_test}, //mm/memoman.c
 {"mm: AK_block", &AK_memoman_test2}, //mm/memoman.c
-//2+21=23 total
+//2+23=25 total
 //opti:
 //---------
 {"opti: AK_rel_eq_assoc", &AK_rel_eq_assoc_test}, //opti/rel_eq_assoc.c
@@ -107,7 +112,7 @@ Test tests[] = {
 {"opti: AK_rel_eq_selection", &AK_rel_eq_selection_test}, //opti/rel_eq_selection.c
 {"opti: AK_rel_eq_projection", &AK_rel_eq_projection_test}, //opti/rel_eq_projection.c
 {"opti: AK_query_optimization", &AK_query_optimization_test}, //opti/query_optimization.c //old 25, new 28
-//5+23=28 total
+//5+25=30 total
 //rel:
 //--------
 {"rel: AK_op_union", &AK_op_union_test}, //rel/union.c
@@ -124,7 +129,8 @@ Test tests[] = {
 {"rel: AK_op_difference", &AK_op_difference_test}, //rel/difference.c
 {"rel: AK_op_projection", &AK_op_projection_test}, //rel/projection.c
 {"rel: AK_op_theta_join", &AK_op_theta_join_test}, //rel/theta_join.c //old 37, new 39
-//11+28=39 total
+{"rel: AK_iterator", &AK_iterator_test}, //rel/iterator.c
+//14+30=44 total
 //sql:
 //--------
 {"sql: AK_command", &AK_test_command}, //sql/command.c
@@ -141,15 +147,15 @@ Test tests[] = {
 {"sql: AK_check_constraint", &AK_check_constraint_test}, //sql/cs/check_constraint.c //old 49, new 51
 {"sql: AK_constraint_names", &AK_constraint_names_test}, //sql/cs/constraint_names.c
 {"sql: AK_insert", &AK_insert_test}, //sql/insert.c
-//14+39=53 total
+//14+44=58 total
 //trans:
 //----------
 {"trans: AK_transaction", &AK_test_Transaction}, //src/trans/transaction.c
-//54
+//59
 //rec:
 //----------
 {"rec: AK_recovery", &AK_recovery_test} //rec/recovery.c
-//55
+//60
 };
 //here are all tests in a order like in the folders from the github
 void help()
@@ -161,6 +167,7 @@ void help()
     printf("alltest - runs all tests at once\n");
     printf("test [test_id] - run akdb in testing mode\n");
     printf("test show - displays available tests\n");
+    printf("migrate [old_file] [new_file] - converts a DB file of an older format\n");
     AK_EPI;
 }
 
@@ -207,6 +214,7 @@ void choose_test()
 {
     AK_PRO;
     int pickedTest=-1;
+    int allTests = sizeof(tests)/sizeof(tests[0]);
     AK_create_test_tables();
     set_catalog_constraints();
     while(pickedTest)
@@ -216,7 +224,7 @@ void choose_test()
         printf("Test: ");
         scanf("%d", &pickedTest);
         if(!pickedTest) exit( EXIT_SUCCESS );
-        while(pickedTest<0 || pickedTest>55)
+        while(pickedTest<0 || pickedTest>allTests)
         {
             printf("\nTest: ");
             scanf("%d", &pickedTest);